@@ -8,8 +8,35 @@
  *
  * Key features:
  *   - Epoch-based object tagging for stable identification across GC cycles
- *   - Full heap walk to find all live objects
- *   - Per-class snapshot and filtered heap walk for multiple target classes
+ *   - Full heap walk to find all live objects, optionally skipping reference-free leaves
+ *   - Reachable walks (FollowReferences) that never report unreachable, uncollected objects,
+ *     from the heap roots or scoped to the instance graph below a set of roots
+ *   - Per-class snapshot, and single-walk filtered / partitioned walks for many classes
+ *   - Chunked walks: matches resolved in bounded chunks instead of one Object[] of the heap
+ *   - Heap census: per-class instance counts, shallow bytes and array-length histograms
+ *     without resolving any object
+ *   - Referrer walk (FollowReferences) to find the holders of a given set of objects
+ *   - Referrer chains: the holders of a set of objects and, through the holders that cannot
+ *     be patched in place, the holders up to those that can, in one FollowReferences pass
+ *     that records up to a given number of references
+ *   - Holder-class discovery: the classes whose instances or static fields reference an
+ *     instance of the source classes, climbing past the classes that cannot be patched in place,
+ *     in one pass without tagging any instance
+ *   - Slot patching: rewrite holder fields / array elements that reference migrated
+ *     objects with JNI, without Java reflection
+ *   - Stack-local patching: rewrite the locals of suspended threads that reference migrated
+ *     objects (GetLocalObject / SetLocalObject)
+ *   - Residual-reference verification: count what still reaches migrated objects after
+ *     patching, with the shortest root path of a sample
+ *   - Reference-graph export: the reachable heap's classes, object sizes and references
+ *     streamed to a compact binary file for offline planning
+ *   - Per-walk tagging environments: no tag outlives the walk that set it
+ *   - Walk progress and cancellation: live visit counters, and a timed-out walk ends early
+ *   - Reclamation tracking: count ObjectFree events for a set of objects after a migration
+ *   - Thread suspension: stop-the-world quiescence with SuspendThreadList / ResumeThreadList
+ *   - Operation timing: wall and safepoint time of the tagging and resolve steps
+ *   - Foreign-function entry points: the statistics above as plain C functions, bound from
+ *     Java through java.lang.foreign without a JNI transition
  *
  * Performance note: every matched object in a single walk is tagged with the SAME
  * per-walk tag value, and objects are resolved with one GetObjectsWithTags(count=1)
@@ -17,6 +44,8 @@
  * linear search over the supplied tag array per entry — passing N distinct tags makes
  * it O(N^2). A single shared tag keeps the resolve O(heap). The per-walk epoch makes
  * the shared tag unique to this walk, so tags left over from earlier walks never match.
+ * Each walk tags in its own scratch JVMTI environment, disposed when the walk ends, so
+ * no tag outlives the walk that set it (see "Per-walk tagging environments").
  *
  * The agent can be loaded at JVM startup (-agentpath) or attached dynamically
  * to a running JVM via the Attach API.
@@ -24,11 +53,17 @@
  * @see migrator.heap.NativeHeapWalker (Java counterpart)
  */
 
+#define _GNU_SOURCE     /* dladdr */
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <limits.h>
+#include <time.h>
+#include <unistd.h>
 #include <jni.h>
 #include <jvmti.h>
 
@@ -45,6 +80,16 @@ static volatile jlong g_epoch = 1;
 /** The single tag value used for all objects matched during the current walk. */
 #define WALK_TAG(epoch) ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | 1ULL))
 
+/** Low-32-bit flag of a dense walk index (see "Walk index"); above every other per-walk tag. */
+#define WALK_INDEX_FLAG 0x80000000ULL
+
+/** Largest dense walk index. */
+#define WALK_INDEX_MAX 0x7FFFFFFFLL
+
+/** Tag of the object with dense index i in an indexed chunked walk. */
+#define WALK_INDEX_TAG(epoch, i) \
+    ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | WALK_INDEX_FLAG | (uint64_t)(uint32_t)(i)))
+
 /**
  * heap_filter for IterateThroughHeap: 0 = no JVMTI_HEAP_FILTER_* bits set, i.e. report
  * every object. (Not JVMTI_HEAP_OBJECT_EITHER — that enum is for the deprecated
@@ -67,13 +112,442 @@ static void check_print(jvmtiEnv* jvmti, jvmtiError err, const char* msg) {
     }
 }
 
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Per-walk tagging environments
+ * ---------------------------------------------------------------------------------------------
+ *
+ * A JVMTI tag lives in the tag map of the environment that set it until it is cleared or its
+ * object dies. A fresh epoch makes the tags of earlier walks irrelevant but does not remove
+ * them, so a FULL walk would leave an entry for every live object behind, and every later GC
+ * would have to process it. Each walk therefore tags in a scratch environment of its own
+ * (GetEnv creates a new one per call) and disposes it once its matches are resolved, which
+ * drops all of the walk's tags at once instead of one SetTag(0) per object. g_jvmti itself
+ * never holds a tag. If a scratch environment cannot be created the walk falls back to g_jvmti,
+ * where its tags stay behind as they did before.
+ */
+
+/** Number of scratch environments currently open (a chunked walk keeps its own across calls). */
+static volatile jint g_walk_envs = 0;
+
+/** Returns a new tagging environment for one walk, or g_jvmti if none can be created. */
+static jvmtiEnv* walk_env_open(void) {
+    static volatile jint warned = 0;
+    jvmtiEnv* jvmti = NULL;
+
+    if (g_vm && (*g_vm)->GetEnv(g_vm, (void**) &jvmti, JVMTI_VERSION_1_2) == JNI_OK && jvmti) {
+        jvmtiCapabilities caps;
+        memset(&caps, 0, sizeof(caps));
+        caps.can_tag_objects = 1;
+        jvmtiError err = (*jvmti)->AddCapabilities(jvmti, &caps);
+        if (err == JVMTI_ERROR_NONE) {
+            __sync_add_and_fetch(&g_walk_envs, 1);
+            return jvmti;
+        }
+        check_print(jvmti, err, "AddCapabilities(walk env) failed");
+        (*jvmti)->DisposeEnvironment(jvmti);
+    }
+    if (__sync_bool_compare_and_swap(&warned, 0, 1)) {
+        fprintf(stderr, "[agent] no per-walk JVMTI environment; walk tags stay in the agent's\n");
+    }
+    return g_jvmti;
+}
+
+/** Disposes a walk's tagging environment, dropping every tag it holds; no-op for g_jvmti. */
+static void walk_env_close(jvmtiEnv* jvmti) {
+    if (!jvmti || jvmti == g_jvmti) return;
+    jvmtiError err = (*jvmti)->DisposeEnvironment(jvmti);
+    check_print(g_jvmti, err, "DisposeEnvironment(walk env) failed");
+    __sync_sub_and_fetch(&g_walk_envs, 1);
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Walk progress and cancellation
+ * ---------------------------------------------------------------------------------------------
+ *
+ * A heap walk is one VM operation at a safepoint: interrupting the Java thread that started it
+ * has no effect until the whole heap has been visited. Each walk callback therefore counts the
+ * objects it is shown and those it tags in its walk's walk_progress, and every
+ * PROGRESS_POLL_INTERVAL visits publishes the counts and checks for a cancellation request. A
+ * cancelled walk returns JVMTI_VISIT_ABORT, which ends the iteration and the safepoint at once,
+ * resolves nothing and throws CancellationException to its Java caller.
+ *
+ * A request cancels the walks already started when it is made (epoch <= g_cancel_epoch); walks
+ * started afterwards are unaffected. The published counts describe the most recently started walk.
+ */
+
+/** Visits between two publications of a walk's counts / checks for cancellation (power of two). */
+#define PROGRESS_POLL_INTERVAL 1024
+
+/** Per-walk visit counters, embedded in each walk's callback context. */
+typedef struct {
+    jlong epoch;
+    jlong visited;      /* objects (references, for a referrer walk) shown to the callback */
+    jlong tagged;       /* objects the callback tagged */
+    int aborted;        /* set once the walk saw a cancellation request */
+} walk_progress;
+
+static volatile jlong g_cancel_epoch = 0;
+static volatile jlong g_progress_epoch = 0;
+static volatile jlong g_progress_visited = 0;
+static volatile jlong g_progress_tagged = 0;
+static volatile jint g_progress_active = 0;
+static volatile jint g_progress_cancelled = 0;
+
+/** Starts counting a walk and makes it the one whose counts are published. */
+static void progress_begin(walk_progress* p, jlong epoch) {
+    p->epoch = epoch;
+    p->visited = 0;
+    p->tagged = 0;
+    p->aborted = 0;
+    g_progress_epoch = epoch;
+    g_progress_visited = 0;
+    g_progress_tagged = 0;
+    g_progress_cancelled = 0;
+    g_progress_active = 1;
+}
+
+/** Publishes the walk's counts (if it is still the latest walk) and checks for cancellation. */
+static int progress_poll(walk_progress* p) {
+    int latest = g_progress_epoch == p->epoch;
+    if (latest) {
+        g_progress_visited = p->visited;
+        g_progress_tagged = p->tagged;
+    }
+    if (!p->aborted && g_cancel_epoch >= p->epoch) {
+        p->aborted = 1;
+        if (latest) g_progress_cancelled = 1;
+    }
+    return p->aborted;
+}
+
+/** Counts one callback; returns non-zero when the walk must abort. */
+static inline int progress_visit(walk_progress* p) {
+    if ((++p->visited & (PROGRESS_POLL_INTERVAL - 1)) != 0) return p->aborted;
+    return progress_poll(p);
+}
+
+/** Publishes the walk's final counts; returns non-zero if it was cancelled. */
+static int progress_end(walk_progress* p) {
+    int aborted = progress_poll(p);
+    if (g_progress_epoch == p->epoch) g_progress_active = 0;
+    return aborted;
+}
+
+/** Throws CancellationException for a cancelled walk (outside any heap callback). */
+static void throw_cancelled(JNIEnv* env, const char* walk) {
+    if ((*env)->ExceptionCheck(env)) return;
+    jclass ex = (*env)->FindClass(env, "java/util/concurrent/CancellationException");
+    if (ex == NULL) return;
+    char msg[128];
+    snprintf(msg, sizeof(msg), "heap walk cancelled: %s", walk);
+    (*env)->ThrowNew(env, ex, msg);
+    (*env)->DeleteLocalRef(env, ex);
+}
+
+/** Number of values reported by migrator_walk_progress. */
+#define WALK_PROGRESS_COUNT 5
+
+/**
+ * Cancels every walk started so far: each stops at its next poll and throws
+ * CancellationException. Walks started afterwards are unaffected. Foreign-function entry point.
+ */
+JNIEXPORT void migrator_cancel_walks(void) {
+    g_cancel_epoch = __sync_add_and_fetch(&g_epoch, 0);
+}
+
+/**
+ * Reports the counts of the most recently started walk. Foreign-function entry point.
+ *
+ * @param out receives { epoch, visited, tagged, active (0/1), cancelled (0/1) }
+ */
+JNIEXPORT void migrator_walk_progress(jlong* out) {
+    if (!out) return;
+    out[0] = g_progress_epoch;
+    out[1] = g_progress_visited;
+    out[2] = g_progress_tagged;
+    out[3] = (jlong) g_progress_active;
+    out[4] = (jlong) g_progress_cancelled;
+}
+
+/** JNI binding of migrator_cancel_walks. */
+JNIEXPORT void JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeCancelWalks(
+        JNIEnv* env,
+        jclass cls) {
+
+    (void) env;
+    (void) cls;
+    migrator_cancel_walks();
+}
+
+/**
+ * JNI binding of migrator_walk_progress.
+ *
+ * @param out long[5] receiving the counts
+ */
+JNIEXPORT void JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeWalkProgress(
+        JNIEnv* env,
+        jclass cls,
+        jlongArray out) {
+
+    (void) cls;
+
+    if (!env || out == NULL || (*env)->GetArrayLength(env, out) < WALK_PROGRESS_COUNT) return;
+    jlong progress[WALK_PROGRESS_COUNT];
+    migrator_walk_progress(progress);
+    (*env)->SetLongArrayRegion(env, out, 0, WALK_PROGRESS_COUNT, progress);
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Operation timing
+ * ---------------------------------------------------------------------------------------------
+ *
+ * IterateThroughHeap and FollowReferences are VM operations run at a safepoint: every
+ * application thread is stopped for the whole call, whichever thread asked for it.
+ * GetObjectsWithTags does not need a safepoint, but it scans the tag map holding the lock that
+ * GC needs, so a safepoint requested meanwhile waits for it. Each native operation therefore
+ * accumulates, per step:
+ *
+ *   TAG      the heap iteration that tags matches (class marking, target tagging, iteration)
+ *   RESOLVE  the GetObjectsWithTags call and the JNI arrays built from its result
+ *
+ * the number of calls, the wall time of the whole step, and the time spent inside the JVMTI
+ * call itself ("safepoint" time). For a tagging step that call spans the whole VM operation,
+ * reaching and leaving the safepoint included, so it is the pause the application sees; for a
+ * resolve step it bounds how long a safepoint could be held off. The counters are cumulative
+ * since the agent loaded; callers take differences.
+ */
+
+enum { OP_TAG = 0, OP_RESOLVE = 1, OP_KINDS = 2 };
+
+static volatile jlong g_op_calls[OP_KINDS];
+static volatile jlong g_op_wall_nanos[OP_KINDS];
+static volatile jlong g_op_safepoint_nanos[OP_KINDS];
+
+/** Monotonic clock in nanoseconds. */
+static jlong op_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (jlong) ts.tv_sec * 1000000000LL + (jlong) ts.tv_nsec;
+}
+
+/** Records one step of the given kind that started at start and spent safepoint ns in JVMTI. */
+static void op_record(int kind, jlong start, jlong safepoint) {
+    __sync_add_and_fetch(&g_op_calls[kind], 1);
+    __sync_add_and_fetch(&g_op_wall_nanos[kind], op_now() - start);
+    __sync_add_and_fetch(&g_op_safepoint_nanos[kind], safepoint);
+}
+
+/**
+ * Reports the cumulative operation times. Foreign-function entry point.
+ *
+ * @param out receives { tag calls, tag wall ns, tag safepoint ns,
+ *                       resolve calls, resolve wall ns, resolve safepoint ns }
+ */
+JNIEXPORT void migrator_op_times(jlong* out) {
+    if (!out) return;
+    for (int k = 0; k < OP_KINDS; k++) {
+        out[3 * k] = __sync_add_and_fetch(&g_op_calls[k], 0);
+        out[3 * k + 1] = __sync_add_and_fetch(&g_op_wall_nanos[k], 0);
+        out[3 * k + 2] = __sync_add_and_fetch(&g_op_safepoint_nanos[k], 0);
+    }
+}
+
+/**
+ * JNI binding of migrator_op_times.
+ *
+ * @param out long[6] receiving the times
+ */
+JNIEXPORT void JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeOpTimes(
+        JNIEnv* env,
+        jclass cls,
+        jlongArray out) {
+
+    (void) cls;
+
+    if (!env || out == NULL || (*env)->GetArrayLength(env, out) < 3 * OP_KINDS) return;
+    jlong times[3 * OP_KINDS];
+    migrator_op_times(times);
+    (*env)->SetLongArrayRegion(env, out, 0, 3 * OP_KINDS, times);
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Leaf filtering
+ * ---------------------------------------------------------------------------------------------
+ *
+ * A full walk reports every live object, yet primitive arrays, Strings and boxed numbers make up
+ * most of a typical heap and can never hold a reference to a migrated object. A full walk that
+ * skips leaves marks the mirrors of the primitive array classes and of the caller's leaf classes
+ * with LEAF_MARK_TAG(epoch) before it starts; its callback then leaves every object whose class
+ * carries that mark untagged, so it is never resolved into a JNI reference. Matching is on the
+ * exact class. The marked mirrors themselves are skipped too (re-tagging one would unmark its
+ * class for the rest of the walk); a Class object has nothing to patch.
+ */
+
+/** Mark of a leaf class mirror: low word 0x7FFFFFFF, above every class mark and chunk tag. */
+#define LEAF_MARK_TAG(epoch) ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | 0x7FFFFFFFULL))
+
+/** JNI names of the primitive array classes, whose instances hold no references. */
+static const char* const PRIMITIVE_ARRAY_CLASSES[] = { "[Z", "[B", "[C", "[S", "[I", "[J", "[F", "[D" };
+
+/**
+ * Marks the primitive array classes and each non-null class in leafArray with leaf_mark in the
+ * walk's tagging environment. Runs before the walk, so it may use JNI.
+ */
+static void mark_leaf_classes(JNIEnv* env, jvmtiEnv* jvmti, jobjectArray leafArray, jlong leaf_mark) {
+    size_t nPrimitive = sizeof(PRIMITIVE_ARRAY_CLASSES) / sizeof(PRIMITIVE_ARRAY_CLASSES[0]);
+    for (size_t i = 0; i < nPrimitive; i++) {
+        jclass k = (*env)->FindClass(env, PRIMITIVE_ARRAY_CLASSES[i]);
+        if (k == NULL) {
+            if ((*env)->ExceptionCheck(env)) (*env)->ExceptionClear(env);
+            continue;
+        }
+        jvmtiError err = (*jvmti)->SetTag(jvmti, k, leaf_mark);
+        check_print(jvmti, err, "SetTag(primitive array class) failed");
+        (*env)->DeleteLocalRef(env, k);
+    }
+
+    jsize nLeaves = leafArray != NULL ? (*env)->GetArrayLength(env, leafArray) : 0;
+    for (jsize i = 0; i < nLeaves; i++) {
+        jclass k = (jclass)(*env)->GetObjectArrayElement(env, leafArray, i);
+        if (k == NULL) continue;
+        jvmtiError err = (*jvmti)->SetTag(jvmti, k, leaf_mark);
+        check_print(jvmti, err, "SetTag(leaf class) failed");
+        (*env)->DeleteLocalRef(env, k);
+    }
+}
+
+/** True if the object (own tag) or its class (class tag) carries the walk's leaf mark. */
+static inline int is_leaf(jlong leaf_mark, jlong class_tag, jlong own_tag) {
+    return leaf_mark != 0 && (class_tag == leaf_mark || own_tag == leaf_mark);
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Reachable walks
+ * ---------------------------------------------------------------------------------------------
+ *
+ * IterateThroughHeap reports every object in the heap, including the unreachable ones no GC has
+ * reclaimed yet, so a walk that follows a burst of allocation tags, resolves and patches garbage
+ * (the benchmarks force a GC before each walk for that reason). A reachable walk runs the same
+ * heap_iteration_callback under FollowReferences instead: the traversal starts at the heap roots
+ * and reports only the objects reachable from them, so its cost follows the live data and no GC
+ * is needed to keep garbage out. Heap filters apply as for IterateThroughHeap; a filtered-out
+ * object is not reported, but the references it holds are still followed.
+ *
+ * FollowReferences reports an object once per reference to it. The callback is therefore run
+ * for an object only while its tag is 0: the callbacks tag every object they keep, and running
+ * one again on an object it skipped (a leaf, another class) changes nothing. Objects reachable
+ * only through soft, weak or phantom references are reported; they are live until the GC clears
+ * the reference.
+ *
+ * A root-scoped walk starts FollowReferences at one initial object instead of the heap roots: an
+ * Object[] holding the caller's roots, so its elements are reported as its array elements. Only
+ * field and array-element references are followed (scope_cb). The class, loader, static-field
+ * and constant-pool references every object leads to would otherwise reach every class's statics,
+ * i.e. most of the heap, so what is reached is the instance graph below the roots. Such a walk
+ * runs without a heap filter: FollowReferences still traverses an object its filter excludes,
+ * whatever the reference kind.
+ */
+
+/** An iteration callback and its user_data, run by reach_cb under FollowReferences. */
+typedef struct {
+    jvmtiHeapIterationCallback iterate;
+    void* user_data;
+} reach_walk_ctx;
+
+/**
+ * JVMTI heap_reference_callback of a reachable walk: runs the walk's iteration callback on the
+ * referree the first time it is reported, and keeps the traversal going unless it aborts.
+ */
+static jint JNICALL reach_cb(
+        jvmtiHeapReferenceKind reference_kind,
+        const jvmtiHeapReferenceInfo* reference_info,
+        jlong class_tag,
+        jlong referrer_class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jlong* referrer_tag_ptr,
+        jint length,
+        void* user_data) {
+
+    (void) reference_kind;
+    (void) reference_info;
+    (void) referrer_class_tag;
+    (void) referrer_tag_ptr;
+
+    reach_walk_ctx* ctx = (reach_walk_ctx*) user_data;
+    if (!ctx || !tag_ptr || *tag_ptr != 0) return JVMTI_VISIT_OBJECTS;
+    jint res = ctx->iterate(class_tag, size, tag_ptr, length, ctx->user_data);
+    return (res & JVMTI_VISIT_ABORT) ? JVMTI_VISIT_ABORT : JVMTI_VISIT_OBJECTS;
+}
+
+/**
+ * JVMTI heap_reference_callback of a root-scoped walk: reach_cb restricted to field and
+ * array-element references, the only ones whose referree it reports or traverses.
+ */
+static jint JNICALL scope_cb(
+        jvmtiHeapReferenceKind reference_kind,
+        const jvmtiHeapReferenceInfo* reference_info,
+        jlong class_tag,
+        jlong referrer_class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jlong* referrer_tag_ptr,
+        jint length,
+        void* user_data) {
+
+    if (reference_kind != JVMTI_HEAP_REFERENCE_FIELD && reference_kind != JVMTI_HEAP_REFERENCE_ARRAY_ELEMENT) {
+        return 0;
+    }
+    return reach_cb(reference_kind, reference_info, class_tag, referrer_class_tag, size, tag_ptr,
+                    referrer_tag_ptr, length, user_data);
+}
+
+/**
+ * Runs one tagging pass of callback over the heap: IterateThroughHeap, or FollowReferences for a
+ * reachable walk, from the heap roots or, with a non-NULL initial object, from it alone (see
+ * "Reachable walks"). A root-scoped walk ignores heap_filter and klass.
+ */
+static jvmtiError iterate_heap(jvmtiEnv* jvmti, int reachable, jobject initial, jint heap_filter, jclass klass,
+                               jvmtiHeapIterationCallback callback, void* user_data) {
+    jvmtiHeapCallbacks callbacks;
+    memset(&callbacks, 0, sizeof(callbacks));
+    if (!reachable) {
+        callbacks.heap_iteration_callback = callback;
+        return (*jvmti)->IterateThroughHeap(jvmti, heap_filter, klass, &callbacks, user_data);
+    }
+    reach_walk_ctx ctx;
+    ctx.iterate = callback;
+    ctx.user_data = user_data;
+    if (initial != NULL) {
+        callbacks.heap_reference_callback = &scope_cb;
+        return (*jvmti)->FollowReferences(jvmti, HEAP_FILTER_NONE, NULL, initial, &callbacks, &ctx);
+    }
+    callbacks.heap_reference_callback = &reach_cb;
+    return (*jvmti)->FollowReferences(jvmti, heap_filter, klass, NULL, &callbacks, &ctx);
+}
+
+/** Per-walk state shared with heap_tagging_cb through IterateThroughHeap's user_data. */
+typedef struct {
+    jlong walk_tag;
+    jlong leaf_mark;    /* skip objects of classes carrying this mark (0: skip nothing) */
+    walk_progress progress;
+} tag_walk_ctx;
+
 /**
  * JVMTI callback to tag heap objects for the current walk.
  *
- * The per-walk tag is passed via user_data (a pointer to the jlong walk_tag) so the
- * callback never reads the shared g_epoch — each walk tags with its own value, even if
- * walks overlap. An object already carrying this walk's tag is left as-is (cheap
- * idempotence when it matches several target classes); any other value is overwritten.
+ * The per-walk tag is passed via user_data (in a tag_walk_ctx) so the callback never reads the
+ * shared g_epoch — each walk tags with its own value, even if walks overlap. An object already
+ * carrying this walk's tag is left as-is (cheap idempotence when it matches several target
+ * classes); any other value is overwritten. Leaves are skipped (see "Leaf filtering").
  */
 static jint JNICALL heap_tagging_cb(
         jlong class_tag,
@@ -82,38 +556,49 @@ static jint JNICALL heap_tagging_cb(
         jint length,
         void* user_data) {
 
-    (void) class_tag;
     (void) size;
     (void) length;
 
-    if (!tag_ptr || !user_data) return JVMTI_ITERATION_CONTINUE;
+    tag_walk_ctx* ctx = (tag_walk_ctx*) user_data;
+    if (!tag_ptr || !ctx) return JVMTI_ITERATION_CONTINUE;
+    if (progress_visit(&ctx->progress)) return JVMTI_VISIT_ABORT;
+    if (is_leaf(ctx->leaf_mark, class_tag, *tag_ptr)) return JVMTI_ITERATION_CONTINUE;
 
-    jlong walk_tag = *(const jlong*) user_data;
-    if (*tag_ptr == walk_tag) {
+    if (*tag_ptr == ctx->walk_tag) {
         return JVMTI_ITERATION_CONTINUE;
     }
 
-    *tag_ptr = walk_tag;
+    *tag_ptr = ctx->walk_tag;
+    ctx->progress.tagged++;
     return JVMTI_ITERATION_CONTINUE;
 }
 
 /**
- * Resolves every object carrying the given per-walk tag into a Java Object[].
+ * Resolves every object carrying one of the given per-walk tags (all of one epoch) into a Java
+ * Object[].
  *
- * One GetObjectsWithTags(count=1) call — O(heap), not O(heap * tags). Returns NULL
- * on error or when nothing matched. Deallocates all JVMTI-owned buffers.
+ * One GetObjectsWithTags call — one scan of the tag map, not one per tag; each entry is compared
+ * with every tag, so n_tags stays small. Returns NULL on error or when nothing matched.
+ * Deallocates all JVMTI-owned buffers. With untag set, each resolved object's tag is cleared,
+ * removing it from the tag map so later lookups scan fewer entries; with index_base >= 0 as
+ * well, the object at position i is retagged WALK_INDEX_TAG(epoch of the tags, index_base + i)
+ * instead (see "Walk index").
  */
-static jobjectArray resolve_walk_tag(JNIEnv* env, jlong walk_tag) {
+static jobjectArray resolve_walk_tags(JNIEnv* env, jvmtiEnv* jvmti, const jlong* walk_tags, jint n_tags,
+                                      int untag, jlong index_base) {
     jint found = 0;
     jobject* objects = NULL;
     jlong* tagsOut = NULL;
 
-    jvmtiError err = (*g_jvmti)->GetObjectsWithTags(
-            g_jvmti, 1, &walk_tag, &found, &objects, &tagsOut);
+    jlong start = op_now();
+    jvmtiError err = (*jvmti)->GetObjectsWithTags(
+            jvmti, n_tags, walk_tags, &found, &objects, &tagsOut);
+    jlong safepoint = op_now() - start;
     if (err != JVMTI_ERROR_NONE) {
-        check_print(g_jvmti, err, "GetObjectsWithTags failed");
-        if (objects) (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) objects);
-        if (tagsOut) (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) tagsOut);
+        check_print(jvmti, err, "GetObjectsWithTags failed");
+        if (objects) (*jvmti)->Deallocate(jvmti, (unsigned char*) objects);
+        if (tagsOut) (*jvmti)->Deallocate(jvmti, (unsigned char*) tagsOut);
+        op_record(OP_RESOLVE, start, safepoint);
         return NULL;
     }
 
@@ -134,18 +619,70 @@ static jobjectArray resolve_walk_tag(JNIEnv* env, jlong walk_tag) {
             if (result != NULL) {
                 (*env)->SetObjectArrayElement(env, result, i, o);
             }
+            if (o && untag) {
+                jlong index = index_base >= 0 ? index_base + i : -1;
+                (*jvmti)->SetTag(jvmti, o, index >= 0 && index <= WALK_INDEX_MAX
+                                           ? WALK_INDEX_TAG((uint64_t) walk_tags[0] >> 32, index) : 0);
+            }
             if (o) (*env)->DeleteLocalRef(env, o);
         }
     }
 
     if (objects) {
-        jvmtiError derr = (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) objects);
-        check_print(g_jvmti, derr, "Deallocate(objects) failed");
+        jvmtiError derr = (*jvmti)->Deallocate(jvmti, (unsigned char*) objects);
+        check_print(jvmti, derr, "Deallocate(objects) failed");
     }
     if (tagsOut) {
-        jvmtiError derr = (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) tagsOut);
-        check_print(g_jvmti, derr, "Deallocate(tagsOut) failed");
+        jvmtiError derr = (*jvmti)->Deallocate(jvmti, (unsigned char*) tagsOut);
+        check_print(jvmti, derr, "Deallocate(tagsOut) failed");
+    }
+    op_record(OP_RESOLVE, start, safepoint);
+    return result;
+}
+
+/** resolve_walk_tags over a single tag. */
+static jobjectArray resolve_walk_tag(JNIEnv* env, jvmtiEnv* jvmti, jlong walk_tag, int untag,
+                                     jlong index_base) {
+    return resolve_walk_tags(env, jvmti, &walk_tag, 1, untag, index_base);
+}
+
+/**
+ * Runs one IterateThroughHeap tagging every reported object (restricted to klass, if non-NULL)
+ * with a fresh walk tag, and resolves them. With a non-NULL leafArray, instances of the primitive
+ * array classes and of the leaf classes are skipped; with reachable set, only objects reachable
+ * from the heap roots, or from initial if non-NULL, are reported (see "Reachable walks"). Throws
+ * CancellationException if the walk is cancelled.
+ */
+static jobjectArray tag_and_resolve(JNIEnv* env, jclass klass, jobjectArray leafArray, int reachable,
+                                    jobject initial, const char* walk) {
+    jlong start = op_now();
+    jvmtiEnv* jvmti = walk_env_open();
+    tag_walk_ctx ctx;
+    jlong epoch = __sync_add_and_fetch(&g_epoch, 1);
+    ctx.walk_tag = WALK_TAG(epoch);
+    ctx.leaf_mark = 0;
+    if (leafArray != NULL) {
+        ctx.leaf_mark = LEAF_MARK_TAG(epoch);
+        mark_leaf_classes(env, jvmti, leafArray, ctx.leaf_mark);
+    }
+    progress_begin(&ctx.progress, epoch);
+
+    jlong iterStart = op_now();
+    jvmtiError err = iterate_heap(jvmti, reachable, initial, HEAP_FILTER_NONE, klass, &heap_tagging_cb, &ctx);
+    op_record(OP_TAG, start, op_now() - iterStart);
+    int cancelled = progress_end(&ctx.progress);
+    if (err != JVMTI_ERROR_NONE || cancelled) {
+        if (cancelled) {
+            throw_cancelled(env, walk);
+        } else {
+            check_print(jvmti, err, walk);
+        }
+        walk_env_close(jvmti);
+        return NULL;
     }
+
+    jobjectArray result = resolve_walk_tag(env, jvmti, ctx.walk_tag, 0, -1);
+    walk_env_close(jvmti);
     return result;
 }
 
@@ -167,142 +704,4306 @@ Java_migrator_heap_NativeHeapWalker_nativeSnapshotObjects(
     (void) cls;
 
     if (!g_jvmti || !env || !targetClass) return NULL;
-
-    /* Fresh epoch -> fresh per-walk tag (avoids an O(heap) clear of old tags). */
-    jlong walk_tag = WALK_TAG(__sync_add_and_fetch(&g_epoch, 1));
-
-    jvmtiHeapCallbacks callbacks;
-    memset(&callbacks, 0, sizeof(callbacks));
-    callbacks.heap_iteration_callback = &heap_tagging_cb;
-
-    jvmtiError err = (*g_jvmti)->IterateThroughHeap(
-            g_jvmti, HEAP_FILTER_NONE, targetClass, &callbacks, &walk_tag);
-    if (err != JVMTI_ERROR_NONE) {
-        check_print(g_jvmti, err, "IterateThroughHeap(snapshotObjects) failed");
-        return NULL;
-    }
-
-    return resolve_walk_tag(env, walk_tag);
+    return tag_and_resolve(env, targetClass, NULL, 0, NULL, "IterateThroughHeap(snapshotObjects)");
 }
 
 /**
  * Walks the entire heap and returns all objects.
  *
+ * @param leafArray NULL to return every object; otherwise instances of the primitive array
+ *                  classes and of these classes are skipped (see "Leaf filtering")
+ * @param reachable JNI_TRUE to return only the objects reachable from the heap roots (see
+ *                  "Reachable walks")
  * @return Array of all objects on the heap, or NULL on error
  */
 JNIEXPORT jobjectArray JNICALL
-Java_migrator_heap_NativeHeapWalker_nativeWalkHeap(JNIEnv *env, jobject thisObj) {
+Java_migrator_heap_NativeHeapWalker_nativeWalkHeap(JNIEnv *env, jobject thisObj, jobjectArray leafArray,
+                                                   jboolean reachable) {
     (void) thisObj;
 
     if (!g_jvmti || !env) return NULL;
-
-    jlong walk_tag = WALK_TAG(__sync_add_and_fetch(&g_epoch, 1));
-
-    jvmtiHeapCallbacks callbacks;
-    memset(&callbacks, 0, sizeof(callbacks));
-    callbacks.heap_iteration_callback = &heap_tagging_cb;
-
-    jvmtiError err = (*g_jvmti)->IterateThroughHeap(
-            g_jvmti, HEAP_FILTER_NONE, NULL, &callbacks, &walk_tag);
-    if (err != JVMTI_ERROR_NONE) {
-        check_print(g_jvmti, err, "IterateThroughHeap(nativeWalkHeap) failed");
-        return NULL;
-    }
-
-    return resolve_walk_tag(env, walk_tag);
+    return tag_and_resolve(env, NULL, leafArray, reachable == JNI_TRUE, NULL,
+                           reachable == JNI_TRUE ? "FollowReferences(nativeWalkHeap)"
+                                                 : "IterateThroughHeap(nativeWalkHeap)");
 }
 
 /**
- * Walks the heap filtered by specific classes.
+ * Returns the objects reachable from the given roots through instance fields and array elements,
+ * the roots included (see "Reachable walks").
  *
- * All target classes are tagged within a single walk using the shared per-walk tag,
- * then resolved in one GetObjectsWithTags(count=1) call. Classes are passed as jclass
- * objects resolved by the Java caller, so they are found regardless of classloader.
- *
- * @param classesArray Array of target classes
- * @return Array of objects matching the specified classes, or NULL on error
+ * @param rootsArray the roots; the walk starts at this array, which is itself not returned
+ * @param leafArray  NULL to return every object reached; otherwise instances of the primitive
+ *                   array classes and of these classes are skipped (see "Leaf filtering")
+ * @return Array of the objects reached, or NULL on error/empty
  */
 JNIEXPORT jobjectArray JNICALL
-Java_migrator_heap_NativeHeapWalker_nativeWalkHeapFiltered(
-    JNIEnv *env, jobject thisObj, jobjectArray classesArray) {
+Java_migrator_heap_NativeHeapWalker_nativeWalkFrom(JNIEnv *env, jclass cls, jobjectArray rootsArray,
+                                                   jobjectArray leafArray) {
+    (void) cls;
 
-    (void) thisObj;
+    if (!g_jvmti || !env || rootsArray == NULL) return NULL;
+    return tag_and_resolve(env, NULL, leafArray, 1, rootsArray, "FollowReferences(nativeWalkFrom)");
+}
 
-    if (!g_jvmti || !env || classesArray == NULL) return NULL;
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Multi-class walks
+ * ---------------------------------------------------------------------------------------------
+ *
+ * The target classes' java.lang.Class mirrors are tagged with CLASS_MARK_TAG(epoch, i), then ONE
+ * IterateThroughHeap pass with JVMTI_HEAP_FILTER_CLASS_UNTAGGED reports only objects whose class
+ * carries a tag; the callback keeps those whose class tag belongs to this walk. The walk cost is
+ * therefore one heap pass regardless of how many classes are requested. Matching is on the exact
+ * class, as with IterateThroughHeap's klass filter.
+ */
 
-    jsize nClasses = (*env)->GetArrayLength(env, classesArray);
-    if (nClasses == 0) return NULL;
+/** Low-32-bit flag of a target-class mark within a multi-class walk. */
+#define CLASS_MARK_FLAG 0x40000000ULL
 
-    jlong walk_tag = WALK_TAG(__sync_add_and_fetch(&g_epoch, 1));
+/** Largest class index whose mark (index + 1) and member tag (index + 2) stay below CLASS_MARK_FLAG. */
+#define CLASS_MAX_INDEX 0x3FFFFFFD
 
-    jvmtiHeapCallbacks callbacks;
-    memset(&callbacks, 0, sizeof(callbacks));
-    callbacks.heap_iteration_callback = &heap_tagging_cb;
+#define CLASS_MARK_TAG(epoch, i) \
+    ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | CLASS_MARK_FLAG | (uint64_t)((uint32_t)(i) + 1U)))
 
-    for (jsize ci = 0; ci < nClasses; ci++) {
-        jclass targetClass = (jclass)(*env)->GetObjectArrayElement(env, classesArray, ci);
-        if (targetClass == NULL) continue;
+/** Tag of an instance of target class i in a partitioned walk (no flag: distinct from the mark). */
+#define CLASS_MEMBER_TAG(epoch, i) \
+    ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | (uint64_t)((uint32_t)(i) + 2U)))
 
-        /* Tag instances of this class with the shared per-walk tag. The tag check in
-         * heap_tagging_cb makes a re-tag a no-op when an object matches several target
-         * classes (e.g. via inheritance). */
-        jvmtiError err = (*g_jvmti)->IterateThroughHeap(g_jvmti, HEAP_FILTER_NONE,
-                                                         targetClass, &callbacks, &walk_tag);
-        if (err != JVMTI_ERROR_NONE) {
-            check_print(g_jvmti, err, "IterateThroughHeap failed for class");
-        }
+/** Tag of the matches in chunk c of a chunked walk (no flag: distinct from the class marks). */
+#define CHUNK_TAG(epoch, c) \
+    ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | (uint64_t)((uint32_t)(c) + 1U)))
 
-        (*env)->DeleteLocalRef(env, targetClass);
+/** Last chunk index; matches beyond it share the last chunk rather than reach CLASS_MARK_FLAG. */
+#define CHUNK_MAX_INDEX CLASS_MAX_INDEX
+
+/** Derived chunking (see "Chunked walks"): slices per size, first slice size, target chunk count. */
+#define CHUNK_SLICE_RUN     4
+#define CHUNK_SLICE_BASE    (1 << 14)
+#define CHUNK_DERIVED_COUNT 8
+#define CHUNK_SLICE_MAX     (1 << 30)
+
+/** Per-walk state shared with class_filter_cb / chunk_tagging_cb through IterateThroughHeap's user_data. */
+typedef struct {
+    uint32_t epoch;
+    jlong shared_tag;   /* tag every match with this value, or 0 to partition by class index */
+    jint chunk_size;    /* > 0 (with shared_tag 0): tag matches by chunk instead of by class */
+    int grow;           /* chunked walk: 1 if slices grow (derived chunks), 0 for chunk_size each */
+    jlong slice;        /* chunked walk: index of the slice being filled */
+    jlong slice_fill;   /* chunked walk: matches in that slice so far */
+    jlong slice_size;   /* chunked walk: its size */
+    jlong matched;      /* matches tagged so far in a chunked walk */
+    jlong leaf_mark;    /* full chunked walk: skip objects of classes carrying this mark (0: none) */
+    walk_progress progress;
+} class_walk_ctx;
+
+/** Size of slice s of a chunked walk whose first slice holds base matches. */
+static jlong chunk_slice_size(jlong base, int grow, jlong s) {
+    jlong size = base;
+    if (grow) {
+        for (jlong level = s / CHUNK_SLICE_RUN; level > 0 && size <= CHUNK_SLICE_MAX / 2; level--) size *= 2;
     }
+    return size;
+}
 
-    return resolve_walk_tag(env, walk_tag);
+/** Tag for the next match of a chunked walk: consecutive runs of a slice's size share one chunk tag. */
+static jlong next_chunk_tag(class_walk_ctx* ctx) {
+    if (ctx->slice_fill == ctx->slice_size) {
+        ctx->slice++;
+        ctx->slice_fill = 0;
+        ctx->slice_size = chunk_slice_size(ctx->chunk_size, ctx->grow, ctx->slice);
+    }
+    ctx->slice_fill++;
+    ctx->matched++;
+    jlong chunk = ctx->slice > CHUNK_MAX_INDEX ? CHUNK_MAX_INDEX : ctx->slice;
+    return CHUNK_TAG(ctx->epoch, chunk);
 }
 
 /**
- * Advances the epoch counter.
- * Called after migration completes to invalidate old tags.
+ * JVMTI heap_iteration_callback for a multi-class walk. Objects whose class carries this walk's
+ * class mark are tagged: with the shared walk tag, with their chunk for a chunked walk, or with
+ * their class index for a partitioned walk. A target class's own mirror is never re-tagged (when java.lang.Class itself is a target),
+ * so its mark stays intact for the rest of the walk.
  */
-JNIEXPORT void JNICALL
-Java_migrator_heap_NativeHeapWalker_nativeAdvanceEpoch(
-        JNIEnv* env,
-        jclass cls) {
-    (void) env;
-    (void) cls;
-    __sync_fetch_and_add(&g_epoch, 1);
+static jint JNICALL class_filter_cb(
+        jlong class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jint length,
+        void* user_data) {
+
+    (void) size;
+    (void) length;
+
+    class_walk_ctx* ctx = (class_walk_ctx*) user_data;
+    if (!ctx || !tag_ptr) return JVMTI_ITERATION_CONTINUE;
+    if (progress_visit(&ctx->progress)) return JVMTI_VISIT_ABORT;
+
+    uint64_t ct = (uint64_t) class_tag;
+    if ((uint32_t)(ct >> 32) != ctx->epoch || (ct & CLASS_MARK_FLAG) == 0) {
+        return JVMTI_ITERATION_CONTINUE;
+    }
+    uint64_t own = (uint64_t) *tag_ptr;
+    if ((uint32_t)(own >> 32) == ctx->epoch && (own & CLASS_MARK_FLAG) != 0) {
+        return JVMTI_ITERATION_CONTINUE;
+    }
+
+    if (ctx->shared_tag != 0) {
+        *tag_ptr = ctx->shared_tag;
+    } else if (ctx->chunk_size > 0) {
+        *tag_ptr = next_chunk_tag(ctx);
+    } else {
+        uint32_t index = ((uint32_t) ct & ~(uint32_t) CLASS_MARK_FLAG) - 1U;
+        *tag_ptr = CLASS_MEMBER_TAG(ctx->epoch, index);
+    }
+    ctx->progress.tagged++;
+    return JVMTI_ITERATION_CONTINUE;
 }
 
 /**
- * Initializes the agent by obtaining JVMTI environment and requesting capabilities.
+ * Tags each non-null class in classesArray with its class mark and runs the single filtered
+ * walk, over the reachable objects only if reachable is set: those reachable from the heap
+ * roots, or from initial if non-NULL. Returns 0 on success, -1 if the walk failed or was
+ * cancelled (CancellationException pending).
  */
-static jint agent_start(JavaVM* vm) {
-    if (!vm) return JNI_ERR;
-    g_vm = vm;
-
-    jint getenv_res = (*vm)->GetEnv(vm, (void**)&g_jvmti, JVMTI_VERSION_1_2);
-    if (getenv_res != JNI_OK || g_jvmti == NULL) {
-        fprintf(stderr, "[agent] Failed to get JVMTI env\n");
-        return JNI_ERR;
+static int walk_marked_classes(JNIEnv* env, jvmtiEnv* jvmti, jobjectArray classesArray, jsize nClasses,
+                               int reachable, jobject initial, class_walk_ctx* ctx) {
+    jlong start = op_now();
+    for (jsize ci = 0; ci < nClasses; ci++) {
+        jclass targetClass = (jclass)(*env)->GetObjectArrayElement(env, classesArray, ci);
+        if (targetClass == NULL) continue;
+        jvmtiError terr = (*jvmti)->SetTag(jvmti, targetClass, CLASS_MARK_TAG(ctx->epoch, ci));
+        check_print(jvmti, terr, "SetTag(target class) failed");
+        (*env)->DeleteLocalRef(env, targetClass);
     }
 
-    jvmtiCapabilities caps;
-    memset(&caps, 0, sizeof(caps));
-    caps.can_tag_objects = 1;
-    jvmtiError err = (*g_jvmti)->AddCapabilities(g_jvmti, &caps);
+    jlong iterStart = op_now();
+    jvmtiError err = iterate_heap(jvmti, reachable, initial, JVMTI_HEAP_FILTER_CLASS_UNTAGGED, NULL,
+                                  &class_filter_cb, ctx);
+    op_record(OP_TAG, start, op_now() - iterStart);
+    if (progress_end(&ctx->progress)) {
+        throw_cancelled(env, reachable ? "FollowReferences(multi-class)" : "IterateThroughHeap(multi-class)");
+        return -1;
+    }
     if (err != JVMTI_ERROR_NONE) {
-        check_print(g_jvmti, err, "AddCapabilities failed");
-        return JNI_ERR;
+        check_print(jvmti, err, reachable ? "FollowReferences(multi-class) failed"
+                                          : "IterateThroughHeap(multi-class) failed");
+        return -1;
     }
-
-    return JNI_OK;
+    return 0;
 }
 
 /**
- * Agent entry point for JVM startup (-agentpath).
- */
-JNIEXPORT jint JNICALL Agent_OnLoad(JavaVM* vm, char* options, void* reserved) {
-    (void) options;
-    (void) reserved;
-    return agent_start(vm);
+ * Walks the heap filtered by specific classes.
+ *
+ * All target classes are matched within a single heap pass (see "Multi-class walks") and every
+ * match gets the shared per-walk tag, resolved in one GetObjectsWithTags(count=1) call. Classes
+ * are passed as jclass objects resolved by the Java caller, so they are found regardless of
+ * classloader.
+ *
+ * @param classesArray Array of target classes
+ * @return Array of objects matching the specified classes, or NULL on error
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeWalkHeapFiltered(
+    JNIEnv *env, jobject thisObj, jobjectArray classesArray) {
+
+    (void) thisObj;
+
+    if (!g_jvmti || !env || classesArray == NULL) return NULL;
+
+    jsize nClasses = (*env)->GetArrayLength(env, classesArray);
+    if (nClasses == 0 || nClasses > CLASS_MAX_INDEX) return NULL;
+
+    class_walk_ctx ctx;
+    ctx.epoch = (uint32_t) __sync_add_and_fetch(&g_epoch, 1);
+    ctx.shared_tag = WALK_TAG(ctx.epoch);
+    ctx.chunk_size = 0;
+    ctx.matched = 0;
+    ctx.leaf_mark = 0;
+    progress_begin(&ctx.progress, ctx.epoch);
+
+    jvmtiEnv* jvmti = walk_env_open();
+    jobjectArray result = NULL;
+    if (walk_marked_classes(env, jvmti, classesArray, nClasses, 0, NULL, &ctx) == 0) {
+        result = resolve_walk_tag(env, jvmti, ctx.shared_tag, 0, -1);
+    }
+    walk_env_close(jvmti);
+    return result;
+}
+
+/**
+ * Resolves the objects tagged CLASS_MEMBER_TAG(epoch, 0 .. nClasses-1) with a single
+ * GetObjectsWithTags call over the nClasses member tags; the returned tag of each object selects
+ * its partition. GetObjectsWithTags compares every tag-map entry against each requested tag, so
+ * this costs O(tag map * classes).
+ *
+ * @return Object[nClasses][] (never a null partition), or NULL on error
+ */
+static jobjectArray resolve_partitions(JNIEnv* env, jvmtiEnv* jvmti, uint32_t epoch, jsize nClasses) {
+    jlong* wanted = (jlong*) malloc((size_t) nClasses * sizeof(jlong));
+    jint* counts = (jint*) calloc((size_t) nClasses, sizeof(jint));
+    if (!wanted || !counts) {
+        free(wanted);
+        free(counts);
+        return NULL;
+    }
+    for (jsize i = 0; i < nClasses; i++) wanted[i] = CLASS_MEMBER_TAG(epoch, i);
+
+    jint found = 0;
+    jobject* objects = NULL;
+    jlong* tagsOut = NULL;
+    jlong start = op_now();
+    jvmtiError err = (*jvmti)->GetObjectsWithTags(
+            jvmti, nClasses, wanted, &found, &objects, &tagsOut);
+    jlong safepoint = op_now() - start;
+    free(wanted);
+    if (err != JVMTI_ERROR_NONE) {
+        check_print(jvmti, err, "GetObjectsWithTags(partitioned) failed");
+        if (objects) (*jvmti)->Deallocate(jvmti, (unsigned char*) objects);
+        if (tagsOut) (*jvmti)->Deallocate(jvmti, (unsigned char*) tagsOut);
+        free(counts);
+        op_record(OP_RESOLVE, start, safepoint);
+        return NULL;
+    }
+
+    if ((*env)->EnsureLocalCapacity(env, found + nClasses + 16) != 0) {
+        if ((*env)->ExceptionCheck(env)) (*env)->ExceptionClear(env);
+    }
+
+    /* member tag low word = index + 2 (see CLASS_MEMBER_TAG) */
+    for (jint i = 0; i < found; i++) {
+        jint index = (jint)((uint32_t) tagsOut[i]) - 2;
+        if (index >= 0 && index < nClasses) counts[index]++;
+    }
+
+    jobjectArray result = NULL;
+    jobjectArray* partitions = (jobjectArray*) calloc((size_t) nClasses, sizeof(jobjectArray));
+    jint* filled = (jint*) calloc((size_t) nClasses, sizeof(jint));
+    jclass objClass = (*env)->FindClass(env, "java/lang/Object");
+    jclass arrClass = (*env)->FindClass(env, "[Ljava/lang/Object;");
+    if (partitions && filled && objClass && arrClass) {
+        result = (*env)->NewObjectArray(env, nClasses, arrClass, NULL);
+        for (jsize c = 0; result != NULL && c < nClasses; c++) {
+            partitions[c] = (*env)->NewObjectArray(env, counts[c], objClass, NULL);
+            if (partitions[c] == NULL) {
+                result = NULL;
+                break;
+            }
+            (*env)->SetObjectArrayElement(env, result, c, partitions[c]);
+        }
+    }
+
+    for (jint i = 0; i < found; i++) {
+        jobject o = objects[i];
+        jint index = (jint)((uint32_t) tagsOut[i]) - 2;
+        if (result != NULL && index >= 0 && index < nClasses) {
+            (*env)->SetObjectArrayElement(env, partitions[index], filled[index]++, o);
+        }
+        if (o) (*env)->DeleteLocalRef(env, o);
+    }
+
+    if (partitions) {
+        for (jsize c = 0; c < nClasses; c++) {
+            if (partitions[c]) (*env)->DeleteLocalRef(env, partitions[c]);
+        }
+    }
+    if (objClass) (*env)->DeleteLocalRef(env, objClass);
+    if (arrClass) (*env)->DeleteLocalRef(env, arrClass);
+    free(partitions);
+    free(filled);
+    free(counts);
+
+    if (objects) {
+        jvmtiError derr = (*jvmti)->Deallocate(jvmti, (unsigned char*) objects);
+        check_print(jvmti, derr, "Deallocate(objects) failed");
+    }
+    if (tagsOut) {
+        jvmtiError derr = (*jvmti)->Deallocate(jvmti, (unsigned char*) tagsOut);
+        check_print(jvmti, derr, "Deallocate(tagsOut) failed");
+    }
+    op_record(OP_RESOLVE, start, safepoint);
+    return result;
+}
+
+/**
+ * Snapshot of the instances of several classes from ONE heap walk, partitioned by class.
+ *
+ * Instances are tagged with their class's index in classesArray, then resolved in one call (see
+ * resolve_partitions). That costs O(tag map * classes) — fine for the handful of migrator source
+ * classes it is meant for, but not a substitute for the shared-tag walks when the class count is
+ * large.
+ *
+ * @param classesArray the classes to snapshot (null elements yield an empty partition)
+ * @param reachable    JNI_TRUE to snapshot only the instances reachable from the heap roots (see
+ *                     "Reachable walks")
+ * @return Object[nClasses][] with the instances of classesArray[i] at index i (never a null
+ *         partition), or NULL on error
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeSnapshotPartitioned(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray classesArray,
+        jboolean reachable) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env || classesArray == NULL) return NULL;
+
+    jsize nClasses = (*env)->GetArrayLength(env, classesArray);
+    if (nClasses == 0 || nClasses > CLASS_MAX_INDEX) return NULL;
+
+    class_walk_ctx ctx;
+    ctx.epoch = (uint32_t) __sync_add_and_fetch(&g_epoch, 1);
+    ctx.shared_tag = 0;
+    ctx.chunk_size = 0;
+    ctx.matched = 0;
+    ctx.leaf_mark = 0;
+    progress_begin(&ctx.progress, ctx.epoch);
+
+    jvmtiEnv* jvmti = walk_env_open();
+    jobjectArray result = NULL;
+    if (walk_marked_classes(env, jvmti, classesArray, nClasses, reachable == JNI_TRUE, NULL, &ctx) == 0) {
+        result = resolve_partitions(env, jvmti, ctx.epoch, nClasses);
+    }
+    walk_env_close(jvmti);
+    return result;
+}
+
+/**
+ * Snapshot of the instances of several classes reachable from the given roots through instance
+ * fields and array elements, from ONE walk, partitioned by class as for nativeSnapshotPartitioned.
+ *
+ * @param rootsArray   the roots (see "Reachable walks"); a root that is an instance of a class
+ *                     is part of its partition
+ * @param classesArray the classes to snapshot (null elements yield an empty partition)
+ * @return Object[nClasses][] with the instances of classesArray[i] at index i (never a null
+ *         partition), or NULL on error
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeSnapshotPartitionedFrom(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray rootsArray,
+        jobjectArray classesArray) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env || rootsArray == NULL || classesArray == NULL) return NULL;
+
+    jsize nClasses = (*env)->GetArrayLength(env, classesArray);
+    if (nClasses == 0 || nClasses > CLASS_MAX_INDEX) return NULL;
+
+    class_walk_ctx ctx;
+    ctx.epoch = (uint32_t) __sync_add_and_fetch(&g_epoch, 1);
+    ctx.shared_tag = 0;
+    ctx.chunk_size = 0;
+    ctx.matched = 0;
+    ctx.leaf_mark = 0;
+    progress_begin(&ctx.progress, ctx.epoch);
+
+    jvmtiEnv* jvmti = walk_env_open();
+    jobjectArray result = NULL;
+    if (walk_marked_classes(env, jvmti, classesArray, nClasses, 1, rootsArray, &ctx) == 0) {
+        result = resolve_partitions(env, jvmti, ctx.epoch, nClasses);
+    }
+    walk_env_close(jvmti);
+    return result;
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Chunked walks
+ * ---------------------------------------------------------------------------------------------
+ *
+ * A single-tag walk resolves every match at once: GetObjectsWithTags hands back one JNI local
+ * reference per match and the result is one Object[] of them all, so a full walk of a 30M-object
+ * heap needs 30M local refs and a 30M-slot array at the same moment. A chunked walk instead tags
+ * consecutive runs of chunk_size matches with CHUNK_TAG(epoch, c) during the one heap pass, and
+ * the Java side resolves the chunks one call at a time, so each resolve is bounded by chunk_size.
+ *
+ * The walk's tagging environment outlives the call that tags it, so its handle travels to the
+ * Java side with the epoch and comes back with each resolve. Each resolve is one
+ * GetObjectsWithTags over that environment's tag map, so a walk of k chunks scans the map k
+ * times; resolved objects are untagged, which shrinks the map as the walk proceeds. A fixed
+ * chunk size on a large heap therefore costs many scans.
+ *
+ * Derived chunks keep k constant instead. The pass cannot know how many objects it will match,
+ * so it tags slices rather than chunks: CHUNK_SLICE_RUN slices of CHUNK_SLICE_BASE matches, then
+ * CHUNK_SLICE_RUN of twice that, and so on, a number of slices logarithmic in the matches. Once
+ * the count is known, consecutive slices are grouped into at most CHUNK_DERIVED_COUNT + 1 chunks
+ * of about count / CHUNK_DERIVED_COUNT matches each, and each chunk is resolved by one
+ * GetObjectsWithTags over the tags of its slices. A slice past the first run holds at most a
+ * quarter of the matches tagged before it, so a chunk overshoots its share by at most a quarter
+ * of the walk. The first chunk names the most tags, CHUNK_SLICE_RUN per doubling of its share
+ * over CHUNK_SLICE_BASE (about two dozen for a share of millions).
+ *
+ * Walk index: a resolve with an index base retags its objects WALK_INDEX_TAG(epoch, base + i)
+ * rather than clearing them, so every object the walk has delivered keeps a dense index until
+ * the walk ends, and nativeWalkIndexOf reads it back with one GetTag. A visited set keyed by that
+ * index needs one bit per delivered object instead of a Java-heap entry (the patcher's
+ * BitmapVisitedSet). The retained index tags keep the tag map at the walk's size, so the
+ * resolves of an indexed walk do not get cheaper as it proceeds.
+ */
+
+/**
+ * JVMTI heap_iteration_callback for a full chunked walk: every object but the skipped leaves
+ * gets its chunk's tag.
+ */
+static jint JNICALL chunk_tagging_cb(
+        jlong class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jint length,
+        void* user_data) {
+
+    (void) size;
+    (void) length;
+
+    class_walk_ctx* ctx = (class_walk_ctx*) user_data;
+    if (!ctx || !tag_ptr) return JVMTI_ITERATION_CONTINUE;
+    if (progress_visit(&ctx->progress)) return JVMTI_VISIT_ABORT;
+    if (is_leaf(ctx->leaf_mark, class_tag, *tag_ptr)) return JVMTI_ITERATION_CONTINUE;
+
+    *tag_ptr = next_chunk_tag(ctx);
+    ctx->progress.tagged++;
+    return JVMTI_ITERATION_CONTINUE;
+}
+
+/**
+ * Groups the slices of a derived chunked walk into chunks of about matched / CHUNK_DERIVED_COUNT
+ * matches: starts[c] receives the first slice of chunk c and starts[chunks] one past the last.
+ * Every chunk but the last reaches its share, so there are at most max_chunks. Returns the number
+ * of chunks.
+ */
+static jint group_chunk_slices(jlong matched, jlong n_slices, jint* starts, jint max_chunks) {
+    jlong share = (matched + CHUNK_DERIVED_COUNT - 1) / CHUNK_DERIVED_COUNT;
+    jint chunks = 0;
+    jlong filled = 0;
+    starts[0] = 0;
+    for (jlong s = 0; s < n_slices; s++) {
+        filled += chunk_slice_size(CHUNK_SLICE_BASE, 1, s);
+        if (s == n_slices - 1 || (filled >= share && chunks < max_chunks - 1)) {
+            starts[++chunks] = (jint)(s + 1);
+            filled = 0;
+        }
+    }
+    return chunks;
+}
+
+/**
+ * Tags the matches of a full (classesArray NULL) or filtered walk in chunks, in one heap pass:
+ * of chunkSize matches each, or with chunkSize 0 of a size derived from the number of matches
+ * (see "Chunked walks"). The chunks are then resolved by nativeResolveChunk over the slices of
+ * chunk 0 .. n-1, and the walk's tagging environment must be released with
+ * nativeEndChunks(walkEnv) afterwards, whether or not every chunk was resolved.
+ *
+ * @param classesArray the classes to match (see "Multi-class walks"), or NULL for every object
+ * @param leafArray    for a full walk, NULL to match every object; otherwise instances of the
+ *                     primitive array classes and of these classes are skipped (see "Leaf
+ *                     filtering"). Ignored by a filtered walk.
+ * @param reachable    JNI_TRUE to match only objects reachable from the heap roots (see
+ *                     "Reachable walks")
+ * @param chunkSize    matches per chunk (> 0), one slice each; or 0 to derive chunks from the
+ *                     number of matches
+ * @param walkOut      long[3] receiving the walk's epoch, its tagging environment handle and the
+ *                     number of matches
+ * @param chunkStarts  with chunkSize 0, int[CHUNK_DERIVED_COUNT + 2] receiving the first slice of
+ *                     each chunk and, after the last chunk, the number of slices; otherwise
+ *                     ignored (chunk c is slice c)
+ * @return the number of chunks (0 when nothing matched), or -1 on error (nothing to release)
+ */
+JNIEXPORT jint JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeTagChunks(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray classesArray,
+        jobjectArray leafArray,
+        jboolean reachable,
+        jint chunkSize,
+        jlongArray walkOut,
+        jintArray chunkStarts) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env || chunkSize < 0 || walkOut == NULL) return -1;
+    if ((*env)->GetArrayLength(env, walkOut) < 3) return -1;
+    int derived = chunkSize == 0;
+    if (derived && (chunkStarts == NULL
+            || (*env)->GetArrayLength(env, chunkStarts) < CHUNK_DERIVED_COUNT + 2)) {
+        return -1;
+    }
+
+    jsize nClasses = classesArray != NULL ? (*env)->GetArrayLength(env, classesArray) : 0;
+    if (nClasses > CLASS_MAX_INDEX) return -1;
+
+    class_walk_ctx ctx;
+    ctx.epoch = (uint32_t) __sync_add_and_fetch(&g_epoch, 1);
+    ctx.shared_tag = 0;
+    ctx.chunk_size = derived ? CHUNK_SLICE_BASE : chunkSize;
+    ctx.grow = derived;
+    ctx.slice = 0;
+    ctx.slice_fill = 0;
+    ctx.slice_size = ctx.chunk_size;
+    ctx.matched = 0;
+    ctx.leaf_mark = 0;
+    progress_begin(&ctx.progress, ctx.epoch);
+
+    jvmtiEnv* jvmti = walk_env_open();
+    if (classesArray != NULL) {
+        if (nClasses == 0) {
+            progress_end(&ctx.progress);
+        } else if (walk_marked_classes(env, jvmti, classesArray, nClasses, reachable == JNI_TRUE, NULL, &ctx) != 0) {
+            walk_env_close(jvmti);
+            return -1;
+        }
+    } else {
+        jlong start = op_now();
+        if (leafArray != NULL) {
+            ctx.leaf_mark = LEAF_MARK_TAG(ctx.epoch);
+            mark_leaf_classes(env, jvmti, leafArray, ctx.leaf_mark);
+        }
+        jlong iterStart = op_now();
+        jvmtiError err = iterate_heap(jvmti, reachable == JNI_TRUE, NULL, HEAP_FILTER_NONE, NULL,
+                                      &chunk_tagging_cb, &ctx);
+        op_record(OP_TAG, start, op_now() - iterStart);
+        if (progress_end(&ctx.progress)) {
+            throw_cancelled(env, reachable == JNI_TRUE ? "FollowReferences(chunked)" : "IterateThroughHeap(chunked)");
+            walk_env_close(jvmti);
+            return -1;
+        }
+        if (err != JVMTI_ERROR_NONE) {
+            check_print(jvmti, err, reachable == JNI_TRUE ? "FollowReferences(chunked) failed"
+                                                          : "IterateThroughHeap(chunked) failed");
+            walk_env_close(jvmti);
+            return -1;
+        }
+    }
+
+    jlong walk[3] = { (jlong) ctx.epoch, (jlong)(intptr_t) jvmti, ctx.matched };
+    (*env)->SetLongArrayRegion(env, walkOut, 0, 3, walk);
+
+    if (ctx.matched == 0) return 0;
+    jlong slices = ctx.slice + 1 > CHUNK_MAX_INDEX + 1 ? CHUNK_MAX_INDEX + 1 : ctx.slice + 1;
+    if (!derived) return (jint) slices;
+    jint starts[CHUNK_DERIVED_COUNT + 2];
+    jint chunks = group_chunk_slices(ctx.matched, slices, starts, CHUNK_DERIVED_COUNT + 1);
+    (*env)->SetIntArrayRegion(env, chunkStarts, 0, chunks + 1, starts);
+    return chunks;
+}
+
+/**
+ * Resolves one chunk of a chunked walk, the slices [firstSlice, firstSlice + sliceCount), into
+ * an Object[] with one scan of the tag map, and clears the tags of its objects, or retags them
+ * with their dense walk index. Objects collected since the walk are simply missing, so a chunk
+ * may hold fewer than its slices were tagged with.
+ *
+ * @param walkEnv    the walk's tagging environment, as reported by nativeTagChunks
+ * @param epoch      the walk's epoch, as reported by nativeTagChunks
+ * @param firstSlice the chunk's first slice
+ * @param sliceCount the number of its slices (> 0)
+ * @param indexBase  the dense index of the chunk's first object, or -1 to clear the tags
+ * @return the chunk's objects, or NULL on error/empty
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeResolveChunk(
+        JNIEnv* env,
+        jclass cls,
+        jlong walkEnv,
+        jlong epoch,
+        jint firstSlice,
+        jint sliceCount,
+        jlong indexBase) {
+
+    (void) cls;
+
+    jvmtiEnv* jvmti = (jvmtiEnv*)(intptr_t) walkEnv;
+    if (!jvmti || !env || firstSlice < 0 || sliceCount <= 0
+            || (jlong) firstSlice + sliceCount - 1 > CHUNK_MAX_INDEX) {
+        return NULL;
+    }
+    jlong* tags = (jlong*) malloc((size_t) sliceCount * sizeof(jlong));
+    if (!tags) return NULL;
+    for (jint i = 0; i < sliceCount; i++) tags[i] = CHUNK_TAG(epoch, firstSlice + i);
+    jobjectArray result = resolve_walk_tags(env, jvmti, tags, sliceCount, 1, indexBase);
+    free(tags);
+    return result;
+}
+
+/**
+ * Reads the dense index of an object in an indexed chunked walk that has not ended yet.
+ *
+ * @param walkEnv the walk's tagging environment, as reported by nativeTagChunks
+ * @param epoch   the walk's epoch, as reported by nativeTagChunks
+ * @param obj     the object
+ * @return its index; -2 if the walk matched it but has not resolved its chunk yet; -1 if the
+ *         walk did not match it (or on error)
+ */
+JNIEXPORT jint JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeWalkIndexOf(
+        JNIEnv* env,
+        jclass cls,
+        jlong walkEnv,
+        jlong epoch,
+        jobject obj) {
+
+    (void) env;
+    (void) cls;
+
+    jvmtiEnv* jvmti = (jvmtiEnv*)(intptr_t) walkEnv;
+    jlong tag = 0;
+    if (!jvmti || obj == NULL || (*jvmti)->GetTag(jvmti, obj, &tag) != JVMTI_ERROR_NONE) return -1;
+    if ((uint32_t)((uint64_t) tag >> 32) != (uint32_t) epoch) return -1;
+    uint32_t low = (uint32_t) tag;
+    if (low & WALK_INDEX_FLAG) return (jint)(low & (uint32_t) WALK_INDEX_MAX);
+    return low >= 1U && low <= (uint32_t) CHUNK_MAX_INDEX + 1U ? -2 : -1;
+}
+
+/**
+ * Ends a chunked walk: disposes its tagging environment, dropping the tags of any chunk that
+ * was not resolved.
+ *
+ * @param walkEnv the walk's tagging environment, as reported by nativeTagChunks
+ */
+JNIEXPORT void JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeEndChunks(
+        JNIEnv* env,
+        jclass cls,
+        jlong walkEnv) {
+
+    (void) env;
+    (void) cls;
+    walk_env_close((jvmtiEnv*)(intptr_t) walkEnv);
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Visit marks
+ * ---------------------------------------------------------------------------------------------
+ *
+ * The visited set of a patch traversal can live in a tag map instead of the Java heap: a visit
+ * set is a scratch tagging environment of its own (see "Per-walk tagging environments"), and an
+ * object is visited once it carries VISIT_TAG(epoch). nativeVisitMark is one GetTag and, for a
+ * new object, one SetTag, so it costs a JNI call and two tag-map lookups per object instead of a
+ * Java-heap entry; nativeVisitClose disposes the environment and with it every mark at once. A
+ * set opened for concurrent markers makes the test-and-set atomic under a raw monitor of its
+ * own. There is no fallback to g_jvmti, whose marks would stay behind.
+ */
+
+/** The tag of a visited object in a visit set. */
+#define VISIT_TAG(epoch) ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | 3ULL))
+
+/**
+ * Opens a visit set.
+ *
+ * @param concurrent JNI_TRUE if several threads will mark concurrently
+ * @param visitOut   long[3] receiving the set's epoch, its tagging environment handle, and its
+ *                   raw monitor handle (0 when not concurrent)
+ * @return JNI_TRUE if opened; JNI_FALSE if no scratch environment is available (nothing to close)
+ */
+JNIEXPORT jboolean JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeVisitOpen(
+        JNIEnv* env,
+        jclass cls,
+        jboolean concurrent,
+        jlongArray visitOut) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env || visitOut == NULL || (*env)->GetArrayLength(env, visitOut) < 3) return JNI_FALSE;
+    jvmtiEnv* jvmti = walk_env_open();
+    if (jvmti == g_jvmti) return JNI_FALSE;
+
+    jrawMonitorID lock = NULL;
+    if (concurrent == JNI_TRUE) {
+        jvmtiError err = (*jvmti)->CreateRawMonitor(jvmti, "migrator-visit-marks", &lock);
+        if (err != JVMTI_ERROR_NONE) {
+            check_print(jvmti, err, "CreateRawMonitor(visit marks) failed");
+            walk_env_close(jvmti);
+            return JNI_FALSE;
+        }
+    }
+    jlong visit[3] = { (jlong)(uint32_t) __sync_add_and_fetch(&g_epoch, 1), (jlong)(intptr_t) jvmti,
+                       (jlong)(intptr_t) lock };
+    (*env)->SetLongArrayRegion(env, visitOut, 0, 3, visit);
+    return JNI_TRUE;
+}
+
+/**
+ * Marks an object visited.
+ *
+ * @param visitEnv the set's tagging environment, as reported by nativeVisitOpen
+ * @param epoch    the set's epoch, as reported by nativeVisitOpen
+ * @param lock     the set's raw monitor, as reported by nativeVisitOpen (0 for none)
+ * @param obj      the object
+ * @return JNI_TRUE if it was not marked before (and is now), JNI_FALSE if it was or on error
+ */
+JNIEXPORT jboolean JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeVisitMark(
+        JNIEnv* env,
+        jclass cls,
+        jlong visitEnv,
+        jlong epoch,
+        jlong lock,
+        jobject obj) {
+
+    (void) env;
+    (void) cls;
+
+    jvmtiEnv* jvmti = (jvmtiEnv*)(intptr_t) visitEnv;
+    if (!jvmti || obj == NULL) return JNI_FALSE;
+    jrawMonitorID monitor = (jrawMonitorID)(intptr_t) lock;
+    jlong mark = VISIT_TAG(epoch);
+    jlong tag = 0;
+
+    if (monitor) (*jvmti)->RawMonitorEnter(jvmti, monitor);
+    jboolean added = JNI_FALSE;
+    if ((*jvmti)->GetTag(jvmti, obj, &tag) == JVMTI_ERROR_NONE && tag != mark) {
+        added = (*jvmti)->SetTag(jvmti, obj, mark) == JVMTI_ERROR_NONE ? JNI_TRUE : JNI_FALSE;
+    }
+    if (monitor) (*jvmti)->RawMonitorExit(jvmti, monitor);
+    return added;
+}
+
+/**
+ * Closes a visit set: destroys its raw monitor and disposes its tagging environment, dropping
+ * every mark.
+ *
+ * @param visitEnv the set's tagging environment, as reported by nativeVisitOpen
+ * @param lock     the set's raw monitor, as reported by nativeVisitOpen (0 for none)
+ */
+JNIEXPORT void JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeVisitClose(
+        JNIEnv* env,
+        jclass cls,
+        jlong visitEnv,
+        jlong lock) {
+
+    (void) env;
+    (void) cls;
+
+    jvmtiEnv* jvmti = (jvmtiEnv*)(intptr_t) visitEnv;
+    if (!jvmti || jvmti == g_jvmti) return;
+    if (lock) (*jvmti)->DestroyRawMonitor(jvmti, (jrawMonitorID)(intptr_t) lock);
+    walk_env_close(jvmti);
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Heap census
+ * ---------------------------------------------------------------------------------------------
+ *
+ * The census classes' mirrors are marked as for a multi-class walk, and one IterateThroughHeap
+ * with JVMTI_HEAP_FILTER_CLASS_UNTAGGED adds each reported object's size (and, for arrays, its
+ * length bucket) to its class's counters. Nothing is tagged besides the mirrors and nothing is
+ * resolved, so the cost in JNI references and Java allocation is proportional to the number of
+ * classes, not to the heap.
+ */
+
+/** Array-length buckets per array class: 0 holds length 0, k holds lengths [2^(k-1), 2^k). */
+#define CENSUS_LENGTH_BUCKETS 32
+
+/** Per-walk state shared with census_cb through IterateThroughHeap's user_data. */
+typedef struct {
+    uint32_t epoch;
+    jint n_classes;
+    jlong* counts;       /* [n_classes] */
+    jlong* bytes;        /* [n_classes] */
+    jint* array_slot;    /* [n_classes]: row in buckets, or -1 for a non-array class */
+    jlong* buckets;      /* [n_arrays * CENSUS_LENGTH_BUCKETS] */
+    walk_progress progress;
+} census_ctx;
+
+/** Length bucket of an array of the given length (see CENSUS_LENGTH_BUCKETS). */
+static int length_bucket(jint length) {
+    int b = 0;
+    while (length > 0 && b < CENSUS_LENGTH_BUCKETS - 1) {
+        length >>= 1;
+        b++;
+    }
+    return b;
+}
+
+/** JVMTI heap_iteration_callback for a census: counts the object against its class's mark. */
+static jint JNICALL census_cb(
+        jlong class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jint length,
+        void* user_data) {
+
+    (void) tag_ptr;
+
+    census_ctx* ctx = (census_ctx*) user_data;
+    if (!ctx) return JVMTI_ITERATION_CONTINUE;
+    if (progress_visit(&ctx->progress)) return JVMTI_VISIT_ABORT;
+
+    uint64_t ct = (uint64_t) class_tag;
+    if ((uint32_t)(ct >> 32) != ctx->epoch || (ct & CLASS_MARK_FLAG) == 0) {
+        return JVMTI_ITERATION_CONTINUE;
+    }
+    jint index = (jint)(((uint32_t) ct & ~(uint32_t) CLASS_MARK_FLAG) - 1U);
+    if (index < 0 || index >= ctx->n_classes) return JVMTI_ITERATION_CONTINUE;
+
+    ctx->counts[index]++;
+    ctx->bytes[index] += size;
+    if (length >= 0 && ctx->array_slot[index] >= 0) {
+        ctx->buckets[(size_t) ctx->array_slot[index] * CENSUS_LENGTH_BUCKETS + length_bucket(length)]++;
+    }
+    return JVMTI_ITERATION_CONTINUE;
+}
+
+/**
+ * Per-class census of the heap in one pass, without tagging or resolving instances.
+ *
+ * Matching is on the exact class. Only classes with at least one instance are reported. The
+ * result is three arrays: the classes, their counters as (count, shallow bytes) pairs, and one
+ * row of CENSUS_LENGTH_BUCKETS length counts per reported array class, in the same order.
+ *
+ * @param classesArray the classes to count, or NULL for every loaded class
+ * @return Object[] { Class[] classes, long[2 * n] counts/bytes, long[32 * arrays] buckets },
+ *         or NULL on error
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeCensus(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray classesArray) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env) return NULL;
+
+    jint nClasses = 0;
+    jclass* classes = NULL;     /* local refs; JVMTI-allocated when loaded, else malloc'd */
+    int loaded = classesArray == NULL;
+    if (loaded) {
+        jvmtiError lerr = (*g_jvmti)->GetLoadedClasses(g_jvmti, &nClasses, &classes);
+        if (lerr != JVMTI_ERROR_NONE) {
+            check_print(g_jvmti, lerr, "GetLoadedClasses failed");
+            return NULL;
+        }
+    } else {
+        nClasses = (*env)->GetArrayLength(env, classesArray);
+    }
+    jint nRefs = loaded ? nClasses : 0;     /* GetLoadedClasses refs to release, whatever happens */
+    if (nClasses > CLASS_MAX_INDEX) nClasses = 0;
+
+    if ((*env)->EnsureLocalCapacity(env, (loaded ? 0 : nClasses) + 16) != 0) {
+        if ((*env)->ExceptionCheck(env)) (*env)->ExceptionClear(env);
+    }
+    if (!loaded && nClasses > 0) {
+        classes = (jclass*) malloc((size_t) nClasses * sizeof(jclass));
+        if (classes) {
+            for (jint i = 0; i < nClasses; i++) {
+                classes[i] = (jclass)(*env)->GetObjectArrayElement(env, classesArray, i);
+            }
+            nRefs = nClasses;
+        }
+    }
+
+    census_ctx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.epoch = (uint32_t) __sync_add_and_fetch(&g_epoch, 1);
+    ctx.n_classes = nClasses;
+    progress_begin(&ctx.progress, ctx.epoch);
+    size_t n = nClasses > 0 ? (size_t) nClasses : 1;
+    ctx.counts = (jlong*) calloc(n, sizeof(jlong));
+    ctx.bytes = (jlong*) calloc(n, sizeof(jlong));
+    ctx.array_slot = (jint*) malloc(n * sizeof(jint));
+
+    jobjectArray result = NULL;
+    int ok = ctx.counts && ctx.bytes && ctx.array_slot && (classes || nClasses == 0);
+
+    jlong start = op_now();
+    jvmtiEnv* jvmti = walk_env_open();
+    jint nArrays = 0;
+    for (jint i = 0; ok && i < nClasses; i++) {
+        jboolean isArray = JNI_FALSE;
+        ctx.array_slot[i] = -1;
+        if (classes[i] == NULL) continue;
+        if ((*g_jvmti)->IsArrayClass(g_jvmti, classes[i], &isArray) == JVMTI_ERROR_NONE && isArray) {
+            ctx.array_slot[i] = nArrays++;
+        }
+        jvmtiError terr = (*jvmti)->SetTag(jvmti, classes[i], CLASS_MARK_TAG(ctx.epoch, i));
+        check_print(jvmti, terr, "SetTag(census class) failed");
+    }
+    if (ok) {
+        ctx.buckets = (jlong*) calloc((size_t)(nArrays > 0 ? nArrays : 1) * CENSUS_LENGTH_BUCKETS, sizeof(jlong));
+        ok = ctx.buckets != NULL;
+    }
+
+    if (ok && nClasses > 0) {
+        jvmtiHeapCallbacks callbacks;
+        memset(&callbacks, 0, sizeof(callbacks));
+        callbacks.heap_iteration_callback = &census_cb;
+
+        jlong iterStart = op_now();
+        jvmtiError err = (*jvmti)->IterateThroughHeap(
+                jvmti, JVMTI_HEAP_FILTER_CLASS_UNTAGGED, NULL, &callbacks, &ctx);
+        op_record(OP_TAG, start, op_now() - iterStart);
+        if (progress_end(&ctx.progress)) {
+            throw_cancelled(env, "IterateThroughHeap(census)");
+            ok = 0;
+        } else if (err != JVMTI_ERROR_NONE) {
+            check_print(jvmti, err, "IterateThroughHeap(census) failed");
+            ok = 0;
+        }
+    } else {
+        progress_end(&ctx.progress);
+    }
+    walk_env_close(jvmti);
+
+    if (ok) {
+        jint reported = 0, reportedArrays = 0;
+        for (jint i = 0; i < nClasses; i++) {
+            if (ctx.counts[i] > 0) {
+                reported++;
+                if (ctx.array_slot[i] >= 0) reportedArrays++;
+            }
+        }
+
+        jclass objClass = (*env)->FindClass(env, "java/lang/Object");
+        jclass classClass = (*env)->FindClass(env, "java/lang/Class");
+        jobjectArray outClasses = classClass ? (*env)->NewObjectArray(env, reported, classClass, NULL) : NULL;
+        jlongArray outStats = (*env)->NewLongArray(env, reported * 2);
+        jlongArray outBuckets = (*env)->NewLongArray(env, reportedArrays * CENSUS_LENGTH_BUCKETS);
+        if (objClass && outClasses && outStats && outBuckets) {
+            jint r = 0, ra = 0;
+            for (jint i = 0; i < nClasses; i++) {
+                if (ctx.counts[i] == 0) continue;
+                jlong pair[2] = { ctx.counts[i], ctx.bytes[i] };
+                (*env)->SetObjectArrayElement(env, outClasses, r, classes[i]);
+                (*env)->SetLongArrayRegion(env, outStats, r * 2, 2, pair);
+                if (ctx.array_slot[i] >= 0) {
+                    (*env)->SetLongArrayRegion(env, outBuckets, ra * CENSUS_LENGTH_BUCKETS, CENSUS_LENGTH_BUCKETS,
+                            ctx.buckets + (size_t) ctx.array_slot[i] * CENSUS_LENGTH_BUCKETS);
+                    ra++;
+                }
+                r++;
+            }
+            result = (*env)->NewObjectArray(env, 3, objClass, NULL);
+            if (result != NULL) {
+                (*env)->SetObjectArrayElement(env, result, 0, outClasses);
+                (*env)->SetObjectArrayElement(env, result, 1, outStats);
+                (*env)->SetObjectArrayElement(env, result, 2, outBuckets);
+            }
+        }
+        if (objClass) (*env)->DeleteLocalRef(env, objClass);
+        if (classClass) (*env)->DeleteLocalRef(env, classClass);
+        if (outClasses) (*env)->DeleteLocalRef(env, outClasses);
+        if (outStats) (*env)->DeleteLocalRef(env, outStats);
+        if (outBuckets) (*env)->DeleteLocalRef(env, outBuckets);
+    }
+
+    if (classes) {
+        for (jint i = 0; i < nRefs; i++) {
+            if (classes[i]) (*env)->DeleteLocalRef(env, classes[i]);
+        }
+        if (loaded) {
+            (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) classes);
+        } else {
+            free(classes);
+        }
+    }
+    free(ctx.counts);
+    free(ctx.bytes);
+    free(ctx.array_slot);
+    free(ctx.buckets);
+    return result;
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Reclamation tracking
+ * ---------------------------------------------------------------------------------------------
+ *
+ * A reclamation tracker tells when a set of objects (the old objects of a committed migration)
+ * has actually been freed. Each object is tagged with the tracker's generation in the high 32
+ * bits and its shallow size in the low 32, in an environment with ObjectFree enabled, so the
+ * event, which carries nothing but the tag, is enough to count both objects and bytes. Nothing
+ * is walked and nothing holds the objects: a tag is weak.
+ *
+ * Every tracker gets an environment of its own, disposed when the tracker is stopped or replaced,
+ * which drops the tags of objects that were never freed in one step. object_free_cb makes no
+ * JVMTI call, so an event still in flight on a disposed environment is harmless, and it ignores
+ * tags of any generation but the current one. Only one tracker is active at a time.
+ */
+
+/** Number of values reported by nativeReclaimStats. */
+#define RECLAIM_STAT_COUNT 8
+
+static jvmtiEnv* g_reclaim_jvmti = NULL;
+static volatile uint32_t g_reclaim_generation = 0;
+static volatile jlong g_reclaim_tracked = 0;
+static volatile jlong g_reclaim_tracked_bytes = 0;
+static volatile jlong g_reclaim_freed = 0;
+static volatile jlong g_reclaim_freed_bytes = 0;
+static volatile jlong g_reclaim_start = 0;
+static volatile jlong g_reclaim_last = 0;
+
+/**
+ * JVMTI ObjectFree callback: counts a freed object of the current tracker and its size. Runs
+ * wherever the VM posts the event (GC or service thread) and may not call JNI or most of JVMTI.
+ */
+static void JNICALL object_free_cb(jvmtiEnv* jvmti, jlong tag) {
+    (void) jvmti;
+    uint64_t t = (uint64_t) tag;
+    if ((uint32_t)(t >> 32) != g_reclaim_generation) return;
+    __sync_add_and_fetch(&g_reclaim_freed, 1);
+    __sync_add_and_fetch(&g_reclaim_freed_bytes, (jlong)(uint32_t) t);
+    g_reclaim_last = op_now();
+}
+
+/** Returns a new environment delivering ObjectFree to object_free_cb, or NULL if unavailable. */
+static jvmtiEnv* reclaim_env_open(void) {
+    jvmtiEnv* jvmti = NULL;
+    if (!g_vm || (*g_vm)->GetEnv(g_vm, (void**) &jvmti, JVMTI_VERSION_1_2) != JNI_OK || !jvmti) return NULL;
+
+    jvmtiCapabilities caps;
+    memset(&caps, 0, sizeof(caps));
+    caps.can_tag_objects = 1;
+    caps.can_generate_object_free_events = 1;
+    jvmtiError err = (*jvmti)->AddCapabilities(jvmti, &caps);
+    if (err == JVMTI_ERROR_NONE) {
+        jvmtiEventCallbacks callbacks;
+        memset(&callbacks, 0, sizeof(callbacks));
+        callbacks.ObjectFree = &object_free_cb;
+        err = (*jvmti)->SetEventCallbacks(jvmti, &callbacks, (jint) sizeof(callbacks));
+    }
+    if (err == JVMTI_ERROR_NONE) {
+        err = (*jvmti)->SetEventNotificationMode(jvmti, JVMTI_ENABLE, JVMTI_EVENT_OBJECT_FREE, NULL);
+    }
+    if (err != JVMTI_ERROR_NONE) {
+        check_print(jvmti, err, "reclamation tracking setup failed");
+        (*jvmti)->DisposeEnvironment(jvmti);
+        return NULL;
+    }
+    return jvmti;
+}
+
+/** Stops the active tracker, if any, dropping the tags of the objects it has not seen freed. */
+static void reclaim_stop(void) {
+    jvmtiEnv* jvmti = g_reclaim_jvmti;
+    if (!jvmti) return;
+    g_reclaim_jvmti = NULL;
+    (*jvmti)->SetEventNotificationMode(jvmti, JVMTI_DISABLE, JVMTI_EVENT_OBJECT_FREE, NULL);
+    jvmtiError err = (*jvmti)->DisposeEnvironment(jvmti);
+    check_print(g_jvmti, err, "DisposeEnvironment(reclamation env) failed");
+}
+
+/**
+ * Starts tracking the reclamation of the given objects, replacing any active tracker. Counters
+ * restart at zero under a new generation.
+ *
+ * @param objectsArray the objects to track (null elements are skipped)
+ * @return the number of objects tracked, or -1 if the VM cannot post ObjectFree
+ */
+JNIEXPORT jlong JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeStartReclaimTracking(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray objectsArray) {
+
+    (void) cls;
+
+    if (!env || objectsArray == NULL) return -1;
+    reclaim_stop();
+
+    jvmtiEnv* jvmti = reclaim_env_open();
+    if (!jvmti) return -1;
+
+    uint32_t generation = (uint32_t) __sync_add_and_fetch(&g_epoch, 1);
+    g_reclaim_generation = generation;
+    g_reclaim_freed = 0;
+    g_reclaim_freed_bytes = 0;
+    g_reclaim_last = 0;
+    g_reclaim_start = op_now();
+    __sync_synchronize();
+
+    jlong tracked = 0, bytes = 0;
+    jsize n = (*env)->GetArrayLength(env, objectsArray);
+    for (jsize i = 0; i < n; i++) {
+        jobject obj = (*env)->GetObjectArrayElement(env, objectsArray, i);
+        if (obj == NULL) continue;
+        jlong size = 0;
+        (*jvmti)->GetObjectSize(jvmti, obj, &size);
+        if (size <= 0) size = 1;
+        if (size > (jlong) UINT32_MAX) size = (jlong) UINT32_MAX;
+        jvmtiError err = (*jvmti)->SetTag(jvmti, obj,
+                (jlong)((((uint64_t) generation) << 32) | (uint64_t) size));
+        if (err == JVMTI_ERROR_NONE) {
+            tracked++;
+            bytes += size;
+        } else {
+            check_print(jvmti, err, "SetTag(reclaimed object) failed");
+        }
+        (*env)->DeleteLocalRef(env, obj);
+    }
+    g_reclaim_tracked = tracked;
+    g_reclaim_tracked_bytes = bytes;
+    __sync_synchronize();
+    g_reclaim_jvmti = jvmti;
+    return tracked;
+}
+
+/**
+ * Reports the active (or last) tracker's counters. Foreign-function entry point.
+ *
+ * @param out receives { generation (0 = none), tracked, tracked bytes, freed, freed bytes,
+ *                       ns from start to the last free (0 = none), ns since start, active }
+ */
+JNIEXPORT void migrator_reclaim_stats(jlong* out) {
+    if (!out) return;
+    jlong start = g_reclaim_start;
+    jlong last = g_reclaim_last;
+    out[0] = (jlong) g_reclaim_generation;
+    out[1] = g_reclaim_tracked;
+    out[2] = g_reclaim_tracked_bytes;
+    out[3] = g_reclaim_freed;
+    out[4] = g_reclaim_freed_bytes;
+    out[5] = last > start ? last - start : 0;
+    out[6] = start > 0 ? op_now() - start : 0;
+    out[7] = g_reclaim_jvmti != NULL;
+}
+
+/**
+ * JNI binding of migrator_reclaim_stats.
+ *
+ * @param out long[8] receiving the counters
+ */
+JNIEXPORT void JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeReclaimStats(
+        JNIEnv* env,
+        jclass cls,
+        jlongArray out) {
+
+    (void) cls;
+
+    if (!env || out == NULL || (*env)->GetArrayLength(env, out) < RECLAIM_STAT_COUNT) return;
+    jlong values[RECLAIM_STAT_COUNT];
+    migrator_reclaim_stats(values);
+    (*env)->SetLongArrayRegion(env, out, 0, RECLAIM_STAT_COUNT, values);
+}
+
+/**
+ * Stops the active tracker. Its counters stay readable until the next one starts.
+ */
+JNIEXPORT void JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeStopReclaimTracking(
+        JNIEnv* env,
+        jclass cls) {
+
+    (void) env;
+    (void) cls;
+    reclaim_stop();
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Thread suspension
+ * ---------------------------------------------------------------------------------------------
+ *
+ * Quiescence without the application's help: the engine suspends the application's threads
+ * with one SuspendThreadList call for the critical phase and resumes them with one
+ * ResumeThreadList. Which threads to suspend is decided in Java; the agent only makes the two
+ * calls, reports one JVMTI error per thread, and times each call, which returns once every
+ * listed thread is actually suspended (or resumed).
+ *
+ * Suspension uses an environment of its own, created on first use and kept for the life of the
+ * VM: threads stay suspended across calls, and disposing the environment would not resume them.
+ */
+
+static jvmtiEnv* g_suspend_jvmti = NULL;
+
+/** Creates the suspension environment on first use; returns it, or NULL if suspension is unavailable. */
+static jvmtiEnv* suspend_env(void) {
+    if (g_suspend_jvmti) return g_suspend_jvmti;
+    if (!g_vm) return NULL;
+
+    jvmtiEnv* jvmti = NULL;
+    if ((*g_vm)->GetEnv(g_vm, (void**) &jvmti, JVMTI_VERSION_1_2) != JNI_OK || !jvmti) return NULL;
+
+    jvmtiCapabilities caps;
+    memset(&caps, 0, sizeof(caps));
+    caps.can_suspend = 1;
+    jvmtiError err = (*jvmti)->AddCapabilities(jvmti, &caps);
+    if (err != JVMTI_ERROR_NONE) {
+        check_print(jvmti, err, "AddCapabilities(can_suspend) failed");
+        (*jvmti)->DisposeEnvironment(jvmti);
+        return NULL;
+    }
+    if (!__sync_bool_compare_and_swap(&g_suspend_jvmti, NULL, jvmti)) {
+        (*jvmti)->DisposeEnvironment(jvmti);
+    }
+    return g_suspend_jvmti;
+}
+
+/**
+ * Suspends or resumes the given threads with one JVMTI call. For suspension, null elements and
+ * the calling thread are rejected without being passed on, so the caller can never suspend itself.
+ *
+ * @return nanoseconds spent in the JVMTI call, or -1 if suspension is unavailable or the call failed
+ */
+static jlong suspend_resume(JNIEnv* env, jobjectArray threadsArray, jintArray errorsArray, int resume) {
+    if (!env || threadsArray == NULL || errorsArray == NULL) return -1;
+    jsize n = (*env)->GetArrayLength(env, threadsArray);
+    if ((*env)->GetArrayLength(env, errorsArray) < n) return -1;
+    jvmtiEnv* jvmti = suspend_env();
+    if (!jvmti) return -1;
+    if (n == 0) return 0;
+
+    jthread* list = (jthread*) calloc((size_t) n, sizeof(jthread));
+    jint* slot = (jint*) calloc((size_t) n, sizeof(jint));
+    jvmtiError* results = (jvmtiError*) calloc((size_t) n, sizeof(jvmtiError));
+    jint* errors = (jint*) calloc((size_t) n, sizeof(jint));
+    if (!list || !slot || !results || !errors) {
+        free(list);
+        free(slot);
+        free(results);
+        free(errors);
+        return -1;
+    }
+
+    jthread self = NULL;
+    (*jvmti)->GetCurrentThread(jvmti, &self);
+
+    jlong elapsed = -1;
+    jint count = 0;
+    for (jsize i = 0; i < n; i++) {
+        jthread t = (jthread) (*env)->GetObjectArrayElement(env, threadsArray, i);
+        if (t == NULL) {
+            errors[i] = JVMTI_ERROR_INVALID_THREAD;
+        } else if (!resume && self && (*env)->IsSameObject(env, t, self)) {
+            errors[i] = JVMTI_ERROR_ILLEGAL_ARGUMENT;
+            (*env)->DeleteLocalRef(env, t);
+        } else {
+            slot[count] = (jint) i;
+            list[count++] = t;
+        }
+    }
+
+    jlong start = op_now();
+    jvmtiError err = resume
+            ? (*jvmti)->ResumeThreadList(jvmti, count, list, results)
+            : (*jvmti)->SuspendThreadList(jvmti, count, list, results);
+    jlong end = op_now();
+    if (err == JVMTI_ERROR_NONE) {
+        for (jint k = 0; k < count; k++) errors[slot[k]] = (jint) results[k];
+        elapsed = end - start;
+    } else {
+        check_print(jvmti, err, resume ? "ResumeThreadList failed" : "SuspendThreadList failed");
+        for (jint k = 0; k < count; k++) errors[slot[k]] = (jint) err;
+    }
+    (*env)->SetIntArrayRegion(env, errorsArray, 0, n, errors);
+
+    for (jint k = 0; k < count; k++) (*env)->DeleteLocalRef(env, list[k]);
+    if (self) (*env)->DeleteLocalRef(env, self);
+    free(list);
+    free(slot);
+    free(results);
+    free(errors);
+    return elapsed;
+}
+
+/**
+ * Suspends the given threads with one SuspendThreadList call.
+ *
+ * @param threadsArray the threads to suspend
+ * @param errorsArray  receives the JVMTI error of each thread (0 = suspended)
+ * @return nanoseconds until every thread was suspended, or -1 if suspension is unavailable
+ */
+JNIEXPORT jlong JNICALL
+Java_migrator_quiesce_NativeThreadSuspender_nativeSuspendThreads(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray threadsArray,
+        jintArray errorsArray) {
+
+    (void) cls;
+    return suspend_resume(env, threadsArray, errorsArray, 0);
+}
+
+/**
+ * Resumes the given threads with one ResumeThreadList call.
+ *
+ * @param threadsArray the threads to resume
+ * @param errorsArray  receives the JVMTI error of each thread (0 = resumed)
+ * @return nanoseconds until every thread was resumed, or -1 if suspension is unavailable
+ */
+JNIEXPORT jlong JNICALL
+Java_migrator_quiesce_NativeThreadSuspender_nativeResumeThreads(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray threadsArray,
+        jintArray errorsArray) {
+
+    (void) cls;
+    return suspend_resume(env, threadsArray, errorsArray, 1);
+}
+
+/**
+ * Size of the per-kind reference counter array reported by a referrer walk. JVMTI reference
+ * kinds are small positive integers (1..10 for object references, 21..27 for roots), so a
+ * fixed 32-slot array indexed by jvmtiHeapReferenceKind covers every kind.
+ */
+#define REFERENCE_KIND_SLOTS 32
+
+/** Tag marking the target objects of a referrer walk (distinct from the walk's holder tag). */
+#define TARGET_TAG(epoch) ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | 2ULL))
+
+/** Per-walk state shared with referrer_tagging_cb through FollowReferences' user_data. */
+typedef struct {
+    jlong target_tag;
+    jlong holder_tag;
+    jlong kind_counts[REFERENCE_KIND_SLOTS];
+    walk_progress progress;
+} referrer_walk_ctx;
+
+/**
+ * JVMTI heap_reference_callback for a referrer walk.
+ *
+ * Every reference whose referree carries the walk's target tag is counted by kind, and its
+ * referrer (when it is an object, not a root) is stamped with the walk's shared holder tag so
+ * all holders resolve in one GetObjectsWithTags(count=1) call. For static-field references the
+ * referrer is the declaring java.lang.Class, so static holders come back as Class objects.
+ * Referrers that are themselves targets keep their target tag: old objects are discarded after
+ * the migration, so their own slots never need patching. Returns JVMTI_VISIT_OBJECTS — every
+ * reachable object must be visited for the holder set to be complete — unless the walk is
+ * cancelled.
+ */
+static jint JNICALL referrer_tagging_cb(
+        jvmtiHeapReferenceKind reference_kind,
+        const jvmtiHeapReferenceInfo* reference_info,
+        jlong class_tag,
+        jlong referrer_class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jlong* referrer_tag_ptr,
+        jint length,
+        void* user_data) {
+
+    (void) reference_info;
+    (void) class_tag;
+    (void) referrer_class_tag;
+    (void) size;
+    (void) length;
+
+    referrer_walk_ctx* ctx = (referrer_walk_ctx*) user_data;
+    if (!ctx) return JVMTI_VISIT_OBJECTS;
+    if (progress_visit(&ctx->progress)) return JVMTI_VISIT_ABORT;
+    if (!tag_ptr || *tag_ptr != ctx->target_tag) return JVMTI_VISIT_OBJECTS;
+
+    if ((int) reference_kind > 0 && (int) reference_kind < REFERENCE_KIND_SLOTS) {
+        ctx->kind_counts[reference_kind]++;
+    }
+
+    if (referrer_tag_ptr != NULL && *referrer_tag_ptr != ctx->target_tag) {
+        if (*referrer_tag_ptr != ctx->holder_tag) ctx->progress.tagged++;
+        *referrer_tag_ptr = ctx->holder_tag;
+    }
+    return JVMTI_VISIT_OBJECTS;
+}
+
+/**
+ * Finds the objects that directly reference any of the given targets.
+ *
+ * Targets are stamped with a per-walk target tag via SetTag (O(targets)), then one
+ * FollowReferences pass from the heap roots reports every reference into a target: the
+ * referrer is tagged with the per-walk holder tag and the reference is counted by kind. The
+ * holders are resolved with a single GetObjectsWithTags(count=1) call, as for the other walks.
+ *
+ * Individual slots are not reported per holder: resolving per-holder tags would need one
+ * distinct tag per holder and an O(heap * holders) GetObjectsWithTags. The Java caller locates
+ * the slots itself by patching only the returned holders.
+ *
+ * @param targetsArray the objects whose referrers to find (null elements are skipped)
+ * @param kindCounts   optional long[] receiving the number of references into the targets per
+ *                     jvmtiHeapReferenceKind (index = kind); roots (stack locals, JNI refs, …)
+ *                     are counted here even though they have no holder object
+ * @return Array of holder objects (instances, or Class objects for static fields), or NULL
+ *         on error / when nothing references the targets
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeFindReferrers(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray targetsArray,
+        jlongArray kindCounts) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env || targetsArray == NULL) return NULL;
+
+    jsize nTargets = (*env)->GetArrayLength(env, targetsArray);
+    if (nTargets == 0) return NULL;
+
+    jlong epoch = __sync_add_and_fetch(&g_epoch, 1);
+    referrer_walk_ctx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.target_tag = TARGET_TAG(epoch);
+    ctx.holder_tag = WALK_TAG(epoch);
+    progress_begin(&ctx.progress, epoch);
+
+    jlong start = op_now();
+    jvmtiEnv* jvmti = walk_env_open();
+    for (jsize i = 0; i < nTargets; i++) {
+        jobject target = (*env)->GetObjectArrayElement(env, targetsArray, i);
+        if (target == NULL) continue;
+        jvmtiError terr = (*jvmti)->SetTag(jvmti, target, ctx.target_tag);
+        check_print(jvmti, terr, "SetTag(referrer target) failed");
+        (*env)->DeleteLocalRef(env, target);
+    }
+
+    jvmtiHeapCallbacks callbacks;
+    memset(&callbacks, 0, sizeof(callbacks));
+    callbacks.heap_reference_callback = &referrer_tagging_cb;
+
+    jlong iterStart = op_now();
+    jvmtiError err = (*jvmti)->FollowReferences(
+            jvmti, HEAP_FILTER_NONE, NULL, NULL, &callbacks, &ctx);
+    op_record(OP_TAG, start, op_now() - iterStart);
+    if (progress_end(&ctx.progress)) {
+        throw_cancelled(env, "FollowReferences(findReferrers)");
+        walk_env_close(jvmti);
+        return NULL;
+    }
+    if (err != JVMTI_ERROR_NONE) {
+        check_print(jvmti, err, "FollowReferences(findReferrers) failed");
+        walk_env_close(jvmti);
+        return NULL;
+    }
+
+    if (kindCounts != NULL) {
+        jsize n = (*env)->GetArrayLength(env, kindCounts);
+        if (n > REFERENCE_KIND_SLOTS) n = REFERENCE_KIND_SLOTS;
+        (*env)->SetLongArrayRegion(env, kindCounts, 0, n, ctx.kind_counts);
+    }
+
+    jobjectArray result = resolve_walk_tag(env, jvmti, ctx.holder_tag, 0, -1);
+    walk_env_close(jvmti);
+    return result;
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Referrer chains
+ * ---------------------------------------------------------------------------------------------
+ *
+ * A holder that cannot be patched in place (a HashMap node, the backing array of a collection,
+ * a record) is patched through its own holders, which may be of the same kind, so a REFERRERS
+ * pass climbs until every chain ends at an anchor. A referrer walk per level costs one
+ * FollowReferences of the whole heap per level; this walk collects every level in one pass.
+ *
+ * The Java caller marks the loaded classes whose instances are climbed. Nodes [0, n_classes)
+ * are their mirrors, [n_classes, n_classes + n_targets) the targets; every other object gets
+ * the next node number the first time a recorded reference names it, as referrer or referree.
+ * The pass records each reference from an object into a target or into an instance of a
+ * climbed class as an edge between two nodes. A breadth-first search back from the targets
+ * over those edges then finds the same chains a walk per level would, depth for depth. One
+ * IterateThroughHeap retags the holders on a chain with their role and clears every other
+ * tag, and a single GetObjectsWithTags over the CHAIN_ROLE_COUNT role tags resolves them.
+ *
+ * The edges cost 8 bytes per reference into a climbed object, so the walk trades native memory
+ * for heap passes. That count grows with the heap, not with the chains: every HashMap node and
+ * collection array holding anything is recorded. The caller caps it; a walk that would record
+ * more edges than the cap, or whose tables cannot grow, aborts and fails, and the caller climbs
+ * a walk per level.
+ */
+
+/** Largest node number encodable in a tag (stored as number + 1 so a tag is never 0). */
+#define CHAIN_MAX_NODES 0x7FFFFFFE
+
+/** Low-32-bit flag of a role tag, above every node tag. */
+#define CHAIN_ROLE_FLAG 0x80000000ULL
+
+#define CHAIN_NODE_TAG(epoch, i) \
+    ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | (uint64_t)((uint32_t)(i) + 1U)))
+#define CHAIN_ROLE_TAG(epoch, role) \
+    ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | CHAIN_ROLE_FLAG | (uint64_t)(uint32_t)(role)))
+
+/** Node flags. The role bits, reported to Java, must match HeapReferrerChains. */
+#define CHAIN_DIRECT 0x01   /* an anchor referencing a target */
+#define CHAIN_LINKED 0x02   /* an anchor referencing a climbed holder */
+#define CHAIN_OPEN   0x04   /* a climbed holder still unanchored after max_depth levels */
+#define CHAIN_ROLES  0x07
+#define CHAIN_CLIMB  0x08   /* an instance of a climbed class */
+#define CHAIN_SCOPE  0x10   /* a holder on some chain */
+
+/** Number of role tags: every combination of the role bits. */
+#define CHAIN_ROLE_COUNT (CHAIN_ROLES + 1)
+
+/** Per-walk state shared with chain_cb and chain_retag_cb through user_data. */
+typedef struct {
+    uint32_t epoch;
+    jint n_classes;
+    jint n_targets;
+    const unsigned char* climb_class;   /* [n_classes]: 1 for a climbed class */
+    unsigned char* flags;               /* [count]: CHAIN_* flags per node */
+    jint count;
+    jint capacity;
+    jint* edge_from;                    /* [n_edges]: referrer node of each recorded reference */
+    jint* edge_to;                      /* [n_edges]: its referree node */
+    jlong n_edges;
+    jlong edge_capacity;
+    jlong max_edges;                    /* the cap on n_edges */
+    int oom;                            /* 1 if a table could not grow, 2 if the cap was reached */
+    jlong kind_counts[REFERENCE_KIND_SLOTS];
+    walk_progress progress;
+} chain_ctx;
+
+/** Decodes a node tag of the current chain walk; returns the node or -1. */
+static jint chain_node_of(const chain_ctx* ctx, jlong tag) {
+    uint64_t t = (uint64_t) tag;
+    if ((uint32_t)(t >> 32) != ctx->epoch) return -1;
+    uint32_t low = (uint32_t) t;
+    if (low == 0 || low > (uint32_t) ctx->count) return -1;
+    return (jint)(low - 1);
+}
+
+/** True if node is one of the walk's targets. */
+static int chain_is_target(const chain_ctx* ctx, jint node) {
+    return node >= ctx->n_classes && node < ctx->n_classes + ctx->n_targets;
+}
+
+/** True if class_tag is the mirror of a climbed class. */
+static int chain_climbed(const chain_ctx* ctx, jlong class_tag) {
+    jint k = chain_node_of(ctx, class_tag);
+    return k >= 0 && k < ctx->n_classes && ctx->climb_class[k];
+}
+
+/** Appends a node with the given flags; returns its number, or -1 if the table cannot grow. */
+static jint chain_add_node(chain_ctx* ctx, unsigned char flags) {
+    if (ctx->count == ctx->capacity) {
+        if (ctx->capacity >= CHAIN_MAX_NODES) return -1;
+        jint cap = ctx->capacity > CHAIN_MAX_NODES / 2 ? CHAIN_MAX_NODES : ctx->capacity * 2;
+        unsigned char* grown = (unsigned char*) realloc(ctx->flags, (size_t) cap);
+        if (!grown) return -1;
+        ctx->flags = grown;
+        ctx->capacity = cap;
+    }
+    ctx->flags[ctx->count] = flags;
+    return ctx->count++;
+}
+
+/**
+ * Records a reference from node `from` to node `to`; returns 0, or -1 if the cap is reached or
+ * the table cannot grow (oom set to 2 or 1).
+ */
+static int chain_add_edge(chain_ctx* ctx, jint from, jint to) {
+    if (ctx->n_edges >= ctx->max_edges) {
+        ctx->oom = 2;
+        return -1;
+    }
+    if (ctx->n_edges == ctx->edge_capacity) {
+        jlong cap = ctx->edge_capacity * 2;
+        if (cap > ctx->max_edges) cap = ctx->max_edges;
+        jint* f = (jint*) realloc(ctx->edge_from, (size_t) cap * sizeof(jint));
+        if (!f) return -1;
+        ctx->edge_from = f;
+        jint* t = (jint*) realloc(ctx->edge_to, (size_t) cap * sizeof(jint));
+        if (!t) return -1;
+        ctx->edge_to = t;
+        ctx->edge_capacity = cap;
+    }
+    ctx->edge_from[ctx->n_edges] = from;
+    ctx->edge_to[ctx->n_edges] = to;
+    ctx->n_edges++;
+    return 0;
+}
+
+/**
+ * JVMTI heap_reference_callback for a chain walk: records every reference from an object into a
+ * target or into an instance of a climbed class, numbering both ends on first sight. References
+ * into a target are counted by kind, roots included; references from a target are not recorded,
+ * since old objects are discarded after the migration. Returns JVMTI_VISIT_OBJECTS so every
+ * reachable object is visited, unless the walk is cancelled or its tables cannot grow.
+ */
+static jint JNICALL chain_cb(
+        jvmtiHeapReferenceKind reference_kind,
+        const jvmtiHeapReferenceInfo* reference_info,
+        jlong class_tag,
+        jlong referrer_class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jlong* referrer_tag_ptr,
+        jint length,
+        void* user_data) {
+
+    (void) reference_info;
+    (void) size;
+    (void) length;
+
+    chain_ctx* ctx = (chain_ctx*) user_data;
+    if (!ctx) return JVMTI_VISIT_OBJECTS;
+    if (progress_visit(&ctx->progress) || ctx->oom) return JVMTI_VISIT_ABORT;
+    if (!tag_ptr) return JVMTI_VISIT_OBJECTS;
+
+    jint to = chain_node_of(ctx, *tag_ptr);
+    if (chain_is_target(ctx, to)) {
+        if ((int) reference_kind > 0 && (int) reference_kind < REFERENCE_KIND_SLOTS) {
+            ctx->kind_counts[reference_kind]++;
+        }
+    } else if (!chain_climbed(ctx, class_tag)) {
+        return JVMTI_VISIT_OBJECTS;
+    }
+    if (referrer_tag_ptr == NULL) return JVMTI_VISIT_OBJECTS;      /* a root: no holder */
+
+    jint from = chain_node_of(ctx, *referrer_tag_ptr);
+    if (chain_is_target(ctx, from)) return JVMTI_VISIT_OBJECTS;
+    if (to < 0) {
+        to = chain_add_node(ctx, CHAIN_CLIMB);
+        if (to < 0) goto oom;
+        *tag_ptr = CHAIN_NODE_TAG(ctx->epoch, to);
+        ctx->progress.tagged++;
+    }
+    if (from < 0) {
+        from = chain_add_node(ctx, chain_climbed(ctx, referrer_class_tag) ? CHAIN_CLIMB : 0);
+        if (from < 0) goto oom;
+        *referrer_tag_ptr = CHAIN_NODE_TAG(ctx->epoch, from);
+        ctx->progress.tagged++;
+    }
+    if (chain_add_edge(ctx, from, to) == 0) return JVMTI_VISIT_OBJECTS;
+    if (ctx->oom) return JVMTI_VISIT_ABORT;
+oom:
+    ctx->oom = 1;
+    return JVMTI_VISIT_ABORT;
+}
+
+/**
+ * Searches back from the targets over the recorded edges, one level per depth as a referrer walk
+ * per level would: a holder first met on a level is climbed further if it is CHAIN_CLIMB, and is
+ * otherwise an anchor, CHAIN_DIRECT on the first level and CHAIN_LINKED on later ones. Every
+ * holder met gets CHAIN_SCOPE; the climbed holders still open after max_depth levels get
+ * CHAIN_OPEN. Returns 0, or -1 if out of memory.
+ */
+static int chain_climb(chain_ctx* ctx, jint max_depth) {
+    jint n = ctx->count;
+    jlong* start = (jlong*) calloc((size_t) n + 1, sizeof(jlong));
+    jint* from = (jint*) malloc((size_t) (ctx->n_edges > 0 ? ctx->n_edges : 1) * sizeof(jint));
+    jint* level = (jint*) malloc((size_t) n * sizeof(jint));
+    jint* frontier = (jint*) malloc((size_t) n * sizeof(jint));
+    jint* next = (jint*) malloc((size_t) n * sizeof(jint));
+    int ok = start && from && level && frontier && next;
+
+    if (ok) {
+        /* the referrers of each node, grouped by referree: from[start[v] .. start[v + 1]) */
+        for (jlong e = 0; e < ctx->n_edges; e++) start[ctx->edge_to[e] + 1]++;
+        for (jint v = 0; v < n; v++) start[v + 1] += start[v];
+        for (jlong e = 0; e < ctx->n_edges; e++) from[start[ctx->edge_to[e]]++] = ctx->edge_from[e];
+        for (jint v = n; v > 0; v--) start[v] = start[v - 1];
+        start[0] = 0;
+
+        for (jint v = 0; v < n; v++) level[v] = -1;
+        jint width = 0;
+        for (jint t = 0; t < ctx->n_targets; t++) frontier[width++] = ctx->n_classes + t;
+        for (jint depth = 0; depth < max_depth && width > 0; depth++) {
+            jint found = 0;
+            for (jint i = 0; i < width; i++) {
+                jint v = frontier[i];
+                for (jlong e = start[v]; e < start[v + 1]; e++) {
+                    jint h = from[e];
+                    if (level[h] == depth) continue;
+                    level[h] = depth;
+                    int first = !(ctx->flags[h] & CHAIN_SCOPE);
+                    ctx->flags[h] |= CHAIN_SCOPE;
+                    if (ctx->flags[h] & CHAIN_CLIMB) {
+                        if (first) next[found++] = h;
+                    } else {
+                        ctx->flags[h] |= depth == 0 ? CHAIN_DIRECT : CHAIN_LINKED;
+                    }
+                }
+            }
+            jint* swap = frontier;
+            frontier = next;
+            next = swap;
+            width = found;
+        }
+        for (jint i = 0; i < width; i++) ctx->flags[frontier[i]] |= CHAIN_OPEN;
+    }
+
+    free(start);
+    free(from);
+    free(level);
+    free(frontier);
+    free(next);
+    return ok ? 0 : -1;
+}
+
+/**
+ * JVMTI heap_iteration_callback run over the tagged objects after the search: retags each holder
+ * on a chain with its role and clears every other node tag of the walk.
+ */
+static jint JNICALL chain_retag_cb(jlong class_tag, jlong size, jlong* tag_ptr, jint length, void* user_data) {
+    (void) class_tag;
+    (void) size;
+    (void) length;
+
+    chain_ctx* ctx = (chain_ctx*) user_data;
+    if (!ctx || !tag_ptr) return JVMTI_ITERATION_CONTINUE;
+    jint node = chain_node_of(ctx, *tag_ptr);
+    if (node < 0) return JVMTI_ITERATION_CONTINUE;
+    unsigned char f = ctx->flags[node];
+    *tag_ptr = (f & CHAIN_SCOPE) ? CHAIN_ROLE_TAG(ctx->epoch, f & CHAIN_ROLES) : 0;
+    return JVMTI_ITERATION_CONTINUE;
+}
+
+/**
+ * Resolves the holders retagged by chain_retag_cb with one GetObjectsWithTags call over the
+ * role tags, clearing each resolved tag.
+ *
+ * @return Object[] { Object[] holders, byte[] roles (CHAIN_ROLES bits, per holder) }, or NULL on
+ *         error
+ */
+static jobjectArray chain_resolve(JNIEnv* env, jvmtiEnv* jvmti, uint32_t epoch) {
+    jlong wanted[CHAIN_ROLE_COUNT];
+    for (jint r = 0; r < CHAIN_ROLE_COUNT; r++) wanted[r] = CHAIN_ROLE_TAG(epoch, r);
+
+    jint found = 0;
+    jobject* objects = NULL;
+    jlong* tagsOut = NULL;
+    jlong start = op_now();
+    jvmtiError err = (*jvmti)->GetObjectsWithTags(
+            jvmti, CHAIN_ROLE_COUNT, wanted, &found, &objects, &tagsOut);
+    jlong safepoint = op_now() - start;
+    if (err != JVMTI_ERROR_NONE) {
+        check_print(jvmti, err, "GetObjectsWithTags(chains) failed");
+        if (objects) (*jvmti)->Deallocate(jvmti, (unsigned char*) objects);
+        if (tagsOut) (*jvmti)->Deallocate(jvmti, (unsigned char*) tagsOut);
+        op_record(OP_RESOLVE, start, safepoint);
+        return NULL;
+    }
+
+    if ((*env)->EnsureLocalCapacity(env, found + 16) != 0) {
+        if ((*env)->ExceptionCheck(env)) (*env)->ExceptionClear(env);
+    }
+    jobjectArray result = NULL;
+    jclass objClass = (*env)->FindClass(env, "java/lang/Object");
+    jobjectArray holders = objClass ? (*env)->NewObjectArray(env, found, objClass, NULL) : NULL;
+    jbyteArray roles = (*env)->NewByteArray(env, found);
+    jbyte* role = (jbyte*) malloc((size_t) (found > 0 ? found : 1));
+    if (objClass && holders && roles && role) {
+        result = (*env)->NewObjectArray(env, 2, objClass, NULL);
+    }
+    for (jint i = 0; i < found; i++) {
+        jobject o = objects[i];
+        if (result != NULL) {
+            (*env)->SetObjectArrayElement(env, holders, i, o);
+            role[i] = (jbyte)((uint32_t) tagsOut[i] & CHAIN_ROLES);
+        }
+        if (o) (*jvmti)->SetTag(jvmti, o, 0);
+        if (o) (*env)->DeleteLocalRef(env, o);
+    }
+    if (result != NULL) {
+        (*env)->SetByteArrayRegion(env, roles, 0, found, role);
+        (*env)->SetObjectArrayElement(env, result, 0, holders);
+        (*env)->SetObjectArrayElement(env, result, 1, roles);
+    }
+
+    free(role);
+    if (objClass) (*env)->DeleteLocalRef(env, objClass);
+    if (holders) (*env)->DeleteLocalRef(env, holders);
+    if (roles) (*env)->DeleteLocalRef(env, roles);
+    if (objects) {
+        jvmtiError derr = (*jvmti)->Deallocate(jvmti, (unsigned char*) objects);
+        check_print(jvmti, derr, "Deallocate(objects) failed");
+    }
+    if (tagsOut) {
+        jvmtiError derr = (*jvmti)->Deallocate(jvmti, (unsigned char*) tagsOut);
+        check_print(jvmti, derr, "Deallocate(tagsOut) failed");
+    }
+    op_record(OP_RESOLVE, start, safepoint);
+    return result;
+}
+
+/**
+ * Returns the classes loaded in the VM, for the Java caller of a chain walk to mark the ones it
+ * climbs.
+ *
+ * @return Class[] of every loaded class, or NULL on error
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeLoadedClasses(
+        JNIEnv* env,
+        jclass cls) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env) return NULL;
+    jint nClasses = 0;
+    jclass* classes = NULL;     /* local refs, JVMTI-allocated */
+    jvmtiError err = (*g_jvmti)->GetLoadedClasses(g_jvmti, &nClasses, &classes);
+    if (err != JVMTI_ERROR_NONE) {
+        check_print(g_jvmti, err, "GetLoadedClasses failed");
+        return NULL;
+    }
+    jobjectArray result = NULL;
+    jclass classClass = (*env)->FindClass(env, "java/lang/Class");
+    if (classClass != NULL) {
+        result = (*env)->NewObjectArray(env, nClasses, classClass, NULL);
+        (*env)->DeleteLocalRef(env, classClass);
+    }
+    for (jint i = 0; i < nClasses; i++) {
+        if (result != NULL) (*env)->SetObjectArrayElement(env, result, i, classes[i]);
+        if (classes[i]) (*env)->DeleteLocalRef(env, classes[i]);
+    }
+    if (classes) (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) classes);
+    return result;
+}
+
+/**
+ * Finds the holders of the given targets and, through the holders of the climbed classes, the
+ * chains up to the anchors that patch them, with one FollowReferences pass (see "Referrer
+ * chains").
+ *
+ * @param targetsArray the objects whose referrers to find (null elements are skipped)
+ * @param classesArray the loaded classes (from nativeLoadedClasses)
+ * @param climbArray   boolean[] parallel to classesArray: true for a class whose instances are
+ *                     climbed through rather than patched in place
+ * @param maxDepth     the number of levels to climb
+ * @param maxEdges     the most references into targets and climbed objects the walk records;
+ *                     the walk aborts and fails when one more is reported
+ * @param kindCounts   optional long[] receiving the number of references into the targets per
+ *                     jvmtiHeapReferenceKind (index = kind), roots included
+ * @return Object[] { Object[] holders, byte[] roles }, or NULL on error (out of memory, more than
+ *         maxEdges references, too many nodes, or a failed JVMTI call)
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeFindReferrerChains(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray targetsArray,
+        jobjectArray classesArray,
+        jbooleanArray climbArray,
+        jint maxDepth,
+        jlong maxEdges,
+        jlongArray kindCounts) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env || targetsArray == NULL || classesArray == NULL || climbArray == NULL
+            || maxEdges <= 0) {
+        return NULL;
+    }
+    jsize nTargets = (*env)->GetArrayLength(env, targetsArray);
+    jsize nClasses = (*env)->GetArrayLength(env, classesArray);
+    if ((*env)->GetArrayLength(env, climbArray) != nClasses
+            || (jlong) nClasses + nTargets > CHAIN_MAX_NODES / 2) {
+        return NULL;
+    }
+
+    chain_ctx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.epoch = (uint32_t) __sync_add_and_fetch(&g_epoch, 1);
+    ctx.n_classes = nClasses;
+    ctx.n_targets = nTargets;
+    ctx.capacity = nClasses + nTargets + 1024;
+    ctx.max_edges = maxEdges;
+    ctx.edge_capacity = maxEdges < 4096 ? maxEdges : 4096;
+    unsigned char* climb = (unsigned char*) malloc((size_t) (nClasses > 0 ? nClasses : 1));
+    ctx.climb_class = climb;
+    ctx.flags = (unsigned char*) malloc((size_t) ctx.capacity);
+    ctx.edge_from = (jint*) malloc((size_t) ctx.edge_capacity * sizeof(jint));
+    ctx.edge_to = (jint*) malloc((size_t) ctx.edge_capacity * sizeof(jint));
+    jobjectArray result = NULL;
+    if (!climb || !ctx.flags || !ctx.edge_from || !ctx.edge_to) goto done;
+
+    jboolean* flags = (*env)->GetBooleanArrayElements(env, climbArray, NULL);
+    if (flags == NULL) goto done;
+    for (jsize i = 0; i < nClasses; i++) climb[i] = flags[i] ? 1 : 0;
+    (*env)->ReleaseBooleanArrayElements(env, climbArray, flags, JNI_ABORT);
+
+    jlong start = op_now();
+    jvmtiEnv* jvmti = walk_env_open();
+    ctx.count = nClasses + nTargets;
+    memset(ctx.flags, 0, (size_t) ctx.count);
+    for (jsize i = 0; i < nClasses; i++) {
+        jobject c = (*env)->GetObjectArrayElement(env, classesArray, i);
+        if (c == NULL) continue;
+        jvmtiError terr = (*jvmti)->SetTag(jvmti, c, CHAIN_NODE_TAG(ctx.epoch, i));
+        check_print(jvmti, terr, "SetTag(chain class) failed");
+        (*env)->DeleteLocalRef(env, c);
+    }
+    for (jsize i = 0; i < nTargets; i++) {
+        jobject target = (*env)->GetObjectArrayElement(env, targetsArray, i);
+        if (target == NULL) continue;
+        jvmtiError terr = (*jvmti)->SetTag(jvmti, target, CHAIN_NODE_TAG(ctx.epoch, nClasses + i));
+        check_print(jvmti, terr, "SetTag(chain target) failed");
+        (*env)->DeleteLocalRef(env, target);
+    }
+
+    jvmtiHeapCallbacks callbacks;
+    memset(&callbacks, 0, sizeof(callbacks));
+    callbacks.heap_reference_callback = &chain_cb;
+    progress_begin(&ctx.progress, ctx.epoch);
+    jlong iterStart = op_now();
+    jvmtiError err = (*jvmti)->FollowReferences(jvmti, HEAP_FILTER_NONE, NULL, NULL, &callbacks, &ctx);
+    op_record(OP_TAG, start, op_now() - iterStart);
+    if (progress_end(&ctx.progress)) {
+        throw_cancelled(env, "FollowReferences(findReferrerChains)");
+    } else if (ctx.oom == 2) {
+        fprintf(stderr, "[agent] referrer-chain walk stopped at its cap of %lld reference(s)\n",
+                (long long) ctx.max_edges);
+    } else if (ctx.oom) {
+        fprintf(stderr, "[agent] referrer-chain walk out of memory after %lld reference(s)\n",
+                (long long) ctx.n_edges);
+    } else if (err != JVMTI_ERROR_NONE) {
+        check_print(jvmti, err, "FollowReferences(findReferrerChains) failed");
+    } else if (chain_climb(&ctx, maxDepth) == 0) {
+        memset(&callbacks, 0, sizeof(callbacks));
+        callbacks.heap_iteration_callback = &chain_retag_cb;
+        iterStart = op_now();
+        err = (*jvmti)->IterateThroughHeap(jvmti, JVMTI_HEAP_FILTER_UNTAGGED, NULL, &callbacks, &ctx);
+        op_record(OP_TAG, iterStart, op_now() - iterStart);
+        if (err != JVMTI_ERROR_NONE) {
+            check_print(jvmti, err, "IterateThroughHeap(chain roles) failed");
+        } else {
+            result = chain_resolve(env, jvmti, ctx.epoch);
+        }
+    }
+    walk_env_close(jvmti);
+
+    if (result != NULL && kindCounts != NULL) {
+        jsize n = (*env)->GetArrayLength(env, kindCounts);
+        if (n > REFERENCE_KIND_SLOTS) n = REFERENCE_KIND_SLOTS;
+        (*env)->SetLongArrayRegion(env, kindCounts, 0, n, ctx.kind_counts);
+    }
+
+done:
+    free(climb);
+    free(ctx.flags);
+    free(ctx.edge_from);
+    free(ctx.edge_to);
+    return result;
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Holder-class discovery
+ * ---------------------------------------------------------------------------------------------
+ *
+ * A SPEC second pass walks only the instances of the classes it is given, so a class that holds
+ * a source instance but is not listed is never patched. Discovery finds those classes in one
+ * FollowReferences pass, without tagging or resolving any instance: every loaded class's mirror
+ * carries its class mark, so each reported reference names the referree's class (class_tag) and
+ * the referrer's class (referrer_class_tag) directly. A field or array-element reference into an
+ * instance of a source class marks the referrer's class as a holder; a static-field reference
+ * marks the declaring class, whose mirror is the referrer. References from instances of the
+ * source classes themselves are not counted: those instances are the ones replaced.
+ *
+ * A holder the SPEC pass cannot patch on its own (a HashMap node, the backing array of a
+ * collection, a record) is reached through the classes holding it, as a REFERRERS pass climbs
+ * its chains. The Java caller marks the climbed classes; a reference into an instance of one is
+ * recorded as a (referrer class, referree class) pair, and after the walk a breadth-first search
+ * from the climbed classes that hold a source climbs those pairs up to max_depth levels. A class
+ * reached that is not climbed is reported as a holder (an anchor); a climbed class still open at
+ * max_depth, or held by nothing but roots, is reported as it is. The pairs are per class, not per
+ * instance, so their number is bounded by the loaded classes, never by the heap; the price is
+ * that a class holding any instance of a climbed class that reaches a source is reported (every
+ * class with a HashMap field once some HashMap holds one), which widens the SPEC walk but never
+ * misses a holder.
+ */
+
+/** Flags of holder_ctx.reach. */
+#define HOLDER_REACHED 0x01   /* a climbed class with an instance on a chain to a source */
+#define HOLDER_HELD    0x02   /* a climbed class whose instances are held by another class */
+
+/** Per-walk state shared with holder_cb through FollowReferences' user_data. */
+typedef struct {
+    uint32_t epoch;
+    jint n_classes;
+    const unsigned char* source;    /* [n_classes]: 1 for a source class */
+    const unsigned char* climb;     /* [n_classes]: 1 for a climbed class, or NULL */
+    unsigned char* holder;          /* [n_classes]: set for a class whose instances hold a source */
+    unsigned char* static_owner;    /* [n_classes]: set for a class whose static fields do */
+    unsigned char* reach;           /* [n_classes]: HOLDER_* flags of the climbed classes */
+    uint64_t* pairs;                /* open-addressed set of class pairs (see holder_pair_key) */
+    size_t pair_capacity;           /* a power of two, or 0 */
+    size_t n_pairs;
+    int oom;
+    walk_progress progress;
+} holder_ctx;
+
+/** Index of the loaded class whose mirror carries class_tag in this walk, or -1. */
+static jint holder_class_of(const holder_ctx* ctx, jlong class_tag) {
+    uint64_t t = (uint64_t) class_tag;
+    if ((uint32_t)(t >> 32) != ctx->epoch || !(t & CLASS_MARK_FLAG)) return -1;
+    jlong i = (jlong)((uint32_t) t & ~(uint32_t) CLASS_MARK_FLAG) - 1;
+    return i >= 0 && i < ctx->n_classes ? (jint) i : -1;
+}
+
+/** Set key of a reference from class `from` into class `to`; never 0. */
+static uint64_t holder_pair_key(jint from, jint to, int is_static) {
+    return ((uint64_t)(uint32_t)(from + 1) << 32) | ((uint64_t)(uint32_t) to << 1) | (uint64_t)(is_static != 0);
+}
+
+/** Adds a class pair to the set; returns 0, or -1 if the set cannot grow. */
+static int holder_add_pair(holder_ctx* ctx, uint64_t key) {
+    if ((ctx->n_pairs + 1) * 2 > ctx->pair_capacity) {
+        size_t cap = ctx->pair_capacity ? ctx->pair_capacity * 2 : 1024;
+        uint64_t* grown = (uint64_t*) calloc(cap, sizeof(uint64_t));
+        if (!grown) return -1;
+        for (size_t i = 0; i < ctx->pair_capacity; i++) {
+            uint64_t k = ctx->pairs[i];
+            if (!k) continue;
+            size_t j = (size_t)((k * 0x9E3779B97F4A7C15ULL) >> 17) & (cap - 1);
+            while (grown[j]) j = (j + 1) & (cap - 1);
+            grown[j] = k;
+        }
+        free(ctx->pairs);
+        ctx->pairs = grown;
+        ctx->pair_capacity = cap;
+    }
+    size_t j = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 17) & (ctx->pair_capacity - 1);
+    while (ctx->pairs[j]) {
+        if (ctx->pairs[j] == key) return 0;
+        j = (j + 1) & (ctx->pair_capacity - 1);
+    }
+    ctx->pairs[j] = key;
+    ctx->n_pairs++;
+    return 0;
+}
+
+/**
+ * JVMTI heap_reference_callback for holder discovery: marks the class of every referrer of a
+ * source instance, and records the class pair of every reference into an instance of a climbed
+ * class. Never tags an object; returns JVMTI_VISIT_OBJECTS so every reachable object is visited,
+ * unless the walk is cancelled or the pair set cannot grow.
+ */
+static jint JNICALL holder_cb(
+        jvmtiHeapReferenceKind reference_kind,
+        const jvmtiHeapReferenceInfo* reference_info,
+        jlong class_tag,
+        jlong referrer_class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jlong* referrer_tag_ptr,
+        jint length,
+        void* user_data) {
+
+    (void) reference_info;
+    (void) size;
+    (void) tag_ptr;
+    (void) length;
+
+    holder_ctx* ctx = (holder_ctx*) user_data;
+    if (!ctx) return JVMTI_VISIT_OBJECTS;
+    if (progress_visit(&ctx->progress) || ctx->oom) return JVMTI_VISIT_ABORT;
+    if (referrer_tag_ptr == NULL) return JVMTI_VISIT_OBJECTS;      /* a root */
+
+    jint target = holder_class_of(ctx, class_tag);
+    if (target < 0) return JVMTI_VISIT_OBJECTS;
+    int is_static = reference_kind == JVMTI_HEAP_REFERENCE_STATIC_FIELD;
+    if (!is_static && reference_kind != JVMTI_HEAP_REFERENCE_FIELD
+            && reference_kind != JVMTI_HEAP_REFERENCE_ARRAY_ELEMENT) {
+        return JVMTI_VISIT_OBJECTS;
+    }
+    jint k = holder_class_of(ctx, is_static ? *referrer_tag_ptr : referrer_class_tag);
+    if (k < 0) return JVMTI_VISIT_OBJECTS;
+
+    if (ctx->source[target]) {
+        unsigned char* mark = is_static ? ctx->static_owner
+                            : ctx->source[k] ? NULL
+                            : (ctx->climb && ctx->climb[k]) ? ctx->reach : ctx->holder;
+        if (mark && !mark[k]) {
+            mark[k] = mark == ctx->reach ? HOLDER_REACHED : 1;
+            ctx->progress.tagged++;
+        }
+    } else if (ctx->climb && ctx->climb[target] && k != target && (is_static || !ctx->source[k])) {
+        if (holder_add_pair(ctx, holder_pair_key(k, target, is_static)) != 0) {
+            ctx->oom = 1;
+            return JVMTI_VISIT_ABORT;
+        }
+    }
+    return JVMTI_VISIT_OBJECTS;
+}
+
+/** qsort comparator ordering class-pair keys by referree class. */
+static int holder_pair_cmp(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*) a & 0xFFFFFFFFULL, y = *(const uint64_t*) b & 0xFFFFFFFFULL;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Climbs the recorded class pairs from the climbed classes that hold a source, one level per
+ * depth: a referrer class first met is climbed further if it is a climbed class, and is
+ * otherwise an instance holder (or a static owner, for a static-field pair). A climbed class
+ * still open after max_depth levels, or held by no other class, becomes an instance holder
+ * itself. Returns 0, or -1 if out of memory.
+ */
+static int holder_climb(holder_ctx* ctx, jint max_depth) {
+    jint n = ctx->n_classes;
+    size_t np = 0;
+    uint64_t* pairs = (uint64_t*) malloc((ctx->n_pairs > 0 ? ctx->n_pairs : 1) * sizeof(uint64_t));
+    size_t* start = (size_t*) calloc((size_t) n + 1, sizeof(size_t));
+    jint* frontier = (jint*) malloc((size_t) (n > 0 ? n : 1) * sizeof(jint));
+    jint* next = (jint*) malloc((size_t) (n > 0 ? n : 1) * sizeof(jint));
+    if (!pairs || !start || !frontier || !next) {
+        free(pairs); free(start); free(frontier); free(next);
+        return -1;
+    }
+    for (size_t i = 0; i < ctx->pair_capacity; i++) {
+        if (ctx->pairs[i]) pairs[np++] = ctx->pairs[i];
+    }
+    qsort(pairs, np, sizeof(uint64_t), holder_pair_cmp);
+    for (size_t i = 0; i < np; i++) start[((pairs[i] & 0xFFFFFFFFULL) >> 1) + 1]++;
+    for (jint i = 0; i < n; i++) start[i + 1] += start[i];
+
+    jint width = 0;
+    for (jint i = 0; i < n; i++) {
+        if (ctx->reach[i] & HOLDER_REACHED) frontier[width++] = i;
+    }
+    for (jint depth = 1; width > 0; depth++) {
+        jint grown = 0;
+        for (jint f = 0; f < width; f++) {
+            jint t = frontier[f];
+            if (depth >= max_depth) {
+                ctx->holder[t] = 1;     /* still open: patched where it stands */
+                continue;
+            }
+            for (size_t p = start[t]; p < start[t + 1]; p++) {
+                jint k = (jint)(pairs[p] >> 32) - 1;
+                ctx->reach[t] |= HOLDER_HELD;
+                if (pairs[p] & 1) {
+                    ctx->static_owner[k] = 1;
+                } else if (ctx->climb[k]) {
+                    if (!(ctx->reach[k] & HOLDER_REACHED)) {
+                        ctx->reach[k] |= HOLDER_REACHED;
+                        next[grown++] = k;
+                    }
+                } else {
+                    ctx->holder[k] = 1;
+                }
+            }
+            if (!(ctx->reach[t] & HOLDER_HELD)) ctx->holder[t] = 1;
+        }
+        jint* swap = frontier;
+        frontier = next;
+        next = swap;
+        width = grown;
+    }
+    free(pairs);
+    free(start);
+    free(frontier);
+    free(next);
+    return 0;
+}
+
+/** Builds a Class[] of the loaded classes whose flag is set, or NULL on error. */
+static jobjectArray holder_class_array(JNIEnv* env, jclass classClass, jobjectArray classesArray, jint nClasses,
+                                       const unsigned char* flags) {
+    jint n = 0;
+    for (jint i = 0; i < nClasses; i++) n += flags[i] != 0;
+    jobjectArray array = (*env)->NewObjectArray(env, n, classClass, NULL);
+    if (array == NULL) return NULL;
+    jint out = 0;
+    for (jint i = 0; i < nClasses; i++) {
+        if (!flags[i]) continue;
+        jobject c = (*env)->GetObjectArrayElement(env, classesArray, i);
+        (*env)->SetObjectArrayElement(env, array, out++, c);
+        if (c) (*env)->DeleteLocalRef(env, c);
+    }
+    return array;
+}
+
+/**
+ * Finds the classes whose instances or static fields reference an instance of a source class,
+ * climbing past the instances of climbed classes to the classes holding them, in one
+ * FollowReferences pass (see "Holder-class discovery"). Matching of the source classes is on the
+ * exact class.
+ *
+ * @param sourceArray  the source classes (null elements are skipped)
+ * @param classesArray the loaded classes (from nativeLoadedClasses)
+ * @param climbArray   boolean[] parallel to classesArray: true for a class whose instances are
+ *                     climbed through rather than patched in place, or null to climb nothing
+ * @param maxDepth     the number of levels to climb
+ * @return Object[] { Class[] instance holders, Class[] static-field owners }, or NULL on error
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeHolderClasses(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray sourceArray,
+        jobjectArray classesArray,
+        jbooleanArray climbArray,
+        jint maxDepth) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env || sourceArray == NULL || classesArray == NULL) return NULL;
+
+    jint nClasses = (*env)->GetArrayLength(env, classesArray);
+    if (climbArray != NULL && (*env)->GetArrayLength(env, climbArray) != nClasses) return NULL;
+
+    holder_ctx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.epoch = (uint32_t) __sync_add_and_fetch(&g_epoch, 1);
+    ctx.n_classes = nClasses;
+    size_t flagBytes = (size_t) (nClasses > 0 ? nClasses : 1);
+    unsigned char* source = (unsigned char*) calloc(flagBytes, 1);
+    unsigned char* climb = climbArray != NULL ? (unsigned char*) calloc(flagBytes, 1) : NULL;
+    ctx.holder = (unsigned char*) calloc(flagBytes, 1);
+    ctx.static_owner = (unsigned char*) calloc(flagBytes, 1);
+    ctx.reach = (unsigned char*) calloc(flagBytes, 1);
+    ctx.source = source;
+    ctx.climb = climb;
+    int ok = nClasses <= CLASS_MAX_INDEX && source && ctx.holder && ctx.static_owner && ctx.reach
+             && (climb || climbArray == NULL);
+    if (ok && climb) {
+        jboolean* flags = (*env)->GetBooleanArrayElements(env, climbArray, NULL);
+        if (flags == NULL) {
+            ok = 0;
+        } else {
+            for (jint i = 0; i < nClasses; i++) climb[i] = flags[i] != JNI_FALSE;
+            (*env)->ReleaseBooleanArrayElements(env, climbArray, flags, JNI_ABORT);
+        }
+    }
+
+    jobjectArray result = NULL;
+    if (ok) {
+        jlong start = op_now();
+        jvmtiEnv* jvmti = walk_env_open();
+        for (jint i = 0; i < nClasses; i++) {
+            jobject c = (*env)->GetObjectArrayElement(env, classesArray, i);
+            if (c == NULL) continue;
+            jvmtiError terr = (*jvmti)->SetTag(jvmti, c, CLASS_MARK_TAG(ctx.epoch, i));
+            check_print(jvmti, terr, "SetTag(holder class) failed");
+            (*env)->DeleteLocalRef(env, c);
+        }
+        jsize nSources = (*env)->GetArrayLength(env, sourceArray);
+        for (jsize i = 0; i < nSources; i++) {
+            jobject s = (*env)->GetObjectArrayElement(env, sourceArray, i);
+            if (s == NULL) continue;
+            jlong tag = 0;
+            if ((*jvmti)->GetTag(jvmti, s, &tag) == JVMTI_ERROR_NONE) {
+                jint k = holder_class_of(&ctx, tag);
+                if (k >= 0) source[k] = 1;
+            }
+            (*env)->DeleteLocalRef(env, s);
+        }
+
+        jvmtiHeapCallbacks callbacks;
+        memset(&callbacks, 0, sizeof(callbacks));
+        callbacks.heap_reference_callback = &holder_cb;
+
+        progress_begin(&ctx.progress, ctx.epoch);
+        jlong iterStart = op_now();
+        jvmtiError err = (*jvmti)->FollowReferences(jvmti, HEAP_FILTER_NONE, NULL, NULL, &callbacks, &ctx);
+        op_record(OP_TAG, start, op_now() - iterStart);
+        walk_env_close(jvmti);
+
+        if (progress_end(&ctx.progress)) {
+            throw_cancelled(env, "FollowReferences(holderClasses)");
+            ok = 0;
+        } else if (err != JVMTI_ERROR_NONE || ctx.oom) {
+            check_print(g_jvmti, err, "FollowReferences(holderClasses) failed");
+            if (ctx.oom) fprintf(stderr, "[agent] holderClasses: out of memory recording class pairs\n");
+            ok = 0;
+        } else if (holder_climb(&ctx, maxDepth) != 0) {
+            fprintf(stderr, "[agent] holderClasses: out of memory climbing class pairs\n");
+            ok = 0;
+        }
+    }
+
+    if (ok) {
+        jclass objClass = (*env)->FindClass(env, "java/lang/Object");
+        jclass classClass = (*env)->FindClass(env, "java/lang/Class");
+        jobjectArray holders = classClass
+                ? holder_class_array(env, classClass, classesArray, nClasses, ctx.holder) : NULL;
+        jobjectArray owners = classClass
+                ? holder_class_array(env, classClass, classesArray, nClasses, ctx.static_owner) : NULL;
+        if (objClass && holders && owners) {
+            result = (*env)->NewObjectArray(env, 2, objClass, NULL);
+            if (result != NULL) {
+                (*env)->SetObjectArrayElement(env, result, 0, holders);
+                (*env)->SetObjectArrayElement(env, result, 1, owners);
+            }
+        }
+        if (objClass) (*env)->DeleteLocalRef(env, objClass);
+        if (classClass) (*env)->DeleteLocalRef(env, classClass);
+        if (holders) (*env)->DeleteLocalRef(env, holders);
+        if (owners) (*env)->DeleteLocalRef(env, owners);
+    }
+
+    free(source);
+    free(climb);
+    free(ctx.holder);
+    free(ctx.static_owner);
+    free(ctx.reach);
+    free(ctx.pairs);
+    return result;
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Slot patching
+ * ---------------------------------------------------------------------------------------------
+ *
+ * One FollowReferences pass records every (holder, slot, old object) edge, then the slots are
+ * rewritten with JNI. Old objects and holders are tagged with their index into the caller's
+ * arrays, so the callback maps a reference to (holder index, old index) with two tag decodes and
+ * no lookup; nothing is resolved through GetObjectsWithTags because the caller already holds
+ * every object involved.
+ */
+
+/** Low-32-bit flag distinguishing holder tags from old-object tags within one patch walk. */
+#define SLOT_HOLDER_FLAG 0x80000000ULL
+
+/** Largest index encodable in the low 31 bits (stored as index + 1 so a tag is never 0). */
+#define SLOT_MAX_INDEX 0x7FFFFFFE
+
+#define SLOT_OLD_TAG(epoch, i) \
+    ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | (uint64_t)((uint32_t)(i) + 1U)))
+#define SLOT_HOLDER_TAG(epoch, i) \
+    ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | SLOT_HOLDER_FLAG | (uint64_t)((uint32_t)(i) + 1U)))
+
+/** Indices into the stats long[] filled by nativePatchSlots. */
+#define SLOT_STAT_FOUND     0
+#define SLOT_STAT_REWRITTEN 1
+#define SLOT_STAT_SKIPPED   2
+#define SLOT_STAT_COUNT     3
+
+/** One reference from a holder slot to an old object, as reported by FollowReferences. */
+typedef struct {
+    jint holder;   /* index into the holders array */
+    jint old;      /* index into the old/new arrays */
+    jint kind;     /* JVMTI_HEAP_REFERENCE_FIELD / _STATIC_FIELD / _ARRAY_ELEMENT */
+    jint index;    /* JVMTI field index or array index */
+} slot_edge;
+
+/** Per-walk state shared with slot_edge_cb through FollowReferences' user_data. */
+typedef struct {
+    uint32_t epoch;
+    slot_edge* edges;
+    size_t count;
+    size_t capacity;
+    int oom;
+} slot_walk_ctx;
+
+/** Decodes a tag of the current patch walk; returns the index or -1 if the tag is not ours. */
+static jint slot_tag_index(jlong tag, uint32_t epoch, int holder) {
+    uint64_t t = (uint64_t) tag;
+    if ((uint32_t)(t >> 32) != epoch) return -1;
+    uint32_t low = (uint32_t) t;
+    if (((low & SLOT_HOLDER_FLAG) != 0) != (holder != 0)) return -1;
+    low &= ~(uint32_t) SLOT_HOLDER_FLAG;
+    return low == 0 ? -1 : (jint)(low - 1);
+}
+
+/**
+ * JVMTI heap_reference_callback for a patch walk: records every field, static-field or
+ * array-element reference from a tagged holder to a tagged old object. Only the raw-memory
+ * C library is used here (no JNI), as the heap callback rules require. Aborts the walk if the
+ * edge buffer cannot grow.
+ */
+static jint JNICALL slot_edge_cb(
+        jvmtiHeapReferenceKind reference_kind,
+        const jvmtiHeapReferenceInfo* reference_info,
+        jlong class_tag,
+        jlong referrer_class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jlong* referrer_tag_ptr,
+        jint length,
+        void* user_data) {
+
+    (void) class_tag;
+    (void) referrer_class_tag;
+    (void) size;
+    (void) length;
+
+    slot_walk_ctx* ctx = (slot_walk_ctx*) user_data;
+    if (!ctx || !tag_ptr || !referrer_tag_ptr || !reference_info) return JVMTI_VISIT_OBJECTS;
+    if (reference_kind != JVMTI_HEAP_REFERENCE_FIELD &&
+        reference_kind != JVMTI_HEAP_REFERENCE_STATIC_FIELD &&
+        reference_kind != JVMTI_HEAP_REFERENCE_ARRAY_ELEMENT) {
+        return JVMTI_VISIT_OBJECTS;
+    }
+
+    jint old = slot_tag_index(*tag_ptr, ctx->epoch, 0);
+    if (old < 0) return JVMTI_VISIT_OBJECTS;
+    jint holder = slot_tag_index(*referrer_tag_ptr, ctx->epoch, 1);
+    if (holder < 0) return JVMTI_VISIT_OBJECTS;
+
+    if (ctx->count == ctx->capacity) {
+        size_t cap = ctx->capacity ? ctx->capacity * 2 : 1024;
+        slot_edge* grown = (slot_edge*) realloc(ctx->edges, cap * sizeof(slot_edge));
+        if (!grown) {
+            ctx->oom = 1;
+            return JVMTI_VISIT_ABORT;
+        }
+        ctx->edges = grown;
+        ctx->capacity = cap;
+    }
+
+    slot_edge* e = &ctx->edges[ctx->count++];
+    e->holder = holder;
+    e->old = old;
+    e->kind = (jint) reference_kind;
+    e->index = reference_kind == JVMTI_HEAP_REFERENCE_ARRAY_ELEMENT
+            ? reference_info->array.index
+            : reference_info->field.index;
+    return JVMTI_VISIT_OBJECTS;
+}
+
+/** Orders edges by holder so each holder (and its class field table) is looked up once. */
+static int slot_edge_cmp(const void* a, const void* b) {
+    jint ha = ((const slot_edge*) a)->holder;
+    jint hb = ((const slot_edge*) b)->holder;
+    return (ha > hb) - (ha < hb);
+}
+
+/** Resolution state of slot_field.type. */
+#define FIELD_TYPE_UNRESOLVED 0
+#define FIELD_TYPE_ANY        1   /* declared as java.lang.Object: every object fits */
+#define FIELD_TYPE_CLASS      2   /* type holds the declared type */
+#define FIELD_TYPE_UNKNOWN    3   /* could not be resolved: never written */
+
+/** One entry of a class's JVMTI field-index table. */
+typedef struct {
+    jfieldID id;
+    jclass declaring;   /* global ref */
+    jclass type;        /* global ref to the field's declared type, resolved lazily */
+    int type_state;     /* FIELD_TYPE_* */
+    int is_static;
+    int is_final;
+    int is_reference;
+} slot_field;
+
+/** JVMTI field-index table of one class (see build_field_table). */
+typedef struct {
+    jclass klass;       /* global ref */
+    int is_interface;
+    jint base;          /* JVMTI index of fields[0] */
+    jint count;
+    slot_field* fields;
+} slot_class;
+
+typedef struct {
+    slot_class* classes;
+    jint count;
+    jint capacity;
+} slot_class_cache;
+
+/** Appends klass to set (global refs, deduplicated by identity); returns 0 on allocation failure. */
+static int add_distinct_class(JNIEnv* env, jclass** set, jint* n, jint* cap, jclass klass) {
+    for (jint i = 0; i < *n; i++) {
+        if ((*env)->IsSameObject(env, (*set)[i], klass)) return 1;
+    }
+    if (*n == *cap) {
+        jint c = *cap ? *cap * 2 : 8;
+        jclass* grown = (jclass*) realloc(*set, (size_t) c * sizeof(jclass));
+        if (!grown) return 0;
+        *set = grown;
+        *cap = c;
+    }
+    (*set)[(*n)++] = (jclass)(*env)->NewGlobalRef(env, klass);
+    return 1;
+}
+
+/** Collects every interface of klass transitively (superinterfaces included) into set. */
+static void collect_interfaces(JNIEnv* env, jclass klass, jclass** set, jint* n, jint* cap) {
+    jint count = 0;
+    jclass* direct = NULL;
+    if ((*g_jvmti)->GetImplementedInterfaces(g_jvmti, klass, &count, &direct) != JVMTI_ERROR_NONE) {
+        return;
+    }
+    for (jint i = 0; i < count; i++) {
+        jint before = *n;
+        if (add_distinct_class(env, set, n, cap, direct[i]) && *n > before) {
+            collect_interfaces(env, direct[i], set, n, cap);
+        }
+        (*env)->DeleteLocalRef(env, direct[i]);
+    }
+    if (direct) (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) direct);
+}
+
+/** Number of fields (JVMTI GetClassFields) declared by klass, or 0 on error. */
+static jint declared_field_count(jclass klass) {
+    jint count = 0;
+    jfieldID* fields = NULL;
+    if ((*g_jvmti)->GetClassFields(g_jvmti, klass, &count, &fields) != JVMTI_ERROR_NONE) return 0;
+    if (fields) (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) fields);
+    return count;
+}
+
+/** Appends klass's declared fields (GetClassFields order) to table; returns 0 on allocation failure. */
+static int append_declared_fields(JNIEnv* env, slot_class* table, jint* cap, jclass klass) {
+    jint count = 0;
+    jfieldID* fields = NULL;
+    if ((*g_jvmti)->GetClassFields(g_jvmti, klass, &count, &fields) != JVMTI_ERROR_NONE) return 1;
+    int ok = 1;
+    if (table->count + count > *cap) {
+        jint c = table->count + count + 8;
+        slot_field* grown = (slot_field*) realloc(table->fields, (size_t) c * sizeof(slot_field));
+        if (!grown) ok = 0;
+        else { table->fields = grown; *cap = c; }
+    }
+    for (jint i = 0; ok && i < count; i++) {
+        slot_field* f = &table->fields[table->count++];
+        memset(f, 0, sizeof(*f));
+        f->id = fields[i];
+        f->declaring = (jclass)(*env)->NewGlobalRef(env, klass);
+
+        jint modifiers = 0;
+        (*g_jvmti)->GetFieldModifiers(g_jvmti, klass, fields[i], &modifiers);
+        f->is_static = (modifiers & 0x0008) != 0;   /* ACC_STATIC */
+        f->is_final = (modifiers & 0x0010) != 0;    /* ACC_FINAL */
+
+        char* sig = NULL;
+        if ((*g_jvmti)->GetFieldName(g_jvmti, klass, fields[i], NULL, &sig, NULL) == JVMTI_ERROR_NONE && sig) {
+            f->is_reference = sig[0] == 'L' || sig[0] == '[';
+            if (strcmp(sig, "Ljava/lang/Object;") == 0) f->type_state = FIELD_TYPE_ANY;
+            (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) sig);
+        }
+    }
+    if (fields) (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) fields);
+    return ok;
+}
+
+/**
+ * Builds the table mapping JVMTI field indices of klass to jfieldIDs, following the
+ * FollowReferences numbering: for a class, the fields of every interface it implements come
+ * first (only counted), then the fields of java.lang.Object down to klass itself, each class in
+ * GetClassFields order; for an interface, its superinterfaces' fields are counted, then its own
+ * fields follow. Every slot is re-checked against the old object before it is written, so a VM
+ * whose numbering differs only causes skipped slots, never a wrong write.
+ */
+static slot_class* build_field_table(JNIEnv* env, slot_class_cache* cache, jclass klass) {
+    if (cache->count == cache->capacity) {
+        jint c = cache->capacity ? cache->capacity * 2 : 16;
+        slot_class* grown = (slot_class*) realloc(cache->classes, (size_t) c * sizeof(slot_class));
+        if (!grown) return NULL;
+        cache->classes = grown;
+        cache->capacity = c;
+    }
+    slot_class* table = &cache->classes[cache->count];
+    memset(table, 0, sizeof(*table));
+
+    jboolean is_interface = JNI_FALSE;
+    (*g_jvmti)->IsInterface(g_jvmti, klass, &is_interface);
+    table->is_interface = is_interface == JNI_TRUE;
+
+    jclass* interfaces = NULL;
+    jint n_interfaces = 0, interfaces_cap = 0;
+    jclass* chain = NULL;
+    jint n_chain = 0, chain_cap = 0;
+    int ok = 1;
+
+    if (table->is_interface) {
+        collect_interfaces(env, klass, &interfaces, &n_interfaces, &interfaces_cap);
+        ok = add_distinct_class(env, &chain, &n_chain, &chain_cap, klass);
+    } else {
+        jclass k = (jclass)(*env)->NewLocalRef(env, klass);
+        while (ok && k != NULL) {
+            collect_interfaces(env, k, &interfaces, &n_interfaces, &interfaces_cap);
+            ok = add_distinct_class(env, &chain, &n_chain, &chain_cap, k);
+            jclass super = (*env)->GetSuperclass(env, k);
+            (*env)->DeleteLocalRef(env, k);
+            k = super;
+        }
+        if (k) (*env)->DeleteLocalRef(env, k);
+    }
+
+    for (jint i = 0; i < n_interfaces; i++) {
+        table->base += declared_field_count(interfaces[i]);
+        (*env)->DeleteGlobalRef(env, interfaces[i]);
+    }
+    free(interfaces);
+
+    jint fields_cap = 0;
+    for (jint i = n_chain - 1; i >= 0; i--) {   /* java.lang.Object first */
+        if (ok) ok = append_declared_fields(env, table, &fields_cap, chain[i]);
+        (*env)->DeleteGlobalRef(env, chain[i]);
+    }
+    free(chain);
+
+    table->klass = (jclass)(*env)->NewGlobalRef(env, klass);
+    cache->count++;
+    return table;
+}
+
+/** Returns the cached field table of klass, building it on first use. */
+static slot_class* field_table_for(JNIEnv* env, slot_class_cache* cache, jclass klass) {
+    for (jint i = 0; i < cache->count; i++) {
+        if ((*env)->IsSameObject(env, cache->classes[i].klass, klass)) return &cache->classes[i];
+    }
+    return build_field_table(env, cache, klass);
+}
+
+/** Releases every global ref and buffer held by the cache. */
+static void free_field_tables(JNIEnv* env, slot_class_cache* cache) {
+    for (jint i = 0; i < cache->count; i++) {
+        slot_class* t = &cache->classes[i];
+        for (jint j = 0; j < t->count; j++) {
+            if (t->fields[j].declaring) (*env)->DeleteGlobalRef(env, t->fields[j].declaring);
+            if (t->fields[j].type) (*env)->DeleteGlobalRef(env, t->fields[j].type);
+        }
+        free(t->fields);
+        if (t->klass) (*env)->DeleteGlobalRef(env, t->klass);
+    }
+    free(cache->classes);
+}
+
+/**
+ * True if value may be stored in field f: resolves the field's declared type once through
+ * java.lang.reflect.Field#getType (JNI has no direct accessor) and checks IsInstanceOf. JNI
+ * Set*Field performs no such check itself, so skipping it could corrupt the heap.
+ */
+static int field_accepts(JNIEnv* env, slot_field* f, jobject value) {
+    if (f->type_state == FIELD_TYPE_UNRESOLVED) {
+        f->type_state = FIELD_TYPE_UNKNOWN;
+        jobject reflected = (*env)->ToReflectedField(env, f->declaring, f->id,
+                                                     f->is_static ? JNI_TRUE : JNI_FALSE);
+        if (reflected) {
+            jclass fieldClass = (*env)->GetObjectClass(env, reflected);
+            jmethodID getType = (*env)->GetMethodID(env, fieldClass, "getType", "()Ljava/lang/Class;");
+            jobject type = getType ? (*env)->CallObjectMethod(env, reflected, getType) : NULL;
+            if ((*env)->ExceptionCheck(env)) (*env)->ExceptionClear(env);
+            if (type) {
+                f->type = (jclass)(*env)->NewGlobalRef(env, type);
+                f->type_state = FIELD_TYPE_CLASS;
+                (*env)->DeleteLocalRef(env, type);
+            }
+            (*env)->DeleteLocalRef(env, fieldClass);
+            (*env)->DeleteLocalRef(env, reflected);
+        }
+    }
+    if (f->type_state == FIELD_TYPE_ANY) return 1;
+    if (f->type_state == FIELD_TYPE_CLASS) return (*env)->IsInstanceOf(env, value, f->type);
+    return 0;   /* unresolvable type: never write blind */
+}
+
+/**
+ * Rewrites one edge. The slot is re-read and compared with the old object first, so only a
+ * slot that still holds exactly that object is written. Returns 1 if the slot was rewritten.
+ */
+static int patch_slot(JNIEnv* env, slot_class_cache* cache, jobject holder, const slot_edge* e,
+                      jobject oldObj, jobject newObj) {
+    if (e->kind == JVMTI_HEAP_REFERENCE_ARRAY_ELEMENT) {
+        jobject current = (*env)->GetObjectArrayElement(env, (jobjectArray) holder, e->index);
+        int same = !(*env)->ExceptionCheck(env) && (*env)->IsSameObject(env, current, oldObj);
+        if ((*env)->ExceptionCheck(env)) (*env)->ExceptionClear(env);
+        if (current) (*env)->DeleteLocalRef(env, current);
+        if (!same) return 0;
+        /* SetObjectArrayElement performs the array store check (ArrayStoreException). */
+        (*env)->SetObjectArrayElement(env, (jobjectArray) holder, e->index, newObj);
+        if ((*env)->ExceptionCheck(env)) {
+            (*env)->ExceptionClear(env);
+            return 0;
+        }
+        return 1;
+    }
+
+    int is_static = e->kind == JVMTI_HEAP_REFERENCE_STATIC_FIELD;
+    jclass klass = is_static ? (jclass) holder : (*env)->GetObjectClass(env, holder);
+    slot_class* table = field_table_for(env, cache, klass);
+    if (!is_static) (*env)->DeleteLocalRef(env, klass);
+    if (!table) return 0;
+
+    jint i = e->index - table->base;
+    if (i < 0 || i >= table->count) return 0;
+    slot_field* f = &table->fields[i];
+    if (!f->is_reference || f->is_static != is_static) return 0;
+    /*
+     * Finals are never written: static finals may be constant-folded by the JIT, and instance
+     * finals of hidden classes and records are trusted as constants too. The Java patcher decides
+     * (it refuses what reflection refuses and reports the rest).
+     */
+    if (f->is_final) return 0;
+
+    jobject current = is_static
+            ? (*env)->GetStaticObjectField(env, (jclass) holder, f->id)
+            : (*env)->GetObjectField(env, holder, f->id);
+    int same = (*env)->IsSameObject(env, current, oldObj);
+    if (current) (*env)->DeleteLocalRef(env, current);
+    if (!same || !field_accepts(env, f, newObj)) return 0;
+
+    if (is_static) {
+        (*env)->SetStaticObjectField(env, (jclass) holder, f->id, newObj);
+    } else {
+        (*env)->SetObjectField(env, holder, f->id, newObj);
+    }
+    return 1;
+}
+
+/**
+ * Rewrites, in the given holders, every field, static field and array element that references
+ * one of oldObjects with the newObjects entry at the same index.
+ *
+ * Old objects and holders are tagged with their array indices, one FollowReferences pass records
+ * the (holder, slot, old) edges, and the edges are applied with SetObjectField /
+ * SetStaticObjectField / SetObjectArrayElement. A slot is skipped (left for the Java patcher)
+ * when it no longer holds the old object, the new object does not fit its declared type, or it
+ * is a final field. Holders must be Class objects for static fields.
+ *
+ * @param holdersArray the objects whose slots to rewrite
+ * @param oldArray     the migrated (old) objects
+ * @param newArray     the replacement for each old object (same length as oldArray)
+ * @param stats        optional long[3]: slots found, rewritten, skipped
+ * @return Array of holders with at least one skipped slot, or NULL if none (or on error, in
+ *         which case stats are left untouched)
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_migrator_heap_NativeHeapWalker_nativePatchSlots(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray holdersArray,
+        jobjectArray oldArray,
+        jobjectArray newArray,
+        jlongArray stats) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env || !holdersArray || !oldArray || !newArray) return NULL;
+
+    jsize nHolders = (*env)->GetArrayLength(env, holdersArray);
+    jsize nOld = (*env)->GetArrayLength(env, oldArray);
+    if (nHolders == 0 || nOld == 0) return NULL;
+    if (nOld != (*env)->GetArrayLength(env, newArray) ||
+        nHolders > SLOT_MAX_INDEX || nOld > SLOT_MAX_INDEX) {
+        return NULL;
+    }
+
+    slot_walk_ctx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.epoch = (uint32_t) __sync_add_and_fetch(&g_epoch, 1);
+
+    jlong start = op_now();
+    jvmtiEnv* jvmti = walk_env_open();
+    for (jsize i = 0; i < nOld; i++) {
+        jobject o = (*env)->GetObjectArrayElement(env, oldArray, i);
+        if (o == NULL) continue;
+        jvmtiError terr = (*jvmti)->SetTag(jvmti, o, SLOT_OLD_TAG(ctx.epoch, i));
+        check_print(jvmti, terr, "SetTag(old object) failed");
+        (*env)->DeleteLocalRef(env, o);
+    }
+    /* Holders are tagged after the old objects so an object that is both keeps the holder tag. */
+    for (jsize i = 0; i < nHolders; i++) {
+        jobject h = (*env)->GetObjectArrayElement(env, holdersArray, i);
+        if (h == NULL) continue;
+        jvmtiError terr = (*jvmti)->SetTag(jvmti, h, SLOT_HOLDER_TAG(ctx.epoch, i));
+        check_print(jvmti, terr, "SetTag(holder) failed");
+        (*env)->DeleteLocalRef(env, h);
+    }
+
+    jvmtiHeapCallbacks callbacks;
+    memset(&callbacks, 0, sizeof(callbacks));
+    callbacks.heap_reference_callback = &slot_edge_cb;
+
+    jlong iterStart = op_now();
+    jvmtiError err = (*jvmti)->FollowReferences(
+            jvmti, HEAP_FILTER_NONE, NULL, NULL, &callbacks, &ctx);
+    op_record(OP_TAG, start, op_now() - iterStart);
+    /* the edges are recorded: the walk's tags are no longer needed */
+    walk_env_close(jvmti);
+    if (err != JVMTI_ERROR_NONE || ctx.oom) {
+        check_print(g_jvmti, err, "FollowReferences(patchSlots) failed");
+        if (ctx.oom) fprintf(stderr, "[agent] patchSlots: out of memory recording edges\n");
+        free(ctx.edges);
+        return NULL;
+    }
+
+    qsort(ctx.edges, ctx.count, sizeof(slot_edge), slot_edge_cmp);
+
+    unsigned char* skippedHolder = (unsigned char*) calloc((size_t) nHolders, 1);
+    slot_class_cache cache;
+    memset(&cache, 0, sizeof(cache));
+    jlong counts[SLOT_STAT_COUNT] = { (jlong) ctx.count, 0, 0 };
+    jint nSkippedHolders = 0;
+
+    size_t e = 0;
+    while (e < ctx.count) {
+        jint h = ctx.edges[e].holder;
+        jobject holder = (*env)->GetObjectArrayElement(env, holdersArray, h);
+        for (; e < ctx.count && ctx.edges[e].holder == h; e++) {
+            const slot_edge* edge = &ctx.edges[e];
+            jobject oldObj = (*env)->GetObjectArrayElement(env, oldArray, edge->old);
+            jobject newObj = (*env)->GetObjectArrayElement(env, newArray, edge->old);
+            int done = holder != NULL && newObj != NULL &&
+                       patch_slot(env, &cache, holder, edge, oldObj, newObj);
+            if (done) {
+                counts[SLOT_STAT_REWRITTEN]++;
+            } else {
+                counts[SLOT_STAT_SKIPPED]++;
+                if (skippedHolder && !skippedHolder[h]) {
+                    skippedHolder[h] = 1;
+                    nSkippedHolders++;
+                }
+            }
+            if (oldObj) (*env)->DeleteLocalRef(env, oldObj);
+            if (newObj) (*env)->DeleteLocalRef(env, newObj);
+        }
+        if (holder) (*env)->DeleteLocalRef(env, holder);
+    }
+
+    free_field_tables(env, &cache);
+    free(ctx.edges);
+
+    if (stats != NULL) {
+        jsize n = (*env)->GetArrayLength(env, stats);
+        if (n > SLOT_STAT_COUNT) n = SLOT_STAT_COUNT;
+        (*env)->SetLongArrayRegion(env, stats, 0, n, counts);
+    }
+
+    jobjectArray result = NULL;
+    if (nSkippedHolders > 0 && skippedHolder) {
+        jclass objClass = (*env)->FindClass(env, "java/lang/Object");
+        if (objClass != NULL) {
+            result = (*env)->NewObjectArray(env, nSkippedHolders, objClass, NULL);
+            (*env)->DeleteLocalRef(env, objClass);
+        }
+        jsize out = 0;
+        for (jsize i = 0; result != NULL && i < nHolders; i++) {
+            if (!skippedHolder[i]) continue;
+            jobject h = (*env)->GetObjectArrayElement(env, holdersArray, i);
+            (*env)->SetObjectArrayElement(env, result, out++, h);
+            if (h) (*env)->DeleteLocalRef(env, h);
+        }
+    }
+    free(skippedHolder);
+    return result;
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Stack-local patching
+ * ---------------------------------------------------------------------------------------------
+ *
+ * A thread suspended in the middle of a request still holds old objects in its frames, where no
+ * heap patcher can see them. One FollowReferences pass reports every stack-local and JNI-local
+ * root that references an old object, with the thread, frame depth and slot it sits in; old
+ * objects and the suspended threads are tagged with their indices (the slot-patching tags), so
+ * the callback maps a root to (thread, old object) with two tag decodes. The callback never lets
+ * the walk go past the roots, so the pass costs the roots only, not the heap.
+ *
+ * Each local is then re-read with GetLocalObject and written with SetLocalObject. A local is only
+ * written when its method has a LocalVariableTable entry covering the slot at the frame's
+ * location: the VM then refuses (JVMTI_ERROR_TYPE_MISMATCH) a replacement that is not
+ * assignable to the local's declared type, whereas without the table it would store any object
+ * and the frame would continue with a value of the wrong class. Operand-stack values, JNI locals
+ * and native frames cannot be written at all; they are reported with the reason.
+ *
+ * Local access needs can_access_local_variables, which HotSpot grants only while the VM starts:
+ * load the agent with -agentpath:...=stacklocals to acquire it then. The environment holding it
+ * is kept for the life of the VM.
+ */
+
+static jvmtiEnv* g_locals_jvmti = NULL;
+
+/** Indices into the stats long[] filled by nativePatchStackLocals. */
+#define LOCAL_STAT_FOUND     0
+#define LOCAL_STAT_REWRITTEN 1
+#define LOCAL_STAT_OTHER     2
+#define LOCAL_STAT_COUNT     3
+
+/** Why a local was not rewritten; mirrored by migrator.heap.StackLocalPatchResult.Reason. */
+#define LOCAL_OPERAND_STACK  0
+#define LOCAL_JNI_LOCAL      1
+#define LOCAL_NO_LOCAL_TYPES 2
+#define LOCAL_TYPE_MISMATCH  3
+#define LOCAL_OPAQUE_FRAME   4
+#define LOCAL_CHANGED        5
+#define LOCAL_FAILED         6
+
+/** Longs per unpatched local in the report: depth, slot, location, reason. */
+#define LOCAL_REPORT_WIDTH 4
+
+/** Creates the local-access environment on first use; returns it, or NULL if local access is unavailable. */
+static jvmtiEnv* locals_env(void) {
+    if (g_locals_jvmti) return g_locals_jvmti;
+    if (!g_vm) return NULL;
+
+    jvmtiEnv* jvmti = NULL;
+    if ((*g_vm)->GetEnv(g_vm, (void**) &jvmti, JVMTI_VERSION_1_2) != JNI_OK || !jvmti) return NULL;
+
+    jvmtiCapabilities caps;
+    memset(&caps, 0, sizeof(caps));
+    caps.can_access_local_variables = 1;
+    jvmtiError err = (*jvmti)->AddCapabilities(jvmti, &caps);
+    if (err != JVMTI_ERROR_NONE) {
+        check_print(jvmti, err, "AddCapabilities(can_access_local_variables) failed");
+        (*jvmti)->DisposeEnvironment(jvmti);
+        return NULL;
+    }
+    if (!__sync_bool_compare_and_swap(&g_locals_jvmti, NULL, jvmti)) {
+        (*jvmti)->DisposeEnvironment(jvmti);
+    }
+    return g_locals_jvmti;
+}
+
+/** One stack-local or JNI-local root referencing an old object. */
+typedef struct {
+    jint thread;          /* index into the threads array */
+    jint old;             /* index into the old/new arrays */
+    jint kind;            /* JVMTI_HEAP_REFERENCE_STACK_LOCAL / _JNI_LOCAL */
+    jint depth;           /* frame depth, as for GetLocalObject */
+    jint slot;            /* local slot, or -1 (operand stack, JNI local) */
+    jint reason;          /* LOCAL_* once the local was not rewritten, else -1 */
+    jlocation location;
+    jmethodID method;
+} local_edge;
+
+/** Per-walk state shared with local_edge_cb through FollowReferences' user_data. */
+typedef struct {
+    uint32_t epoch;
+    local_edge* edges;
+    size_t count;
+    size_t capacity;
+    jlong other_threads;
+    int oom;
+} local_walk_ctx;
+
+/**
+ * JVMTI heap_reference_callback for a stack-local walk: records every stack-local and JNI-local
+ * root of a tagged thread that references a tagged old object, and counts those of other threads.
+ * Never follows a reference, so only the roots are visited.
+ */
+static jint JNICALL local_edge_cb(
+        jvmtiHeapReferenceKind reference_kind,
+        const jvmtiHeapReferenceInfo* reference_info,
+        jlong class_tag,
+        jlong referrer_class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jlong* referrer_tag_ptr,
+        jint length,
+        void* user_data) {
+
+    (void) class_tag;
+    (void) referrer_class_tag;
+    (void) size;
+    (void) referrer_tag_ptr;
+    (void) length;
+
+    local_walk_ctx* ctx = (local_walk_ctx*) user_data;
+    if (!ctx || !tag_ptr || !reference_info) return 0;
+    if (reference_kind != JVMTI_HEAP_REFERENCE_STACK_LOCAL &&
+        reference_kind != JVMTI_HEAP_REFERENCE_JNI_LOCAL) {
+        return 0;
+    }
+
+    jint old = slot_tag_index(*tag_ptr, ctx->epoch, 0);
+    if (old < 0) return 0;
+    int stack = reference_kind == JVMTI_HEAP_REFERENCE_STACK_LOCAL;
+    jlong thread_tag = stack ? reference_info->stack_local.thread_tag : reference_info->jni_local.thread_tag;
+    jint thread = slot_tag_index(thread_tag, ctx->epoch, 1);
+    if (thread < 0) {
+        ctx->other_threads++;
+        return 0;
+    }
+
+    if (ctx->count == ctx->capacity) {
+        size_t cap = ctx->capacity ? ctx->capacity * 2 : 256;
+        local_edge* grown = (local_edge*) realloc(ctx->edges, cap * sizeof(local_edge));
+        if (!grown) {
+            ctx->oom = 1;
+            return JVMTI_VISIT_ABORT;
+        }
+        ctx->edges = grown;
+        ctx->capacity = cap;
+    }
+
+    local_edge* e = &ctx->edges[ctx->count++];
+    e->thread = thread;
+    e->old = old;
+    e->kind = (jint) reference_kind;
+    e->depth = stack ? reference_info->stack_local.depth : reference_info->jni_local.depth;
+    e->slot = stack ? reference_info->stack_local.slot : -1;
+    e->location = stack ? reference_info->stack_local.location : -1;
+    e->method = stack ? reference_info->stack_local.method : reference_info->jni_local.method;
+    e->reason = -1;
+    return 0;
+}
+
+/** True if method has a LocalVariableTable entry for slot that is live at location. */
+static int local_has_type(jvmtiEnv* jvmti, jmethodID method, jint slot, jlocation location) {
+    jint count = 0;
+    jvmtiLocalVariableEntry* table = NULL;
+    if (!method || (*jvmti)->GetLocalVariableTable(jvmti, method, &count, &table) != JVMTI_ERROR_NONE) {
+        return 0;
+    }
+    int found = 0;
+    for (jint i = 0; i < count; i++) {
+        if (table[i].slot == slot && location >= table[i].start_location &&
+            location < table[i].start_location + table[i].length) {
+            found = 1;
+        }
+        (*jvmti)->Deallocate(jvmti, (unsigned char*) table[i].name);
+        (*jvmti)->Deallocate(jvmti, (unsigned char*) table[i].signature);
+        if (table[i].generic_signature) (*jvmti)->Deallocate(jvmti, (unsigned char*) table[i].generic_signature);
+    }
+    (*jvmti)->Deallocate(jvmti, (unsigned char*) table);
+    return found;
+}
+
+/** Maps the JVMTI error of a local read or write to a LOCAL_* reason. */
+static jint local_error_reason(jvmtiError err) {
+    if (err == JVMTI_ERROR_TYPE_MISMATCH) return LOCAL_TYPE_MISMATCH;
+    if (err == JVMTI_ERROR_OPAQUE_FRAME) return LOCAL_OPAQUE_FRAME;
+    return LOCAL_FAILED;
+}
+
+/**
+ * Rewrites one stack local after re-reading it. Returns -1 if the local was rewritten, or the
+ * LOCAL_* reason it was not.
+ */
+static jint patch_local(JNIEnv* env, jvmtiEnv* jvmti, jthread thread, const local_edge* e,
+                        jobject oldObj, jobject newObj) {
+    if (e->kind == JVMTI_HEAP_REFERENCE_JNI_LOCAL) return LOCAL_JNI_LOCAL;
+    if (e->slot < 0) return LOCAL_OPERAND_STACK;
+    if (!local_has_type(jvmti, e->method, e->slot, e->location)) return LOCAL_NO_LOCAL_TYPES;
+
+    jobject current = NULL;
+    jvmtiError err = (*jvmti)->GetLocalObject(jvmti, thread, e->depth, e->slot, &current);
+    if (err != JVMTI_ERROR_NONE) return local_error_reason(err);
+    int same = (*env)->IsSameObject(env, current, oldObj);
+    if (current) (*env)->DeleteLocalRef(env, current);
+    if (!same) return LOCAL_CHANGED;
+
+    /* checks the replacement against the local's declared type, from the table checked above */
+    err = (*jvmti)->SetLocalObject(jvmti, thread, e->depth, e->slot, newObj);
+    return err == JVMTI_ERROR_NONE ? -1 : local_error_reason(err);
+}
+
+/** Returns "pkg.Class.method" for a JVMTI method ID, or NULL. */
+static jstring method_label(JNIEnv* env, jvmtiEnv* jvmti, jmethodID method) {
+    if (!method) return NULL;
+    char* name = NULL;
+    char* signature = NULL;
+    jclass declaring = NULL;
+    jstring label = NULL;
+    if ((*jvmti)->GetMethodName(jvmti, method, &name, NULL, NULL) == JVMTI_ERROR_NONE &&
+        (*jvmti)->GetMethodDeclaringClass(jvmti, method, &declaring) == JVMTI_ERROR_NONE &&
+        (*jvmti)->GetClassSignature(jvmti, declaring, &signature, NULL) == JVMTI_ERROR_NONE) {
+        /* "Lpkg/Class;" -> "pkg.Class" */
+        size_t len = strlen(signature);
+        size_t n = len >= 2 ? len - 2 : 0;
+        char* buf = (char*) malloc(n + strlen(name) + 2);
+        if (buf) {
+            for (size_t i = 0; i < n; i++) buf[i] = signature[i + 1] == '/' ? '.' : signature[i + 1];
+            buf[n] = '.';
+            strcpy(buf + n + 1, name);
+            label = (*env)->NewStringUTF(env, buf);
+            free(buf);
+        }
+    }
+    if (name) (*jvmti)->Deallocate(jvmti, (unsigned char*) name);
+    if (signature) (*jvmti)->Deallocate(jvmti, (unsigned char*) signature);
+    if (declaring) (*env)->DeleteLocalRef(env, declaring);
+    return label;
+}
+
+/**
+ * Builds the report of the locals not rewritten: Object[] { Thread[], String[] methods,
+ * long[] { depth, slot, location, reason } per local }, or NULL if every local was rewritten.
+ */
+static jobjectArray local_report(JNIEnv* env, jvmtiEnv* jvmti, jobjectArray threadsArray,
+                                 const local_walk_ctx* ctx, jint skipped) {
+    if (skipped == 0) return NULL;
+    jclass objClass = (*env)->FindClass(env, "java/lang/Object");
+    jclass threadClass = (*env)->FindClass(env, "java/lang/Thread");
+    jclass stringClass = (*env)->FindClass(env, "java/lang/String");
+    jobjectArray report = NULL;
+    if (objClass && threadClass && stringClass) {
+        jobjectArray outThreads = (*env)->NewObjectArray(env, skipped, threadClass, NULL);
+        jobjectArray outMethods = (*env)->NewObjectArray(env, skipped, stringClass, NULL);
+        jlongArray outLocals = (*env)->NewLongArray(env, skipped * LOCAL_REPORT_WIDTH);
+        if (outThreads && outMethods && outLocals) {
+            jint k = 0;
+            for (size_t i = 0; i < ctx->count && k < skipped; i++) {
+                const local_edge* e = &ctx->edges[i];
+                if (e->reason < 0) continue;
+                jobject t = (*env)->GetObjectArrayElement(env, threadsArray, e->thread);
+                (*env)->SetObjectArrayElement(env, outThreads, k, t);
+                if (t) (*env)->DeleteLocalRef(env, t);
+                jstring label = method_label(env, jvmti, e->method);
+                if (label) {
+                    (*env)->SetObjectArrayElement(env, outMethods, k, label);
+                    (*env)->DeleteLocalRef(env, label);
+                }
+                jlong row[LOCAL_REPORT_WIDTH] = { e->depth, e->slot, (jlong) e->location, e->reason };
+                (*env)->SetLongArrayRegion(env, outLocals, k * LOCAL_REPORT_WIDTH, LOCAL_REPORT_WIDTH, row);
+                k++;
+            }
+            report = (*env)->NewObjectArray(env, 3, objClass, NULL);
+            if (report) {
+                (*env)->SetObjectArrayElement(env, report, 0, outThreads);
+                (*env)->SetObjectArrayElement(env, report, 1, outMethods);
+                (*env)->SetObjectArrayElement(env, report, 2, outLocals);
+            }
+        }
+        if (outThreads) (*env)->DeleteLocalRef(env, outThreads);
+        if (outMethods) (*env)->DeleteLocalRef(env, outMethods);
+        if (outLocals) (*env)->DeleteLocalRef(env, outLocals);
+    }
+    if (objClass) (*env)->DeleteLocalRef(env, objClass);
+    if (threadClass) (*env)->DeleteLocalRef(env, threadClass);
+    if (stringClass) (*env)->DeleteLocalRef(env, stringClass);
+    return report;
+}
+
+/**
+ * Rewrites, in the frames of the given suspended threads, every local variable that references
+ * one of oldObjects with the newObjects entry at the same index.
+ *
+ * The threads must be suspended (or be the calling thread). Locals that cannot be rewritten are
+ * reported with the reason; references held by threads that were not passed are counted only.
+ *
+ * @param threadsArray the suspended threads whose frames to patch
+ * @param oldArray     the migrated (old) objects
+ * @param newArray     the replacement for each old object (same length as oldArray)
+ * @param stats        long[3]: locals found, rewritten, references held by other threads
+ * @return the locals not rewritten (see local_report), or NULL if none (or on error, in which
+ *         case stats are left untouched)
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_migrator_heap_NativeHeapWalker_nativePatchStackLocals(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray threadsArray,
+        jobjectArray oldArray,
+        jobjectArray newArray,
+        jlongArray stats) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env || !threadsArray || !oldArray || !newArray || !stats) return NULL;
+
+    jsize nThreads = (*env)->GetArrayLength(env, threadsArray);
+    jsize nOld = (*env)->GetArrayLength(env, oldArray);
+    if (nOld != (*env)->GetArrayLength(env, newArray) ||
+        nThreads > SLOT_MAX_INDEX || nOld > SLOT_MAX_INDEX) {
+        return NULL;
+    }
+    jvmtiEnv* locals = locals_env();
+    if (!locals) return NULL;
+
+    local_walk_ctx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.epoch = (uint32_t) __sync_add_and_fetch(&g_epoch, 1);
+
+    jlong start = op_now();
+    jvmtiEnv* jvmti = walk_env_open();
+    for (jsize i = 0; i < nOld; i++) {
+        jobject o = (*env)->GetObjectArrayElement(env, oldArray, i);
+        if (o == NULL) continue;
+        jvmtiError terr = (*jvmti)->SetTag(jvmti, o, SLOT_OLD_TAG(ctx.epoch, i));
+        check_print(jvmti, terr, "SetTag(old object) failed");
+        (*env)->DeleteLocalRef(env, o);
+    }
+    for (jsize i = 0; i < nThreads; i++) {
+        jobject t = (*env)->GetObjectArrayElement(env, threadsArray, i);
+        if (t == NULL) continue;
+        jvmtiError terr = (*jvmti)->SetTag(jvmti, t, SLOT_HOLDER_TAG(ctx.epoch, i));
+        check_print(jvmti, terr, "SetTag(thread) failed");
+        (*env)->DeleteLocalRef(env, t);
+    }
+
+    jvmtiHeapCallbacks callbacks;
+    memset(&callbacks, 0, sizeof(callbacks));
+    callbacks.heap_reference_callback = &local_edge_cb;
+
+    jlong iterStart = op_now();
+    jvmtiError err = (*jvmti)->FollowReferences(
+            jvmti, HEAP_FILTER_NONE, NULL, NULL, &callbacks, &ctx);
+    op_record(OP_TAG, start, op_now() - iterStart);
+    walk_env_close(jvmti);
+    if (err != JVMTI_ERROR_NONE || ctx.oom) {
+        check_print(g_jvmti, err, "FollowReferences(patchStackLocals) failed");
+        if (ctx.oom) fprintf(stderr, "[agent] patchStackLocals: out of memory recording locals\n");
+        free(ctx.edges);
+        return NULL;
+    }
+
+    jlong counts[LOCAL_STAT_COUNT] = { (jlong) ctx.count, 0, ctx.other_threads };
+    jint skipped = 0;
+    for (size_t i = 0; i < ctx.count; i++) {
+        local_edge* e = &ctx.edges[i];
+        jthread thread = (jthread) (*env)->GetObjectArrayElement(env, threadsArray, e->thread);
+        jobject oldObj = (*env)->GetObjectArrayElement(env, oldArray, e->old);
+        jobject newObj = (*env)->GetObjectArrayElement(env, newArray, e->old);
+        e->reason = newObj != NULL && thread != NULL
+                ? patch_local(env, locals, thread, e, oldObj, newObj)
+                : LOCAL_FAILED;
+        if (e->reason < 0) {
+            counts[LOCAL_STAT_REWRITTEN]++;
+        } else {
+            skipped++;
+        }
+        if (thread) (*env)->DeleteLocalRef(env, thread);
+        if (oldObj) (*env)->DeleteLocalRef(env, oldObj);
+        if (newObj) (*env)->DeleteLocalRef(env, newObj);
+    }
+
+    jobjectArray report = local_report(env, locals, threadsArray, &ctx, skipped);
+    free(ctx.edges);
+
+    jsize n = (*env)->GetArrayLength(env, stats);
+    if (n > LOCAL_STAT_COUNT) n = LOCAL_STAT_COUNT;
+    (*env)->SetLongArrayRegion(env, stats, 0, n, counts);
+    return report;
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Residual-reference verification
+ * ---------------------------------------------------------------------------------------------
+ *
+ * Once the patch passes are done no old object should be reachable. A verification walk gives
+ * every object it reaches a node in a native table (the object's tag is its node index) holding
+ * the reference it was reached by and its distance from the roots, so an old object that is
+ * still reachable comes with a root path at no extra cost. FollowReferences visits depth-first,
+ * so an object may first be reached along a longer path: every reported reference relaxes its
+ * referree's distance, and the walk runs again while a pass still shortened one. A pass that
+ * shortens nothing proves every distance exact. A walk that reaches no old object stops after
+ * its first pass, which is the expected outcome.
+ *
+ * Loaded classes are numbered before the walk so each node records its class from class_tag;
+ * class and field names are then resolved for the reported paths only. Primitive arrays can
+ * hold no reference and get no node. The native table costs 20 bytes per reachable object for
+ * the duration of the call.
+ *
+ * The caller's own bookkeeping (the forwarding table, its working sets, the thread running the
+ * migration) keeps every old object reachable by design: excluded objects are neither reported
+ * nor followed, and stack and JNI-local roots of an excluded thread are ignored. The calling
+ * thread and the argument arrays are always excluded.
+ */
+
+/** Passes a verification walk may take to make its root paths shortest. */
+#define VERIFY_MAX_PASSES 4
+
+/** Longest root path reported; a longer one keeps the links nearest its old object. */
+#define VERIFY_MAX_PATH 64
+
+/** Largest node index encodable in a tag (stored as index + 1 so a tag is never 0). */
+#define VERIFY_MAX_NODES 0x7FFFFFFE
+
+/** Distance of a node that no reference has reached yet. */
+#define VERIFY_UNREACHED INT_MAX
+
+#define VERIFY_NODE_TAG(epoch, i) \
+    ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | (uint64_t)((uint32_t)(i) + 1U)))
+#define VERIFY_EXCLUDED_TAG(epoch) \
+    ((jlong)((((uint64_t)(uint32_t)(epoch)) << 32) | 0xFFFFFFFFULL))
+
+/** Indices into the stats long[] filled by nativeVerifyResidual. */
+#define VERIFY_STAT_REACHED 0
+#define VERIFY_STAT_PASSES  1
+#define VERIFY_STAT_EXACT   2
+#define VERIFY_STAT_COUNT   3
+
+/** One reachable object of a verification walk. */
+typedef struct {
+    jint parent;   /* node of the referrer, or -1 for a heap root */
+    jint depth;    /* references from the roots, or VERIFY_UNREACHED */
+    jint klass;    /* index into the loaded classes, or -1 if unknown */
+    jint kind;     /* jvmtiHeapReferenceKind of the reference from parent */
+    jint index;    /* JVMTI field index or array index of that reference, or -1 */
+} verify_node;
+
+/**
+ * Per-walk state shared with verify_cb through FollowReferences' user_data. Nodes
+ * [0, n_targets) are the old objects, [class_base, class_base + n_classes) the loaded classes;
+ * the objects reached are numbered from there on.
+ */
+typedef struct {
+    uint32_t epoch;
+    jlong excluded_tag;
+    verify_node* nodes;
+    jint count;
+    jint capacity;
+    jint n_targets;
+    jint class_base;
+    jint n_classes;
+    const unsigned char* primitive_array;   /* [n_classes]: 1 for a primitive array class */
+    int first_pass;
+    jlong shortened;
+    int oom;
+    jlong kind_counts[REFERENCE_KIND_SLOTS];
+    walk_progress progress;
+} verify_ctx;
+
+/** Decodes a node tag of the current verification walk; returns the node or -1. */
+static jint verify_node_of(const verify_ctx* ctx, jlong tag) {
+    uint64_t t = (uint64_t) tag;
+    if ((uint32_t)(t >> 32) != ctx->epoch) return -1;
+    uint32_t low = (uint32_t) t;
+    if (low == 0 || low > (uint32_t) ctx->count) return -1;
+    return (jint)(low - 1);
+}
+
+/** Index of the class whose mirror carries class_tag, or -1. */
+static jint verify_class_of(const verify_ctx* ctx, jlong class_tag) {
+    jint node = verify_node_of(ctx, class_tag);
+    if (node < ctx->class_base || node >= ctx->class_base + ctx->n_classes) return -1;
+    return node - ctx->class_base;
+}
+
+/** Appends an unreached node; returns its index, or -1 if the table cannot grow. */
+static jint verify_add_node(verify_ctx* ctx, jint klass) {
+    if (ctx->count == ctx->capacity) {
+        if (ctx->capacity >= VERIFY_MAX_NODES) return -1;
+        jint cap = ctx->capacity > VERIFY_MAX_NODES / 2 ? VERIFY_MAX_NODES : ctx->capacity * 2;
+        verify_node* grown = (verify_node*) realloc(ctx->nodes, (size_t) cap * sizeof(verify_node));
+        if (!grown) return -1;
+        ctx->nodes = grown;
+        ctx->capacity = cap;
+    }
+    verify_node* n = &ctx->nodes[ctx->count];
+    n->parent = -1;
+    n->depth = VERIFY_UNREACHED;
+    n->klass = klass;
+    n->kind = 0;
+    n->index = -1;
+    return ctx->count++;
+}
+
+/**
+ * JVMTI heap_reference_callback for a verification walk.
+ *
+ * Numbers each object on first sight and relaxes its distance through the reported reference.
+ * Excluded objects, and stack or JNI-local roots of an excluded thread, are not followed. In
+ * the first pass every reference into an old object from anything but another old object is
+ * counted by kind: these are the references the patch passes missed. Only the raw-memory C
+ * library is used here (no JNI). Aborts the walk if the node table cannot grow.
+ */
+static jint JNICALL verify_cb(
+        jvmtiHeapReferenceKind reference_kind,
+        const jvmtiHeapReferenceInfo* reference_info,
+        jlong class_tag,
+        jlong referrer_class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jlong* referrer_tag_ptr,
+        jint length,
+        void* user_data) {
+
+    (void) referrer_class_tag;
+    (void) size;
+    (void) length;
+
+    verify_ctx* ctx = (verify_ctx*) user_data;
+    if (!ctx || !tag_ptr) return JVMTI_VISIT_OBJECTS;
+    if (progress_visit(&ctx->progress)) return JVMTI_VISIT_ABORT;
+    if (*tag_ptr == ctx->excluded_tag) return 0;
+
+    jint parent = -1;
+    jint depth = 0;
+    if (referrer_tag_ptr == NULL) {
+        if (reference_info != NULL &&
+            ((reference_kind == JVMTI_HEAP_REFERENCE_STACK_LOCAL &&
+              reference_info->stack_local.thread_tag == ctx->excluded_tag) ||
+             (reference_kind == JVMTI_HEAP_REFERENCE_JNI_LOCAL &&
+              reference_info->jni_local.thread_tag == ctx->excluded_tag))) {
+            return 0;
+        }
+    } else {
+        parent = verify_node_of(ctx, *referrer_tag_ptr);
+        depth = parent >= 0 ? ctx->nodes[parent].depth : VERIFY_UNREACHED;
+    }
+
+    jint klass = verify_class_of(ctx, class_tag);
+    jint id = verify_node_of(ctx, *tag_ptr);
+    if (id < 0) {
+        if (klass >= 0 && ctx->primitive_array[klass]) return 0;
+        id = verify_add_node(ctx, klass);
+        if (id < 0) {
+            ctx->oom = 1;
+            return JVMTI_VISIT_ABORT;
+        }
+        *tag_ptr = VERIFY_NODE_TAG(ctx->epoch, id);
+        ctx->progress.tagged++;
+    }
+
+    verify_node* node = &ctx->nodes[id];
+    if (node->klass < 0) node->klass = klass;
+    if (depth != VERIFY_UNREACHED && depth + 1 < node->depth) {
+        if (node->depth != VERIFY_UNREACHED) ctx->shortened++;
+        node->depth = depth + 1;
+        node->parent = parent;
+        node->kind = (jint) reference_kind;
+        switch (reference_kind) {
+            case JVMTI_HEAP_REFERENCE_FIELD:
+            case JVMTI_HEAP_REFERENCE_STATIC_FIELD:
+                node->index = reference_info ? reference_info->field.index : -1;
+                break;
+            case JVMTI_HEAP_REFERENCE_ARRAY_ELEMENT:
+                node->index = reference_info ? reference_info->array.index : -1;
+                break;
+            case JVMTI_HEAP_REFERENCE_CONSTANT_POOL:
+                node->index = reference_info ? reference_info->constant_pool.index : -1;
+                break;
+            default:
+                node->index = -1;
+                break;
+        }
+    }
+
+    if (ctx->first_pass && id < ctx->n_targets && (parent < 0 || parent >= ctx->n_targets) &&
+        (int) reference_kind > 0 && (int) reference_kind < REFERENCE_KIND_SLOTS) {
+        ctx->kind_counts[reference_kind]++;
+    }
+    return JVMTI_VISIT_OBJECTS;
+}
+
+/** Loaded class behind a node (the class itself for a class node), or NULL if unknown. */
+static jclass verify_node_class(const verify_ctx* ctx, jclass* classes, jint node, int* is_class) {
+    *is_class = node >= ctx->class_base && node < ctx->class_base + ctx->n_classes;
+    if (*is_class) return classes[node - ctx->class_base];
+    jint klass = ctx->nodes[node].klass;
+    return klass >= 0 ? classes[klass] : NULL;
+}
+
+/**
+ * Name of the field a node was reached through, for a field or static-field reference whose
+ * holder's class is known; NULL otherwise.
+ */
+static jstring verify_slot_name(JNIEnv* env, const verify_ctx* ctx, jclass* classes,
+                                slot_class_cache* cache, jint node) {
+    const verify_node* n = &ctx->nodes[node];
+    if (n->parent < 0 || n->index < 0 ||
+        (n->kind != JVMTI_HEAP_REFERENCE_FIELD && n->kind != JVMTI_HEAP_REFERENCE_STATIC_FIELD)) {
+        return NULL;
+    }
+    int is_class = 0;
+    jclass holder = verify_node_class(ctx, classes, n->parent, &is_class);
+    if (holder == NULL || is_class != (n->kind == JVMTI_HEAP_REFERENCE_STATIC_FIELD)) return NULL;
+
+    slot_class* table = field_table_for(env, cache, holder);
+    if (!table) return NULL;
+    jint i = n->index - table->base;
+    if (i < 0 || i >= table->count) return NULL;
+
+    char* name = NULL;
+    jstring result = NULL;
+    if ((*g_jvmti)->GetFieldName(g_jvmti, table->fields[i].declaring, table->fields[i].id,
+                                 &name, NULL, NULL) == JVMTI_ERROR_NONE && name) {
+        result = (*env)->NewStringUTF(env, name);
+        (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) name);
+    }
+    return result;
+}
+
+/**
+ * Builds the root path of one reached old object, root end first:
+ * Object[] { Class[] classes, String[] slots, int[] links }. classes holds each object's class
+ * (for a Class object, the class itself); slots the field name each object was reached
+ * through, or null; links three ints per object: the reference kind it was reached by, the
+ * field or array index of that reference (-1 if none), and 1 if the object is a Class. A path
+ * longer than VERIFY_MAX_PATH keeps its last links, so its first kind is then not a root kind.
+ */
+static jobjectArray verify_path(JNIEnv* env, const verify_ctx* ctx, jclass* classes,
+                                slot_class_cache* cache, jclass objClass, jclass classClass,
+                                jclass stringClass, jint target) {
+    jint chain[VERIFY_MAX_PATH];
+    jint n = 0;
+    for (jint v = target; v >= 0 && n < VERIFY_MAX_PATH; v = ctx->nodes[v].parent) chain[n++] = v;
+
+    jobjectArray outClasses = (*env)->NewObjectArray(env, n, classClass, NULL);
+    jobjectArray outSlots = (*env)->NewObjectArray(env, n, stringClass, NULL);
+    jintArray outLinks = (*env)->NewIntArray(env, n * 3);
+    jobjectArray path = NULL;
+    if (outClasses && outSlots && outLinks) {
+        for (jint k = 0; k < n; k++) {
+            jint node = chain[n - 1 - k];
+            int is_class = 0;
+            jclass klass = verify_node_class(ctx, classes, node, &is_class);
+            if (klass) (*env)->SetObjectArrayElement(env, outClasses, k, klass);
+            jstring slot = verify_slot_name(env, ctx, classes, cache, node);
+            if (slot) {
+                (*env)->SetObjectArrayElement(env, outSlots, k, slot);
+                (*env)->DeleteLocalRef(env, slot);
+            }
+            jint link[3] = { ctx->nodes[node].kind, ctx->nodes[node].index, is_class };
+            (*env)->SetIntArrayRegion(env, outLinks, k * 3, 3, link);
+        }
+        path = (*env)->NewObjectArray(env, 3, objClass, NULL);
+        if (path) {
+            (*env)->SetObjectArrayElement(env, path, 0, outClasses);
+            (*env)->SetObjectArrayElement(env, path, 1, outSlots);
+            (*env)->SetObjectArrayElement(env, path, 2, outLinks);
+        }
+    }
+    if (outClasses) (*env)->DeleteLocalRef(env, outClasses);
+    if (outSlots) (*env)->DeleteLocalRef(env, outSlots);
+    if (outLinks) (*env)->DeleteLocalRef(env, outLinks);
+    return path;
+}
+
+/** Tags every non-null element of array (which may be NULL) with tag. */
+static void verify_tag_all(JNIEnv* env, jvmtiEnv* jvmti, jobjectArray array, jlong tag, const char* what) {
+    if (array == NULL) return;
+    jsize n = (*env)->GetArrayLength(env, array);
+    for (jsize i = 0; i < n; i++) {
+        jobject o = (*env)->GetObjectArrayElement(env, array, i);
+        if (o == NULL) continue;
+        jvmtiError err = (*jvmti)->SetTag(jvmti, o, tag);
+        check_print(jvmti, err, what);
+        (*env)->DeleteLocalRef(env, o);
+    }
+}
+
+/**
+ * Finds the old objects that are still reachable after a migration, the references that keep
+ * them so, and the shortest root path of a sample of them.
+ *
+ * One FollowReferences pass from the heap roots numbers every reachable object (see
+ * "Residual-reference verification"). If an old object was reached, further passes shorten the
+ * recorded paths until they are exact or VERIFY_MAX_PASSES ran; the paths of the first
+ * maxPaths reached old objects (in targets order) are then built from the node table. Nothing
+ * is resolved through GetObjectsWithTags.
+ *
+ * @param targetsArray  the old objects (null elements are skipped)
+ * @param excludedArray objects to neither report nor follow, and threads whose stack and
+ *                      JNI-local roots to ignore (may be NULL); an excluded old object is
+ *                      never reported
+ * @param maxPaths      the number of root paths to report
+ * @param kindCounts    optional long[] receiving the number of references into the old objects
+ *                      from other objects or roots, per jvmtiHeapReferenceKind (index = kind)
+ * @param stats         optional long[3]: old objects reached, passes run, 1 if the paths are
+ *                      shortest
+ * @return Array of root paths (see verify_path), or NULL if none was reached (or on error, in
+ *         which case stats are left untouched)
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeVerifyResidual(
+        JNIEnv* env,
+        jclass cls,
+        jobjectArray targetsArray,
+        jobjectArray excludedArray,
+        jint maxPaths,
+        jlongArray kindCounts,
+        jlongArray stats) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env || targetsArray == NULL) return NULL;
+    jsize nTargets = (*env)->GetArrayLength(env, targetsArray);
+    if (nTargets == 0) return NULL;
+
+    jint nClasses = 0;
+    jclass* classes = NULL;     /* local refs, JVMTI-allocated */
+    jvmtiError lerr = (*g_jvmti)->GetLoadedClasses(g_jvmti, &nClasses, &classes);
+    if (lerr != JVMTI_ERROR_NONE) {
+        check_print(g_jvmti, lerr, "GetLoadedClasses failed");
+        return NULL;
+    }
+
+    verify_ctx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.epoch = (uint32_t) __sync_add_and_fetch(&g_epoch, 1);
+    ctx.excluded_tag = VERIFY_EXCLUDED_TAG(ctx.epoch);
+    ctx.n_targets = (jint) nTargets;
+    ctx.class_base = (jint) nTargets;
+    ctx.n_classes = nClasses;
+
+    unsigned char* primitiveArray = NULL;
+    int ok = (jlong) nTargets + nClasses <= VERIFY_MAX_NODES / 2;
+    if (ok) {
+        ctx.capacity = nTargets + nClasses > 1024 ? nTargets + nClasses : 1024;
+        ctx.nodes = (verify_node*) malloc((size_t) ctx.capacity * sizeof(verify_node));
+        primitiveArray = (unsigned char*) calloc((size_t)(nClasses > 0 ? nClasses : 1), 1);
+        ok = ctx.nodes && primitiveArray;
+    }
+    ctx.primitive_array = primitiveArray;
+    for (jint i = 0; ok && i < nTargets + nClasses; i++) verify_add_node(&ctx, -1);
+    for (jint i = 0; ok && i < nClasses; i++) {
+        char* sig = NULL;
+        if ((*g_jvmti)->GetClassSignature(g_jvmti, classes[i], &sig, NULL) == JVMTI_ERROR_NONE && sig) {
+            primitiveArray[i] = sig[0] == '[' && sig[1] != 'L' && sig[1] != '[';
+            (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) sig);
+        }
+    }
+
+    jobjectArray result = NULL;
+    jlong reached = 0;
+    jint passes = 0;
+    int exact = 0;
+
+    if (ok) {
+        jlong start = op_now();
+        jvmtiEnv* jvmti = walk_env_open();
+        for (jsize i = 0; i < nTargets; i++) {
+            jobject o = (*env)->GetObjectArrayElement(env, targetsArray, i);
+            if (o == NULL) continue;
+            jvmtiError terr = (*jvmti)->SetTag(jvmti, o, VERIFY_NODE_TAG(ctx.epoch, i));
+            check_print(jvmti, terr, "SetTag(verify target) failed");
+            (*env)->DeleteLocalRef(env, o);
+        }
+        for (jint i = 0; i < nClasses; i++) {
+            jvmtiError terr = (*jvmti)->SetTag(jvmti, classes[i], VERIFY_NODE_TAG(ctx.epoch, ctx.class_base + i));
+            check_print(jvmti, terr, "SetTag(verify class) failed");
+        }
+        /* Exclusions are tagged last so an excluded old object is excluded. */
+        verify_tag_all(env, jvmti, excludedArray, ctx.excluded_tag, "SetTag(verify exclusion) failed");
+        (*jvmti)->SetTag(jvmti, targetsArray, ctx.excluded_tag);
+        if (excludedArray) (*jvmti)->SetTag(jvmti, excludedArray, ctx.excluded_tag);
+        jthread self = NULL;
+        if ((*jvmti)->GetCurrentThread(jvmti, &self) == JVMTI_ERROR_NONE && self) {
+            (*jvmti)->SetTag(jvmti, self, ctx.excluded_tag);
+            (*env)->DeleteLocalRef(env, self);
+        }
+
+        jvmtiHeapCallbacks callbacks;
+        memset(&callbacks, 0, sizeof(callbacks));
+        callbacks.heap_reference_callback = &verify_cb;
+
+        progress_begin(&ctx.progress, ctx.epoch);
+        jvmtiError err = JVMTI_ERROR_NONE;
+        jlong safepoint = 0;
+        do {
+            ctx.first_pass = passes == 0;
+            ctx.shortened = 0;
+            jlong iterStart = op_now();
+            err = (*jvmti)->FollowReferences(jvmti, HEAP_FILTER_NONE, NULL, NULL, &callbacks, &ctx);
+            safepoint += op_now() - iterStart;
+            passes++;
+            if (err != JVMTI_ERROR_NONE || ctx.oom || ctx.progress.aborted) break;
+            reached = 0;
+            for (jint i = 0; i < ctx.n_targets; i++) {
+                if (ctx.nodes[i].depth != VERIFY_UNREACHED) reached++;
+            }
+            exact = ctx.shortened == 0;
+        } while (reached > 0 && !exact && passes < VERIFY_MAX_PASSES);
+        op_record(OP_TAG, start, safepoint);
+        /* the node table holds everything the paths need: the walk's tags can go */
+        walk_env_close(jvmti);
+
+        if (progress_end(&ctx.progress)) {
+            throw_cancelled(env, "FollowReferences(verifyResidual)");
+            ok = 0;
+        } else if (err != JVMTI_ERROR_NONE || ctx.oom) {
+            check_print(g_jvmti, err, "FollowReferences(verifyResidual) failed");
+            if (ctx.oom) fprintf(stderr, "[agent] verifyResidual: out of memory numbering objects\n");
+            ok = 0;
+        }
+    }
+
+    if (ok) {
+        jint nPaths = reached < maxPaths ? (jint) reached : (maxPaths > 0 ? maxPaths : 0);
+        jclass objClass = (*env)->FindClass(env, "java/lang/Object");
+        jclass classClass = (*env)->FindClass(env, "java/lang/Class");
+        jclass stringClass = (*env)->FindClass(env, "java/lang/String");
+        if (nPaths > 0 && objClass && classClass && stringClass) {
+            result = (*env)->NewObjectArray(env, nPaths, objClass, NULL);
+            slot_class_cache cache;
+            memset(&cache, 0, sizeof(cache));
+            jint out = 0;
+            for (jint i = 0; result != NULL && i < ctx.n_targets && out < nPaths; i++) {
+                if (ctx.nodes[i].depth == VERIFY_UNREACHED) continue;
+                jobjectArray path = verify_path(env, &ctx, classes, &cache, objClass, classClass, stringClass, i);
+                (*env)->SetObjectArrayElement(env, result, out++, path);
+                if (path) (*env)->DeleteLocalRef(env, path);
+            }
+            free_field_tables(env, &cache);
+        }
+        if (objClass) (*env)->DeleteLocalRef(env, objClass);
+        if (classClass) (*env)->DeleteLocalRef(env, classClass);
+        if (stringClass) (*env)->DeleteLocalRef(env, stringClass);
+
+        if (kindCounts != NULL) {
+            jsize n = (*env)->GetArrayLength(env, kindCounts);
+            if (n > REFERENCE_KIND_SLOTS) n = REFERENCE_KIND_SLOTS;
+            (*env)->SetLongArrayRegion(env, kindCounts, 0, n, ctx.kind_counts);
+        }
+        if (stats != NULL) {
+            jlong counts[VERIFY_STAT_COUNT] = { reached, passes, reached == 0 || exact };
+            jsize n = (*env)->GetArrayLength(env, stats);
+            if (n > VERIFY_STAT_COUNT) n = VERIFY_STAT_COUNT;
+            (*env)->SetLongArrayRegion(env, stats, 0, n, counts);
+        }
+    }
+
+    free(ctx.nodes);
+    free(primitiveArray);
+    for (jint i = 0; i < nClasses; i++) {
+        if (classes[i]) (*env)->DeleteLocalRef(env, classes[i]);
+    }
+    if (classes) (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) classes);
+    return result;
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Reference-graph export
+ * ---------------------------------------------------------------------------------------------
+ *
+ * Planning a migration offline needs the heap's reference structure, not its contents: which
+ * classes hold references into a source class, and how many objects a SPEC walk would visit.
+ * One FollowReferences pass from the roots writes that structure to a file, a fraction of the
+ * size of an .hprof dump: no field values, no strings, no primitive array contents.
+ *
+ * Objects are numbered on first sight, as in a verification walk; loaded classes are numbered
+ * first, so the id of a class's mirror is also its class id. Each reported reference is appended
+ * to an edge buffer flushed to the file with write() as it fills, so the walk itself holds only
+ * the buffer and an 8-byte record per object. The object table is written after the edges, and
+ * the header, which carries the counts and section offsets, last.
+ *
+ * File layout, in the byte order of the writing machine (the magic tells which):
+ *
+ *   header   64 bytes: u32 magic, u32 version, u32 flags, u32 classes, u64 objects, u64 edges,
+ *            u64 class table offset, u64 edge offset, u64 object offset, u64 file size
+ *   classes  per class: u32 class flags, u32 length, the JVMTI signature (no terminator)
+ *   edges    16-byte aligned; per reference: u32 referrer (GRAPH_ROOT for a heap root),
+ *            u32 referree, u32 jvmtiHeapReferenceKind, i32 field / array / constant-pool index
+ *   objects  16-byte aligned; per object: i32 class id (-1 if unknown), u32 shallow size
+ *            (saturated at 0xFFFFFFFF)
+ *
+ * With GRAPH_SOURCE_EDGES_ONLY, only references into instances of the source classes are
+ * written; every reachable object is still numbered and listed in the object table.
+ *
+ * @see migrator.heap.HeapGraph (reader)
+ */
+
+#define GRAPH_MAGIC   0x4D475247U     /* "GRGM" in little-endian order */
+#define GRAPH_VERSION 1U
+
+/** File flag: only the references into source-class instances were written. */
+#define GRAPH_SOURCE_EDGES_ONLY 1U
+
+/** Class flags in the class table. */
+#define GRAPH_CLASS_SOURCE          1U
+#define GRAPH_CLASS_PRIMITIVE_ARRAY 2U
+
+/** Referrer id of a heap-root reference. */
+#define GRAPH_ROOT 0xFFFFFFFFU
+
+#define GRAPH_HEADER_SIZE 64
+#define GRAPH_BUFFER_SIZE (1 << 20)
+
+/** Indices into the stats long[] filled by nativeExportGraph. */
+#define GRAPH_STAT_CLASSES 0
+#define GRAPH_STAT_OBJECTS 1
+#define GRAPH_STAT_EDGES   2
+#define GRAPH_STAT_COUNT   3
+
+/** One object of the object table. */
+typedef struct {
+    jint klass;
+    uint32_t size;
+} graph_node;
+
+/** One reference of the edge table. */
+typedef struct {
+    uint32_t referrer;
+    uint32_t referree;
+    uint32_t kind;
+    int32_t index;
+} graph_edge;
+
+/** Sequential writer over a file descriptor; the first failure sticks. */
+typedef struct {
+    int fd;
+    unsigned char* buf;
+    size_t used;
+    uint64_t offset;
+    int failed;
+} graph_writer;
+
+/** Per-walk state shared with graph_cb through FollowReferences' user_data. */
+typedef struct {
+    uint32_t epoch;
+    graph_node* nodes;
+    jint count;
+    jint capacity;
+    jint n_classes;
+    const uint32_t* class_flags;    /* [n_classes] */
+    int source_only;
+    jlong edges;
+    int oom;
+    graph_writer* out;
+    walk_progress progress;
+} graph_ctx;
+
+static void graph_flush(graph_writer* w) {
+    size_t done = 0;
+    while (!w->failed && done < w->used) {
+        ssize_t n = write(w->fd, w->buf + done, w->used - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            w->failed = errno;
+        } else {
+            done += (size_t) n;
+        }
+    }
+    w->used = 0;
+}
+
+static void graph_write(graph_writer* w, const void* data, size_t len) {
+    const unsigned char* p = (const unsigned char*) data;
+    while (len > 0 && !w->failed) {
+        size_t room = GRAPH_BUFFER_SIZE - w->used;
+        size_t n = len < room ? len : room;
+        memcpy(w->buf + w->used, p, n);
+        w->used += n;
+        w->offset += n;
+        p += n;
+        len -= n;
+        if (w->used == GRAPH_BUFFER_SIZE) graph_flush(w);
+    }
+}
+
+/** Pads the output with zeros to the next multiple of 16 bytes. */
+static void graph_align(graph_writer* w) {
+    static const unsigned char zeros[16] = { 0 };
+    size_t pad = (size_t) ((16 - (w->offset & 15)) & 15);
+    graph_write(w, zeros, pad);
+}
+
+/** Decodes a node tag of the current export walk; returns the node or -1. */
+static jint graph_node_of(const graph_ctx* ctx, jlong tag) {
+    uint64_t t = (uint64_t) tag;
+    if ((uint32_t)(t >> 32) != ctx->epoch) return -1;
+    uint32_t low = (uint32_t) t;
+    if (low == 0 || low > (uint32_t) ctx->count) return -1;
+    return (jint)(low - 1);
+}
+
+/** Appends a node; returns its index, or -1 if the table cannot grow. */
+static jint graph_add_node(graph_ctx* ctx, jint klass, jlong size) {
+    if (ctx->count == ctx->capacity) {
+        if (ctx->capacity >= VERIFY_MAX_NODES) return -1;
+        jint cap = ctx->capacity > VERIFY_MAX_NODES / 2 ? VERIFY_MAX_NODES : ctx->capacity * 2;
+        graph_node* grown = (graph_node*) realloc(ctx->nodes, (size_t) cap * sizeof(graph_node));
+        if (!grown) return -1;
+        ctx->nodes = grown;
+        ctx->capacity = cap;
+    }
+    graph_node* n = &ctx->nodes[ctx->count];
+    n->klass = klass;
+    n->size = size > (jlong) UINT32_MAX ? UINT32_MAX : (uint32_t) (size > 0 ? size : 0);
+    return ctx->count++;
+}
+
+/**
+ * JVMTI heap_reference_callback for a graph export: numbers each object on first sight and
+ * appends the reported reference to the edge stream. Only the raw-memory C library and write()
+ * are used here (no JNI). Aborts the walk if the node table cannot grow or the file cannot be
+ * written.
+ */
+static jint JNICALL graph_cb(
+        jvmtiHeapReferenceKind reference_kind,
+        const jvmtiHeapReferenceInfo* reference_info,
+        jlong class_tag,
+        jlong referrer_class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jlong* referrer_tag_ptr,
+        jint length,
+        void* user_data) {
+
+    (void) referrer_class_tag;
+    (void) length;
+
+    graph_ctx* ctx = (graph_ctx*) user_data;
+    if (!ctx || !tag_ptr) return JVMTI_VISIT_OBJECTS;
+    if (progress_visit(&ctx->progress)) return JVMTI_VISIT_ABORT;
+
+    jint klass = graph_node_of(ctx, class_tag);
+    if (klass >= ctx->n_classes) klass = -1;
+    jint id = graph_node_of(ctx, *tag_ptr);
+    if (id < 0) {
+        id = graph_add_node(ctx, klass, size);
+        if (id < 0) {
+            ctx->oom = 1;
+            return JVMTI_VISIT_ABORT;
+        }
+        *tag_ptr = VERIFY_NODE_TAG(ctx->epoch, id);
+        ctx->progress.tagged++;
+    } else if (ctx->nodes[id].klass < 0) {
+        /* a class mirror, numbered before the walk */
+        ctx->nodes[id].klass = klass;
+        ctx->nodes[id].size = size > (jlong) UINT32_MAX ? UINT32_MAX : (uint32_t) (size > 0 ? size : 0);
+    }
+
+    if (ctx->source_only && (klass < 0 || !(ctx->class_flags[klass] & GRAPH_CLASS_SOURCE))) {
+        return JVMTI_VISIT_OBJECTS;
+    }
+    graph_edge e;
+    e.referrer = GRAPH_ROOT;
+    if (referrer_tag_ptr != NULL) {
+        jint parent = graph_node_of(ctx, *referrer_tag_ptr);
+        if (parent >= 0) e.referrer = (uint32_t) parent;
+    }
+    e.referree = (uint32_t) id;
+    e.kind = (uint32_t) reference_kind;
+    e.index = -1;
+    if (reference_info != NULL) {
+        switch (reference_kind) {
+            case JVMTI_HEAP_REFERENCE_FIELD:
+            case JVMTI_HEAP_REFERENCE_STATIC_FIELD:
+                e.index = reference_info->field.index;
+                break;
+            case JVMTI_HEAP_REFERENCE_ARRAY_ELEMENT:
+                e.index = reference_info->array.index;
+                break;
+            case JVMTI_HEAP_REFERENCE_CONSTANT_POOL:
+                e.index = reference_info->constant_pool.index;
+                break;
+            default:
+                break;
+        }
+    }
+    graph_write(ctx->out, &e, sizeof(e));
+    ctx->edges++;
+    return ctx->out->failed ? JVMTI_VISIT_ABORT : JVMTI_VISIT_OBJECTS;
+}
+
+/** Writes the class table: flags, signature length and signature of each loaded class. */
+static void graph_write_classes(graph_writer* w, jclass* classes, jint nClasses, const uint32_t* flags) {
+    for (jint i = 0; i < nClasses && !w->failed; i++) {
+        char* sig = NULL;
+        if ((*g_jvmti)->GetClassSignature(g_jvmti, classes[i], &sig, NULL) != JVMTI_ERROR_NONE) sig = NULL;
+        uint32_t len = sig ? (uint32_t) strlen(sig) : 0;
+        graph_write(w, &flags[i], sizeof(uint32_t));
+        graph_write(w, &len, sizeof(len));
+        if (len > 0) graph_write(w, sig, len);
+        if (sig) (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) sig);
+    }
+}
+
+/** Writes the header over the placeholder at the start of the file. */
+static int graph_write_header(int fd, uint32_t flags, jint nClasses, jint nObjects, jlong nEdges,
+                              uint64_t classOffset, uint64_t edgeOffset, uint64_t objectOffset,
+                              uint64_t fileSize) {
+    unsigned char header[GRAPH_HEADER_SIZE];
+    uint32_t u32[4] = { GRAPH_MAGIC, GRAPH_VERSION, flags, (uint32_t) nClasses };
+    uint64_t u64[6] = { (uint64_t) nObjects, (uint64_t) nEdges, classOffset, edgeOffset, objectOffset, fileSize };
+    memcpy(header, u32, sizeof(u32));
+    memcpy(header + sizeof(u32), u64, sizeof(u64));
+    return pwrite(fd, header, sizeof(header), 0) == (ssize_t) sizeof(header);
+}
+
+/**
+ * Writes the reference graph of the reachable heap to a file (see "Reference-graph export").
+ *
+ * @param pathString      the file to create or truncate
+ * @param sourceArray     the classes to flag as migration sources (may be NULL)
+ * @param sourceEdgesOnly JNI_TRUE to write only the references into source-class instances
+ * @param stats           optional long[3]: classes, objects and references written
+ * @return the size of the file in bytes, or -1 on error (stats are then left untouched)
+ */
+JNIEXPORT jlong JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeExportGraph(
+        JNIEnv* env,
+        jclass cls,
+        jstring pathString,
+        jobjectArray sourceArray,
+        jboolean sourceEdgesOnly,
+        jlongArray stats) {
+
+    (void) cls;
+
+    if (!g_jvmti || !env || pathString == NULL) return -1;
+
+    jint nClasses = 0;
+    jclass* classes = NULL;     /* local refs, JVMTI-allocated */
+    jvmtiError lerr = (*g_jvmti)->GetLoadedClasses(g_jvmti, &nClasses, &classes);
+    if (lerr != JVMTI_ERROR_NONE) {
+        check_print(g_jvmti, lerr, "GetLoadedClasses failed");
+        return -1;
+    }
+
+    graph_ctx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.epoch = (uint32_t) __sync_add_and_fetch(&g_epoch, 1);
+    ctx.n_classes = nClasses;
+    ctx.source_only = sourceEdgesOnly == JNI_TRUE;
+
+    graph_writer out;
+    memset(&out, 0, sizeof(out));
+    out.fd = -1;
+    uint32_t* classFlags = (uint32_t*) calloc((size_t) (nClasses > 0 ? nClasses : 1), sizeof(uint32_t));
+    int ok = nClasses <= VERIFY_MAX_NODES / 2 && classFlags != NULL;
+    if (ok) {
+        ctx.capacity = nClasses > 1024 ? nClasses : 1024;
+        ctx.nodes = (graph_node*) malloc((size_t) ctx.capacity * sizeof(graph_node));
+        out.buf = (unsigned char*) malloc(GRAPH_BUFFER_SIZE);
+        ok = ctx.nodes && out.buf;
+    }
+    ctx.class_flags = classFlags;
+    ctx.out = &out;
+    for (jint i = 0; ok && i < nClasses; i++) graph_add_node(&ctx, -1, 0);
+
+    const char* path = ok ? (*env)->GetStringUTFChars(env, pathString, NULL) : NULL;
+    if (ok && path) {
+        out.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (out.fd < 0) {
+            fprintf(stderr, "[agent] exportGraph: cannot open %s: %s\n", path, strerror(errno));
+            ok = 0;
+        }
+    } else {
+        ok = 0;
+    }
+    if (path) (*env)->ReleaseStringUTFChars(env, pathString, path);
+
+    jlong fileSize = -1;
+    if (ok) {
+        jlong start = op_now();
+        jvmtiEnv* jvmti = walk_env_open();
+        for (jint i = 0; i < nClasses; i++) {
+            jvmtiError terr = (*jvmti)->SetTag(jvmti, classes[i], VERIFY_NODE_TAG(ctx.epoch, i));
+            check_print(jvmti, terr, "SetTag(graph class) failed");
+        }
+        jsize nSources = sourceArray ? (*env)->GetArrayLength(env, sourceArray) : 0;
+        for (jsize i = 0; i < nSources; i++) {
+            jobject source = (*env)->GetObjectArrayElement(env, sourceArray, i);
+            if (source == NULL) continue;
+            jlong tag = 0;
+            if ((*jvmti)->GetTag(jvmti, source, &tag) == JVMTI_ERROR_NONE) {
+                jint k = graph_node_of(&ctx, tag);
+                if (k >= 0 && k < nClasses) classFlags[k] |= GRAPH_CLASS_SOURCE;
+            }
+            (*env)->DeleteLocalRef(env, source);
+        }
+        for (jint i = 0; i < nClasses; i++) {
+            char* sig = NULL;
+            if ((*g_jvmti)->GetClassSignature(g_jvmti, classes[i], &sig, NULL) == JVMTI_ERROR_NONE && sig) {
+                if (sig[0] == '[' && sig[1] != 'L' && sig[1] != '[') classFlags[i] |= GRAPH_CLASS_PRIMITIVE_ARRAY;
+                (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) sig);
+            }
+        }
+
+        /* header placeholder, then the class table, written before the walk */
+        unsigned char placeholder[GRAPH_HEADER_SIZE] = { 0 };
+        graph_write(&out, placeholder, sizeof(placeholder));
+        uint64_t classOffset = out.offset;
+        graph_write_classes(&out, classes, nClasses, classFlags);
+        graph_align(&out);
+        uint64_t edgeOffset = out.offset;
+
+        jvmtiHeapCallbacks callbacks;
+        memset(&callbacks, 0, sizeof(callbacks));
+        callbacks.heap_reference_callback = &graph_cb;
+
+        progress_begin(&ctx.progress, ctx.epoch);
+        jvmtiError err = JVMTI_ERROR_NONE;
+        jlong iterStart = op_now();
+        if (!out.failed) err = (*jvmti)->FollowReferences(jvmti, HEAP_FILTER_NONE, NULL, NULL, &callbacks, &ctx);
+        op_record(OP_TAG, start, op_now() - iterStart);
+        walk_env_close(jvmti);
+
+        if (progress_end(&ctx.progress)) {
+            throw_cancelled(env, "FollowReferences(exportGraph)");
+            ok = 0;
+        } else if (err != JVMTI_ERROR_NONE || ctx.oom) {
+            check_print(g_jvmti, err, "FollowReferences(exportGraph) failed");
+            if (ctx.oom) fprintf(stderr, "[agent] exportGraph: out of memory numbering objects\n");
+            ok = 0;
+        }
+
+        uint64_t objectOffset = 0;
+        if (ok) {
+            graph_align(&out);
+            objectOffset = out.offset;
+            graph_write(&out, ctx.nodes, (size_t) ctx.count * sizeof(graph_node));
+            graph_flush(&out);
+        }
+        if (ok && out.failed) {
+            fprintf(stderr, "[agent] exportGraph: write failed: %s\n", strerror(out.failed));
+            ok = 0;
+        }
+        if (ok && !graph_write_header(out.fd, ctx.source_only ? GRAPH_SOURCE_EDGES_ONLY : 0, nClasses, ctx.count,
+                                      ctx.edges, classOffset, edgeOffset, objectOffset, out.offset)) {
+            fprintf(stderr, "[agent] exportGraph: header write failed: %s\n", strerror(errno));
+            ok = 0;
+        }
+        if (ok) fileSize = (jlong) out.offset;
+    }
+    if (out.fd >= 0 && close(out.fd) != 0 && ok) {
+        fprintf(stderr, "[agent] exportGraph: close failed: %s\n", strerror(errno));
+        fileSize = -1;
+    }
+
+    if (fileSize >= 0 && stats != NULL) {
+        jlong counts[GRAPH_STAT_COUNT] = { nClasses, ctx.count, ctx.edges };
+        jsize n = (*env)->GetArrayLength(env, stats);
+        if (n > GRAPH_STAT_COUNT) n = GRAPH_STAT_COUNT;
+        (*env)->SetLongArrayRegion(env, stats, 0, n, counts);
+    }
+
+    free(out.buf);
+    free(ctx.nodes);
+    free(classFlags);
+    for (jint i = 0; i < nClasses; i++) {
+        if (classes[i]) (*env)->DeleteLocalRef(env, classes[i]);
+    }
+    if (classes) (*g_jvmti)->Deallocate(g_jvmti, (unsigned char*) classes);
+    return fileSize;
+}
+
+/**
+ * Advances the epoch counter. Foreign-function entry point.
+ * Called after migration completes to invalidate old tags (walks that fell back to g_jvmti).
+ */
+JNIEXPORT void migrator_advance_epoch(void) {
+    __sync_fetch_and_add(&g_epoch, 1);
+}
+
+/** JNI binding of migrator_advance_epoch. */
+JNIEXPORT void JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeAdvanceEpoch(
+        JNIEnv* env,
+        jclass cls) {
+    (void) env;
+    (void) cls;
+    migrator_advance_epoch();
+}
+
+/** JVMTI heap_iteration_callback counting the objects reported (only tagged ones are). */
+static jint JNICALL count_tagged_cb(
+        jlong class_tag,
+        jlong size,
+        jlong* tag_ptr,
+        jint length,
+        void* user_data) {
+
+    (void) class_tag;
+    (void) size;
+    (void) tag_ptr;
+    (void) length;
+
+    if (user_data) (*(jlong*) user_data)++;
+    return JVMTI_ITERATION_CONTINUE;
+}
+
+/**
+ * Counts the objects still tagged in the agent's own environment: tags that outlived their
+ * walk. Zero unless a walk had to fall back to g_jvmti. Costs one heap pass, a VM operation, so
+ * a foreign caller must not bind it as a critical function. Foreign-function entry point.
+ *
+ * @return the number of tagged objects, or -1 on error
+ */
+JNIEXPORT jlong migrator_retained_tags(void) {
+    if (!g_jvmti) return -1;
+
+    jlong count = 0;
+    jvmtiHeapCallbacks callbacks;
+    memset(&callbacks, 0, sizeof(callbacks));
+    callbacks.heap_iteration_callback = &count_tagged_cb;
+
+    jvmtiError err = (*g_jvmti)->IterateThroughHeap(
+            g_jvmti, JVMTI_HEAP_FILTER_UNTAGGED, NULL, &callbacks, &count);
+    if (err != JVMTI_ERROR_NONE) {
+        check_print(g_jvmti, err, "IterateThroughHeap(retainedTags) failed");
+        return -1;
+    }
+    return count;
+}
+
+/** JNI binding of migrator_retained_tags. */
+JNIEXPORT jlong JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeRetainedTags(
+        JNIEnv* env,
+        jclass cls) {
+    (void) env;
+    (void) cls;
+    return migrator_retained_tags();
+}
+
+/**
+ * Foreign-function entry point.
+ *
+ * @return the number of per-walk tagging environments currently open: non-zero only while a
+ *         walk runs, or while a chunked walk has not been ended
+ */
+JNIEXPORT jint migrator_open_walk_envs(void) {
+    return __sync_add_and_fetch(&g_walk_envs, 0);
+}
+
+/** JNI binding of migrator_open_walk_envs. */
+JNIEXPORT jint JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeOpenWalkEnvs(
+        JNIEnv* env,
+        jclass cls) {
+    (void) env;
+    (void) cls;
+    return migrator_open_walk_envs();
+}
+
+/*
+ * ---------------------------------------------------------------------------------------------
+ * Foreign-function entry points
+ * ---------------------------------------------------------------------------------------------
+ *
+ * The statistics of the agent (walk progress, cancellation, operation times, reclamation
+ * counters, epoch, tag diagnostics) are also exported as plain C functions named migrator_*,
+ * with no JNIEnv and only primitive and pointer arguments. ForeignHeapWalker binds them through
+ * java.lang.foreign: results land in an off-heap segment the caller owns, and the short ones are
+ * bound as critical functions, which skip the Java-to-native thread-state transition altogether.
+ * Object results (snapshots, walks, referrers, patching) still need JNI references and stay on the
+ * JNI entry points.
+ *
+ * A foreign caller must look the symbols up in this very library, loaded once by the VM as an
+ * agent: nativeLibraryPath reports where it was loaded from.
+ */
+
+/**
+ * Reports the file this agent was loaded from, for a foreign-function symbol lookup.
+ *
+ * @return the path, or NULL if it cannot be determined
+ */
+JNIEXPORT jstring JNICALL
+Java_migrator_heap_NativeHeapWalker_nativeLibraryPath(
+        JNIEnv* env,
+        jclass cls) {
+    (void) cls;
+
+    Dl_info info;
+    if (!env || dladdr((void*) &migrator_walk_progress, &info) == 0 || info.dli_fname == NULL) {
+        return NULL;
+    }
+    return (*env)->NewStringUTF(env, info.dli_fname);
+}
+
+/** True if the comma-separated agent options contain name. */
+static int has_option(const char* options, const char* name) {
+    size_t len = strlen(name);
+    for (const char* p = options; p && *p; ) {
+        const char* end = strchr(p, ',');
+        size_t n = end ? (size_t)(end - p) : strlen(p);
+        if (n == len && strncmp(p, name, len) == 0) return 1;
+        p = end ? end + 1 : NULL;
+    }
+    return 0;
+}
+
+/**
+ * Initializes the agent by obtaining JVMTI environment and requesting capabilities.
+ */
+static jint agent_start(JavaVM* vm) {
+    if (!vm) return JNI_ERR;
+    g_vm = vm;
+
+    jint getenv_res = (*vm)->GetEnv(vm, (void**)&g_jvmti, JVMTI_VERSION_1_2);
+    if (getenv_res != JNI_OK || g_jvmti == NULL) {
+        fprintf(stderr, "[agent] Failed to get JVMTI env\n");
+        return JNI_ERR;
+    }
+
+    jvmtiCapabilities caps;
+    memset(&caps, 0, sizeof(caps));
+    caps.can_tag_objects = 1;
+    jvmtiError err = (*g_jvmti)->AddCapabilities(g_jvmti, &caps);
+    if (err != JVMTI_ERROR_NONE) {
+        check_print(g_jvmti, err, "AddCapabilities failed");
+        return JNI_ERR;
+    }
+
+    return JNI_OK;
+}
+
+/**
+ * Agent entry point for JVM startup (-agentpath).
+ */
+JNIEXPORT jint JNICALL Agent_OnLoad(JavaVM* vm, char* options, void* reserved) {
+    (void) reserved;
+    jint res = agent_start(vm);
+    /* can_access_local_variables is only granted while the VM starts: acquire it now if asked */
+    if (res == JNI_OK && has_option(options, "stacklocals")) locals_env();
+    return res;
 }
 
 /**
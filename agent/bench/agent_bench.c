@@ -0,0 +1,477 @@
+/**
+ * @file agent_bench.c
+ * @brief Standalone benchmark driver for the native JVMTI agent.
+ *
+ * Starts a JVM through the JNI invocation API with the agent loaded (-agentpath), builds a
+ * synthetic heap of a chosen shape with JNI, and calls the agent's own entry points directly
+ * (looked up with dlsym in the library the VM loaded), so what is timed is the native layer
+ * alone: no Java patching, no JIT warm-up of Java code, no Maven classpath.
+ *
+ * Measured per iteration, each as one JSON object per line on stdout:
+ *
+ *   snapshot          nativeSnapshotObjects(target class): tag + GetObjectsWithTags
+ *   filtered          nativeWalkHeapFiltered(holder class)
+ *   full              nativeWalkHeap(no leaves, not reachable)
+ *   full_skip_leaves  nativeWalkHeap(primitive arrays + String skipped)
+ *   reachable         nativeWalkHeap(FollowReferences from the roots)
+ *   census            nativeCensus(target, holder classes)
+ *
+ * Each record carries the wall time of the call and the agent's own split of it
+ * (migrator_op_times deltas): TAG (heap iteration) and RESOLVE (GetObjectsWithTags plus the
+ * JNI result arrays), wall and safepoint time. A final "tagmap" record measures the JVM's
+ * tag-map overhead: System.gc() time with no tags, then with every target tagged in a JVMTI
+ * environment of the driver's own.
+ *
+ * Heap shapes (every holder is a java.util.concurrent.atomic.AtomicReference, every target a
+ * java.util.concurrent.atomic.AtomicLong, both rare in a bare JVM):
+ *
+ *   flat   one root Object[] -> N holders -> one target each
+ *   chain  root -> holder 0 -> Object[2] { target 0, holder 1 } -> ...: one path N deep
+ *
+ * plus --leaves byte[64] arrays reachable from the root, and --garbage unreachable targets
+ * allocated after the heap is built (a full walk sees them, a reachable walk does not).
+ *
+ * Build (see run.sh):
+ *   gcc -O2 -I"$JAVA_HOME/include" -I"$JAVA_HOME/include/linux" -o agent-bench agent_bench.c \
+ *       -L"$JAVA_HOME/lib/server" -Wl,-rpath,"$JAVA_HOME/lib/server" -ljvm -ldl
+ *
+ * Usage:
+ *   agent-bench --agent <libagent.so> [--shape flat|chain] [--objects N] [--leaves N]
+ *               [--garbage N] [--iterations N] [--warmup N] [--jvm-opt <option>]...
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <jni.h>
+#include <jvmti.h>
+
+typedef jobjectArray (JNICALL *snapshot_fn)(JNIEnv*, jclass, jclass);
+typedef jobjectArray (JNICALL *walk_fn)(JNIEnv*, jobject, jobjectArray, jboolean);
+typedef jobjectArray (JNICALL *filtered_fn)(JNIEnv*, jobject, jobjectArray);
+typedef jobjectArray (JNICALL *census_fn)(JNIEnv*, jclass, jobjectArray);
+typedef void (*op_times_fn)(jlong*);
+typedef jlong (*retained_tags_fn)(void);
+
+/** Values written by migrator_op_times: calls, wall ns, safepoint ns for TAG, then RESOLVE. */
+#define OP_TIME_COUNT 6
+
+/** Batch of objects created between two local-reference frames. */
+#define LOCAL_BATCH 1024
+
+#define MAX_JVM_OPTS 32
+
+typedef struct {
+    const char* agent;
+    const char* shape;
+    long objects;
+    long leaves;
+    long garbage;
+    int iterations;
+    int warmup;
+    const char* jvm_opts[MAX_JVM_OPTS];
+    int n_jvm_opts;
+} bench_config;
+
+typedef struct {
+    snapshot_fn snapshot;
+    walk_fn walk;
+    filtered_fn filtered;
+    census_fn census;
+    op_times_fn op_times;
+    retained_tags_fn retained_tags;
+} agent_api;
+
+typedef struct {
+    jclass target;          /* AtomicLong */
+    jclass holder;          /* AtomicReference */
+    jclass object;
+    jclass byte_array;
+    jclass string;
+    jmethodID target_init;
+    jmethodID holder_init;
+    jobject root;           /* global ref keeping the synthetic heap reachable */
+} heap_classes;
+
+static jlong now_nanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (jlong) ts.tv_sec * 1000000000LL + (jlong) ts.tv_nsec;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s --agent <libagent.so> [--shape flat|chain] [--objects N] [--leaves N]\n"
+            "          [--garbage N] [--iterations N] [--warmup N] [--jvm-opt <option>]...\n", prog);
+}
+
+static int parse_args(int argc, char** argv, bench_config* cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->shape = "flat";
+    cfg->objects = 100000;
+    cfg->leaves = 100000;
+    cfg->iterations = 5;
+    cfg->warmup = 2;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (v == NULL) return 0;
+        if (strcmp(a, "--agent") == 0) cfg->agent = v;
+        else if (strcmp(a, "--shape") == 0) cfg->shape = v;
+        else if (strcmp(a, "--objects") == 0) cfg->objects = atol(v);
+        else if (strcmp(a, "--leaves") == 0) cfg->leaves = atol(v);
+        else if (strcmp(a, "--garbage") == 0) cfg->garbage = atol(v);
+        else if (strcmp(a, "--iterations") == 0) cfg->iterations = atoi(v);
+        else if (strcmp(a, "--warmup") == 0) cfg->warmup = atoi(v);
+        else if (strcmp(a, "--jvm-opt") == 0 && cfg->n_jvm_opts < MAX_JVM_OPTS) cfg->jvm_opts[cfg->n_jvm_opts++] = v;
+        else return 0;
+        i++;
+    }
+    if (strcmp(cfg->shape, "flat") != 0 && strcmp(cfg->shape, "chain") != 0) return 0;
+    return cfg->agent != NULL && cfg->objects > 0 && cfg->leaves >= 0 && cfg->garbage >= 0
+           && cfg->iterations > 0 && cfg->warmup >= 0;
+}
+
+/** Looks the agent's entry points up in the library the VM loaded (dlopen returns the same handle). */
+static int bind_agent(const char* path, agent_api* api) {
+    void* lib = dlopen(path, RTLD_NOW | RTLD_NOLOAD);
+    if (!lib) {
+        fprintf(stderr, "agent not loaded by the VM: %s\n", dlerror());
+        return 0;
+    }
+    api->snapshot = (snapshot_fn) dlsym(lib, "Java_migrator_heap_NativeHeapWalker_nativeSnapshotObjects");
+    api->walk = (walk_fn) dlsym(lib, "Java_migrator_heap_NativeHeapWalker_nativeWalkHeap");
+    api->filtered = (filtered_fn) dlsym(lib, "Java_migrator_heap_NativeHeapWalker_nativeWalkHeapFiltered");
+    api->census = (census_fn) dlsym(lib, "Java_migrator_heap_NativeHeapWalker_nativeCensus");
+    api->op_times = (op_times_fn) dlsym(lib, "migrator_op_times");
+    api->retained_tags = (retained_tags_fn) dlsym(lib, "migrator_retained_tags");
+    if (!api->snapshot || !api->walk || !api->filtered || !api->census || !api->op_times || !api->retained_tags) {
+        fprintf(stderr, "agent does not export every benchmarked entry point\n");
+        return 0;
+    }
+    return 1;
+}
+
+static int check_exception(JNIEnv* env, const char* what) {
+    if (!(*env)->ExceptionCheck(env)) return 0;
+    fprintf(stderr, "Java exception during %s\n", what);
+    (*env)->ExceptionDescribe(env);
+    (*env)->ExceptionClear(env);
+    return 1;
+}
+
+static jclass global_class(JNIEnv* env, const char* name) {
+    jclass local = (*env)->FindClass(env, name);
+    if (!local) return NULL;
+    jclass global = (jclass) (*env)->NewGlobalRef(env, local);
+    (*env)->DeleteLocalRef(env, local);
+    return global;
+}
+
+static int resolve_classes(JNIEnv* env, heap_classes* hc) {
+    hc->target = global_class(env, "java/util/concurrent/atomic/AtomicLong");
+    hc->holder = global_class(env, "java/util/concurrent/atomic/AtomicReference");
+    hc->object = global_class(env, "java/lang/Object");
+    hc->byte_array = global_class(env, "[B");
+    hc->string = global_class(env, "java/lang/String");
+    if (!hc->target || !hc->holder || !hc->object || !hc->byte_array || !hc->string) return 0;
+    hc->target_init = (*env)->GetMethodID(env, hc->target, "<init>", "(J)V");
+    hc->holder_init = (*env)->GetMethodID(env, hc->holder, "<init>", "(Ljava/lang/Object;)V");
+    return hc->target_init && hc->holder_init;
+}
+
+/**
+ * Builds the synthetic heap: root Object[2] { holders (flat) or the first holder (chain), leaves }.
+ * Objects are created in batches inside local frames so the local-reference table stays small.
+ */
+static int build_heap(JNIEnv* env, const bench_config* cfg, heap_classes* hc) {
+    int chain = strcmp(cfg->shape, "chain") == 0;
+    jobjectArray root = (*env)->NewObjectArray(env, 2, hc->object, NULL);
+    jobjectArray leaves = (*env)->NewObjectArray(env, (jsize) cfg->leaves, hc->object, NULL);
+    jobjectArray holders = chain ? NULL : (*env)->NewObjectArray(env, (jsize) cfg->objects, hc->object, NULL);
+    if (!root || !leaves || (!chain && !holders)) {
+        check_exception(env, "allocating the root");
+        return 0;
+    }
+
+    jobject next = NULL;    /* chain: the holder built last, i.e. holder i + 1 */
+    for (long i = 0; i < cfg->objects; i += LOCAL_BATCH) {
+        if ((*env)->PushLocalFrame(env, 4 * LOCAL_BATCH + 4) != 0) return 0;
+        long end = i + LOCAL_BATCH < cfg->objects ? i + LOCAL_BATCH : cfg->objects;
+        for (long k = i; k < end; k++) {
+            jobject target = (*env)->NewObject(env, hc->target, hc->target_init, (jlong) k);
+            if (!chain) {
+                jobject holder = (*env)->NewObject(env, hc->holder, hc->holder_init, target);
+                (*env)->SetObjectArrayElement(env, holders, (jsize) k, holder);
+                (*env)->DeleteLocalRef(env, holder);
+            } else {
+                jobjectArray node = (*env)->NewObjectArray(env, 2, hc->object, NULL);
+                (*env)->SetObjectArrayElement(env, node, 0, target);
+                (*env)->SetObjectArrayElement(env, node, 1, next);
+                jobject holder = (*env)->NewObject(env, hc->holder, hc->holder_init, node);
+                (*env)->DeleteLocalRef(env, node);
+                if (next) (*env)->DeleteGlobalRef(env, next);
+                next = (*env)->NewGlobalRef(env, holder);
+                (*env)->DeleteLocalRef(env, holder);
+            }
+            (*env)->DeleteLocalRef(env, target);
+        }
+        (*env)->PopLocalFrame(env, NULL);
+        if (check_exception(env, "building the heap")) return 0;
+    }
+    for (long i = 0; i < cfg->leaves; i += LOCAL_BATCH) {
+        if ((*env)->PushLocalFrame(env, LOCAL_BATCH + 4) != 0) return 0;
+        long end = i + LOCAL_BATCH < cfg->leaves ? i + LOCAL_BATCH : cfg->leaves;
+        for (long k = i; k < end; k++) {
+            jbyteArray leaf = (*env)->NewByteArray(env, 64);
+            (*env)->SetObjectArrayElement(env, leaves, (jsize) k, leaf);
+            (*env)->DeleteLocalRef(env, leaf);
+        }
+        (*env)->PopLocalFrame(env, NULL);
+        if (check_exception(env, "building the leaves")) return 0;
+    }
+
+    (*env)->SetObjectArrayElement(env, root, 0, chain ? next : holders);
+    (*env)->SetObjectArrayElement(env, root, 1, leaves);
+    if (next) (*env)->DeleteGlobalRef(env, next);
+    hc->root = (*env)->NewGlobalRef(env, root);
+    (*env)->DeleteLocalRef(env, root);
+    (*env)->DeleteLocalRef(env, leaves);
+    if (holders) (*env)->DeleteLocalRef(env, holders);
+    return hc->root != NULL;
+}
+
+/** Allocates unreachable targets: garbage a full walk still reports until a GC reclaims it. */
+static void make_garbage(JNIEnv* env, const bench_config* cfg, heap_classes* hc) {
+    for (long i = 0; i < cfg->garbage; i += LOCAL_BATCH) {
+        if ((*env)->PushLocalFrame(env, LOCAL_BATCH + 4) != 0) return;
+        long end = i + LOCAL_BATCH < cfg->garbage ? i + LOCAL_BATCH : cfg->garbage;
+        for (long k = i; k < end; k++) {
+            (*env)->NewObject(env, hc->target, hc->target_init, (jlong) -k);
+        }
+        (*env)->PopLocalFrame(env, NULL);
+    }
+    check_exception(env, "allocating garbage");
+}
+
+static jobjectArray class_array(JNIEnv* env, jclass a, jclass b) {
+    jclass classClass = (*env)->FindClass(env, "java/lang/Class");
+    if (!classClass) return NULL;
+    jobjectArray array = (*env)->NewObjectArray(env, b ? 2 : 1, classClass, NULL);
+    (*env)->DeleteLocalRef(env, classClass);
+    if (!array) return NULL;
+    (*env)->SetObjectArrayElement(env, array, 0, a);
+    if (b) (*env)->SetObjectArrayElement(env, array, 1, b);
+    return array;
+}
+
+/**
+ * Size of a walk result: the length of the Object[] (NULL meaning none found), or for a census
+ * the instances counted over every reported class.
+ */
+static jlong result_count(JNIEnv* env, jobjectArray result, int census) {
+    if (!result) return 0;
+    if (!census) return (*env)->GetArrayLength(env, result);
+    jlongArray stats = (jlongArray) (*env)->GetObjectArrayElement(env, result, 1);
+    if (!stats) return 0;
+    jsize n = (*env)->GetArrayLength(env, stats);
+    jlong total = 0;
+    for (jsize i = 0; i < n; i += 2) {
+        jlong count;
+        (*env)->GetLongArrayRegion(env, stats, i, 1, &count);
+        total += count;
+    }
+    (*env)->DeleteLocalRef(env, stats);
+    return total;
+}
+
+enum { OP_SNAPSHOT, OP_FILTERED, OP_FULL, OP_FULL_SKIP_LEAVES, OP_REACHABLE, OP_CENSUS, OP_COUNT };
+
+static const char* const OP_NAMES[OP_COUNT] = {
+    "snapshot", "filtered", "full", "full_skip_leaves", "reachable", "census"
+};
+
+/** Runs one operation and prints its record (unless it is a warm-up). */
+static int run_op(JNIEnv* env, const agent_api* api, heap_classes* hc, const bench_config* cfg,
+                  int op, int iter, int warmup, jobjectArray holderOnly, jobjectArray leafClasses,
+                  jobjectArray censusClasses) {
+    if ((*env)->PushLocalFrame(env, 16) != 0) return 0;
+    jlong before[OP_TIME_COUNT], after[OP_TIME_COUNT];
+    api->op_times(before);
+    jlong start = now_nanos();
+    jobjectArray result = NULL;
+    switch (op) {
+        case OP_SNAPSHOT:         result = api->snapshot(env, NULL, hc->target); break;
+        case OP_FILTERED:         result = api->filtered(env, NULL, holderOnly); break;
+        case OP_FULL:             result = api->walk(env, NULL, NULL, JNI_FALSE); break;
+        case OP_FULL_SKIP_LEAVES: result = api->walk(env, NULL, leafClasses, JNI_FALSE); break;
+        case OP_REACHABLE:        result = api->walk(env, NULL, NULL, JNI_TRUE); break;
+        case OP_CENSUS:           result = api->census(env, NULL, censusClasses); break;
+        default: break;
+    }
+    jlong wall = now_nanos() - start;
+    api->op_times(after);
+    int failed = check_exception(env, OP_NAMES[op]);
+    jlong count = failed ? -1 : result_count(env, result, op == OP_CENSUS);
+    if (!failed && op == OP_SNAPSHOT && result == NULL) failed = 1;     /* targets are always live */
+    (*env)->PopLocalFrame(env, NULL);
+
+    if (!warmup) {
+        printf("{\"bench\":\"agent\",\"op\":\"%s\",\"shape\":\"%s\",\"objects\":%ld,\"leaves\":%ld,"
+               "\"garbage\":%ld,\"iter\":%d,\"results\":%lld,\"wall_ns\":%lld,"
+               "\"tag_calls\":%lld,\"tag_wall_ns\":%lld,\"tag_safepoint_ns\":%lld,"
+               "\"resolve_calls\":%lld,\"resolve_wall_ns\":%lld,\"resolve_safepoint_ns\":%lld}\n",
+               OP_NAMES[op], cfg->shape, cfg->objects, cfg->leaves, cfg->garbage, iter,
+               (long long) count, (long long) wall,
+               (long long) (after[0] - before[0]), (long long) (after[1] - before[1]),
+               (long long) (after[2] - before[2]), (long long) (after[3] - before[3]),
+               (long long) (after[4] - before[4]), (long long) (after[5] - before[5]));
+        fflush(stdout);
+    }
+    return !failed;
+}
+
+/** Median wall time of a few System.gc() calls. */
+static jlong gc_nanos(JNIEnv* env, jclass system, jmethodID gc) {
+    jlong samples[3];
+    for (int i = 0; i < 3; i++) {
+        jlong start = now_nanos();
+        (*env)->CallStaticVoidMethod(env, system, gc);
+        samples[i] = now_nanos() - start;
+    }
+    jlong a = samples[0], b = samples[1], c = samples[2];
+    if (a > b) { jlong t = a; a = b; b = t; }
+    if (b > c) { jlong t = b; b = c; c = t; }
+    if (a > b) { jlong t = a; a = b; b = t; }
+    return b;
+}
+
+/**
+ * Tag-map overhead: GC time without tags, then with every target tagged in an environment of
+ * the driver's own (disposed afterwards, which drops the tags), and the time to set the tags.
+ */
+static void run_tagmap(JavaVM* vm, JNIEnv* env, const agent_api* api, heap_classes* hc, const bench_config* cfg) {
+    jclass system = (*env)->FindClass(env, "java/lang/System");
+    jmethodID gc = system ? (*env)->GetStaticMethodID(env, system, "gc", "()V") : NULL;
+    jvmtiEnv* jvmti = NULL;
+    if (!gc || (*vm)->GetEnv(vm, (void**) &jvmti, JVMTI_VERSION_1_2) != JNI_OK || !jvmti) {
+        check_exception(env, "tagmap setup");
+        fprintf(stderr, "tagmap: no JVMTI environment\n");
+        return;
+    }
+    jvmtiCapabilities caps;
+    memset(&caps, 0, sizeof(caps));
+    caps.can_tag_objects = 1;
+    if ((*jvmti)->AddCapabilities(jvmti, &caps) != JVMTI_ERROR_NONE) {
+        fprintf(stderr, "tagmap: can_tag_objects unavailable\n");
+        (*jvmti)->DisposeEnvironment(jvmti);
+        return;
+    }
+
+    jlong untagged = gc_nanos(env, system, gc);
+    jobjectArray targets = api->snapshot(env, NULL, hc->target);
+    jsize n = targets ? (*env)->GetArrayLength(env, targets) : 0;
+    jlong tagStart = now_nanos();
+    for (jsize i = 0; i < n; i++) {
+        jobject t = (*env)->GetObjectArrayElement(env, targets, i);
+        (*jvmti)->SetTag(jvmti, t, (jlong) i + 1);
+        (*env)->DeleteLocalRef(env, t);
+    }
+    jlong tagNanos = now_nanos() - tagStart;
+    if (targets) (*env)->DeleteLocalRef(env, targets);
+    jlong tagged = gc_nanos(env, system, gc);
+    jlong disposeStart = now_nanos();
+    (*jvmti)->DisposeEnvironment(jvmti);
+    jlong disposeNanos = now_nanos() - disposeStart;
+    (*env)->DeleteLocalRef(env, system);
+    check_exception(env, "tagmap");
+
+    printf("{\"bench\":\"agent\",\"op\":\"tagmap\",\"shape\":\"%s\",\"objects\":%ld,\"leaves\":%ld,"
+           "\"garbage\":%ld,\"tags\":%d,\"set_tags_ns\":%lld,\"gc_untagged_ns\":%lld,"
+           "\"gc_tagged_ns\":%lld,\"dispose_ns\":%lld,\"agent_retained_tags\":%lld}\n",
+           cfg->shape, cfg->objects, cfg->leaves, cfg->garbage, (int) n, (long long) tagNanos,
+           (long long) untagged, (long long) tagged, (long long) disposeNanos,
+           (long long) api->retained_tags());
+    fflush(stdout);
+}
+
+/** Prints the run's configuration and the JVM version as the first record. */
+static void print_meta(JNIEnv* env, const bench_config* cfg) {
+    const char* version = "?";
+    jclass system = (*env)->FindClass(env, "java/lang/System");
+    jmethodID getProperty = system
+            ? (*env)->GetStaticMethodID(env, system, "getProperty", "(Ljava/lang/String;)Ljava/lang/String;")
+            : NULL;
+    jstring key = (*env)->NewStringUTF(env, "java.version");
+    jstring value = getProperty ? (jstring) (*env)->CallStaticObjectMethod(env, system, getProperty, key) : NULL;
+    const char* chars = value ? (*env)->GetStringUTFChars(env, value, NULL) : NULL;
+    if (chars) version = chars;
+    printf("{\"bench\":\"agent\",\"op\":\"meta\",\"java_version\":\"%s\",\"shape\":\"%s\",\"objects\":%ld,"
+           "\"leaves\":%ld,\"garbage\":%ld,\"iterations\":%d,\"warmup\":%d}\n",
+           version, cfg->shape, cfg->objects, cfg->leaves, cfg->garbage, cfg->iterations, cfg->warmup);
+    fflush(stdout);
+    if (chars) (*env)->ReleaseStringUTFChars(env, value, chars);
+    check_exception(env, "meta");
+}
+
+int main(int argc, char** argv) {
+    bench_config cfg;
+    if (!parse_args(argc, argv, &cfg)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    char agentOption[4096];
+    snprintf(agentOption, sizeof(agentOption), "-agentpath:%s", cfg.agent);
+    JavaVMOption options[MAX_JVM_OPTS + 1];
+    options[0].optionString = agentOption;
+    options[0].extraInfo = NULL;
+    for (int i = 0; i < cfg.n_jvm_opts; i++) {
+        options[i + 1].optionString = (char*) cfg.jvm_opts[i];
+        options[i + 1].extraInfo = NULL;
+    }
+    JavaVMInitArgs args;
+    args.version = JNI_VERSION_21;
+    args.nOptions = cfg.n_jvm_opts + 1;
+    args.options = options;
+    args.ignoreUnrecognized = JNI_FALSE;
+
+    JavaVM* vm = NULL;
+    JNIEnv* env = NULL;
+    if (JNI_CreateJavaVM(&vm, (void**) &env, &args) != JNI_OK) {
+        fprintf(stderr, "JNI_CreateJavaVM failed\n");
+        return 1;
+    }
+
+    agent_api api;
+    heap_classes hc;
+    memset(&hc, 0, sizeof(hc));
+    int ok = bind_agent(cfg.agent, &api) && resolve_classes(env, &hc) && build_heap(env, &cfg, &hc);
+    if (!ok) {
+        check_exception(env, "setup");
+        fprintf(stderr, "setup failed\n");
+        (*vm)->DestroyJavaVM(vm);
+        return 1;
+    }
+    make_garbage(env, &cfg, &hc);
+    print_meta(env, &cfg);
+
+    jobjectArray holderOnly = class_array(env, hc.holder, NULL);
+    jobjectArray leafClasses = class_array(env, hc.byte_array, hc.string);
+    jobjectArray censusClasses = class_array(env, hc.target, hc.holder);
+    for (int iter = 0; ok && iter < cfg.warmup + cfg.iterations; iter++) {
+        int warmup = iter < cfg.warmup;
+        for (int op = 0; ok && op < OP_COUNT; op++) {
+            ok = run_op(env, &api, &hc, &cfg, op, warmup ? iter : iter - cfg.warmup, warmup,
+                        holderOnly, leafClasses, censusClasses);
+        }
+    }
+    if (ok) run_tagmap(vm, env, &api, &hc, &cfg);
+
+    (*env)->DeleteGlobalRef(env, hc.root);
+    (*vm)->DestroyJavaVM(vm);
+    return ok ? 0 : 1;
+}
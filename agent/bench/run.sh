@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+# Build the native agent and its standalone benchmark driver, then run the driver.
+# Every argument is passed to agent-bench (see agent_bench.c); --agent defaults to the
+# freshly built library. Output: one JSON object per line on stdout.
+#   agent/bench/run.sh --shape chain --objects 200000 --jvm-opt -Xmx4g > agent-bench.jsonl
+set -euo pipefail
+HERE="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+AGENT_DIR="$(cd "$HERE/.." && pwd)"
+
+if [ -z "${JAVA_HOME:-}" ]; then
+    JAVA_HOME="$(dirname "$(dirname "$(readlink -f "$(command -v java)")")")"
+fi
+INC=(-I"$JAVA_HOME/include" -I"$JAVA_HOME/include/linux")
+LIBJVM_DIR="$JAVA_HOME/lib/server"
+OUT="${BENCH_OUT:-$HERE/out}"
+mkdir -p "$OUT"
+
+gcc -fPIC "${INC[@]}" -shared -O2 -o "$OUT/libagent.so" "$AGENT_DIR/agent.c"
+gcc -O2 -Wall "${INC[@]}" -o "$OUT/agent-bench" "$HERE/agent_bench.c" \
+    -L"$LIBJVM_DIR" -Wl,-rpath,"$LIBJVM_DIR" -ljvm -ldl
+
+case " $* " in
+    *" --agent "*) exec "$OUT/agent-bench" "$@" ;;
+    *)             exec "$OUT/agent-bench" --agent "$OUT/libagent.so" "$@" ;;
+esac
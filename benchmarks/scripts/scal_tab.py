@@ -18,6 +18,7 @@ def load(name):
             "m": int(p.get("m", 0)),
             "fanout": int(p.get("fanout", 0)),
             "payloadSize": int(p.get("payloadSize", 0)),
+            "patchThreads": int(p.get("patchThreads", 1)),
             "score": b["primaryMetric"]["score"],
             "err": b["primaryMetric"]["scoreError"],
         })
@@ -41,6 +42,8 @@ def table(title, rows, axis, fixed_note):
 
 table("m axis — object count V (fanout=0)", load("axis-m.json"), "m", "fanout=0, payload=64")
 table("fanout axis — refs/node, connectivity (m=3000)", load("axis-fanout.json"), "fanout", "m=3000, payload=64")
+table("T axis — second-pass patch threads (m=1000000)", load("axis-threads.json"), "patchThreads",
+      "m=1000000, fanout=2")
 table("payloadSize axis — bytes/node, heap (m=20000)", load("axis-payload.json"), "payloadSize", "m=20000, fanout=0")
 
 print("\n## GC axis (m=50000, fanout=0, payload=64)")
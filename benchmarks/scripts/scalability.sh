@@ -7,6 +7,7 @@
 #   - N axis        : total live heap objects (background filler), m fixed → O(N): walk visits all objects
 #   - L axis        : graph depth at fixed m/E (star=1 / chain=m / ring) → flat, stack-safe (iterative patch)
 #   - gc axis       : G1 (default) / ZGC / Shenandoah / Parallel at a fixed config
+#   - T axis        : second-pass patch threads at large m, fanout=2 → SECOND_PASS ≈ 1/T up to the core count
 set -euo pipefail
 HERE="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 ROOT="$(cd "$HERE/../.." && pwd)"
@@ -55,5 +56,11 @@ for gc in G1GC ZGC ShenandoahGC ParallelGC; do
          || echo "  ($gc unavailable/failed, skipped)"
 done
 
+echo "=== [7/7] T axis (m=1000000, fanout=2, patch threads swept) ==="
+java -jar "$JAR" "${BASEARGS[@]}" -p m=1000000 -p fanout=2 -p payloadSize=64 \
+     -p patchThreads=1,2,4,8,16 \
+     -jvmArgsAppend "-Djdk.attach.allowAttachSelf=true -XX:+EnableDynamicAgentLoading -Xms8g -Xmx8g" \
+     -rf json -rff "$OUT/axis-threads.json"
+
 echo "=== tabulate ==="
 python3 "$HERE/scal_tab.py" "$OUT"
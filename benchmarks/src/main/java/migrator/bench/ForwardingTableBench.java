@@ -0,0 +1,160 @@
+package migrator.bench;
+
+import migrator.patch.ForwardingTable;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OperationsPerInvocation;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+import java.util.IdentityHashMap;
+import java.util.Random;
+import java.util.concurrent.TimeUnit;
+import java.util.function.Function;
+
+/**
+ * Lookup throughput and footprint of {@link ForwardingTable} against the {@link IdentityHashMap}
+ * it replaced, at 10K–10M entries.
+ *
+ * <p>The patcher looks up every field and element it visits, so three lookups are measured, each
+ * over {@value #PROBES} probes in random order (nanoseconds per lookup):
+ * <ul>
+ *   <li><b>hit</b> — a mapped old object;</li>
+ *   <li><b>miss</b> — an unmapped instance of the source class;</li>
+ *   <li><b>missOtherClass</b> — an object of another class, the common case while patching, which
+ *       {@code ForwardingTable} rejects before hashing.</li>
+ * </ul>
+ * {@code impl} selects {@code identity} ({@code IdentityHashMap}), {@code table} (the build form)
+ * or {@code frozen} ({@link ForwardingTable#freeze()}). Only one implementation runs per fork, so
+ * the lookup call site stays monomorphic.
+ *
+ * <p>{@link #build} fills a table of {@code entries} mappings once, the first pass's work: run it
+ * with {@code -prof gc}, where {@code gc.alloc.rate.norm} is the bytes the table allocates —
+ * its footprint plus any arrays discarded by resizing. {@code presized=true} sizes the
+ * {@code ForwardingTable} from the entry count first, as the engine does from the snapshot.
+ *
+ * <pre>
+ * java -jar benchmarks/target/benchmarks.jar ForwardingTableBench -prof gc
+ * </pre>
+ */
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@State(Scope.Benchmark)
+@Warmup(iterations = 3, time = 2)
+@Measurement(iterations = 5, time = 2)
+@Fork(value = 1, jvmArgsAppend = { "-Xms8g", "-Xmx8g" })
+public class ForwardingTableBench {
+
+    static final int PROBES = 1 << 16;
+
+    @Param({"10000", "100000", "1000000", "10000000"})
+    public int entries;
+
+    @Param({"identity", "table", "frozen"})
+    public String impl;
+
+    @Param({"true"})
+    public boolean presized;
+
+    /** Stand-in for a source class. */
+    static final class OldUser {
+        final int id;
+        OldUser(int id) { this.id = id; }
+    }
+
+    /** Stand-in for everything else the patcher meets. */
+    static final class Other {
+        final int id;
+        Other(int id) { this.id = id; }
+    }
+
+    private OldUser[] keys;
+    private Object[] values;
+    private Function<Object, Object> lookup;
+
+    private Object[] hits;
+    private Object[] misses;
+    private Object[] others;
+
+    @Setup(Level.Trial)
+    public void setUp() {
+        keys = new OldUser[entries];
+        values = new Object[entries];
+        for (int i = 0; i < entries; i++) {
+            keys[i] = new OldUser(i);
+            values[i] = new Object();
+        }
+        if ("identity".equals(impl)) {
+            IdentityHashMap<Object, Object> map = new IdentityHashMap<>();
+            for (int i = 0; i < entries; i++) map.put(keys[i], values[i]);
+            lookup = map::get;
+        } else {
+            ForwardingTable table = new ForwardingTable();
+            if (presized) table.ensureCapacity(entries);
+            for (int i = 0; i < entries; i++) table.put(keys[i], values[i]);
+            if ("frozen".equals(impl)) table.freeze();
+            lookup = table::get;
+        }
+
+        Random random = new Random(7);
+        hits = new Object[PROBES];
+        misses = new Object[PROBES];
+        others = new Object[PROBES];
+        for (int i = 0; i < PROBES; i++) {
+            hits[i] = keys[random.nextInt(entries)];
+            misses[i] = new OldUser(-i);
+            others[i] = new Other(i);
+        }
+    }
+
+    @Benchmark
+    @OperationsPerInvocation(PROBES)
+    public int hit() {
+        return probe(hits);
+    }
+
+    @Benchmark
+    @OperationsPerInvocation(PROBES)
+    public int miss() {
+        return probe(misses);
+    }
+
+    @Benchmark
+    @OperationsPerInvocation(PROBES)
+    public int missOtherClass() {
+        return probe(others);
+    }
+
+    private int probe(Object[] probes) {
+        Function<Object, Object> f = lookup;
+        int found = 0;
+        for (Object p : probes) {
+            if (f.apply(p) != null) found++;
+        }
+        return found;
+    }
+
+    /** One table of {@code entries} mappings, built from scratch (see the class comment for footprint). */
+    @Benchmark
+    @BenchmarkMode(Mode.SingleShotTime)
+    @OutputTimeUnit(TimeUnit.MILLISECONDS)
+    public Object build() {
+        if ("identity".equals(impl)) {
+            IdentityHashMap<Object, Object> map = new IdentityHashMap<>();
+            for (int i = 0; i < entries; i++) map.put(keys[i], values[i]);
+            return map;
+        }
+        ForwardingTable table = presized ? new ForwardingTable(entries) : new ForwardingTable();
+        for (int i = 0; i < entries; i++) table.put(keys[i], values[i]);
+        if ("frozen".equals(impl)) table.freeze();
+        return table;
+    }
+}
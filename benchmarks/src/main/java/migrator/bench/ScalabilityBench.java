@@ -4,6 +4,7 @@ import migrator.bench.NodeGraph.GraphHolder;
 import migrator.bench.NodeGraph.NodeMigrator;
 import migrator.commit.CommitManager;
 import migrator.commit.RollbackManager;
+import migrator.config.HeapWalkMode;
 import migrator.crac.NoopCracController;
 import migrator.engine.MigrationEngine;
 import migrator.smoke.SmokeTestResult;
@@ -40,7 +41,12 @@ import java.util.concurrent.TimeUnit;
  *
  * <p>Uses the filtered (SPEC) heap walk — S0's intended low-pause path — and forces a collection
  * in per-invocation setup so the walk never re-scans uncollected garbage from previous ops (see
- * memory: heap-walk-sees-uncollected-garbage).
+ * memory: heap-walk-sees-uncollected-garbage). {@code -p walkMode=REACHABLE -p forceGc=false}
+ * instead measures the live-only walk on a heap that still holds the previous ops' garbage.
+ *
+ * <p>{@code -p patchThreads=1,2,4,8,16} sweeps the parallelism of the second-pass patch (see
+ * {@code MigrationEngine.setPatchParallelism}); for large {@code m} the {@code SECOND_PASS} phase
+ * should shrink with the thread count up to the number of cores.
  */
 @BenchmarkMode(Mode.SingleShotTime)
 @OutputTimeUnit(TimeUnit.MILLISECONDS)
@@ -75,6 +81,18 @@ public class ScalabilityBench {
     @Param({"ring"})
     public String layout;
 
+    // Axis W: heap walk mode (HeapWalkMode name) and whether setup collects the previous
+    // invocation's garbage first. REACHABLE never visits it, so it needs no forced GC.
+    @Param({"SPEC"})
+    public String walkMode;
+
+    @Param({"true"})
+    public boolean forceGc;
+
+    // Axis T: threads patching the second-pass walk (1 = sequential on the migrating thread).
+    @Param({"1"})
+    public int patchThreads;
+
     private boolean nativeReady;
 
     @Setup(Level.Trial)
@@ -92,7 +110,7 @@ public class ScalabilityBench {
         // Drop the previous graph and force GC so the filtered walk sees exactly this invocation's
         // m nodes, not uncollected garbage (outside the timed region in SingleShotTime).
         GraphHolder.reset();
-        System.gc();
+        if (forceGc) System.gc();
         GraphHolder.build(m, fanout, payloadSize, layout, bgObjects, bgSize);
     }
 
@@ -111,8 +129,9 @@ public class ScalabilityBench {
                 smoke,
                 new CommitManager(NoopCracController.INSTANCE),
                 new RollbackManager(NoopCracController.INSTANCE));
-        engine.setFullHeapWalk(false);   // filtered (SPEC) walk — S0's intended fast path
+        engine.setHeapWalkMode(HeapWalkMode.valueOf(walkMode));   // SPEC by default — S0's intended fast path
         engine.setAllTimeoutsSeconds(0);
+        engine.setPatchParallelism(patchThreads);
         engine.migrate(Set.of(GraphHolder.class), null, null);
         return GraphHolder.nodes;
     }
@@ -1,11 +1,14 @@
 package migrator.alert;
 
 import migrator.config.AlertLevel;
+import migrator.heap.HeapOpTimes;
 import migrator.metrics.MigrationMetrics;
 import migrator.metrics.MigrationMetrics.Phase;
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
+import java.util.Locale;
+
 /**
  * Structured logging for migration events.
  *
@@ -32,7 +35,8 @@ import org.slf4j.LoggerFactory;
  * 12:00:00.000 INFO  migration - MIGRATION_STARTED id=42
  * 12:00:00.100 INFO  migration - PHASE_STARTED id=42 phase=FIRST_PASS
  * 12:00:00.500 INFO  migration - PHASE_COMPLETED id=42 phase=FIRST_PASS duration_ms=400
- * 12:00:01.000 INFO  migration - MIGRATION_COMPLETED id=42 duration_ms=1000 objects_migrated=500
+ * 12:00:00.500 INFO  migration - HEAP_OPS id=42 phase=FIRST_PASS safepoint_ms=180.2 tag_calls=1 tag_wall_ms=150.3 tag_safepoint_ms=150.1 resolve_calls=1 resolve_wall_ms=40.5 resolve_safepoint_ms=30.1
+ * 12:00:01.000 INFO  migration - MIGRATION_COMPLETED id=42 duration_ms=1000 objects_migrated=500 objects_patched=20 heap_delta=1024 heap_safepoint_ms=310.4
  * </pre>
  */
 public final class MigrationAlertLogger {
@@ -118,6 +122,31 @@ public final class MigrationAlertLogger {
         }
     }
 
+    /**
+     * Log when a migration phase completes, followed by the native heap operations it ran: the
+     * safepoint pauses of heap walks are not visible in the phase duration alone.
+     *
+     * @param migrationId the migration identifier
+     * @param phase the phase that completed
+     * @param durationMs duration of the phase in milliseconds
+     * @param heapOps the heap operations run during the phase (nothing is logged for none)
+     */
+    public static void phaseCompleted(long migrationId, Phase phase, long durationMs, HeapOpTimes heapOps) {
+        phaseCompleted(migrationId, phase, durationMs);
+        if (shouldLogInfo() && heapOps != null && !heapOps.isEmpty()) {
+            log.info("HEAP_OPS id={} phase={} safepoint_ms={} tag_calls={} tag_wall_ms={} tag_safepoint_ms={} "
+                            + "resolve_calls={} resolve_wall_ms={} resolve_safepoint_ms={}",
+                    migrationId, name(phase), ms(heapOps.safepointNanos()),
+                    heapOps.tagCalls(), ms(heapOps.tagWallNanos()), ms(heapOps.tagSafepointNanos()),
+                    heapOps.resolveCalls(), ms(heapOps.resolveWallNanos()), ms(heapOps.resolveSafepointNanos()));
+        }
+    }
+
+    /** Formats nanoseconds as milliseconds with one decimal place. */
+    private static String ms(long nanos) {
+        return String.format(Locale.ROOT, "%.1f", HeapOpTimes.millis(nanos));
+    }
+
     /**
      * Log when a migration completes successfully.
      *
@@ -127,12 +156,13 @@ public final class MigrationAlertLogger {
     public static void migrationCompleted(long migrationId, MigrationMetrics metrics) {
         if (shouldLogInfo()) {
             if (metrics != null) {
-                log.info("MIGRATION_COMPLETED id={} duration_ms={} objects_migrated={} objects_patched={} heap_delta={}",
+                log.info("MIGRATION_COMPLETED id={} duration_ms={} objects_migrated={} objects_patched={} heap_delta={} heap_safepoint_ms={}",
                         migrationId,
                         metrics.totalDurationMs(),
                         metrics.objectsMigrated(),
                         metrics.objectsPatched(),
-                        metrics.heapDelta());
+                        metrics.heapDelta(),
+                        ms(metrics.heapOps().safepointNanos()));
             } else {
                 log.info("MIGRATION_COMPLETED id={}", migrationId);
             }
@@ -36,5 +36,38 @@ public enum HeapWalkMode {
      *   <li>The object graph is well-understood</li>
      * </ul>
      */
-    SPEC
+    SPEC,
+
+    /**
+     * Find the objects that actually hold references to migrated objects
+     * (a JVMTI referrer walk) and patch only those.
+     *
+     * <p>The pause scales with the number of references rather than with
+     * the heap or the holder classes' population, and no holder classes
+     * need to be specified. Use this mode when:
+     * <ul>
+     *   <li>Few objects reference the migrated instances</li>
+     *   <li>Holder classes are unknown or have many instances</li>
+     *   <li>The native agent is available</li>
+     * </ul>
+     */
+    REFERRERS,
+
+    /**
+     * Walk only the objects reachable from the heap roots, like FULL
+     * without the garbage that no GC has reclaimed yet.
+     *
+     * <p>The first-pass snapshots are restricted to reachable instances
+     * too, so dead source objects are neither migrated nor patched, and
+     * no full GC is needed before the migration to keep them out. The
+     * walk follows references from the roots, so its cost follows the
+     * live data rather than the heap. Use this mode when:
+     * <ul>
+     *   <li>The heap holds much uncollected garbage (e.g. a large heap
+     *       between old-generation collections)</li>
+     *   <li>Forcing a GC before the migration is too expensive</li>
+     *   <li>The native agent is available</li>
+     * </ul>
+     */
+    REACHABLE
 }
@@ -0,0 +1,29 @@
+package migrator.config;
+
+/**
+ * Defines how the heap walker calls into the native agent.
+ *
+ * <p>This can be configured via the {@code migration.heap.walker.backend} property in the
+ * configuration file.
+ *
+ * @see MigrationConfig#heapWalkerBackend()
+ * @see migrator.heap.HeapWalker
+ */
+public enum HeapWalkerBackend {
+    /**
+     * Call every native operation through JNI ({@link migrator.heap.NativeHeapWalker}).
+     *
+     * <p>Works on every supported JDK. This is the default.
+     */
+    JNI,
+
+    /**
+     * Bind the agent's statistics entry points through the Foreign Function &amp; Memory API
+     * ({@link migrator.heap.ForeignHeapWalker}); operations on Java objects still use JNI.
+     *
+     * <p>Walk progress, cancellation, operation times and reclamation counters are exchanged
+     * through off-heap memory without a JNI transition. Requires JDK 22 or later at build and run
+     * time; the engine falls back to {@link #JNI} with a warning otherwise.
+     */
+    FOREIGN
+}
@@ -1,6 +1,7 @@
 package migrator.config;
 
 import java.time.Duration;
+import java.util.List;
 
 /**
  * Central configuration for migration operations.
@@ -8,7 +9,22 @@ import java.time.Duration;
  * <p>This class encapsulates all configurable parameters for the migration
  * engine, including:
  * <ul>
- *   <li>Heap walk mode (full vs. filtered)</li>
+ *   <li>Heap walk mode (full, filtered or referrer-driven)</li>
+ *   <li>Heap walker backend (JNI, or the Foreign Function &amp; Memory API)</li>
+ *   <li>Native slot patching</li>
+ *   <li>Reference cap of the one-pass referrer-chain walk</li>
+ *   <li>Type-directed pruning of the reference patcher's traversal</li>
+ *   <li>Parallelism of the second-pass reference patch</li>
+ *   <li>Read-optimized forwarding table for the patch passes</li>
+ *   <li>Visited-set tracking of the second-pass patch (identity set, native marks, walk index)</li>
+ *   <li>Chunk size of streamed FULL / SPEC heap walks</li>
+ *   <li>Leaf filtering of FULL heap walks</li>
+ *   <li>Pre-migration heap census of the source classes</li>
+ *   <li>Holder-class discovery for the SPEC walk filter</li>
+ *   <li>Residual-reference verification after the critical phase</li>
+ *   <li>Reclamation tracking of the old objects after commit</li>
+ *   <li>Engine-managed quiescence by thread suspension, and its allowlist</li>
+ *   <li>Stack-local patching of the suspended threads</li>
  *   <li>Timeout settings for various phases</li>
  *   <li>Heap size constraints</li>
  *   <li>History size and alert level</li>
@@ -25,7 +41,49 @@ public final class MigrationConfig {
     /** Configuration with all defaults: filtered (SPEC) heap walk, no timeouts, WARNING alerts, history size 10. */
     public static final MigrationConfig DEFAULTS = builder().build();
 
+    /** Walk chunk size that streams FULL walks in chunks derived from the walk's size, and resolves the others whole. */
+    public static final int AUTO_WALK_CHUNK_SIZE = -1;
+
+    /** Default number of objects per chunk of a streamed heap walk: {@link #AUTO_WALK_CHUNK_SIZE}. */
+    public static final int DEFAULT_WALK_CHUNK_SIZE = AUTO_WALK_CHUNK_SIZE;
+
+    /**
+     * Default number of references the one-pass referrer-chain walk may record: 8M, 64 MiB of
+     * native edges. Above it the REFERRERS climb takes one referrer walk per level.
+     */
+    public static final long DEFAULT_REFERRER_CHAIN_LIMIT = 8L << 20;
+
+    /** Default number of residual objects whose root path a verification reports. */
+    public static final int DEFAULT_RESIDUAL_PATH_SAMPLES = 3;
+
+    /**
+     * Default reference-free leaf classes skipped by a FULL heap walk, besides primitive arrays:
+     * {@code String} and the boxed primitives.
+     */
+    public static final List<String> DEFAULT_LEAF_CLASSES = List.of(
+            "java.lang.String", "java.lang.Boolean", "java.lang.Byte", "java.lang.Character",
+            "java.lang.Short", "java.lang.Integer", "java.lang.Long", "java.lang.Float",
+            "java.lang.Double");
+
     private final HeapWalkMode heapWalkMode;
+    private final HeapWalkerBackend heapWalkerBackend;
+    private final boolean nativePatching;
+    private final long referrerChainLimit;
+    private final boolean typePruning;
+    private final int patchParallelism;
+    private final boolean freezeForwarding;
+    private final VisitedTracking visitedTracking;
+    private final int walkChunkSize;
+    private final boolean skipLeaves;
+    private final List<String> leafClasses;
+    private final boolean heapCensus;
+    private final boolean discoverHolders;
+    private final boolean verifyResiduals;
+    private final int residualPathSamples;
+    private final boolean trackReclamation;
+    private final boolean quiesceBySuspension;
+    private final List<String> suspendAllowlist;
+    private final boolean patchStackLocals;
     private final Duration heapWalkTimeout;
     private final Duration heapSnapshotTimeout;
     private final Duration criticalPhaseTimeout;
@@ -37,6 +95,24 @@ public final class MigrationConfig {
 
     private MigrationConfig(Builder b) {
         this.heapWalkMode = b.heapWalkMode;
+        this.heapWalkerBackend = b.heapWalkerBackend;
+        this.nativePatching = b.nativePatching;
+        this.referrerChainLimit = b.referrerChainLimit;
+        this.typePruning = b.typePruning;
+        this.patchParallelism = b.patchParallelism;
+        this.freezeForwarding = b.freezeForwarding;
+        this.visitedTracking = b.visitedTracking;
+        this.walkChunkSize = b.walkChunkSize;
+        this.skipLeaves = b.skipLeaves;
+        this.leafClasses = b.leafClasses;
+        this.heapCensus = b.heapCensus;
+        this.discoverHolders = b.discoverHolders;
+        this.verifyResiduals = b.verifyResiduals;
+        this.residualPathSamples = b.residualPathSamples;
+        this.trackReclamation = b.trackReclamation;
+        this.quiesceBySuspension = b.quiesceBySuspension;
+        this.suspendAllowlist = b.suspendAllowlist;
+        this.patchStackLocals = b.patchStackLocals;
         this.heapWalkTimeout = b.heapWalkTimeout;
         this.heapSnapshotTimeout = b.heapSnapshotTimeout;
         this.criticalPhaseTimeout = b.criticalPhaseTimeout;
@@ -56,12 +132,66 @@ public final class MigrationConfig {
         return new Builder();
     }
 
-    /** Returns the heap walk mode (FULL or SPEC). */
+    /** Returns the heap walk mode (FULL, SPEC, REFERRERS or REACHABLE). */
     public HeapWalkMode heapWalkMode() { return heapWalkMode; }
 
+    /** Returns how the heap walker calls into the native agent (JNI or FOREIGN). */
+    public HeapWalkerBackend heapWalkerBackend() { return heapWalkerBackend; }
+
     /** Returns true if full heap walk is enabled. */
     public boolean isFullHeapWalk() { return heapWalkMode == HeapWalkMode.FULL; }
 
+    /** Returns true if holder slots are rewritten natively (REFERRERS mode only). */
+    public boolean isNativePatching() { return nativePatching; }
+
+    /** Returns the most references the REFERRERS one-pass chain walk records, or 0 to climb one walk per level. */
+    public long referrerChainLimit() { return referrerChainLimit; }
+
+    /** Returns true if the reference patcher skips fields and objects whose types cannot reach a source class. */
+    public boolean isTypePruning() { return typePruning; }
+
+    /** Returns the worker threads of the FULL / SPEC / REACHABLE second-pass patch (1 = sequential, 0 = one per processor). */
+    public int patchParallelism() { return patchParallelism; }
+
+    /** Returns true if the forwarding table switches to its read-optimized form for the patch passes. */
+    public boolean isFreezeForwarding() { return freezeForwarding; }
+
+    /** Returns where the second-pass patch keeps its visited set (IDENTITY, MARKS, INDEX or AUTO). */
+    public VisitedTracking visitedTracking() { return visitedTracking; }
+
+    /** Returns the objects per chunk of a streamed heap walk, 0 to resolve every walk whole, or {@link #AUTO_WALK_CHUNK_SIZE}. */
+    public int walkChunkSize() { return walkChunkSize; }
+
+    /** Returns true if FULL heap walks skip primitive arrays and instances of the {@link #leafClasses()}. */
+    public boolean isSkipLeaves() { return skipLeaves; }
+
+    /** Returns the names of the reference-free classes a FULL heap walk skips (besides primitive arrays). */
+    public List<String> leafClasses() { return leafClasses; }
+
+    /** Returns true if the source classes are counted before the first pass, for admission control and metrics. */
+    public boolean isHeapCensus() { return heapCensus; }
+
+    /** Returns true if SPEC walks also visit the classes found holding source instances in the heap. */
+    public boolean isDiscoverHolders() { return discoverHolders; }
+
+    /** Returns true if the old objects still reachable after the critical phase are looked for and reported. */
+    public boolean isVerifyResiduals() { return verifyResiduals; }
+
+    /** Returns the number of residual objects whose shortest root path the verification logs. */
+    public int residualPathSamples() { return residualPathSamples; }
+
+    /** Returns true if the frees of the old objects are counted after commit, to tell when they are reclaimed. */
+    public boolean isTrackReclamation() { return trackReclamation; }
+
+    /** Returns true if the engine suspends the application threads itself for the critical phase. */
+    public boolean isQuiesceBySuspension() { return quiesceBySuspension; }
+
+    /** Returns the names (or prefixes ending with {@code '*'}) of the threads a suspension leaves running. */
+    public List<String> suspendAllowlist() { return suspendAllowlist; }
+
+    /** Returns true if the locals of the suspended threads that reference old objects are rewritten. */
+    public boolean isPatchStackLocals() { return patchStackLocals; }
+
     /** Returns the timeout for heap walk operations. */
     public Duration heapWalkTimeout() { return heapWalkTimeout; }
 
@@ -90,6 +220,24 @@ public final class MigrationConfig {
     public String toString() {
         return "MigrationConfig{" +
                 "heapWalkMode=" + heapWalkMode +
+                ", heapWalkerBackend=" + heapWalkerBackend +
+                ", nativePatching=" + nativePatching +
+                ", referrerChainLimit=" + referrerChainLimit +
+                ", typePruning=" + typePruning +
+                ", patchParallelism=" + patchParallelism +
+                ", freezeForwarding=" + freezeForwarding +
+                ", visitedTracking=" + visitedTracking +
+                ", walkChunkSize=" + walkChunkSize +
+                ", skipLeaves=" + skipLeaves +
+                ", leafClasses=" + leafClasses +
+                ", heapCensus=" + heapCensus +
+                ", discoverHolders=" + discoverHolders +
+                ", verifyResiduals=" + verifyResiduals +
+                ", residualPathSamples=" + residualPathSamples +
+                ", trackReclamation=" + trackReclamation +
+                ", quiesceBySuspension=" + quiesceBySuspension +
+                ", suspendAllowlist=" + suspendAllowlist +
+                ", patchStackLocals=" + patchStackLocals +
                 ", heapWalkTimeout=" + heapWalkTimeout.toSeconds() + "s" +
                 ", heapSnapshotTimeout=" + heapSnapshotTimeout.toSeconds() + "s" +
                 ", criticalPhaseTimeout=" + criticalPhaseTimeout.toSeconds() + "s" +
@@ -106,6 +254,24 @@ public final class MigrationConfig {
      */
     public static final class Builder {
         private HeapWalkMode heapWalkMode = HeapWalkMode.SPEC;
+        private HeapWalkerBackend heapWalkerBackend = HeapWalkerBackend.JNI;
+        private boolean nativePatching = false;
+        private long referrerChainLimit = DEFAULT_REFERRER_CHAIN_LIMIT;
+        private boolean typePruning = true;
+        private int patchParallelism = 1;
+        private boolean freezeForwarding = false;
+        private VisitedTracking visitedTracking = VisitedTracking.AUTO;
+        private int walkChunkSize = DEFAULT_WALK_CHUNK_SIZE;
+        private boolean skipLeaves = true;
+        private List<String> leafClasses = DEFAULT_LEAF_CLASSES;
+        private boolean heapCensus = false;
+        private boolean discoverHolders = false;
+        private boolean verifyResiduals = false;
+        private int residualPathSamples = DEFAULT_RESIDUAL_PATH_SAMPLES;
+        private boolean trackReclamation = false;
+        private boolean quiesceBySuspension = false;
+        private List<String> suspendAllowlist = List.of();
+        private boolean patchStackLocals = false;
         private Duration heapWalkTimeout = Duration.ZERO;
         private Duration heapSnapshotTimeout = Duration.ZERO;
         private Duration criticalPhaseTimeout = Duration.ZERO;
@@ -120,6 +286,100 @@ public final class MigrationConfig {
             return this;
         }
 
+        public Builder heapWalkerBackend(HeapWalkerBackend backend) {
+            this.heapWalkerBackend = backend != null ? backend : HeapWalkerBackend.JNI;
+            return this;
+        }
+
+        public Builder nativePatching(boolean enabled) {
+            this.nativePatching = enabled;
+            return this;
+        }
+
+        public Builder referrerChainLimit(long references) {
+            if (references < 0) throw new IllegalArgumentException("referrerChainLimit must not be negative");
+            this.referrerChainLimit = references;
+            return this;
+        }
+
+        public Builder typePruning(boolean enabled) {
+            this.typePruning = enabled;
+            return this;
+        }
+
+        public Builder patchParallelism(int threads) {
+            if (threads < 0) throw new IllegalArgumentException("patchParallelism must not be negative");
+            this.patchParallelism = threads;
+            return this;
+        }
+
+        public Builder freezeForwarding(boolean enabled) {
+            this.freezeForwarding = enabled;
+            return this;
+        }
+
+        public Builder visitedTracking(VisitedTracking tracking) {
+            this.visitedTracking = tracking != null ? tracking : VisitedTracking.AUTO;
+            return this;
+        }
+
+        public Builder walkChunkSize(int size) {
+            if (size < AUTO_WALK_CHUNK_SIZE) throw new IllegalArgumentException("walkChunkSize must be -1 (auto) or more");
+            this.walkChunkSize = size;
+            return this;
+        }
+
+        public Builder skipLeaves(boolean enabled) {
+            this.skipLeaves = enabled;
+            return this;
+        }
+
+        public Builder leafClasses(List<String> classNames) {
+            this.leafClasses = classNames != null ? List.copyOf(classNames) : List.of();
+            return this;
+        }
+
+        public Builder heapCensus(boolean enabled) {
+            this.heapCensus = enabled;
+            return this;
+        }
+
+        public Builder discoverHolders(boolean enabled) {
+            this.discoverHolders = enabled;
+            return this;
+        }
+
+        public Builder verifyResiduals(boolean enabled) {
+            this.verifyResiduals = enabled;
+            return this;
+        }
+
+        public Builder residualPathSamples(int samples) {
+            if (samples < 0) throw new IllegalArgumentException("residualPathSamples must not be negative");
+            this.residualPathSamples = samples;
+            return this;
+        }
+
+        public Builder trackReclamation(boolean enabled) {
+            this.trackReclamation = enabled;
+            return this;
+        }
+
+        public Builder quiesceBySuspension(boolean enabled) {
+            this.quiesceBySuspension = enabled;
+            return this;
+        }
+
+        public Builder suspendAllowlist(List<String> threadNames) {
+            this.suspendAllowlist = threadNames != null ? List.copyOf(threadNames) : List.of();
+            return this;
+        }
+
+        public Builder patchStackLocals(boolean enabled) {
+            this.patchStackLocals = enabled;
+            return this;
+        }
+
         public Builder heapWalkTimeout(Duration timeout) {
             this.heapWalkTimeout = timeout != null ? timeout : Duration.ZERO;
             return this;
@@ -8,6 +8,7 @@ import java.io.IOException;
 import java.io.InputStream;
 import java.nio.file.Files;
 import java.nio.file.Path;
+import java.util.Arrays;
 import java.util.Map;
 import java.util.Properties;
 
@@ -25,7 +26,22 @@ import java.util.Properties;
  *
  * <h2>Configuration Properties:</h2>
  * <ul>
- *   <li>{@code migration.heap.walk.mode} - FULL or SPEC</li>
+ *   <li>{@code migration.heap.walk.mode} - FULL, SPEC, REFERRERS or REACHABLE</li>
+ *   <li>{@code migration.heap.walker.backend} - JNI or FOREIGN (JDK 22+)</li>
+ *   <li>{@code migration.patch.native} - true to rewrite holder slots natively (REFERRERS mode)</li>
+ *   <li>{@code migration.referrers.chain.limit} - references the one-pass REFERRERS chain walk may record (0 = one walk per level)</li>
+ *   <li>{@code migration.patch.prune} - false to traverse fields and objects whose types cannot reach a source class</li>
+ *   <li>{@code migration.patch.parallelism} - second-pass patch threads (1 = sequential, 0 = one per processor)</li>
+ *   <li>{@code migration.forwarding.freeze} - true to switch the forwarding table to its read-optimized form for the patch passes</li>
+ *   <li>{@code migration.patch.visited} - IDENTITY, MARKS, INDEX or AUTO: where the second-pass patch keeps its visited set</li>
+ *   <li>{@code migration.heap.walk.chunk.size} - objects per chunk of a streamed walk, 0 to resolve walks whole, or {@code auto} (default) to stream FULL walks in derived chunks</li>
+ *   <li>{@code migration.spec.discover.holders} - true to add the classes found holding source instances to the SPEC walk</li>
+ *   <li>{@code migration.verify.residual} - true to report the old objects still reachable after the critical phase</li>
+ *   <li>{@code migration.verify.residual.paths} - number of residual objects whose root path is logged</li>
+ *   <li>{@code migration.reclaim.track} - true to count the frees of the old objects after commit</li>
+ *   <li>{@code migration.quiesce.suspend} - true to suspend the application threads natively for the critical phase</li>
+ *   <li>{@code migration.quiesce.suspend.allow} - comma-separated thread names (or prefixes ending with {@code *}) left running</li>
+ *   <li>{@code migration.patch.stack.locals} - true to rewrite the locals of the suspended threads (needs {@code migration.quiesce.suspend})</li>
  *   <li>{@code migration.timeout.heap.walk} - timeout in seconds</li>
  *   <li>{@code migration.timeout.heap.snapshot} - timeout in seconds</li>
  *   <li>{@code migration.timeout.critical.phase} - timeout in seconds</li>
@@ -157,6 +173,84 @@ public final class MigrationConfigLoader {
             }
         });
 
+        getString(props, "migration.heap.walker.backend").ifPresent(v -> {
+            try {
+                b.heapWalkerBackend(HeapWalkerBackend.valueOf(v.toUpperCase()));
+            } catch (IllegalArgumentException e) {
+                log.warn("Invalid heap.walker.backend: {}", v);
+            }
+        });
+
+        getBoolean(props, "migration.patch.native").ifPresent(b::nativePatching);
+
+
+        getBoolean(props, "migration.patch.prune").ifPresent(b::typePruning);
+
+        getBoolean(props, "migration.heap.walk.skip.leaves").ifPresent(b::skipLeaves);
+
+        getString(props, "migration.heap.walk.leaf.classes").ifPresent(v -> b.leafClasses(
+                Arrays.stream(v.split(","))
+                        .map(String::trim)
+                        .filter(name -> !name.isEmpty())
+                        .toList()));
+
+        getBoolean(props, "migration.heap.census").ifPresent(b::heapCensus);
+
+        getBoolean(props, "migration.spec.discover.holders").ifPresent(b::discoverHolders);
+
+        getBoolean(props, "migration.verify.residual").ifPresent(b::verifyResiduals);
+
+        getInt(props, "migration.verify.residual.paths").ifPresent(v -> {
+            if (v >= 0) b.residualPathSamples(v);
+            else log.warn("Ignoring negative verify.residual.paths: {}", v);
+        });
+
+        getBoolean(props, "migration.reclaim.track").ifPresent(b::trackReclamation);
+
+        getBoolean(props, "migration.quiesce.suspend").ifPresent(b::quiesceBySuspension);
+
+        getString(props, "migration.quiesce.suspend.allow").ifPresent(v -> b.suspendAllowlist(
+                Arrays.stream(v.split(","))
+                        .map(String::trim)
+                        .filter(name -> !name.isEmpty())
+                        .toList()));
+
+        getBoolean(props, "migration.patch.stack.locals").ifPresent(b::patchStackLocals);
+
+        getBoolean(props, "migration.forwarding.freeze").ifPresent(b::freezeForwarding);
+
+        getString(props, "migration.patch.visited").ifPresent(v -> {
+            try {
+                b.visitedTracking(VisitedTracking.valueOf(v.toUpperCase()));
+            } catch (IllegalArgumentException e) {
+                log.warn("Invalid patch.visited: {}", v);
+            }
+        });
+
+        getInt(props, "migration.patch.parallelism").ifPresent(v -> {
+            if (v >= 0) b.patchParallelism(v);
+            else log.warn("Ignoring negative patch.parallelism: {}", v);
+        });
+
+        getLong(props, "migration.referrers.chain.limit").ifPresent(v -> {
+            if (v >= 0) b.referrerChainLimit(v);
+            else log.warn("Ignoring negative referrers.chain.limit: {}", v);
+        });
+
+        getString(props, "migration.heap.walk.chunk.size").ifPresent(v -> {
+            if (v.equalsIgnoreCase("auto")) {
+                b.walkChunkSize(MigrationConfig.AUTO_WALK_CHUNK_SIZE);
+                return;
+            }
+            try {
+                int n = Integer.parseInt(v);
+                if (n >= 0) b.walkChunkSize(n);
+                else log.warn("Ignoring negative heap.walk.chunk.size: {}", n);
+            } catch (NumberFormatException e) {
+                log.warn("Invalid heap.walk.chunk.size: {}", v);
+            }
+        });
+
         getLong(props, "migration.timeout.heap.walk").ifPresent(b::heapWalkTimeoutSeconds);
         getLong(props, "migration.timeout.heap.snapshot").ifPresent(b::heapSnapshotTimeoutSeconds);
         getLong(props, "migration.timeout.critical.phase").ifPresent(b::criticalPhaseTimeoutSeconds);
@@ -187,6 +281,16 @@ public final class MigrationConfigLoader {
         return val != null ? java.util.Optional.of(val.trim()) : java.util.Optional.empty();
     }
 
+    /** Reads a key as a boolean ({@code true}/{@code false}, case-insensitive), returning empty (and logging a warning) otherwise. */
+    private static java.util.Optional<Boolean> getBoolean(Properties props, String key) {
+        return getString(props, key).flatMap(v -> {
+            if (v.equalsIgnoreCase("true")) return java.util.Optional.of(Boolean.TRUE);
+            if (v.equalsIgnoreCase("false")) return java.util.Optional.of(Boolean.FALSE);
+            log.warn("Invalid boolean for {}: {}", key, v);
+            return java.util.Optional.empty();
+        });
+    }
+
     /** Reads a key as a long, returning empty (and logging a warning) when not a valid number. */
     private static java.util.Optional<Long> getLong(Properties props, String key) {
         return getString(props, key).flatMap(v -> {
@@ -0,0 +1,43 @@
+package migrator.config;
+
+/**
+ * Defines where the second-pass reference patch keeps its visited set, the objects its
+ * traversal has already scheduled.
+ *
+ * <p>This can be configured via the {@code migration.patch.visited} property in the
+ * configuration file. It applies to the batches the reflective patcher traverses after a heap
+ * walk; single roots, static fields and referrer walks always use a small identity set.
+ *
+ * @see MigrationConfig#visitedTracking()
+ * @see migrator.patch.VisitedSet
+ */
+public enum VisitedTracking {
+    /**
+     * An identity hash set on the Java heap: the fastest per object, but a few words per visited
+     * object, so a FULL walk of a large heap allocates a set as large as the heap's object count
+     * inside the critical phase.
+     */
+    IDENTITY,
+
+    /**
+     * JVMTI tags set by the native agent, one epoch per batch, dropped at once when the batch
+     * ends. Nothing per object on the Java heap, at the cost of a native call per visited object.
+     * Falls back to {@link #IDENTITY} without the native agent.
+     */
+    MARKS,
+
+    /**
+     * One bit per object, keyed by the dense index a streamed FULL or REACHABLE walk gives each
+     * object it delivers. Such a walk delivers every object that can hold a reference, so the
+     * traversal leaves an object of a later chunk to that chunk instead of marking it. Other walks
+     * fall back to {@link #IDENTITY}.
+     */
+    INDEX,
+
+    /**
+     * Chosen by the heap walk: {@link #INDEX} for a streamed FULL or REACHABLE walk, so a walk
+     * resolved in bounded chunks also keeps a bounded visited set, and {@link #IDENTITY} for every
+     * other walk, which already holds its whole result on the Java heap. This is the default.
+     */
+    AUTO
+}
@@ -0,0 +1,151 @@
+package migrator.engine;
+
+import migrator.exceptions.MigrationTimeoutException;
+import migrator.heap.HeapWalker;
+import migrator.state.MigrationState;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.time.Duration;
+import java.util.concurrent.ArrayBlockingQueue;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.CancellationException;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicReference;
+import java.util.function.Consumer;
+
+/**
+ * Runs a chunked heap walk on a worker thread and hands its chunks to the calling thread through
+ * a one-slot queue, so the caller consumes chunk N while the walker resolves chunk N+1.
+ *
+ * <p>At most three chunks are alive at once: the one being consumed, the one queued and the one
+ * being resolved. The consumer always runs in the calling thread, so when the walk times out or
+ * fails nothing is left consuming concurrently with the caller's fallback.
+ *
+ * <p>The timeout bounds the time the caller spends <em>waiting</em> for chunks (the walk's own
+ * cost), not the time spent consuming them, matching the non-streaming walks where the timeout
+ * covers the walk but not the patch. Given the walker running the walk, its live progress is
+ * published to {@link MigrationState} and a timed-out walk is cancelled through the walker, so a
+ * native walk stops within a poll interval instead of finishing its heap pass.
+ */
+final class ChunkPipeline {
+
+    private static final Logger log = LoggerFactory.getLogger(ChunkPipeline.class);
+
+    /** End-of-walk marker; compared by identity. */
+    private static final Object[] END = new Object[0];
+
+    /** A chunked walk that delivers its chunks to the given sink, in the thread that runs it. */
+    @FunctionalInterface
+    interface ChunkedWalk {
+        long walk(Consumer<Object[]> chunkSink) throws Exception;
+    }
+
+    private ChunkPipeline() {
+        // Utility class
+    }
+
+    /**
+     * Runs {@code walk} on a worker thread and passes each chunk to {@code consumer} in the
+     * calling thread.
+     *
+     * @param operation the name of the operation (for error messages and the worker's name)
+     * @param timeout   the walk timeout, or null/zero to disable
+     * @param walk      the chunked walk
+     * @param consumer  receives each chunk, in order
+     * @return the number of objects consumed
+     * @throws MigrationTimeoutException if the walk keeps the caller waiting longer than the timeout
+     * @throws Exception if the walk or the consumer fails
+     */
+    static long run(String operation, Duration timeout, ChunkedWalk walk, Consumer<Object[]> consumer)
+            throws Exception {
+        return run(operation, timeout, null, walk, consumer);
+    }
+
+    /**
+     * Runs {@code walk} as {@link #run(String, Duration, ChunkedWalk, Consumer)} does, publishing
+     * the progress of {@code walker} while it runs and cancelling its walk if the caller stops
+     * consuming before the walk ends (on timeout or when the consumer fails).
+     *
+     * @param walker the heap walker running the walk, or null for none
+     */
+    static long run(String operation, Duration timeout, HeapWalker walker, ChunkedWalk walk,
+                    Consumer<Object[]> consumer) throws Exception {
+        if (walker != null) MigrationState.getInstance().walkStarted(operation, walker::walkProgress);
+        try {
+            return pipe(operation, timeout, walker, walk, consumer);
+        } finally {
+            if (walker != null) MigrationState.getInstance().walkFinished();
+        }
+    }
+
+    private static long pipe(String operation, Duration timeout, HeapWalker walker, ChunkedWalk walk,
+                             Consumer<Object[]> consumer) throws Exception {
+        BlockingQueue<Object[]> handoff = new ArrayBlockingQueue<>(1);
+        AtomicReference<Throwable> failure = new AtomicReference<>();
+
+        Thread worker = new Thread(() -> {
+            try {
+                walk.walk(chunk -> {
+                    try {
+                        handoff.put(chunk);
+                    } catch (InterruptedException e) {
+                        // the caller stopped consuming: abort the walk at this chunk boundary
+                        Thread.currentThread().interrupt();
+                        throw new CancellationException(operation + " cancelled");
+                    }
+                });
+            } catch (Throwable t) {
+                failure.set(t);
+            } finally {
+                try {
+                    handoff.put(END);
+                } catch (InterruptedException e) {
+                    Thread.currentThread().interrupt();
+                }
+            }
+        }, "migration-" + operation);
+        worker.setDaemon(true);
+        worker.start();
+
+        boolean timed = MigrationTimeoutConfig.isEnabled(timeout);
+        long budgetNanos = timed ? timeout.toNanos() : 0L;
+        long consumed = 0;
+        boolean drained = false;
+        try {
+            while (true) {
+                Object[] chunk;
+                if (timed) {
+                    long waitStart = System.nanoTime();
+                    chunk = handoff.poll(budgetNanos, TimeUnit.NANOSECONDS);
+                    budgetNanos -= System.nanoTime() - waitStart;
+                    if (chunk == null) {
+                        log.warn("Operation '{}' timed out after {} ms", operation, timeout.toMillis());
+                        throw new MigrationTimeoutException(operation, timeout);
+                    }
+                } else {
+                    chunk = handoff.take();
+                }
+                if (chunk == END) {
+                    drained = true;
+                    break;
+                }
+                consumer.accept(chunk);
+                consumed += chunk.length;
+            }
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+            throw new MigrationTimeoutException(operation, timeout, e);
+        } finally {
+            // a native walk still tagging does not see the interrupt; ask it to stop
+            if (!drained && walker != null && worker.isAlive()) TimeoutExecutor.cancelWalk(operation, walker);
+            // no-op once the worker has finished; otherwise unblocks its put() so it stops
+            worker.interrupt();
+        }
+
+        Throwable t = failure.get();
+        if (t instanceof Error err) throw err;
+        if (t instanceof Exception ex) throw ex;
+        return consumed;
+    }
+}
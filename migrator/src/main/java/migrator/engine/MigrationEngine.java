@@ -5,8 +5,11 @@ import org.slf4j.LoggerFactory;
 
 import migrator.ClassMigrator;
 import migrator.alert.MigrationAlertLogger;
+import migrator.config.HeapWalkMode;
+import migrator.config.HeapWalkerBackend;
 import migrator.config.MigrationConfig;
 import migrator.config.MigrationConfigLoader;
+import migrator.config.VisitedTracking;
 import migrator.commit.*;
 import migrator.exceptions.MigrateException;
 import migrator.exceptions.MigrationTimeoutException;
@@ -18,6 +21,7 @@ import migrator.metrics.MigrationMetricsCollector;
 import migrator.patch.*;
 import migrator.phase.*;
 import migrator.plan.*;
+import migrator.quiesce.*;
 import migrator.registry.RegistryUpdater;
 import migrator.scanner.*;
 import migrator.smoke.SmokeTestReport;
@@ -26,25 +30,33 @@ import migrator.state.MigrationState;
 
 import java.lang.reflect.InvocationTargetException;
 import java.lang.reflect.Method;
+import java.nio.file.Path;
 import java.time.Duration;
 import java.util.*;
+import java.util.concurrent.Callable;
 import java.util.concurrent.ConcurrentHashMap;
 import java.util.concurrent.ConcurrentMap;
 import java.util.concurrent.atomic.AtomicBoolean;
 import java.util.concurrent.atomic.AtomicLong;
+import java.util.function.Consumer;
 
 /**
  * Final MigrationEngine — orchestrates live migration end-to-end, including:
  *  - first pass (allocate & migrate)
  *  - signal before critical phase (app should quiesce)
+ *  - optional engine-managed quiescence: suspend the application threads natively
  *  - second pass (patch references)
+ *  - optional stack-local patching of the suspended threads
  *  - registry updates
  *  - signal after critical phase (app may resume)
+ *  - optional residual-reference verification (old objects still reachable)
  *  - smoke-tests
  *  - commit (delete checkpoint) OR rollback (restore checkpoint)
+ *  - optional reclamation tracking of the old objects after commit
  *
  * Notes:
- *  - Engine does NOT perform pause/resume itself; it only signals via MigrationPhaseListener.
+ *  - Engine does NOT perform pause/resume itself unless quiescing by suspension is enabled;
+ *    otherwise it only signals via MigrationPhaseListener.
  *  - RollbackManager.restore may not return (platform-specific).
  *  - Migrations must be serialized: a single global {@link MigrationState} and the static
  *    {@code lastMetrics} assume one migration runs at a time per JVM. Do not run migrations
@@ -55,7 +67,9 @@ public final class MigrationEngine {
     private static final Logger log = LoggerFactory.getLogger(MigrationEngine.class);
 
     private final MigrationPlan plan;
-    private final HeapWalker heapWalker;
+    // Replaced only by setHeapWalkerBackend, before a migration starts
+    private HeapWalker heapWalker;
+    private final ThreadSuspender threadSuspender;
     private final ForwardingTable forwarding;
     private final ReferencePatcher referencePatcher;
     private final RegistryUpdater registryUpdater;
@@ -84,10 +98,82 @@ public final class MigrationEngine {
     // its terminal state is recorded only once.
     private final AtomicBoolean finalized = new AtomicBoolean(false);
 
-    // Configuration: true = full heap walk, false = filtered heap walk for specified classes only.
-    // Filtered is the default: it only tags instances of the classes that can hold references to
-    // migrated objects, avoiding an O(heap) reflective scan during the critical (quiesced) phase.
-    private boolean fullHeapWalk = false;
+    // Second-pass strategy: FULL patches every object on the heap, SPEC (the default) only instances
+    // of the classes that can hold references to migrated objects, avoiding an O(heap) reflective
+    // scan during the critical (quiesced) phase; REFERRERS patches only the objects that actually
+    // hold such a reference.
+    private HeapWalkMode heapWalkMode = HeapWalkMode.SPEC;
+
+    // How the heap walker calls into the agent: FOREIGN binds its statistics through
+    // java.lang.foreign (JDK 22+), falling back to JNI when that is unavailable.
+    private HeapWalkerBackend heapWalkerBackend = HeapWalkerBackend.JNI;
+
+    // Upper bound on referrer-walk levels: climbing from a migrated object through JDK internals
+    // (map node -> table -> map -> owner) rarely needs more than four.
+    private static final int MAX_REFERRER_DEPTH = 8;
+
+    // REFERRERS mode: the most references the one-pass chain walk may record before the climb
+    // falls back to one referrer walk per level; 0 always climbs per level.
+    private long referrerChainLimit = MigrationConfig.DEFAULT_REFERRER_CHAIN_LIMIT;
+
+    // REFERRERS mode only: rewrite the slots of direct holders natively (no reflection), leaving
+    // JDK containers and any skipped slot to the Java patcher.
+    private boolean nativePatching = false;
+
+    // Switch the forwarding table to its read-optimized form (keys and values in separate arrays)
+    // after the straggler rescan, for the patch passes.
+    private boolean freezeForwarding = false;
+
+    // FULL, SPEC and REACHABLE modes: where the second-pass patch keeps its visited set (see
+    // VisitedTracking); AUTO picks by the heap walk mode when the pass starts.
+    private VisitedTracking visitedTracking = VisitedTracking.AUTO;
+
+    // FULL, SPEC and REACHABLE modes: patch the walked objects on this many threads (1 = on the
+    // migrating thread, 0 = one per processor). The parallel patcher and its pool are built lazily
+    // and kept for later migrations with the same parallelism.
+    private int patchParallelism = 1;
+    private ParallelReferencePatcher parallelPatcher;
+
+    // FULL, REACHABLE and SPEC modes: resolve the heap walk in chunks of this many objects and patch
+    // each chunk while the next one resolves, so the walk never materializes the whole heap at once;
+    // 0 resolves the walk as one set, and AUTO (default) streams FULL walks in chunks derived from
+    // the walk's size. Each chunk costs a GetObjectsWithTags scan of the tag map.
+    private int walkChunkSize = MigrationConfig.DEFAULT_WALK_CHUNK_SIZE;
+
+    // FULL / REACHABLE modes: the walk skips primitive arrays and instances of these reference-free classes, so
+    // they are never resolved or handed to the patcher.
+    private boolean skipLeaves = true;
+    private Set<Class<?>> leafClasses = resolveLeafClasses(MigrationConfig.DEFAULT_LEAF_CLASSES);
+
+    // Admission control: count the source classes before the first pass (see censusSourceClasses)
+    // and refuse a migration whose projected heap exceeds maxHeapSizeMb (0 = no limit).
+    private boolean heapCensus = false;
+    private long maxHeapSizeMb = 0;
+
+    // SPEC mode: under quiescence, find the classes holding source instances (one heap pass, no
+    // objects resolved) and add them to the filtered walk, their static-field owners to static patching.
+    private boolean discoverHolders = false;
+
+    // Verification after the critical phase: look for old objects still reachable (references the
+    // patch passes missed) and log the shortest root path of up to residualPathSamples of them.
+    private boolean verifyResiduals = false;
+    private int residualPathSamples = MigrationConfig.DEFAULT_RESIDUAL_PATH_SAMPLES;
+
+    // After commit: count the frees of the old objects, published live through MigrationState.
+    private boolean trackReclamation = false;
+
+    // Engine-managed quiescence: after onBeforeCriticalPhase, suspend every application thread not
+    // on the allowlist until the registry update is done, instead of trusting the listener alone.
+    private boolean quiesceBySuspension = false;
+    private List<String> suspendAllowlist = List.of();
+
+    // With suspension only: after the second pass, rewrite the locals of the suspended threads
+    // that still reference old objects, so threads need not drain before being frozen.
+    private boolean patchStackLocals = false;
+
+    // Root-scoped migration (migrateReachableFrom): the roots of the running migration, whose
+    // instance graph replaces the heap in the snapshots and the second pass; null for the whole heap.
+    private Object[] scopeRoots;
 
     // Metrics collection
     private final MigrationMetricsCollector metricsCollector = new MigrationMetricsCollector();
@@ -116,8 +202,10 @@ public final class MigrationEngine {
         }
 
         heapWalker = new NativeHeapWalker();
+        threadSuspender = new NativeThreadSuspender();
         forwarding = new ForwardingTable();
         referencePatcher = new ReflectionReferencePatcher(forwarding);
+        setTypePruning(true);
         registryUpdater = new RegistryUpdater(forwarding, referencePatcher);
         smokeRunner = resolver.resolveSmokeTestRunner(scan.smokeTests());
         commitManager = resolver.resolveCommitManager(scan.commitManager());
@@ -129,21 +217,435 @@ public final class MigrationEngine {
 
     /**
      * Set heap walk mode.
-     * @param fullHeapWalk true for full heap walk (default), false for filtered heap walk
+     * @param fullHeapWalk true for full heap walk, false for filtered heap walk (default)
      * @return this engine for method chaining
      */
     public MigrationEngine setFullHeapWalk(boolean fullHeapWalk) {
-        this.fullHeapWalk = fullHeapWalk;
+        this.heapWalkMode = fullHeapWalk ? HeapWalkMode.FULL : HeapWalkMode.SPEC;
         return this;
     }
 
+    /**
+     * Set the heap walk mode used by the second pass. REACHABLE also restricts the first-pass
+     * snapshots to reachable instances.
+     * @param mode FULL, SPEC, REFERRERS or REACHABLE (null resets to the SPEC default)
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setHeapWalkMode(HeapWalkMode mode) {
+        this.heapWalkMode = mode != null ? mode : HeapWalkMode.SPEC;
+        return this;
+    }
+
+    /**
+     * @return the heap walk mode used by the second pass
+     */
+    public HeapWalkMode getHeapWalkMode() {
+        return heapWalkMode;
+    }
+
+    /**
+     * Set how the heap walker calls into the native agent. FOREIGN needs JDK 22 or later and the
+     * loaded agent; when it cannot be bound, a warning is logged and JNI is kept. A heap walker
+     * other than the engine's own native one is left in place.
+     * @param backend JNI or FOREIGN (null resets to the JNI default)
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setHeapWalkerBackend(HeapWalkerBackend backend) {
+        this.heapWalkerBackend = backend != null ? backend : HeapWalkerBackend.JNI;
+        if (!(heapWalker instanceof NativeHeapWalker) && !(heapWalker instanceof ForeignHeapWalker)) {
+            return this;
+        }
+        if (heapWalkerBackend == HeapWalkerBackend.FOREIGN) {
+            if (!(heapWalker instanceof ForeignHeapWalker)) {
+                try {
+                    heapWalker = ForeignHeapWalker.create();
+                } catch (MigrateException e) {
+                    log.warn("{}; using the JNI heap walker", e.getMessage());
+                }
+            }
+        } else if (!(heapWalker instanceof NativeHeapWalker)) {
+            heapWalker = new NativeHeapWalker();
+        }
+        return this;
+    }
+
+    /**
+     * @return the configured heap walker backend (the walker may have fallen back to JNI)
+     */
+    public HeapWalkerBackend getHeapWalkerBackend() {
+        return heapWalkerBackend;
+    }
+
+    /**
+     * Enable native slot patching for the REFERRERS second pass: plain fields, static fields and
+     * array elements of direct holders are rewritten by the agent instead of by reflection.
+     * Ignored in the other modes, and falls back to the Java patcher if unsupported.
+     * @param nativePatching true to patch natively, false (default) for the Java patcher only
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setNativePatching(boolean nativePatching) {
+        this.nativePatching = nativePatching;
+        return this;
+    }
+
+    /**
+     * @return true if native slot patching is enabled for the REFERRERS second pass
+     */
+    public boolean isNativePatching() {
+        return nativePatching;
+    }
+
+    /**
+     * Cap the one-pass referrer-chain walk of the REFERRERS second pass. That walk records every
+     * reference into an instance of a climbed class anywhere on the heap (8 bytes of native
+     * memory each), so its cost grows with the heap rather than with the chains. A walk that
+     * would record more references stops, and the climb takes one referrer walk per level instead.
+     * @param referrerChainLimit the most references to record, or 0 to always climb per level
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setReferrerChainLimit(long referrerChainLimit) {
+        if (referrerChainLimit < 0) throw new IllegalArgumentException("referrerChainLimit must not be negative");
+        this.referrerChainLimit = referrerChainLimit;
+        return this;
+    }
+
+    /**
+     * @return the most references the one-pass referrer-chain walk records (0 = per-level climb only)
+     */
+    public long getReferrerChainLimit() {
+        return referrerChainLimit;
+    }
+
+    /**
+     * Choose whether the reference patcher prunes its traversal by the plan's source classes (the
+     * default): a field whose declared type, or an object whose class, can never lead to a source
+     * instance is not traversed. Fields typed {@code Object}, interfaces, non-final classes and JDK
+     * containers are always followed (see {@link ReflectionReferencePatcher#setMigratedTypes}).
+     * @param typePruning true to prune by the source classes, false to traverse everything
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setTypePruning(boolean typePruning) {
+        if (referencePatcher instanceof ReflectionReferencePatcher reflective) {
+            reflective.setMigratedTypes(typePruning ? sourceClasses() : null);
+        }
+        return this;
+    }
+
+    /**
+     * @return true if the reference patcher prunes its traversal by the source classes
+     */
+    public boolean isTypePruning() {
+        return referencePatcher instanceof ReflectionReferencePatcher reflective
+                && !reflective.getMigratedTypes().isEmpty();
+    }
+
+    /**
+     * Switch the forwarding table to its read-optimized form once the straggler rescan has put the
+     * last mapping, so the patch passes probe an array of keys alone. The switch copies the table
+     * once, in the critical phase.
+     * @param freezeForwarding true to freeze the table for the patch passes, false (default) to keep it as built
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setFreezeForwarding(boolean freezeForwarding) {
+        this.freezeForwarding = freezeForwarding;
+        return this;
+    }
+
+    /**
+     * @return true if the forwarding table is frozen for the patch passes
+     */
+    public boolean isFreezeForwarding() {
+        return freezeForwarding;
+    }
+
+    /**
+     * Choose where the patch of a FULL, SPEC or REACHABLE second-pass walk keeps its visited set:
+     * an identity set on the Java heap, JVMTI tags in the agent, or a bitmap keyed by the dense
+     * index of a streamed walk (see {@link VisitedTracking}). The last two keep a large walk's
+     * visited set out of the Java heap, so it causes no GC in the critical phase.
+     * @param visitedTracking the tracking, or null for AUTO (default)
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setVisitedTracking(VisitedTracking visitedTracking) {
+        this.visitedTracking = visitedTracking != null ? visitedTracking : VisitedTracking.AUTO;
+        return this;
+    }
+
+    /**
+     * @return where the second-pass patch keeps its visited set
+     */
+    public VisitedTracking getVisitedTracking() {
+        return visitedTracking;
+    }
+
+    /**
+     * Set how many threads patch the objects of a FULL, SPEC or REACHABLE second-pass walk. With
+     * more than one, the batch is traversed by a work-stealing pool sharing one visited set (see
+     * {@link ParallelReferencePatcher}); REFERRERS patching and static fields stay sequential.
+     * @param patchParallelism worker threads, 1 (default) to patch on the migrating thread, or 0 for
+     *                         one per available processor
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setPatchParallelism(int patchParallelism) {
+        if (patchParallelism < 0) throw new IllegalArgumentException("patchParallelism must not be negative");
+        this.patchParallelism = patchParallelism;
+        return this;
+    }
+
+    /**
+     * @return the configured second-pass patch parallelism (1 = sequential, 0 = one per processor)
+     */
+    public int getPatchParallelism() {
+        return patchParallelism;
+    }
+
+    /**
+     * Set the chunk size of the FULL, REACHABLE and SPEC second-pass heap walks. Each chunk is
+     * patched while the next one is resolved, bounding the walk's result and JNI references by the
+     * chunk size; the patch's visited set stays bounded only with INDEX (or AUTO) visited tracking.
+     * Each chunk is resolved by its own scan of the tag map, so small chunks on a large heap cost
+     * time. {@link MigrationConfig#AUTO_WALK_CHUNK_SIZE} (the default) streams FULL walks in
+     * chunks derived from the walk's size, a few scans per walk, and resolves the others whole.
+     * @param walkChunkSize objects per chunk, 0 to resolve every walk as one set, or -1 (auto)
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setWalkChunkSize(int walkChunkSize) {
+        if (walkChunkSize < MigrationConfig.AUTO_WALK_CHUNK_SIZE) {
+            throw new IllegalArgumentException("walkChunkSize must be -1 (auto) or more");
+        }
+        this.walkChunkSize = walkChunkSize;
+        return this;
+    }
+
+    /**
+     * @return the chunk size of the second-pass heap walks (0 = not chunked, -1 = auto)
+     */
+    public int getWalkChunkSize() {
+        return walkChunkSize;
+    }
+
+    /**
+     * Count the source classes' instances (one heap pass, no objects resolved) before each
+     * migration, record the result in the metrics and, when a maximum heap size is configured,
+     * refuse a migration whose projected heap exceeds it.
+     * @param heapCensus true to take the census, false (default) to skip it
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setHeapCensus(boolean heapCensus) {
+        this.heapCensus = heapCensus;
+        return this;
+    }
+
+    /**
+     * @return true if the source classes are counted before each migration
+     */
+    public boolean isHeapCensus() {
+        return heapCensus;
+    }
+
+    /**
+     * In SPEC mode, find the classes that hold references to source instances before the second
+     * pass (one heap pass under quiescence that resolves no objects) and walk them along with the
+     * classes to scan; the classes whose static fields hold one have their static fields patched.
+     * Classes missing from {@code classesToScan} are then no longer left unpatched. Other modes
+     * ignore the setting.
+     * @param discoverHolders true to discover the holder classes, false (default) to walk only the
+     *                        classes to scan and the classes of the migrated objects
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setDiscoverHolders(boolean discoverHolders) {
+        this.discoverHolders = discoverHolders;
+        return this;
+    }
+
+    /**
+     * @return true if SPEC walks also visit the classes found holding source instances
+     */
+    public boolean isDiscoverHolders() {
+        return discoverHolders;
+    }
+
+    /**
+     * Skip reference-free leaves in FULL and REACHABLE heap walks: primitive arrays and instances of exactly the
+     * {@linkplain #setLeafClasses leaf classes}. A leaf must never hold a reference to a migrated
+     * object, or that reference is left unpatched.
+     * @param skipLeaves true (default) to skip leaves, false to walk every object
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setSkipLeaves(boolean skipLeaves) {
+        this.skipLeaves = skipLeaves;
+        return this;
+    }
+
+    /**
+     * @return true if FULL and REACHABLE heap walks skip reference-free leaves
+     */
+    public boolean isSkipLeaves() {
+        return skipLeaves;
+    }
+
+    /**
+     * Set the reference-free classes FULL and REACHABLE heap walks skip, besides primitive arrays. Defaults to
+     * {@code String} and the boxed primitives.
+     * @param leafClasses the leaf classes (null means none)
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setLeafClasses(Collection<Class<?>> leafClasses) {
+        Set<Class<?>> leaves = new LinkedHashSet<>();
+        if (leafClasses != null) leafClasses.stream().filter(Objects::nonNull).forEach(leaves::add);
+        this.leafClasses = Collections.unmodifiableSet(leaves);
+        return this;
+    }
+
+    /**
+     * @return the reference-free classes FULL and REACHABLE heap walks skip, besides primitive arrays
+     */
+    public Set<Class<?>> getLeafClasses() {
+        return leafClasses;
+    }
+
+    /**
+     * After the critical phase, look for the old objects that are still reachable and report them
+     * in the metrics, logging the shortest root path of a sample. Report-only: residuals never
+     * fail the migration, and a heap walker without support skips the check.
+     * @param verifyResiduals true to verify, false (default) to skip it
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setVerifyResiduals(boolean verifyResiduals) {
+        this.verifyResiduals = verifyResiduals;
+        return this;
+    }
+
+    /**
+     * @return true if residual references are looked for after the critical phase
+     */
+    public boolean isVerifyResiduals() {
+        return verifyResiduals;
+    }
+
+    /**
+     * Set how many residual objects the verification reports a root path for.
+     * @param residualPathSamples the number of paths (0 reports counts only)
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setResidualPathSamples(int residualPathSamples) {
+        if (residualPathSamples < 0) throw new IllegalArgumentException("residualPathSamples must not be negative");
+        this.residualPathSamples = residualPathSamples;
+        return this;
+    }
+
+    /**
+     * @return the number of residual objects the verification reports a root path for
+     */
+    public int getResidualPathSamples() {
+        return residualPathSamples;
+    }
+
+    /**
+     * After commit, count how many of the migrated old objects the garbage collector frees, and
+     * when, without keeping them alive. The progress is read live through
+     * {@link MigrationState#getReclamation()} until the next tracked migration replaces it; an old
+     * generation that is never reclaimed points at a leak. A heap walker without support skips it.
+     * @param trackReclamation true to track, false (default) to skip it
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setTrackReclamation(boolean trackReclamation) {
+        this.trackReclamation = trackReclamation;
+        return this;
+    }
+
+    /**
+     * @return true if the frees of the old objects are counted after commit
+     */
+    public boolean isTrackReclamation() {
+        return trackReclamation;
+    }
+
+    /**
+     * Quiesce the application by suspending its threads natively for the critical phase: every
+     * live platform thread except the migrating thread, the migrator's own threads, JDK threads
+     * and the allowlisted ones is suspended after {@code onBeforeCriticalPhase} and resumed after
+     * the registry update (or on failure). A suspended thread holding a lock the migration needs
+     * would deadlock it, so with a critical-phase timeout set, a watchdog resumes the threads once
+     * the pause exceeds it.
+     * @param quiesceBySuspension true to suspend, false (default) to rely on the phase listener
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setQuiesceBySuspension(boolean quiesceBySuspension) {
+        this.quiesceBySuspension = quiesceBySuspension;
+        return this;
+    }
+
+    /**
+     * @return true if the engine suspends the application threads for the critical phase
+     */
+    public boolean isQuiesceBySuspension() {
+        return quiesceBySuspension;
+    }
+
+    /**
+     * Set the threads a suspension leaves running.
+     * @param suspendAllowlist thread names, or name prefixes ending with {@code '*'}
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setSuspendAllowlist(Collection<String> suspendAllowlist) {
+        this.suspendAllowlist = suspendAllowlist != null ? List.copyOf(suspendAllowlist) : List.of();
+        return this;
+    }
+
+    /**
+     * @return the names (or prefixes ending with {@code '*'}) of the threads a suspension leaves running
+     */
+    public List<String> getSuspendAllowlist() {
+        return suspendAllowlist;
+    }
+
+    /**
+     * Rewrite, after the second pass, the local variables of the suspended application threads
+     * that reference old objects, so a thread frozen mid-request continues with the new objects.
+     * Requires quiescing by suspension, and an agent loaded with {@code -agentpath:<lib>=stacklocals};
+     * otherwise it is skipped with a warning. Locals that cannot be rewritten are logged.
+     * @param patchStackLocals true to patch, false (default) to skip it
+     * @return this engine for method chaining
+     */
+    public MigrationEngine setPatchStackLocals(boolean patchStackLocals) {
+        this.patchStackLocals = patchStackLocals;
+        return this;
+    }
+
+    /**
+     * @return true if the locals of the suspended threads are patched
+     */
+    public boolean isPatchStackLocals() {
+        return patchStackLocals;
+    }
+
     /**
      * Apply migration configuration.
      */
     public MigrationEngine applyConfig(MigrationConfig config) {
         if (config == null) return this;
 
-        this.fullHeapWalk = config.isFullHeapWalk();
+        this.heapWalkMode = config.heapWalkMode();
+        setHeapWalkerBackend(config.heapWalkerBackend());
+        this.nativePatching = config.isNativePatching();
+        this.referrerChainLimit = config.referrerChainLimit();
+        setTypePruning(config.isTypePruning());
+        this.patchParallelism = config.patchParallelism();
+        this.freezeForwarding = config.isFreezeForwarding();
+        this.visitedTracking = config.visitedTracking();
+        this.walkChunkSize = config.walkChunkSize();
+        this.skipLeaves = config.isSkipLeaves();
+        this.leafClasses = resolveLeafClasses(config.leafClasses());
+        this.heapCensus = config.isHeapCensus();
+        this.discoverHolders = config.isDiscoverHolders();
+        this.maxHeapSizeMb = config.maxHeapSizeMb();
+        this.verifyResiduals = config.isVerifyResiduals();
+        this.residualPathSamples = config.residualPathSamples();
+        this.trackReclamation = config.isTrackReclamation();
+        this.quiesceBySuspension = config.isQuiesceBySuspension();
+        this.suspendAllowlist = config.suspendAllowlist();
+        this.patchStackLocals = config.isPatchStackLocals();
         this.timeoutConfig = MigrationTimeoutConfig.builder()
                 .heapWalkTimeout(config.heapWalkTimeout())
                 .heapSnapshotTimeout(config.heapSnapshotTimeout())
@@ -158,6 +660,24 @@ public final class MigrationEngine {
         return this;
     }
 
+    /**
+     * Loads the named leaf classes without initializing them; names that cannot be loaded are
+     * logged and ignored.
+     */
+    private static Set<Class<?>> resolveLeafClasses(Collection<String> names) {
+        Set<Class<?>> leaves = new LinkedHashSet<>();
+        ClassLoader loader = Thread.currentThread().getContextClassLoader();
+        if (loader == null) loader = MigrationEngine.class.getClassLoader();
+        for (String name : names) {
+            try {
+                leaves.add(Class.forName(name, false, loader));
+            } catch (ClassNotFoundException | LinkageError e) {
+                log.warn("Ignoring unknown leaf class {}: {}", name, e.toString());
+            }
+        }
+        return Collections.unmodifiableSet(leaves);
+    }
+
     /**
      * Load configuration from the default classpath resource and apply it.
      *
@@ -172,6 +692,20 @@ public final class MigrationEngine {
      * Validate heap size is within configured limits.
      */
     public static void validateHeapSize(MigrationConfig config) throws MigrateException {
+        validateHeapSize(config, null);
+    }
+
+    /**
+     * Validate heap size is within configured limits, counting the migration's projected heap.
+     *
+     * <p>With a census of the source classes, the maximum applies to the used heap plus the
+     * census's shallow bytes: the first pass allocates roughly one new object per source instance,
+     * and both coexist until commit.
+     *
+     * @param config the limits (null skips validation)
+     * @param census the census of the source classes, or null to check the current heap only
+     */
+    public static void validateHeapSize(MigrationConfig config, HeapCensus census) throws MigrateException {
         if (config == null) return;
 
         long MB = 1024 * 1024;
@@ -188,13 +722,31 @@ public final class MigrationEngine {
             throw new MigrateException(
                     "Used heap " + usedMb + " MB exceeds max " + config.maxHeapSizeMb() + " MB");
         }
+
+        checkProjectedHeap(config.maxHeapSizeMb(), census);
+    }
+
+    /** Fails when the used heap plus the census's shallow bytes exceeds {@code maxHeapSizeMb} (0 = no limit). */
+    private static void checkProjectedHeap(long maxHeapSizeMb, HeapCensus census) throws MigrateException {
+        if (maxHeapSizeMb <= 0 || census == null) return;
+
+        long MB = 1024 * 1024;
+        Runtime rt = Runtime.getRuntime();
+        long usedMb = (rt.totalMemory() - rt.freeMemory()) / MB;
+        long projectedMb = usedMb + (census.totalShallowBytes() + MB - 1) / MB;
+
+        if (projectedMb > maxHeapSizeMb) {
+            throw new MigrateException(
+                    "Migrating " + census.totalCount() + " source instances would take the heap from "
+                            + usedMb + " MB to ~" + projectedMb + " MB, above max " + maxHeapSizeMb + " MB");
+        }
     }
 
     /**
      * @return true if full heap walk is enabled, false for filtered heap walk
      */
     public boolean isFullHeapWalk() {
-        return fullHeapWalk;
+        return heapWalkMode == HeapWalkMode.FULL;
     }
 
     /**
@@ -245,6 +797,26 @@ public final class MigrationEngine {
         return lastMetrics;
     }
 
+    /**
+     * Write the reference graph of the reachable heap to a file, with this engine's source classes
+     * flagged, for planning the migration offline with {@link HeapGraph}. Migrates nothing and
+     * changes nothing; the walk stops the application at a safepoint for its duration, under the
+     * heap-walk timeout.
+     *
+     * @param file            the file to create or replace
+     * @param sourceEdgesOnly true to write only the references into source-class instances
+     * @return what was written
+     * @throws MigrateException if the walk or the write fails, or the heap walker cannot export
+     */
+    public HeapGraphExport exportReferenceGraph(Path file, boolean sourceEdgesOnly) throws MigrateException {
+        List<Class<?>> sources = sourceClasses();
+        HeapGraphExport export = walkWithTimeout("exportReferenceGraph", timeoutConfig.heapWalkTimeout(),
+                () -> heapWalker.exportReferenceGraph(file, sources, sourceEdgesOnly));
+        log.info("Exported reference graph to {}: {} classes, {} objects, {} references, {} bytes",
+                export.file(), export.classes(), export.objects(), export.references(), export.bytes());
+        return export;
+    }
+
     /**
      * Convenience method to set all timeouts to the same value.
      *
@@ -429,8 +1001,10 @@ public final class MigrationEngine {
         }
 
         heapWalker = new NativeHeapWalker();
+        threadSuspender = new NativeThreadSuspender();
         forwarding = new ForwardingTable();
         referencePatcher = new ReflectionReferencePatcher(forwarding);
+        setTypePruning(true);
         registryUpdater = new RegistryUpdater(forwarding, referencePatcher);
         this.phaseListener = phaseListener == null ? NoopPhaseListener.INSTANCE : phaseListener;
         this.smokeRunner = Objects.requireNonNull(smokeRunner, "smokeRunner");
@@ -442,7 +1016,36 @@ public final class MigrationEngine {
      * Run migration with generic container updates. classesToScan are typically target classes and are used by RegistryUpdater.
      */
     public void migrate(Collection<Class<?>> classesToScan, Collection<?> genericContainers, Class<?> interfaceType) throws MigrateException {
-        doMigrate(classesToScan, genericContainers, interfaceType);
+        doMigrate(null, classesToScan, genericContainers, interfaceType);
+    }
+
+    /**
+     * Run a migration scoped to the objects reachable from {@code roots}: only the source instances
+     * in that subgraph are migrated, and only the objects in it are walked and patched, so the cost
+     * follows the subgraph instead of the heap. Meant for state partitioned under root objects,
+     * such as one tenant's state under its tenant object, migrated one root at a time.
+     *
+     * <p>The subgraph is what the roots' instance fields and array elements lead to, transitively
+     * (see {@link HeapWalker#snapshotReachableFrom}). References into it from outside, e.g. a
+     * shared cache or a static field, are not patched unless they are in {@code classesToScan}'s
+     * static fields or the registries: a source instance reachable that way keeps its old
+     * references. {@linkplain #setVerifyResiduals Residual verification} reports them. A root that
+     * is itself a source instance is migrated, but the caller's reference to it is not patched.
+     * The heap census and holder-class discovery are heap-wide and are skipped; the heap walk
+     * mode does not apply.
+     *
+     * @param roots             the objects to migrate below (at least one non-null)
+     * @param classesToScan     classes to scan for registry updates and static fields
+     * @param genericContainers optional containers to update
+     * @param interfaceType     optional interface type for generic containers
+     * @throws MigrateException if the migration fails, or the walker does not support root-scoped walks
+     */
+    public void migrateReachableFrom(Collection<?> roots, Collection<Class<?>> classesToScan,
+                                     Collection<?> genericContainers, Class<?> interfaceType) throws MigrateException {
+        Objects.requireNonNull(roots, "roots");
+        Object[] scope = roots.stream().filter(Objects::nonNull).toArray();
+        if (scope.length == 0) throw new IllegalArgumentException("roots must contain at least one object");
+        doMigrate(scope, classesToScan, genericContainers, interfaceType);
     }
 
     /**
@@ -467,7 +1070,7 @@ public final class MigrationEngine {
             TimeoutExecutor.executeWithTimeoutChecked(
                     "migration",
                     timeout,
-                    () -> doMigrate(classesToScan, genericContainers, interfaceType)
+                    () -> doMigrate(null, classesToScan, genericContainers, interfaceType)
             );
         } catch (MigrationTimeoutException e) {
             // The overall migration exceeded the timeout. doMigrate runs on a worker thread, which
@@ -500,11 +1103,21 @@ public final class MigrationEngine {
         }
     }
 
-    private void doMigrate(Collection<Class<?>> classesToScan, Collection<?> genericContainers, Class<?> interfaceType) throws MigrateException {
+    private void doMigrate(Object[] roots, Collection<Class<?>> classesToScan, Collection<?> genericContainers,
+                           Class<?> interfaceType) throws MigrateException {
         // Empty plan is a no-op: check it before requiring classesToScan so an empty plan never
         // throws on a null scan list it would not have used.
         if (plan.orderedMigrators().isEmpty()) return;
         Objects.requireNonNull(classesToScan, "classesToScan");
+        scopeRoots = roots;
+        try {
+            doMigrate(classesToScan, genericContainers, interfaceType);
+        } finally {
+            scopeRoots = null;
+        }
+    }
+
+    private void doMigrate(Collection<Class<?>> classesToScan, Collection<?> genericContainers, Class<?> interfaceType) throws MigrateException {
 
         final long migrationId = MIGRATION_COUNTER.getAndIncrement();
         rollbackInvoked.set(false);
@@ -518,7 +1131,9 @@ public final class MigrationEngine {
         MigrationState.getInstance().migrationStarted(migrationId);
         MigrationAlertLogger.migrationStarted(migrationId);
 
-        metricsCollector.start(migrationId).migratorCount(plan.orderedMigrators().size());
+        metricsCollector.start(migrationId)
+                .migratorCount(plan.orderedMigrators().size())
+                .heapOpTimes(heapWalker::opTimes);
         // Tracks whether the app may have been quiesced by onBeforeCriticalPhase but not yet
         // resumed by onAfterCriticalPhase. A one-element array so the critical-phase lambda can
         // mutate it; the finally block uses it as a safety net to guarantee the app is resumed.
@@ -526,19 +1141,27 @@ public final class MigrationEngine {
         // resume) and cleared BEFORE onAfter is attempted (so a failing onAfter is not retried by
         // the finally — see onAfterCriticalPhase's at-least-once/idempotency contract).
         final boolean[] beforeCriticalCalled = {false};
+        // The engine-managed pause, when quiescing by suspension; resumed at most once (after the
+        // registry update, by the failure paths, or by its watchdog).
+        final Quiescence[] quiescence = {null};
 
         // Set once this thread wins the finalization CAS (claims the commit). It lets the catch
         // blocks know a post-commit failure is still ours to record, without re-winning the CAS.
         boolean ownsOutcome = false;
 
         try {
+            // Admission: size the migration before anything is allocated for it.
+            long censused = censusSourceClasses();
+
             // FIRST PASS
             MigrationState.getInstance().setCurrentPhase(Phase.FIRST_PASS);
             MigrationAlertLogger.phaseStarted(migrationId, Phase.FIRST_PASS);
             long phaseStart = System.currentTimeMillis();
-            metricsCollector.timed(Phase.FIRST_PASS, () ->
+            long snapshotted = metricsCollector.timed(Phase.FIRST_PASS, () ->
                     firstPassAllocateAndMigrate(allResolvedOldObjects, createdPerMigrator));
-            MigrationAlertLogger.phaseCompleted(migrationId, Phase.FIRST_PASS, System.currentTimeMillis() - phaseStart);
+            MigrationAlertLogger.phaseCompleted(migrationId, Phase.FIRST_PASS, System.currentTimeMillis() - phaseStart,
+                    metricsCollector.heapOps(Phase.FIRST_PASS));
+            recordUnreachableSkipped(censused, snapshotted);
 
             // CRITICAL PHASE
             MigrationState.getInstance().setCurrentPhase(Phase.CRITICAL_PHASE);
@@ -549,6 +1172,9 @@ public final class MigrationEngine {
                 // partial quiesce is resumed by the finally block.
                 beforeCriticalCalled[0] = true;
                 signalBeforeCriticalPhase(ctx);
+                if (quiesceBySuspension) {
+                    quiescence[0] = suspendApplicationThreads();
+                }
 
                 // Straggler rescan under quiescence. The first-pass snapshot ran *before* the
                 // application was quiesced, so new instances of a source class may have been created
@@ -566,15 +1192,27 @@ public final class MigrationEngine {
                 Set<Object> pass2Objects = new LinkedHashSet<>(allResolvedOldObjects);
                 createdPerMigrator.values().forEach(pass2Objects::addAll);
 
+                // No more puts until the migration ends: switch to the read-optimized form.
+                if (freezeForwarding) {
+                    forwarding.freeze();
+                }
+
                 // Compute the set of classes that may hold references to migrated objects once,
                 // then reuse it for both the filtered heap walk and static-field patching.
-                Set<Class<?>> classesToPatch = collectClassesToPatch(classesToScan, pass2Objects);
+                HolderClasses holders = discoverHolderClasses();
+                Set<Class<?>> classesToPatch = collectClassesToPatch(classesToScan, pass2Objects,
+                        holders.instanceHolders());
 
                 // SECOND PASS
                 metricsCollector.timed(Phase.SECOND_PASS, () ->
                         patchedCount[0] = secondPassPatchReferencesWithCount(pass2Objects, classesToPatch));
 
-                safeAutoPatchStaticFields(classesToPatch);
+                safeAutoPatchStaticFields(withStaticOwners(classesToPatch, holders));
+
+                // STACK LOCALS: only frozen threads can have their frames rewritten
+                if (patchStackLocals) {
+                    metricsCollector.timed(Phase.STACK_LOCALS, () -> patchSuspendedStackLocals(quiescence[0], allResolvedOldObjects));
+                }
 
                 // REGISTRY UPDATE
                 metricsCollector.timed(Phase.REGISTRY_UPDATE, () -> {
@@ -583,22 +1221,36 @@ public final class MigrationEngine {
                     updateGenericFields(classesToScan, pass2Objects, interfaceType);
                 });
 
+                resumeApplicationThreads(quiescence[0]);
+
                 // Clear before attempting onAfter: it runs exactly once here on the normal path; if
                 // it throws, the finally must not invoke it again.
                 beforeCriticalCalled[0] = false;
                 signalAfterCriticalPhase(ctx);
             });
-            MigrationAlertLogger.phaseCompleted(migrationId, Phase.CRITICAL_PHASE, System.currentTimeMillis() - criticalPhaseStart);
+            MigrationAlertLogger.phaseCompleted(migrationId, Phase.CRITICAL_PHASE, System.currentTimeMillis() - criticalPhaseStart,
+                    metricsCollector.heapOps(Phase.CRITICAL_PHASE));
 
             metricsCollector.objectsPatched(patchedCount[0]);
 
+            // VERIFY
+            if (verifyResiduals) {
+                MigrationState.getInstance().setCurrentPhase(Phase.VERIFY);
+                MigrationAlertLogger.phaseStarted(migrationId, Phase.VERIFY);
+                long verifyStart = System.currentTimeMillis();
+                metricsCollector.timed(Phase.VERIFY, () -> verifyResidualReferences(allResolvedOldObjects, createdPerMigrator));
+                MigrationAlertLogger.phaseCompleted(migrationId, Phase.VERIFY, System.currentTimeMillis() - verifyStart,
+                        metricsCollector.heapOps(Phase.VERIFY));
+            }
+
             // SMOKE TESTS
             MigrationState.getInstance().setCurrentPhase(Phase.SMOKE_TEST);
             MigrationAlertLogger.phaseStarted(migrationId, Phase.SMOKE_TEST);
             long smokeTestStart = System.currentTimeMillis();
             SmokeTestReport report = metricsCollector.timed(Phase.SMOKE_TEST,
                     () -> runSmokeTestsWithTimeout(createdPerMigrator));
-            MigrationAlertLogger.phaseCompleted(migrationId, Phase.SMOKE_TEST, System.currentTimeMillis() - smokeTestStart);
+            MigrationAlertLogger.phaseCompleted(migrationId, Phase.SMOKE_TEST, System.currentTimeMillis() - smokeTestStart,
+                    metricsCollector.heapOps(Phase.SMOKE_TEST));
 
             if (!report.success()) {
                 log.error("Smoke tests failed for migration id={}", migrationId);
@@ -626,6 +1278,9 @@ public final class MigrationEngine {
             ownsOutcome = true;
             commitWithRollback();
             migratorAdvanceEpoch();
+            if (trackReclamation) {
+                startReclamationTracking(migrationId, allResolvedOldObjects);
+            }
 
             lastMetrics = metricsCollector.finish();
             log.info("Migration metrics: {}", lastMetrics.summary());
@@ -636,6 +1291,7 @@ public final class MigrationEngine {
             MigrationAlertLogger.migrationCompleted(migrationId, lastMetrics);
 
         } catch (MigrateException me) {
+            resumeApplicationThreads(quiescence[0]);
             // Record the failure if we own the outcome — either we already claimed it (a post-commit
             // failure) or we win the CAS now. If the timeout path already finalized (and recorded /
             // rolled back), don't double-record or fight it; just propagate.
@@ -646,6 +1302,7 @@ public final class MigrationEngine {
             }
             throw me;
         } catch (Exception e) {
+            resumeApplicationThreads(quiescence[0]);
             if (ownsOutcome || finalized.compareAndSet(false, true)) {
                 finishMetricsOnError();
                 MigrationState.getInstance().migrationFailed(migrationId, e, lastMetrics);
@@ -653,6 +1310,8 @@ public final class MigrationEngine {
             }
             cleanupAndRollback(allResolvedOldObjects, e);
         } finally {
+            // Safety net for Errors, which the catch blocks above do not see.
+            resumeApplicationThreads(quiescence[0]);
             if (beforeCriticalCalled[0]) {
                 safeAfterCriticalPhase(ctx, migrationId);
             }
@@ -741,21 +1400,242 @@ public final class MigrationEngine {
         return interfaceTypes;
     }
 
-    /** First pass: runs each migrator in plan order to allocate new objects and populate the forwarding table. */
-    private void firstPassAllocateAndMigrate(
+    /**
+     * First pass: snapshots every migrator's source class in one heap walk, then runs each migrator
+     * in plan order to allocate new objects and populate the forwarding table. In REACHABLE mode
+     * the snapshot holds only the instances reachable from the heap roots, so uncollected garbage
+     * is never migrated; in a root-scoped migration, only those reachable from its roots.
+     *
+     * <p>One snapshot up front sees the same instances as a snapshot per migrator: the plan runs
+     * dependencies first (for A&rarr;B, B&rarr;C the B migrator runs before A), so no migrator's
+     * source instances are created by a migrator that runs earlier in the same pass.
+     *
+     * @return the number of source instances in the snapshot
+     */
+    private long firstPassAllocateAndMigrate(
         Set<Object> allResolvedOldObjects,
         Map<MigratorDescriptor, List<Object>> createdPerMigrator
     ) throws MigrateException {
-        for (MigratorDescriptor desc : plan.orderedMigrators()) {
-            processMigrator(desc, allResolvedOldObjects, createdPerMigrator);
+        List<MigratorDescriptor> migrators = plan.orderedMigrators();
+        List<Class<?>> sources = sourceClasses();
+
+        Object[] roots = scopeRoots;
+        boolean reachable = heapWalkMode == HeapWalkMode.REACHABLE;
+        Map<Class<?>, Object[]> snapshot;
+        if (roots != null) {
+            snapshot = walkWithTimeout(
+                    "heapSnapshotFrom(" + roots.length + " roots, " + sources.size() + " classes)",
+                    timeoutConfig.heapSnapshotTimeout(),
+                    () -> heapWalker.snapshotReachableFrom(Arrays.asList(roots), sources)
+            );
+        } else {
+            snapshot = walkWithTimeout(
+                    (reachable ? "heapSnapshotReachable(" : "heapSnapshot(") + sources.size() + " classes)",
+                    timeoutConfig.heapSnapshotTimeout(),
+                    () -> reachable ? heapWalker.snapshotReachable(sources) : heapWalker.snapshotPartitioned(sources)
+            );
+        }
+
+        long snapshotted = 0;
+        if (snapshot != null) {
+            for (Object[] found : snapshot.values()) {
+                if (found != null) snapshotted += found.length;
+            }
+        }
+        // Size the forwarding table once from the snapshot, so it never resizes while the
+        // migrators run.
+        forwarding.ensureCapacity((int) Math.min(Integer.MAX_VALUE, forwarding.size() + snapshotted));
+        for (MigratorDescriptor desc : migrators) {
+            Object[] found = snapshot != null ? snapshot.get(desc.from()) : null;
+            processMigrator(desc, found, allResolvedOldObjects, createdPerMigrator);
+        }
+        return snapshotted;
+    }
+
+    /**
+     * In REACHABLE mode with a census taken, records how many source instances the census counted
+     * but the reachable first-pass snapshot left out: garbage a heap snapshot would have migrated.
+     * Instances created between the census and the snapshot make this an underestimate.
+     */
+    private void recordUnreachableSkipped(long censused, long snapshotted) {
+        if (heapWalkMode != HeapWalkMode.REACHABLE || censused == MigrationMetrics.NO_CENSUS) return;
+        long skipped = Math.max(0, censused - snapshotted);
+        metricsCollector.unreachableSkipped(skipped);
+        log.info("Reachable snapshot left out {} unreachable source instance(s) of {} counted by the census",
+                skipped, censused);
+    }
+
+    /**
+     * Residual-reference verification: one reference walk from the heap roots finds the old
+     * objects still reachable after the critical phase, and the references into them the patch
+     * passes missed. The migration's own bookkeeping (and this thread's stack) reaches every old
+     * object by design and is left out of the walk. Report-only and best effort: a walker without
+     * support, or a failed walk, is logged and skipped.
+     */
+    private void verifyResidualReferences(Set<Object> allResolvedOldObjects,
+                                          Map<MigratorDescriptor, List<Object>> createdPerMigrator) {
+        List<Object> oldObjects = migratedOldObjects(allResolvedOldObjects);
+        if (oldObjects.isEmpty()) return;
+        List<Object> excluded = List.of(oldObjects, allResolvedOldObjects, createdPerMigrator, forwarding,
+                Thread.currentThread());
+
+        ResidualReferences residuals;
+        try {
+            residuals = walkWithTimeout("verifyResiduals", timeoutConfig.heapWalkTimeout(),
+                    () -> heapWalker.findResidualReferences(oldObjects, excluded, residualPathSamples));
+        } catch (MigrateException | RuntimeException e) {
+            log.warn("Residual-reference verification skipped: {}", e.toString());
+            return;
+        }
+
+        metricsCollector.residuals(residuals.residualObjects(), residuals.residualReferences());
+        if (residuals.isClean()) {
+            log.info("Residual-reference verification: none of {} old object(s) is reachable", oldObjects.size());
+            return;
         }
+        log.warn("Residual-reference verification: {} of {} old object(s) still reachable; {}",
+                residuals.residualObjects(), oldObjects.size(), residuals.describe());
+        for (RootPath path : residuals.samplePaths()) {
+            log.warn("  root path{}: {}", residuals.exactPaths() ? "" : " (may not be shortest)", path.describe());
+        }
+    }
+
+    /** The resolved old objects that were actually migrated (have a forwarding entry). */
+    private List<Object> migratedOldObjects(Set<Object> allResolvedOldObjects) {
+        List<Object> oldObjects = new ArrayList<>();
+        for (Object o : allResolvedOldObjects) {
+            if (forwarding.contains(o)) oldObjects.add(o);
+        }
+        return oldObjects;
+    }
+
+    /**
+     * Starts counting the frees of the migrated old objects and publishes the tracker to
+     * {@link MigrationState}, first logging how far the previous tracker got. Runs after commit,
+     * so any failure is logged rather than propagated.
+     */
+    private void startReclamationTracking(long migrationId, Set<Object> allResolvedOldObjects) {
+        try {
+            MigrationState state = MigrationState.getInstance();
+            ReclamationProgress previous = state.getReclamation();
+            if (previous.trackerId() != 0) {
+                if (previous.isComplete()) {
+                    log.info("Old objects of migration id={}: {}", state.getReclamationMigrationId(), previous.describe());
+                } else {
+                    log.warn("Old objects of migration id={} not all reclaimed (possible leak): {}",
+                            state.getReclamationMigrationId(), previous.describe());
+                }
+            }
+            List<Object> oldObjects = migratedOldObjects(allResolvedOldObjects);
+            if (oldObjects.isEmpty() || !heapWalker.startReclamationTracking(oldObjects)) {
+                log.debug("Reclamation tracking not started for migration id={}", migrationId);
+                return;
+            }
+            HeapWalker walker = heapWalker;
+            state.reclamationStarted(migrationId, walker::reclamationProgress);
+            log.info("Tracking the reclamation of {} old object(s) of migration id={}", oldObjects.size(), migrationId);
+        } catch (Throwable t) {
+            // Best-effort, after commit: an UnsatisfiedLinkError (agent not loaded) must not fail
+            // an already-committed migration either.
+            log.warn("Failed to start reclamation tracking (migration already committed): {}", t.toString());
+        }
+    }
+
+    /**
+     * Runs a heap walk under its timeout, publishing its progress to {@link MigrationState} and
+     * cancelling it natively if it times out (see {@link TimeoutExecutor#executeWalkWithTimeout}).
+     */
+    private <T> T walkWithTimeout(String operation, Duration timeout, Callable<T> walk) throws MigrateException {
+        try {
+            return TimeoutExecutor.executeWalkWithTimeout(operation, timeout, heapWalker, walk);
+        } catch (MigrateException | RuntimeException e) {
+            throw e;
+        } catch (Exception e) {
+            throw new MigrateException(operation + " failed: " + e.getMessage(), e);
+        }
+    }
+
+    /** @return each migrator's source class, in plan order */
+    private List<Class<?>> sourceClasses() {
+        List<MigratorDescriptor> migrators = plan.orderedMigrators();
+        List<Class<?>> sources = new ArrayList<>(migrators.size());
+        for (MigratorDescriptor desc : migrators) sources.add(desc.from());
+        return sources;
+    }
+
+    /**
+     * Counts the source classes' instances in one heap pass that resolves nothing, before the first
+     * pass allocates any new object. The result goes to the metrics and, with a heap limit set, is
+     * checked as the projected extra heap of the migration. Best effort: a walker without census
+     * support, or a failed census, skips both.
+     *
+     * @return the number of source instances counted, or {@link MigrationMetrics#NO_CENSUS}
+     */
+    private long censusSourceClasses() throws MigrateException {
+        if (!heapCensus || scopeRoots != null) return MigrationMetrics.NO_CENSUS;
+        List<Class<?>> sources = sourceClasses();
+        HeapCensus census;
+        try {
+            census = walkWithTimeout(
+                    "heapCensus(" + sources.size() + " classes)",
+                    timeoutConfig.heapSnapshotTimeout(),
+                    () -> heapWalker.census(sources)
+            );
+        } catch (Exception e) {
+            log.warn("Heap census skipped: {}", e.toString());
+            return MigrationMetrics.NO_CENSUS;
+        }
+        metricsCollector.sourceCensus(census.totalCount(), census.totalShallowBytes());
+        log.info("Heap census: {} source instances, {} bytes shallow",
+                census.totalCount(), census.totalShallowBytes());
+        checkProjectedHeap(maxHeapSizeMb, census);
+        return census.totalCount();
+    }
+
+    /**
+     * Finds the classes holding references to source instances, for the SPEC walk, in one heap
+     * pass that resolves nothing. A holder the patcher climbs through (a JDK collection node, a
+     * backing array, a record) is replaced by the classes holding it, as the REFERRERS pass
+     * climbs, so a source held in a map of an unlisted class brings in that class. Runs under
+     * quiescence, after the straggler rescan, so no holder appears between the discovery and the
+     * walk. Best effort: a walker without discovery support,
+     * or a failed pass, leaves the walk to the classes to scan and the migrated objects' classes.
+     *
+     * @return the holder classes, or {@link HolderClasses#EMPTY} when discovery is off or skipped
+     */
+    private HolderClasses discoverHolderClasses() {
+        if (!discoverHolders || heapWalkMode != HeapWalkMode.SPEC || scopeRoots != null) return HolderClasses.EMPTY;
+        List<Class<?>> sources = sourceClasses();
+        HolderClasses holders;
+        try {
+            holders = walkWithTimeout(
+                    "findHolderClasses(" + sources.size() + " classes)",
+                    timeoutConfig.heapWalkTimeout(),
+                    () -> heapWalker.findHolderClasses(sources, referencePatcher::isReferrerClimbed, MAX_REFERRER_DEPTH)
+            );
+        } catch (Exception e) {
+            log.warn("Holder-class discovery skipped: {}", e.toString());
+            return HolderClasses.EMPTY;
+        }
+        log.info("Holder-class discovery: {} instance holders, {} static-field owners",
+                holders.instanceHolders().size(), holders.staticOwners().size());
+        return holders;
+    }
+
+    /** @return the classes whose static fields to patch: {@code classesToPatch} plus the discovered static owners */
+    private static Set<Class<?>> withStaticOwners(Set<Class<?>> classesToPatch, HolderClasses holders) {
+        if (holders.staticOwners().isEmpty()) return classesToPatch;
+        Set<Class<?>> classes = new LinkedHashSet<>(classesToPatch);
+        classes.addAll(holders.staticOwners());
+        return classes;
     }
 
     /**
      * Re-runs the migrators under quiescence to catch source-class instances created after the
      * first-pass snapshot but before the application was paused. Because {@link #processMigrator}
      * skips objects already in the forwarding table, this is idempotent for already-migrated objects
-     * and migrates only the stragglers, appending them to {@code createdPerMigrator}.
+     * and migrates only the stragglers, appending them to {@code createdPerMigrator}. Like the first
+     * pass, it costs a single partitioned heap snapshot regardless of the number of migrators.
      */
     private void rescanStragglersUnderQuiescence(
         Set<Object> allResolvedOldObjects,
@@ -769,6 +1649,76 @@ public final class MigrationEngine {
         }
     }
 
+    /**
+     * Suspends the application threads for the critical phase. With a critical-phase timeout set,
+     * a watchdog resumes them once the pause exceeds it.
+     */
+    private Quiescence suspendApplicationThreads() throws MigrateException {
+        List<Thread> threads = ApplicationThreads.select(suspendAllowlist);
+        Quiescence q = Quiescence.begin(threadSuspender, threads, timeoutConfig.criticalPhaseTimeout());
+        log.info("Suspended {} application thread(s) in {} ms", q.suspendedCount(),
+                String.format(Locale.ROOT, "%.2f", HeapOpTimes.millis(q.suspendNanos())));
+        if (q.failedCount() > 0) {
+            log.warn("{} application thread(s) could not be suspended and keep running", q.failedCount());
+        }
+        return q;
+    }
+
+    /**
+     * Resumes the threads {@link #suspendApplicationThreads} suspended, unless already resumed,
+     * and records the pause. Never throws: the failure paths call it too, before rolling back.
+     */
+    private void resumeApplicationThreads(Quiescence q) {
+        if (q == null) return;
+        if (q.resume()) {
+            log.info("Resumed {} application thread(s) in {} ms; paused {} ms", q.suspendedCount(),
+                    String.format(Locale.ROOT, "%.2f", HeapOpTimes.millis(q.resumeNanos())),
+                    String.format(Locale.ROOT, "%.1f", HeapOpTimes.millis(q.pausedNanos())));
+        } else if (!q.isResumedByWatchdog()) {
+            return; // resumed and recorded already
+        }
+        metricsCollector.suspension(new MigrationMetrics.ThreadSuspension(q.suspendedCount(), q.failedCount(),
+                q.suspendNanos(), q.resumeNanos(), q.pausedNanos()));
+    }
+
+    /**
+     * Rewrites the locals of the suspended threads that reference migrated old objects, and logs
+     * the ones that cannot be rewritten. Never fails the migration: a local left unpatched keeps
+     * its old object, as it would without this pass.
+     */
+    private void patchSuspendedStackLocals(Quiescence q, Set<Object> allResolvedOldObjects) {
+        if (q == null || !q.isSuspended()) {
+            log.warn("Stack-local patching skipped: the application threads are not suspended "
+                    + "(enable quiescing by suspension)");
+            return;
+        }
+        List<Object> oldObjects = migratedOldObjects(allResolvedOldObjects);
+        Object[] olds = oldObjects.toArray();
+        Object[] news = new Object[olds.length];
+        for (int i = 0; i < olds.length; i++) {
+            news[i] = forwarding.get(olds[i]);
+        }
+
+        StackLocalPatchResult result;
+        try {
+            result = heapWalker.patchStackLocals(q.threads(), olds, news);
+        } catch (MigrateException e) {
+            log.warn("Stack-local patching unavailable: {}", e.getMessage());
+            return;
+        }
+        metricsCollector.stackLocals(result.localsFound(), result.localsRewritten());
+        log.info("Stack-local patching rewrote {} of {} local(s) in {} suspended thread(s)",
+                result.localsRewritten(), result.localsFound(), q.suspendedCount());
+        if (!result.unpatched().isEmpty()) {
+            log.warn("{} local(s) still reference old objects and were not rewritten:", result.unpatched().size());
+            result.unpatched().forEach(local -> log.warn("  {}", local.describe()));
+        }
+        if (result.otherThreadReferences() > 0) {
+            log.debug("{} stack/JNI-local reference(s) to old objects are held by threads that were not suspended",
+                    result.otherThreadReferences());
+        }
+    }
+
     /** Signals the phase listener to quiesce before the critical phase, under the critical-phase timeout. */
     private void signalBeforeCriticalPhase(MigrationContext ctx) throws MigrateException {
         try {
@@ -786,22 +1736,16 @@ public final class MigrationEngine {
 
 
     /**
-     * Snapshots all live instances of one migrator's source class and migrates each, recording the
-     * old&rarr;new mapping in the forwarding table. Objects already migrated are skipped.
+     * Migrates the given instances of one migrator's source class, recording the old&rarr;new
+     * mapping in the forwarding table. Objects already migrated are skipped.
      */
     private void processMigrator(
             MigratorDescriptor desc,
+            Object[] objects,
             Set<Object> allResolvedOldObjects,
             Map<MigratorDescriptor, List<Object>> createdPerMigrator
     ) throws MigrateException {
-        Class<?> from = desc.from();
         Object migrator = desc.migrator();
-
-        Object[] objects = TimeoutExecutor.executeWithTimeout(
-                "heapSnapshot(" + from.getSimpleName() + ")",
-                timeoutConfig.heapSnapshotTimeout(),
-                () -> heapWalker.snapshotObjects(from)
-        );
         if (objects == null || objects.length == 0) return;
 
         // computeIfAbsent (not put): the straggler rescan re-runs this method under quiescence, and
@@ -828,9 +1772,11 @@ public final class MigrationEngine {
     }
 
     /**
-     * Second pass: walks the heap (full or filtered by {@code classesToPatch}) and patches every
-     * reachable object's references to migrated objects. Falls back to patching only the known
-     * pass-2 objects if the heap walk fails.
+     * Second pass: walks the heap (full, reachable from the roots, or filtered by
+     * {@code classesToPatch}) and patches every walked object's references to migrated objects,
+     * or — in REFERRERS mode — patches only the objects that hold such a reference. With a chunk
+     * size set, FULL, REACHABLE and SPEC walks are streamed, and FULL walks are by default: each chunk is patched while the next
+     * one resolves. Falls back to patching only the known pass-2 objects if the heap walk fails.
      *
      * @return the number of objects patched
      */
@@ -838,19 +1784,48 @@ public final class MigrationEngine {
         Set<Object> objectsToPatch = null;
         int patchedCount = 0;
 
+        WalkVisitedSets visitedSets = WalkVisitedSets.install(referencePatcher, heapWalker, secondPassVisitedTracking());
+        if (visitedSets.tracking() != VisitedTracking.IDENTITY) {
+            log.debug("Second-pass visited sets: {}", visitedSets.tracking());
+        }
         try {
-            if (fullHeapWalk) {
+            if (scopeRoots != null) {
+                return patchReachableFromRoots(pass2Objects);
+            }
+            if (heapWalkMode == HeapWalkMode.REFERRERS) {
+                log.debug("Using referrer walk");
+                ReferrerChains chains = walkWithTimeout(
+                        "heapWalkReferrers",
+                        timeoutConfig.heapWalkTimeout(),
+                        () -> findReferrerChains(pass2Objects)
+                );
+                List<Object> anchors = nativePatching ? patchDirectSlotsNatively(chains) : chains.anchors();
+                referencePatcher.patchReferrers(anchors, chains.scope());
+                return chains.scope().size();
+            }
+            if (streamsSecondPass()) {
+                long streamed = streamHeapWalk(classesToPatch);
+                if (streamed > 0) return (int) Math.min(streamed, Integer.MAX_VALUE);
+            } else if (heapWalkMode == HeapWalkMode.FULL) {
                 // Full heap walk - patch all objects on the heap
                 log.debug("Using full heap walk");
-                objectsToPatch = TimeoutExecutor.executeWithTimeoutChecked(
+                objectsToPatch = walkWithTimeout(
                         "heapWalkFull",
                         timeoutConfig.heapWalkTimeout(),
-                        () -> heapWalker.walkHeap()
+                        () -> skipLeaves ? heapWalker.walkHeapSkippingLeaves(leafClasses) : heapWalker.walkHeap()
+                );
+            } else if (heapWalkMode == HeapWalkMode.REACHABLE) {
+                // Reachable walk - patch every object reachable from the heap roots
+                log.debug("Using reachable heap walk");
+                objectsToPatch = walkWithTimeout(
+                        "heapWalkReachable",
+                        timeoutConfig.heapWalkTimeout(),
+                        () -> heapWalker.walkReachable(skipLeaves ? leafClasses : null)
                 );
             } else {
                 // Filtered heap walk - only walk objects of specified classes
                 log.debug("Using filtered heap walk for {} classes", classesToPatch.size());
-                objectsToPatch = TimeoutExecutor.executeWithTimeoutChecked(
+                objectsToPatch = walkWithTimeout(
                         "heapWalkFiltered",
                         timeoutConfig.heapWalkTimeout(),
                         () -> heapWalker.walkHeap(classesToPatch)
@@ -860,13 +1835,15 @@ public final class MigrationEngine {
             if (objectsToPatch != null && !objectsToPatch.isEmpty()) {
                 // Patch all objects from the heap walk in one batch (shared visited set, so a
                 // connected migrated graph is traversed once — see patchObjects).
-                referencePatcher.patchObjects(objectsToPatch);
+                walkPatcher().patchObjects(objectsToPatch);
                 return objectsToPatch.size();
             }
         } catch (Exception e) {
             // Heap walk failed or timed out: fall back to patching the known pass-2 objects. Note
             // the fallback itself is unbounded (no timeout), so surface this at warn level.
             log.warn("heapWalker failed: {}, falling back to pass2Objects (unbounded)", e.toString());
+        } finally {
+            visitedSets.close();
         }
 
         // Fallback: patch only pass2Objects
@@ -877,6 +1854,249 @@ public final class MigrationEngine {
         return patchedCount;
     }
 
+    /**
+     * Where this second pass keeps its visited sets: {@link #visitedTracking}, with AUTO resolved to
+     * INDEX for the walks INDEX applies to (a streamed FULL or REACHABLE walk, which delivers every
+     * object that can hold a reference) and to IDENTITY otherwise.
+     */
+    private VisitedTracking secondPassVisitedTracking() {
+        boolean covering = scopeRoots == null
+                && (heapWalkMode == HeapWalkMode.FULL || heapWalkMode == HeapWalkMode.REACHABLE);
+        boolean streamed = covering && streamsSecondPass();
+        return switch (visitedTracking) {
+            case AUTO, INDEX -> streamed ? VisitedTracking.INDEX : VisitedTracking.IDENTITY;
+            case MARKS -> heapWalkMode == HeapWalkMode.REFERRERS ? VisitedTracking.IDENTITY : VisitedTracking.MARKS;
+            case IDENTITY -> VisitedTracking.IDENTITY;
+        };
+    }
+
+    /**
+     * Whether the FULL / REACHABLE / SPEC second-pass walk is streamed: with a positive
+     * {@link #walkChunkSize}, or by default for a FULL walk, whose result is the whole heap.
+     */
+    private boolean streamsSecondPass() {
+        return walkChunkSize > 0
+                || (walkChunkSize == MigrationConfig.AUTO_WALK_CHUNK_SIZE && heapWalkMode == HeapWalkMode.FULL);
+    }
+
+    /**
+     * Second pass of a root-scoped migration: walks the objects reachable from its roots and
+     * patches them in one batch, with the pass-2 objects, which the roots do not reach until
+     * they are patched.
+     *
+     * @return the number of objects patched
+     */
+    private int patchReachableFromRoots(Set<Object> pass2Objects) throws MigrateException {
+        Object[] roots = scopeRoots;
+        log.debug("Using root-scoped walk from {} roots", roots.length);
+        Set<Object> walked = walkWithTimeout(
+                "heapWalkFrom(" + roots.length + " roots)",
+                timeoutConfig.heapWalkTimeout(),
+                () -> heapWalker.walkReachableFrom(Arrays.asList(roots), skipLeaves ? leafClasses : null)
+        );
+        Set<Object> objectsToPatch = Collections.newSetFromMap(new IdentityHashMap<>());
+        objectsToPatch.addAll(walked);
+        objectsToPatch.addAll(pass2Objects);
+        walkPatcher().patchObjects(objectsToPatch);
+        return objectsToPatch.size();
+    }
+
+    /**
+     * Streams the FULL, REACHABLE or SPEC walk through one patch batch: the walk resolves chunks on
+     * a worker thread while this thread patches the previous chunk. Already patched chunks stay
+     * patched if the walk fails part-way; the caller's fallback re-patching is idempotent. An auto
+     * {@link #walkChunkSize} lets the walk derive its chunks ({@link HeapWalker#DERIVED_CHUNK_SIZE}).
+     *
+     * @return the number of objects patched
+     */
+    private long streamHeapWalk(Set<Class<?>> classesToPatch) throws Exception {
+        Consumer<Object[]> batch = walkPatcher().openBatch();
+        int chunkSize = walkChunkSize > 0 ? walkChunkSize : HeapWalker.DERIVED_CHUNK_SIZE;
+        Object chunks = walkChunkSize > 0 ? walkChunkSize : "derived from the walk";
+        if (heapWalkMode == HeapWalkMode.FULL) {
+            log.debug("Using full heap walk in chunks of {}", chunks);
+            return ChunkPipeline.run("heapWalkFull", timeoutConfig.heapWalkTimeout(), heapWalker,
+                    sink -> skipLeaves
+                            ? heapWalker.walkHeapSkippingLeaves(leafClasses, sink, chunkSize)
+                            : heapWalker.walkHeap(sink, chunkSize), batch);
+        }
+        if (heapWalkMode == HeapWalkMode.REACHABLE) {
+            log.debug("Using reachable heap walk in chunks of {}", chunks);
+            return ChunkPipeline.run("heapWalkReachable", timeoutConfig.heapWalkTimeout(), heapWalker,
+                    sink -> heapWalker.walkReachable(skipLeaves ? leafClasses : null, sink, chunkSize), batch);
+        }
+        log.debug("Using filtered heap walk for {} classes in chunks of {}", classesToPatch.size(), chunks);
+        return ChunkPipeline.run("heapWalkFiltered", timeoutConfig.heapWalkTimeout(), heapWalker,
+                sink -> heapWalker.walkHeap(classesToPatch, sink, chunkSize), batch);
+    }
+
+    /**
+     * The patcher for the objects of a second-pass walk: the reference patcher itself, or with a
+     * patch parallelism above one a {@link ParallelReferencePatcher} over it.
+     */
+    private ReferencePatcher walkPatcher() {
+        int threads = patchParallelism == 0 ? Runtime.getRuntime().availableProcessors() : patchParallelism;
+        if (threads <= 1 || !(referencePatcher instanceof ReflectionReferencePatcher reflective)) {
+            return referencePatcher;
+        }
+        if (parallelPatcher == null || parallelPatcher.parallelism() != threads) {
+            if (parallelPatcher != null) parallelPatcher.close();
+            parallelPatcher = new ParallelReferencePatcher(reflective, threads);
+        }
+        return parallelPatcher;
+    }
+
+    /**
+     * Holders found by the REFERRERS second pass. {@code directAnchors} reference a migrated object
+     * themselves; {@code chainAnchors} reach one only through non-anchor holders (possibly besides
+     * direct references of their own). {@code scope} is every holder on a chain from an anchor down
+     * to a migrated object; the patch traversal is confined to it.
+     */
+    private record ReferrerChains(List<Object> oldObjects, List<Object> directAnchors,
+                                  List<Object> chainAnchors, Set<Object> scope) {
+
+        /** Every anchor, each once. */
+        List<Object> anchors() {
+            Set<Object> seen = Collections.newSetFromMap(new IdentityHashMap<>());
+            List<Object> all = new ArrayList<>(directAnchors.size() + chainAnchors.size());
+            for (Object a : directAnchors) if (seen.add(a)) all.add(a);
+            for (Object a : chainAnchors) if (seen.add(a)) all.add(a);
+            return all;
+        }
+    }
+
+    /**
+     * REFERRERS second pass: finds the holders of the migrated (old) objects with referrer walks.
+     * Holders that cannot be rewritten in place (JDK internals, immutable containers, records —
+     * see {@link ReferencePatcher#isReferrerAnchor}) are climbed: their own holders are found in
+     * turn, until every chain ends at an anchor. Patching the anchors within the collected chains
+     * then costs time proportional to the number of references to old objects rather than to the
+     * holder classes' population. One chain walk climbs every level at once, recording at most
+     * {@link #referrerChainLimit} references; a walker without chain walks, a walk that fails or
+     * exceeds the limit, or a limit of 0 climbs one referrer walk per level instead.
+     */
+    private ReferrerChains findReferrerChains(Set<Object> pass2Objects) throws MigrateException {
+        List<Object> oldObjects = new ArrayList<>();
+        for (Object o : pass2Objects) {
+            if (forwarding.contains(o)) oldObjects.add(o);
+        }
+
+        if (referrerChainLimit == 0) return climbReferrers(oldObjects);
+        HeapReferrerChains walked;
+        try {
+            walked = heapWalker.findReferrerChains(oldObjects, referencePatcher::isReferrerClimbed, MAX_REFERRER_DEPTH,
+                    referrerChainLimit);
+        } catch (MigrateException e) {
+            log.debug("No referrer-chain walk ({}); climbing one referrer walk per level", e.getMessage());
+            return climbReferrers(oldObjects);
+        }
+
+        // old objects are discarded after the migration; their own slots need no patching
+        Set<Object> scope = Collections.newSetFromMap(new IdentityHashMap<>());
+        for (Object holder : walked.referrers().holders()) {
+            if (holder != null && !forwarding.contains(holder)) scope.add(holder);
+        }
+        List<Object> directAnchors = new ArrayList<>();
+        for (Object holder : walked.directAnchors()) {
+            if (scope.contains(holder)) directAnchors.add(holder);
+        }
+        List<Object> chainAnchors = new ArrayList<>();
+        for (Object holder : walked.linkedAnchors()) {
+            if (scope.contains(holder)) chainAnchors.add(holder);
+        }
+        List<Object> open = new ArrayList<>();
+        for (Object holder : walked.openEnds()) {
+            if (scope.contains(holder)) open.add(holder);
+        }
+        return referrerChains(oldObjects, directAnchors, chainAnchors, open, scope,
+                walked.referrers().rootReferenceCount());
+    }
+
+    /**
+     * Climbs the referrer chains of {@link #findReferrerChains} with one referrer walk per level:
+     * each walk looks for the holders of the climbed holders the walk before found first.
+     */
+    private ReferrerChains climbReferrers(List<Object> oldObjects) throws MigrateException {
+        Set<Object> scope = Collections.newSetFromMap(new IdentityHashMap<>());
+        List<Object> directAnchors = new ArrayList<>();
+        List<Object> chainAnchors = new ArrayList<>();
+        Set<Object> chainAnchorSet = Collections.newSetFromMap(new IdentityHashMap<>());
+        Collection<?> frontier = oldObjects;
+        long rootReferences = 0;
+
+        for (int depth = 0; depth < MAX_REFERRER_DEPTH && !frontier.isEmpty(); depth++) {
+            HeapReferrers referrers = heapWalker.findReferrers(frontier);
+            if (depth == 0) rootReferences = referrers.rootReferenceCount();
+
+            List<Object> next = new ArrayList<>();
+            for (Object holder : referrers.holders()) {
+                // old objects are discarded after the migration; their own slots need no patching
+                if (holder == null || forwarding.contains(holder)) continue;
+                boolean first = scope.add(holder);
+                if (!referencePatcher.isReferrerAnchor(holder)) {
+                    if (first) next.add(holder);
+                } else if (depth == 0) {
+                    directAnchors.add(holder);
+                } else if (chainAnchorSet.add(holder)) {
+                    // may also be a direct anchor: it must still be traversed into its chain
+                    chainAnchors.add(holder);
+                }
+            }
+            frontier = next;
+        }
+        return referrerChains(oldObjects, directAnchors, chainAnchors, frontier, scope, rootReferences);
+    }
+
+    /** Completes the chains found by a referrer climb, whose {@code open} ends found no anchor. */
+    private ReferrerChains referrerChains(List<Object> oldObjects, List<Object> directAnchors,
+                                          List<Object> chainAnchors, Collection<?> open, Set<Object> scope,
+                                          long rootReferences) {
+        if (!open.isEmpty()) {
+            // Chains still open after MAX_REFERRER_DEPTH levels: patch their current ends as-is
+            // (best effort) rather than silently dropping them.
+            log.warn("Referrer walk did not reach an anchor for {} holder(s) within {} levels; patching them directly",
+                    open.size(), MAX_REFERRER_DEPTH);
+            chainAnchors.addAll(open);
+        }
+        if (rootReferences > 0) {
+            log.warn("{} reference(s) to migrated objects are held by heap roots (stack locals, JNI) and cannot be patched",
+                    rootReferences);
+        }
+
+        log.debug("Referrer walk found {} holder(s), {} direct and {} chain anchor(s)",
+                scope.size(), directAnchors.size(), chainAnchors.size());
+        return new ReferrerChains(oldObjects, directAnchors, chainAnchors, scope);
+    }
+
+    /**
+     * Rewrites the slots of the direct anchors natively and returns the anchors the Java patcher
+     * still has to start from: the chain anchors plus any direct anchor with a skipped slot. If
+     * native patching is unsupported or fails, every anchor is returned unchanged.
+     */
+    private List<Object> patchDirectSlotsNatively(ReferrerChains chains) {
+        if (chains.directAnchors().isEmpty()) return chains.anchors();
+
+        Object[] oldObjects = chains.oldObjects().toArray();
+        Object[] newObjects = new Object[oldObjects.length];
+        for (int i = 0; i < oldObjects.length; i++) {
+            newObjects[i] = forwarding.get(oldObjects[i]);
+        }
+
+        SlotPatchResult result;
+        try {
+            result = heapWalker.patchSlots(chains.directAnchors(), oldObjects, newObjects);
+        } catch (MigrateException e) {
+            log.debug("Native slot patching unavailable ({}); using the Java patcher", e.getMessage());
+            return chains.anchors();
+        }
+        log.debug("Native slot patching rewrote {} of {} slot(s); {} holder(s) left to the Java patcher",
+                result.slotsRewritten(), result.slotsFound(), result.unpatchedHolders().length);
+
+        List<Object> remaining = new ArrayList<>(chains.chainAnchors());
+        Collections.addAll(remaining, result.unpatchedHolders());
+        return remaining;
+    }
+
     /** Patches static fields of every candidate class, isolating (logging) any failure. */
     private void safeAutoPatchStaticFields(Set<Class<?>> classesToPatch) {
         try {
@@ -939,10 +2159,13 @@ public final class MigrationEngine {
 
     /**
      * Collects the set of classes (and their superclass chains) that may hold references to migrated
-     * objects: the scanned classes plus the concrete classes of all pass-2 objects. Used both to filter
-     * the heap walk and to drive static-field patching.
+     * objects: the scanned classes plus the concrete classes of all pass-2 objects, then the
+     * discovered holder classes (exact classes, which is all the filtered walk needs; discovery
+     * already climbed past the JDK internals the walk cannot patch on their own). Used both to
+     * filter the heap walk and to drive static-field patching.
      */
-    private Set<Class<?>> collectClassesToPatch(Collection<Class<?>> classesToScan, Collection<Object> pass2Objects) {
+    private Set<Class<?>> collectClassesToPatch(Collection<Class<?>> classesToScan, Collection<Object> pass2Objects,
+                                                Collection<Class<?>> discoveredHolders) {
         Set<Class<?>> classesToPatch = new LinkedHashSet<>();
 
         if (classesToScan != null) {
@@ -960,6 +2183,11 @@ public final class MigrationEngine {
             }
         }
 
+        // Added last: addClassHierarchy's early exit assumes a present class has its supers too.
+        if (discoveredHolders != null) {
+            classesToPatch.addAll(discoveredHolders);
+        }
+
         return classesToPatch;
     }
 
@@ -1075,12 +2303,17 @@ public final class MigrationEngine {
 
 
     /**
-     * Best-effort delegation to NativeHeapWalker.advanceEpoch() if available. Runs after commit,
-     * so any failure is logged rather than propagated.
+     * Best-effort delegation to NativeHeapWalker.advanceEpoch() if available (through the foreign
+     * binding with the FOREIGN backend). Runs after commit, so any failure is logged rather than
+     * propagated.
      */
     private void migratorAdvanceEpoch() {
         try {
-            NativeHeapWalker.advanceEpoch();
+            if (heapWalker instanceof ForeignHeapWalker foreign) {
+                foreign.advanceEpoch();
+            } else {
+                NativeHeapWalker.advanceEpoch();
+            }
         } catch (Throwable t) {
             // Best-effort native bookkeeping that runs after commit; a failure here — including a
             // native UnsatisfiedLinkError (an Error) when the agent library isn't loaded — must not
@@ -1,6 +1,9 @@
 package migrator.engine;
 
 import migrator.exceptions.MigrationTimeoutException;
+import migrator.heap.HeapWalker;
+import migrator.heap.WalkProgress;
+import migrator.state.MigrationState;
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
@@ -16,7 +19,8 @@ import java.util.function.Supplier;
  *
  * <p>The executor uses a cached thread pool for timeout operations. Operations that
  * timeout are interrupted, though the underlying operation may not respond to interruption
- * depending on its implementation.
+ * depending on its implementation. A native heap walk does not: it runs as one VM operation,
+ * so heap walks go through {@link #executeWalkWithTimeout}, which also cancels the walk itself.
  *
  * @see MigrationTimeoutConfig
  * @see MigrationTimeoutException
@@ -118,6 +122,51 @@ public final class TimeoutExecutor {
      * @throws Exception if the callable throws a checked exception
      */
     public static <T> T executeWithTimeoutChecked(String operation, Duration timeout, Callable<T> callable) throws Exception {
+        return executeChecked(operation, timeout, callable, null);
+    }
+
+    /**
+     * Executes a heap walk with a timeout, publishing its live progress to {@link MigrationState}
+     * while it runs.
+     *
+     * <p>On timeout the walk is cancelled through {@link HeapWalker#cancelWalks()} as well as
+     * interrupted, so a native walk stops within a poll interval instead of visiting the rest of
+     * the heap, and the timeout is logged with the progress the walk had reached.
+     *
+     * @param operation the name of the operation (for error messages and the migration state)
+     * @param timeout the timeout duration, or null/zero to disable
+     * @param walker the heap walker running the walk
+     * @param walk the walk to execute
+     * @param <T> the return type
+     * @return the result of the walk
+     * @throws MigrationTimeoutException if the walk times out
+     * @throws Exception if the walk throws a checked exception
+     */
+    public static <T> T executeWalkWithTimeout(String operation, Duration timeout, HeapWalker walker,
+                                               Callable<T> walk) throws Exception {
+        MigrationState state = MigrationState.getInstance();
+        state.walkStarted(operation, walker::walkProgress);
+        try {
+            return executeChecked(operation, timeout, walk, () -> cancelWalk(operation, walker));
+        } finally {
+            state.walkFinished();
+        }
+    }
+
+    /** Cancels a timed-out walk and logs how far it got. Never throws. */
+    static void cancelWalk(String operation, HeapWalker walker) {
+        try {
+            WalkProgress progress = walker.walkProgress();
+            walker.cancelWalks();
+            log.warn("Cancelling heap walk '{}' at {}", operation, progress.describe());
+        } catch (RuntimeException | LinkageError e) {
+            log.warn("Could not cancel heap walk '{}': {}", operation, e.toString());
+        }
+    }
+
+    /** Runs {@code callable} under the timeout; {@code onTimeout} (may be null) runs before the worker is interrupted. */
+    private static <T> T executeChecked(String operation, Duration timeout, Callable<T> callable,
+                                        Runnable onTimeout) throws Exception {
         if (!MigrationTimeoutConfig.isEnabled(timeout)) {
             return callable.call();
         }
@@ -131,10 +180,12 @@ public final class TimeoutExecutor {
         try {
             return future.get(timeout.toMillis(), TimeUnit.MILLISECONDS);
         } catch (TimeoutException e) {
-            future.cancel(true);
             log.warn("Operation '{}' timed out after {} ms", operation, timeout.toMillis());
+            if (onTimeout != null) onTimeout.run();
+            future.cancel(true);
             throw new MigrationTimeoutException(operation, timeout, e);
         } catch (InterruptedException e) {
+            if (onTimeout != null) onTimeout.run();
             future.cancel(true);
             Thread.currentThread().interrupt();
             throw new MigrationTimeoutException(operation, timeout, e);
@@ -0,0 +1,108 @@
+package migrator.engine;
+
+import migrator.config.VisitedTracking;
+import migrator.exceptions.MigrateException;
+import migrator.heap.HeapWalker;
+import migrator.heap.VisitMarks;
+import migrator.heap.WalkIndex;
+import migrator.patch.BitmapVisitedSet;
+import migrator.patch.ReferencePatcher;
+import migrator.patch.ReflectionReferencePatcher;
+import migrator.patch.VisitedSet;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.util.ArrayList;
+import java.util.List;
+
+/**
+ * The visited sets of one second-pass walk, kept where {@link VisitedTracking} says: installed on
+ * the reflective patcher as its batch factory for the walk, and removed by {@link #close()},
+ * which also releases every native mark set and the walk index.
+ *
+ * <p>{@link VisitedTracking#MARKS} opens a {@link VisitMarks} per batch;
+ * {@link VisitedTracking#INDEX} opens one {@link WalkIndex} up front, which the walker attaches to
+ * the walk that follows, and keys a {@link BitmapVisitedSet} by it. Either falls back to identity
+ * sets when the walker cannot provide them.
+ */
+final class WalkVisitedSets implements VisitedSet.Factory, AutoCloseable {
+
+    private static final Logger log = LoggerFactory.getLogger(WalkVisitedSets.class);
+
+    private final ReflectionReferencePatcher patcher;
+    private final HeapWalker walker;
+    private final VisitedTracking tracking;
+    private final WalkIndex index;
+    private final List<VisitMarks> marks = new ArrayList<>();
+
+    private WalkVisitedSets(ReflectionReferencePatcher patcher, HeapWalker walker, VisitedTracking tracking,
+                            WalkIndex index) {
+        this.patcher = patcher;
+        this.walker = walker;
+        this.tracking = tracking;
+        this.index = index;
+    }
+
+    /**
+     * Installs the visited sets of {@code tracking} ({@link VisitedTracking#MARKS} or
+     * {@link VisitedTracking#INDEX}; anything else installs nothing) on {@code patcher}.
+     *
+     * @return the installed sets, to be closed when the walk's batches are done
+     */
+    static WalkVisitedSets install(ReferencePatcher patcher, HeapWalker walker, VisitedTracking tracking) {
+        if (!(patcher instanceof ReflectionReferencePatcher reflective) || walker == null
+                || (tracking != VisitedTracking.MARKS && tracking != VisitedTracking.INDEX)) {
+            return new WalkVisitedSets(null, walker, VisitedTracking.IDENTITY, null);
+        }
+        WalkIndex index = null;
+        if (tracking == VisitedTracking.INDEX) {
+            try {
+                index = walker.openWalkIndex();
+            } catch (MigrateException e) {
+                log.debug("No walk index ({}); visited sets stay on the heap", e.getMessage());
+                return new WalkVisitedSets(null, walker, VisitedTracking.IDENTITY, null);
+            }
+        }
+        WalkVisitedSets sets = new WalkVisitedSets(reflective, walker, tracking, index);
+        reflective.setVisitedSets(sets);
+        return sets;
+    }
+
+    /** @return where the walk's visited sets are kept: IDENTITY, MARKS or INDEX */
+    VisitedTracking tracking() {
+        return tracking;
+    }
+
+    @Override
+    public VisitedSet open(int expectedSize, int concurrency) {
+        if (tracking == VisitedTracking.INDEX) {
+            return new BitmapVisitedSet(index::indexOf);
+        }
+        VisitMarks set;
+        try {
+            set = walker.openVisitMarks(concurrency > 1);
+        } catch (MigrateException e) {
+            log.debug("No visit marks ({}); batch keeps its visited set on the heap", e.getMessage());
+            return VisitedSet.IDENTITY.open(expectedSize, concurrency);
+        }
+        synchronized (marks) {
+            marks.add(set);
+        }
+        return new VisitedSet() {
+            @Override public boolean add(Object o) { return set.mark(o); }
+            @Override public void close() { set.close(); }
+        };
+    }
+
+    /** Restores the patcher's identity sets and releases the native marks and index. */
+    @Override
+    public void close() {
+        if (patcher == null) return;
+        patcher.setVisitedSets(null);
+        if (index != null) index.close();
+        synchronized (marks) {
+            for (VisitMarks set : marks) set.close();
+            marks.clear();
+        }
+    }
+}
@@ -0,0 +1,34 @@
+package migrator.heap;
+
+/**
+ * The statistics entry points of the native agent ({@code migrator_*} in {@code agent/agent.c}),
+ * bound without JNI. The implementation uses {@code java.lang.foreign}, final only from JDK 22,
+ * so it is compiled separately (from {@code src/main/java22}, when the build runs on JDK 22 or
+ * later) and loaded reflectively by {@link ForeignHeapWalker}.
+ *
+ * <p>Every method has the contract of the {@link HeapWalker} or {@link NativeHeapWalker} method
+ * of the same name.
+ */
+interface ForeignAgentBinding {
+
+    /** @see HeapWalker#walkProgress() */
+    WalkProgress walkProgress();
+
+    /** @see HeapWalker#cancelWalks() */
+    void cancelWalks();
+
+    /** @see HeapWalker#opTimes() */
+    HeapOpTimes opTimes();
+
+    /** @see HeapWalker#reclamationProgress() */
+    ReclamationProgress reclamationProgress();
+
+    /** @see NativeHeapWalker#advanceEpoch() */
+    void advanceEpoch();
+
+    /** @see NativeHeapWalker#retainedTagCount() */
+    long retainedTagCount();
+
+    /** @see NativeHeapWalker#openWalkEnvironments() */
+    int openWalkEnvironments();
+}
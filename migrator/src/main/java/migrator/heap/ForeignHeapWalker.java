@@ -0,0 +1,290 @@
+package migrator.heap;
+
+import java.nio.file.Path;
+import java.util.Collection;
+import java.util.Map;
+import java.util.Set;
+import java.util.function.Consumer;
+import java.util.function.Predicate;
+
+import migrator.exceptions.MigrateException;
+
+/**
+ * {@link HeapWalker} that reaches the native agent through the Foreign Function &amp; Memory API
+ * ({@code java.lang.foreign}, JDK 22+) wherever the exchange is numeric.
+ *
+ * <p>Walk progress, cancellation, operation times, reclamation counters, the epoch and the tag
+ * diagnostics are bound to the agent's {@code migrator_*} functions: the agent writes its
+ * counters into an off-heap segment, and the short calls skip the thread-state transition of a
+ * JNI call (see {@code PanamaAgentBinding}). These are the calls made while a walk runs, by the
+ * progress watcher and the timeout path, and around every phase for the metrics.
+ *
+ * <p>Everything that returns or takes Java objects (snapshots, walks, the census, referrers,
+ * holder classes, patching, verification, the graph export, tracking windows) still goes through
+ * {@link NativeHeapWalker}: a foreign function cannot create or read Java references, and JNI's
+ * per-object cost is in the agent building the result array, which no binding removes.
+ *
+ * <p>Obtain one with {@link #create()}. The binding is compiled only when the build runs on
+ * JDK 22 or later, and the native agent must be loaded; {@link #unsupportedReason()} tells why it
+ * is not available otherwise.
+ *
+ * @see ForeignAgentBinding
+ */
+public final class ForeignHeapWalker implements HeapWalker {
+
+    /** The binding compiled from {@code src/main/java22}; absent from a build on JDK 21. */
+    private static final String BINDING_CLASS = "migrator.heap.PanamaAgentBinding";
+
+    /** First JDK on which {@code java.lang.foreign} is final. */
+    private static final int MIN_FEATURE = 22;
+
+    private static volatile ForeignAgentBinding sharedBinding;
+    private static volatile String unsupportedReason;
+    private static volatile boolean bindFailed;
+
+    private final NativeHeapWalker jni = new NativeHeapWalker();
+    private final ForeignAgentBinding binding;
+
+    private ForeignHeapWalker(ForeignAgentBinding binding) {
+        this.binding = binding;
+    }
+
+    /**
+     * Binds the agent's foreign entry points (once per process) and returns a walker using them.
+     *
+     * @return the walker
+     * @throws MigrateException if the runtime is older than JDK 22, the binding was not compiled,
+     *                          or the native agent is not loaded
+     */
+    public static ForeignHeapWalker create() throws MigrateException {
+        ForeignAgentBinding b = bind();
+        if (b == null) {
+            throw new MigrateException("Foreign heap walker unavailable: " + unsupportedReason);
+        }
+        return new ForeignHeapWalker(b);
+    }
+
+    /** @return true if {@link #create()} succeeds in this process */
+    public static boolean isSupported() {
+        return bind() != null;
+    }
+
+    /** @return why {@link #create()} fails, or null if it succeeds */
+    public static String unsupportedReason() {
+        return bind() != null ? null : unsupportedReason;
+    }
+
+    /**
+     * Binds on first use. A failure is remembered, since none of its causes can change later,
+     * except an agent that is not loaded yet.
+     */
+    private static synchronized ForeignAgentBinding bind() {
+        if (sharedBinding != null || bindFailed) return sharedBinding;
+        int feature = Runtime.version().feature();
+        if (feature < MIN_FEATURE) {
+            return fail("requires JDK " + MIN_FEATURE + " or later, running " + feature);
+        }
+        try {
+            String library = NativeHeapWalker.agentLibraryPath();
+            if (library == null) {
+                return fail("the native agent cannot report where it was loaded from");
+            }
+            Class<?> type = Class.forName(BINDING_CLASS);
+            sharedBinding = (ForeignAgentBinding) type.getDeclaredConstructor(String.class).newInstance(library);
+            unsupportedReason = null;
+            return sharedBinding;
+        } catch (ClassNotFoundException e) {
+            return fail("not compiled in (build on JDK " + MIN_FEATURE + " or later)");
+        } catch (UnsatisfiedLinkError e) {
+            unsupportedReason = "the native agent is not loaded";
+            return null;
+        } catch (ReflectiveOperationException | RuntimeException | LinkageError e) {
+            Throwable cause = e.getCause() != null ? e.getCause() : e;
+            return fail("binding failed: " + cause);
+        }
+    }
+
+    private static ForeignAgentBinding fail(String reason) {
+        unsupportedReason = reason;
+        bindFailed = true;
+        return null;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Bound through java.lang.foreign
+    // ---------------------------------------------------------------------------------------------
+
+    @Override
+    public WalkProgress walkProgress() {
+        return binding.walkProgress();
+    }
+
+    @Override
+    public void cancelWalks() {
+        binding.cancelWalks();
+    }
+
+    @Override
+    public HeapOpTimes opTimes() {
+        return binding.opTimes();
+    }
+
+    @Override
+    public ReclamationProgress reclamationProgress() {
+        return binding.reclamationProgress();
+    }
+
+    /** @see NativeHeapWalker#advanceEpoch() */
+    public void advanceEpoch() {
+        binding.advanceEpoch();
+    }
+
+    /** @see NativeHeapWalker#retainedTagCount() */
+    public long retainedTagCount() {
+        return binding.retainedTagCount();
+    }
+
+    /** @see NativeHeapWalker#openWalkEnvironments() */
+    public int openWalkEnvironments() {
+        return binding.openWalkEnvironments();
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Object results: JNI
+    // ---------------------------------------------------------------------------------------------
+
+    @Override
+    public Object[] snapshotObjects(Class<?> targetClass) {
+        return jni.snapshotObjects(targetClass);
+    }
+
+    @Override
+    public Map<Class<?>, Object[]> snapshotPartitioned(Collection<Class<?>> classes) {
+        return jni.snapshotPartitioned(classes);
+    }
+
+    @Override
+    public Map<Class<?>, Object[]> snapshotReachable(Collection<Class<?>> classes) {
+        return jni.snapshotReachable(classes);
+    }
+
+    @Override
+    public Set<Object> walkHeap() {
+        return jni.walkHeap();
+    }
+
+    @Override
+    public Set<Object> walkHeapSkippingLeaves(Collection<Class<?>> leafClasses) {
+        return jni.walkHeapSkippingLeaves(leafClasses);
+    }
+
+    @Override
+    public Set<Object> walkReachable(Collection<Class<?>> leafClasses) {
+        return jni.walkReachable(leafClasses);
+    }
+
+    @Override
+    public Map<Class<?>, Object[]> snapshotReachableFrom(Collection<?> roots, Collection<Class<?>> classes)
+            throws MigrateException {
+        return jni.snapshotReachableFrom(roots, classes);
+    }
+
+    @Override
+    public Set<Object> walkReachableFrom(Collection<?> roots, Collection<Class<?>> leafClasses) {
+        return jni.walkReachableFrom(roots, leafClasses);
+    }
+
+    @Override
+    public Set<Object> walkHeap(Collection<Class<?>> classes) throws MigrateException {
+        return jni.walkHeap(classes);
+    }
+
+    @Override
+    public long walkHeap(Consumer<Object[]> chunkSink, int chunkSize) throws MigrateException {
+        return jni.walkHeap(chunkSink, chunkSize);
+    }
+
+    @Override
+    public long walkHeapSkippingLeaves(Collection<Class<?>> leafClasses, Consumer<Object[]> chunkSink,
+                                       int chunkSize) throws MigrateException {
+        return jni.walkHeapSkippingLeaves(leafClasses, chunkSink, chunkSize);
+    }
+
+    @Override
+    public long walkReachable(Collection<Class<?>> leafClasses, Consumer<Object[]> chunkSink, int chunkSize)
+            throws MigrateException {
+        return jni.walkReachable(leafClasses, chunkSink, chunkSize);
+    }
+
+    @Override
+    public long walkHeap(Collection<Class<?>> classes, Consumer<Object[]> chunkSink, int chunkSize)
+            throws MigrateException {
+        return jni.walkHeap(classes, chunkSink, chunkSize);
+    }
+
+    @Override
+    public HeapCensus census(Collection<Class<?>> classes) throws MigrateException {
+        return jni.census(classes);
+    }
+
+    @Override
+    public boolean startReclamationTracking(Collection<?> objects) {
+        return jni.startReclamationTracking(objects);
+    }
+
+    @Override
+    public void stopReclamationTracking() {
+        jni.stopReclamationTracking();
+    }
+
+    @Override
+    public HeapReferrers findReferrers(Collection<?> targets) {
+        return jni.findReferrers(targets);
+    }
+
+    @Override
+    public HeapReferrerChains findReferrerChains(Collection<?> targets, Predicate<Class<?>> climbed, int maxDepth,
+                                                 long maxEdges) throws MigrateException {
+        return jni.findReferrerChains(targets, climbed, maxDepth, maxEdges);
+    }
+
+    @Override
+    public HolderClasses findHolderClasses(Collection<Class<?>> sourceClasses, Predicate<Class<?>> climbed,
+                                           int maxDepth) throws MigrateException {
+        return jni.findHolderClasses(sourceClasses, climbed, maxDepth);
+    }
+
+    @Override
+    public SlotPatchResult patchSlots(Collection<?> holders, Object[] oldObjects, Object[] newObjects)
+            throws MigrateException {
+        return jni.patchSlots(holders, oldObjects, newObjects);
+    }
+
+    @Override
+    public StackLocalPatchResult patchStackLocals(Collection<Thread> threads, Object[] oldObjects,
+                                                  Object[] newObjects) throws MigrateException {
+        return jni.patchStackLocals(threads, oldObjects, newObjects);
+    }
+
+    @Override
+    public ResidualReferences findResidualReferences(Collection<?> oldObjects, Collection<?> excluded, int maxPaths)
+            throws MigrateException {
+        return jni.findResidualReferences(oldObjects, excluded, maxPaths);
+    }
+
+    @Override
+    public HeapGraphExport exportReferenceGraph(Path file, Collection<Class<?>> sourceClasses, boolean sourceEdgesOnly)
+            throws MigrateException {
+        return jni.exportReferenceGraph(file, sourceClasses, sourceEdgesOnly);
+    }
+
+    @Override
+    public VisitMarks openVisitMarks(boolean concurrent) throws MigrateException {
+        return jni.openVisitMarks(concurrent);
+    }
+
+    @Override
+    public WalkIndex openWalkIndex() throws MigrateException {
+        return jni.openWalkIndex();
+    }
+}
@@ -0,0 +1,123 @@
+package migrator.heap;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.Comparator;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Per-class histogram of the heap: instance count, total shallow size and, for array classes,
+ * the distribution of array lengths. Produced by one heap pass that resolves no objects, so its
+ * size is proportional to the number of classes, never to the heap.
+ *
+ * <p>Matching is on the exact class: instances of a subclass are counted under the subclass only.
+ * Classes without instances have no entry.
+ *
+ * @param classes the per-class entries, in the order the walker reported them
+ * @see HeapWalker#census(java.util.Collection)
+ */
+public record HeapCensus(Map<Class<?>, ClassCensus> classes) {
+
+    /** Number of array-length buckets: bucket 0 holds length 0, bucket k lengths [2^(k-1), 2^k). */
+    public static final int LENGTH_BUCKETS = 32;
+
+    /** An empty census: no classes, no instances. */
+    public static final HeapCensus EMPTY = new HeapCensus(Map.of());
+
+    /** Null-guards and freezes the entries. */
+    public HeapCensus {
+        classes = (classes == null || classes.isEmpty())
+                ? Map.of()
+                : Collections.unmodifiableMap(new LinkedHashMap<>(classes));
+    }
+
+    /**
+     * The census of one class.
+     *
+     * @param type          the class
+     * @param count         the number of instances
+     * @param shallowBytes  the total shallow size of the instances, in bytes
+     * @param lengthBuckets for an array class, the number of arrays per length bucket (see
+     *                      {@link #LENGTH_BUCKETS}); null for other classes
+     */
+    public record ClassCensus(Class<?> type, long count, long shallowBytes, long[] lengthBuckets) {
+
+        /** @return the average shallow size of an instance in bytes (0 without instances). */
+        public long averageBytes() {
+            return count > 0 ? shallowBytes / count : 0;
+        }
+    }
+
+    /**
+     * Builds a census from the arrays filled by the native agent: the classes, their
+     * (count, shallow bytes) pairs, and one row of {@link #LENGTH_BUCKETS} counts per array class
+     * in the same order.
+     *
+     * @param raw {@code Object[] { Class[], long[], long[] }} (null means empty)
+     * @return the census
+     */
+    static HeapCensus fromNative(Object[] raw) {
+        if (raw == null || raw.length < 3 || !(raw[0] instanceof Class<?>[] types)
+                || !(raw[1] instanceof long[] stats) || !(raw[2] instanceof long[] buckets)) {
+            return EMPTY;
+        }
+        Map<Class<?>, ClassCensus> entries = new LinkedHashMap<>();
+        int arrayRow = 0;
+        for (int i = 0; i < types.length && 2 * i + 1 < stats.length; i++) {
+            Class<?> type = types[i];
+            long[] lengths = null;
+            if (type != null && type.isArray() && (arrayRow + 1) * LENGTH_BUCKETS <= buckets.length) {
+                lengths = new long[LENGTH_BUCKETS];
+                System.arraycopy(buckets, arrayRow++ * LENGTH_BUCKETS, lengths, 0, LENGTH_BUCKETS);
+            }
+            if (type != null) entries.put(type, new ClassCensus(type, stats[2 * i], stats[2 * i + 1], lengths));
+        }
+        return new HeapCensus(entries);
+    }
+
+    /** @return the number of instances of exactly this class (0 if none). */
+    public long count(Class<?> type) {
+        ClassCensus c = classes.get(type);
+        return c != null ? c.count() : 0;
+    }
+
+    /** @return the total shallow size of the instances of exactly this class, in bytes (0 if none). */
+    public long shallowBytes(Class<?> type) {
+        ClassCensus c = classes.get(type);
+        return c != null ? c.shallowBytes() : 0;
+    }
+
+    /** @return the number of instances across all counted classes. */
+    public long totalCount() {
+        long n = 0;
+        for (ClassCensus c : classes.values()) n += c.count();
+        return n;
+    }
+
+    /** @return the total shallow size across all counted classes, in bytes. */
+    public long totalShallowBytes() {
+        long n = 0;
+        for (ClassCensus c : classes.values()) n += c.shallowBytes();
+        return n;
+    }
+
+    /**
+     * @param limit the maximum number of entries
+     * @return the entries with the largest shallow size, largest first
+     */
+    public List<ClassCensus> largestByBytes(int limit) {
+        List<ClassCensus> sorted = new ArrayList<>(classes.values());
+        sorted.sort(Comparator.comparingLong(ClassCensus::shallowBytes).reversed());
+        return sorted.subList(0, Math.max(0, Math.min(limit, sorted.size())));
+    }
+
+    /**
+     * @param bucket a length bucket index
+     * @return the smallest array length counted in that bucket
+     */
+    public static long bucketLowerBound(int bucket) {
+        return bucket <= 0 ? 0 : 1L << (bucket - 1);
+    }
+}
@@ -0,0 +1,493 @@
+package migrator.heap;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Path;
+import java.nio.file.StandardOpenOption;
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.EnumMap;
+import java.util.HashMap;
+import java.util.LinkedHashMap;
+import java.util.LinkedHashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Objects;
+import java.util.Set;
+
+/**
+ * Reader of a reference graph written by {@link HeapWalker#exportReferenceGraph}, for planning a
+ * migration offline: who references a class, which classes hold references that would need
+ * patching, and how many objects a SPEC walk would visit.
+ *
+ * <p>The file is memory-mapped, never loaded: the object and reference tables are read in place,
+ * so a query costs one sequential pass over the tables and memory proportional to the number of
+ * classes, plus one bit per object for the queries that count distinct holders. Only the class
+ * table is decoded when the file is opened.
+ *
+ * <p>Objects are identified by their index in the object table. The first {@link #classCount()}
+ * objects are the loaded classes' {@code Class} mirrors, so a class id is also the object id of
+ * its mirror; a static field is a reference from that mirror. Classes are matched by name
+ * ({@link Class#getName()} form) and exactly: instances of a subclass are not counted under its
+ * superclass, and a name loaded by several class loaders matches all of them.
+ *
+ * <p>Not thread-safe: open one reader per thread.
+ *
+ * @see HeapGraphExport
+ */
+public final class HeapGraph implements AutoCloseable {
+
+    /** Referrer id of a reference from a heap root. */
+    public static final int ROOT = -1;
+
+    /** "GRGM" in little-endian order (GRAPH_MAGIC in agent.c). */
+    static final int MAGIC = 0x4D475247;
+    static final int VERSION = 1;
+    static final int HEADER_SIZE = 64;
+    static final int EDGE_SIZE = 16;
+    static final int OBJECT_SIZE = 8;
+
+    /** File flag: only the references into source-class instances were written. */
+    static final int SOURCE_EDGES_ONLY = 1;
+
+    /** Class flags in the class table. */
+    static final int CLASS_SOURCE = 1;
+    static final int CLASS_PRIMITIVE_ARRAY = 2;
+
+    /** Bytes mapped per buffer: a multiple of both record sizes, so no record straddles two. */
+    private static final long WINDOW = 1L << 30;
+
+    /** Receives the references of {@link #forEachReference}. */
+    @FunctionalInterface
+    public interface ReferenceVisitor {
+        /**
+         * @param referrer the referring object, or {@link #ROOT}
+         * @param referree the referenced object
+         * @param kind     the kind of reference (null for a kind unknown to this version)
+         * @param index    the JVMTI field index, array index or constant-pool index, or -1
+         */
+        void reference(int referrer, int referree, HeapReferenceKind kind, int index);
+    }
+
+    /**
+     * The references into the instances of one class.
+     *
+     * @param target     the class name
+     * @param instances  its reachable instances
+     * @param references the references into them, from objects and roots
+     * @param byClass    references from objects, by referring class, most first; a static
+     *                   field counts under the class that declares it
+     * @param roots      references from heap roots, by kind
+     */
+    public record Referrers(String target, long instances, long references,
+                            Map<String, Long> byClass, Map<HeapReferenceKind, Long> roots) {
+
+        /** Freezes the maps. */
+        public Referrers {
+            byClass = Collections.unmodifiableMap(new LinkedHashMap<>(byClass));
+            roots = Collections.unmodifiableMap(roots.isEmpty()
+                    ? new EnumMap<>(HeapReferenceKind.class) : new EnumMap<>(roots));
+        }
+    }
+
+    /**
+     * What a SPEC second pass over a set of classes would cost on this heap.
+     *
+     * @param objectsWalked the instances of the SPEC classes: the objects the filtered walk
+     *                      resolves and the patcher visits
+     * @param bytesWalked   their shallow size
+     * @param holders       the objects holding a field, array-element or static-field reference
+     *                      to a source instance
+     * @param holdersMissed those of the holders the SPEC classes do not cover, whose references
+     *                      the second pass would leave unpatched
+     * @param heapObjects   every reachable object: what a FULL walk resolves
+     * @param heapBytes     their shallow size
+     */
+    public record SpecCost(long objectsWalked, long bytesWalked, long holders, long holdersMissed,
+                           long heapObjects, long heapBytes) {
+
+        /** @return the share of the reachable objects the SPEC walk visits, 0 to 1. */
+        public double walkedFraction() {
+            return heapObjects > 0 ? (double) objectsWalked / heapObjects : 0;
+        }
+    }
+
+    private final FileChannel channel;
+    private final boolean sourceEdgesOnly;
+    private final String[] classNames;
+    private final int[] classFlags;
+    private final Map<String, List<Integer>> classIds;
+    private final int objectCount;
+    private final long referenceCount;
+    private final Table references;
+    private final Table objects;
+
+    private HeapGraph(FileChannel channel, boolean sourceEdgesOnly, String[] classNames, int[] classFlags,
+                      int objectCount, long referenceCount, Table references, Table objects) {
+        this.channel = channel;
+        this.sourceEdgesOnly = sourceEdgesOnly;
+        this.classNames = classNames;
+        this.classFlags = classFlags;
+        this.objectCount = objectCount;
+        this.referenceCount = referenceCount;
+        this.references = references;
+        this.objects = objects;
+        Map<String, List<Integer>> ids = new HashMap<>();
+        for (int i = 0; i < classNames.length; i++) {
+            ids.computeIfAbsent(classNames[i], k -> new ArrayList<>(1)).add(i);
+        }
+        this.classIds = ids;
+    }
+
+    /**
+     * Maps a graph file and decodes its class table.
+     *
+     * @param file a file written by {@link HeapWalker#exportReferenceGraph}
+     * @return the reader; close it to release the file
+     * @throws IOException if the file cannot be read, or is not a complete graph export
+     */
+    public static HeapGraph open(Path file) throws IOException {
+        FileChannel channel = FileChannel.open(file, StandardOpenOption.READ);
+        try {
+            long size = channel.size();
+            if (size < HEADER_SIZE) throw new IOException(file + ": not a reference-graph file");
+            ByteBuffer header = channel.map(FileChannel.MapMode.READ_ONLY, 0, HEADER_SIZE);
+            header.order(ByteOrder.LITTLE_ENDIAN);
+            if (header.getInt(0) != MAGIC) {
+                header.order(ByteOrder.BIG_ENDIAN);
+                if (header.getInt(0) != MAGIC) {
+                    throw new IOException(file + ": not a reference-graph file, or an incomplete export");
+                }
+            }
+            ByteOrder order = header.order();
+            int version = header.getInt(4);
+            if (version != VERSION) throw new IOException(file + ": unsupported graph version " + version);
+            int flags = header.getInt(8);
+            int classCount = header.getInt(12);
+            long objectCount = header.getLong(16);
+            long referenceCount = header.getLong(24);
+            long classOffset = header.getLong(32);
+            long edgeOffset = header.getLong(40);
+            long objectOffset = header.getLong(48);
+            long fileSize = header.getLong(56);
+            if (fileSize != size || classCount < 0 || objectCount < classCount || objectCount > Integer.MAX_VALUE
+                    || referenceCount < 0 || classOffset < HEADER_SIZE || edgeOffset < classOffset
+                    || edgeOffset + referenceCount * EDGE_SIZE > objectOffset
+                    || objectOffset + objectCount * OBJECT_SIZE > size
+                    || edgeOffset - classOffset > Integer.MAX_VALUE) {
+                throw new IOException(file + ": corrupt or truncated reference-graph header");
+            }
+
+            String[] names = new String[classCount];
+            int[] classFlags = new int[classCount];
+            ByteBuffer classes = channel.map(FileChannel.MapMode.READ_ONLY, classOffset, edgeOffset - classOffset)
+                    .order(order);
+            for (int i = 0; i < classCount; i++) {
+                if (classes.remaining() < 8) throw new IOException(file + ": truncated class table");
+                classFlags[i] = classes.getInt();
+                int length = classes.getInt();
+                if (length < 0 || length > classes.remaining()) throw new IOException(file + ": truncated class table");
+                byte[] signature = new byte[length];
+                classes.get(signature);
+                names[i] = className(new String(signature, StandardCharsets.UTF_8));
+            }
+
+            Table references = new Table(channel, order, edgeOffset, referenceCount, EDGE_SIZE);
+            Table objects = new Table(channel, order, objectOffset, objectCount, OBJECT_SIZE);
+            return new HeapGraph(channel, (flags & SOURCE_EDGES_ONLY) != 0, names, classFlags,
+                    (int) objectCount, referenceCount, references, objects);
+        } catch (IOException | RuntimeException e) {
+            channel.close();
+            throw e;
+        }
+    }
+
+    /**
+     * Converts a JVMTI class signature to the {@link Class#getName()} form:
+     * {@code Ljava/lang/String;} to {@code java.lang.String}, {@code [Ljava/lang/String;} to
+     * {@code [Ljava.lang.String;}, {@code I} to {@code int}.
+     */
+    static String className(String signature) {
+        if (signature.isEmpty()) return "?";
+        if (signature.charAt(0) == 'L' && signature.endsWith(";")) {
+            return signature.substring(1, signature.length() - 1).replace('/', '.');
+        }
+        if (signature.charAt(0) == '[') return signature.replace('/', '.');
+        if (signature.length() == 1) {
+            switch (signature.charAt(0)) {
+                case 'Z': return "boolean";
+                case 'B': return "byte";
+                case 'C': return "char";
+                case 'S': return "short";
+                case 'I': return "int";
+                case 'J': return "long";
+                case 'F': return "float";
+                case 'D': return "double";
+                case 'V': return "void";
+                default: break;
+            }
+        }
+        return signature;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Tables
+    // ---------------------------------------------------------------------------------------------
+
+    /** @return the number of loaded classes when the graph was written */
+    public int classCount() {
+        return classNames.length;
+    }
+
+    /** @return the name of a class, in {@link Class#getName()} form */
+    public String className(int classId) {
+        return classNames[classId];
+    }
+
+    /** @return the ids of the classes with this name (one per defining loader), empty if none */
+    public List<Integer> classIds(String name) {
+        return classIds.getOrDefault(name, List.of());
+    }
+
+    /** @return true if the class was flagged as a migration source by the export */
+    public boolean isSourceClass(int classId) {
+        return (classFlags[classId] & CLASS_SOURCE) != 0;
+    }
+
+    /** @return the names of the classes flagged as migration sources by the export */
+    public Set<String> sourceClassNames() {
+        Set<String> names = new LinkedHashSet<>();
+        for (int i = 0; i < classNames.length; i++) {
+            if (isSourceClass(i)) names.add(classNames[i]);
+        }
+        return names;
+    }
+
+    /** @return true if only the references into source-class instances were written */
+    public boolean sourceEdgesOnly() {
+        return sourceEdgesOnly;
+    }
+
+    /** @return the number of reachable objects, class mirrors included */
+    public int objectCount() {
+        return objectCount;
+    }
+
+    /** @return the number of references in the file */
+    public long referenceCount() {
+        return referenceCount;
+    }
+
+    /** @return the class id of an object, or -1 if the walk could not tell */
+    public int objectClass(int objectId) {
+        return objects.buffer(objectId).getInt(objects.position(objectId));
+    }
+
+    /** @return the shallow size of an object in bytes (saturated at 4 GiB - 1) */
+    public long objectSize(int objectId) {
+        return Integer.toUnsignedLong(objects.buffer(objectId).getInt(objects.position(objectId) + 4));
+    }
+
+    /**
+     * Visits every reference in file order, which is the order the walk reported them in.
+     *
+     * @param visitor receives each reference
+     */
+    public void forEachReference(ReferenceVisitor visitor) {
+        Objects.requireNonNull(visitor, "visitor");
+        for (long i = 0; i < referenceCount; i++) {
+            ByteBuffer b = references.buffer(i);
+            int p = references.position(i);
+            visitor.reference(b.getInt(p), b.getInt(p + 4), HeapReferenceKind.fromCode(b.getInt(p + 8)),
+                    b.getInt(p + 12));
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Queries
+    // ---------------------------------------------------------------------------------------------
+
+    /**
+     * Who references the instances of a class.
+     *
+     * @param className the class, in {@link Class#getName()} form
+     * @return the references into its instances, by referring class and root kind
+     * @throws IllegalArgumentException if the class was not loaded when the graph was written
+     */
+    public Referrers referrersOf(String className) {
+        boolean[] target = select(List.of(className), true);
+        long instances = 0;
+        for (int i = 0; i < objectCount; i++) {
+            int k = objectClass(i);
+            if (k >= 0 && target[k]) instances++;
+        }
+        long[] perClass = new long[classNames.length];
+        long[] perRoot = new long[HeapReferenceKind.OTHER.code() + 1];
+        long[] total = { 0 };
+        forEachReference((referrer, referree, kind, index) -> {
+            int k = objectClass(referree);
+            if (k < 0 || !target[k]) return;
+            total[0]++;
+            if (referrer == ROOT) {
+                if (kind != null) perRoot[kind.code()]++;
+                return;
+            }
+            int holderClass = holderClass(referrer, kind);
+            if (holderClass >= 0) perClass[holderClass]++;
+        });
+
+        List<Integer> order = new ArrayList<>();
+        for (int i = 0; i < perClass.length; i++) {
+            if (perClass[i] > 0) order.add(i);
+        }
+        order.sort((a, b) -> Long.compare(perClass[b], perClass[a]));
+        Map<String, Long> byClass = new LinkedHashMap<>();
+        for (int i : order) byClass.merge(classNames[i], perClass[i], Long::sum);
+        return new Referrers(className, instances, total[0], byClass, HeapReferenceKind.countsFromNative(perRoot));
+    }
+
+    /**
+     * The classes whose instances (or static fields) hold a field or array-element reference to
+     * an instance of a source class: the classes a SPEC second pass must cover. The source
+     * classes themselves are left out, since their instances are the ones replaced.
+     *
+     * @param sourceClassNames the source classes, or null / empty for those flagged by the export
+     * @return the class names, the most referencing first
+     */
+    public Set<String> classesToPatch(Collection<String> sourceClassNames) {
+        boolean[] source = sources(sourceClassNames);
+        long[] perClass = new long[classNames.length];
+        forEachReference((referrer, referree, kind, index) -> {
+            if (referrer == ROOT || !patchable(kind)) return;
+            int k = objectClass(referree);
+            if (k < 0 || !source[k]) return;
+            int holderClass = holderClass(referrer, kind);
+            if (holderClass >= 0 && !source[holderClass]) perClass[holderClass]++;
+        });
+        List<Integer> order = new ArrayList<>();
+        for (int i = 0; i < perClass.length; i++) {
+            if (perClass[i] > 0) order.add(i);
+        }
+        order.sort((a, b) -> Long.compare(perClass[b], perClass[a]));
+        Set<String> names = new LinkedHashSet<>();
+        for (int i : order) names.add(classNames[i]);
+        return names;
+    }
+
+    /**
+     * What a SPEC second pass over {@code specClassNames} would visit, and which holders of
+     * references to source instances it would miss.
+     *
+     * <p>Uses one bit per object to count distinct holders.
+     *
+     * @param specClassNames   the classes the SPEC walk is filtered to (exact classes)
+     * @param sourceClassNames the source classes, or null / empty for those flagged by the export
+     * @return the cost estimate
+     */
+    public SpecCost specCost(Collection<String> specClassNames, Collection<String> sourceClassNames) {
+        boolean[] spec = select(specClassNames, false);
+        boolean[] source = sources(sourceClassNames);
+        long walked = 0, walkedBytes = 0, heapBytes = 0;
+        for (int i = 0; i < objectCount; i++) {
+            long size = objectSize(i);
+            heapBytes += size;
+            int k = objectClass(i);
+            if (k >= 0 && spec[k]) {
+                walked++;
+                walkedBytes += size;
+            }
+        }
+
+        long[] seen = new long[(objectCount + 63) >>> 6];
+        long[] holders = { 0, 0 };
+        forEachReference((referrer, referree, kind, index) -> {
+            if (referrer == ROOT || !patchable(kind)) return;
+            int k = objectClass(referree);
+            if (k < 0 || !source[k]) return;
+            long bit = 1L << referrer;
+            if ((seen[referrer >>> 6] & bit) != 0) return;
+            seen[referrer >>> 6] |= bit;
+            holders[0]++;
+            int holderClass = holderClass(referrer, kind);
+            if (holderClass < 0 || !spec[holderClass]) holders[1]++;
+        });
+        return new SpecCost(walked, walkedBytes, holders[0], holders[1], objectCount, heapBytes);
+    }
+
+    /**
+     * The class a reference is attributed to: for a static field, the class that declares it
+     * (the referrer is its mirror); otherwise the referrer's class.
+     */
+    private int holderClass(int referrer, HeapReferenceKind kind) {
+        if (kind == HeapReferenceKind.STATIC_FIELD && referrer < classNames.length) return referrer;
+        return objectClass(referrer);
+    }
+
+    /** References the patcher rewrites: instance fields, array elements and static fields. */
+    private static boolean patchable(HeapReferenceKind kind) {
+        return kind == HeapReferenceKind.FIELD || kind == HeapReferenceKind.ARRAY_ELEMENT
+                || kind == HeapReferenceKind.STATIC_FIELD;
+    }
+
+    /** The source-class selection: the given names, or the classes flagged by the export. */
+    private boolean[] sources(Collection<String> sourceClassNames) {
+        if (sourceClassNames != null && !sourceClassNames.isEmpty()) return select(sourceClassNames, false);
+        boolean[] flagged = new boolean[classNames.length];
+        for (int i = 0; i < flagged.length; i++) flagged[i] = isSourceClass(i);
+        return flagged;
+    }
+
+    /** Marks the class ids of the given names; an unknown name fails only if {@code required}. */
+    private boolean[] select(Collection<String> names, boolean required) {
+        boolean[] selected = new boolean[classNames.length];
+        if (names == null) return selected;
+        for (String name : names) {
+            List<Integer> ids = classIds(name);
+            if (ids.isEmpty() && required) {
+                throw new IllegalArgumentException("Class not in the graph: " + name);
+            }
+            for (int id : ids) selected[id] = true;
+        }
+        return selected;
+    }
+
+    @Override
+    public void close() throws IOException {
+        channel.close();
+    }
+
+    /**
+     * A table of fixed-size records mapped in windows of {@link #WINDOW} bytes, so it may exceed
+     * the 2 GiB limit of a single buffer.
+     */
+    private static final class Table {
+        private final MappedByteBuffer[] windows;
+        private final int recordSize;
+
+        Table(FileChannel channel, ByteOrder order, long offset, long count, int recordSize) throws IOException {
+            this.recordSize = recordSize;
+            long length = count * recordSize;
+            int n = (int) ((length + WINDOW - 1) / WINDOW);
+            windows = new MappedByteBuffer[n];
+            for (int i = 0; i < n; i++) {
+                long start = i * WINDOW;
+                windows[i] = channel.map(FileChannel.MapMode.READ_ONLY, offset + start,
+                        Math.min(WINDOW, length - start));
+                windows[i].order(order);
+            }
+        }
+
+        ByteBuffer buffer(long record) {
+            return windows[(int) (record * recordSize / WINDOW)];
+        }
+
+        int position(long record) {
+            return (int) (record * recordSize % WINDOW);
+        }
+    }
+}
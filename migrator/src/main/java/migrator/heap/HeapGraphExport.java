@@ -0,0 +1,17 @@
+package migrator.heap;
+
+import java.nio.file.Path;
+
+/**
+ * What a reference-graph export wrote. Open the file with {@link HeapGraph#open(Path)}.
+ *
+ * @param file       the file written
+ * @param classes    the loaded classes in its class table
+ * @param objects    the reachable objects numbered by the walk
+ * @param references the references written (only those into source-class instances when the
+ *                   export was restricted to them)
+ * @param bytes      the size of the file
+ * @see HeapWalker#exportReferenceGraph(Path, java.util.Collection, boolean)
+ */
+public record HeapGraphExport(Path file, long classes, long objects, long references, long bytes) {
+}
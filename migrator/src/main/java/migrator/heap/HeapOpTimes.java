@@ -0,0 +1,95 @@
+package migrator.heap;
+
+import java.util.Locale;
+
+/**
+ * Time spent in native heap operations, split into the tagging step (the heap iteration that
+ * marks matches) and the resolve step (turning tagged objects back into references).
+ *
+ * <p>Heap iterations run as VM operations at a safepoint, so every application thread is stopped
+ * for their whole duration. {@code safepointNanos} is the time spent inside the JVMTI call itself:
+ * for tagging, the pause the application sees; for resolving, how long a safepoint could have
+ * been held off by the tag-map scan. {@code wallNanos} covers the whole step, including the
+ * bookkeeping around the call (class marking, building result arrays). Readings are cumulative
+ * (for the native walker, since the agent loaded); take differences with {@link #minus(HeapOpTimes)}.
+ *
+ * @param tagCalls              tagging steps run
+ * @param tagWallNanos          wall time of the tagging steps
+ * @param tagSafepointNanos     time the tagging steps held the application at a safepoint
+ * @param resolveCalls          resolve steps run
+ * @param resolveWallNanos      wall time of the resolve steps
+ * @param resolveSafepointNanos time the resolve steps spent in the JVMTI tag-map scan
+ * @see HeapWalker#opTimes()
+ */
+public record HeapOpTimes(long tagCalls, long tagWallNanos, long tagSafepointNanos,
+                          long resolveCalls, long resolveWallNanos, long resolveSafepointNanos) {
+
+    /** No native operation has run, or the walker does not measure them. */
+    public static final HeapOpTimes NONE = new HeapOpTimes(0, 0, 0, 0, 0, 0);
+
+    /**
+     * Builds the times reported by the native agent.
+     *
+     * @param raw {@code long[] { tagCalls, tagWall, tagSafepoint, resolveCalls, resolveWall,
+     *            resolveSafepoint }} (null means none)
+     * @return the times
+     */
+    static HeapOpTimes fromNative(long[] raw) {
+        if (raw == null || raw.length < 6) return NONE;
+        return new HeapOpTimes(raw[0], raw[1], raw[2], raw[3], raw[4], raw[5]);
+    }
+
+    /**
+     * @param earlier an earlier reading of the same counters (null means {@link #NONE})
+     * @return the operations run since {@code earlier}
+     */
+    public HeapOpTimes minus(HeapOpTimes earlier) {
+        if (earlier == null) return this;
+        return new HeapOpTimes(
+                tagCalls - earlier.tagCalls, tagWallNanos - earlier.tagWallNanos,
+                tagSafepointNanos - earlier.tagSafepointNanos,
+                resolveCalls - earlier.resolveCalls, resolveWallNanos - earlier.resolveWallNanos,
+                resolveSafepointNanos - earlier.resolveSafepointNanos);
+    }
+
+    /**
+     * @param other further operations (null means {@link #NONE})
+     * @return the sum of both
+     */
+    public HeapOpTimes plus(HeapOpTimes other) {
+        if (other == null) return this;
+        return new HeapOpTimes(
+                tagCalls + other.tagCalls, tagWallNanos + other.tagWallNanos,
+                tagSafepointNanos + other.tagSafepointNanos,
+                resolveCalls + other.resolveCalls, resolveWallNanos + other.resolveWallNanos,
+                resolveSafepointNanos + other.resolveSafepointNanos);
+    }
+
+    /** @return true if no native operation ran. */
+    public boolean isEmpty() {
+        return tagCalls == 0 && resolveCalls == 0;
+    }
+
+    /** @return the wall time of both steps, in nanoseconds. */
+    public long wallNanos() {
+        return tagWallNanos + resolveWallNanos;
+    }
+
+    /** @return the safepoint time of both steps, in nanoseconds. */
+    public long safepointNanos() {
+        return tagSafepointNanos + resolveSafepointNanos;
+    }
+
+    /** @return a one-line description for logs, e.g. {@code "safepoint 12.3ms of 15.0ms (tag 10.1/11.0ms x2, resolve 2.2/4.0ms x2)"} */
+    public String describe() {
+        return String.format(Locale.ROOT, "safepoint %.1fms of %.1fms (tag %.1f/%.1fms x%d, resolve %.1f/%.1fms x%d)",
+                millis(safepointNanos()), millis(wallNanos()),
+                millis(tagSafepointNanos), millis(tagWallNanos), tagCalls,
+                millis(resolveSafepointNanos), millis(resolveWallNanos), resolveCalls);
+    }
+
+    /** @return nanoseconds as fractional milliseconds */
+    public static double millis(long nanos) {
+        return nanos / 1_000_000.0;
+    }
+}
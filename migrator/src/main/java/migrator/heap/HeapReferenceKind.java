@@ -0,0 +1,99 @@
+package migrator.heap;
+
+import java.util.EnumMap;
+import java.util.Map;
+
+/**
+ * Kinds of heap references reported by a referrer walk, mirroring JVMTI's
+ * {@code jvmtiHeapReferenceKind}.
+ *
+ * <p>Object-to-object kinds ({@link #FIELD}, {@link #ARRAY_ELEMENT}, {@link #STATIC_FIELD}, …)
+ * have a holder that the patcher can rewrite. Root kinds ({@link #isRoot()}) — stack locals, JNI
+ * references, monitors — have no holder object on the heap and cannot be patched reflectively.
+ *
+ * @see HeapReferrers
+ * @see HeapWalker#findReferrers(java.util.Collection)
+ */
+public enum HeapReferenceKind {
+    /** Reference from an object to its class. */
+    CLASS(1),
+    /** Reference from an object to the value of one of its instance fields. */
+    FIELD(2),
+    /** Reference from an array to one of its elements. */
+    ARRAY_ELEMENT(3),
+    /** Reference from a class to its class loader. */
+    CLASS_LOADER(4),
+    /** Reference from a class to its signers array. */
+    SIGNERS(5),
+    /** Reference from a class to its protection domain. */
+    PROTECTION_DOMAIN(6),
+    /** Reference from a class to one of its interfaces. */
+    INTERFACE(7),
+    /** Reference from a class to the value of one of its static fields. */
+    STATIC_FIELD(8),
+    /** Reference from a class to a resolved entry in its constant pool. */
+    CONSTANT_POOL(9),
+    /** Reference from a class to its superclass. */
+    SUPERCLASS(10),
+    /** Heap root: JNI global reference. */
+    JNI_GLOBAL(21),
+    /** Heap root: system class. */
+    SYSTEM_CLASS(22),
+    /** Heap root: monitor. */
+    MONITOR(23),
+    /** Heap root: local variable on a thread stack. */
+    STACK_LOCAL(24),
+    /** Heap root: JNI local reference. */
+    JNI_LOCAL(25),
+    /** Heap root: thread. */
+    THREAD(26),
+    /** Heap root: other. */
+    OTHER(27);
+
+    private final int code;
+
+    HeapReferenceKind(int code) {
+        this.code = code;
+    }
+
+    /** @return the JVMTI {@code jvmtiHeapReferenceKind} value. */
+    public int code() {
+        return code;
+    }
+
+    /** @return true for root kinds, which have no holder object that could be patched. */
+    public boolean isRoot() {
+        return code >= JNI_GLOBAL.code;
+    }
+
+    /**
+     * Maps a JVMTI reference-kind value to its constant.
+     *
+     * @param code the {@code jvmtiHeapReferenceKind} value
+     * @return the matching kind, or null for an unknown value
+     */
+    public static HeapReferenceKind fromCode(int code) {
+        for (HeapReferenceKind kind : values()) {
+            if (kind.code == code) return kind;
+        }
+        return null;
+    }
+
+    /**
+     * Maps a native per-kind counter array (index = JVMTI reference-kind value) to counts,
+     * dropping zero and unknown entries.
+     *
+     * @param rawCounts the counter array (null means no references)
+     * @return the non-zero counts per kind
+     */
+    static Map<HeapReferenceKind, Long> countsFromNative(long[] rawCounts) {
+        Map<HeapReferenceKind, Long> counts = new EnumMap<>(HeapReferenceKind.class);
+        if (rawCounts != null) {
+            for (int code = 0; code < rawCounts.length; code++) {
+                HeapReferenceKind kind = fromCode(code);
+                if (kind != null && rawCounts[code] > 0) counts.put(kind, rawCounts[code]);
+            }
+        }
+        return counts;
+    }
+}
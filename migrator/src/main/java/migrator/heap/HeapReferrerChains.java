@@ -0,0 +1,65 @@
+package migrator.heap;
+
+import java.util.ArrayList;
+import java.util.List;
+
+/**
+ * Result of a referrer-chain walk: the holders of the walk's targets and, through the holders
+ * of the climbed classes, the holders up each chain to one that is not climbed (an anchor).
+ *
+ * <p>A holder is found on the first level it is met at, as by one {@link HeapWalker#findReferrers
+ * referrer walk} per level: an anchor of the first level references a target itself; an anchor of
+ * a later level references a climbed holder (and may reference a target too). A climbed holder is
+ * climbed once. Climbed holders that have not reached an anchor when the walk's depth runs out
+ * are its open ends.
+ *
+ * @param referrers     every holder on a chain, each once, with the number of references into the
+ *                      targets per kind (roots included)
+ * @param directAnchors the anchors that reference a target
+ * @param linkedAnchors the anchors that reference a climbed holder
+ * @param openEnds      the climbed holders still without an anchor after the last level
+ * @see HeapWalker#findReferrerChains(java.util.Collection, java.util.function.Predicate, int, long)
+ */
+public record HeapReferrerChains(HeapReferrers referrers, List<Object> directAnchors,
+                                 List<Object> linkedAnchors, List<Object> openEnds) {
+
+    /** An empty result: no holders, no references. */
+    public static final HeapReferrerChains EMPTY =
+            new HeapReferrerChains(HeapReferrers.EMPTY, List.of(), List.of(), List.of());
+
+    /** Role bit of a direct anchor (CHAIN_DIRECT in agent.c). */
+    static final int DIRECT = 0x01;
+    /** Role bit of a linked anchor (CHAIN_LINKED in agent.c). */
+    static final int LINKED = 0x02;
+    /** Role bit of an open end (CHAIN_OPEN in agent.c). */
+    static final int OPEN = 0x04;
+
+    /** Null-guards the components and freezes the lists. */
+    public HeapReferrerChains {
+        referrers = referrers != null ? referrers : HeapReferrers.EMPTY;
+        directAnchors = directAnchors != null ? List.copyOf(directAnchors) : List.of();
+        linkedAnchors = linkedAnchors != null ? List.copyOf(linkedAnchors) : List.of();
+        openEnds = openEnds != null ? List.copyOf(openEnds) : List.of();
+    }
+
+    /**
+     * Builds the result from the arrays filled by the native agent.
+     *
+     * @param holders   every holder on a chain (null means none)
+     * @param roles     the role bits of each holder, parallel to {@code holders}
+     * @param rawCounts the counter array, indexed by {@code jvmtiHeapReferenceKind}
+     * @return the result
+     */
+    static HeapReferrerChains fromNative(Object[] holders, byte[] roles, long[] rawCounts) {
+        List<Object> direct = new ArrayList<>();
+        List<Object> linked = new ArrayList<>();
+        List<Object> open = new ArrayList<>();
+        int n = holders != null && roles != null ? Math.min(holders.length, roles.length) : 0;
+        for (int i = 0; i < n; i++) {
+            if ((roles[i] & DIRECT) != 0) direct.add(holders[i]);
+            if ((roles[i] & LINKED) != 0) linked.add(holders[i]);
+            if ((roles[i] & OPEN) != 0) open.add(holders[i]);
+        }
+        return new HeapReferrerChains(HeapReferrers.fromNative(holders, rawCounts), direct, linked, open);
+    }
+}
@@ -0,0 +1,57 @@
+package migrator.heap;
+
+import java.util.Collections;
+import java.util.EnumMap;
+import java.util.Map;
+
+/**
+ * Result of a referrer walk: the objects that directly hold a reference to any of the walk's
+ * targets, plus a count of those references per {@link HeapReferenceKind}.
+ *
+ * <p>Holders are instances for field and array-element references, and {@link Class} objects
+ * for static-field references. References from heap roots (stack locals, JNI references) have
+ * no holder and appear only in the counts.
+ *
+ * @param holders         the distinct holder objects (never null, may be empty)
+ * @param referenceCounts number of references into the targets, per kind
+ * @see HeapWalker#findReferrers(java.util.Collection)
+ */
+public record HeapReferrers(Object[] holders, Map<HeapReferenceKind, Long> referenceCounts) {
+
+    /** An empty result: no holders, no references. */
+    public static final HeapReferrers EMPTY = new HeapReferrers(new Object[0], Map.of());
+
+    /** Null-guards both components and freezes the counts. */
+    public HeapReferrers {
+        holders = holders != null ? holders : new Object[0];
+        referenceCounts = (referenceCounts == null || referenceCounts.isEmpty())
+                ? Map.of()
+                : Collections.unmodifiableMap(new EnumMap<>(referenceCounts));
+    }
+
+    /**
+     * Builds a result from the raw per-kind counter array filled by the native agent
+     * (index = JVMTI reference-kind value).
+     *
+     * @param holders   the resolved holders (null means none)
+     * @param rawCounts the counter array, indexed by {@code jvmtiHeapReferenceKind}
+     * @return the result
+     */
+    static HeapReferrers fromNative(Object[] holders, long[] rawCounts) {
+        return new HeapReferrers(holders, HeapReferenceKind.countsFromNative(rawCounts));
+    }
+
+    /** @return the number of references of the given kind (0 if none). */
+    public long referenceCount(HeapReferenceKind kind) {
+        return referenceCounts.getOrDefault(kind, 0L);
+    }
+
+    /** @return the number of references held by heap roots, which cannot be patched. */
+    public long rootReferenceCount() {
+        long n = 0;
+        for (Map.Entry<HeapReferenceKind, Long> e : referenceCounts.entrySet()) {
+            if (e.getKey().isRoot()) n += e.getValue();
+        }
+        return n;
+    }
+}
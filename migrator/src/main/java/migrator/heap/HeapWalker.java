@@ -1,7 +1,17 @@
 package migrator.heap;
 
+import java.nio.file.Path;
+import java.util.Arrays;
 import java.util.Collection;
+import java.util.Collections;
+import java.util.HashSet;
+import java.util.IdentityHashMap;
+import java.util.LinkedHashMap;
+import java.util.Map;
+import java.util.Objects;
 import java.util.Set;
+import java.util.function.Consumer;
+import java.util.function.Predicate;
 
 import migrator.exceptions.MigrateException;
 
@@ -10,12 +20,25 @@ import migrator.exceptions.MigrateException;
  *
  * <p>Implementations of this interface provide mechanisms to:
  * <ul>
- *   <li>Take snapshots of all objects of a given class type</li>
- *   <li>Walk the entire heap or a filtered subset</li>
+ *   <li>Take snapshots of all objects of a given class type, or of several types at once</li>
+ *   <li>Walk the entire heap or a filtered subset, whole or streamed in bounded chunks</li>
+ *   <li>Walk the entire heap without the objects that can hold no reference (leaves)</li>
+ *   <li>Snapshot or walk only the objects reachable from the heap roots, leaving out garbage
+ *       that has not been collected yet</li>
+ *   <li>Count instances and shallow bytes per class without resolving any object</li>
+ *   <li>Count how many of a set of objects the garbage collector has freed, and when</li>
+ *   <li>Find the objects that hold references to a given set of objects</li>
+ *   <li>Rewrite the slots of known holders that reference migrated objects</li>
+ *   <li>Verify that nothing still reaches the migrated objects, with the root paths that do</li>
+ *   <li>Export the reachable heap's reference graph to a file for offline planning</li>
+ *   <li>Keep a traversal's visited marks, or the dense index of a chunked walk's objects, outside
+ *       the Java heap</li>
+ *   <li>Report the progress of a running walk, and cancel it</li>
  * </ul>
  *
  * <p>The primary implementation is {@link NativeHeapWalker}, which uses JNI
- * for efficient heap traversal.
+ * for efficient heap traversal. {@link ForeignHeapWalker} binds its statistics calls through
+ * {@code java.lang.foreign} instead (JDK 22+).
  *
  * <p><strong>Error handling:</strong> native-backed implementations require the native
  * library to be loaded. If it is missing, calls may fail with an unchecked error (e.g.
@@ -26,6 +49,17 @@ import migrator.exceptions.MigrateException;
  */
 public interface HeapWalker {
 
+    /**
+     * Chunk size of a chunked walk that derives its chunks from the number of objects it
+     * matches: about {@link #DERIVED_CHUNKS} chunks of similar size, however large the walk. A
+     * native walk scans its tag map once per chunk, so this keeps the scans a small constant
+     * where a fixed chunk size multiplies them with the heap.
+     */
+    int DERIVED_CHUNK_SIZE = 0;
+
+    /** The number of chunks a {@link #DERIVED_CHUNK_SIZE} walk aims for (the agent's CHUNK_DERIVED_COUNT). */
+    int DERIVED_CHUNKS = 8;
+
     /**
      * Takes a snapshot of all objects of a given class type and returns them directly.
      *
@@ -37,6 +71,26 @@ public interface HeapWalker {
      */
     Object[] snapshotObjects(Class<?> targetClass);
 
+    /**
+     * Takes a snapshot of the instances of several classes at once, partitioned by class.
+     *
+     * <p>Matching is on the exact class, as for {@link #snapshotObjects(Class)}. Native
+     * implementations answer from a single heap walk, so the cost does not grow with the number
+     * of classes; the default implementation takes one snapshot per class.
+     *
+     * @param classes the classes to snapshot (null elements and duplicates are ignored)
+     * @return the live instances of each distinct class, in encounter order (never null; every
+     *         requested class has an entry, possibly an empty array)
+     */
+    default Map<Class<?>, Object[]> snapshotPartitioned(Collection<Class<?>> classes) {
+        Map<Class<?>, Object[]> result = new LinkedHashMap<>();
+        if (classes == null) return result;
+        for (Class<?> cls : classes) {
+            if (cls != null && !result.containsKey(cls)) result.put(cls, snapshotObjects(cls));
+        }
+        return result;
+    }
+
     /**
      * Walk the entire heap and return all live objects.
      *
@@ -61,4 +115,557 @@ public interface HeapWalker {
      * @throws MigrateException if the heap walk fails (e.g., native library not loaded)
      */
     Set<Object> walkHeap(Collection<Class<?>> classes) throws MigrateException;
+
+    /**
+     * Walk the entire heap and hand the live objects to {@code chunkSink} in chunks of at most
+     * {@code chunkSize}, in the caller's thread.
+     *
+     * <p>Unlike {@link #walkHeap()}, the result is never materialized as a whole: native
+     * implementations resolve one chunk per call, so the walk's memory (JNI references, result
+     * arrays) is bounded by the chunk size rather than by the heap. Each object is delivered
+     * once; objects that die during the walk may be missing. The default implementation slices
+     * the result of {@link #walkHeap()}.
+     *
+     * <p>With {@link #DERIVED_CHUNK_SIZE} the walk picks its chunk size once it knows how many
+     * objects it matched, about a {@link #DERIVED_CHUNKS}-th of them: the walk's memory is then
+     * bounded by that fraction of the walk instead of by a fixed size.
+     *
+     * @param chunkSink receives each chunk (never null or empty); an exception it throws aborts
+     *                  the walk and propagates
+     * @param chunkSize the maximum number of objects per chunk (positive), or
+     *                  {@link #DERIVED_CHUNK_SIZE} to derive it from the walk's size
+     * @return the number of objects delivered
+     * @throws MigrateException if the heap walk fails
+     */
+    default long walkHeap(Consumer<Object[]> chunkSink, int chunkSize) throws MigrateException {
+        checkChunkArgs(chunkSink, chunkSize);
+        return deliverInChunks(walkHeap(), chunkSink, chunkSize);
+    }
+
+    /**
+     * Walk the heap for instances of the specified classes and hand them to {@code chunkSink} in
+     * chunks of at most {@code chunkSize}; the filtered counterpart of
+     * {@link #walkHeap(Consumer, int)}.
+     *
+     * @param classes   the classes to filter for (null or empty delivers nothing)
+     * @param chunkSink receives each chunk (never null or empty); an exception it throws aborts
+     *                  the walk and propagates
+     * @param chunkSize the maximum number of objects per chunk (positive), or
+     *                  {@link #DERIVED_CHUNK_SIZE} to derive it from the walk's size
+     * @return the number of objects delivered
+     * @throws MigrateException if the heap walk fails
+     */
+    default long walkHeap(Collection<Class<?>> classes, Consumer<Object[]> chunkSink, int chunkSize)
+            throws MigrateException {
+        checkChunkArgs(chunkSink, chunkSize);
+        return deliverInChunks(walkHeap(classes), chunkSink, chunkSize);
+    }
+
+    /**
+     * Walk the entire heap like {@link #walkHeap()}, but without leaves: primitive arrays and
+     * instances of exactly the given classes. Leaves can never hold a reference to a migrated
+     * object, so a patcher gains nothing from them; on a typical heap they are most objects.
+     *
+     * <p>The default implementation filters the result of {@link #walkHeap()}; native
+     * implementations skip leaves while tagging, so they are never resolved at all.
+     *
+     * @param leafClasses classes whose instances hold no reference to any migrated object
+     *                    (null means primitive arrays only)
+     * @return an identity-based set of the live objects that are not leaves
+     * @throws MigrateException if the heap walk fails
+     */
+    default Set<Object> walkHeapSkippingLeaves(Collection<Class<?>> leafClasses) throws MigrateException {
+        Set<Class<?>> leaves = leafSet(leafClasses);
+        Set<Object> result = Collections.newSetFromMap(new IdentityHashMap<>());
+        for (Object o : walkHeap()) {
+            if (o != null && !isLeaf(o, leaves)) result.add(o);
+        }
+        return result;
+    }
+
+    /**
+     * Streamed counterpart of {@link #walkHeapSkippingLeaves(Collection)}: walk the entire heap
+     * without leaves and hand the objects to {@code chunkSink} in chunks of at most
+     * {@code chunkSize}, as {@link #walkHeap(Consumer, int)} does.
+     *
+     * <p>The default implementation filters each chunk of {@link #walkHeap(Consumer, int)}, so its
+     * chunks may be smaller than {@code chunkSize}.
+     *
+     * @param leafClasses classes whose instances hold no reference to any migrated object
+     *                    (null means primitive arrays only)
+     * @param chunkSink   receives each chunk (never null or empty); an exception it throws aborts
+     *                    the walk and propagates
+     * @param chunkSize   the maximum number of objects per chunk (positive), or
+     *                    {@link #DERIVED_CHUNK_SIZE} to derive it from the walk's size
+     * @return the number of objects delivered
+     * @throws MigrateException if the heap walk fails
+     */
+    default long walkHeapSkippingLeaves(Collection<Class<?>> leafClasses, Consumer<Object[]> chunkSink,
+                                        int chunkSize) throws MigrateException {
+        checkChunkArgs(chunkSink, chunkSize);
+        Set<Class<?>> leaves = leafSet(leafClasses);
+        long[] delivered = {0};
+        walkHeap(chunk -> {
+            Object[] kept = new Object[chunk.length];
+            int n = 0;
+            for (Object o : chunk) {
+                if (o != null && !isLeaf(o, leaves)) kept[n++] = o;
+            }
+            if (n == 0) return;
+            delivered[0] += n;
+            chunkSink.accept(n == kept.length ? kept : Arrays.copyOf(kept, n));
+        }, chunkSize);
+        return delivered[0];
+    }
+
+    /**
+     * Takes a snapshot like {@link #snapshotPartitioned(Collection)}, but of the instances
+     * reachable from the heap roots only. A heap snapshot also returns the unreachable instances
+     * that no GC has reclaimed yet; migrating them wastes a migrator call, an allocation and
+     * patching work per dead object, and forcing a full GC first costs a pause proportional to the
+     * heap. Native implementations follow references from the roots instead, at a cost
+     * proportional to the live data.
+     *
+     * <p>The default implementation cannot tell reachable instances from garbage and returns
+     * {@link #snapshotPartitioned(Collection)}.
+     *
+     * @param classes the classes to snapshot (null elements and duplicates are ignored)
+     * @return the reachable instances of each distinct class, in encounter order (never null;
+     *         every requested class has an entry, possibly an empty array)
+     */
+    default Map<Class<?>, Object[]> snapshotReachable(Collection<Class<?>> classes) {
+        return snapshotPartitioned(classes);
+    }
+
+    /**
+     * Walk the objects reachable from the heap roots: {@link #walkHeap()} without the garbage
+     * that has not been collected yet, optionally without leaves as for
+     * {@link #walkHeapSkippingLeaves(Collection)}.
+     *
+     * <p>The default implementation cannot tell reachable objects from garbage and walks the
+     * whole heap.
+     *
+     * @param leafClasses null to return every reachable object; otherwise primitive arrays and
+     *                    instances of exactly these classes are left out
+     * @return an identity-based set of the reachable objects
+     * @throws MigrateException if the heap walk fails
+     */
+    default Set<Object> walkReachable(Collection<Class<?>> leafClasses) throws MigrateException {
+        return leafClasses == null ? walkHeap() : walkHeapSkippingLeaves(leafClasses);
+    }
+
+    /**
+     * Streamed counterpart of {@link #walkReachable(Collection)}: hand the reachable objects to
+     * {@code chunkSink} in chunks of at most {@code chunkSize}, as {@link #walkHeap(Consumer, int)}
+     * does.
+     *
+     * <p>The default implementation cannot tell reachable objects from garbage and walks the
+     * whole heap.
+     *
+     * @param leafClasses null to deliver every reachable object; otherwise primitive arrays and
+     *                    instances of exactly these classes are left out
+     * @param chunkSink   receives each chunk (never null or empty); an exception it throws aborts
+     *                    the walk and propagates
+     * @param chunkSize   the maximum number of objects per chunk (positive), or
+     *                    {@link #DERIVED_CHUNK_SIZE} to derive it from the walk's size
+     * @return the number of objects delivered
+     * @throws MigrateException if the heap walk fails
+     */
+    default long walkReachable(Collection<Class<?>> leafClasses, Consumer<Object[]> chunkSink, int chunkSize)
+            throws MigrateException {
+        return leafClasses == null
+                ? walkHeap(chunkSink, chunkSize)
+                : walkHeapSkippingLeaves(leafClasses, chunkSink, chunkSize);
+    }
+
+    /**
+     * Takes a snapshot like {@link #snapshotPartitioned(Collection)}, but of the instances
+     * reachable from {@code roots} only: the roots themselves and what their instance fields and
+     * array elements lead to, transitively. Class, class-loader and static-field references are
+     * not followed, so state reached only through a class's statics is out of scope.
+     *
+     * <p>This is the walk of one subgraph, such as one tenant's state under its root object, at a
+     * cost proportional to the subgraph rather than the heap.
+     *
+     * <p>The default implementation does not support root-scoped walks and throws.
+     *
+     * @param roots   the objects to start from (null elements are ignored)
+     * @param classes the classes to snapshot (null elements and duplicates are ignored)
+     * @return the instances of each distinct class reachable from the roots, in encounter order
+     *         (never null; every requested class has an entry, possibly an empty array)
+     * @throws MigrateException if the walk fails or is not supported by this implementation
+     */
+    default Map<Class<?>, Object[]> snapshotReachableFrom(Collection<?> roots, Collection<Class<?>> classes)
+            throws MigrateException {
+        throw new MigrateException(getClass().getSimpleName() + " does not support root-scoped walks");
+    }
+
+    /**
+     * Walk the objects reachable from {@code roots} through instance fields and array elements,
+     * the roots included, as {@link #snapshotReachableFrom(Collection, Collection)} scopes them:
+     * the objects a patcher has to visit to patch one subgraph.
+     *
+     * <p>The default implementation does not support root-scoped walks and throws.
+     *
+     * @param roots       the objects to start from (null elements are ignored)
+     * @param leafClasses null to return every object reached; otherwise primitive arrays and
+     *                    instances of exactly these classes are left out
+     * @return an identity-based set of the objects reached
+     * @throws MigrateException if the walk fails or is not supported by this implementation
+     */
+    default Set<Object> walkReachableFrom(Collection<?> roots, Collection<Class<?>> leafClasses)
+            throws MigrateException {
+        throw new MigrateException(getClass().getSimpleName() + " does not support root-scoped walks");
+    }
+
+    /**
+     * Count the instances of each class, with their total shallow size and (for arrays) their
+     * length distribution, in one heap pass that resolves no objects.
+     *
+     * <p>This is the cheap way to size a migration before it starts: unlike a snapshot, it
+     * allocates nothing proportional to the number of instances. Matching is on the exact class.
+     *
+     * <p>The default implementation does not support a census and throws, so callers skip it.
+     *
+     * @param classes the classes to count, or null / empty for every loaded class
+     * @return the per-class histogram (never null)
+     * @throws MigrateException if the walk fails or is not supported by this implementation
+     */
+    default HeapCensus census(Collection<Class<?>> classes) throws MigrateException {
+        throw new MigrateException(getClass().getSimpleName() + " does not support a heap census");
+    }
+
+    /**
+     * Start counting how many of the given objects the garbage collector frees, and when, without
+     * keeping any of them alive. Progress is read with {@link #reclamationProgress()} until the
+     * tracker is stopped or replaced.
+     *
+     * <p>Only one tracker is active at a time; starting one replaces the previous tracker and
+     * restarts the counts.
+     *
+     * <p>The default implementation cannot track reclamation and returns false.
+     *
+     * @param objects the objects to track (null elements are ignored)
+     * @return true if tracking started, false if it is not available
+     */
+    default boolean startReclamationTracking(Collection<?> objects) {
+        return false;
+    }
+
+    /**
+     * Report the progress of the active tracker, or the final counts of the last one stopped.
+     *
+     * @return the progress, or {@link ReclamationProgress#NONE} if no tracker has run (never null)
+     */
+    default ReclamationProgress reclamationProgress() {
+        return ReclamationProgress.NONE;
+    }
+
+    /**
+     * Stop the active reclamation tracker, if any. Its last counts stay readable through
+     * {@link #reclamationProgress()}, and frees after this call are no longer counted.
+     */
+    default void stopReclamationTracking() {
+    }
+
+    /**
+     * Find the objects that directly reference any of the given targets.
+     *
+     * <p>Unlike the class-based walks, the cost of a referrer walk is independent of which
+     * classes hold the targets: it follows references from the heap roots once and reports
+     * only the actual holders. Static-field holders are reported as their declaring
+     * {@link Class}; references held only by roots (stack locals, JNI references) appear in
+     * the per-kind counts but have no holder.
+     *
+     * <p>The default implementation does not support referrer discovery and throws, so callers
+     * fall back to a class-based walk.
+     *
+     * @param targets the objects whose referrers to find (null or empty returns an empty result)
+     * @return the holders and per-kind reference counts (never null)
+     * @throws MigrateException if the walk fails or is not supported by this implementation
+     */
+    default HeapReferrers findReferrers(Collection<?> targets) throws MigrateException {
+        throw new MigrateException(getClass().getSimpleName() + " does not support referrer walks");
+    }
+
+    /**
+     * Find the holders of the given targets and, for every holder whose class is climbed, that
+     * holder's own holders in turn, up to {@code maxDepth} levels, in one walk.
+     *
+     * <p>The result is the one {@link #findReferrers} would give called once per level on the
+     * climbed holders first found on the level before, but the heap is walked once instead of
+     * once per level: the walk records the references into every instance of a climbed class
+     * and climbs the recorded references afterwards. That record costs memory in proportion to
+     * the references into climbed instances anywhere on the heap, not only on the chains, so it
+     * is capped at {@code maxEdges} references: a walk that would record more fails, as does one
+     * that runs out of memory.
+     *
+     * <p>The default implementation does not support chain walks and throws, so callers fall back
+     * to a {@link #findReferrers} walk per level.
+     *
+     * @param targets  the objects whose referrers to find (null or empty returns an empty result)
+     * @param climbed  true for a class whose instances are climbed through rather than reported
+     *                 as anchors; {@link Class} objects are always anchors
+     * @param maxDepth the number of levels to climb
+     * @param maxEdges the most references into the targets and climbed instances to record
+     * @return the holders by role and the per-kind reference counts into the targets (never null)
+     * @throws MigrateException if the walk fails, exceeds {@code maxEdges}, or is not supported by
+     *                          this implementation
+     */
+    default HeapReferrerChains findReferrerChains(Collection<?> targets, Predicate<Class<?>> climbed, int maxDepth,
+                                                  long maxEdges) throws MigrateException {
+        throw new MigrateException(getClass().getSimpleName() + " does not support referrer-chain walks");
+    }
+
+    /**
+     * Rewrite, in the given holders, every field, static field and array element that references
+     * {@code oldObjects[i]} with {@code newObjects[i]}.
+     *
+     * <p>This is the native counterpart of reflective patching for plain holders: slots are found
+     * in one reference traversal and written directly, so no per-field reflective get/set runs.
+     * Holders are instances or arrays, or {@link Class} objects for static fields. Slots that
+     * cannot be rewritten safely are skipped and their holders reported, for the Java patcher to
+     * handle. Holders that need API-level rebuilds (JDK containers, records) must not be passed.
+     *
+     * <p>The default implementation does not support slot patching and throws, so callers fall
+     * back to the Java patcher.
+     *
+     * @param holders    the objects whose slots to rewrite (null or empty returns an empty result)
+     * @param oldObjects the migrated objects
+     * @param newObjects the replacement of each old object, at the same index
+     * @return the slot counts and the holders left for the Java patcher (never null)
+     * @throws MigrateException if the pass fails or is not supported by this implementation
+     */
+    default SlotPatchResult patchSlots(Collection<?> holders, Object[] oldObjects, Object[] newObjects)
+            throws MigrateException {
+        throw new MigrateException(getClass().getSimpleName() + " does not support slot patching");
+    }
+
+    /**
+     * Rewrite, in the frames of the given suspended threads, every local variable that references
+     * {@code oldObjects[i]} with {@code newObjects[i]}.
+     *
+     * <p>Heap patching cannot see stack frames, so without this a thread frozen mid-request keeps
+     * using old objects after it resumes. The threads must stay suspended for the whole call. A
+     * local is only written when the VM can check that the replacement fits its declared type;
+     * the others are reported with the reason, and references held by threads not passed in are
+     * counted only.
+     *
+     * <p>The default implementation does not support stack-local patching and throws, so callers
+     * skip it.
+     *
+     * @param threads    the suspended threads whose frames to patch (null or empty returns an
+     *                   empty result)
+     * @param oldObjects the migrated objects
+     * @param newObjects the replacement of each old object, at the same index
+     * @return the local counts and the locals left unpatched (never null)
+     * @throws MigrateException if the pass fails or is not supported by this implementation
+     */
+    default StackLocalPatchResult patchStackLocals(Collection<Thread> threads, Object[] oldObjects,
+                                                   Object[] newObjects) throws MigrateException {
+        throw new MigrateException(getClass().getSimpleName() + " does not support stack-local patching");
+    }
+
+    /**
+     * Find the given (old) objects that are still reachable from the heap roots, count the
+     * references that keep them so, and report the shortest root path of up to {@code maxPaths}
+     * of them. Meant to run once the patch passes are done, when nothing should reach an old
+     * object any more.
+     *
+     * <p>The caller's own bookkeeping reaches every old object: {@code excluded} objects are
+     * neither reported nor followed, so passing the forwarding table and the migration's working
+     * sets leaves them out. An excluded {@link Thread} also has its stack and JNI-local roots
+     * ignored. The calling thread is always excluded.
+     *
+     * <p>The default implementation does not support verification and throws, so callers skip
+     * it.
+     *
+     * @param oldObjects the objects that should be unreachable (null or empty returns
+     *                   {@link ResidualReferences#NONE})
+     * @param excluded   objects and threads to leave out of the walk (may be null)
+     * @param maxPaths   the number of residual objects to report a root path for
+     * @return the residual objects, references and sample paths (never null)
+     * @throws MigrateException if the walk fails or is not supported by this implementation
+     */
+    default ResidualReferences findResidualReferences(Collection<?> oldObjects, Collection<?> excluded, int maxPaths)
+            throws MigrateException {
+        throw new MigrateException(getClass().getSimpleName() + " does not support residual-reference verification");
+    }
+
+    /**
+     * Find the classes that reference instances of {@code sourceClasses}: those with an instance
+     * holding one in a field or array element, and those declaring a static field holding one.
+     * Climbs nothing: a holder is reported as its exact class, whatever it is.
+     *
+     * @param sourceClasses the classes whose instances are migrated
+     * @return the holder classes (never null)
+     * @throws MigrateException if the walk fails or discovery is not supported by this
+     *                          implementation
+     * @see #findHolderClasses(Collection, Predicate, int)
+     */
+    default HolderClasses findHolderClasses(Collection<Class<?>> sourceClasses) throws MigrateException {
+        return findHolderClasses(sourceClasses, cls -> false, 0);
+    }
+
+    /**
+     * Find the classes that reference instances of {@code sourceClasses}: those with an instance
+     * holding one in a field or array element, and those declaring a static field holding one.
+     * One pass from the heap roots that resolves no objects, so the result is proportional to the
+     * number of classes, never to the heap.
+     *
+     * <p>The instance holders are the classes a SPEC pass has to walk; only references from
+     * reachable objects are counted. Matching of the source classes is on the exact class. A
+     * holder of a class for which {@code climbed} is true (a JDK collection node, a backing array,
+     * a record) cannot be patched by walking its class, so the classes holding its instances are
+     * reported in its place, climbing up to {@code maxDepth} levels as
+     * {@link #findReferrerChains} does. The climb follows classes, not instances: every class
+     * holding an instance of a climbed class that reaches a source is reported, so the result
+     * may be wider than the actual holders, never narrower.
+     *
+     * <p>The default implementation does not support discovery and throws, so callers skip it.
+     *
+     * @param sourceClasses the classes whose instances are migrated
+     * @param climbed       true for a class whose holders are reported in its place
+     * @param maxDepth      the number of levels to climb; a climbed class still held by climbed
+     *                      classes after that is reported itself
+     * @return the holder classes (never null)
+     * @throws MigrateException if the walk fails or discovery is not supported by this
+     *                          implementation
+     */
+    default HolderClasses findHolderClasses(Collection<Class<?>> sourceClasses, Predicate<Class<?>> climbed,
+                                            int maxDepth) throws MigrateException {
+        throw new MigrateException(getClass().getSimpleName() + " does not support holder-class discovery");
+    }
+
+    /**
+     * Write the reference graph of the reachable heap to a file: the loaded classes, the class
+     * and shallow size of every reachable object, and every reference between them, in one walk
+     * from the heap roots. Read it offline with {@link HeapGraph}, without the application.
+     *
+     * <p>The file holds no field values, so it is much smaller than a heap dump, and it can be
+     * cut down further to the references into instances of {@code sourceClasses}: enough to find
+     * who references the source classes and what a SPEC walk would visit.
+     *
+     * <p>The default implementation does not support an export and throws.
+     *
+     * @param file            the file to create or replace
+     * @param sourceClasses   the classes to flag as migration sources (may be null or empty)
+     * @param sourceEdgesOnly true to write only the references into instances of exactly the
+     *                        source classes
+     * @return what was written (never null)
+     * @throws MigrateException if the walk or the write fails, or an export is not supported by
+     *                          this implementation
+     */
+    default HeapGraphExport exportReferenceGraph(Path file, Collection<Class<?>> sourceClasses,
+                                                 boolean sourceEdgesOnly) throws MigrateException {
+        throw new MigrateException(getClass().getSimpleName() + " does not support a reference-graph export");
+    }
+
+    /**
+     * Open a set of visited marks kept outside the Java heap, for the visited set of a large patch
+     * traversal. The caller must {@linkplain VisitMarks#close() close} it.
+     *
+     * <p>The default implementation does not support marks and throws, so callers keep their
+     * marks on the heap.
+     *
+     * @param concurrent true if several threads will mark concurrently
+     * @return the empty set of marks
+     * @throws MigrateException if no set can be opened or marks are not supported by this
+     *                          implementation
+     */
+    default VisitMarks openVisitMarks(boolean concurrent) throws MigrateException {
+        throw new MigrateException(getClass().getSimpleName() + " does not support visit marks");
+    }
+
+    /**
+     * Open a dense index of the next chunked walk: each object the walk delivers keeps its
+     * position in the walk (0, 1, 2, ...) until the walk ends, readable with
+     * {@link WalkIndex#indexOf}. The caller must {@linkplain WalkIndex#close() close} it; at most
+     * one index is open per walker.
+     *
+     * <p>The default implementation does not support an index and throws.
+     *
+     * @return the index, attached to the next chunked walk
+     * @throws MigrateException if an index is already open or indexing is not supported by this
+     *                          implementation
+     */
+    default WalkIndex openWalkIndex() throws MigrateException {
+        throw new MigrateException(getClass().getSimpleName() + " does not support a walk index");
+    }
+
+    /** Validates the arguments of the chunked walks. */
+    private static void checkChunkArgs(Consumer<Object[]> chunkSink, int chunkSize) {
+        Objects.requireNonNull(chunkSink, "chunkSink");
+        if (chunkSize < 0) throw new IllegalArgumentException("chunkSize must not be negative: " + chunkSize);
+    }
+
+    /**
+     * Reports the progress of the most recently started walk. Safe to call from any thread while
+     * the walk runs.
+     *
+     * <p>The default implementation does not track progress and returns {@link WalkProgress#NONE}.
+     *
+     * @return the walk's progress (never null)
+     */
+    default WalkProgress walkProgress() {
+        return WalkProgress.NONE;
+    }
+
+    /**
+     * Asks every walk already running to stop as soon as it can, typically because its caller
+     * timed out. A cancelled walk returns nothing: it throws
+     * {@link java.util.concurrent.CancellationException}. Walks started afterwards are unaffected.
+     *
+     * <p>The default implementation cannot stop a running walk and does nothing; the walk then
+     * runs to completion and its result is discarded by the caller.
+     */
+    default void cancelWalks() {
+    }
+
+    /**
+     * Reports the time spent in native heap operations so far: wall time, and time the
+     * application was held at a safepoint, for the tagging and resolve steps separately. Callers
+     * take the difference of two readings to time a stretch of work.
+     *
+     * <p>The default implementation does not measure and returns {@link HeapOpTimes#NONE}.
+     *
+     * @return the cumulative times (never null)
+     */
+    default HeapOpTimes opTimes() {
+        return HeapOpTimes.NONE;
+    }
+
+    /** Copies the caller's leaf classes into a set, dropping nulls. */
+    private static Set<Class<?>> leafSet(Collection<Class<?>> leafClasses) {
+        Set<Class<?>> leaves = new HashSet<>();
+        if (leafClasses != null) {
+            for (Class<?> c : leafClasses) if (c != null) leaves.add(c);
+        }
+        return leaves;
+    }
+
+    /** True for a primitive array or an instance of exactly one of {@code leaves}. */
+    private static boolean isLeaf(Object o, Set<Class<?>> leaves) {
+        Class<?> cls = o.getClass();
+        return (cls.isArray() && cls.getComponentType().isPrimitive()) || leaves.contains(cls);
+    }
+
+    /** Slices an already-materialized walk result into chunks for the default chunked walks. */
+    private static long deliverInChunks(Collection<Object> objects, Consumer<Object[]> chunkSink, int chunkSize) {
+        if (objects == null || objects.isEmpty()) return 0;
+        if (chunkSize == DERIVED_CHUNK_SIZE) chunkSize = (objects.size() + DERIVED_CHUNKS - 1) / DERIVED_CHUNKS;
+        Object[] chunk = new Object[Math.min(chunkSize, objects.size())];
+        int n = 0;
+        long delivered = 0;
+        for (Object o : objects) {
+            chunk[n++] = o;
+            if (n == chunk.length) {
+                chunkSink.accept(chunk);
+                delivered += n;
+                chunk = new Object[(int) Math.min(chunkSize, objects.size() - delivered)];
+                n = 0;
+            }
+        }
+        return delivered;
+    }
 }
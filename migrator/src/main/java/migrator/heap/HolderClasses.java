@@ -0,0 +1,58 @@
+package migrator.heap;
+
+import java.util.Collections;
+import java.util.LinkedHashSet;
+import java.util.Set;
+
+/**
+ * The classes that hold references to instances of a set of source classes, found by one heap
+ * pass that resolves no objects (see
+ * {@link HeapWalker#findHolderClasses(java.util.Collection, java.util.function.Predicate, int)}).
+ *
+ * <p>These are the classes a SPEC second pass has to walk: an instance holder has at least one
+ * instance with a field or array element referencing a source instance, directly or through
+ * instances of climbed classes; a static owner declares a static field that does. The source
+ * classes themselves are never instance holders.
+ *
+ * <p>The result is a snapshot: a class that starts holding a source instance after the pass is
+ * not in it.
+ *
+ * @param instanceHolders the classes whose instances reference a source instance
+ * @param staticOwners    the classes whose static fields reference a source instance
+ */
+public record HolderClasses(Set<Class<?>> instanceHolders, Set<Class<?>> staticOwners) {
+
+    /** No holders. */
+    public static final HolderClasses EMPTY = new HolderClasses(Set.of(), Set.of());
+
+    /** Null-guards and freezes the sets. */
+    public HolderClasses {
+        instanceHolders = freeze(instanceHolders);
+        staticOwners = freeze(staticOwners);
+    }
+
+    /**
+     * Builds the result from the arrays filled by the native agent.
+     *
+     * @param raw {@code Object[] { Class[] instanceHolders, Class[] staticOwners }} (null means empty)
+     * @return the holder classes
+     */
+    static HolderClasses fromNative(Object[] raw) {
+        if (raw == null || raw.length < 2 || !(raw[0] instanceof Class<?>[] holders)
+                || !(raw[1] instanceof Class<?>[] owners)) {
+            return EMPTY;
+        }
+        return new HolderClasses(Set.of(holders), Set.of(owners));
+    }
+
+    /** @return true if no class holds a source instance */
+    public boolean isEmpty() {
+        return instanceHolders.isEmpty() && staticOwners.isEmpty();
+    }
+
+    private static Set<Class<?>> freeze(Set<Class<?>> classes) {
+        return (classes == null || classes.isEmpty())
+                ? Set.of()
+                : Collections.unmodifiableSet(new LinkedHashSet<>(classes));
+    }
+}
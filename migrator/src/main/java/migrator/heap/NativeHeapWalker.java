@@ -1,10 +1,19 @@
 package migrator.heap;
 
+import java.nio.file.Path;
 import java.util.Collection;
 import java.util.Collections;
 import java.util.IdentityHashMap;
+import java.util.LinkedHashMap;
+import java.util.Map;
 import java.util.Objects;
 import java.util.Set;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicReference;
+import java.util.concurrent.locks.ReadWriteLock;
+import java.util.concurrent.locks.ReentrantReadWriteLock;
+import java.util.function.Consumer;
+import java.util.function.Predicate;
 
 import migrator.exceptions.MigrateException;
 
@@ -14,11 +23,29 @@ import migrator.exceptions.MigrateException;
  * <p>This implementation uses native methods to efficiently walk the JVM heap
  * and locate objects of specific types. It supports:
  * <ul>
- *   <li>Taking snapshots of objects by class type</li>
+ *   <li>Taking snapshots of objects by class type, for many classes in one walk</li>
  *   <li>Bulk resolution of all matched objects in a single native call</li>
- *   <li>Full heap walks returning all live objects</li>
- *   <li>Filtered heap walks for specific classes only</li>
+ *   <li>Full heap walks returning all live objects, or all but the reference-free leaves</li>
+ *   <li>Reachable snapshots and walks that follow references from the heap roots, so
+ *       uncollected garbage is never returned</li>
+ *   <li>Root-scoped snapshots and walks over the instance graph below a set of roots</li>
+ *   <li>Filtered heap walks for specific classes only, in one walk for all classes</li>
+ *   <li>Chunked walks that resolve matches in bounded chunks instead of one array, optionally
+ *       keeping a dense index of the delivered objects in their tags</li>
+ *   <li>Visited marks kept as JVMTI tags in a tagging environment of their own</li>
+ *   <li>Per-class census (counts, shallow bytes, array lengths) without resolving objects</li>
+ *   <li>Reclamation tracking that counts the frees of a set of objects through JVMTI ObjectFree</li>
+ *   <li>Referrer walks that find the holders of a set of objects, and chain walks that climb
+ *       every level up to the holders patchable in place in one walk</li>
+ *   <li>Holder-class discovery finding the classes that reference a set of classes</li>
+ *   <li>Slot patching that rewrites holder references without reflection</li>
+ *   <li>Stack-local patching that rewrites the locals of suspended threads</li>
+ *   <li>Residual-reference verification with the shortest root paths of what is left</li>
+ *   <li>Reference-graph export to a compact file read offline by {@link HeapGraph}</li>
  *   <li>Epoch advancement for tracking migration generations</li>
+ *   <li>Per-walk tagging environments, so no walk leaves tags behind</li>
+ *   <li>Live walk progress and cooperative cancellation of a running walk</li>
+ *   <li>Wall and safepoint time of every tagging and resolve step</li>
  * </ul>
  *
  * <p><strong>Note:</strong> Requires the native migrator library to be loaded.
@@ -27,10 +54,69 @@ import migrator.exceptions.MigrateException;
  */
 public final class NativeHeapWalker implements HeapWalker {
 
+    /** Length of the per-kind counter array filled by a referrer walk (see REFERENCE_KIND_SLOTS in agent.c). */
+    private static final int REFERENCE_KIND_SLOTS = 32;
+
+    /** Length of the stats array filled by slot patching: found, rewritten, skipped (see agent.c). */
+    private static final int SLOT_STAT_COUNT = 3;
+
+    /** Length of the stats array filled by stack-local patching: found, rewritten, other threads (see agent.c). */
+    private static final int LOCAL_STAT_COUNT = 3;
+
+    /** Length of the stats array filled by verification: reached, passes, exact (see agent.c). */
+    private static final int VERIFY_STAT_COUNT = 3;
+
+    /** Length of the stats array filled by a graph export: classes, objects, references (see agent.c). */
+    private static final int GRAPH_STAT_COUNT = 3;
+
+    /** Length of the stats array filled by reclamation tracking (see RECLAIM_STAT_COUNT in agent.c). */
+    private static final int RECLAIM_STAT_COUNT = 8;
+
+    /** Length of the handle array filled by nativeVisitOpen: epoch, environment, raw monitor (see agent.c). */
+    private static final int VISIT_HANDLE_COUNT = 3;
+
+    /** The open walk index, attached to the next chunked walk; null if none. */
+    private final AtomicReference<NativeWalkIndex> walkIndex = new AtomicReference<>();
+
     private static native Object[] nativeSnapshotObjects(Class<?> targetClass);
-    private native Object[] nativeWalkHeap();
+    private static native Object[][] nativeSnapshotPartitioned(Class<?>[] targetClasses, boolean reachable);
+    private static native Object[][] nativeSnapshotPartitionedFrom(Object[] roots, Class<?>[] targetClasses);
+    private static native Object[] nativeWalkFrom(Object[] roots, Class<?>[] leafClasses);
+    private native Object[] nativeWalkHeap(Class<?>[] leafClasses, boolean reachable);
     private native Object[] nativeWalkHeapFiltered(Class<?>[] targetClasses);
+    private static native int nativeTagChunks(Class<?>[] targetClasses, Class<?>[] leafClasses, boolean reachable,
+                                              int chunkSize, long[] walkOut, int[] chunkStarts);
+    private static native Object[] nativeResolveChunk(long walkEnv, long epoch, int firstSlice, int sliceCount,
+                                                      long indexBase);
+    private static native int nativeWalkIndexOf(long walkEnv, long epoch, Object obj);
+    private static native void nativeEndChunks(long walkEnv);
+    private static native boolean nativeVisitOpen(boolean concurrent, long[] visitOut);
+    private static native boolean nativeVisitMark(long visitEnv, long epoch, long lock, Object obj);
+    private static native void nativeVisitClose(long visitEnv, long lock);
+    private static native Object[] nativeCensus(Class<?>[] classes);
+    private static native Object[] nativeFindReferrers(Object[] targets, long[] kindCounts);
+    private static native Class<?>[] nativeLoadedClasses();
+    private static native Object[] nativeFindReferrerChains(Object[] targets, Class<?>[] classes, boolean[] climb,
+                                                            int maxDepth, long maxEdges, long[] kindCounts);
+    private static native Object[] nativeHolderClasses(Class<?>[] sourceClasses, Class<?>[] classes, boolean[] climb,
+                                                       int maxDepth);
+    private static native Object[] nativePatchSlots(Object[] holders, Object[] oldObjects, Object[] newObjects, long[] stats);
+    private static native Object[] nativePatchStackLocals(Thread[] threads, Object[] oldObjects, Object[] newObjects,
+                                                          long[] stats);
+    private static native Object[] nativeVerifyResidual(Object[] targets, Object[] excluded, int maxPaths,
+                                                        long[] kindCounts, long[] stats);
+    private static native long nativeExportGraph(String path, Class<?>[] sourceClasses, boolean sourceEdgesOnly,
+                                                 long[] stats);
     private static native void nativeAdvanceEpoch();
+    private static native long nativeStartReclaimTracking(Object[] objects);
+    private static native void nativeReclaimStats(long[] out);
+    private static native void nativeStopReclaimTracking();
+    private static native void nativeCancelWalks();
+    private static native void nativeWalkProgress(long[] out);
+    private static native void nativeOpTimes(long[] out);
+    private static native long nativeRetainedTags();
+    private static native int nativeOpenWalkEnvs();
+    private static native String nativeLibraryPath();
 
     @Override
     public Object[] snapshotObjects(Class<?> targetClass) {
@@ -38,9 +124,116 @@ public final class NativeHeapWalker implements HeapWalker {
         return result != null ? result : new Object[0];
     }
 
+    @Override
+    public Map<Class<?>, Object[]> snapshotPartitioned(Collection<Class<?>> classes) {
+        return partitioned(classes, false);
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>The same single class-filtered walk as {@link #snapshotPartitioned(Collection)}, run by
+     * JVMTI {@code FollowReferences} from the heap roots instead of {@code IterateThroughHeap}.
+     */
+    @Override
+    public Map<Class<?>, Object[]> snapshotReachable(Collection<Class<?>> classes) {
+        return partitioned(classes, true);
+    }
+
+    /** Snapshots the instances of each distinct class in one native walk, reachable ones only if asked. */
+    private static Map<Class<?>, Object[]> partitioned(Collection<Class<?>> classes, boolean reachable) {
+        Map<Class<?>, Object[]> result = new LinkedHashMap<>();
+        if (classes == null || classes.isEmpty()) return result;
+        Class<?>[] targets = classes.stream()
+                                .filter(Objects::nonNull)
+                                .distinct()
+                                .toArray(Class<?>[]::new);
+        if (targets.length == 0) return result;
+        Object[][] partitions = nativeSnapshotPartitioned(targets, reachable);
+        for (int i = 0; i < targets.length; i++) {
+            Object[] part = partitions != null ? partitions[i] : null;
+            result.put(targets[i], part != null ? part : new Object[0]);
+        }
+        return result;
+    }
+
     @Override
     public Set<Object> walkHeap() {
-        Object[] objects = nativeWalkHeap();
+        return toIdentitySet(nativeWalkHeap(null, false));
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>The agent marks the leaf classes' mirrors before the walk and its callback leaves their
+     * instances untagged, so they are never resolved into references. The marked {@link Class}
+     * objects themselves are not reported either.
+     */
+    @Override
+    public Set<Object> walkHeapSkippingLeaves(Collection<Class<?>> leafClasses) {
+        return toIdentitySet(nativeWalkHeap(leafArray(leafClasses), false));
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>Runs the full walk under JVMTI {@code FollowReferences} from the heap roots. Objects
+     * reachable only through soft, weak or phantom references are returned too.
+     */
+    @Override
+    public Set<Object> walkReachable(Collection<Class<?>> leafClasses) {
+        return toIdentitySet(nativeWalkHeap(leafClasses != null ? leafArray(leafClasses) : null, true));
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>One JVMTI {@code FollowReferences} pass whose initial object is an array of the roots,
+     * tagging instances of the classes as for {@link #snapshotPartitioned(Collection)}.
+     */
+    @Override
+    public Map<Class<?>, Object[]> snapshotReachableFrom(Collection<?> roots, Collection<Class<?>> classes)
+            throws MigrateException {
+        Map<Class<?>, Object[]> result = new LinkedHashMap<>();
+        if (classes == null || classes.isEmpty()) return result;
+        Class<?>[] targets = classes.stream()
+                                .filter(Objects::nonNull)
+                                .distinct()
+                                .toArray(Class<?>[]::new);
+        if (targets.length == 0) return result;
+        Object[] rootArray = rootArray(roots);
+        Object[][] partitions = rootArray.length > 0 ? nativeSnapshotPartitionedFrom(rootArray, targets) : null;
+        if (rootArray.length > 0 && partitions == null) {
+            throw new MigrateException("Root-scoped snapshot failed");
+        }
+        for (int i = 0; i < targets.length; i++) {
+            Object[] part = partitions != null ? partitions[i] : null;
+            result.put(targets[i], part != null ? part : new Object[0]);
+        }
+        return result;
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>One JVMTI {@code FollowReferences} pass whose initial object is an array of the roots.
+     * Objects reachable only through soft, weak or phantom references are returned too.
+     */
+    @Override
+    public Set<Object> walkReachableFrom(Collection<?> roots, Collection<Class<?>> leafClasses) {
+        Object[] rootArray = rootArray(roots);
+        if (rootArray.length == 0) return toIdentitySet(null);
+        return toIdentitySet(nativeWalkFrom(rootArray, leafClasses != null ? leafArray(leafClasses) : null));
+    }
+
+    /** The non-null roots, as the array a root-scoped walk starts from. */
+    private static Object[] rootArray(Collection<?> roots) {
+        if (roots == null) return new Object[0];
+        return roots.stream().filter(Objects::nonNull).toArray();
+    }
+
+    /** Collects a native walk result (null means empty) into an identity set. */
+    private static Set<Object> toIdentitySet(Object[] objects) {
         Set<Object> set = Collections.newSetFromMap(new IdentityHashMap<>());
         if (objects != null) {
             Collections.addAll(set, objects);
@@ -48,6 +241,15 @@ public final class NativeHeapWalker implements HeapWalker {
         return set;
     }
 
+    /** The leaf classes as passed to the agent: never null, so the agent always skips primitive arrays. */
+    private static Class<?>[] leafArray(Collection<Class<?>> leafClasses) {
+        if (leafClasses == null) return new Class<?>[0];
+        return leafClasses.stream()
+                          .filter(Objects::nonNull)
+                          .distinct()
+                          .toArray(Class<?>[]::new);
+    }
+
     @Override
     public Set<Object> walkHeap(Collection<Class<?>> classes) throws MigrateException {
         if (classes == null || classes.isEmpty()) return Collections.emptySet();
@@ -60,7 +262,407 @@ public final class NativeHeapWalker implements HeapWalker {
         if (objs != null) Collections.addAll(set, objs);
         return set;
     }
+
+    @Override
+    public long walkHeap(Consumer<Object[]> chunkSink, int chunkSize) throws MigrateException {
+        return walkChunked(null, null, false, chunkSink, chunkSize);
+    }
+
+    @Override
+    public long walkHeapSkippingLeaves(Collection<Class<?>> leafClasses, Consumer<Object[]> chunkSink,
+                                       int chunkSize) throws MigrateException {
+        return walkChunked(null, leafArray(leafClasses), false, chunkSink, chunkSize);
+    }
+
+    @Override
+    public long walkReachable(Collection<Class<?>> leafClasses, Consumer<Object[]> chunkSink, int chunkSize)
+            throws MigrateException {
+        return walkChunked(null, leafClasses != null ? leafArray(leafClasses) : null, true, chunkSink, chunkSize);
+    }
+
+    @Override
+    public long walkHeap(Collection<Class<?>> classes, Consumer<Object[]> chunkSink, int chunkSize)
+            throws MigrateException {
+        Objects.requireNonNull(chunkSink, "chunkSink");
+        if (classes == null || classes.isEmpty()) return 0;
+        Class<?>[] targets = classes.stream()
+                                .filter(Objects::nonNull)
+                                .distinct()
+                                .toArray(Class<?>[]::new);
+        if (targets.length == 0) return 0;
+        return walkChunked(targets, null, false, chunkSink, chunkSize);
+    }
+
+    /**
+     * Tags the matches in one heap pass, then resolves and delivers them one chunk at a time, so
+     * at most one chunk is held in native references and the result array at any moment.
+     * Resolved objects are untagged natively, and the walk's tagging environment is disposed at
+     * the end even if the sink throws, dropping the tags of the chunks never resolved. A full walk
+     * ({@code targets} null) with non-null {@code leaves} skips the leaves while tagging; a
+     * {@code reachable} walk tags only objects reachable from the heap roots. With a
+     * {@linkplain #openWalkIndex() walk index} open, resolved objects are retagged with their
+     * dense index instead, and the index answers for this walk until it ends.
+     *
+     * <p>With {@link #DERIVED_CHUNK_SIZE} the pass tags slices of growing size, and the agent
+     * groups them into at most {@link #DERIVED_CHUNKS} + 1 chunks once it knows the number of
+     * matches; each chunk is still resolved by one scan of the tag map.
+     */
+    private long walkChunked(Class<?>[] targets, Class<?>[] leaves, boolean reachable,
+                             Consumer<Object[]> chunkSink, int chunkSize) throws MigrateException {
+        Objects.requireNonNull(chunkSink, "chunkSink");
+        if (chunkSize < 0) throw new IllegalArgumentException("chunkSize must not be negative: " + chunkSize);
+        long[] walk = new long[3]; // epoch, tagging environment, matches
+        int[] starts = chunkSize == DERIVED_CHUNK_SIZE ? new int[DERIVED_CHUNKS + 2] : null;
+        int chunks = nativeTagChunks(targets, leaves, reachable, chunkSize, walk, starts);
+        if (chunks < 0) {
+            throw new MigrateException("Chunked heap walk failed");
+        }
+        NativeWalkIndex index = walkIndex.getAndSet(null);
+        if (index != null && !index.attach(walk[1], walk[0])) index = null;
+        long delivered = 0;
+        try {
+            for (int c = 0; c < chunks; c++) {
+                int first = starts != null ? starts[c] : c;
+                int slices = starts != null ? starts[c + 1] - starts[c] : 1;
+                Object[] chunk = nativeResolveChunk(walk[1], walk[0], first, slices, index != null ? delivered : -1);
+                if (chunk == null || chunk.length == 0) continue;
+                delivered += chunk.length;
+                chunkSink.accept(chunk);
+            }
+        } finally {
+            if (index != null) index.detach();
+            nativeEndChunks(walk[1]);
+        }
+        return delivered;
+    }
+
+    @Override
+    public VisitMarks openVisitMarks(boolean concurrent) throws MigrateException {
+        long[] visit = new long[VISIT_HANDLE_COUNT]; // epoch, tagging environment, raw monitor
+        if (!nativeVisitOpen(concurrent, visit)) {
+            throw new MigrateException("No tagging environment for visit marks");
+        }
+        return new NativeVisitMarks(visit[0], visit[1], visit[2]);
+    }
+
+    @Override
+    public WalkIndex openWalkIndex() throws MigrateException {
+        NativeWalkIndex index = new NativeWalkIndex();
+        if (!walkIndex.compareAndSet(null, index)) {
+            throw new MigrateException("A walk index is already open");
+        }
+        return index;
+    }
+
+    /** Marks of one visit set: a tagging environment of its own, disposed by {@link #close()}. */
+    private static final class NativeVisitMarks implements VisitMarks {
+        private final long epoch;
+        private final long env;
+        private final long lock;
+        private final AtomicBoolean closed = new AtomicBoolean();
+
+        NativeVisitMarks(long epoch, long env, long lock) {
+            this.epoch = epoch;
+            this.env = env;
+            this.lock = lock;
+        }
+
+        @Override
+        public boolean mark(Object o) {
+            if (closed.get()) throw new IllegalStateException("visit marks closed");
+            return nativeVisitMark(env, epoch, lock, o);
+        }
+
+        @Override
+        public void close() {
+            if (closed.compareAndSet(false, true)) nativeVisitClose(env, lock);
+        }
+    }
+
+    /**
+     * Dense index of one chunked walk. {@code walk} holds the walk's environment and epoch while
+     * the walk runs; the walk detaches it under the write lock before disposing the environment,
+     * so a lookup, which holds the read lock, never reaches a disposed one.
+     */
+    private final class NativeWalkIndex implements WalkIndex {
+        private final ReadWriteLock lock = new ReentrantReadWriteLock();
+        private volatile long[] walk;
+        private volatile boolean closed;
+
+        boolean attach(long env, long epoch) {
+            if (closed) return false;
+            walk = new long[] { env, epoch };
+            return true;
+        }
+
+        void detach() {
+            lock.writeLock().lock();
+            try {
+                walk = null;
+            } finally {
+                lock.writeLock().unlock();
+            }
+        }
+
+        @Override
+        public int indexOf(Object o) {
+            if (walk == null) return UNWALKED;
+            lock.readLock().lock();
+            try {
+                long[] w = walk;
+                return w != null ? nativeWalkIndexOf(w[0], w[1], o) : UNWALKED;
+            } finally {
+                lock.readLock().unlock();
+            }
+        }
+
+        @Override
+        public void close() {
+            closed = true;
+            walkIndex.compareAndSet(this, null);
+        }
+    }
+
+    @Override
+    public HeapCensus census(Collection<Class<?>> classes) throws MigrateException {
+        Class<?>[] targets = null;
+        if (classes != null && !classes.isEmpty()) {
+            targets = classes.stream()
+                             .filter(Objects::nonNull)
+                             .distinct()
+                             .toArray(Class<?>[]::new);
+            if (targets.length == 0) return HeapCensus.EMPTY;
+        }
+        Object[] raw = nativeCensus(targets);
+        if (raw == null) {
+            throw new MigrateException("Heap census failed");
+        }
+        return HeapCensus.fromNative(raw);
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>Each object is tagged with its shallow size in a JVMTI environment of the tracker's own
+     * that posts {@code ObjectFree}, so a free is counted from its tag alone and costs no heap
+     * walk. The tracker is shared by every instance of this class. Stopping or replacing it
+     * disposes its environment, which drops the tags of the objects still alive in one step.
+     */
+    @Override
+    public boolean startReclamationTracking(Collection<?> objects) {
+        if (objects == null || objects.isEmpty()) return false;
+        synchronized (NativeHeapWalker.class) {
+            return nativeStartReclaimTracking(objects.toArray()) >= 0;
+        }
+    }
+
+    @Override
+    public ReclamationProgress reclamationProgress() {
+        long[] raw = new long[RECLAIM_STAT_COUNT];
+        nativeReclaimStats(raw);
+        return ReclamationProgress.fromNative(raw);
+    }
+
+    @Override
+    public void stopReclamationTracking() {
+        synchronized (NativeHeapWalker.class) {
+            nativeStopReclaimTracking();
+        }
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>Counts are kept natively by the walk's JVMTI callback and published every 1024 visits.
+     */
+    @Override
+    public WalkProgress walkProgress() {
+        long[] raw = new long[5];
+        nativeWalkProgress(raw);
+        return WalkProgress.fromNative(raw);
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>The walk's JVMTI callback notices the request within 1024 visits and returns
+     * {@code JVMTI_VISIT_ABORT}, which ends the iteration and releases the safepoint at once.
+     */
+    @Override
+    public void cancelWalks() {
+        nativeCancelWalks();
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>Measured natively around each JVMTI call with a monotonic clock; the counters are shared
+     * by every walker in the process.
+     */
+    @Override
+    public HeapOpTimes opTimes() {
+        long[] raw = new long[6];
+        nativeOpTimes(raw);
+        return HeapOpTimes.fromNative(raw);
+    }
+
+    @Override
+    public HeapReferrers findReferrers(Collection<?> targets) {
+        if (targets == null || targets.isEmpty()) return HeapReferrers.EMPTY;
+        long[] kindCounts = new long[REFERENCE_KIND_SLOTS];
+        Object[] holders = nativeFindReferrers(targets.toArray(), kindCounts);
+        return HeapReferrers.fromNative(holders, kindCounts);
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>{@code climbed} is asked once per loaded class before the walk. The walk numbers the
+     * objects it records in a native table, and one edge of 8 bytes per recorded reference, for
+     * the duration of the call, so at most {@code 8 * maxEdges} bytes of edges; the walk stops as
+     * soon as it would record more. A class loaded meanwhile is not climbed.
+     */
+    @Override
+    public HeapReferrerChains findReferrerChains(Collection<?> targets, Predicate<Class<?>> climbed, int maxDepth,
+                                                 long maxEdges) throws MigrateException {
+        if (targets == null || targets.isEmpty()) return HeapReferrerChains.EMPTY;
+        if (maxEdges <= 0) throw new MigrateException("Referrer-chain walk disabled (no references may be recorded)");
+        Class<?>[] classes = nativeLoadedClasses();
+        if (classes == null) throw new MigrateException("No loaded classes for a referrer-chain walk");
+        boolean[] climb = new boolean[classes.length];
+        for (int i = 0; i < classes.length; i++) {
+            climb[i] = classes[i] != null && classes[i] != Class.class && climbed.test(classes[i]);
+        }
+        long[] kindCounts = new long[REFERENCE_KIND_SLOTS];
+        Object[] raw = nativeFindReferrerChains(targets.toArray(), classes, climb, maxDepth, maxEdges, kindCounts);
+        if (raw == null || raw.length < 2) {
+            throw new MigrateException("Referrer-chain walk failed (out of memory or over " + maxEdges + " references)");
+        }
+        return HeapReferrerChains.fromNative((Object[]) raw[0], (byte[]) raw[1], kindCounts);
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>Every loaded class's mirror is tagged for the walk, so each reported reference names the
+     * class of both ends without tagging any instance. {@code climbed} is asked once per loaded
+     * class before the walk; the climb records one native entry per distinct (referrer class,
+     * climbed class) pair, for the duration of the call.
+     */
+    @Override
+    public HolderClasses findHolderClasses(Collection<Class<?>> sourceClasses, Predicate<Class<?>> climbed,
+                                           int maxDepth) throws MigrateException {
+        if (sourceClasses == null || sourceClasses.isEmpty()) return HolderClasses.EMPTY;
+        Class<?>[] sources = sourceClasses.stream()
+                                          .filter(Objects::nonNull)
+                                          .distinct()
+                                          .toArray(Class<?>[]::new);
+        if (sources.length == 0) return HolderClasses.EMPTY;
+        Class<?>[] classes = nativeLoadedClasses();
+        if (classes == null) throw new MigrateException("No loaded classes for holder-class discovery");
+        boolean[] climb = new boolean[classes.length];
+        for (int i = 0; climbed != null && i < classes.length; i++) {
+            climb[i] = classes[i] != null && classes[i] != Class.class && climbed.test(classes[i]);
+        }
+        Object[] raw = nativeHolderClasses(sources, classes, climb, maxDepth);
+        if (raw == null) {
+            throw new MigrateException("Holder-class discovery failed");
+        }
+        return HolderClasses.fromNative(raw);
+    }
+
+    @Override
+    public SlotPatchResult patchSlots(Collection<?> holders, Object[] oldObjects, Object[] newObjects)
+            throws MigrateException {
+        if (holders == null || holders.isEmpty() || oldObjects == null || oldObjects.length == 0) {
+            return SlotPatchResult.EMPTY;
+        }
+        if (newObjects == null || newObjects.length != oldObjects.length) {
+            throw new MigrateException("patchSlots: oldObjects and newObjects differ in length");
+        }
+        long[] stats = new long[SLOT_STAT_COUNT];
+        stats[0] = -1; // "not filled": the agent leaves stats untouched when the walk itself fails
+        Object[] unpatched = nativePatchSlots(holders.toArray(), oldObjects, newObjects, stats);
+        if (stats[0] < 0) {
+            throw new MigrateException("Native slot patching failed");
+        }
+        return new SlotPatchResult(stats[0], stats[1], unpatched);
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>Needs the JVMTI capability {@code can_access_local_variables}, which HotSpot only grants
+     * while the VM starts: load the agent with {@code -agentpath:<lib>=stacklocals}. Without it,
+     * this throws.
+     */
+    @Override
+    public StackLocalPatchResult patchStackLocals(Collection<Thread> threads, Object[] oldObjects,
+                                                  Object[] newObjects) throws MigrateException {
+        if (threads == null || threads.isEmpty() || oldObjects == null || oldObjects.length == 0) {
+            return StackLocalPatchResult.EMPTY;
+        }
+        if (newObjects == null || newObjects.length != oldObjects.length) {
+            throw new MigrateException("patchStackLocals: oldObjects and newObjects differ in length");
+        }
+        long[] stats = new long[LOCAL_STAT_COUNT];
+        stats[0] = -1; // "not filled": the agent leaves stats untouched when local access is unavailable
+        Object[] report = nativePatchStackLocals(threads.toArray(new Thread[0]), oldObjects, newObjects, stats);
+        if (stats[0] < 0) {
+            throw new MigrateException("Stack-local patching failed or is not available "
+                    + "(load the agent with -agentpath:<lib>=stacklocals)");
+        }
+        return StackLocalPatchResult.fromNative(stats, report);
+    }
     
+    /**
+     * {@inheritDoc}
+     *
+     * <p>One JVMTI {@code FollowReferences} pass from the heap roots numbers every reachable
+     * object in a native table (about 20 bytes per object for the duration of the call) that
+     * records the reference each was reached by. A clean heap costs that single pass. When an old
+     * object is reached, up to three more passes shorten the recorded paths until they are exact;
+     * {@link ResidualReferences#exactPaths()} tells whether they got there.
+     */
+    @Override
+    public ResidualReferences findResidualReferences(Collection<?> oldObjects, Collection<?> excluded, int maxPaths)
+            throws MigrateException {
+        if (oldObjects == null || oldObjects.isEmpty()) return ResidualReferences.NONE;
+        long[] kindCounts = new long[REFERENCE_KIND_SLOTS];
+        long[] stats = new long[VERIFY_STAT_COUNT];
+        stats[0] = -1; // "not filled": the agent leaves stats untouched when the walk itself fails
+        Object[] paths = nativeVerifyResidual(oldObjects.toArray(), excluded != null ? excluded.toArray() : null,
+                Math.max(0, maxPaths), kindCounts, stats);
+        if (stats[0] < 0) {
+            throw new MigrateException("Residual-reference verification failed");
+        }
+        return ResidualReferences.fromNative(stats[0], stats[2] != 0, kindCounts, paths);
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>One JVMTI {@code FollowReferences} pass numbers every reachable object and streams each
+     * reference to the file as it is reported; the agent holds an 8-byte record per object for
+     * the duration of the walk, and writes the object table after it.
+     */
+    @Override
+    public HeapGraphExport exportReferenceGraph(Path file, Collection<Class<?>> sourceClasses, boolean sourceEdgesOnly)
+            throws MigrateException {
+        Objects.requireNonNull(file, "file");
+        Path target = file.toAbsolutePath();
+        Class<?>[] sources = sourceClasses == null ? new Class<?>[0] : sourceClasses.stream()
+                .filter(Objects::nonNull)
+                .distinct()
+                .toArray(Class<?>[]::new);
+        long[] stats = new long[GRAPH_STAT_COUNT];
+        long bytes = nativeExportGraph(target.toString(), sources, sourceEdgesOnly, stats);
+        if (bytes < 0) {
+            throw new MigrateException("Reference-graph export to " + target + " failed");
+        }
+        return new HeapGraphExport(target, stats[0], stats[1], stats[2], bytes);
+    }
+
     /**
      * Advances the migration epoch counter.
      *
@@ -71,4 +673,34 @@ public final class NativeHeapWalker implements HeapWalker {
     public static void advanceEpoch() {
         nativeAdvanceEpoch();
     }
+
+    /**
+     * Counts the objects still carrying a tag in the agent's long-lived JVMTI environment.
+     *
+     * <p>Every walk tags in a disposable environment of its own and drops it when the walk
+     * ends, so this stays at zero however many walks have run; a non-zero value means the agent
+     * could not create per-walk environments and is leaving tags behind that every GC must
+     * process. Costs one heap pass: meant for diagnostics and benchmarks, not for the hot path.
+     *
+     * @return the number of tagged objects, or -1 if the count failed
+     */
+    public static long retainedTagCount() {
+        return nativeRetainedTags();
+    }
+
+    /**
+     * @return the number of per-walk tagging environments currently open; zero whenever no walk
+     *         is running
+     */
+    public static int openWalkEnvironments() {
+        return nativeOpenWalkEnvs();
+    }
+
+    /**
+     * @return the file the native agent was loaded from, or null if it cannot be determined;
+     *         {@link ForeignHeapWalker} looks its foreign-function entry points up there
+     */
+    static String agentLibraryPath() {
+        return nativeLibraryPath();
+    }
 }
@@ -0,0 +1,60 @@
+package migrator.heap;
+
+import java.util.Locale;
+
+/**
+ * How much of a set of tracked objects the garbage collector has freed so far, as reported by a
+ * reclamation tracker ({@link HeapWalker#startReclamationTracking}).
+ *
+ * <p>After a migration commits, its old objects should become unreachable and be reclaimed by the
+ * next collections. A tracker that stays {@linkplain #isComplete() incomplete} long after several
+ * GCs points at a leak: something outside the migration still holds old objects.
+ *
+ * @param trackerId          identifies the tracker (0 = none has run, or the walker cannot track)
+ * @param tracked            objects tracked
+ * @param trackedBytes       shallow bytes of the tracked objects
+ * @param reclaimed          tracked objects freed so far
+ * @param reclaimedBytes     shallow bytes of the objects freed so far
+ * @param nanosToLastReclaim time from the start of tracking to the last free seen (0 = none)
+ * @param nanosSinceStart    time since tracking started
+ * @param active             true while the tracker still counts frees
+ */
+public record ReclamationProgress(long trackerId, long tracked, long trackedBytes, long reclaimed,
+                                  long reclaimedBytes, long nanosToLastReclaim, long nanosSinceStart,
+                                  boolean active) {
+
+    /** No tracker has run, or the walker cannot track reclamation. */
+    public static final ReclamationProgress NONE = new ReclamationProgress(0, 0, 0, 0, 0, 0, 0, false);
+
+    /**
+     * Builds the progress reported by the native agent.
+     *
+     * @param raw {@code long[] { trackerId, tracked, trackedBytes, reclaimed, reclaimedBytes,
+     *            nanosToLastReclaim, nanosSinceStart, active }} (null means none)
+     * @return the progress
+     */
+    static ReclamationProgress fromNative(long[] raw) {
+        if (raw == null || raw.length < 8 || raw[0] == 0) return NONE;
+        return new ReclamationProgress(raw[0], raw[1], raw[2], raw[3], raw[4], raw[5], raw[6], raw[7] != 0);
+    }
+
+    /** @return tracked objects not freed yet */
+    public long outstanding() {
+        return Math.max(0, tracked - reclaimed);
+    }
+
+    /** @return true if every tracked object has been freed */
+    public boolean isComplete() {
+        return trackerId != 0 && reclaimed >= tracked;
+    }
+
+    /** @return a one-line description for logs, e.g. {@code "reclaimed 990 of 1,000 objects (31,680 of 32,000 bytes), last 41.2ms after start"} */
+    public String describe() {
+        if (trackerId == 0) return "no reclamation tracked";
+        return String.format(Locale.ROOT, "reclaimed %,d of %,d objects (%,d of %,d bytes), %s",
+                reclaimed, tracked, reclaimedBytes, trackedBytes,
+                nanosToLastReclaim > 0
+                        ? String.format(Locale.ROOT, "last %.1fms after start", HeapOpTimes.millis(nanosToLastReclaim))
+                        : "none yet");
+    }
+}
@@ -0,0 +1,89 @@
+package migrator.heap;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.EnumMap;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+import java.util.stream.Collectors;
+
+/**
+ * Result of a residual-reference verification: the migrated (old) objects that are still
+ * reachable once every reference to them should have been rewritten, the references that keep
+ * them so, and the shortest root path of a sample of them.
+ *
+ * <p>A residual object doubles its footprint for as long as the reference survives: missed
+ * static finals, holders the patcher skips, JDK-internal structures. References are counted
+ * only from outside the old objects: an old object held solely by another old object is
+ * residual, but the reference between them is not counted.
+ *
+ * @param residualObjects the old objects still reachable from the heap roots
+ * @param referenceCounts references into the old objects from other objects or roots, per kind
+ * @param samplePaths     the root paths of up to the requested number of residual objects
+ * @param exactPaths      true if every sample path is a shortest one (the walk converged)
+ * @see HeapWalker#findResidualReferences(java.util.Collection, java.util.Collection, int)
+ */
+public record ResidualReferences(long residualObjects, Map<HeapReferenceKind, Long> referenceCounts,
+                                 List<RootPath> samplePaths, boolean exactPaths) {
+
+    /** Nothing reachable: the migration left no reference behind. */
+    public static final ResidualReferences NONE = new ResidualReferences(0, Map.of(), List.of(), true);
+
+    /** Null-guards and freezes the counts and paths. */
+    public ResidualReferences {
+        referenceCounts = (referenceCounts == null || referenceCounts.isEmpty())
+                ? Map.of()
+                : Collections.unmodifiableMap(new EnumMap<>(referenceCounts));
+        samplePaths = samplePaths != null ? List.copyOf(samplePaths) : List.of();
+    }
+
+    /**
+     * Builds a result from the values filled by the native agent.
+     *
+     * @param residualObjects the old objects reached
+     * @param exactPaths      true if the paths are shortest
+     * @param rawCounts       the per-kind counter array, indexed by {@code jvmtiHeapReferenceKind}
+     * @param rawPaths        the native paths (null means none; see {@link RootPath#fromNative})
+     * @return the result
+     */
+    static ResidualReferences fromNative(long residualObjects, boolean exactPaths, long[] rawCounts,
+                                         Object[] rawPaths) {
+        List<RootPath> paths = new ArrayList<>();
+        if (rawPaths != null) {
+            for (Object raw : rawPaths) {
+                RootPath path = RootPath.fromNative(raw);
+                if (path != null) paths.add(path);
+            }
+        }
+        return new ResidualReferences(residualObjects, HeapReferenceKind.countsFromNative(rawCounts), paths,
+                exactPaths);
+    }
+
+    /** @return true if no old object is reachable any more */
+    public boolean isClean() {
+        return residualObjects == 0;
+    }
+
+    /** @return the number of references into the old objects, of every kind */
+    public long residualReferences() {
+        long n = 0;
+        for (long count : referenceCounts.values()) n += count;
+        return n;
+    }
+
+    /** @return the number of references of the given kind (0 if none) */
+    public long referenceCount(HeapReferenceKind kind) {
+        return referenceCounts.getOrDefault(kind, 0L);
+    }
+
+    /** @return a one-line summary for logs, e.g. {@code "2 residual object(s), 3 reference(s) (FIELD 2, STATIC_FIELD 1)"} */
+    public String describe() {
+        if (isClean()) return "no residual objects";
+        String kinds = referenceCounts.entrySet().stream()
+                .map(e -> e.getKey().name() + " " + e.getValue())
+                .collect(Collectors.joining(", "));
+        return String.format(Locale.ROOT, "%d residual object(s), %d reference(s)%s",
+                residualObjects, residualReferences(), kinds.isEmpty() ? "" : " (" + kinds + ")");
+    }
+}
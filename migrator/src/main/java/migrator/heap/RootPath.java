@@ -0,0 +1,98 @@
+package migrator.heap;
+
+import java.util.ArrayList;
+import java.util.List;
+
+/**
+ * A chain of references from a heap root to an object, reported by a residual-reference
+ * verification: one step per object, starting with the object a root references directly and
+ * ending with the residual (old) object.
+ *
+ * <p>Steps hold type names, not objects, so a path can be kept and logged without keeping
+ * anything on it reachable.
+ *
+ * @param steps     the objects along the path, root end first (never null)
+ * @param truncated true if the path was too long to report whole and starts part-way, so its
+ *                  first step was not reached from a root
+ * @see ResidualReferences
+ * @see HeapWalker#findResidualReferences(java.util.Collection, java.util.Collection, int)
+ */
+public record RootPath(List<Step> steps, boolean truncated) {
+
+    /**
+     * One object on a path and the reference it was reached by.
+     *
+     * @param typeName the object's type ({@link Class#getTypeName()}), or {@code "?"} if unknown;
+     *                 for a {@link Class} object, the type of the class itself
+     * @param isClass  true if the object is a {@link Class} (the holder of static fields)
+     * @param via      the kind of the reference into this object: a root kind for the first
+     *                 step of a whole path (null if unknown)
+     * @param index    the array index of an {@link HeapReferenceKind#ARRAY_ELEMENT} reference,
+     *                 the JVMTI index of a field or constant-pool reference, or -1
+     * @param field    the name of the field the object was reached through, or null
+     */
+    public record Step(String typeName, boolean isClass, HeapReferenceKind via, int index, String field) {
+
+        /** @return how the previous step refers to this one, e.g. {@code "items"} or {@code "[3]"} */
+        public String slot() {
+            if (field != null) return field;
+            if (via == HeapReferenceKind.ARRAY_ELEMENT) return "[" + index + "]";
+            return via != null ? via.name().toLowerCase() : "?";
+        }
+
+        /** @return the object's description, e.g. {@code "app.Registry"} or {@code "class app.Registry"} */
+        public String object() {
+            return isClass ? "class " + typeName : typeName;
+        }
+    }
+
+    /** Null-guards and freezes the steps. */
+    public RootPath {
+        steps = steps != null ? List.copyOf(steps) : List.of();
+    }
+
+    /**
+     * @return the path on one line, e.g.
+     *         {@code "SYSTEM_CLASS class app.Registry -INSTANCE-> app.Registry -items-> app.OldUser[] -[0]-> app.OldUser"}
+     */
+    public String describe() {
+        StringBuilder sb = new StringBuilder();
+        for (int i = 0; i < steps.size(); i++) {
+            Step step = steps.get(i);
+            if (i > 0) {
+                sb.append(" -").append(step.slot()).append("-> ");
+            } else if (truncated) {
+                sb.append("... -").append(step.slot()).append("-> ");
+            } else {
+                sb.append(step.via() != null ? step.via().name() : "?").append(' ');
+            }
+            sb.append(step.object());
+        }
+        return sb.toString();
+    }
+
+    /**
+     * Builds a path from the arrays filled by the native agent: each object's class, the field it
+     * was reached through (or null), and three ints per object (reference kind, index, 1 if the
+     * object is a {@link Class}).
+     *
+     * @param raw {@code Object[] { Class[], String[], int[] }}
+     * @return the path, or null if {@code raw} is malformed
+     */
+    static RootPath fromNative(Object raw) {
+        if (!(raw instanceof Object[] parts) || parts.length < 3
+                || !(parts[0] instanceof Class<?>[] classes)
+                || !(parts[1] instanceof String[] fields)
+                || !(parts[2] instanceof int[] links)
+                || fields.length != classes.length || links.length != classes.length * 3) {
+            return null;
+        }
+        List<Step> steps = new ArrayList<>(classes.length);
+        for (int i = 0; i < classes.length; i++) {
+            steps.add(new Step(classes[i] != null ? classes[i].getTypeName() : "?", links[i * 3 + 2] != 0,
+                    HeapReferenceKind.fromCode(links[i * 3]), links[i * 3 + 1], fields[i]));
+        }
+        boolean truncated = steps.isEmpty() || steps.get(0).via() == null || !steps.get(0).via().isRoot();
+        return new RootPath(steps, truncated);
+    }
+}
@@ -0,0 +1,30 @@
+package migrator.heap;
+
+/**
+ * Result of a native slot-patching pass: how many holder slots referencing old objects were
+ * found, how many were rewritten, and which holders still have slots left for the Java patcher.
+ *
+ * <p>A slot is skipped when the replacement does not fit its declared type, it is a
+ * {@code final} field (static or instance), or it no longer holds the old object when it is
+ * rewritten.
+ *
+ * @param slotsFound       slots found referencing an old object
+ * @param slotsRewritten   slots rewritten with the replacement
+ * @param unpatchedHolders holders with at least one skipped slot (never null)
+ * @see HeapWalker#patchSlots(java.util.Collection, Object[], Object[])
+ */
+public record SlotPatchResult(long slotsFound, long slotsRewritten, Object[] unpatchedHolders) {
+
+    /** Nothing found, nothing left over. */
+    public static final SlotPatchResult EMPTY = new SlotPatchResult(0, 0, new Object[0]);
+
+    /** Null-guards the holder array. */
+    public SlotPatchResult {
+        unpatchedHolders = unpatchedHolders != null ? unpatchedHolders : new Object[0];
+    }
+
+    /** @return the number of slots found but not rewritten. */
+    public long slotsSkipped() {
+        return slotsFound - slotsRewritten;
+    }
+}
@@ -0,0 +1,102 @@
+package migrator.heap;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Locale;
+
+/**
+ * Result of a stack-local patching pass: how many local variables of the suspended threads
+ * referenced an old object, how many were rewritten, and where the others are.
+ *
+ * <p>A local is left alone when the VM cannot write it (an operand-stack value, a JNI local, a
+ * native frame), when its method has no local-variable table to check the replacement's type
+ * against, when the replacement does not fit the declared type, or when it no longer holds the
+ * old object. References held by threads that were not patched (not suspended, or the migrating
+ * thread itself) are counted only.
+ *
+ * @param localsFound           locals of the patched threads referencing an old object
+ * @param localsRewritten       locals rewritten with the replacement
+ * @param otherThreadReferences stack and JNI-local references to old objects held by other threads
+ * @param unpatched             the locals found but not rewritten
+ * @see HeapWalker#patchStackLocals(java.util.Collection, Object[], Object[])
+ */
+public record StackLocalPatchResult(long localsFound, long localsRewritten, long otherThreadReferences,
+                                    List<UnpatchedLocal> unpatched) {
+
+    /** Nothing found. */
+    public static final StackLocalPatchResult EMPTY = new StackLocalPatchResult(0, 0, 0, List.of());
+
+    /** Null-guards and freezes the unpatched locals. */
+    public StackLocalPatchResult {
+        unpatched = unpatched != null ? List.copyOf(unpatched) : List.of();
+    }
+
+    /** Why a local was not rewritten (same order as the LOCAL_* reasons in agent.c). */
+    public enum Reason {
+        /** A value on the frame's operand stack: it has no slot to write. */
+        OPERAND_STACK,
+        /** A JNI local reference of a native method. */
+        JNI_LOCAL,
+        /** The method has no local-variable table (compiled without {@code -g}), so the slot's type is unknown. */
+        NO_LOCAL_TYPES,
+        /** The replacement is not assignable to the local's declared type. */
+        TYPE_MISMATCH,
+        /** The frame cannot be written (a native frame). */
+        OPAQUE_FRAME,
+        /** The local no longer held the old object when it was re-read. */
+        CHANGED,
+        /** Any other JVMTI error, e.g. the thread was not suspended. */
+        FAILED;
+
+        static Reason fromNative(long code) {
+            Reason[] values = values();
+            return code >= 0 && code < values.length ? values[(int) code] : FAILED;
+        }
+    }
+
+    /**
+     * One local found but not rewritten.
+     *
+     * @param thread   the thread whose frame holds it
+     * @param method   the frame's method ({@code pkg.Class.method}), or null if unknown
+     * @param depth    the frame depth (0 = top of the stack)
+     * @param slot     the local slot, or -1 for an operand-stack value or JNI local
+     * @param location the frame's bytecode index, or -1 if unknown
+     * @param reason   why it was not rewritten
+     */
+    public record UnpatchedLocal(Thread thread, String method, int depth, int slot, long location, Reason reason) {
+
+        /** @return e.g. {@code "worker-3 at app.Handler.handle (depth 2, slot 4, bci 17): TYPE_MISMATCH"} */
+        public String describe() {
+            return String.format(Locale.ROOT, "%s at %s (depth %d, slot %d, bci %d): %s",
+                    thread != null ? thread.getName() : "?", method != null ? method : "?",
+                    depth, slot, location, reason);
+        }
+    }
+
+    /**
+     * Builds a result from the values filled by the native agent.
+     *
+     * @param stats  {@code long[] { found, rewritten, otherThreadReferences }}
+     * @param report {@code Object[] { Thread[], String[] methods, long[] { depth, slot, location,
+     *               reason } per local }} (null means every local was rewritten)
+     * @return the result
+     */
+    static StackLocalPatchResult fromNative(long[] stats, Object[] report) {
+        List<UnpatchedLocal> unpatched = new ArrayList<>();
+        if (report != null && report.length == 3 && report[0] instanceof Thread[] threads
+                && report[1] instanceof String[] methods && report[2] instanceof long[] locals) {
+            for (int i = 0; i < threads.length && i * 4 + 3 < locals.length; i++) {
+                unpatched.add(new UnpatchedLocal(threads[i], i < methods.length ? methods[i] : null,
+                        (int) locals[i * 4], (int) locals[i * 4 + 1], locals[i * 4 + 2],
+                        Reason.fromNative(locals[i * 4 + 3])));
+            }
+        }
+        return new StackLocalPatchResult(stats[0], stats[1], stats[2], unpatched);
+    }
+
+    /** @return the number of locals found but not rewritten */
+    public long localsSkipped() {
+        return localsFound - localsRewritten;
+    }
+}
@@ -0,0 +1,27 @@
+package migrator.heap;
+
+/**
+ * Visited marks kept by the native agent as JVMTI tags rather than on the Java heap, for the
+ * visited set of a large patch traversal.
+ *
+ * <p>Each set tags in a tagging environment of its own with a fresh epoch, so its marks never
+ * mix with those of a walk or another set, and {@link #close()} drops them all at once. Marking
+ * costs a native call and a tag-map lookup or two per object; the Java heap holds nothing per
+ * object.
+ *
+ * @see HeapWalker#openVisitMarks(boolean)
+ */
+public interface VisitMarks extends AutoCloseable {
+
+    /**
+     * Marks {@code o} visited.
+     *
+     * @param o the object (never null)
+     * @return true if it was not marked before
+     */
+    boolean mark(Object o);
+
+    /** Drops every mark; the set is not used afterwards. Idempotent. */
+    @Override
+    void close();
+}
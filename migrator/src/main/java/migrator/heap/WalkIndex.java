@@ -0,0 +1,30 @@
+package migrator.heap;
+
+/**
+ * The dense index of each object a chunked walk delivers: 0, 1, 2, ... in delivery order, kept
+ * by the native agent as the object's walk tag until the walk ends.
+ *
+ * <p>An index opened by {@link HeapWalker#openWalkIndex()} attaches to the next chunked walk the
+ * walker starts, and answers for that walk until the walk ends; before and after, every object
+ * is {@link #UNWALKED}. Lookups are safe from any thread while the walk delivers its chunks.
+ *
+ * @see HeapWalker#openWalkIndex()
+ */
+public interface WalkIndex extends AutoCloseable {
+
+    /** {@link #indexOf} of an object the walk did not match, or when no walk is attached. */
+    int UNWALKED = -1;
+
+    /** {@link #indexOf} of an object the walk matched but has not delivered yet. */
+    int PENDING = -2;
+
+    /**
+     * @param o the object (never null)
+     * @return its dense index in the attached walk, {@link #PENDING} or {@link #UNWALKED}
+     */
+    int indexOf(Object o);
+
+    /** Stops indexing: a walk not yet started is no longer indexed. Idempotent. */
+    @Override
+    void close();
+}
@@ -0,0 +1,41 @@
+package migrator.heap;
+
+/**
+ * Live progress of the most recently started heap walk, as counted by the walk itself.
+ *
+ * <p>For an {@code IterateThroughHeap} walk, {@code visited} counts the objects shown to the walk
+ * (for a class-filtered walk, only instances of the requested classes); for a referrer walk it
+ * counts the references followed. The counts are published every few hundred visits, so a running
+ * walk reports slightly stale values.
+ *
+ * @param walkId    identifies the walk (its tagging epoch); 0 if no walk has run
+ * @param visited   objects (or references) visited so far
+ * @param tagged    objects tagged as matches so far
+ * @param active    true while the walk is running
+ * @param cancelled true if the walk was cancelled
+ * @see HeapWalker#walkProgress()
+ * @see HeapWalker#cancelWalks()
+ */
+public record WalkProgress(long walkId, long visited, long tagged, boolean active, boolean cancelled) {
+
+    /** No walk has run, or the walker does not report progress. */
+    public static final WalkProgress NONE = new WalkProgress(0, 0, 0, false, false);
+
+    /**
+     * Builds the progress reported by the native agent.
+     *
+     * @param raw {@code long[] { walkId, visited, tagged, active, cancelled }} (null means none)
+     * @return the progress
+     */
+    static WalkProgress fromNative(long[] raw) {
+        if (raw == null || raw.length < 5 || raw[0] == 0) return NONE;
+        return new WalkProgress(raw[0], raw[1], raw[2], raw[3] != 0, raw[4] != 0);
+    }
+
+    /** @return a one-line description for logs, e.g. {@code "walk 42: 1,048,576 visited, 12 tagged, running"} */
+    public String describe() {
+        if (walkId == 0) return "no walk";
+        return String.format("walk %d: %,d visited, %,d tagged, %s", walkId, visited, tagged,
+                cancelled ? "cancelled" : active ? "running" : "finished");
+    }
+}
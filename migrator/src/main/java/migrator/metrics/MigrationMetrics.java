@@ -1,5 +1,7 @@
 package migrator.metrics;
 
+import migrator.heap.HeapOpTimes;
+
 import java.time.Duration;
 import java.time.Instant;
 import java.util.Collections;
@@ -17,6 +19,17 @@ import java.util.Map;
  *   <li>Memory metrics (heap usage before/after)</li>
  *   <li>CPU metrics (load before/after/peak)</li>
  *   <li>Object counts (migrated, patched)</li>
+ *   <li>Pre-migration census of the source classes (instances, shallow bytes), when taken</li>
+ *   <li>Unreachable source instances a reachable first-pass snapshot left out, when a census
+ *       was taken to compare against</li>
+ *   <li>Old objects still reachable after the critical phase, and the references holding them,
+ *       when the residual-reference verification ran</li>
+ *   <li>Application threads the engine suspended for the critical phase, and how long suspending,
+ *       resuming and the whole pause took, when the engine quiesced by suspension</li>
+ *   <li>Local variables of the suspended threads that referenced old objects, and how many were
+ *       rewritten, when stack-local patching ran</li>
+ *   <li>Native heap operations: wall and safepoint time of the tagging and resolve steps, per
+ *       phase and for the whole migration (pauses the phase durations alone do not show)</li>
  * </ul>
  *
  * <p>Use {@link #summary()} for a human-readable summary, or {@link #toMap()}
@@ -36,13 +49,36 @@ public record MigrationMetrics(
         long totalDurationMs,
         int objectsMigrated,
         int objectsPatched,
-        int migratorCount
+        int migratorCount,
+        long sourceInstances,
+        long sourceShallowBytes,
+        long unreachableSkipped,
+        long residualObjects,
+        long residualReferences,
+        long stackLocalsFound,
+        long stackLocalsRewritten,
+        ThreadSuspension suspension,
+        Map<Phase, HeapOpTimes> phaseHeapOps,
+        HeapOpTimes heapOps
 ) {
-    /** Defensively wraps the mutable phase-duration map so the record stays truly immutable. */
+    /**
+     * Value of {@link #sourceInstances} / {@link #sourceShallowBytes} when no census was taken, of
+     * {@link #unreachableSkipped} when it was not measured, of {@link #residualObjects} /
+     * {@link #residualReferences} when no verification ran, and of {@link #stackLocalsFound} /
+     * {@link #stackLocalsRewritten} when no stack-local patching ran.
+     */
+    public static final long NO_CENSUS = -1;
+
+    /** Defensively wraps the mutable per-phase maps so the record stays truly immutable. */
     public MigrationMetrics {
         phaseDurations = (phaseDurations == null || phaseDurations.isEmpty())
                 ? Map.of()
                 : Collections.unmodifiableMap(new EnumMap<>(phaseDurations));
+        phaseHeapOps = (phaseHeapOps == null || phaseHeapOps.isEmpty())
+                ? Map.of()
+                : Collections.unmodifiableMap(new EnumMap<>(phaseHeapOps));
+        if (heapOps == null) heapOps = HeapOpTimes.NONE;
+        if (suspension == null) suspension = ThreadSuspension.NONE;
     }
 
     /**
@@ -55,8 +91,12 @@ public record MigrationMetrics(
         CRITICAL_PHASE,
         /** Second pass: patching remaining references */
         SECOND_PASS,
+        /** Stack-local patching of the suspended threads, within the critical phase */
+        STACK_LOCALS,
         /** Registry update phase */
         REGISTRY_UPDATE,
+        /** Residual-reference verification, after the critical phase */
+        VERIFY,
         /** Smoke test execution phase */
         SMOKE_TEST
     }
@@ -93,6 +133,27 @@ public record MigrationMetrics(
         }
     }
 
+    /**
+     * Engine-managed quiescence: the application threads suspended for the critical phase.
+     *
+     * @param threads      threads suspended
+     * @param failed       threads that could not be suspended (they had ended, or were already suspended)
+     * @param suspendNanos time until every thread was suspended
+     * @param resumeNanos  time until every thread was resumed
+     * @param pausedNanos  time from the start of suspending to the end of resuming
+     */
+    public record ThreadSuspension(int threads, int failed, long suspendNanos, long resumeNanos, long pausedNanos) {
+        /** The engine suspended no threads. */
+        public static final ThreadSuspension NONE = new ThreadSuspension(0, 0, 0, 0, 0);
+
+        /** @return a human-readable "N threads, pause …ms (suspend …ms, resume …ms)" summary. */
+        public String summary() {
+            return String.format(Locale.ROOT, "%d threads%s, pause %.1fms (suspend %.2fms, resume %.2fms)",
+                    threads, failed > 0 ? " (" + failed + " failed)" : "", HeapOpTimes.millis(pausedNanos),
+                    HeapOpTimes.millis(suspendNanos), HeapOpTimes.millis(resumeNanos));
+        }
+    }
+
     /**
      * Returns the change in heap memory usage during migration.
      *
@@ -121,6 +182,17 @@ public record MigrationMetrics(
         return phaseDurations.getOrDefault(phase, 0L);
     }
 
+    /**
+     * Returns the native heap operations run during a specific phase. Phases nest (the critical
+     * phase contains the second pass and the registry update), as their durations do.
+     *
+     * @param phase the phase to query
+     * @return the phase's heap operations, or {@link HeapOpTimes#NONE} if none ran
+     */
+    public HeapOpTimes phaseHeapOps(Phase phase) {
+        return phaseHeapOps.getOrDefault(phase, HeapOpTimes.NONE);
+    }
+
     /**
      * Returns a human-readable summary of the migration metrics.
      *
@@ -128,9 +200,52 @@ public record MigrationMetrics(
      */
     public String summary() {
         return String.format(Locale.ROOT,
-                "Migration #%d in %dms | Heap: %s (delta: %s) | CPU: %s | Objects: %d migrated, %d patched",
+                "Migration #%d in %dms | Heap: %s (delta: %s) | CPU: %s | Objects: %d migrated, %d patched%s%s%s%s%s%s",
                 migrationId, totalDurationMs, memoryAfter.heapSummary(), formatBytes(heapDelta()),
-                cpu.summary(), objectsMigrated, objectsPatched);
+                cpu.summary(), objectsMigrated, objectsPatched,
+                hasCensus() ? String.format(Locale.ROOT, " | Census: %d source instances, %s",
+                        sourceInstances, formatBytes(sourceShallowBytes)) : "",
+                hasUnreachableSkipped() ? " | Unreachable skipped: " + unreachableSkipped : "",
+                hasResidualCheck() ? String.format(Locale.ROOT, " | Residual: %d objects, %d references",
+                        residualObjects, residualReferences) : "",
+                hasStackLocalPatch() ? String.format(Locale.ROOT, " | Stack locals: %d of %d rewritten",
+                        stackLocalsRewritten, stackLocalsFound) : "",
+                hasSuspension() ? " | Suspended: " + suspension.summary() : "",
+                heapOps.isEmpty() ? "" : " | Heap ops: " + heapOps.describe());
+    }
+
+    /** @return true if a census of the source classes was taken before the migration. */
+    public boolean hasCensus() {
+        return sourceInstances != NO_CENSUS;
+    }
+
+    /**
+     * @return true if {@link #unreachableSkipped} was measured: the first pass took a reachable
+     *         snapshot (REACHABLE walk mode) and a census counted every source instance before it
+     */
+    public boolean hasUnreachableSkipped() {
+        return unreachableSkipped != NO_CENSUS;
+    }
+
+    /**
+     * @return true if the residual-reference verification ran, so {@link #residualObjects} and
+     *         {@link #residualReferences} were measured
+     */
+    public boolean hasResidualCheck() {
+        return residualObjects != NO_CENSUS;
+    }
+
+    /**
+     * @return true if stack-local patching ran, so {@link #stackLocalsFound} and
+     *         {@link #stackLocalsRewritten} were measured
+     */
+    public boolean hasStackLocalPatch() {
+        return stackLocalsFound != NO_CENSUS;
+    }
+
+    /** @return true if the engine quiesced the application by suspending its threads. */
+    public boolean hasSuspension() {
+        return !ThreadSuspension.NONE.equals(suspension);
     }
 
     /**
@@ -155,11 +270,36 @@ public record MigrationMetrics(
         map.put("cpuLoadPeak", cpu != null ? cpu.peak : null);
         map.put("objectsMigrated", objectsMigrated);
         map.put("objectsPatched", objectsPatched);
+        map.put("sourceInstances", hasCensus() ? sourceInstances : null);
+        map.put("sourceShallowBytes", hasCensus() ? sourceShallowBytes : null);
+        map.put("unreachableSkipped", hasUnreachableSkipped() ? unreachableSkipped : null);
+        map.put("residualObjects", hasResidualCheck() ? residualObjects : null);
+        map.put("residualReferences", hasResidualCheck() ? residualReferences : null);
+        map.put("stackLocalsFound", hasStackLocalPatch() ? stackLocalsFound : null);
+        map.put("stackLocalsRewritten", hasStackLocalPatch() ? stackLocalsRewritten : null);
+        if (hasSuspension()) {
+            map.put("threadsSuspended", suspension.threads());
+            map.put("threadsSuspendFailed", suspension.failed());
+            map.put("suspendMs", HeapOpTimes.millis(suspension.suspendNanos()));
+            map.put("resumeMs", HeapOpTimes.millis(suspension.resumeNanos()));
+            map.put("suspendedPauseMs", HeapOpTimes.millis(suspension.pausedNanos()));
+        }
         phaseDurations.forEach((phase, duration) ->
                 map.put(phase.name().toLowerCase() + "DurationMs", duration));
+        putHeapOps(map, "heapOp", heapOps);
+        phaseHeapOps.forEach((phase, ops) -> putHeapOps(map, phase.name().toLowerCase(), ops));
         return map;
     }
 
+    /** Adds {@code <prefix>TagWallMs}, {@code <prefix>TagSafepointMs} and the resolve pair, if any ran. */
+    private static void putHeapOps(Map<String, Object> map, String prefix, HeapOpTimes ops) {
+        if (ops.isEmpty()) return;
+        map.put(prefix + "TagWallMs", HeapOpTimes.millis(ops.tagWallNanos()));
+        map.put(prefix + "TagSafepointMs", HeapOpTimes.millis(ops.tagSafepointNanos()));
+        map.put(prefix + "ResolveWallMs", HeapOpTimes.millis(ops.resolveWallNanos()));
+        map.put(prefix + "ResolveSafepointMs", HeapOpTimes.millis(ops.resolveSafepointNanos()));
+    }
+
     /** Formats a byte count as B/KB/MB/GB with one or two decimal places. */
     private static String formatBytes(long bytes) {
         if (bytes < 1024) return bytes + "B";
@@ -191,6 +331,13 @@ public record MigrationMetrics(
         private final Map<Phase, Long> phaseDurations = new EnumMap<>(Phase.class);
         private long totalDurationMs;
         private int objectsMigrated, objectsPatched, migratorCount;
+        private long sourceInstances = NO_CENSUS, sourceShallowBytes = NO_CENSUS;
+        private long unreachableSkipped = NO_CENSUS;
+        private long residualObjects = NO_CENSUS, residualReferences = NO_CENSUS;
+        private long stackLocalsFound = NO_CENSUS, stackLocalsRewritten = NO_CENSUS;
+        private ThreadSuspension suspension = ThreadSuspension.NONE;
+        private final Map<Phase, HeapOpTimes> phaseHeapOps = new EnumMap<>(Phase.class);
+        private HeapOpTimes heapOps = HeapOpTimes.NONE;
 
         public Builder migrationId(long id) { this.migrationId = id; return this; }
         public Builder startTime(Instant t) { this.startTime = t; return this; }
@@ -227,6 +374,35 @@ public record MigrationMetrics(
         public Builder objectsPatched(int v) { this.objectsPatched = v; return this; }
         public Builder migratorCount(int v) { this.migratorCount = v; return this; }
 
+        public Builder sourceCensus(long instances, long shallowBytes) {
+            this.sourceInstances = instances;
+            this.sourceShallowBytes = shallowBytes;
+            return this;
+        }
+
+        public Builder unreachableSkipped(long v) { this.unreachableSkipped = v; return this; }
+
+        public Builder residuals(long objects, long references) {
+            this.residualObjects = objects;
+            this.residualReferences = references;
+            return this;
+        }
+
+        public Builder stackLocals(long found, long rewritten) {
+            this.stackLocalsFound = found;
+            this.stackLocalsRewritten = rewritten;
+            return this;
+        }
+
+        public Builder suspension(ThreadSuspension v) { this.suspension = v; return this; }
+
+        public Builder phaseHeapOps(Map<Phase, HeapOpTimes> ops) {
+            this.phaseHeapOps.putAll(ops);
+            return this;
+        }
+
+        public Builder heapOps(HeapOpTimes ops) { this.heapOps = ops; return this; }
+
         public MigrationMetrics build() {
             return new MigrationMetrics(
                     migrationId, startTime, endTime,
@@ -234,7 +410,10 @@ public record MigrationMetrics(
                     new MemoryMetrics(heapUsedAfter, heapCommittedAfter, heapMaxAfter, nonHeapUsedAfter),
                     new CpuMetrics(cpuBefore, cpuAfter, cpuPeak, processors),
                     new EnumMap<>(phaseDurations),
-                    totalDurationMs, objectsMigrated, objectsPatched, migratorCount
+                    totalDurationMs, objectsMigrated, objectsPatched, migratorCount,
+                    sourceInstances, sourceShallowBytes, unreachableSkipped,
+                    residualObjects, residualReferences, stackLocalsFound, stackLocalsRewritten, suspension,
+                    new EnumMap<>(phaseHeapOps), heapOps
             );
         }
     }
@@ -1,5 +1,6 @@
 package migrator.metrics;
 
+import migrator.heap.HeapOpTimes;
 import migrator.metrics.MigrationMetrics.Phase;
 
 import java.lang.management.ManagementFactory;
@@ -11,6 +12,7 @@ import java.time.Instant;
 import java.util.EnumMap;
 import java.util.Locale;
 import java.util.Map;
+import java.util.function.Supplier;
 
 /**
  * Collects JVM metrics during migration execution using JMX.
@@ -21,12 +23,17 @@ import java.util.Map;
  *   <li>CPU load (before, after, and peak)</li>
  *   <li>Per-phase timing using functional-style {@link #timed(Phase, ThrowingRunnable)}</li>
  *   <li>Object counts (migrated and patched)</li>
+ *   <li>The pre-migration census of the source classes</li>
+ *   <li>The unreachable source instances a reachable snapshot left out</li>
+ *   <li>The old objects and references left over after the critical phase</li>
+ *   <li>Native heap-operation times, per phase and overall, when a source is set with
+ *       {@link #heapOpTimes(Supplier)}</li>
  * </ul>
  *
  * <h2>Usage:</h2>
  * <pre>
  * MigrationMetricsCollector collector = new MigrationMetricsCollector();
- * collector.start(migrationId);
+ * collector.start(migrationId).heapOpTimes(heapWalker::opTimes);
  *
  * collector.timed(Phase.FIRST_PASS, () -&gt; performFirstPass());
  * collector.objectsMigrated(count);
@@ -43,7 +50,10 @@ public final class MigrationMetricsCollector {
     private final int availableProcessors = Runtime.getRuntime().availableProcessors();
 
     private final Map<Phase, Long> phaseDurations = new EnumMap<>(Phase.class);
+    private final Map<Phase, HeapOpTimes> phaseHeapOps = new EnumMap<>(Phase.class);
     private MigrationMetrics.Builder builder;
+    private Supplier<HeapOpTimes> heapOpSource = () -> HeapOpTimes.NONE;
+    private HeapOpTimes heapOpsAtStart = HeapOpTimes.NONE;
 
     private Instant startTime;
     private double cpuLoadPeak;
@@ -57,6 +67,9 @@ public final class MigrationMetricsCollector {
     public MigrationMetricsCollector start(long migrationId) {
         this.startTime = Instant.now();
         this.phaseDurations.clear();
+        this.phaseHeapOps.clear();
+        this.heapOpSource = () -> HeapOpTimes.NONE;
+        this.heapOpsAtStart = HeapOpTimes.NONE;
         this.builder = MigrationMetrics.builder();
 
         MemoryUsage heap = memoryBean.getHeapMemoryUsage();
@@ -73,6 +86,28 @@ public final class MigrationMetricsCollector {
         return this;
     }
 
+    /**
+     * Sets where native heap-operation times are read from. Each timed phase then records the
+     * operations run while it ran, and {@link #finish()} those run since this call.
+     *
+     * @param source cumulative heap-operation times, typically {@code heapWalker::opTimes}
+     * @return this collector for method chaining
+     */
+    public MigrationMetricsCollector heapOpTimes(Supplier<HeapOpTimes> source) {
+        requireStarted();
+        this.heapOpSource = source != null ? source : () -> HeapOpTimes.NONE;
+        this.heapOpsAtStart = readHeapOps();
+        return this;
+    }
+
+    /**
+     * @param phase a timed phase
+     * @return the heap operations recorded for the phase so far, or {@link HeapOpTimes#NONE}
+     */
+    public HeapOpTimes heapOps(Phase phase) {
+        return phaseHeapOps.getOrDefault(phase, HeapOpTimes.NONE);
+    }
+
     /** @throws IllegalStateException if {@link #start(long)} has not been called yet. */
     private void requireStarted() {
         if (builder == null) {
@@ -96,10 +131,12 @@ public final class MigrationMetricsCollector {
     public <E extends Exception> void timed(Phase phase, ThrowingRunnable<E> action) throws E {
         requireStarted();
         long start = System.nanoTime();
+        HeapOpTimes opsBefore = readHeapOps();
         try {
             action.run();
         } finally {
             phaseDurations.put(phase, Duration.ofNanos(System.nanoTime() - start).toMillis());
+            recordHeapOps(phase, opsBefore);
             sampleCpu();
         }
     }
@@ -110,10 +147,12 @@ public final class MigrationMetricsCollector {
     public <T, E extends Exception> T timed(Phase phase, ThrowingSupplier<T, E> action) throws E {
         requireStarted();
         long start = System.nanoTime();
+        HeapOpTimes opsBefore = readHeapOps();
         try {
             return action.get();
         } finally {
             phaseDurations.put(phase, Duration.ofNanos(System.nanoTime() - start).toMillis());
+            recordHeapOps(phase, opsBefore);
             sampleCpu();
         }
     }
@@ -142,6 +181,70 @@ public final class MigrationMetricsCollector {
         return this;
     }
 
+    /**
+     * Records the census of the source classes taken before the first pass.
+     *
+     * @param instances    the number of source-class instances
+     * @param shallowBytes their total shallow size in bytes
+     * @return this collector for method chaining
+     */
+    public MigrationMetricsCollector sourceCensus(long instances, long shallowBytes) {
+        requireStarted();
+        builder.sourceCensus(instances, shallowBytes);
+        return this;
+    }
+
+    /**
+     * Records how many source instances the census counted but the reachable first-pass snapshot
+     * left out.
+     *
+     * @param count the number of unreachable source instances not migrated
+     * @return this collector for method chaining
+     */
+    public MigrationMetricsCollector unreachableSkipped(long count) {
+        requireStarted();
+        builder.unreachableSkipped(count);
+        return this;
+    }
+
+    /**
+     * Records the result of the residual-reference verification.
+     *
+     * @param objects    the old objects still reachable
+     * @param references the references into them from outside the old objects
+     * @return this collector for method chaining
+     */
+    public MigrationMetricsCollector residuals(long objects, long references) {
+        requireStarted();
+        builder.residuals(objects, references);
+        return this;
+    }
+
+    /**
+     * Records the result of stack-local patching.
+     *
+     * @param found     the locals of the suspended threads that referenced an old object
+     * @param rewritten the locals rewritten
+     * @return this collector for method chaining
+     */
+    public MigrationMetricsCollector stackLocals(long found, long rewritten) {
+        requireStarted();
+        builder.stackLocals(found, rewritten);
+        return this;
+    }
+
+    /**
+     * Records the application threads the engine suspended for the critical phase.
+     *
+     * @param suspension the threads suspended and the suspend, resume and pause times
+     * @return this collector for method chaining
+     */
+    public MigrationMetricsCollector suspension(MigrationMetrics.ThreadSuspension suspension) {
+        requireStarted();
+        builder.suspension(suspension);
+        return this;
+    }
+
     /**
      * Records the number of migrators in the migration plan.
      *
@@ -172,10 +275,28 @@ public final class MigrationMetricsCollector {
                 .cpuLoadAfter(cpuLoadAfter)
                 .cpuLoadPeak(Math.max(cpuLoadPeak, cpuLoadAfter))
                 .phaseDurations(phaseDurations)
+                .phaseHeapOps(phaseHeapOps)
+                .heapOps(readHeapOps().minus(heapOpsAtStart))
                 .totalDurationMs(Duration.between(startTime, endTime).toMillis())
                 .build();
     }
 
+    /** Reads the heap-operation source; a failing source counts as no operations. */
+    private HeapOpTimes readHeapOps() {
+        try {
+            HeapOpTimes ops = heapOpSource.get();
+            return ops != null ? ops : HeapOpTimes.NONE;
+        } catch (RuntimeException | LinkageError e) {
+            return HeapOpTimes.NONE;
+        }
+    }
+
+    /** Records the heap operations a phase ran since {@code before}, if any. */
+    private void recordHeapOps(Phase phase, HeapOpTimes before) {
+        HeapOpTimes ops = readHeapOps().minus(before);
+        if (!ops.isEmpty()) phaseHeapOps.put(phase, ops);
+    }
+
     /** Samples current CPU load and raises the running peak if it is higher. */
     private void sampleCpu() {
         double current = getCpuLoad();
@@ -0,0 +1,70 @@
+package migrator.patch;
+
+import java.lang.invoke.MethodHandles;
+import java.lang.invoke.VarHandle;
+import java.util.Objects;
+import java.util.concurrent.atomic.AtomicReferenceArray;
+import java.util.function.ToIntFunction;
+
+/**
+ * {@link VisitedSet} of one bit per object, keyed by the dense index a heap walk assigns to each
+ * object it delivers (0, 1, 2, ... in delivery order).
+ *
+ * <p>Meant for walks that cover every object that can hold a reference to a migrated object (a
+ * FULL or REACHABLE walk): an object the walk has not indexed (yet) is either a leaf, which holds
+ * no such reference, or a member of a later chunk, which the walk still delivers as a root. So
+ * {@link #add} declines it and the traversal leaves it to its own chunk, while {@link #addRoot}
+ * admits any root. The footprint is one bit per index up to the largest one seen, instead of an
+ * identity-map entry per visited object.
+ *
+ * <p>The bits live in pages of {@value #PAGE_BITS} allocated on first use and set atomically, so
+ * the set may be shared by concurrent workers.
+ */
+public final class BitmapVisitedSet implements VisitedSet {
+
+    private static final int PAGE_SHIFT = 16;
+    private static final int PAGE_BITS = 1 << PAGE_SHIFT;
+
+    /** Pages cover every non-negative int index. */
+    private static final int PAGES = 1 << (31 - PAGE_SHIFT);
+
+    private static final VarHandle WORDS = MethodHandles.arrayElementVarHandle(long[].class);
+
+    private final ToIntFunction<Object> index;
+    private final AtomicReferenceArray<long[]> pages = new AtomicReferenceArray<>(PAGES);
+
+    /**
+     * @param index the walk's dense index of an object, or a negative value for an object the
+     *              walk has not indexed
+     */
+    public BitmapVisitedSet(ToIntFunction<Object> index) {
+        this.index = Objects.requireNonNull(index);
+    }
+
+    @Override
+    public boolean add(Object o) {
+        int i = index.applyAsInt(o);
+        return i >= 0 && mark(i);
+    }
+
+    @Override
+    public boolean addRoot(Object o) {
+        int i = index.applyAsInt(o);
+        return i < 0 || mark(i);
+    }
+
+    /** Sets bit {@code i}; true if it was clear. */
+    private boolean mark(int i) {
+        long[] page = page(i >>> PAGE_SHIFT);
+        int word = (i & (PAGE_BITS - 1)) >>> 6;
+        long bit = 1L << i;
+        return ((long) WORDS.getAndBitwiseOr(page, word, bit) & bit) == 0;
+    }
+
+    private long[] page(int p) {
+        long[] page = pages.get(p);
+        if (page != null) return page;
+        long[] fresh = new long[PAGE_BITS >>> 6];
+        return pages.compareAndSet(p, null, fresh) ? fresh : pages.get(p);
+    }
+}
@@ -0,0 +1,47 @@
+package migrator.patch;
+
+import java.util.IdentityHashMap;
+
+/**
+ * Identity visited set shared by the workers of {@link ParallelReferencePatcher}.
+ *
+ * <p>The objects are spread over independently locked {@link IdentityHashMap} stripes by their
+ * identity hash, so workers adding different objects rarely contend for the same lock, and an
+ * object is admitted by exactly one {@link #add} however many workers reach it. It is what
+ * {@link VisitedSet#IDENTITY} opens for a concurrent traversal.
+ */
+final class ConcurrentVisitedSet implements VisitedSet {
+
+    private final IdentityHashMap<Object, Boolean>[] stripes;
+    private final int mask;
+
+    /**
+     * @param concurrency expected number of concurrent writers; the stripe count is a power of two
+     *                    several times larger
+     * @param sizeHint    expected number of objects in total
+     */
+    @SuppressWarnings("unchecked")
+    ConcurrentVisitedSet(int concurrency, int sizeHint) {
+        int n = Integer.highestOneBit(Math.max(1, concurrency) * 16 - 1) << 1;
+        stripes = new IdentityHashMap[n];
+        int perStripe = Math.max(16, sizeHint / n);
+        for (int i = 0; i < n; i++) {
+            stripes[i] = new IdentityHashMap<>(perStripe);
+        }
+        mask = n - 1;
+    }
+
+    private IdentityHashMap<Object, Boolean> stripe(Object o) {
+        int h = System.identityHashCode(o);
+        return stripes[(h ^ (h >>> 16)) & mask];
+    }
+
+    @Override
+    public boolean add(Object o) {
+        IdentityHashMap<Object, Boolean> stripe = stripe(o);
+        synchronized (stripe) {
+            return stripe.put(o, Boolean.TRUE) == null;
+        }
+    }
+
+}
@@ -1,6 +1,7 @@
 package migrator.patch;
 
-import java.util.IdentityHashMap;
+import java.util.Arrays;
+import java.util.Objects;
 
 /**
  * Maps old objects to their migrated counterparts using identity-based comparison.
@@ -11,23 +12,65 @@ import java.util.IdentityHashMap;
  * <p>Key features:
  * <ul>
  *   <li>Identity-based comparison (not equals/hashCode)</li>
- *   <li>Fast O(1) lookups via a single {@link IdentityHashMap} (no per-lookup allocation)</li>
+ *   <li>Open addressing with linear probing over one array of alternating keys and values, kept
+ *       at most half full so probe chains stay short; {@link #ensureCapacity} presizes it from the
+ *       first-pass snapshot, so the table does not resize while the migrators run</li>
+ *   <li>A negative path ahead of hashing: a lookup of an object whose class is not the class of
+ *       any key (a {@code String}, a collection, any non-source object) misses after comparing
+ *       its class with the few key classes</li>
+ *   <li>An optional read-optimized form ({@link #freeze}) for the patch passes, with keys and
+ *       values in separate arrays, so a probe that misses reads only keys</li>
  * </ul>
  *
  * <p>The table is created fresh per migration and lives only for the duration of that
  * migration; the old objects it maps are kept strongly reachable by the engine while it
  * runs, so weak references / GC bookkeeping would add allocation cost without benefit.
  *
- * <p><b>Not thread-safe.</b> The contract is that all {@link #put} calls happen during the
- * migrate pass and complete-before the patch pass begins, after which the table is only read.
- * If reference patching is ever parallelized, this map must be made concurrent (or safely
- * published) accordingly.
+ * <p><b>Not thread-safe for writes.</b> The contract is that all {@link #put} calls happen during
+ * the migrate pass and complete-before the patch pass begins, after which the table is only read.
+ * Concurrent reads of the unmodified table are safe; {@link ParallelReferencePatcher} publishes it to
+ * its workers by submitting each batch to its pool, which happens-after the last {@code put}.
  *
  * @see ReferencePatcher
  */
 public final class ForwardingTable {
 
-    private final IdentityHashMap<Object, Object> map = new IdentityHashMap<>();
+    /** Smallest number of slots; always a power of two. */
+    private static final int MIN_SLOTS = 16;
+
+    /** Largest number of slots of the build form (its array holds two references per slot). */
+    private static final int MAX_SLOTS = 1 << 29;
+
+    /** Key classes tracked for the negative path; with more, every lookup is hashed. */
+    private static final int MAX_KEY_CLASSES = 8;
+
+    private static final Class<?>[] NO_CLASSES = new Class<?>[0];
+
+    /** Build form: key of slot {@code i} at {@code 2i}, its value at {@code 2i + 1}; null when frozen. */
+    private Object[] table;
+
+    /** Frozen form: the same slots as separate arrays; null unless frozen. */
+    private Object[] frozenKeys;
+    private Object[] frozenValues;
+
+    private int size;
+    private int shift;
+
+    /** Distinct classes of the keys put so far, or null once there are too many to be worth checking. */
+    private Class<?>[] keyClasses = NO_CLASSES;
+
+    public ForwardingTable() {
+        allocate(MIN_SLOTS);
+    }
+
+    /**
+     * Creates a table that holds {@code expectedSize} mappings without resizing.
+     *
+     * @param expectedSize the expected number of mappings
+     */
+    public ForwardingTable(int expectedSize) {
+        allocate(slotsFor(expectedSize));
+    }
 
     /**
      * Register a mapping from old object to new object.
@@ -36,7 +79,24 @@ public final class ForwardingTable {
      * @param newObj the migrated object
      */
     public void put(Object oldObj, Object newObj) {
-        map.put(oldObj, newObj);
+        Objects.requireNonNull(oldObj, "oldObj");
+        if (frozenKeys != null) thaw();
+        addKeyClass(oldObj.getClass());
+        Object[] tab = table;
+        int mask = (tab.length >> 1) - 1;
+        for (int i = index(oldObj); ; i = (i + 1) & mask) {
+            Object k = tab[i << 1];
+            if (k == oldObj) {
+                tab[(i << 1) + 1] = newObj;
+                return;
+            }
+            if (k == null) {
+                tab[i << 1] = oldObj;
+                tab[(i << 1) + 1] = newObj;
+                if (++size > tab.length >> 2) resize((tab.length >> 1) << 1);
+                return;
+            }
+        }
     }
 
     /**
@@ -46,7 +106,23 @@ public final class ForwardingTable {
      * @return the migrated object, or null if not found
      */
     public Object get(Object oldObj) {
-        return map.get(oldObj);
+        if (oldObj == null || !isKeyClass(oldObj.getClass())) return null;
+        Object[] keys = frozenKeys;
+        if (keys != null) {
+            int mask = keys.length - 1;
+            for (int i = index(oldObj); ; i = (i + 1) & mask) {
+                Object k = keys[i];
+                if (k == oldObj) return frozenValues[i];
+                if (k == null) return null;
+            }
+        }
+        Object[] tab = table;
+        int mask = (tab.length >> 1) - 1;
+        for (int i = index(oldObj); ; i = (i + 1) & mask) {
+            Object k = tab[i << 1];
+            if (k == oldObj) return tab[(i << 1) + 1];
+            if (k == null) return null;
+        }
     }
 
     /**
@@ -56,7 +132,23 @@ public final class ForwardingTable {
      * @return true if a mapping exists
      */
     public boolean contains(Object oldObj) {
-        return map.containsKey(oldObj);
+        if (oldObj == null || !isKeyClass(oldObj.getClass())) return false;
+        Object[] keys = frozenKeys;
+        if (keys != null) {
+            int mask = keys.length - 1;
+            for (int i = index(oldObj); ; i = (i + 1) & mask) {
+                Object k = keys[i];
+                if (k == oldObj) return true;
+                if (k == null) return false;
+            }
+        }
+        Object[] tab = table;
+        int mask = (tab.length >> 1) - 1;
+        for (int i = index(oldObj); ; i = (i + 1) & mask) {
+            Object k = tab[i << 1];
+            if (k == oldObj) return true;
+            if (k == null) return false;
+        }
     }
 
     /**
@@ -65,11 +157,152 @@ public final class ForwardingTable {
      * @param oldObj the original object
      */
     public void remove(Object oldObj) {
-        map.remove(oldObj);
+        if (oldObj == null || !isKeyClass(oldObj.getClass())) return;
+        if (frozenKeys != null) thaw();
+        Object[] tab = table;
+        int mask = (tab.length >> 1) - 1;
+        int i = index(oldObj);
+        for (; ; i = (i + 1) & mask) {
+            Object k = tab[i << 1];
+            if (k == oldObj) break;
+            if (k == null) return;
+        }
+        size--;
+        // Backward-shift deletion: move each later key of the probe run whose home slot does not
+        // lie cyclically in (i, j] into the hole, so no tombstones are needed.
+        for (int j = (i + 1) & mask; ; j = (j + 1) & mask) {
+            Object k = tab[j << 1];
+            if (k == null) break;
+            int home = index(k);
+            boolean stays = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+            if (!stays) {
+                tab[i << 1] = k;
+                tab[(i << 1) + 1] = tab[(j << 1) + 1];
+                i = j;
+            }
+        }
+        tab[i << 1] = null;
+        tab[(i << 1) + 1] = null;
     }
 
-    /** Clear all mappings. */
+    /** Clear all mappings, releasing the table's storage. */
     public void clear() {
-        map.clear();
+        frozenKeys = null;
+        frozenValues = null;
+        keyClasses = NO_CLASSES;
+        size = 0;
+        allocate(MIN_SLOTS);
+    }
+
+    /** @return the number of mappings */
+    public int size() {
+        return size;
+    }
+
+    /**
+     * Grow the table, if needed, so that it holds {@code expectedSize} mappings without resizing.
+     * Called with the first-pass snapshot count before the migrators run.
+     *
+     * @param expectedSize the expected number of mappings
+     */
+    public void ensureCapacity(int expectedSize) {
+        int slots = slotsFor(expectedSize);
+        if (frozenKeys != null) thaw();
+        if (slots > table.length >> 1) resize(slots);
+    }
+
+    /**
+     * Switch to the read-optimized form: keys and values move to separate arrays with the same
+     * slots, so the copy needs no rehashing and a probe that misses reads only keys. A later
+     * {@link #put}, {@link #remove} or {@link #ensureCapacity} switches back first.
+     */
+    public void freeze() {
+        if (frozenKeys != null) return;
+        Object[] tab = table;
+        int slots = tab.length >> 1;
+        Object[] keys = new Object[slots];
+        Object[] values = new Object[slots];
+        for (int i = 0; i < slots; i++) {
+            keys[i] = tab[i << 1];
+            values[i] = tab[(i << 1) + 1];
+        }
+        frozenKeys = keys;
+        frozenValues = values;
+        table = null;
+    }
+
+    /** @return true if the table is in its read-optimized form */
+    public boolean isFrozen() {
+        return frozenKeys != null;
+    }
+
+    private void thaw() {
+        Object[] keys = frozenKeys;
+        Object[] values = frozenValues;
+        Object[] tab = new Object[keys.length << 1];
+        for (int i = 0; i < keys.length; i++) {
+            tab[i << 1] = keys[i];
+            tab[(i << 1) + 1] = values[i];
+        }
+        table = tab;
+        frozenKeys = null;
+        frozenValues = null;
+    }
+
+    private void allocate(int slots) {
+        table = new Object[slots << 1];
+        shift = 32 - Integer.numberOfTrailingZeros(slots);
+    }
+
+    private void resize(int slots) {
+        if (slots > MAX_SLOTS) {
+            if (table.length >> 1 == MAX_SLOTS) throw new IllegalStateException("ForwardingTable is full");
+            slots = MAX_SLOTS;
+        }
+        Object[] old = table;
+        allocate(slots);
+        Object[] tab = table;
+        int mask = slots - 1;
+        for (int s = 0; s < old.length; s += 2) {
+            Object k = old[s];
+            if (k == null) continue;
+            int i = index(k);
+            while (tab[i << 1] != null) i = (i + 1) & mask;
+            tab[i << 1] = k;
+            tab[(i << 1) + 1] = old[s + 1];
+        }
+    }
+
+    /** Home slot of {@code o}: Fibonacci hashing of its identity hash into the top bits. */
+    private int index(Object o) {
+        return (System.identityHashCode(o) * 0x9E3779B9) >>> shift;
+    }
+
+    /** Slots (a power of two) keeping {@code expectedSize} mappings at most half full. */
+    private static int slotsFor(int expectedSize) {
+        if (expectedSize < 0) throw new IllegalArgumentException("expectedSize must not be negative");
+        long wanted = Math.max(MIN_SLOTS, (long) expectedSize * 2);
+        return wanted >= MAX_SLOTS ? MAX_SLOTS : Integer.highestOneBit((int) wanted - 1) << 1;
+    }
+
+    private boolean isKeyClass(Class<?> cls) {
+        Class<?>[] classes = keyClasses;
+        if (classes == null) return true;
+        for (Class<?> c : classes) {
+            if (c == cls) return true;
+        }
+        return false;
+    }
+
+    private void addKeyClass(Class<?> cls) {
+        Class<?>[] classes = keyClasses;
+        if (classes == null || isKeyClass(cls)) return;
+        keyClasses = classes.length == MAX_KEY_CLASSES ? null : appended(classes, cls);
+    }
+
+    private static Class<?>[] appended(Class<?>[] classes, Class<?> cls) {
+        Class<?>[] grown = Arrays.copyOf(classes, classes.length + 1);
+        grown[classes.length] = cls;
+        return grown;
     }
 }
@@ -0,0 +1,24 @@
+package migrator.patch;
+
+import java.util.IdentityHashMap;
+
+/**
+ * The default {@link VisitedSet} of a sequential traversal: an {@link IdentityHashMap}, sized from
+ * the batch's roots when their number is known.
+ */
+final class IdentityVisitedSet implements VisitedSet {
+
+    private final IdentityHashMap<Object, Boolean> seen;
+
+    /**
+     * @param expectedSize the number of roots the batch is known to have, or 0 if unknown
+     */
+    IdentityVisitedSet(int expectedSize) {
+        seen = expectedSize > 0 ? new IdentityHashMap<>(Math.max(64, expectedSize * 2)) : new IdentityHashMap<>();
+    }
+
+    @Override
+    public boolean add(Object o) {
+        return seen.put(o, Boolean.TRUE) == null;
+    }
+}
@@ -0,0 +1,216 @@
+package migrator.patch;
+
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Deque;
+import java.util.List;
+import java.util.Objects;
+import java.util.Set;
+import java.util.concurrent.ForkJoinPool;
+import java.util.concurrent.ForkJoinWorkerThread;
+import java.util.concurrent.RecursiveAction;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.function.Consumer;
+
+/**
+ * {@link ReferencePatcher} that patches a batch of roots on several threads.
+ *
+ * <p>Each object is processed exactly as by the {@link ReflectionReferencePatcher} it wraps, so
+ * both patch the same fields, elements and containers; only the traversal differs:
+ * <ul>
+ *   <li>The roots are split into tasks of a {@link ForkJoinPool}. Each worker drains a local work
+ *       stack, and while the pool has idle workers it forks the older half of a growing stack off
+ *       as a new task for them to steal.</li>
+ *   <li>One visited set is shared by all workers, so each reachable object is still processed
+ *       once per batch. It comes from the wrapped patcher's
+ *       {@linkplain ReflectionReferencePatcher#setVisitedSets factory}; the default is an identity
+ *       set striped by identity hash.</li>
+ *   <li>Roots, fields and objects are pruned by the wrapped patcher's
+ *       {@linkplain ReflectionReferencePatcher#setMigratedTypes migrated types}, as they are
+ *       sequentially.</li>
+ *   <li>JDK containers are rebuilt under a lock striped by the container's identity, never its own
+ *       monitor, which a suspended application thread may hold. At most one worker rewrites a
+ *       given container at a time.</li>
+ *   <li>The {@link ForwardingTable} is only read: every {@code put} of the first pass happens
+ *       before the batch is submitted to the pool.</li>
+ * </ul>
+ *
+ * <p>Single roots ({@link #patchObject}), static fields and referrer walks are small and go to the
+ * wrapped patcher on the calling thread. The pool's workers are daemon threads named
+ * {@code migration-patch-N}, which exit after a short idle period; {@link #close()} stops them at
+ * once.
+ *
+ * @see ReflectionReferencePatcher
+ */
+public final class ParallelReferencePatcher implements ReferencePatcher, AutoCloseable {
+
+    /** Roots per leaf task when a batch is first split. */
+    private static final int ROOT_SPLIT = 1024;
+
+    /** Local work-stack depth above which a worker offers half of it to idle workers. */
+    private static final int STACK_SPLIT = 64;
+
+    /** Forks only while the pool has fewer queued tasks than this per worker (see getSurplusQueuedTaskCount). */
+    private static final int SURPLUS_LIMIT = 2;
+
+    private static final int CONTAINER_LOCKS = 256;
+
+    private final ReflectionReferencePatcher patcher;
+    private final int parallelism;
+    private final ForkJoinPool pool;
+    private final Object[] containerLocks = new Object[CONTAINER_LOCKS];
+
+    /**
+     * @param patcher     the patcher that processes each object
+     * @param parallelism number of worker threads (at least 1)
+     */
+    public ParallelReferencePatcher(ReflectionReferencePatcher patcher, int parallelism) {
+        this.patcher = Objects.requireNonNull(patcher);
+        if (parallelism < 1) throw new IllegalArgumentException("parallelism must be at least 1");
+        this.parallelism = parallelism;
+        for (int i = 0; i < CONTAINER_LOCKS; i++) containerLocks[i] = new Object();
+        AtomicInteger ids = new AtomicInteger();
+        ForkJoinPool.ForkJoinWorkerThreadFactory factory = p -> {
+            ForkJoinWorkerThread t = ForkJoinPool.defaultForkJoinWorkerThreadFactory.newThread(p);
+            t.setName("migration-patch-" + ids.incrementAndGet());
+            t.setDaemon(true);
+            return t;
+        };
+        this.pool = new ForkJoinPool(parallelism, factory, null, false,
+                0, parallelism, 1, null, 30, TimeUnit.SECONDS);
+    }
+
+    /** @return the number of worker threads */
+    public int parallelism() {
+        return parallelism;
+    }
+
+    @Override
+    public void patchObject(Object obj) {
+        patcher.patchObject(obj);
+    }
+
+    @Override
+    public void patchObjects(Iterable<?> objects) {
+        if (objects == null) return;
+        Object[] roots = objects instanceof Collection<?> c ? c.toArray() : toArray(objects);
+        try (VisitedSet visited = patcher.getVisitedSets().open(roots.length, parallelism)) {
+            patchChunk(roots, visited);
+        }
+    }
+
+    /**
+     * Chunked counterpart of {@link #patchObjects}: one shared visited set for the whole batch, each
+     * chunk patched in parallel and complete before the sink returns.
+     */
+    @Override
+    public Consumer<Object[]> openBatch() {
+        VisitedSet visited = patcher.getVisitedSets().open(0, parallelism);
+        return chunk -> {
+            if (chunk != null) patchChunk(chunk, visited);
+        };
+    }
+
+    @Override
+    public void patchStaticFields(Class<?> clazz) {
+        patcher.patchStaticFields(clazz);
+    }
+
+    @Override
+    public void patchReferrers(Collection<?> anchors, Set<Object> scope) {
+        patcher.patchReferrers(anchors, scope);
+    }
+
+    @Override
+    public boolean isReferrerAnchor(Object holder) {
+        return patcher.isReferrerAnchor(holder);
+    }
+
+    @Override
+    public boolean isReferrerClimbed(Class<?> cls) {
+        return patcher.isReferrerClimbed(cls);
+    }
+
+    /** Stops the worker threads; patching afterwards fails with {@code RejectedExecutionException}. */
+    @Override
+    public void close() {
+        pool.shutdownNow();
+    }
+
+    private void patchChunk(Object[] roots, VisitedSet visited) {
+        if (roots.length == 0) return;
+        pool.invoke(new PatchTask(roots, 0, roots.length, visited, false));
+    }
+
+    private static Object[] toArray(Iterable<?> objects) {
+        List<Object> list = new ArrayList<>();
+        for (Object o : objects) list.add(o);
+        return list.toArray();
+    }
+
+    /** Processes one object, holding its container lock if it is a JDK container rebuilt in place. */
+    private void process(Object obj, VisitedSet visited, Deque<Object> work) {
+        if (!ReflectionReferencePatcher.isJdkContainer(obj)) {
+            patcher.processOne(obj, visited, work);
+            return;
+        }
+        int h = System.identityHashCode(obj);
+        synchronized (containerLocks[(h ^ (h >>> 16)) & (CONTAINER_LOCKS - 1)]) {
+            patcher.processOne(obj, visited, work);
+        }
+    }
+
+    /**
+     * Patches {@code items[from, to)}: splits a large root range in halves, then drains a local work
+     * stack, forking off part of it whenever other workers are idle. {@code admitted} items are
+     * already in the visited set (they were handed over from another worker's stack).
+     */
+    private final class PatchTask extends RecursiveAction {
+        private final Object[] items;
+        private final int from, to;
+        private final VisitedSet visited;
+        private final boolean admitted;
+
+        PatchTask(Object[] items, int from, int to, VisitedSet visited, boolean admitted) {
+            this.items = items;
+            this.from = from;
+            this.to = to;
+            this.visited = visited;
+            this.admitted = admitted;
+        }
+
+        @Override
+        protected void compute() {
+            if (to - from > ROOT_SPLIT) {
+                int mid = (from + to) >>> 1;
+                invokeAll(new PatchTask(items, from, mid, visited, admitted),
+                          new PatchTask(items, mid, to, visited, admitted));
+                return;
+            }
+            Deque<Object> work = new ArrayDeque<>();
+            for (int i = from; i < to; i++) {
+                Object o = items[i];
+                if (o != null && (admitted || (patcher.mayReach(o) && visited.addRoot(o)))) work.push(o);
+            }
+            List<PatchTask> forked = null;
+            Object obj;
+            while ((obj = work.poll()) != null) {
+                process(obj, visited, work);
+                if (work.size() > STACK_SPLIT && getSurplusQueuedTaskCount() < SURPLUS_LIMIT) {
+                    // hand the older half (the bottom of the stack) to an idle worker
+                    Object[] half = new Object[work.size() / 2];
+                    for (int i = 0; i < half.length; i++) half[i] = work.pollLast();
+                    PatchTask task = new PatchTask(half, 0, half.length, visited, true);
+                    task.fork();
+                    if (forked == null) forked = new ArrayList<>();
+                    forked.add(task);
+                }
+            }
+            if (forked != null) {
+                for (PatchTask task : forked) task.join();
+            }
+        }
+    }
+}
@@ -1,5 +1,10 @@
 package migrator.patch;
 
+import java.util.Arrays;
+import java.util.Collection;
+import java.util.Set;
+import java.util.function.Consumer;
+
 /**
  * Interface for patching object references during migration.
  *
@@ -49,6 +54,20 @@ public interface ReferencePatcher {
         }
     }
 
+    /**
+     * Open a batch whose roots arrive in chunks, e.g. from a chunked heap walk. Every chunk passed
+     * to the returned sink is fully patched before the sink returns, so the caller may drop it
+     * afterwards.
+     *
+     * <p>Implementations may share cycle-detection state across the chunks of one batch, as for
+     * {@link #patchObjects}; the default implementation patches each chunk independently.
+     *
+     * @return a sink patching each chunk of roots it receives (null elements are ignored)
+     */
+    default Consumer<Object[]> openBatch() {
+        return chunk -> patchObjects(Arrays.asList(chunk));
+    }
+
     /**
      * Patch static fields of the given class.
      *
@@ -60,4 +79,56 @@ public interface ReferencePatcher {
      * @param clazz the class whose static fields should be patched (null is safely ignored)
      */
     void patchStaticFields(Class<?> clazz);
+
+    /**
+     * Patch the holders found by a referrer walk, without traversing beyond them.
+     *
+     * <p>{@code anchors} are holders this patcher can rewrite in place (see
+     * {@link #isReferrerAnchor}); {@code scope} is every holder found while climbing from the
+     * migrated objects to those anchors — JDK-internal nodes, backing arrays and immutable
+     * containers. Traversal starts at the anchors and only descends into objects in
+     * {@code scope}, so a {@code HashMap} or immutable {@code List} between an anchor and a
+     * migrated object is rebuilt through its usual container handling, while everything else
+     * reachable from the anchors is left alone. {@link Class} anchors have their static fields
+     * patched.
+     *
+     * <p>The default implementation ignores {@code scope} and patches the anchors' full graphs.
+     *
+     * @param anchors the holders to start from (null is safely ignored)
+     * @param scope   identity set of the objects the traversal may enter
+     */
+    default void patchReferrers(Collection<?> anchors, Set<Object> scope) {
+        patchObjects(anchors);
+    }
+
+    /**
+     * Decide whether a holder found by a referrer walk can be patched in place, or whether the
+     * walk must climb to the holder's own referrers (e.g. a {@code HashMap} node, the backing
+     * array of a JDK collection, an immutable container or a record, all of which are rewritten
+     * through the object that holds them).
+     *
+     * <p>The default treats every holder as an anchor. A patcher that overrides this overrides
+     * {@link #isReferrerClimbed} to match.
+     *
+     * @param holder a holder reported by the referrer walk
+     * @return true if {@link #patchReferrers} may start from this holder
+     */
+    default boolean isReferrerAnchor(Object holder) {
+        return true;
+    }
+
+    /**
+     * Decide, by class, whether a referrer walk must climb past the instances of {@code cls}:
+     * true only for a class whose instances are not {@linkplain #isReferrerAnchor anchors} and
+     * may hold a reference to a migrated object. Lets a heap walker record, in one walk, the
+     * references every level of the climb needs.
+     *
+     * <p>The default climbs no class, as every holder is an anchor.
+     *
+     * @param cls a loaded class
+     * @return true if a referrer walk climbs to the holders of {@code cls}'s instances
+     */
+    default boolean isReferrerClimbed(Class<?> cls) {
+        return false;
+    }
 }
@@ -13,6 +13,7 @@ import java.util.*;
 import java.util.concurrent.CompletableFuture;
 import java.util.concurrent.ConcurrentHashMap;
 import java.util.concurrent.atomic.AtomicReference;
+import java.util.function.Consumer;
 import java.util.stream.Stream;
 
 /**
@@ -21,10 +22,12 @@ import java.util.stream.Stream;
  * <p>Features:
  * <ul>
  *   <li>Module-aware access handling (skips JDK internals)</li>
- *   <li>Identity-based visited set to avoid infinite recursion on cycles</li>
+ *   <li>Pluggable visited set ({@link VisitedSet}) to avoid infinite recursion on cycles</li>
  *   <li>Safe access setup using trySetAccessible / setAccessible fallback</li>
  *   <li>Handles collections, arrays, Optional, Reference, ThreadLocal, etc.</li>
  *   <li>Creates replacement containers for immutable collections</li>
+ *   <li>Optional type-directed pruning ({@link #setMigratedTypes}): fields and objects whose types
+ *       can never lead to a migrated instance are not traversed</li>
  * </ul>
  *
  * @see ForwardingTable
@@ -43,16 +46,67 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
     private final Map<Class<?>, Field[]> instanceFieldCache = new ConcurrentHashMap<>();
     private final Map<Class<?>, Field[]> staticFieldCache = new ConcurrentHashMap<>();
 
+    /** Opens the visited set of each batch ({@link #patchObjects}, {@link #openBatch}). */
+    private volatile VisitedSet.Factory visitedSets = VisitedSet.IDENTITY;
+
+    /** What may reach the migrated types, per class; null traverses everything (see {@link TypeReach}). */
+    private volatile TypeReach reach;
+
     public ReflectionReferencePatcher(ForwardingTable forwarding) {
         this.forwarding = Objects.requireNonNull(forwarding);
     }
 
+    /**
+     * Choose where batches ({@link #patchObjects}, {@link #openBatch}, and the batches of a
+     * {@link ParallelReferencePatcher} over this patcher) keep their visited marks. Single roots,
+     * static fields and referrer walks keep theirs in a small identity set of their own.
+     *
+     * <p>A batch opened by {@link #openBatch} has no end the patcher could see, so its set is not
+     * closed by the patcher; a factory whose sets hold native resources must release them itself
+     * once the batch is done.
+     *
+     * @param visitedSets the factory, or null for {@link VisitedSet#IDENTITY} (the default)
+     */
+    public void setVisitedSets(VisitedSet.Factory visitedSets) {
+        this.visitedSets = visitedSets != null ? visitedSets : VisitedSet.IDENTITY;
+    }
+
+    /** @return the factory of the batches' visited sets */
+    public VisitedSet.Factory getVisitedSets() {
+        return visitedSets;
+    }
+
+    /**
+     * Declare the types whose instances the forwarding table maps, so the traversal can skip what
+     * can never lead to one. A field is not read when its declared type cannot reach a migrated
+     * type, and an object is not scheduled when its class cannot (see {@link TypeReach}): a
+     * {@code String}, a {@code BigDecimal}, or a domain object whose field types close over neither
+     * the migrated types nor {@code Object}, an interface, or an open class. Fields typed
+     * {@code Object}, interfaces, non-final classes and JDK containers are always followed.
+     *
+     * <p>The forwarding table must map only instances of these types (or their subclasses);
+     * anything else it maps may be missed. The analysis is cached per class until the next call.
+     *
+     * @param types the migrated types, or null / empty to traverse everything (the default)
+     */
+    public void setMigratedTypes(Collection<Class<?>> types) {
+        List<Class<?>> known = types == null ? List.of()
+                : types.stream().filter(Objects::nonNull).distinct().toList();
+        this.reach = known.isEmpty() ? null : new TypeReach(known, this::instanceFields);
+    }
+
+    /** @return the migrated types the traversal is pruned by, or an empty list if it is not pruned */
+    public List<Class<?>> getMigratedTypes() {
+        TypeReach r = reach;
+        return r != null ? r.types() : List.of();
+    }
+
     @Override
     public void patchObject(Object obj) {
         if (obj == null) return;
         // Single-root entry point: a fresh per-call visited set. For one root this is the
         // cheapest option (the set stays as small as the root's reachable subgraph).
-        Set<Object> visited = Collections.newSetFromMap(new IdentityHashMap<>());
+        VisitedSet visited = new IdentityVisitedSet(0);
         Deque<Object> work = new ArrayDeque<>();
         enqueue(obj, visited, work);
         drain(visited, work);
@@ -64,16 +118,34 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
      * each reachable object is processed exactly once and the total work is {@code O(V+E)}
      * regardless of how densely the migrated objects reference one another. In-place replacement is
      * idempotent (guarded by {@code forwarding}), so objects reachable from several roots are
-     * deduplicated without changing the result.
+     * deduplicated without changing the result. The visited set comes from
+     * {@link #setVisitedSets the batch factory}.
      */
     @Override
     public void patchObjects(Iterable<?> objects) {
         if (objects == null) return;
         int sizeHint = (objects instanceof Collection<?> c) ? c.size() : 64;
-        Set<Object> visited = Collections.newSetFromMap(new IdentityHashMap<>(Math.max(64, sizeHint * 2)));
+        try (VisitedSet visited = visitedSets.open(sizeHint, 1)) {
+            Deque<Object> work = new ArrayDeque<>();
+            for (Object o : objects) enqueueRoot(o, visited, work);
+            drain(visited, work);
+        }
+    }
+
+    /**
+     * Chunked counterpart of {@link #patchObjects}: one visited set and work queue for the whole
+     * batch, drained after each chunk, so the chunk itself can be released while an object
+     * reachable from several chunks is still processed once.
+     */
+    @Override
+    public Consumer<Object[]> openBatch() {
+        VisitedSet visited = visitedSets.open(0, 1);
         Deque<Object> work = new ArrayDeque<>();
-        for (Object o : objects) enqueue(o, visited, work);
-        drain(visited, work);
+        return chunk -> {
+            if (chunk == null) return;
+            for (Object o : chunk) enqueueRoot(o, visited, work);
+            drain(visited, work);
+        };
     }
 
     @Override
@@ -86,7 +158,7 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
             return;
         }
         // visited set for deep patching static field contents
-        Set<Object> visited = Collections.newSetFromMap(new IdentityHashMap<>());
+        VisitedSet visited = new IdentityVisitedSet(0);
         Deque<Object> work = new ArrayDeque<>();
         for (Field field : staticFields(clazz)) {
             patchStaticField(field, visited, work);
@@ -94,6 +166,79 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
         drain(visited, work);
     }
 
+    /**
+     * Referrer-walk entry point: traverses from {@code anchors} but only into objects in
+     * {@code scope} (the holder chains found by the walk), so each patched holder is reached
+     * through the object that owns it and nothing else reachable from the anchors is visited.
+     */
+    @Override
+    public void patchReferrers(Collection<?> anchors, Set<Object> scope) {
+        if (anchors == null) return;
+        ScopedVisitedSet visited = new ScopedVisitedSet(scope);
+        Deque<Object> work = new ArrayDeque<>();
+        for (Object anchor : anchors) {
+            if (anchor instanceof Class<?> cls) {
+                // static-field holder: the walk reports the declaring class itself
+                if (isJdkClass(cls)) continue;
+                for (Field field : staticFields(cls)) {
+                    patchStaticField(field, visited, work);
+                }
+            } else if (anchor != null && visited.addRoot(anchor)) {
+                work.push(anchor);
+            }
+        }
+        drain(visited, work);
+    }
+
+    /**
+     * A holder is an anchor when it can be rewritten in place: a {@link Class} (static fields),
+     * an instance of a non-JDK, non-record class, or an array of a non-JDK element type. JDK
+     * internals (map nodes, collection backing arrays, immutable containers) and records must be
+     * rebuilt or replaced through whatever holds them, so the walk climbs past them.
+     */
+    @Override
+    public boolean isReferrerAnchor(Object holder) {
+        if (holder == null) return false;
+        return holder instanceof Class<?> || isAnchorClass(holder.getClass());
+    }
+
+    /**
+     * A class is climbed when its instances are not anchors and can hold a reference at all: a JDK
+     * class or record with an instance field of a reference type other than a primitive array, or
+     * an array of such a type. The other non-anchors (strings, boxed primitives, primitive arrays)
+     * never hold a migrated object, so a chain walk need not record the references into them.
+     */
+    @Override
+    public boolean isReferrerClimbed(Class<?> cls) {
+        if (cls == null || cls == Class.class || isAnchorClass(cls)) return false;
+        if (cls.isArray()) return mayHoldReference(cls.getComponentType());
+        try {
+            for (Class<?> c = cls; c != null; c = c.getSuperclass()) {
+                for (Field f : c.getDeclaredFields()) {
+                    if (!Modifier.isStatic(f.getModifiers()) && mayHoldReference(f.getType())) return true;
+                }
+            }
+            return false;
+        } catch (LinkageError | SecurityException e) {
+            return true;
+        }
+    }
+
+    /** An instance of {@code cls} is an anchor (see {@link #isReferrerAnchor}). */
+    private static boolean isAnchorClass(Class<?> cls) {
+        if (cls.isArray()) {
+            Class<?> component = cls.getComponentType();
+            while (component.isArray()) component = component.getComponentType();
+            return !component.isPrimitive() && !isJdkClass(component);
+        }
+        return !isJdkClass(cls) && !cls.isRecord();
+    }
+
+    /** A slot declared as {@code type} can hold a reference to an arbitrary object. */
+    private static boolean mayHoldReference(Class<?> type) {
+        return !type.isPrimitive() && !(type.isArray() && type.getComponentType().isPrimitive());
+    }
+
     // ── Internal iterative implementation ───────────────────────────────────────────────
     //
     // The object graph is traversed with an explicit work-stack rather than recursion:
@@ -101,23 +246,47 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
     // O(N) long, which would overflow the call stack. enqueue() schedules each not-yet-seen
     // object once; in-place replacements happen when the *holder* is processed.
 
-    /** Schedule {@code o} for processing if it hasn't been seen. */
-    private static void enqueue(Object o, Set<Object> visited, Deque<Object> work) {
-        if (o != null && visited.add(o)) {
+    /** Schedule {@code o} for processing if it hasn't been seen and may reach a migrated type. */
+    private void enqueue(Object o, VisitedSet visited, Deque<Object> work) {
+        if (o != null && mayReach(o)) {
+            schedule(o, visited, work);
+        }
+    }
+
+    /** {@link #enqueue} for a value already known to {@linkplain #mayReach reach}. */
+    private static void schedule(Object o, VisitedSet visited, Deque<Object> work) {
+        if (visited.add(o)) {
             work.push(o);
         }
     }
 
+    /** Schedule a root of the batch for processing if it hasn't been seen (see {@link VisitedSet#addRoot}). */
+    private void enqueueRoot(Object o, VisitedSet visited, Deque<Object> work) {
+        if (o != null && mayReach(o) && visited.addRoot(o)) {
+            work.push(o);
+        }
+    }
+
+    /** True unless the traversal is pruned and {@code o}'s class can never lead to a migrated instance. */
+    boolean mayReach(Object o) {
+        TypeReach r = reach;
+        return r == null || r.exact(o.getClass());
+    }
+
     /** Process the work-stack until empty. */
-    private void drain(Set<Object> visited, Deque<Object> work) {
+    private void drain(VisitedSet visited, Deque<Object> work) {
         Object obj;
         while ((obj = work.poll()) != null) {
             processOne(obj, visited, work);
         }
     }
 
-    /** Processes one dequeued object: patches array elements, JDK-container contents, or instance fields. */
-    private void processOne(Object obj, Set<Object> visited, Deque<Object> work) {
+    /**
+     * Processes one dequeued object: patches array elements, JDK-container contents, or instance
+     * fields, scheduling what it reaches through {@code visited} / {@code work}. Safe to call from
+     * several threads at once on different objects (see {@link ParallelReferencePatcher}).
+     */
+    void processOne(Object obj, VisitedSet visited, Deque<Object> work) {
         Class<?> cls = obj.getClass();
 
         if (cls.isArray()) {
@@ -141,7 +310,13 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
             return;
         }
 
-        for (Field field : instanceFields(cls)) {
+        TypeReach r = reach;
+        Field[] fields = instanceFields(cls);
+        if (r != null) {
+            for (int i : r.reachingFields(cls)) patchField(obj, fields[i], visited, work);
+            return;
+        }
+        for (Field field : fields) {
             patchField(obj, field, visited, work);
         }
     }
@@ -150,7 +325,7 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
      * Handle JDK container types by recursing into their contents.
      * We don't modify JDK internal fields, but we do patch/recurse their contained objects.
      */
-    private void patchJdkContainer(Object obj, Set<Object> visited, Deque<Object> work) {
+    private void patchJdkContainer(Object obj, VisitedSet visited, Deque<Object> work) {
         if (obj instanceof List<?> list) {
             patchList(list, visited, work);
         } else if (obj instanceof Map<?, ?> map) {
@@ -167,7 +342,7 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
 
     /** Replaces migrated elements of a List in place; non-migrated elements are scheduled for traversal. */
     @SuppressWarnings("unchecked")
-    private void patchList(List<?> list, Set<Object> visited, Deque<Object> work) {
+    private void patchList(List<?> list, VisitedSet visited, Deque<Object> work) {
         List<Object> mutableList = (List<Object>) list;
 
         // RandomAccess lists (ArrayList, CopyOnWriteArrayList) are cheapest by index; for
@@ -211,7 +386,7 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
 
     /** Replaces migrated elements of a non-List collection via bulk remove/add; recurses into the rest. */
     @SuppressWarnings("unchecked")
-    private void patchCollection(Collection<?> collection, Set<Object> visited, Deque<Object> work) {
+    private void patchCollection(Collection<?> collection, VisitedSet visited, Deque<Object> work) {
         // Rebuild the collection in iteration order rather than removeAll()/addAll():
         //  - ordered collections (queues, deques, LinkedHashSet) keep their element order
         //  - matching stays identity-based, not the equals/hashCode semantics of removeAll(),
@@ -243,7 +418,7 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
 
     /** Replaces migrated keys/values of a Map (re-inserting changed entries); recurses into unchanged ones. */
     @SuppressWarnings("unchecked")
-    private void patchMap(Map<?, ?> map, Set<Object> visited, Deque<Object> work) {
+    private void patchMap(Map<?, ?> map, VisitedSet visited, Deque<Object> work) {
         Map<Object, Object> mutableMap = (Map<Object, Object>) map;
 
         // Rebuild in iteration order so replaced entries keep their position; unchanged keys and
@@ -326,7 +501,7 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
     }
 
     /** Recurses into an Optional's value; the immutable Optional itself is replaced at its holding field. */
-    private void patchOptional(Optional<?> optional, Set<Object> visited, Deque<Object> work) {
+    private void patchOptional(Optional<?> optional, VisitedSet visited, Deque<Object> work) {
         if (optional.isEmpty()) return;
 
         Object val = optional.get();
@@ -342,7 +517,7 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
     }
 
     /** Recurses into a Reference's referent; the immutable Reference itself is replaced at its holding field. */
-    private void patchReference(Reference<?> ref, Set<Object> visited, Deque<Object> work) {
+    private void patchReference(Reference<?> ref, VisitedSet visited, Deque<Object> work) {
         Object val = ref.get();
         if (val == null) return;
 
@@ -622,11 +797,11 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
     }
 
     /** Replaces migrated elements of an object array in place; non-migrated elements are scheduled for traversal. */
-    private void patchArray(Object array, Set<Object> visited, Deque<Object> work) {
+    private void patchArray(Object array, VisitedSet visited, Deque<Object> work) {
         int len = Array.getLength(array);
         for (int i = 0; i < len; i++) {
             Object val = Array.get(array, i);
-            if (val == null) continue;
+            if (val == null || !mayReach(val)) continue;
 
             Object replacement = resolveReplacement(val);
             if (replacement != null && replacement != val) {
@@ -637,25 +812,26 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
                     log.debug("Failed to set array element at index {}: {}", i, e.getMessage());
                 }
             } else {
-                enqueue(val, visited, work);
+                schedule(val, visited, work);
             }
         }
     }
 
     // Fields are pre-filtered (no JDK-declared fields) and made accessible at cache time,
     // so the per-object path here is just get -> forwarding lookup -> set.
-    private void patchField(Object obj, Field field, Set<Object> visited, Deque<Object> work) {
+    private void patchField(Object obj, Field field, VisitedSet visited, Deque<Object> work) {
         try {
             Object val = field.get(obj);
-            if (val == null) return;
+            if (val == null || !mayReach(val)) return;
 
             // forwarding replacement first, then immutable-container rebuild (records, Optional,
-            // immutable collections, references); otherwise schedule for traversal.
+            // immutable collections, references); otherwise schedule for traversal. A value whose
+            // class cannot reach a migrated type is neither replaced nor rebuilt, so it is skipped.
             Object replacement = resolveReplacement(val);
             if (replacement != null && replacement != val) {
                 field.set(obj, replacement);
             } else {
-                enqueue(val, visited, work);
+                schedule(val, visited, work);
             }
         } catch (IllegalAccessException | IllegalArgumentException e) {
             // best-effort: log and continue. IllegalArgumentException occurs when the
@@ -666,7 +842,7 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
     }
 
     /** Patches a single static field: replaces a migrated value or container, otherwise schedules its value. */
-    private void patchStaticField(Field field, Set<Object> visited, Deque<Object> work) {
+    private void patchStaticField(Field field, VisitedSet visited, Deque<Object> work) {
         try {
             Object val = field.get(null);
             if (val == null) return;
@@ -691,8 +867,38 @@ public final class ReflectionReferencePatcher implements ReferencePatcher {
         }
     }
 
+    /**
+     * Visited set for {@link #patchReferrers}: {@link #add} admits only objects in the referrer
+     * scope, so {@code enqueue} never schedules anything outside the holder chains. Anchors are
+     * admitted explicitly via {@link #addRoot}.
+     */
+    private static final class ScopedVisitedSet implements VisitedSet {
+        private final Set<Object> scope;
+        private final Set<Object> seen = Collections.newSetFromMap(new IdentityHashMap<>());
+
+        ScopedVisitedSet(Set<Object> scope) {
+            this.scope = scope != null ? scope : Set.of();
+        }
+
+        @Override public boolean add(Object o) { return scope.contains(o) && seen.add(o); }
+        @Override public boolean addRoot(Object o) { return seen.add(o); }
+    }
+
     // ── Field enumeration helpers ───────────────────────────────────────────────
 
+    /** True for classes in a {@code java.*} / {@code jdk.*} module, whose internals are never patched. */
+    static boolean isJdkClass(Class<?> cls) {
+        Module module = cls.getModule();
+        String name = module != null ? module.getName() : null;
+        return name != null && (name.startsWith("java") || name.startsWith("jdk"));
+    }
+
+    /** True if {@code obj} is a JDK container whose contents {@link #processOne} rewrites in place. */
+    static boolean isJdkContainer(Object obj) {
+        Class<?> cls = obj.getClass();
+        return !cls.isArray() && isJdkClass(cls);
+    }
+
     /** Returns the cached non-static, non-primitive, non-JDK, accessible instance fields of a class. */
     private Field[] instanceFields(Class<?> cls) {
         return instanceFieldCache.computeIfAbsent(cls, c -> getAllFields(c)
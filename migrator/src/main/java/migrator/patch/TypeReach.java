@@ -0,0 +1,170 @@
+package migrator.patch;
+
+import java.lang.ref.Reference;
+import java.lang.reflect.Field;
+import java.lang.reflect.Modifier;
+import java.util.ArrayDeque;
+import java.util.Arrays;
+import java.util.Collection;
+import java.util.Deque;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Optional;
+import java.util.Set;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicReference;
+import java.util.function.Function;
+
+/**
+ * Which classes can lead a patch traversal to an instance of a migrated type. The answer comes from
+ * declared types alone, and {@link ReflectionReferencePatcher} works it out the first time it meets
+ * a class.
+ *
+ * <p>A <i>declared</i> type (of a field, or an array's component) may reach a migrated type when
+ * <ul>
+ *   <li>it is a supertype or subtype of a migrated type, {@code Object} and the migrated types'
+ *       interfaces included;</li>
+ *   <li>it is an array whose component type may reach;</li>
+ *   <li>it is a final class (records and most enums included) with a patchable field that may
+ *       reach, or a sealed type with a permitted subtype, or a field of its own, that may reach;</li>
+ *   <li>it is any other interface or non-final class. A subclass the analysis cannot see could hold
+ *       anything, so these stay conservative, as do the JDK containers the patcher looks into
+ *       (collections, maps, {@code Optional}, references, {@code AtomicReference},
+ *       {@code CompletableFuture}), whose contents are untyped at run time.</li>
+ * </ul>
+ * Other final JDK classes ({@code String}, boxed primitives, ...) cannot: the patcher never looks
+ * inside them. An object's <i>exact</i> class is judged as if it were final, so an instance of a
+ * non-final domain class is skipped when none of its own fields may reach.
+ *
+ * <p>Each answer is a search of the declared-type graph from the class asked about: it may reach
+ * when the search meets a type that may reach by itself. A negative answer holds for every type the
+ * search met, so all of them are cached at once.
+ */
+final class TypeReach {
+
+    private final Class<?>[] types;
+    private final Function<Class<?>, Field[]> fields;
+
+    private final Map<Class<?>, Boolean> declared = new ConcurrentHashMap<>();
+    private final Map<Class<?>, Boolean> exact = new ConcurrentHashMap<>();
+    private final Map<Class<?>, int[]> reachingFields = new ConcurrentHashMap<>();
+
+    /**
+     * @param types  the migrated types (never empty)
+     * @param fields the patchable instance fields of a class, the ones the traversal follows
+     */
+    TypeReach(Collection<Class<?>> types, Function<Class<?>, Field[]> fields) {
+        this.types = types.toArray(new Class<?>[0]);
+        this.fields = fields;
+    }
+
+    /** @return the migrated types */
+    List<Class<?>> types() {
+        return List.of(types);
+    }
+
+    /** @return true if an object of exactly {@code cls} may be, or lead to, a migrated instance */
+    boolean exact(Class<?> cls) {
+        Boolean known = exact.get(cls);
+        return known != null ? known : search(cls, true);
+    }
+
+    /** @return true if a value declared as {@code type} may be, or lead to, a migrated instance */
+    boolean declared(Class<?> type) {
+        Boolean known = declared.get(type);
+        return known != null ? known : search(type, false);
+    }
+
+    /**
+     * @param cls a class that {@linkplain #exact may reach}
+     * @return the indices, among its patchable fields, of the fields whose declared type may reach
+     */
+    int[] reachingFields(Class<?> cls) {
+        int[] slots = reachingFields.get(cls);
+        if (slots == null) {
+            slots = reachingFields.computeIfAbsent(cls, c -> {
+                Field[] all = fields.apply(c);
+                int[] found = new int[all.length];
+                int n = 0;
+                for (int i = 0; i < all.length; i++) {
+                    if (declared(all[i].getType())) found[n++] = i;
+                }
+                return Arrays.copyOf(found, n);
+            });
+        }
+        return slots;
+    }
+
+    /** Searches the declared-type graph from {@code start} and caches the answer. */
+    private boolean search(Class<?> start, boolean startExact) {
+        Deque<Class<?>> pending = new ArrayDeque<>();
+        Set<Class<?>> met = new HashSet<>();
+        boolean reaches;
+        if (startExact) {
+            reaches = expand(start, true, pending);
+        } else {
+            pending.push(start);
+            reaches = false;
+        }
+        Class<?> type;
+        while (!reaches && (type = pending.poll()) != null) {
+            if (!met.add(type)) continue;
+            Boolean known = declared.get(type);
+            reaches = known != null ? known : expand(type, false, pending);
+        }
+        if (startExact) {
+            exact.put(start, reaches);
+        } else {
+            declared.put(start, reaches);
+        }
+        if (!reaches) {
+            for (Class<?> t : met) declared.put(t, Boolean.FALSE);
+        }
+        return reaches;
+    }
+
+    /**
+     * Pushes the declared types a value of {@code type} leads the traversal to.
+     *
+     * @return true if {@code type} may reach by itself, whatever it leads to
+     */
+    private boolean expand(Class<?> type, boolean isExact, Deque<Class<?>> next) {
+        if (type.isPrimitive()) return false;
+        if (type.isArray()) {
+            next.push(type.getComponentType());
+            return false;
+        }
+        for (Class<?> t : types) {
+            if (type.isAssignableFrom(t) || t.isAssignableFrom(type)) return true;
+        }
+        boolean closed = isExact || Modifier.isFinal(type.getModifiers());
+        if (ReflectionReferencePatcher.isJdkClass(type)) {
+            return !closed || isJdkHolder(type);
+        }
+        if (closed) {
+            for (Field f : fields.apply(type)) next.push(f.getType());
+            return false;
+        }
+        if (type.isSealed()) {
+            for (Class<?> permitted : type.getPermittedSubclasses()) next.push(permitted);
+            if (!type.isInterface() && !Modifier.isAbstract(type.getModifiers())) {
+                for (Field f : fields.apply(type)) next.push(f.getType());
+            }
+            return false;
+        }
+        return true;
+    }
+
+    /** True for the JDK classes whose contents the patcher patches or rebuilds. */
+    private static boolean isJdkHolder(Class<?> cls) {
+        return Collection.class.isAssignableFrom(cls)
+                || Map.class.isAssignableFrom(cls)
+                || Optional.class.isAssignableFrom(cls)
+                || Reference.class.isAssignableFrom(cls)
+                || AtomicReference.class.isAssignableFrom(cls)
+                || CompletableFuture.class.isAssignableFrom(cls)
+                || cls.isRecord();
+    }
+}
@@ -0,0 +1,59 @@
+package migrator.patch;
+
+/**
+ * The objects a patch traversal has already scheduled, so each reachable object is processed
+ * once per traversal and cycles terminate.
+ *
+ * <p>{@link ReflectionReferencePatcher} opens one per batch through its {@link Factory}: the
+ * default keeps the objects in an identity hash set, which costs the Java heap a few words per
+ * object visited. Other implementations keep the marks elsewhere, e.g. as JVMTI tags in the
+ * agent, or as bits keyed by the dense index a heap walk assigns its objects
+ * ({@link BitmapVisitedSet}).
+ *
+ * @see ReflectionReferencePatcher#setVisitedSets(Factory)
+ */
+public interface VisitedSet extends AutoCloseable {
+
+    /** Identity hash sets for every batch; thread-safe ones for concurrent traversals. */
+    Factory IDENTITY = (expectedSize, concurrency) -> concurrency > 1
+            ? new ConcurrentVisitedSet(concurrency, expectedSize * 2)
+            : new IdentityVisitedSet(expectedSize);
+
+    /**
+     * Marks {@code o} as visited.
+     *
+     * @param o an object reached by the traversal (never null)
+     * @return true if {@code o} is to be processed now, false if it was already visited or is
+     *         left to a later root
+     */
+    boolean add(Object o);
+
+    /**
+     * Marks a root of the batch as visited. A root is processed unless it was already visited;
+     * implementations that decline unknown objects in {@link #add} must still admit them here.
+     *
+     * @param o a root of the batch (never null)
+     * @return true if {@code o} is to be processed now
+     */
+    default boolean addRoot(Object o) {
+        return add(o);
+    }
+
+    /** Releases what the set holds outside the Java heap; the set is not used afterwards. */
+    @Override
+    default void close() {
+    }
+
+    /** Opens the visited set of one patch batch. */
+    @FunctionalInterface
+    interface Factory {
+
+        /**
+         * @param expectedSize the number of roots the batch is known to have, or 0 if unknown
+         * @param concurrency  the number of threads that call {@link #add} concurrently (1 for a
+         *                     sequential traversal)
+         * @return a new, empty visited set
+         */
+        VisitedSet open(int expectedSize, int concurrency);
+    }
+}
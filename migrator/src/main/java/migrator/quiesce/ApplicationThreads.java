@@ -0,0 +1,71 @@
+package migrator.quiesce;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.List;
+
+/**
+ * Chooses the threads an engine-managed quiescence suspends: every live platform thread of the
+ * application, except
+ * <ul>
+ *   <li>the calling (migrating) thread,</li>
+ *   <li>the migrator's own threads, whose names start with {@value #MIGRATOR_THREAD_PREFIX},</li>
+ *   <li>JDK threads: those in the root {@code "system"} thread group (reference handler,
+ *       finalizer, signal dispatcher, attach listener) and the JDK's innocuous threads,</li>
+ *   <li>threads on the allowlist.</li>
+ * </ul>
+ *
+ * <p>An allowlist entry is a thread name, or a name prefix when it ends with {@code '*'}
+ * ({@code "grpc-default-executor-*"}). Virtual threads are not listed; they stop with the carrier
+ * threads they are mounted on.
+ */
+public final class ApplicationThreads {
+
+    /** Name prefix of the threads the migrator starts itself; they are never suspended. */
+    public static final String MIGRATOR_THREAD_PREFIX = "migration-";
+
+    private ApplicationThreads() {
+        // Utility class
+    }
+
+    /**
+     * @param allowlist thread names (or prefixes ending with {@code '*'}) to leave running; may be null
+     * @return the application threads to suspend, as of now
+     */
+    public static List<Thread> select(Collection<String> allowlist) {
+        Thread self = Thread.currentThread();
+        List<Thread> selected = new ArrayList<>();
+        for (Thread t : Thread.getAllStackTraces().keySet()) {
+            if (t == self || !t.isAlive() || t.isVirtual()) continue;
+            if (isMigratorThread(t) || isJdkThread(t) || isAllowed(t.getName(), allowlist)) continue;
+            selected.add(t);
+        }
+        return selected;
+    }
+
+    /** @return true if the thread was started by the migrator itself */
+    static boolean isMigratorThread(Thread t) {
+        return t.getName().startsWith(MIGRATOR_THREAD_PREFIX);
+    }
+
+    /** @return true if the thread belongs to the JDK rather than the application */
+    static boolean isJdkThread(Thread t) {
+        ThreadGroup group = t.getThreadGroup();
+        if (group != null && group.getParent() == null) return true;
+        return t.getClass().getName().equals("jdk.internal.misc.InnocuousThread");
+    }
+
+    /** @return true if {@code name} matches an allowlist entry */
+    static boolean isAllowed(String name, Collection<String> allowlist) {
+        if (allowlist == null || name == null) return false;
+        for (String entry : allowlist) {
+            if (entry == null || entry.isEmpty()) continue;
+            if (entry.endsWith("*")
+                    ? name.startsWith(entry.substring(0, entry.length() - 1))
+                    : name.equals(entry)) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
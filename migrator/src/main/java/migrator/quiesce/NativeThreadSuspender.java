@@ -0,0 +1,54 @@
+package migrator.quiesce;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.List;
+import java.util.Objects;
+
+import migrator.exceptions.MigrateException;
+
+/**
+ * Native implementation of {@link ThreadSuspender}: one JVMTI {@code SuspendThreadList} call
+ * suspends every thread, and one {@code ResumeThreadList} call resumes them. Both return once
+ * every listed thread has reached the requested state, so the reported times are the latency the
+ * critical phase pays for suspending and resuming.
+ *
+ * <p><strong>Note:</strong> Requires the native migrator library to be loaded.
+ */
+public final class NativeThreadSuspender implements ThreadSuspender {
+
+    private static native long nativeSuspendThreads(Thread[] threads, int[] errors);
+    private static native long nativeResumeThreads(Thread[] threads, int[] errors);
+
+    @Override
+    public SuspendResult suspend(Collection<Thread> threads) throws MigrateException {
+        Thread[] list = toArray(threads);
+        int[] errors = new int[list.length];
+        long nanos = nativeSuspendThreads(list, errors);
+        if (nanos < 0) throw new MigrateException("Thread suspension is not available in this VM");
+        return result(list, errors, nanos);
+    }
+
+    @Override
+    public SuspendResult resume(Collection<Thread> threads) {
+        Thread[] list = toArray(threads);
+        int[] errors = new int[list.length];
+        long nanos = nativeResumeThreads(list, errors);
+        if (nanos < 0) return new SuspendResult(List.of(), list.length, 0);
+        return result(list, errors, nanos);
+    }
+
+    private static Thread[] toArray(Collection<Thread> threads) {
+        if (threads == null) return new Thread[0];
+        return threads.stream().filter(Objects::nonNull).distinct().toArray(Thread[]::new);
+    }
+
+    /** Splits the listed threads by their JVMTI error: 0 means the call succeeded for that thread. */
+    private static SuspendResult result(Thread[] list, int[] errors, long nanos) {
+        List<Thread> done = new ArrayList<>(list.length);
+        for (int i = 0; i < list.length; i++) {
+            if (errors[i] == 0) done.add(list[i]);
+        }
+        return new SuspendResult(done, list.length - done.size(), nanos);
+    }
+}
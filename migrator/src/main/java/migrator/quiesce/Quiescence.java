@@ -0,0 +1,154 @@
+package migrator.quiesce;
+
+import java.time.Duration;
+import java.util.Collection;
+import java.util.List;
+import java.util.concurrent.atomic.AtomicReference;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import migrator.exceptions.MigrateException;
+
+/**
+ * One engine-managed stop-the-world pause: the application threads suspended for a critical
+ * phase, resumed exactly once by {@link #resume()} (or {@link #close()}).
+ *
+ * <p>With a maximum pause, a watchdog thread resumes the threads itself if the pause runs longer.
+ * A suspended thread may hold a lock the migrating thread then waits for; the watchdog turns such
+ * a deadlock into an over-long pause, at the price of letting the application run before the
+ * critical phase ends. That is logged as an error.
+ *
+ * <p>Timings: {@link #suspendNanos()} and {@link #resumeNanos()} are the latency of the two JVMTI
+ * calls; {@link #pausedNanos()} spans from the start of suspending to the end of resuming, the
+ * longest any suspended thread was stopped.
+ */
+public final class Quiescence implements AutoCloseable {
+
+    private static final Logger log = LoggerFactory.getLogger(Quiescence.class);
+
+    private final ThreadSuspender suspender;
+    private final AtomicReference<List<Thread>> suspended;
+    private final List<Thread> threads;
+    private final int failed;
+    private final long suspendNanos;
+    private final long startNanos;
+    private final Thread watchdog;
+    private volatile long resumeNanos;
+    private volatile long pausedNanos;
+    private volatile boolean resumedByWatchdog;
+
+    private Quiescence(ThreadSuspender suspender, SuspendResult result, long startNanos, Duration maxPause) {
+        this.suspender = suspender;
+        this.suspended = new AtomicReference<>(result.threads());
+        this.threads = result.threads();
+        this.failed = result.failed();
+        this.suspendNanos = result.nanos();
+        this.startNanos = startNanos;
+        this.watchdog = maxPause != null && !maxPause.isZero() && !maxPause.isNegative()
+                ? startWatchdog(maxPause) : null;
+    }
+
+    /**
+     * Suspend the given threads.
+     *
+     * @param suspender the suspender to use
+     * @param threads   the threads to suspend (see {@link ApplicationThreads#select})
+     * @param maxPause  resume the threads after this long even if {@link #resume()} was not
+     *                  called; null or zero for no limit
+     * @return the pause in progress
+     * @throws MigrateException if thread suspension is not available
+     */
+    public static Quiescence begin(ThreadSuspender suspender, Collection<Thread> threads, Duration maxPause)
+            throws MigrateException {
+        long start = System.nanoTime();
+        SuspendResult result = suspender.suspend(threads);
+        return new Quiescence(suspender, result, start, maxPause);
+    }
+
+    private Thread startWatchdog(Duration maxPause) {
+        Thread t = new Thread(() -> {
+            try {
+                Thread.sleep(maxPause.toMillis());
+            } catch (InterruptedException e) {
+                return;
+            }
+            if (resumeOnce()) {
+                resumedByWatchdog = true;
+                log.error("Suspended application threads resumed by the watchdog after {} ms, before the critical phase ended",
+                        maxPause.toMillis());
+            }
+        }, ApplicationThreads.MIGRATOR_THREAD_PREFIX + "quiesce-watchdog");
+        t.setDaemon(true);
+        t.start();
+        return t;
+    }
+
+    /**
+     * Resume the suspended threads, unless already resumed.
+     *
+     * @return true if this call resumed them
+     */
+    public boolean resume() {
+        if (watchdog != null) watchdog.interrupt();
+        return resumeOnce();
+    }
+
+    private boolean resumeOnce() {
+        List<Thread> threads = suspended.getAndSet(null);
+        if (threads == null) return false;
+        SuspendResult result = threads.isEmpty() ? SuspendResult.NONE : suspender.resume(threads);
+        resumeNanos = result.nanos();
+        pausedNanos = System.nanoTime() - startNanos;
+        if (result.failed() > 0) {
+            log.warn("{} of {} suspended thread(s) could not be resumed", result.failed(), threads.size());
+        }
+        return true;
+    }
+
+    /** Same as {@link #resume()}. */
+    @Override
+    public void close() {
+        resume();
+    }
+
+    /** @return the threads suspended (they stay listed after they are resumed) */
+    public List<Thread> threads() {
+        return threads;
+    }
+
+    /** @return the number of threads suspended */
+    public int suspendedCount() {
+        return threads.size();
+    }
+
+    /** @return true while the threads are still suspended */
+    public boolean isSuspended() {
+        return suspended.get() != null;
+    }
+
+    /** @return the number of threads that could not be suspended */
+    public int failedCount() {
+        return failed;
+    }
+
+    /** @return time until every thread was suspended */
+    public long suspendNanos() {
+        return suspendNanos;
+    }
+
+    /** @return time until every thread was resumed (0 while suspended) */
+    public long resumeNanos() {
+        return resumeNanos;
+    }
+
+    /** @return time from the start of suspending to the end of resuming (0 while suspended) */
+    public long pausedNanos() {
+        return pausedNanos;
+    }
+
+    /** @return true if the watchdog, not the caller, resumed the threads */
+    public boolean isResumedByWatchdog() {
+        return resumedByWatchdog;
+    }
+}
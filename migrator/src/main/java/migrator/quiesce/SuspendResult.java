@@ -0,0 +1,21 @@
+package migrator.quiesce;
+
+import java.util.List;
+
+/**
+ * Outcome of one {@link ThreadSuspender#suspend} or {@link ThreadSuspender#resume} call.
+ *
+ * @param threads the threads the call suspended (or resumed)
+ * @param failed  the threads it could not suspend (or resume), e.g. because they had ended
+ * @param nanos   time until every listed thread was suspended (or resumed)
+ */
+public record SuspendResult(List<Thread> threads, int failed, long nanos) {
+
+    /** Nothing was suspended or resumed. */
+    public static final SuspendResult NONE = new SuspendResult(List.of(), 0, 0);
+
+    /** Null-guards and freezes the threads. */
+    public SuspendResult {
+        threads = threads != null ? List.copyOf(threads) : List.of();
+    }
+}
@@ -0,0 +1,37 @@
+package migrator.quiesce;
+
+import java.util.Collection;
+
+import migrator.exceptions.MigrateException;
+
+/**
+ * Suspends and resumes Java threads, so the engine can quiesce an application for the critical
+ * phase without the application's help.
+ *
+ * <p>A suspended thread stops wherever it is, in the middle of a request or holding a lock, and
+ * continues from there when resumed. Callers must therefore never suspend themselves or a thread
+ * they will wait on, and must resume every thread they suspended.
+ *
+ * @see NativeThreadSuspender
+ * @see Quiescence
+ */
+public interface ThreadSuspender {
+
+    /**
+     * Suspend the given threads, returning once each of them is suspended.
+     *
+     * @param threads the threads to suspend (null elements and the calling thread are not suspended)
+     * @return the threads actually suspended, the number that could not be, and the time it took
+     * @throws MigrateException if thread suspension is not available at all
+     */
+    SuspendResult suspend(Collection<Thread> threads) throws MigrateException;
+
+    /**
+     * Resume the given threads. Never throws: threads that are not suspended (or no longer alive)
+     * are counted as failed.
+     *
+     * @param threads the threads to resume
+     * @return the threads resumed, the number that could not be, and the time it took
+     */
+    SuspendResult resume(Collection<Thread> threads);
+}
@@ -1,5 +1,7 @@
 package migrator.state;
 
+import migrator.heap.ReclamationProgress;
+import migrator.heap.WalkProgress;
 import migrator.metrics.MigrationMetrics;
 import migrator.metrics.MigrationMetrics.Phase;
 
@@ -11,6 +13,7 @@ import java.util.List;
 import java.util.Map;
 import java.util.concurrent.locks.ReadWriteLock;
 import java.util.concurrent.locks.ReentrantReadWriteLock;
+import java.util.function.Supplier;
 
 /**
  * Thread-safe singleton tracking migration state across the JVM.
@@ -19,6 +22,8 @@ import java.util.concurrent.locks.ReentrantReadWriteLock;
  * <ul>
  *   <li>Current migration status ({@link Status})</li>
  *   <li>Active phase during in-progress migrations</li>
+ *   <li>Live progress of the heap walk in progress, if any</li>
+ *   <li>How many old objects of the last tracked migration have been reclaimed</li>
  *   <li>Metrics from the last completed migration</li>
  *   <li>A bounded history of recent migrations</li>
  *   <li>Error information if the last migration failed</li>
@@ -67,6 +72,10 @@ public final class MigrationState {
     private volatile Instant startTime;
     private volatile MigrationMetrics lastMetrics;
     private volatile String lastError;
+    private volatile String currentWalk;
+    private volatile Supplier<WalkProgress> walkProgressSource;
+    private volatile long reclamationMigrationId;
+    private volatile Supplier<ReclamationProgress> reclamationSource;
     private final List<MigrationHistoryEntry> history = new ArrayList<>();
 
     private MigrationState() {}
@@ -112,6 +121,38 @@ public final class MigrationState {
         }
     }
 
+    /**
+     * Record that a heap walk started. Its progress is read live from {@code progress} until
+     * {@link #walkFinished()}.
+     *
+     * @param operation the walk's operation name (e.g. "heapWalkFiltered")
+     * @param progress  reports the walk's progress; called from monitoring threads
+     */
+    public void walkStarted(String operation, Supplier<WalkProgress> progress) {
+        this.walkProgressSource = progress;
+        this.currentWalk = operation;
+    }
+
+    /**
+     * Record that the heap walk in progress ended.
+     */
+    public void walkFinished() {
+        this.currentWalk = null;
+        this.walkProgressSource = null;
+    }
+
+    /**
+     * Record that the old objects of a committed migration are being tracked. Their reclamation is
+     * read live from {@code progress} until another migration's tracking replaces it.
+     *
+     * @param migrationId the id of the migration whose old objects are tracked
+     * @param progress    reports the tracker's progress; called from monitoring threads
+     */
+    public void reclamationStarted(long migrationId, Supplier<ReclamationProgress> progress) {
+        this.reclamationSource = progress;
+        this.reclamationMigrationId = migrationId;
+    }
+
     /**
      * Mark migration as completed successfully.
      *
@@ -224,6 +265,50 @@ public final class MigrationState {
         return startTime;
     }
 
+    /**
+     * Get the operation name of the heap walk in progress, or null if none is running.
+     */
+    public String getCurrentWalk() {
+        return currentWalk;
+    }
+
+    /**
+     * Get the live progress of the heap walk in progress, or {@link WalkProgress#NONE} if none is
+     * running or its walker does not report progress.
+     */
+    public WalkProgress getWalkProgress() {
+        Supplier<WalkProgress> source = walkProgressSource;
+        if (source == null) return WalkProgress.NONE;
+        try {
+            WalkProgress progress = source.get();
+            return progress != null ? progress : WalkProgress.NONE;
+        } catch (RuntimeException | LinkageError e) {
+            return WalkProgress.NONE;
+        }
+    }
+
+    /**
+     * Get the id of the migration whose old objects are tracked for reclamation, or 0 if none.
+     */
+    public long getReclamationMigrationId() {
+        return reclamationMigrationId;
+    }
+
+    /**
+     * Get how many old objects of the tracked migration have been reclaimed so far, or
+     * {@link ReclamationProgress#NONE} if none is tracked or the tracker cannot be read.
+     */
+    public ReclamationProgress getReclamation() {
+        Supplier<ReclamationProgress> source = reclamationSource;
+        if (source == null) return ReclamationProgress.NONE;
+        try {
+            ReclamationProgress progress = source.get();
+            return progress != null ? progress : ReclamationProgress.NONE;
+        } catch (RuntimeException | LinkageError e) {
+            return ReclamationProgress.NONE;
+        }
+    }
+
     /**
      * Get the metrics from the last migration. After a successful run these are the final metrics;
      * after a failure they are the partial metrics collected before the failure (possibly null).
@@ -264,6 +349,30 @@ public final class MigrationState {
             map.put("startTime", startTime != null ? startTime.toString() : null);
             map.put("lastError", lastError);
 
+            String walk = currentWalk;
+            if (walk != null) {
+                WalkProgress progress = getWalkProgress();
+                Map<String, Object> walkMap = new LinkedHashMap<>();
+                walkMap.put("operation", walk);
+                walkMap.put("objectsVisited", progress.visited());
+                walkMap.put("objectsTagged", progress.tagged());
+                walkMap.put("cancelled", progress.cancelled());
+                map.put("currentWalk", walkMap);
+            }
+
+            if (reclamationSource != null) {
+                ReclamationProgress progress = getReclamation();
+                Map<String, Object> reclaimMap = new LinkedHashMap<>();
+                reclaimMap.put("migrationId", reclamationMigrationId);
+                reclaimMap.put("oldObjects", progress.tracked());
+                reclaimMap.put("reclaimed", progress.reclaimed());
+                reclaimMap.put("oldBytes", progress.trackedBytes());
+                reclaimMap.put("reclaimedBytes", progress.reclaimedBytes());
+                reclaimMap.put("timeToReclaimMs", progress.isComplete() ? progress.nanosToLastReclaim() / 1_000_000 : null);
+                reclaimMap.put("complete", progress.isComplete());
+                map.put("reclamation", reclaimMap);
+            }
+
             if (lastMetrics != null) {
                 map.put("lastMigration", lastMetrics.toMap());
             }
@@ -298,6 +407,10 @@ public final class MigrationState {
             this.startTime = null;
             this.lastMetrics = null;
             this.lastError = null;
+            this.currentWalk = null;
+            this.walkProgressSource = null;
+            this.reclamationMigrationId = 0;
+            this.reclamationSource = null;
             this.maxHistorySize = DEFAULT_HISTORY_SIZE;
             this.history.clear();
         } finally {
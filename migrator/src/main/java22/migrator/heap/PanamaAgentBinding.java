@@ -0,0 +1,139 @@
+package migrator.heap;
+
+import java.lang.foreign.Arena;
+import java.lang.foreign.FunctionDescriptor;
+import java.lang.foreign.Linker;
+import java.lang.foreign.MemorySegment;
+import java.lang.foreign.SymbolLookup;
+import java.lang.invoke.MethodHandle;
+import java.nio.file.Path;
+
+import static java.lang.foreign.ValueLayout.ADDRESS;
+import static java.lang.foreign.ValueLayout.JAVA_INT;
+import static java.lang.foreign.ValueLayout.JAVA_LONG;
+
+/**
+ * {@link ForeignAgentBinding} over {@code java.lang.foreign} (JDK 22+).
+ *
+ * <p>The {@code migrator_*} symbols are looked up in the agent library the VM already loaded,
+ * so they share its state with the JNI entry points. Counters are written by the agent straight
+ * into an off-heap segment and read from there, without a Java array in between. Every function
+ * but {@code migrator_retained_tags} is bound as a critical function: it only reads or writes a
+ * few globals, so the call skips the thread-state transition a JNI or ordinary downcall makes.
+ * {@code migrator_retained_tags} runs a heap iteration, a VM operation that needs it.
+ *
+ * <p>Instantiated reflectively by {@link ForeignHeapWalker}; the constructor fails if a symbol
+ * is missing.
+ */
+final class PanamaAgentBinding implements ForeignAgentBinding {
+
+    /** Values written by migrator_walk_progress (WALK_PROGRESS_COUNT in agent.c). */
+    private static final int WALK_PROGRESS_COUNT = 5;
+
+    /** Values written by migrator_op_times (3 * OP_KINDS in agent.c). */
+    private static final int OP_TIME_COUNT = 6;
+
+    /** Values written by migrator_reclaim_stats (RECLAIM_STAT_COUNT in agent.c). */
+    private static final int RECLAIM_STAT_COUNT = 8;
+
+    private final MethodHandle walkProgress;
+    private final MethodHandle cancelWalks;
+    private final MethodHandle opTimes;
+    private final MethodHandle reclaimStats;
+    private final MethodHandle advanceEpoch;
+    private final MethodHandle retainedTags;
+    private final MethodHandle openWalkEnvs;
+
+    PanamaAgentBinding(String libraryPath) {
+        Linker linker = Linker.nativeLinker();
+        // The library stays loaded with the VM: the agent is never unloaded.
+        SymbolLookup agent = SymbolLookup.libraryLookup(Path.of(libraryPath), Arena.global());
+        Linker.Option critical = Linker.Option.critical(false);
+        FunctionDescriptor fill = FunctionDescriptor.ofVoid(ADDRESS);
+
+        walkProgress = linker.downcallHandle(symbol(agent, "migrator_walk_progress"), fill, critical);
+        cancelWalks = linker.downcallHandle(symbol(agent, "migrator_cancel_walks"),
+                FunctionDescriptor.ofVoid(), critical);
+        opTimes = linker.downcallHandle(symbol(agent, "migrator_op_times"), fill, critical);
+        reclaimStats = linker.downcallHandle(symbol(agent, "migrator_reclaim_stats"), fill, critical);
+        advanceEpoch = linker.downcallHandle(symbol(agent, "migrator_advance_epoch"),
+                FunctionDescriptor.ofVoid(), critical);
+        retainedTags = linker.downcallHandle(symbol(agent, "migrator_retained_tags"),
+                FunctionDescriptor.of(JAVA_LONG));
+        openWalkEnvs = linker.downcallHandle(symbol(agent, "migrator_open_walk_envs"),
+                FunctionDescriptor.of(JAVA_INT), critical);
+    }
+
+    @Override
+    public WalkProgress walkProgress() {
+        return WalkProgress.fromNative(fill(walkProgress, WALK_PROGRESS_COUNT));
+    }
+
+    @Override
+    public void cancelWalks() {
+        try {
+            cancelWalks.invokeExact();
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    @Override
+    public HeapOpTimes opTimes() {
+        return HeapOpTimes.fromNative(fill(opTimes, OP_TIME_COUNT));
+    }
+
+    @Override
+    public ReclamationProgress reclamationProgress() {
+        return ReclamationProgress.fromNative(fill(reclaimStats, RECLAIM_STAT_COUNT));
+    }
+
+    @Override
+    public void advanceEpoch() {
+        try {
+            advanceEpoch.invokeExact();
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    @Override
+    public long retainedTagCount() {
+        try {
+            return (long) retainedTags.invokeExact();
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    @Override
+    public int openWalkEnvironments() {
+        try {
+            return (int) openWalkEnvs.invokeExact();
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    private static MemorySegment symbol(SymbolLookup agent, String name) {
+        return agent.find(name).orElseThrow(() -> new IllegalStateException("agent does not export " + name));
+    }
+
+    /** Calls a {@code void f(jlong* out)} entry point on a fresh off-heap segment and returns its values. */
+    private static long[] fill(MethodHandle function, int count) {
+        try (Arena arena = Arena.ofConfined()) {
+            MemorySegment out = arena.allocate(JAVA_LONG, count);
+            function.invokeExact(out);
+            return out.toArray(JAVA_LONG);
+        } catch (Throwable t) {
+            throw rethrow(t);
+        }
+    }
+
+    /** A downcall throws only what the callee does (nothing), or an Error of the linker. */
+    private static RuntimeException rethrow(Throwable t) {
+        if (t instanceof RuntimeException re) return re;
+        if (t instanceof Error e) throw e;
+        return new IllegalStateException(t);
+    }
+}
@@ -4,6 +4,8 @@ import migrator.ClassMigrator;
 import migrator.annotations.Migrator;
 import migrator.commit.CommitManager;
 import migrator.commit.RollbackManager;
+import migrator.config.HeapWalkMode;
+import migrator.config.VisitedTracking;
 import migrator.crac.NoopCracController;
 import migrator.engine.MigrationEngine;
 import migrator.metrics.MigrationMetrics;
@@ -13,12 +15,26 @@ import migrator.phase.MigrationPhaseListener;
 import migrator.smoke.SmokeTestResult;
 import migrator.smoke.SmokeTestRunner;
 
+import java.lang.management.GarbageCollectorMXBean;
+import java.lang.management.ManagementFactory;
 import java.util.*;
 import java.util.concurrent.ConcurrentHashMap;
 
 /**
  * Heap stress test: progressively scales object count to find practical limits.
- * Uses SPEC (filtered) heap walk for the reference-patching phase.
+ * Uses SPEC (filtered) heap walk for the reference-patching phase by default; the first argument
+ * selects another {@link HeapWalkMode}.
+ *
+ * <p>Each count is migrated once per {@link VisitedTracking} (IDENTITY, MARKS, INDEX, or those
+ * given as further arguments), so the table compares where the second pass keeps its visited
+ * set: the second-pass time, and the collections and GC time inside the critical phase, which an
+ * identity set of a FULL walk drives up. A tracking the walk mode does not support falls back as
+ * in the engine (INDEX runs as IDENTITY in a SPEC walk); the "Visited" column shows the one asked for.
+ *
+ * <pre>
+ * java ... migrator.benchmark.HeapStressTest FULL
+ * java ... migrator.benchmark.HeapStressTest REACHABLE IDENTITY INDEX
+ * </pre>
  *
  * Each OldPayload is ~1 KB (1024-byte data array + header/fields/String).
  * Scale: 1K -> 10K -> 50K -> 100K -> 500K -> 1M -> 2M objects.
@@ -79,15 +95,33 @@ public class HeapStressTest {
     static class BenchPhaseListener implements MigrationPhaseListener {
         long quiesceStart;
         long quiesceDurationMs;
+        long gcCountStart, gcTimeStart;
+        long criticalGcs, criticalGcMs;
 
         @Override
         public void onBeforeCriticalPhase(MigrationContext ctx) {
+            gcCountStart = gcCount();
+            gcTimeStart = gcTimeMs();
             quiesceStart = System.nanoTime();
         }
 
         @Override
         public void onAfterCriticalPhase(MigrationContext ctx) {
             quiesceDurationMs = (System.nanoTime() - quiesceStart) / 1_000_000;
+            criticalGcs = gcCount() - gcCountStart;
+            criticalGcMs = gcTimeMs() - gcTimeStart;
+        }
+
+        static long gcCount() {
+            long n = 0;
+            for (GarbageCollectorMXBean gc : ManagementFactory.getGarbageCollectorMXBeans()) n += Math.max(0, gc.getCollectionCount());
+            return n;
+        }
+
+        static long gcTimeMs() {
+            long ms = 0;
+            for (GarbageCollectorMXBean gc : ManagementFactory.getGarbageCollectorMXBeans()) ms += Math.max(0, gc.getCollectionTime());
+            return ms;
         }
     }
 
@@ -105,36 +139,43 @@ public class HeapStressTest {
     // ─── Main ───────────────────────────────────────────────────────
 
     public static void main(String[] args) {
+        HeapWalkMode mode = args.length > 0 ? HeapWalkMode.valueOf(args[0].toUpperCase()) : HeapWalkMode.SPEC;
+        List<VisitedTracking> trackings = new ArrayList<>();
+        for (int i = 1; i < args.length; i++) trackings.add(VisitedTracking.valueOf(args[i].toUpperCase()));
+        if (trackings.isEmpty()) trackings = List.of(VisitedTracking.IDENTITY, VisitedTracking.MARKS, VisitedTracking.INDEX);
+
         System.out.println("================================================================");
-        System.out.println("  Live Migrator -- Heap Stress Test (SPEC mode, 1KB objects)");
+        System.out.printf("  Live Migrator -- Heap Stress Test (%s mode, %d B objects)%n", mode, PAYLOAD_SIZE);
         System.out.println("================================================================");
         System.out.println();
         printJvmInfo();
 
         List<String[]> resultTable = new ArrayList<>();
         resultTable.add(new String[]{
-            "Count", "Data MB", "Alloc ms", "Total ms",
+            "Count", "Visited", "Data MB", "Alloc ms", "Total ms",
             "1st Pass", "Critical", "2nd Pass", "Registry",
             "Smoke", "Migrated", "Patched",
-            "Heap +MB", "Quiesce ms", "List%", "Map%"
+            "Heap +MB", "Quiesce ms", "Crit GCs", "Crit GC ms", "List%", "Map%"
         });
 
         for (int count : OBJECT_COUNTS) {
-            double dataMb = (double) count * PAYLOAD_SIZE / (1024.0 * 1024);
-            System.out.println("----------------------------------------------------------------");
-            System.out.printf("Test: %,d objects x %d B = %.0f MB%n", count, PAYLOAD_SIZE, dataMb);
-            System.out.println("----------------------------------------------------------------");
-
-            String[] row = runSingleTest(count);
-            if (row != null) resultTable.add(row);
-
-            objectStore = null;
-            mapStore = null;
-            System.gc();
-            sleep(2000);
-            System.gc();
-            sleep(1000);
-            System.out.println();
+            for (VisitedTracking tracking : trackings) {
+                double dataMb = (double) count * PAYLOAD_SIZE / (1024.0 * 1024);
+                System.out.println("----------------------------------------------------------------");
+                System.out.printf("Test: %,d objects x %d B = %.0f MB, visited %s%n", count, PAYLOAD_SIZE, dataMb, tracking);
+                System.out.println("----------------------------------------------------------------");
+
+                String[] row = runSingleTest(count, mode, tracking);
+                if (row != null) resultTable.add(row);
+
+                objectStore = null;
+                mapStore = null;
+                System.gc();
+                sleep(2000);
+                System.gc();
+                sleep(1000);
+                System.out.println();
+            }
         }
 
         System.out.println();
@@ -144,7 +185,7 @@ public class HeapStressTest {
         printTable(resultTable);
     }
 
-    static String[] runSingleTest(int objectCount) {
+    static String[] runSingleTest(int objectCount, HeapWalkMode mode, VisitedTracking tracking) {
         Runtime rt = Runtime.getRuntime();
 
         // ── Allocate ──
@@ -168,7 +209,7 @@ public class HeapStressTest {
         System.out.printf(" %,d ms (heap %,d MB)%n", allocMs, heapMb);
 
         // ── Migrate ──
-        System.out.print("  [2/4] Migrating (SPEC)...");
+        System.out.printf("  [2/4] Migrating (%s, visited %s)...", mode, tracking);
         BenchPhaseListener phaseListener = new BenchPhaseListener();
 
         try {
@@ -183,7 +224,8 @@ public class HeapStressTest {
                     new CommitManager(NoopCracController.INSTANCE),
                     new RollbackManager(NoopCracController.INSTANCE)
             );
-            engine.setFullHeapWalk(false); // SPEC mode
+            engine.setHeapWalkMode(mode);
+            engine.setVisitedTracking(tracking);
             engine.setAllTimeoutsSeconds(0); // no timeout
 
             long t0 = System.nanoTime();
@@ -196,8 +238,9 @@ public class HeapStressTest {
             if (m != null) {
                 System.out.printf("    Total      : %,6d ms%n", m.totalDurationMs());
                 System.out.printf("    1st pass   : %,6d ms%n", m.phaseDuration(Phase.FIRST_PASS));
-                System.out.printf("    Critical   : %,6d ms  (quiesce %,d ms)%n",
-                        m.phaseDuration(Phase.CRITICAL_PHASE), phaseListener.quiesceDurationMs);
+                System.out.printf("    Critical   : %,6d ms  (quiesce %,d ms, %d GCs / %,d ms)%n",
+                        m.phaseDuration(Phase.CRITICAL_PHASE), phaseListener.quiesceDurationMs,
+                        phaseListener.criticalGcs, phaseListener.criticalGcMs);
                 System.out.printf("    2nd pass   : %,6d ms%n", m.phaseDuration(Phase.SECOND_PASS));
                 System.out.printf("    Registry   : %,6d ms%n", m.phaseDuration(Phase.REGISTRY_UPDATE));
                 System.out.printf("    Smoke      : %,6d ms%n", m.phaseDuration(Phase.SMOKE_TEST));
@@ -219,6 +262,7 @@ public class HeapStressTest {
 
             return new String[]{
                 String.format("%,d", objectCount),
+                tracking.name(),
                 String.format("%.0f", (double) objectCount * PAYLOAD_SIZE / (1024.0 * 1024)),
                 String.format("%,d", allocMs),
                 m != null ? String.format("%,d", m.totalDurationMs()) : "-",
@@ -231,6 +275,8 @@ public class HeapStressTest {
                 m != null ? String.format("%,d", m.objectsPatched()) : "-",
                 m != null ? String.format("%+.1f", m.heapDelta() / (1024.0 * 1024)) : "-",
                 String.format("%,d", phaseListener.quiesceDurationMs),
+                String.format("%,d", phaseListener.criticalGcs),
+                String.format("%,d", phaseListener.criticalGcMs),
                 String.format("%.1f", lp),
                 String.format("%.1f", mp)
             };
@@ -240,9 +286,10 @@ public class HeapStressTest {
             t.printStackTrace(System.err);
             return new String[]{
                 String.format("%,d", objectCount),
+                tracking.name(),
                 String.format("%.0f", (double) objectCount * PAYLOAD_SIZE / (1024.0 * 1024)),
                 String.format("%,d", allocMs),
-                "FAIL", "-", "-", "-", "-", "-", "-", "-", "-", "-", "-", "-"
+                "FAIL", "-", "-", "-", "-", "-", "-", "-", "-", "-", "-", "-", "-", "-", "-"
             };
         }
     }
@@ -0,0 +1,137 @@
+package migrator.benchmark;
+
+import migrator.heap.NativeHeapWalker;
+
+import javax.management.MBeanServer;
+import javax.management.ObjectName;
+import java.lang.management.GarbageCollectorMXBean;
+import java.lang.management.ManagementFactory;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.regex.Matcher;
+import java.util.regex.Pattern;
+
+/**
+ * Shows that heap walks leave no JVMTI tags behind: the GC pause and the agent's native memory
+ * after many walks match the baseline taken before the first one.
+ *
+ * Each round runs every walk the engine uses (full, filtered, partitioned, chunked, census)
+ * over a heap of N small objects, then reports:
+ *
+ *   retained  = objects still tagged in the agent's long-lived JVMTI env (must stay 0)
+ *   envs      = per-walk tagging environments still open (must stay 0)
+ *   gcMs      = average pause of a forced full GC, from the collectors' MXBeans
+ *   svcKB     = NMT "Serviceability" committed memory, where the JVMTI tag maps live
+ *               (n/a unless run with -XX:NativeMemoryTracking=summary)
+ *
+ * A walk that tagged in the agent's own env would leave one tag-map entry per live object after
+ * each full walk, and every later GC would have to process them. Run with the agent:
+ *   -agentpath:agent/libagent.so -XX:NativeMemoryTracking=summary
+ */
+public class TagReclaimBench {
+
+    public static class Item {
+        final int id;
+        final byte[] data;
+        Item(int id) { this.id = id; this.data = new byte[16]; }
+    }
+
+    static final int N = 1_000_000;
+    static final int ROUNDS = 10;
+    static final int GCS_PER_SAMPLE = 3;
+
+    // Keep strong refs so the heap stays the same size across rounds.
+    static List<Item> items;
+
+    public static void main(String[] args) throws Exception {
+        NativeHeapWalker walker = new NativeHeapWalker();
+        items = new ArrayList<>(N);
+        for (int i = 0; i < N; i++) items.add(new Item(i));
+
+        System.out.println("================================================================");
+        System.out.println("  Live Migrator -- JVMTI tag reclamation across repeated walks");
+        System.out.println("================================================================");
+        System.out.printf("%,d objects | %d rounds | heap max %,d MB%n%n",
+                N, ROUNDS, Runtime.getRuntime().maxMemory() / (1024 * 1024));
+        System.out.printf("%-10s %-12s %-10s %-6s %-10s %-10s%n",
+                "round", "walkMs", "retained", "envs", "gcMs", "svcKB");
+        System.out.println("-".repeat(62));
+
+        Sample baseline = sample();
+        print("baseline", 0, baseline);
+
+        Sample last = baseline;
+        for (int r = 1; r <= ROUNDS; r++) {
+            long t0 = System.nanoTime();
+            walker.walkHeap();
+            walker.walkHeap(List.of(Item.class, byte[].class));
+            walker.snapshotPartitioned(List.of(Item.class, byte[].class));
+            walker.walkHeap(chunk -> { }, 1 << 18);
+            walker.census(null);
+            double walkMs = (System.nanoTime() - t0) / 1e6;
+
+            last = sample();
+            print("#" + r, walkMs, last);
+        }
+
+        System.out.println("-".repeat(62));
+        boolean clean = last.retained == 0 && last.envs == 0;
+        System.out.printf("steady state: %s | gc pause %.2f ms vs %.2f ms baseline | svc %s KB vs %s KB%n",
+                clean ? "no tags retained" : "TAGS RETAINED",
+                last.gcMs, baseline.gcMs, kb(last.svcKb), kb(baseline.svcKb));
+        if (!clean) System.exit(1);
+    }
+
+    record Sample(long retained, int envs, double gcMs, long svcKb) {}
+
+    static Sample sample() {
+        long retained = NativeHeapWalker.retainedTagCount();
+        int envs = NativeHeapWalker.openWalkEnvironments();
+
+        long gcTime = 0, gcCount = 0;
+        for (int i = 0; i < GCS_PER_SAMPLE; i++) {
+            long[] before = collectorTotals();
+            System.gc();
+            long[] after = collectorTotals();
+            gcTime += after[0] - before[0];
+            gcCount += Math.max(1, after[1] - before[1]);
+        }
+        return new Sample(retained, envs, (double) gcTime / gcCount, serviceabilityCommittedKb());
+    }
+
+    /** @return total {collection time ms, collection count} over all collectors */
+    static long[] collectorTotals() {
+        long time = 0, count = 0;
+        for (GarbageCollectorMXBean gc : ManagementFactory.getGarbageCollectorMXBeans()) {
+            time += Math.max(0, gc.getCollectionTime());
+            count += Math.max(0, gc.getCollectionCount());
+        }
+        return new long[]{time, count};
+    }
+
+    private static final Pattern SERVICEABILITY =
+            Pattern.compile("Serviceability \\(reserved=\\d+KB, committed=(\\d+)KB\\)");
+
+    /** @return NMT committed KB of the Serviceability category, or -1 when NMT is off */
+    static long serviceabilityCommittedKb() {
+        try {
+            MBeanServer server = ManagementFactory.getPlatformMBeanServer();
+            Object out = server.invoke(new ObjectName("com.sun.management:type=DiagnosticCommand"),
+                    "vmNativeMemory", new Object[]{new String[]{"summary"}},
+                    new String[]{String[].class.getName()});
+            Matcher m = SERVICEABILITY.matcher(String.valueOf(out));
+            return m.find() ? Long.parseLong(m.group(1)) : -1;
+        } catch (Exception e) {
+            return -1;
+        }
+    }
+
+    static void print(String round, double walkMs, Sample s) {
+        System.out.printf("%-10s %-12.1f %-10d %-6d %-10.2f %-10s%n",
+                round, walkMs, s.retained, s.envs, s.gcMs, kb(s.svcKb));
+    }
+
+    static String kb(long kb) {
+        return kb < 0 ? "n/a" : String.format("%,d", kb);
+    }
+}
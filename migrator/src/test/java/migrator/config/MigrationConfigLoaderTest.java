@@ -7,6 +7,7 @@ import java.io.IOException;
 import java.nio.file.Files;
 import java.nio.file.Path;
 import java.time.Duration;
+import java.util.List;
 
 import static org.junit.jupiter.api.Assertions.*;
 
@@ -94,6 +95,204 @@ class MigrationConfigLoaderTest {
         assertEquals(AlertLevel.WARNING, c.alertLevel());
     }
 
+    @Test
+    void referrersWalkMode() throws IOException {
+        Path f = tempDir.resolve("test.properties");
+        Files.writeString(f, "migration.heap.walk.mode=referrers\n");
+
+        MigrationConfig c = MigrationConfigLoader.loadFromFile(f);
+
+        assertEquals(HeapWalkMode.REFERRERS, c.heapWalkMode());
+        assertFalse(c.isFullHeapWalk());
+    }
+
+    @Test
+    void nativePatchingFlag() throws IOException {
+        Path on = tempDir.resolve("on.properties");
+        Files.writeString(on, "migration.patch.native=TRUE\n");
+        Path invalid = tempDir.resolve("invalid.properties");
+        Files.writeString(invalid, "migration.patch.native=yes\n");
+
+        assertTrue(MigrationConfigLoader.loadFromFile(on).isNativePatching());
+        assertFalse(MigrationConfigLoader.loadFromFile(invalid).isNativePatching());
+    }
+
+    @Test
+    void referrerChainLimit() throws IOException {
+        Path off = tempDir.resolve("off.properties");
+        Files.writeString(off, "migration.referrers.chain.limit=0\n");
+        Path negative = tempDir.resolve("negative.properties");
+        Files.writeString(negative, "migration.referrers.chain.limit=-1\n");
+
+        assertEquals(0L, MigrationConfigLoader.loadFromFile(off).referrerChainLimit());
+        assertEquals(MigrationConfig.DEFAULT_REFERRER_CHAIN_LIMIT,
+                MigrationConfigLoader.loadFromFile(negative).referrerChainLimit());
+    }
+
+    @Test
+    void freezeForwardingFlag() throws IOException {
+        Path on = tempDir.resolve("on.properties");
+        Files.writeString(on, "migration.forwarding.freeze=true\n");
+
+        assertTrue(MigrationConfigLoader.loadFromFile(on).isFreezeForwarding());
+        assertFalse(MigrationConfig.DEFAULTS.isFreezeForwarding());
+    }
+
+    @Test
+    void patchParallelism() throws IOException {
+        Path set = tempDir.resolve("set.properties");
+        Files.writeString(set, "migration.patch.parallelism=16\n");
+        Path negative = tempDir.resolve("negative.properties");
+        Files.writeString(negative, "migration.patch.parallelism=-2\n");
+
+        assertEquals(16, MigrationConfigLoader.loadFromFile(set).patchParallelism());
+        assertEquals(1, MigrationConfigLoader.loadFromFile(negative).patchParallelism());
+    }
+
+    @Test
+    void typePruningFlag() throws IOException {
+        Path off = tempDir.resolve("off.properties");
+        Files.writeString(off, "migration.patch.prune=false\n");
+
+        assertFalse(MigrationConfigLoader.loadFromFile(off).isTypePruning());
+        assertTrue(MigrationConfig.DEFAULTS.isTypePruning());
+    }
+
+    @Test
+    void visitedTracking() throws IOException {
+        Path set = tempDir.resolve("set.properties");
+        Files.writeString(set, "migration.patch.visited=index\n");
+        Path invalid = tempDir.resolve("invalid.properties");
+        Files.writeString(invalid, "migration.patch.visited=bogus\n");
+
+        assertEquals(VisitedTracking.INDEX, MigrationConfigLoader.loadFromFile(set).visitedTracking());
+        assertEquals(VisitedTracking.AUTO, MigrationConfigLoader.loadFromFile(invalid).visitedTracking());
+        assertEquals(VisitedTracking.AUTO, MigrationConfig.DEFAULTS.visitedTracking());
+    }
+
+    @Test
+    void walkChunkSize() throws IOException {
+        Path set = tempDir.resolve("set.properties");
+        Files.writeString(set, "migration.heap.walk.chunk.size=4096\n");
+        Path whole = tempDir.resolve("whole.properties");
+        Files.writeString(whole, "migration.heap.walk.chunk.size=0\n");
+        Path auto = tempDir.resolve("auto.properties");
+        Files.writeString(auto, "migration.heap.walk.chunk.size=AUTO\n");
+        Path negative = tempDir.resolve("negative.properties");
+        Files.writeString(negative, "migration.heap.walk.chunk.size=-5\n");
+
+        assertEquals(4096, MigrationConfigLoader.loadFromFile(set).walkChunkSize());
+        assertEquals(0, MigrationConfigLoader.loadFromFile(whole).walkChunkSize());
+        assertEquals(MigrationConfig.AUTO_WALK_CHUNK_SIZE, MigrationConfigLoader.loadFromFile(auto).walkChunkSize());
+        assertEquals(MigrationConfig.DEFAULT_WALK_CHUNK_SIZE,
+                MigrationConfigLoader.loadFromFile(negative).walkChunkSize());
+    }
+
+    @Test
+    void heapCensusFlag() throws IOException {
+        Path on = tempDir.resolve("census.properties");
+        Files.writeString(on, "migration.heap.census=true\n");
+
+        assertTrue(MigrationConfigLoader.loadFromFile(on).isHeapCensus());
+        assertFalse(MigrationConfig.DEFAULTS.isHeapCensus());
+    }
+
+    @Test
+    void discoverHoldersFlag() throws IOException {
+        Path on = tempDir.resolve("holders.properties");
+        Files.writeString(on, "migration.spec.discover.holders=true\n");
+
+        assertTrue(MigrationConfigLoader.loadFromFile(on).isDiscoverHolders());
+        assertFalse(MigrationConfig.DEFAULTS.isDiscoverHolders());
+    }
+
+    @Test
+    void reachableWalkMode() throws IOException {
+        Path f = tempDir.resolve("reachable.properties");
+        Files.writeString(f, "migration.heap.walk.mode=reachable\n");
+
+        MigrationConfig c = MigrationConfigLoader.loadFromFile(f);
+
+        assertEquals(HeapWalkMode.REACHABLE, c.heapWalkMode());
+        assertFalse(c.isFullHeapWalk());
+    }
+
+    @Test
+    void residualVerificationSettings() throws IOException {
+        Path f = tempDir.resolve("verify.properties");
+        Files.writeString(f, """
+                migration.verify.residual=true
+                migration.verify.residual.paths=0
+                """);
+
+        MigrationConfig c = MigrationConfigLoader.loadFromFile(f);
+
+        assertTrue(c.isVerifyResiduals());
+        assertEquals(0, c.residualPathSamples());
+        assertFalse(MigrationConfig.DEFAULTS.isVerifyResiduals());
+        assertEquals(MigrationConfig.DEFAULT_RESIDUAL_PATH_SAMPLES, MigrationConfig.DEFAULTS.residualPathSamples());
+    }
+
+    @Test
+    void reclamationTrackingFlag() throws IOException {
+        Path on = tempDir.resolve("reclaim.properties");
+        Files.writeString(on, "migration.reclaim.track=true\n");
+
+        assertTrue(MigrationConfigLoader.loadFromFile(on).isTrackReclamation());
+        assertFalse(MigrationConfig.DEFAULTS.isTrackReclamation());
+    }
+
+    @Test
+    void suspensionSettings() throws IOException {
+        Path f = tempDir.resolve("suspend.properties");
+        Files.writeString(f, """
+                migration.quiesce.suspend=true
+                migration.quiesce.suspend.allow=metrics-reporter, grpc-*,
+                """);
+
+        MigrationConfig c = MigrationConfigLoader.loadFromFile(f);
+
+        assertTrue(c.isQuiesceBySuspension());
+        assertEquals(List.of("metrics-reporter", "grpc-*"), c.suspendAllowlist());
+        assertFalse(MigrationConfig.DEFAULTS.isQuiesceBySuspension());
+        assertEquals(List.of(), MigrationConfig.DEFAULTS.suspendAllowlist());
+    }
+
+    @Test
+    void heapWalkerBackend() throws IOException {
+        Path foreign = tempDir.resolve("foreign.properties");
+        Files.writeString(foreign, "migration.heap.walker.backend=foreign\n");
+        Path invalid = tempDir.resolve("invalid-backend.properties");
+        Files.writeString(invalid, "migration.heap.walker.backend=CUDA\n");
+
+        assertEquals(HeapWalkerBackend.FOREIGN, MigrationConfigLoader.loadFromFile(foreign).heapWalkerBackend());
+        assertEquals(HeapWalkerBackend.JNI, MigrationConfigLoader.loadFromFile(invalid).heapWalkerBackend());
+        assertEquals(HeapWalkerBackend.JNI, MigrationConfig.DEFAULTS.heapWalkerBackend());
+    }
+
+    @Test
+    void stackLocalsSetting() throws IOException {
+        Path f = tempDir.resolve("locals.properties");
+        Files.writeString(f, "migration.patch.stack.locals=true\n");
+
+        assertTrue(MigrationConfigLoader.loadFromFile(f).isPatchStackLocals());
+        assertFalse(MigrationConfig.DEFAULTS.isPatchStackLocals());
+    }
+
+    @Test
+    void leafFilterSettings() throws IOException {
+        Path f = tempDir.resolve("leaves.properties");
+        Files.writeString(f, """
+                migration.heap.walk.skip.leaves=false
+                migration.heap.walk.leaf.classes=java.lang.String, java.math.BigInteger,
+                """);
+
+        MigrationConfig c = MigrationConfigLoader.loadFromFile(f);
+
+        assertFalse(c.isSkipLeaves());
+        assertEquals(List.of("java.lang.String", "java.math.BigInteger"), c.leafClasses());
+    }
+
     @Test
     void invalidValuesUseDefaults() throws IOException {
         Path f = tempDir.resolve("test.properties");
@@ -3,6 +3,7 @@ package migrator.config;
 import org.junit.jupiter.api.Test;
 
 import java.time.Duration;
+import java.util.List;
 
 import static org.junit.jupiter.api.Assertions.*;
 
@@ -17,6 +18,11 @@ class MigrationConfigTest {
 
         assertEquals(HeapWalkMode.SPEC, c.heapWalkMode());
         assertFalse(c.isFullHeapWalk());
+        assertFalse(c.isNativePatching());
+        assertEquals(MigrationConfig.DEFAULT_WALK_CHUNK_SIZE, c.walkChunkSize());
+        assertFalse(c.isHeapCensus());
+        assertTrue(c.isSkipLeaves());
+        assertEquals(MigrationConfig.DEFAULT_LEAF_CLASSES, c.leafClasses());
         assertEquals(Duration.ZERO, c.heapWalkTimeout());
         assertEquals(0, c.minHeapSizeMb());
         assertEquals(0, c.maxHeapSizeMb());
@@ -28,6 +34,11 @@ class MigrationConfigTest {
     void builderSetsValues() {
         MigrationConfig c = MigrationConfig.builder()
                 .heapWalkMode(HeapWalkMode.SPEC)
+                .nativePatching(true)
+                .walkChunkSize(4096)
+                .heapCensus(true)
+                .skipLeaves(false)
+                .leafClasses(List.of("com.example.Blob"))
                 .heapWalkTimeoutSeconds(60)
                 .heapSnapshotTimeoutSeconds(30)
                 .criticalPhaseTimeoutSeconds(20)
@@ -40,6 +51,11 @@ class MigrationConfigTest {
 
         assertEquals(HeapWalkMode.SPEC, c.heapWalkMode());
         assertFalse(c.isFullHeapWalk());
+        assertTrue(c.isNativePatching());
+        assertEquals(4096, c.walkChunkSize());
+        assertTrue(c.isHeapCensus());
+        assertFalse(c.isSkipLeaves());
+        assertEquals(List.of("com.example.Blob"), c.leafClasses());
         assertEquals(Duration.ofSeconds(60), c.heapWalkTimeout());
         assertEquals(Duration.ofSeconds(30), c.heapSnapshotTimeout());
         assertEquals(Duration.ofSeconds(20), c.criticalPhaseTimeout());
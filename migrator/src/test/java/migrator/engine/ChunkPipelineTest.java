@@ -0,0 +1,160 @@
+package migrator.engine;
+
+import migrator.exceptions.MigrateException;
+import migrator.exceptions.MigrationTimeoutException;
+import migrator.heap.HeapWalker;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.time.Duration;
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.List;
+import java.util.Set;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import static org.assertj.core.api.Assertions.assertThat;
+import static org.assertj.core.api.Assertions.assertThatThrownBy;
+
+/**
+ * Unit tests for {@link ChunkPipeline}.
+ */
+@DisplayName("ChunkPipeline")
+class ChunkPipelineTest {
+
+    @Test
+    @DisplayName("delivers every chunk in order, on the calling thread")
+    void deliversChunksInOrderOnCaller() throws Exception {
+        Thread caller = Thread.currentThread();
+        List<Object> seen = new ArrayList<>();
+        AtomicBoolean walkedElsewhere = new AtomicBoolean();
+
+        long n = ChunkPipeline.run("test", Duration.ofSeconds(5), sink -> {
+            walkedElsewhere.set(Thread.currentThread() != caller);
+            sink.accept(new Object[]{1, 2});
+            sink.accept(new Object[]{3});
+            return 3;
+        }, chunk -> {
+            assertThat(Thread.currentThread()).isSameAs(caller);
+            seen.addAll(List.of(chunk));
+        });
+
+        assertThat(n).isEqualTo(3);
+        assertThat(seen).containsExactly(1, 2, 3);
+        assertThat(walkedElsewhere).isTrue();
+    }
+
+    @Test
+    @DisplayName("resolves the next chunk while the caller consumes the current one")
+    void overlapsResolveWithConsume() throws Exception {
+        CountDownLatch secondResolving = new CountDownLatch(1);
+        AtomicBoolean overlapped = new AtomicBoolean();
+
+        ChunkPipeline.run("test", null, sink -> {
+            sink.accept(new Object[]{"a"});
+            secondResolving.countDown();
+            sink.accept(new Object[]{"b"});
+            return 2;
+        }, chunk -> {
+            if (chunk[0].equals("a")) {
+                try {
+                    overlapped.set(secondResolving.await(5, TimeUnit.SECONDS));
+                } catch (InterruptedException e) {
+                    Thread.currentThread().interrupt();
+                }
+            }
+        });
+
+        assertThat(overlapped).isTrue();
+    }
+
+    @Test
+    @DisplayName("rethrows the walk's failure after the chunks delivered before it")
+    void rethrowsWalkFailure() {
+        List<Object> seen = new ArrayList<>();
+
+        assertThatThrownBy(() -> ChunkPipeline.run("test", Duration.ofSeconds(5), sink -> {
+            sink.accept(new Object[]{1});
+            throw new MigrateException("walk failed");
+        }, chunk -> seen.addAll(List.of(chunk))))
+                .isInstanceOf(MigrateException.class)
+                .hasMessage("walk failed");
+        assertThat(seen).containsExactly(1);
+    }
+
+    @Test
+    @DisplayName("times out on a stalled walk but not on a slow consumer")
+    void timeoutCountsOnlyWaiting() throws Exception {
+        assertThatThrownBy(() -> ChunkPipeline.run("stalledWalk", Duration.ofMillis(50), sink -> {
+            Thread.sleep(5000);
+            return 0;
+        }, chunk -> { }))
+                .isInstanceOf(MigrationTimeoutException.class)
+                .hasMessageContaining("stalledWalk");
+
+        long n = ChunkPipeline.run("slowConsumer", Duration.ofMillis(200), sink -> {
+            for (int i = 0; i < 3; i++) sink.accept(new Object[]{i});
+            return 3;
+        }, chunk -> {
+            try {
+                Thread.sleep(150);
+            } catch (InterruptedException e) {
+                Thread.currentThread().interrupt();
+            }
+        });
+        assertThat(n).isEqualTo(3);
+    }
+
+    @Test
+    @DisplayName("a failing consumer stops the walk at the next chunk boundary")
+    void consumerFailureStopsWalk() throws Exception {
+        AtomicInteger offered = new AtomicInteger();
+        CountDownLatch walkEnded = new CountDownLatch(1);
+
+        assertThatThrownBy(() -> ChunkPipeline.run("test", null, sink -> {
+            try {
+                for (int i = 0; i < 1000; i++) {
+                    sink.accept(new Object[]{i});
+                    offered.incrementAndGet();
+                }
+                return 1000;
+            } finally {
+                walkEnded.countDown();
+            }
+        }, chunk -> {
+            throw new IllegalStateException("patch failed");
+        }))
+                .isInstanceOf(IllegalStateException.class)
+                .hasMessage("patch failed");
+
+        assertThat(walkEnded.await(5, TimeUnit.SECONDS)).isTrue();
+        assertThat(offered.get()).isLessThan(1000);
+    }
+
+    @Test
+    @DisplayName("cancels the walker's walk when the caller times out waiting for a chunk")
+    void cancelsWalkerOnTimeout() throws InterruptedException {
+        AtomicBoolean cancelled = new AtomicBoolean();
+        CountDownLatch walkEnded = new CountDownLatch(1);
+        HeapWalker walker = new HeapWalker() {
+            @Override public void cancelWalks() { cancelled.set(true); }
+            @Override public Object[] snapshotObjects(Class<?> c) { return new Object[0]; }
+            @Override public Set<Object> walkHeap() { return Collections.emptySet(); }
+            @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+        };
+
+        assertThatThrownBy(() -> ChunkPipeline.run("heapWalkFull", Duration.ofMillis(50), walker, sink -> {
+            // a tagging pass that ignores interrupts until cancelled
+            while (!cancelled.get()) Thread.onSpinWait();
+            walkEnded.countDown();
+            return 0;
+        }, chunk -> { }))
+                .isInstanceOf(MigrationTimeoutException.class);
+
+        assertThat(walkEnded.await(5, TimeUnit.SECONDS)).isTrue();
+    }
+}
@@ -6,7 +6,14 @@ import org.junit.jupiter.api.DisplayName;
 import org.junit.jupiter.api.Nested;
 import org.junit.jupiter.api.Test;
 
+import java.util.ArrayList;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Random;
+
 import static org.assertj.core.api.Assertions.assertThat;
+import static org.assertj.core.api.Assertions.assertThatThrownBy;
 
 /**
  * Unit tests for {@link ForwardingTable}.
@@ -348,6 +355,87 @@ class ForwardingTableTest {
         }
     }
 
+    @Nested
+    @DisplayName("open addressing")
+    class OpenAddressing {
+
+        @Test
+        @DisplayName("should match IdentityHashMap over random puts, removes and lookups")
+        void shouldMatchIdentityHashMap() {
+            Random random = new Random(42);
+            Map<Object, Object> model = new IdentityHashMap<>();
+            List<Object> keys = new ArrayList<>();
+            for (int i = 0; i < 2_000; i++) keys.add(new Object());
+
+            for (int step = 0; step < 50_000; step++) {
+                Object key = keys.get(random.nextInt(keys.size()));
+                if (random.nextInt(3) == 0) {
+                    table.remove(key);
+                    model.remove(key);
+                } else {
+                    Object value = new Object();
+                    table.put(key, value);
+                    model.put(key, value);
+                }
+                if (step % 5_000 == 0) table.freeze();
+            }
+
+            assertThat(table.size()).isEqualTo(model.size());
+            for (Object key : keys) {
+                assertThat(table.get(key)).isSameAs(model.get(key));
+                assertThat(table.contains(key)).isEqualTo(model.containsKey(key));
+            }
+        }
+
+        @Test
+        @DisplayName("should keep its mappings when presized, frozen and thawed")
+        void shouldKeepMappingsAcrossForms() {
+            ForwardingTable presized = new ForwardingTable(1_000);
+            Object[] olds = new Object[1_000];
+            for (int i = 0; i < olds.length; i++) {
+                olds[i] = new Object();
+                presized.put(olds[i], i);
+            }
+            presized.ensureCapacity(5_000);
+
+            presized.freeze();
+            assertThat(presized.isFrozen()).isTrue();
+            for (int i = 0; i < olds.length; i++) assertThat(presized.get(olds[i])).isEqualTo(i);
+
+            Object late = new Object();
+            presized.put(late, "late");
+            assertThat(presized.isFrozen()).isFalse();
+            assertThat(presized.get(late)).isEqualTo("late");
+            assertThat(presized.size()).isEqualTo(olds.length + 1);
+        }
+
+        @Test
+        @DisplayName("should miss objects of other classes and stay correct past the tracked key classes")
+        void shouldFilterByKeyClass() {
+            Object old = new Object();
+            table.put(old, "new");
+            assertThat(table.get("a string")).isNull();
+            assertThat(table.contains(List.of())).isFalse();
+
+            // more key classes than the filter tracks: every lookup is hashed, still exact
+            List<Object> mixed = List.of(new StringBuilder(), 1L, 2.0, 'c', (short) 3, (byte) 4, 5f, new int[0], new long[0]);
+            for (Object o : mixed) table.put(o, o);
+            for (Object o : mixed) assertThat(table.get(o)).isSameAs(o);
+            assertThat(table.get(old)).isEqualTo("new");
+            assertThat(table.get(new Object())).isNull();
+        }
+
+        @Test
+        @DisplayName("should ignore null lookups and reject null keys")
+        void shouldHandleNulls() {
+            assertThat(table.get(null)).isNull();
+            assertThat(table.contains(null)).isFalse();
+            table.remove(null);
+            assertThatThrownBy(() -> table.put(null, new Object())).isInstanceOf(NullPointerException.class);
+            assertThatThrownBy(() -> new ForwardingTable(-1)).isInstanceOf(IllegalArgumentException.class);
+        }
+    }
+
     @Nested
     @DisplayName("concurrency safety")
     class ConcurrencySafety {
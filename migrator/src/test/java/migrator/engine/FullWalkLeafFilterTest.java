@@ -0,0 +1,156 @@
+package migrator.engine;
+
+import migrator.config.HeapWalkMode;
+import migrator.config.MigrationConfig;
+import migrator.engine.ItemFixture.Holder;
+import migrator.engine.ItemFixture.NewItem;
+import migrator.engine.ItemFixture.OldItem;
+import migrator.exceptions.MigrateException;
+import migrator.heap.HeapWalker;
+import migrator.state.MigrationState;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Set;
+import java.util.function.Consumer;
+
+import static migrator.engine.ItemFixture.injectHeapWalker;
+import static migrator.engine.ItemFixture.newEngine;
+import static org.assertj.core.api.Assertions.assertThat;
+
+/**
+ * Verifies that FULL heap walks skip reference-free leaves (primitive arrays and the configured
+ * leaf classes), whole or streamed, and that the holders of migrated objects are still patched.
+ */
+@DisplayName("MigrationEngine — FULL walk leaf filtering")
+class FullWalkLeafFilterTest {
+
+    static final class Payload { final long v; Payload(long v) { this.v = v; } }
+
+    /** A heap of one holder plus leaves; records which walk the engine asked for and what it received. */
+    static final class LeafHeapWalker implements HeapWalker {
+        final OldItem old = new OldItem(1);
+        final Holder holder = new Holder(old);
+        final List<Object> heap = List.of(holder, "text", 42, new byte[8], new int[2], new Payload(7),
+                new Object[]{"boxed"});
+        final List<Object> delivered = new ArrayList<>();
+        Collection<Class<?>> leavesAsked;
+        Integer chunkSizeAsked;
+        int plainWalks = 0;
+
+        @Override public Object[] snapshotObjects(Class<?> targetClass) {
+            return targetClass == OldItem.class ? new Object[]{old} : new Object[0];
+        }
+
+        @Override public Set<Object> walkHeap() {
+            plainWalks++;
+            Set<Object> set = Collections.newSetFromMap(new IdentityHashMap<>());
+            set.addAll(heap);
+            return set;
+        }
+
+        @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+
+        @Override public Set<Object> walkHeapSkippingLeaves(Collection<Class<?>> leafClasses) throws MigrateException {
+            leavesAsked = leafClasses;
+            Set<Object> kept = HeapWalker.super.walkHeapSkippingLeaves(leafClasses);
+            delivered.addAll(kept);
+            return kept;
+        }
+
+        @Override public long walkHeapSkippingLeaves(Collection<Class<?>> leafClasses, Consumer<Object[]> chunkSink,
+                                                     int chunkSize) throws MigrateException {
+            leavesAsked = leafClasses;
+            chunkSizeAsked = chunkSize;
+            return HeapWalker.super.walkHeapSkippingLeaves(leafClasses, chunk -> {
+                delivered.addAll(List.of(chunk));
+                chunkSink.accept(chunk);
+            }, chunkSize);
+        }
+    }
+
+    @BeforeEach
+    void reset() {
+        MigrationState.getInstance().reset();
+    }
+
+    @AfterEach
+    void cleanup() {
+        MigrationState.getInstance().reset();
+    }
+
+    @Test
+    @DisplayName("a whole FULL walk skips primitive arrays, Strings and boxes, and still patches the holder")
+    void wholeWalkSkipsLeaves() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder()
+                .heapWalkMode(HeapWalkMode.FULL)
+                .walkChunkSize(0)
+                .build());
+        LeafHeapWalker fake = new LeafHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(fake.leavesAsked).contains(String.class, Integer.class);
+        assertThat(fake.delivered).hasSize(3)
+                .noneMatch(o -> o instanceof String || o instanceof Integer || o instanceof byte[] || o instanceof int[]);
+        assertThat(fake.holder.item).isInstanceOf(NewItem.class);
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
+    }
+
+    @Test
+    @DisplayName("a streamed FULL walk skips the configured leaf classes too")
+    void streamedWalkSkipsConfiguredLeaves() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder()
+                .heapWalkMode(HeapWalkMode.FULL)
+                .walkChunkSize(2)
+                .leafClasses(List.of(Payload.class.getName(), "com.example.DoesNotExist"))
+                .build());
+        LeafHeapWalker fake = new LeafHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(engine.getLeafClasses()).containsExactly(Payload.class);
+        assertThat(fake.delivered).hasSize(4).noneMatch(o -> o instanceof Payload || o instanceof byte[]);
+        assertThat(fake.holder.item).isInstanceOf(NewItem.class);
+    }
+
+    @Test
+    @DisplayName("by default a FULL walk is streamed in chunks the walk derives")
+    void defaultWalkIsStreamed() throws Exception {
+        MigrationEngine engine = newEngine().setHeapWalkMode(HeapWalkMode.FULL);
+        LeafHeapWalker fake = new LeafHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(engine.getWalkChunkSize()).isEqualTo(MigrationConfig.AUTO_WALK_CHUNK_SIZE);
+        assertThat(fake.chunkSizeAsked).isEqualTo(HeapWalker.DERIVED_CHUNK_SIZE);
+        assertThat(fake.delivered).hasSize(3);
+        assertThat(fake.holder.item).isInstanceOf(NewItem.class);
+    }
+
+    @Test
+    @DisplayName("with leaf skipping off, the FULL walk reports every object")
+    void skippingOff() throws Exception {
+        MigrationEngine engine = newEngine().setSkipLeaves(false).setHeapWalkMode(HeapWalkMode.FULL);
+        engine.setWalkChunkSize(0);
+        LeafHeapWalker fake = new LeafHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(engine.isSkipLeaves()).isFalse();
+        assertThat(fake.leavesAsked).isNull();
+        assertThat(fake.plainWalks).isEqualTo(1);
+        assertThat(fake.holder.item).isInstanceOf(NewItem.class);
+    }
+}
@@ -0,0 +1,130 @@
+package migrator.engine;
+
+import migrator.config.MigrationConfig;
+import migrator.engine.ItemFixture.OldItem;
+import migrator.exceptions.MigrateException;
+import migrator.heap.HeapCensus;
+import migrator.heap.HeapWalker;
+import migrator.metrics.MigrationMetrics;
+import migrator.state.MigrationState;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.Collection;
+import java.util.Collections;
+import java.util.Map;
+import java.util.Set;
+
+import static migrator.engine.ItemFixture.injectHeapWalker;
+import static migrator.engine.ItemFixture.newEngine;
+import static org.assertj.core.api.Assertions.assertThat;
+import static org.assertj.core.api.Assertions.assertThatThrownBy;
+
+/**
+ * Verifies the opt-in heap census: the engine counts the source classes before the first pass,
+ * records the counts in the metrics, and refuses a migration whose projected heap exceeds the
+ * configured maximum — before allocating anything for it.
+ */
+@DisplayName("MigrationEngine — heap census admission")
+class HeapCensusAdmissionTest {
+
+    /** Reports a census of fixed size; counts snapshots so tests can tell whether pass 1 ran. */
+    static final class CensusHeapWalker implements HeapWalker {
+        final long censusBytes;
+        int censusCalls = 0;
+        int snapshots = 0;
+
+        CensusHeapWalker(long censusBytes) { this.censusBytes = censusBytes; }
+
+        @Override public Object[] snapshotObjects(Class<?> targetClass) {
+            snapshots++;
+            return targetClass == OldItem.class ? new Object[]{new OldItem(1), new OldItem(2)} : new Object[0];
+        }
+
+        @Override public Set<Object> walkHeap() { return Collections.emptySet(); }
+        @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+
+        @Override public HeapCensus census(Collection<Class<?>> classes) {
+            censusCalls++;
+            assertThat(classes).containsExactly(OldItem.class);
+            return new HeapCensus(Map.of(OldItem.class,
+                    new HeapCensus.ClassCensus(OldItem.class, 2, censusBytes, null)));
+        }
+    }
+
+    @BeforeEach
+    void reset() {
+        MigrationState.getInstance().reset();
+    }
+
+    @AfterEach
+    void cleanup() {
+        MigrationState.getInstance().reset();
+    }
+
+    @Test
+    @DisplayName("records the census of the source classes in the metrics")
+    void recordsCensusInMetrics() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder().heapCensus(true).build());
+        CensusHeapWalker fake = new CensusHeapWalker(48);
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        MigrationMetrics metrics = MigrationEngine.getLastMetrics();
+        assertThat(fake.censusCalls).isEqualTo(1);
+        assertThat(metrics.hasCensus()).isTrue();
+        assertThat(metrics.sourceInstances()).isEqualTo(2);
+        assertThat(metrics.sourceShallowBytes()).isEqualTo(48);
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
+    }
+
+    @Test
+    @DisplayName("refuses a migration whose projected heap exceeds the maximum, before the first pass")
+    void refusesOversizedMigration() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder()
+                .heapCensus(true)
+                .maxHeapSizeMb(Runtime.getRuntime().maxMemory() / (1024 * 1024) + 1024)
+                .build());
+        CensusHeapWalker fake = new CensusHeapWalker(1L << 50); // 1 PB of source objects
+        injectHeapWalker(engine, fake);
+
+        assertThatThrownBy(() -> engine.migrate(Set.<Class<?>>of(), null, null))
+                .isInstanceOf(MigrateException.class)
+                .hasMessageContaining("source instances");
+
+        assertThat(fake.snapshots).isZero();
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.FAILED);
+    }
+
+    @Test
+    @DisplayName("is off by default, and a walker without census support does not block the migration")
+    void optInAndTolerant() throws Exception {
+        MigrationEngine engine = newEngine();
+        CensusHeapWalker fake = new CensusHeapWalker(48);
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(engine.isHeapCensus()).isFalse();
+        assertThat(fake.censusCalls).isZero();
+        assertThat(MigrationEngine.getLastMetrics().hasCensus()).isFalse();
+
+        MigrationState.getInstance().reset();
+        MigrationEngine plainEngine = newEngine().setHeapCensus(true);
+        injectHeapWalker(plainEngine, new HeapWalker() {
+            @Override public Object[] snapshotObjects(Class<?> c) {
+                return c == OldItem.class ? new Object[]{new OldItem(3)} : new Object[0];
+            }
+            @Override public Set<Object> walkHeap() { return Collections.emptySet(); }
+            @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+        });
+
+        plainEngine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
+        assertThat(MigrationEngine.getLastMetrics().hasCensus()).isFalse();
+    }
+}
@@ -0,0 +1,74 @@
+package migrator.engine;
+
+import migrator.config.HeapWalkerBackend;
+import migrator.config.MigrationConfig;
+import migrator.heap.ForeignHeapWalker;
+import migrator.heap.HeapWalker;
+import migrator.heap.NativeHeapWalker;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.lang.reflect.Field;
+import java.util.Collection;
+import java.util.Set;
+
+import static migrator.engine.ItemFixture.newEngine;
+import static org.assertj.core.api.Assertions.assertThat;
+
+/**
+ * Verifies how the engine picks its heap walker from {@code migration.heap.walker.backend}: the
+ * foreign walker when it can be bound, JNI otherwise, and a walker supplied from outside is never
+ * replaced.
+ */
+@DisplayName("MigrationEngine — heap walker backend selection")
+class HeapWalkerBackendTest {
+
+    @Test
+    @DisplayName("JNI is the default")
+    void jniByDefault() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.DEFAULTS);
+
+        assertThat(engine.getHeapWalkerBackend()).isEqualTo(HeapWalkerBackend.JNI);
+        assertThat(heapWalker(engine)).isInstanceOf(NativeHeapWalker.class);
+    }
+
+    @Test
+    @DisplayName("FOREIGN uses the foreign walker when it can be bound, and falls back to JNI otherwise")
+    void foreignOrFallback() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder()
+                .heapWalkerBackend(HeapWalkerBackend.FOREIGN)
+                .build());
+
+        assertThat(engine.getHeapWalkerBackend()).isEqualTo(HeapWalkerBackend.FOREIGN);
+        assertThat(heapWalker(engine)).isInstanceOf(
+                ForeignHeapWalker.isSupported() ? ForeignHeapWalker.class : NativeHeapWalker.class);
+
+        engine.setHeapWalkerBackend(HeapWalkerBackend.JNI);
+
+        assertThat(heapWalker(engine)).isInstanceOf(NativeHeapWalker.class);
+    }
+
+    @Test
+    @DisplayName("a heap walker supplied from outside is kept")
+    void customWalkerKept() throws Exception {
+        MigrationEngine engine = newEngine();
+        HeapWalker custom = new HeapWalker() {
+            @Override public Object[] snapshotObjects(Class<?> targetClass) { return new Object[0]; }
+            @Override public Set<Object> walkHeap() { return Set.of(); }
+            @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Set.of(); }
+        };
+        Field f = MigrationEngine.class.getDeclaredField("heapWalker");
+        f.setAccessible(true);
+        f.set(engine, custom);
+
+        engine.setHeapWalkerBackend(HeapWalkerBackend.FOREIGN).setHeapWalkerBackend(HeapWalkerBackend.JNI);
+
+        assertThat(heapWalker(engine)).isSameAs(custom);
+    }
+
+    private static HeapWalker heapWalker(MigrationEngine engine) throws Exception {
+        Field f = MigrationEngine.class.getDeclaredField("heapWalker");
+        f.setAccessible(true);
+        return (HeapWalker) f.get(engine);
+    }
+}
@@ -0,0 +1,143 @@
+package migrator.engine;
+
+import migrator.config.HeapWalkMode;
+import migrator.config.MigrationConfig;
+import migrator.engine.ItemFixture.Holder;
+import migrator.engine.ItemFixture.NewItem;
+import migrator.engine.ItemFixture.OldItem;
+import migrator.heap.HeapWalker;
+import migrator.heap.HolderClasses;
+import migrator.state.MigrationState;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Set;
+import java.util.function.Predicate;
+
+import static migrator.engine.ItemFixture.injectHeapWalker;
+import static migrator.engine.ItemFixture.newEngine;
+import static org.assertj.core.api.Assertions.assertThat;
+
+/**
+ * Verifies holder-class discovery in SPEC mode: the classes the walker reports as holding source
+ * instances are added to the filtered walk, and their static-field owners to static patching, so a
+ * holder missing from {@code classesToScan} is still patched.
+ */
+@DisplayName("MigrationEngine — holder-class discovery for SPEC walks")
+class HolderDiscoveryTest {
+
+    /** Holds a source instance in a static field. */
+    static final class StaticOwner { static Object item; }
+
+    /** Reports Holder and StaticOwner as holders; its filtered walk returns the Holder instance only if asked for Holder. */
+    static final class DiscoveringHeapWalker implements HeapWalker {
+        final OldItem a = new OldItem(1), b = new OldItem(2);
+        final Holder holder = new Holder(a);
+        final List<Collection<Class<?>>> discoveries = new ArrayList<>();
+        final List<Set<Class<?>>> filteredWalks = new ArrayList<>();
+        Predicate<Class<?>> climbed;
+
+        @Override public Object[] snapshotObjects(Class<?> targetClass) {
+            return targetClass == OldItem.class ? new Object[]{a, b} : new Object[0];
+        }
+
+        @Override public Set<Object> walkHeap() { return Collections.emptySet(); }
+
+        @Override public Set<Object> walkHeap(Collection<Class<?>> classes) {
+            filteredWalks.add(Set.copyOf(classes));
+            return classes.contains(Holder.class) ? Set.of(holder) : Collections.emptySet();
+        }
+
+        @Override public HolderClasses findHolderClasses(Collection<Class<?>> sourceClasses,
+                                                         Predicate<Class<?>> climbed, int maxDepth) {
+            discoveries.add(List.copyOf(sourceClasses));
+            this.climbed = climbed;
+            return new HolderClasses(Set.of(Holder.class), Set.of(StaticOwner.class));
+        }
+    }
+
+    @BeforeEach
+    void reset() {
+        MigrationState.getInstance().reset();
+    }
+
+    @AfterEach
+    void cleanup() {
+        StaticOwner.item = null;
+        MigrationState.getInstance().reset();
+    }
+
+    @Test
+    @DisplayName("walks and patches the discovered instance holders and static owners")
+    void patchesDiscoveredHolders() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder()
+                .heapWalkMode(HeapWalkMode.SPEC)
+                .discoverHolders(true)
+                .build());
+        DiscoveringHeapWalker fake = new DiscoveringHeapWalker();
+        StaticOwner.item = fake.b;
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(engine.isDiscoverHolders()).isTrue();
+        assertThat(fake.discoveries).containsExactly(List.of(OldItem.class));
+        // discovery climbs past what the patcher cannot walk on its own, to the classes holding it
+        assertThat(fake.climbed.test(HashMap.class)).isTrue();
+        assertThat(fake.climbed.test(Holder.class)).isFalse();
+        assertThat(fake.filteredWalks).isNotEmpty().allSatisfy(c -> assertThat(c).contains(Holder.class));
+        assertThat(fake.holder.item).isInstanceOf(NewItem.class);
+        assertThat(StaticOwner.item).isInstanceOf(NewItem.class);
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
+    }
+
+    @Test
+    @DisplayName("is off by default: the filtered walk misses an unlisted holder")
+    void offByDefault() throws Exception {
+        MigrationEngine engine = newEngine();
+        DiscoveringHeapWalker fake = new DiscoveringHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(engine.isDiscoverHolders()).isFalse();
+        assertThat(fake.discoveries).isEmpty();
+        assertThat(fake.holder.item).isInstanceOf(OldItem.class);
+    }
+
+    @Test
+    @DisplayName("is skipped outside SPEC mode, and a walker without discovery support does not block the migration")
+    void specOnlyAndTolerant() throws Exception {
+        MigrationEngine fullEngine = newEngine().applyConfig(MigrationConfig.builder()
+                .heapWalkMode(HeapWalkMode.FULL)
+                .discoverHolders(true)
+                .build());
+        DiscoveringHeapWalker fake = new DiscoveringHeapWalker();
+        injectHeapWalker(fullEngine, fake);
+
+        fullEngine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(fake.discoveries).isEmpty();
+
+        MigrationState.getInstance().reset();
+        MigrationEngine plainEngine = newEngine().setDiscoverHolders(true);
+        injectHeapWalker(plainEngine, new HeapWalker() {
+            @Override public Object[] snapshotObjects(Class<?> c) {
+                return c == OldItem.class ? new Object[]{new OldItem(3)} : new Object[0];
+            }
+            @Override public Set<Object> walkHeap() { return Collections.emptySet(); }
+            @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+        });
+
+        plainEngine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
+    }
+}
@@ -0,0 +1,63 @@
+package migrator.engine;
+
+import migrator.ClassMigrator;
+import migrator.commit.CommitManager;
+import migrator.commit.RollbackManager;
+import migrator.crac.NoopCracController;
+import migrator.exceptions.MigrateException;
+import migrator.heap.HeapWalker;
+import migrator.phase.NoopPhaseListener;
+import migrator.smoke.SmokeTestRunner;
+
+import java.lang.reflect.Field;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+
+/**
+ * The migration shared by the engine tests that replace a collaborator of the engine with a fake:
+ * {@link OldItem}s become {@link NewItem}s through {@link ItemMigrator}, and a {@link Holder}
+ * references an item from a field.
+ */
+final class ItemFixture {
+
+    private ItemFixture() {
+    }
+
+    static final class OldItem { final int id; OldItem(int id) { this.id = id; } }
+    static final class NewItem { final int id; NewItem(int id) { this.id = id; } }
+    static final class Holder { Object item; Holder(Object item) { this.item = item; } }
+
+    /** Public + no-arg so MigratorDescriptor can instantiate it. */
+    public static final class ItemMigrator implements ClassMigrator<OldItem, NewItem> {
+        /** Every item migrated, in order; a test that reads it clears it first. */
+        static final List<OldItem> migrated = Collections.synchronizedList(new ArrayList<>());
+
+        @Override public NewItem migrate(OldItem old) {
+            migrated.add(old);
+            return new NewItem(old.id);
+        }
+    }
+
+    /** @return an engine migrating {@link OldItem} to {@link NewItem}, with no-op collaborators */
+    static MigrationEngine newEngine() throws MigrateException {
+        return new MigrationEngine(
+                ItemMigrator.class,
+                NoopPhaseListener.INSTANCE,
+                new SmokeTestRunner.Builder().build(),
+                new CommitManager(NoopCracController.INSTANCE),
+                new RollbackManager(NoopCracController.INSTANCE));
+    }
+
+    /** Replaces the engine's heap walker. */
+    static void injectHeapWalker(MigrationEngine engine, HeapWalker walker) throws Exception {
+        inject(engine, "heapWalker", walker);
+    }
+
+    /** Replaces the engine's private {@code field} with {@code value}. */
+    static void inject(MigrationEngine engine, String field, Object value) throws Exception {
+        Field f = MigrationEngine.class.getDeclaredField(field);
+        f.setAccessible(true);
+        f.set(engine, value);
+    }
+}
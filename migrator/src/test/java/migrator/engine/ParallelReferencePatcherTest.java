@@ -0,0 +1,154 @@
+package migrator.engine;
+
+import migrator.patch.ForwardingTable;
+import migrator.patch.ParallelReferencePatcher;
+import migrator.patch.ReflectionReferencePatcher;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.function.Consumer;
+
+import static org.assertj.core.api.Assertions.assertThat;
+import static org.assertj.core.api.Assertions.assertThatThrownBy;
+
+/**
+ * {@link ParallelReferencePatcher} must patch exactly what the sequential patcher does: graphs
+ * large and connected enough that the workers split and steal each other's stacks.
+ */
+@DisplayName("ParallelReferencePatcher")
+class ParallelReferencePatcherTest {
+
+    interface Identifiable { int getId(); }
+
+    static final class OldClass implements Identifiable {
+        private final int id;
+        OldClass(int id) { this.id = id; }
+        @Override public int getId() { return id; }
+    }
+
+    static final class NewClass implements Identifiable {
+        private final int id;
+        NewClass(int id) { this.id = id; }
+        @Override public int getId() { return id; }
+    }
+
+    static final class Node {
+        Identifiable payload;
+        Node next;
+        Node skip;
+        final List<Object> items = new ArrayList<>();
+    }
+
+    private ForwardingTable forwarding;
+    private ParallelReferencePatcher patcher;
+
+    @BeforeEach
+    void setUp() {
+        forwarding = new ForwardingTable();
+        patcher = new ParallelReferencePatcher(new ReflectionReferencePatcher(forwarding), 4);
+    }
+
+    @AfterEach
+    void tearDown() {
+        patcher.close();
+    }
+
+    /** A ring of {@code n} nodes with skip links; each holds a migrated payload field and list element. */
+    private Node[] ring(int n) {
+        Node[] nodes = new Node[n];
+        for (int i = 0; i < n; i++) {
+            OldClass old = new OldClass(i);
+            forwarding.put(old, new NewClass(i));
+            nodes[i] = new Node();
+            nodes[i].payload = old;
+            nodes[i].items.add(old);
+        }
+        for (int i = 0; i < n; i++) {
+            nodes[i].next = nodes[(i + 1) % n];
+            nodes[i].skip = nodes[(i + 97) % n];
+        }
+        return nodes;
+    }
+
+    private static void assertPatched(Node[] nodes) {
+        for (Node node : nodes) {
+            assertThat(node.payload).isInstanceOf(NewClass.class);
+            assertThat(node.items).singleElement().isSameAs(node.payload);
+        }
+    }
+
+    @Test
+    @DisplayName("patches every node of a large connected graph reached from one root")
+    void patchesGraphFromOneRoot() {
+        Node[] nodes = ring(50_000);
+
+        patcher.patchObjects(List.of(nodes[0]));
+
+        assertPatched(nodes);
+    }
+
+    @Test
+    @DisplayName("patches a batch of many roots that reach one another")
+    void patchesManyRoots() {
+        Node[] nodes = ring(20_000);
+
+        patcher.patchObjects(List.of(nodes));
+
+        assertPatched(nodes);
+    }
+
+    @Test
+    @DisplayName("rebuilds a shared JDK container once, with every migrated entry replaced")
+    void rebuildsSharedContainer() {
+        Node[] nodes = ring(5_000);
+        Map<Object, Object> shared = new HashMap<>();
+        for (Node node : nodes) shared.put(node.payload, node.payload);
+        for (Node node : nodes) node.items.add(shared);
+
+        patcher.patchObjects(List.of(nodes));
+
+        assertThat(shared).hasSize(nodes.length);
+        shared.forEach((k, v) -> {
+            assertThat(k).isInstanceOf(NewClass.class);
+            assertThat(v).isSameAs(k);
+        });
+    }
+
+    @Test
+    @DisplayName("shares the visited set across the chunks of one batch")
+    void sharesVisitedAcrossChunks() {
+        Node[] nodes = ring(2_000);
+        Consumer<Object[]> batch = patcher.openBatch();
+
+        batch.accept(new Object[] { nodes[0] });
+        assertPatched(nodes);
+
+        // already visited in this batch: a later chunk does not reprocess it
+        OldClass again = new OldClass(-1);
+        forwarding.put(again, new NewClass(-1));
+        nodes[1].payload = again;
+        batch.accept(new Object[] { nodes[1], null });
+        assertThat(nodes[1].payload).isSameAs(again);
+
+        patcher.openBatch().accept(new Object[] { nodes[1] });
+        assertThat(nodes[1].payload).isInstanceOf(NewClass.class);
+    }
+
+    @Test
+    @DisplayName("ignores null and empty batches and rejects a parallelism below one")
+    void edgeCases() {
+        patcher.patchObjects(null);
+        patcher.patchObjects(List.of());
+        patcher.openBatch().accept(null);
+
+        assertThat(patcher.parallelism()).isEqualTo(4);
+        assertThatThrownBy(() -> new ParallelReferencePatcher(new ReflectionReferencePatcher(forwarding), 0))
+                .isInstanceOf(IllegalArgumentException.class);
+    }
+}
@@ -0,0 +1,166 @@
+package migrator.engine;
+
+import migrator.config.HeapWalkMode;
+import migrator.config.MigrationConfig;
+import migrator.engine.ItemFixture.Holder;
+import migrator.engine.ItemFixture.ItemMigrator;
+import migrator.engine.ItemFixture.NewItem;
+import migrator.engine.ItemFixture.OldItem;
+import migrator.heap.HeapCensus;
+import migrator.heap.HeapWalker;
+import migrator.metrics.MigrationMetrics;
+import migrator.state.MigrationState;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.IdentityHashMap;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+import java.util.function.Consumer;
+
+import static migrator.engine.ItemFixture.injectHeapWalker;
+import static migrator.engine.ItemFixture.newEngine;
+import static org.assertj.core.api.Assertions.assertThat;
+
+/**
+ * Verifies the REACHABLE walk mode: the first pass migrates only the reachable source instances,
+ * the second pass patches only reachable objects, and the garbage left out is reported when a
+ * census gives the total to compare against.
+ */
+@DisplayName("MigrationEngine — REACHABLE walk mode")
+class ReachableWalkTest {
+
+    /**
+     * Two live items held by a live holder, plus three dead items and a dead holder (of a live
+     * item) that a heap iteration still reports. Records which walks the engine asked for.
+     */
+    static final class GarbageHeapWalker implements HeapWalker {
+        final OldItem live1 = new OldItem(1), live2 = new OldItem(2);
+        final Holder liveHolder = new Holder(live1);
+        final List<OldItem> dead = List.of(new OldItem(3), new OldItem(4), new OldItem(5));
+        final Holder deadHolder = new Holder(live2);
+        final List<String> calls = new ArrayList<>();
+
+        @Override public Object[] snapshotObjects(Class<?> targetClass) {
+            if (targetClass != OldItem.class) return new Object[0];
+            List<Object> all = new ArrayList<>(List.of(live1, live2));
+            all.addAll(dead);
+            return all.toArray();
+        }
+
+        @Override public Map<Class<?>, Object[]> snapshotReachable(Collection<Class<?>> classes) {
+            calls.add("snapshotReachable");
+            Map<Class<?>, Object[]> result = new LinkedHashMap<>();
+            for (Class<?> c : classes) {
+                result.put(c, c == OldItem.class ? new Object[]{live1, live2} : new Object[0]);
+            }
+            return result;
+        }
+
+        @Override public Set<Object> walkHeap() {
+            calls.add("walkHeap");
+            return identitySet(liveHolder, live1, live2, deadHolder);
+        }
+
+        @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+
+        @Override public Set<Object> walkReachable(Collection<Class<?>> leafClasses) {
+            calls.add("walkReachable");
+            return identitySet(liveHolder, live1, live2);
+        }
+
+        @Override public long walkReachable(Collection<Class<?>> leafClasses, Consumer<Object[]> chunkSink,
+                                            int chunkSize) {
+            calls.add("walkReachableChunked");
+            chunkSink.accept(new Object[]{liveHolder});
+            return 1;
+        }
+
+        @Override public HeapCensus census(Collection<Class<?>> classes) {
+            return new HeapCensus(Map.of(OldItem.class,
+                    new HeapCensus.ClassCensus(OldItem.class, 5, 80, null)));
+        }
+
+        private static Set<Object> identitySet(Object... objects) {
+            Set<Object> set = Collections.newSetFromMap(new IdentityHashMap<>());
+            Collections.addAll(set, objects);
+            return set;
+        }
+    }
+
+    @BeforeEach
+    void reset() {
+        MigrationState.getInstance().reset();
+        ItemMigrator.migrated.clear();
+    }
+
+    @AfterEach
+    void cleanup() {
+        MigrationState.getInstance().reset();
+    }
+
+    @Test
+    @DisplayName("migrates and patches only reachable objects, and reports the garbage left out")
+    void migratesOnlyReachable() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder()
+                .heapWalkMode(HeapWalkMode.REACHABLE)
+                .walkChunkSize(0)
+                .heapCensus(true)
+                .build());
+        GarbageHeapWalker fake = new GarbageHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(ItemMigrator.migrated).containsExactly(fake.live1, fake.live2);
+        assertThat(fake.calls).contains("snapshotReachable", "walkReachable").doesNotContain("walkHeap");
+        assertThat(fake.liveHolder.item).isInstanceOf(NewItem.class);
+        assertThat(fake.deadHolder.item).isInstanceOf(OldItem.class);
+
+        MigrationMetrics metrics = MigrationEngine.getLastMetrics();
+        assertThat(metrics.hasUnreachableSkipped()).isTrue();
+        assertThat(metrics.unreachableSkipped()).isEqualTo(3);
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
+    }
+
+    @Test
+    @DisplayName("streams the reachable walk in chunks, and reports no garbage count without a census")
+    void streamedWithoutCensus() throws Exception {
+        MigrationEngine engine = newEngine().setHeapWalkMode(HeapWalkMode.REACHABLE).setWalkChunkSize(16);
+        GarbageHeapWalker fake = new GarbageHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(ItemMigrator.migrated).hasSize(2);
+        assertThat(fake.calls).contains("walkReachableChunked");
+        assertThat(fake.liveHolder.item).isInstanceOf(NewItem.class);
+        assertThat(MigrationEngine.getLastMetrics().hasUnreachableSkipped()).isFalse();
+    }
+
+    @Test
+    @DisplayName("other modes snapshot the whole heap and measure nothing")
+    void otherModesUnchanged() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder()
+                .heapWalkMode(HeapWalkMode.FULL)
+                .skipLeaves(false)
+                .walkChunkSize(0)
+                .heapCensus(true)
+                .build());
+        GarbageHeapWalker fake = new GarbageHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(ItemMigrator.migrated).hasSize(5);
+        assertThat(fake.calls).contains("walkHeap").doesNotContain("snapshotReachable", "walkReachable");
+        assertThat(MigrationEngine.getLastMetrics().hasUnreachableSkipped()).isFalse();
+    }
+}
@@ -0,0 +1,107 @@
+package migrator.engine;
+
+import migrator.config.HeapWalkMode;
+import migrator.config.MigrationConfig;
+import migrator.engine.ItemFixture.Holder;
+import migrator.engine.ItemFixture.NewItem;
+import migrator.engine.ItemFixture.OldItem;
+import migrator.heap.HeapWalker;
+import migrator.heap.ReclamationProgress;
+import migrator.state.MigrationState;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Set;
+
+import static migrator.engine.ItemFixture.injectHeapWalker;
+import static migrator.engine.ItemFixture.newEngine;
+import static org.assertj.core.api.Assertions.assertThat;
+
+/**
+ * Verifies the optional reclamation tracking after commit: the engine hands the migrated old
+ * objects to the walker's tracker and publishes its progress through {@link MigrationState}.
+ */
+@DisplayName("MigrationEngine — reclamation tracking")
+class ReclamationTrackingTest {
+
+    /** A heap of one holder of one old item, with a tracker that records what it was given. */
+    static final class TrackingHeapWalker implements HeapWalker {
+        final OldItem old = new OldItem(1);
+        final Holder holder = new Holder(old);
+        final List<Object> tracked = new ArrayList<>();
+        final ReclamationProgress progress = new ReclamationProgress(3, 1, 16, 0, 0, 0, 5_000, true);
+
+        @Override public Object[] snapshotObjects(Class<?> targetClass) {
+            return targetClass == OldItem.class ? new Object[]{old} : new Object[0];
+        }
+
+        @Override public Set<Object> walkHeap() {
+            Set<Object> set = Collections.newSetFromMap(new IdentityHashMap<>());
+            set.add(holder);
+            return set;
+        }
+
+        @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+
+        @Override public boolean startReclamationTracking(Collection<?> objects) {
+            tracked.addAll(objects);
+            return true;
+        }
+
+        @Override public ReclamationProgress reclamationProgress() {
+            return tracked.isEmpty() ? ReclamationProgress.NONE : progress;
+        }
+    }
+
+    @BeforeEach
+    void reset() {
+        MigrationState.getInstance().reset();
+    }
+
+    @AfterEach
+    void cleanup() {
+        MigrationState.getInstance().reset();
+    }
+
+    @Test
+    @DisplayName("tracks the migrated old objects after commit and publishes the tracker's progress")
+    void tracksOldObjects() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder()
+                .heapWalkMode(HeapWalkMode.FULL)
+                .walkChunkSize(0)
+                .trackReclamation(true)
+                .build());
+        TrackingHeapWalker fake = new TrackingHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        MigrationState state = MigrationState.getInstance();
+        assertThat(fake.tracked).containsExactly(fake.old);
+        assertThat(fake.holder.item).isInstanceOf(NewItem.class);
+        assertThat(state.getReclamationMigrationId()).isEqualTo(MigrationEngine.getLastMetrics().migrationId());
+        assertThat(state.getReclamation()).isSameAs(fake.progress);
+        assertThat(state.toMap()).containsKey("reclamation");
+    }
+
+    @Test
+    @DisplayName("is off by default")
+    void offByDefault() throws Exception {
+        MigrationEngine engine = newEngine().setHeapWalkMode(HeapWalkMode.FULL);
+        TrackingHeapWalker fake = new TrackingHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(engine.isTrackReclamation()).isFalse();
+        assertThat(fake.tracked).isEmpty();
+        assertThat(MigrationState.getInstance().getReclamation()).isEqualTo(ReclamationProgress.NONE);
+    }
+}
@@ -0,0 +1,303 @@
+package migrator.engine;
+
+import migrator.ClassMigrator;
+import migrator.commit.CommitManager;
+import migrator.commit.RollbackManager;
+import migrator.config.HeapWalkMode;
+import migrator.crac.NoopCracController;
+import migrator.exceptions.MigrateException;
+import migrator.heap.HeapReferenceKind;
+import migrator.heap.HeapReferrerChains;
+import migrator.heap.HeapReferrers;
+import migrator.heap.HeapWalker;
+import migrator.heap.SlotPatchResult;
+import migrator.phase.NoopPhaseListener;
+import migrator.smoke.SmokeTestRunner;
+import migrator.state.MigrationState;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.lang.reflect.Field;
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+import java.util.function.Predicate;
+
+import static org.assertj.core.api.Assertions.assertThat;
+
+/**
+ * Verifies the REFERRERS second pass: the engine asks the heap walker for the holders of the
+ * migrated objects, climbs past JDK-internal holders until it reaches an application-owned one,
+ * and patches exactly those chains — without a full or filtered heap walk.
+ *
+ * <p>The engine's heap walker is replaced with a fake whose referrer graph is declared up front.
+ */
+@DisplayName("MigrationEngine — REFERRERS second pass")
+class ReferrerWalkTest {
+
+    interface Account {}
+    static final class OldAccount implements Account { final int id; OldAccount(int id) { this.id = id; } }
+    static final class NewAccount implements Account { final int id; NewAccount(int id) { this.id = id; } }
+
+    /** Public + no-arg so MigratorDescriptor can instantiate it. */
+    public static final class AccountMigrator implements ClassMigrator<OldAccount, NewAccount> {
+        @Override public NewAccount migrate(OldAccount old) { return new NewAccount(old.id); }
+    }
+
+    static final class Session { Account account; Session(Account account) { this.account = account; } }
+    static final class Registry { final List<Account> accounts = new ArrayList<>(); }
+
+    /** Snapshots two accounts; answers referrer walks from a fixed holder graph; counts heap walks. */
+    static final class ReferrerHeapWalker implements HeapWalker {
+        final OldAccount a1 = new OldAccount(1);
+        final OldAccount a2 = new OldAccount(2);
+        final Session session = new Session(a1);
+        final Registry registry = new Registry();
+        final Map<Object, List<Object>> referrersOf = new IdentityHashMap<>();
+        int heapWalks = 0;
+        int referrerWalks = 0;
+        // chain walks: false = unsupported (default method); true = answered from the same graph,
+        // failing once more than maxEdges references are recorded
+        boolean chains = false;
+        int chainWalks = 0;
+        // slot patching: null = unsupported (default method); true = rewrite Session slots; false = skip all
+        Boolean rewriteSlots = null;
+        final List<Object> slotHolders = new ArrayList<>();
+
+        ReferrerHeapWalker() {
+            registry.accounts.add(a2);
+            referrersOf.put(a1, List.of(session));
+            referrersOf.put(a2, List.of(registry.accounts)); // JDK holder: must be climbed
+            referrersOf.put(registry.accounts, List.of(registry));
+        }
+
+        @Override public Object[] snapshotObjects(Class<?> targetClass) {
+            return targetClass == OldAccount.class ? new Object[]{a1, a2} : new Object[0];
+        }
+
+        @Override public Set<Object> walkHeap() { heapWalks++; return Collections.emptySet(); }
+        @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { heapWalks++; return Collections.emptySet(); }
+
+        @Override public HeapReferrers findReferrers(Collection<?> targets) {
+            referrerWalks++;
+            List<Object> holders = new ArrayList<>();
+            for (Object t : targets) holders.addAll(referrersOf.getOrDefault(t, List.of()));
+            return new HeapReferrers(holders.toArray(), Map.of(HeapReferenceKind.FIELD, (long) holders.size()));
+        }
+
+        @Override public HeapReferrerChains findReferrerChains(Collection<?> targets, Predicate<Class<?>> climbed,
+                                                               int maxDepth, long maxEdges) throws MigrateException {
+            if (!chains) return HeapWalker.super.findReferrerChains(targets, climbed, maxDepth, maxEdges);
+            chainWalks++;
+            long edges = 0;
+            Set<Object> seen = Collections.newSetFromMap(new IdentityHashMap<>());
+            List<Object> holders = new ArrayList<>();
+            List<Object> direct = new ArrayList<>();
+            List<Object> linked = new ArrayList<>();
+            Collection<?> frontier = targets;
+            for (int depth = 0; depth < maxDepth && !frontier.isEmpty(); depth++) {
+                List<Object> next = new ArrayList<>();
+                for (Object t : frontier) {
+                    for (Object h : referrersOf.getOrDefault(t, List.of())) {
+                        if (++edges > maxEdges) throw new MigrateException("over " + maxEdges + " references");
+                        boolean first = seen.add(h);
+                        if (first) holders.add(h);
+                        if (climbed.test(h.getClass())) {
+                            if (first) next.add(h);
+                        } else {
+                            (depth == 0 ? direct : linked).add(h);
+                        }
+                    }
+                }
+                frontier = next;
+            }
+            return new HeapReferrerChains(new HeapReferrers(holders.toArray(), Map.of()), direct, linked, List.of());
+        }
+
+        @Override public SlotPatchResult patchSlots(Collection<?> holders, Object[] olds, Object[] news)
+                throws MigrateException {
+            if (rewriteSlots == null) return HeapWalker.super.patchSlots(holders, olds, news);
+            slotHolders.addAll(holders);
+            if (!rewriteSlots) return new SlotPatchResult(holders.size(), 0, holders.toArray());
+            for (Object h : holders) {
+                if (h instanceof Session sess) {
+                    for (int i = 0; i < olds.length; i++) {
+                        if (sess.account == olds[i]) sess.account = (Account) news[i];
+                    }
+                }
+            }
+            return new SlotPatchResult(holders.size(), holders.size(), new Object[0]);
+        }
+    }
+
+    @BeforeEach
+    void reset() {
+        MigrationState.getInstance().reset();
+    }
+
+    @AfterEach
+    void cleanup() {
+        MigrationState.getInstance().reset();
+    }
+
+    @Test
+    @DisplayName("patches field and collection holders found by referrer walks, without a heap walk")
+    void patchesHoldersFoundByReferrerWalk() throws Exception {
+        MigrationEngine engine = newEngine();
+        engine.setHeapWalkMode(HeapWalkMode.REFERRERS);
+        ReferrerHeapWalker fake = new ReferrerHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(fake.session.account).isInstanceOf(NewAccount.class);
+        assertThat(fake.registry.accounts).singleElement().isInstanceOf(NewAccount.class);
+        // level 1: accounts -> {session, list}; level 2: list -> {registry}; level 3 is never needed
+        assertThat(fake.referrerWalks).isEqualTo(2);
+        assertThat(fake.heapWalks).isZero();
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
+    }
+
+    @Test
+    @DisplayName("climbs every level in one chain walk when the walker supports it")
+    void climbsInOneChainWalk() throws Exception {
+        MigrationEngine engine = newEngine();
+        engine.setHeapWalkMode(HeapWalkMode.REFERRERS);
+        ReferrerHeapWalker fake = new ReferrerHeapWalker();
+        fake.chains = true;
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(fake.session.account).isInstanceOf(NewAccount.class);
+        assertThat(fake.registry.accounts).singleElement().isInstanceOf(NewAccount.class);
+        assertThat(fake.chainWalks).isEqualTo(1);
+        assertThat(fake.referrerWalks).isZero();
+        assertThat(fake.heapWalks).isZero();
+    }
+
+    @Test
+    @DisplayName("climbs one referrer walk per level once the chain walk exceeds its limit")
+    void fallsBackAboveChainLimit() throws Exception {
+        MigrationEngine engine = newEngine();
+        engine.setHeapWalkMode(HeapWalkMode.REFERRERS);
+        engine.setReferrerChainLimit(2); // the graph has three references
+        ReferrerHeapWalker fake = new ReferrerHeapWalker();
+        fake.chains = true;
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(fake.session.account).isInstanceOf(NewAccount.class);
+        assertThat(fake.registry.accounts).singleElement().isInstanceOf(NewAccount.class);
+        assertThat(fake.chainWalks).isEqualTo(1);
+        assertThat(fake.referrerWalks).isEqualTo(2);
+    }
+
+    @Test
+    @DisplayName("a chain limit of 0 skips the chain walk")
+    void zeroChainLimitSkipsChainWalk() throws Exception {
+        MigrationEngine engine = newEngine();
+        engine.setHeapWalkMode(HeapWalkMode.REFERRERS);
+        engine.setReferrerChainLimit(0);
+        ReferrerHeapWalker fake = new ReferrerHeapWalker();
+        fake.chains = true;
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(fake.registry.accounts).singleElement().isInstanceOf(NewAccount.class);
+        assertThat(fake.chainWalks).isZero();
+        assertThat(fake.referrerWalks).isEqualTo(2);
+    }
+
+    @Test
+    @DisplayName("native patching gets only the direct holders; the Java patcher handles the chains")
+    void nativePatchingTakesDirectHolders() throws Exception {
+        MigrationEngine engine = newEngine();
+        engine.setHeapWalkMode(HeapWalkMode.REFERRERS).setNativePatching(true);
+        ReferrerHeapWalker fake = new ReferrerHeapWalker();
+        fake.rewriteSlots = true;
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        // the list is a JDK holder (not an anchor) and the registry reaches a migrated object only
+        // through it, so only the session is handed to the native pass
+        assertThat(fake.slotHolders).containsExactly(fake.session);
+        assertThat(fake.session.account).isInstanceOf(NewAccount.class);
+        assertThat(fake.registry.accounts).singleElement().isInstanceOf(NewAccount.class);
+    }
+
+    @Test
+    @DisplayName("holders with skipped slots, or a walker without slot patching, fall back to the Java patcher")
+    void nativePatchingFallsBackToJava() throws Exception {
+        for (Boolean mode : new Boolean[]{false, null}) {
+            MigrationState.getInstance().reset();
+            MigrationEngine engine = newEngine();
+            engine.setHeapWalkMode(HeapWalkMode.REFERRERS).setNativePatching(true);
+            ReferrerHeapWalker fake = new ReferrerHeapWalker();
+            fake.rewriteSlots = mode;
+            injectHeapWalker(engine, fake);
+
+            engine.migrate(Set.<Class<?>>of(), null, null);
+
+            assertThat(fake.session.account).as("rewriteSlots=%s", mode).isInstanceOf(NewAccount.class);
+            assertThat(fake.registry.accounts).singleElement().isInstanceOf(NewAccount.class);
+        }
+    }
+
+    @Test
+    @DisplayName("falls back to patching the pass-2 objects when the walker has no referrer support")
+    void fallsBackWithoutReferrerSupport() throws Exception {
+        MigrationEngine engine = newEngine();
+        engine.setHeapWalkMode(HeapWalkMode.REFERRERS);
+        HeapWalker plain = new HeapWalker() {
+            final OldAccount a = new OldAccount(1);
+            @Override public Object[] snapshotObjects(Class<?> c) {
+                return c == OldAccount.class ? new Object[]{a} : new Object[0];
+            }
+            @Override public Set<Object> walkHeap() { return Collections.emptySet(); }
+            @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+        };
+        injectHeapWalker(engine, plain);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
+    }
+
+    @Test
+    @DisplayName("setFullHeapWalk maps onto the heap walk mode")
+    void setFullHeapWalkMapsToMode() throws MigrateException {
+        MigrationEngine engine = newEngine();
+        engine.setFullHeapWalk(true);
+        assertThat(engine.getHeapWalkMode()).isEqualTo(HeapWalkMode.FULL);
+        engine.setHeapWalkMode(HeapWalkMode.REFERRERS);
+        assertThat(engine.isFullHeapWalk()).isFalse();
+        engine.setHeapWalkMode(null);
+        assertThat(engine.getHeapWalkMode()).isEqualTo(HeapWalkMode.SPEC);
+        assertThat(engine.isNativePatching()).isFalse();
+    }
+
+    private static MigrationEngine newEngine() throws MigrateException {
+        return new MigrationEngine(
+                AccountMigrator.class,
+                NoopPhaseListener.INSTANCE,
+                new SmokeTestRunner.Builder().build(),
+                new CommitManager(NoopCracController.INSTANCE),
+                new RollbackManager(NoopCracController.INSTANCE));
+    }
+
+    private static void injectHeapWalker(MigrationEngine engine, HeapWalker walker) throws Exception {
+        Field f = MigrationEngine.class.getDeclaredField("heapWalker");
+        f.setAccessible(true);
+        f.set(engine, walker);
+    }
+}
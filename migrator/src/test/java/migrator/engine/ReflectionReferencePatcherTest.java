@@ -1,14 +1,20 @@
 package migrator.engine;
 
+import migrator.patch.BitmapVisitedSet;
 import migrator.patch.ForwardingTable;
+import migrator.patch.ParallelReferencePatcher;
 import migrator.patch.ReflectionReferencePatcher;
+import migrator.patch.VisitedSet;
 import org.junit.jupiter.api.BeforeEach;
 import org.junit.jupiter.api.DisplayName;
 import org.junit.jupiter.api.Nested;
 import org.junit.jupiter.api.Test;
 
 import java.lang.ref.WeakReference;
+import java.math.BigDecimal;
 import java.util.*;
+import java.util.function.Consumer;
+import java.util.function.ToIntFunction;
 
 import static org.assertj.core.api.Assertions.assertThat;
 import static org.assertj.core.api.Assertions.assertThatCode;
@@ -667,6 +673,349 @@ class ReflectionReferencePatcherTest {
         }
     }
 
+    @Nested
+    @DisplayName("openBatch (chunked roots)")
+    class ChunkedBatch {
+
+        @Test
+        @DisplayName("should patch every chunk before the sink returns")
+        void shouldPatchEachChunkOnArrival() {
+            OldClass old = new OldClass(1);
+            NewClass replacement = new NewClass(1);
+            forwarding.put(old, replacement);
+            ContainerWithField first = new ContainerWithField(old);
+            ContainerWithField second = new ContainerWithField(old);
+
+            Consumer<Object[]> batch = patcher.openBatch();
+            batch.accept(new Object[]{first, null});
+            assertThat(first.reference).isSameAs(replacement);
+            assertThat(second.reference).isSameAs(old);
+
+            batch.accept(new Object[]{second});
+            assertThat(second.reference).isSameAs(replacement);
+        }
+
+        @Test
+        @DisplayName("should share the visited set across the chunks of one batch")
+        void shouldShareVisitedSetAcrossChunks() {
+            OldClass old = new OldClass(1);
+            NewClass replacement = new NewClass(1);
+            forwarding.put(old, replacement);
+            ContainerWithField shared = new ContainerWithField(old);
+            ContainerWithObjectField viaFirst = new ContainerWithObjectField(shared);
+
+            Consumer<Object[]> batch = patcher.openBatch();
+            batch.accept(new Object[]{viaFirst});
+            assertThat(shared.reference).isSameAs(replacement);
+
+            // already visited in this batch: a later chunk does not reprocess it
+            shared.reference = old;
+            batch.accept(new Object[]{shared});
+            assertThat(shared.reference).isSameAs(old);
+
+            // a new batch starts from a fresh visited set
+            patcher.openBatch().accept(new Object[]{shared});
+            assertThat(shared.reference).isSameAs(replacement);
+        }
+    }
+
+    @Nested
+    @DisplayName("visited sets")
+    class VisitedSets {
+
+        /** A dense index over {@code objects}, in order; everything else is unindexed. */
+        private ToIntFunction<Object> indexOver(Object... objects) {
+            Map<Object, Integer> index = new IdentityHashMap<>();
+            for (Object o : objects) index.put(o, index.size());
+            return o -> index.getOrDefault(o, -1);
+        }
+
+        @Test
+        @DisplayName("should open one set per batch from the factory and close it after patchObjects")
+        void shouldUseFactoryPerBatch() {
+            OldClass old = new OldClass(1);
+            NewClass replacement = new NewClass(1);
+            forwarding.put(old, replacement);
+            List<Integer> opened = new ArrayList<>();
+            int[] closed = {0};
+            patcher.setVisitedSets((expected, concurrency) -> {
+                opened.add(concurrency);
+                VisitedSet identity = VisitedSet.IDENTITY.open(expected, concurrency);
+                return new VisitedSet() {
+                    @Override public boolean add(Object o) { return identity.add(o); }
+                    @Override public void close() { closed[0]++; }
+                };
+            });
+            ContainerWithField a = new ContainerWithField(old);
+            ContainerWithField b = new ContainerWithField(old);
+
+            patcher.patchObjects(List.of(a));
+            patcher.openBatch().accept(new Object[] { b });
+            patcher.patchObject(new ContainerWithField(old)); // single roots keep their own set
+
+            assertThat(a.reference).isSameAs(replacement);
+            assertThat(b.reference).isSameAs(replacement);
+            assertThat(opened).containsExactly(1, 1);
+            assertThat(closed[0]).isEqualTo(1);
+
+            patcher.setVisitedSets(null);
+            assertThat(patcher.getVisitedSets()).isSameAs(VisitedSet.IDENTITY);
+        }
+
+        @Test
+        @DisplayName("should patch a cyclic graph with a bitmap over the walk's dense index")
+        void shouldPatchWithBitmap() {
+            OldClass old = new OldClass(1);
+            NewClass replacement = new NewClass(1);
+            forwarding.put(old, replacement);
+            CycleDetection.SelfRef x = new CycleDetection.SelfRef(), y = new CycleDetection.SelfRef();
+            x.self = y;
+            y.self = x;
+            x.value = old;
+            y.value = old;
+            patcher.setVisitedSets((expected, concurrency) -> new BitmapVisitedSet(indexOver(x, y)));
+
+            patcher.patchObjects(List.of(x, y));
+
+            assertThat(x.value).isSameAs(replacement);
+            assertThat(y.value).isSameAs(replacement);
+        }
+
+        @Test
+        @DisplayName("should leave an unindexed object to its own chunk but admit it as a root")
+        void shouldLeaveUnindexedToItsChunk() {
+            OldClass old = new OldClass(1);
+            NewClass replacement = new NewClass(1);
+            forwarding.put(old, replacement);
+            ContainerWithField later = new ContainerWithField(old);
+            ContainerWithObjectField first = new ContainerWithObjectField(later);
+            patcher.setVisitedSets((expected, concurrency) -> new BitmapVisitedSet(indexOver(first)));
+            Consumer<Object[]> batch = patcher.openBatch();
+
+            batch.accept(new Object[] { first });
+            assertThat(later.reference).as("not indexed yet: left to its chunk").isSameAs(old);
+
+            batch.accept(new Object[] { later });
+            assertThat(later.reference).isSameAs(replacement);
+        }
+
+        @Test
+        @DisplayName("should mark each index once, across pages and concurrently")
+        void shouldMarkEachIndexOnce() throws InterruptedException {
+            Object[] objects = new Object[200_000];
+            for (int i = 0; i < objects.length; i++) objects[i] = new Object();
+            BitmapVisitedSet set = new BitmapVisitedSet(indexOver(objects));
+            int[] admitted = new int[4];
+            Thread[] threads = new Thread[admitted.length];
+            for (int t = 0; t < threads.length; t++) {
+                int id = t;
+                threads[t] = new Thread(() -> {
+                    for (Object o : objects) if (set.add(o)) admitted[id]++;
+                });
+                threads[t].start();
+            }
+            for (Thread thread : threads) thread.join();
+
+            assertThat(Arrays.stream(admitted).sum()).isEqualTo(objects.length);
+            assertThat(set.add(new Object())).isFalse();
+            assertThat(set.addRoot(new Object())).isTrue();
+            assertThat(set.addRoot(objects[123_456])).isFalse();
+        }
+
+        @Test
+        @DisplayName("should hand the parallel patcher a set opened for its workers")
+        void shouldOpenConcurrentSetForParallelPatcher() {
+            OldClass old = new OldClass(1);
+            NewClass replacement = new NewClass(1);
+            forwarding.put(old, replacement);
+            List<Integer> opened = new ArrayList<>();
+            patcher.setVisitedSets((expected, concurrency) -> {
+                opened.add(concurrency);
+                return VisitedSet.IDENTITY.open(expected, concurrency);
+            });
+            ContainerWithField holder = new ContainerWithField(old);
+
+            try (ParallelReferencePatcher parallel = new ParallelReferencePatcher(patcher, 3)) {
+                parallel.patchObjects(List.of(holder));
+            }
+
+            assertThat(holder.reference).isSameAs(replacement);
+            assertThat(opened).containsExactly(3);
+        }
+    }
+
+    @Nested
+    @DisplayName("type pruning")
+    class TypePruning {
+
+        static final class Money {
+            final String currency;
+            final long cents;
+            Money(String currency, long cents) { this.currency = currency; this.cents = cents; }
+        }
+
+        static class Address {
+            String street;
+            Money rent;
+        }
+
+        sealed interface Shape permits Circle, Square {}
+        record Circle(double radius) implements Shape {}
+        record Square(double side) implements Shape {}
+
+        static final class Holder {
+            Money money;
+            BigDecimal balance;
+            Address address;
+            Shape shape;
+            int[] counts;
+            Identifiable ref;
+            Object any;
+        }
+
+        static final class Wrapper {
+            Identifiable ref;
+        }
+
+        /** Patches {@code roots} as one batch, returning every object its visited set admitted. */
+        private List<Object> patchRecording(Object... roots) {
+            List<Object> admitted = new ArrayList<>();
+            patcher.setVisitedSets((expected, concurrency) -> new VisitedSet() {
+                final Set<Object> seen = Collections.newSetFromMap(new IdentityHashMap<>());
+                @Override public boolean add(Object o) {
+                    if (!seen.add(o)) return false;
+                    admitted.add(o);
+                    return true;
+                }
+            });
+            patcher.patchObjects(List.of(roots));
+            return admitted;
+        }
+
+        private Holder holder(OldClass old) {
+            Holder holder = new Holder();
+            holder.money = new Money("EUR", 1000);
+            holder.balance = BigDecimal.TEN;
+            holder.address = new Address();
+            holder.address.street = "Main";
+            holder.shape = new Circle(1);
+            holder.counts = new int[4];
+            holder.ref = old;
+            Wrapper wrapper = new Wrapper();
+            wrapper.ref = old;
+            holder.any = wrapper;
+            return holder;
+        }
+
+        @Test
+        @DisplayName("should skip fields and objects that cannot reach a migrated type")
+        void shouldSkipUnreachableTypes() {
+            OldClass old = new OldClass(1);
+            NewClass replacement = new NewClass(1);
+            forwarding.put(old, replacement);
+            patcher.setMigratedTypes(List.of(OldClass.class));
+            Holder holder = holder(old);
+            Wrapper wrapper = (Wrapper) holder.any;
+
+            List<Object> admitted = patchRecording(holder);
+
+            assertThat(holder.ref).isSameAs(replacement);
+            assertThat(wrapper.ref).isSameAs(replacement);
+            // money, shape and counts are never read; balance and address are read but not followed
+            assertThat(admitted).containsExactly(holder, wrapper);
+        }
+
+        @Test
+        @DisplayName("should traverse everything without migrated types")
+        void shouldTraverseEverythingByDefault() {
+            OldClass old = new OldClass(1);
+            forwarding.put(old, new NewClass(1));
+            Holder holder = holder(old);
+
+            List<Object> admitted = patchRecording(holder);
+
+            assertThat(patcher.getMigratedTypes()).isEmpty();
+            assertThat(admitted).contains(holder.money, holder.balance, holder.address, holder.shape, holder.counts,
+                    holder.any);
+        }
+
+        @Test
+        @DisplayName("should follow an open class only when its instance's own fields may reach")
+        void shouldJudgeObjectsByExactClass() {
+            OldClass old = new OldClass(1);
+            NewClass replacement = new NewClass(1);
+            forwarding.put(old, replacement);
+            patcher.setMigratedTypes(List.of(OldClass.class));
+            ContainerWithField reaching = new ContainerWithField(old);
+            Address inert = new Address();
+            Object[] array = { inert, reaching, "text" };
+            ContainerWithObjectField root = new ContainerWithObjectField(array);
+
+            List<Object> admitted = patchRecording(root);
+
+            assertThat(reaching.reference).isSameAs(replacement);
+            assertThat(admitted).containsExactlyInAnyOrder(root, array, reaching);
+        }
+
+        @Test
+        @DisplayName("should keep Object fields, interfaces and JDK containers conservative")
+        void shouldKeepOpenTypesConservative() {
+            OldClass old = new OldClass(1);
+            NewClass replacement = new NewClass(1);
+            forwarding.put(old, replacement);
+            patcher.setMigratedTypes(List.of(OldClass.class));
+            List<Object> list = new ArrayList<>(List.of("a", old));
+            Map<Object, Object> map = new HashMap<>(Map.of("k", list));
+            ContainerWithObjectField root = new ContainerWithObjectField(map);
+
+            patchRecording(root);
+
+            assertThat(list).containsExactly("a", replacement);
+        }
+
+        @Test
+        @DisplayName("should restore full traversal when the migrated types are cleared")
+        void shouldClearMigratedTypes() {
+            patcher.setMigratedTypes(List.of(OldClass.class));
+            assertThat(patcher.getMigratedTypes()).containsExactly(OldClass.class);
+
+            patcher.setMigratedTypes(null);
+
+            assertThat(patcher.getMigratedTypes()).isEmpty();
+            Address inert = new Address();
+            assertThat(patchRecording(inert)).containsExactly(inert);
+        }
+    }
+
+    @Nested
+    @DisplayName("referrer climbing")
+    class ReferrerClimbing {
+
+        @Test
+        @DisplayName("should climb exactly the non-anchor classes that can hold a reference")
+        void shouldClimbNonAnchorClasses() {
+            Map<String, Object> map = new HashMap<>();
+            map.put("k", new OldClass(1));
+            List<Object> climbed = List.of(new ArrayList<>(), new Object[0], map.entrySet().iterator().next(),
+                    new RecordHolder(null, "r"));
+            List<Object> anchors = List.of(new ContainerWithField(null), new ContainerWithArray(null),
+                    new OldClass[0], String.class);
+            List<Object> inert = List.of("text", 1, new int[0], new int[0][]);
+
+            for (Object holder : climbed) {
+                assertThat(patcher.isReferrerClimbed(holder.getClass())).as("%s", holder.getClass()).isTrue();
+                assertThat(patcher.isReferrerAnchor(holder)).as("%s", holder.getClass()).isFalse();
+            }
+            for (Object holder : anchors) {
+                assertThat(patcher.isReferrerClimbed(holder.getClass())).as("%s", holder.getClass()).isFalse();
+                assertThat(patcher.isReferrerAnchor(holder)).as("%s", holder.getClass()).isTrue();
+            }
+            for (Object holder : inert) {
+                assertThat(patcher.isReferrerClimbed(holder.getClass())).as("%s", holder.getClass()).isFalse();
+            }
+        }
+    }
+
     @Nested
     @DisplayName("edge cases")
     class EdgeCases {
@@ -0,0 +1,140 @@
+package migrator.engine;
+
+import migrator.config.HeapWalkMode;
+import migrator.config.MigrationConfig;
+import migrator.engine.ItemFixture.Holder;
+import migrator.engine.ItemFixture.NewItem;
+import migrator.engine.ItemFixture.OldItem;
+import migrator.heap.HeapReferenceKind;
+import migrator.heap.HeapWalker;
+import migrator.heap.ResidualReferences;
+import migrator.heap.RootPath;
+import migrator.metrics.MigrationMetrics;
+import migrator.state.MigrationState;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+
+import static migrator.engine.ItemFixture.injectHeapWalker;
+import static migrator.engine.ItemFixture.newEngine;
+import static org.assertj.core.api.Assertions.assertThat;
+
+/**
+ * Verifies the optional residual-reference check after patching: what the engine asks the walker
+ * to verify and exclude, how results reach the metrics, and that the check never fails a
+ * migration.
+ */
+@DisplayName("MigrationEngine — residual-reference verification")
+class ResidualVerificationTest {
+
+    /** A heap of one holder of one old item; records what the engine asked it to verify. */
+    static class VerifyingHeapWalker implements HeapWalker {
+        final OldItem old = new OldItem(1);
+        final Holder holder = new Holder(old);
+        final List<Object> verified = new ArrayList<>();
+        Collection<?> excluded;
+        int maxPaths = -1;
+
+        @Override public Object[] snapshotObjects(Class<?> targetClass) {
+            return targetClass == OldItem.class ? new Object[]{old} : new Object[0];
+        }
+
+        @Override public Set<Object> walkHeap() {
+            Set<Object> set = Collections.newSetFromMap(new IdentityHashMap<>());
+            set.add(holder);
+            return set;
+        }
+
+        @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+
+        @Override public ResidualReferences findResidualReferences(Collection<?> oldObjects, Collection<?> excluded,
+                                                                   int maxPaths) {
+            verified.addAll(oldObjects);
+            this.excluded = excluded;
+            this.maxPaths = maxPaths;
+            RootPath path = new RootPath(List.of(
+                    new RootPath.Step("app.Registry", true, HeapReferenceKind.SYSTEM_CLASS, -1, null),
+                    new RootPath.Step(OldItem.class.getTypeName(), false, HeapReferenceKind.STATIC_FIELD, 2, "cached")),
+                    false);
+            return new ResidualReferences(1, Map.of(HeapReferenceKind.STATIC_FIELD, 1L), List.of(path), true);
+        }
+    }
+
+    @BeforeEach
+    void reset() {
+        MigrationState.getInstance().reset();
+    }
+
+    @AfterEach
+    void cleanup() {
+        MigrationState.getInstance().reset();
+    }
+
+    @Test
+    @DisplayName("verifies the migrated old objects, excluding the engine's own bookkeeping, and records the result")
+    void verifiesAndRecords() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder()
+                .heapWalkMode(HeapWalkMode.FULL)
+                .walkChunkSize(0)
+                .verifyResiduals(true)
+                .residualPathSamples(5)
+                .build());
+        VerifyingHeapWalker fake = new VerifyingHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(fake.verified).containsExactly(fake.old);
+        assertThat(fake.maxPaths).isEqualTo(5);
+        assertThat(fake.excluded).isNotEmpty().noneMatch(o -> o == fake.old || o == fake.holder);
+        assertThat(fake.holder.item).isInstanceOf(NewItem.class);
+
+        MigrationMetrics metrics = MigrationEngine.getLastMetrics();
+        assertThat(metrics.hasResidualCheck()).isTrue();
+        assertThat(metrics.residualObjects()).isEqualTo(1);
+        assertThat(metrics.residualReferences()).isEqualTo(1);
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
+    }
+
+    @Test
+    @DisplayName("is off by default")
+    void offByDefault() throws Exception {
+        MigrationEngine engine = newEngine().setHeapWalkMode(HeapWalkMode.FULL);
+        VerifyingHeapWalker fake = new VerifyingHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(engine.isVerifyResiduals()).isFalse();
+        assertThat(fake.verified).isEmpty();
+        assertThat(MigrationEngine.getLastMetrics().hasResidualCheck()).isFalse();
+    }
+
+    @Test
+    @DisplayName("a walker that cannot verify leaves the migration successful and the check unreported")
+    void unsupportedWalkerIsSkipped() throws Exception {
+        MigrationEngine engine = newEngine().setHeapWalkMode(HeapWalkMode.FULL).setVerifyResiduals(true);
+        VerifyingHeapWalker fake = new VerifyingHeapWalker() {
+            @Override public ResidualReferences findResidualReferences(Collection<?> oldObjects,
+                                                                       Collection<?> excluded, int maxPaths) {
+                throw new IllegalStateException("no verifier");
+            }
+        };
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(fake.holder.item).isInstanceOf(NewItem.class);
+        assertThat(MigrationEngine.getLastMetrics().hasResidualCheck()).isFalse();
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
+    }
+}
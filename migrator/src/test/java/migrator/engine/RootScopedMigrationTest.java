@@ -0,0 +1,146 @@
+package migrator.engine;
+
+import migrator.config.MigrationConfig;
+import migrator.engine.ItemFixture.NewItem;
+import migrator.engine.ItemFixture.OldItem;
+import migrator.exceptions.MigrateException;
+import migrator.heap.HeapCensus;
+import migrator.heap.HeapWalker;
+import migrator.state.MigrationState;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+
+import static migrator.engine.ItemFixture.injectHeapWalker;
+import static migrator.engine.ItemFixture.newEngine;
+import static org.assertj.core.api.Assertions.assertThat;
+import static org.assertj.core.api.Assertions.assertThatThrownBy;
+
+/**
+ * Verifies root-scoped migration: the snapshots and the second pass go through the walker's
+ * root-scoped walks, so only the tenant under the given root is migrated and patched, and the
+ * heap-wide census is skipped.
+ */
+@DisplayName("MigrationEngine — root-scoped migration")
+class RootScopedMigrationTest {
+
+    /** One tenant's state: its items, reachable from the tenant object. */
+    static final class Tenant {
+        final Object[] items;
+        Tenant(Object... items) { this.items = items; }
+    }
+
+    /** Two tenants; the root-scoped walks see only the tenant passed as the root. */
+    static final class TenantHeapWalker implements HeapWalker {
+        final Tenant a = new Tenant(new OldItem(1), new OldItem(2));
+        final Tenant b = new Tenant(new OldItem(3));
+        final List<Collection<?>> scopedSnapshots = new ArrayList<>();
+        final List<Collection<?>> scopedWalks = new ArrayList<>();
+        int heapSnapshots = 0;
+        int censusCalls = 0;
+
+        @Override public Object[] snapshotObjects(Class<?> targetClass) {
+            heapSnapshots++;
+            return new Object[0];
+        }
+
+        @Override public Set<Object> walkHeap() { return Collections.emptySet(); }
+        @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+
+        @Override public HeapCensus census(Collection<Class<?>> classes) {
+            censusCalls++;
+            return HeapCensus.EMPTY;
+        }
+
+        @Override public Map<Class<?>, Object[]> snapshotReachableFrom(Collection<?> roots, Collection<Class<?>> classes) {
+            scopedSnapshots.add(List.copyOf(roots));
+            List<Object> items = new ArrayList<>();
+            for (Object root : roots) Collections.addAll(items, ((Tenant) root).items);
+            return Map.of(OldItem.class, items.toArray());
+        }
+
+        @Override public Set<Object> walkReachableFrom(Collection<?> roots, Collection<Class<?>> leafClasses) {
+            scopedWalks.add(List.copyOf(roots));
+            Set<Object> reached = Collections.newSetFromMap(new IdentityHashMap<>());
+            for (Object root : roots) {
+                reached.add(root);
+                reached.add(((Tenant) root).items);
+            }
+            return reached;
+        }
+    }
+
+    @BeforeEach
+    void reset() {
+        MigrationState.getInstance().reset();
+    }
+
+    @AfterEach
+    void cleanup() {
+        MigrationState.getInstance().reset();
+    }
+
+    @Test
+    @DisplayName("migrates and patches only the tenant under the root")
+    void migratesOneTenant() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder().heapCensus(true).build());
+        TenantHeapWalker fake = new TenantHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrateReachableFrom(List.of(fake.a), Set.<Class<?>>of(), null, null);
+
+        assertThat(fake.scopedSnapshots).isNotEmpty().allSatisfy(r -> assertThat(r).containsExactly(fake.a));
+        assertThat(fake.scopedWalks).hasSize(1);
+        assertThat(fake.heapSnapshots).isZero();
+        assertThat(fake.censusCalls).isZero();
+        assertThat(fake.a.items).hasSize(2).allSatisfy(item -> assertThat(item).isInstanceOf(NewItem.class));
+        assertThat(fake.b.items).allSatisfy(item -> assertThat(item).isInstanceOf(OldItem.class));
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
+    }
+
+    @Test
+    @DisplayName("leaves the next whole-heap migration unscoped")
+    void scopeEndsWithTheMigration() throws Exception {
+        MigrationEngine engine = newEngine();
+        TenantHeapWalker fake = new TenantHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrateReachableFrom(List.of(fake.a), Set.<Class<?>>of(), null, null);
+        MigrationState.getInstance().reset();
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(fake.scopedWalks).hasSize(1);
+        assertThat(fake.heapSnapshots).isPositive();
+    }
+
+    @Test
+    @DisplayName("rejects empty roots, and fails on a walker without root-scoped walks")
+    void rejectsUnsupported() throws Exception {
+        MigrationEngine engine = newEngine();
+        injectHeapWalker(engine, new TenantHeapWalker());
+
+        assertThatThrownBy(() -> engine.migrateReachableFrom(Collections.singletonList(null), Set.of(), null, null))
+                .isInstanceOf(IllegalArgumentException.class);
+
+        MigrationEngine plainEngine = newEngine();
+        injectHeapWalker(plainEngine, new HeapWalker() {
+            @Override public Object[] snapshotObjects(Class<?> c) { return new Object[0]; }
+            @Override public Set<Object> walkHeap() { return Collections.emptySet(); }
+            @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+        });
+
+        assertThatThrownBy(() -> plainEngine.migrateReachableFrom(List.of(new Tenant()), Set.of(), null, null))
+                .isInstanceOf(MigrateException.class)
+                .hasMessageContaining("root-scoped");
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.FAILED);
+    }
+}
@@ -0,0 +1,198 @@
+package migrator.engine;
+
+import migrator.config.HeapWalkMode;
+import migrator.config.MigrationConfig;
+import migrator.engine.ItemFixture.Holder;
+import migrator.engine.ItemFixture.NewItem;
+import migrator.engine.ItemFixture.OldItem;
+import migrator.exceptions.MigrateException;
+import migrator.heap.HeapWalker;
+import migrator.heap.StackLocalPatchResult;
+import migrator.metrics.MigrationMetrics;
+import migrator.quiesce.SuspendResult;
+import migrator.quiesce.ThreadSuspender;
+import migrator.state.MigrationState;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.Collection;
+import java.util.Collections;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Set;
+import java.util.concurrent.CountDownLatch;
+
+import static migrator.engine.ItemFixture.inject;
+import static migrator.engine.ItemFixture.newEngine;
+import static org.assertj.core.api.Assertions.assertThat;
+
+/**
+ * Verifies the engine's stack-local pass: it runs only while the application threads are
+ * suspended, is handed the suspended threads with each old object paired to its replacement, its
+ * counts reach the metrics, and a walker that cannot patch locals does not fail the migration.
+ */
+@DisplayName("MigrationEngine — stack-local patching")
+class StackLocalPatchTest {
+
+    /** A heap of one holder of one old item; records the stack-local patch request it receives. */
+    static class RecordingHeapWalker implements HeapWalker {
+        final OldItem old = new OldItem(1);
+        final Holder holder = new Holder(old);
+        FakeSuspender suspender;
+        Collection<Thread> patchedThreads;
+        Object[] patchedOld;
+        Object[] patchedNew;
+        boolean patchedWhileSuspended;
+
+        @Override public Object[] snapshotObjects(Class<?> targetClass) {
+            return targetClass == OldItem.class ? new Object[]{old} : new Object[0];
+        }
+
+        @Override public Set<Object> walkHeap() {
+            Set<Object> set = Collections.newSetFromMap(new IdentityHashMap<>());
+            set.add(holder);
+            return set;
+        }
+
+        @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+
+        @Override public StackLocalPatchResult patchStackLocals(Collection<Thread> threads,
+                                                                Object[] oldObjects, Object[] newObjects) {
+            patchedWhileSuspended = suspender.suspended != null;
+            patchedThreads = threads;
+            patchedOld = oldObjects;
+            patchedNew = newObjects;
+            return new StackLocalPatchResult(3, 2, 1, List.of(new StackLocalPatchResult.UnpatchedLocal(
+                    threads.iterator().next(), "app.Handler.handle", 1, 2, 17,
+                    StackLocalPatchResult.Reason.NO_LOCAL_TYPES)));
+        }
+    }
+
+    /** Pretends to suspend every thread it is given. */
+    static final class FakeSuspender implements ThreadSuspender {
+        volatile Collection<Thread> suspended;
+
+        @Override public SuspendResult suspend(Collection<Thread> threads) {
+            suspended = threads;
+            return new SuspendResult(threads, 0, 1_000);
+        }
+
+        @Override public SuspendResult resume(Collection<Thread> threads) {
+            suspended = null;
+            return new SuspendResult(threads, 0, 2_000);
+        }
+    }
+
+    private final CountDownLatch release = new CountDownLatch(1);
+    private Thread appThread;
+
+    @BeforeEach
+    void reset() {
+        MigrationState.getInstance().reset();
+        appThread = new Thread(() -> {
+            try {
+                release.await();
+            } catch (InterruptedException ignored) {
+                Thread.currentThread().interrupt();
+            }
+        }, "stack-locals-test-app");
+        appThread.setDaemon(true);
+        appThread.start();
+    }
+
+    @AfterEach
+    void cleanup() throws InterruptedException {
+        release.countDown();
+        appThread.join(5_000);
+        MigrationState.getInstance().reset();
+    }
+
+    @Test
+    @DisplayName("patches the locals of the suspended threads, pairing each old object with its replacement")
+    void patchesSuspendedThreads() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder()
+                .heapWalkMode(HeapWalkMode.FULL)
+                .walkChunkSize(0)
+                .quiesceBySuspension(true)
+                .patchStackLocals(true)
+                .build());
+        RecordingHeapWalker walker = newWalker(engine);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(engine.isPatchStackLocals()).isTrue();
+        assertThat(walker.patchedWhileSuspended).isTrue();
+        assertThat(walker.patchedThreads).contains(appThread).doesNotContain(Thread.currentThread());
+        assertThat(walker.patchedOld).containsExactly(walker.old);
+        assertThat(walker.patchedNew).hasSize(1);
+        assertThat(walker.patchedNew[0]).isInstanceOf(NewItem.class).isSameAs(walker.holder.item);
+
+        MigrationMetrics metrics = MigrationEngine.getLastMetrics();
+        assertThat(metrics.hasStackLocalPatch()).isTrue();
+        assertThat(metrics.stackLocalsFound()).isEqualTo(3);
+        assertThat(metrics.stackLocalsRewritten()).isEqualTo(2);
+        assertThat(metrics.phaseDurations()).containsKey(MigrationMetrics.Phase.STACK_LOCALS);
+    }
+
+    @Test
+    @DisplayName("is skipped when the threads are not suspended")
+    void skippedWithoutSuspension() throws Exception {
+        MigrationEngine engine = newEngine().setHeapWalkMode(HeapWalkMode.FULL).setPatchStackLocals(true);
+        RecordingHeapWalker walker = newWalker(engine);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(walker.patchedThreads).isNull();
+        assertThat(walker.holder.item).isInstanceOf(NewItem.class);
+        assertThat(MigrationEngine.getLastMetrics().hasStackLocalPatch()).isFalse();
+    }
+
+    @Test
+    @DisplayName("a walker that cannot patch locals does not fail the migration")
+    void unsupportedTolerated() throws Exception {
+        MigrationEngine engine = newEngine()
+                .setHeapWalkMode(HeapWalkMode.FULL)
+                .setQuiesceBySuspension(true)
+                .setPatchStackLocals(true);
+        RecordingHeapWalker walker = new RecordingHeapWalker() {
+            @Override public StackLocalPatchResult patchStackLocals(Collection<Thread> threads,
+                                                                    Object[] oldObjects, Object[] newObjects)
+                    throws MigrateException {
+                throw new MigrateException("no local access");
+            }
+        };
+        FakeSuspender suspender = new FakeSuspender();
+        walker.suspender = suspender;
+        inject(engine, "heapWalker", walker);
+        inject(engine, "threadSuspender", suspender);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(walker.holder.item).isInstanceOf(NewItem.class);
+        assertThat(MigrationEngine.getLastMetrics().hasStackLocalPatch()).isFalse();
+        assertThat(MigrationEngine.getLastMetrics().hasSuspension()).isTrue();
+    }
+
+    @Test
+    @DisplayName("is off by default")
+    void offByDefault() throws Exception {
+        MigrationEngine engine = newEngine().setHeapWalkMode(HeapWalkMode.FULL).setQuiesceBySuspension(true);
+        RecordingHeapWalker walker = newWalker(engine);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(engine.isPatchStackLocals()).isFalse();
+        assertThat(walker.patchedThreads).isNull();
+    }
+
+    private static RecordingHeapWalker newWalker(MigrationEngine engine) throws Exception {
+        FakeSuspender suspender = new FakeSuspender();
+        RecordingHeapWalker walker = new RecordingHeapWalker();
+        walker.suspender = suspender;
+        inject(engine, "heapWalker", walker);
+        inject(engine, "threadSuspender", suspender);
+        return walker;
+    }
+}
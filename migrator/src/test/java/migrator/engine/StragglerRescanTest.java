@@ -17,7 +17,9 @@ import org.junit.jupiter.api.Test;
 import java.lang.reflect.Field;
 import java.util.Collection;
 import java.util.Collections;
+import java.util.LinkedHashMap;
 import java.util.List;
+import java.util.Map;
 import java.util.Set;
 import java.util.concurrent.atomic.AtomicInteger;
 
@@ -114,6 +116,46 @@ class StragglerRescanTest {
         assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
     }
 
+    /** Counts batch snapshots; never expects a per-class snapshot. */
+    static final class BatchHeapWalker implements HeapWalker {
+        final StragglerHeapWalker delegate = new StragglerHeapWalker();
+        int batchCalls = 0;
+
+        @Override public Object[] snapshotObjects(Class<?> targetClass) {
+            throw new AssertionError("per-class snapshot used instead of snapshotPartitioned");
+        }
+
+        @Override public Map<Class<?>, Object[]> snapshotPartitioned(Collection<Class<?>> classes) {
+            batchCalls++;
+            Map<Class<?>, Object[]> result = new LinkedHashMap<>();
+            for (Class<?> c : classes) result.put(c, delegate.snapshotObjects(c));
+            return result;
+        }
+
+        @Override public Set<Object> walkHeap() { return Collections.emptySet(); }
+        @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+    }
+
+    @Test
+    @DisplayName("the first pass and the rescan each take one batch snapshot of all source classes")
+    void firstPassAndRescanUseOneBatchSnapshotEach() throws Exception {
+        MigrationEngine engine = new MigrationEngine(
+                AccountMigrator.class,
+                NoopPhaseListener.INSTANCE,
+                new SmokeTestRunner.Builder().build(),
+                new CommitManager(NoopCracController.INSTANCE),
+                new RollbackManager(NoopCracController.INSTANCE));
+
+        BatchHeapWalker fake = new BatchHeapWalker();
+        injectHeapWalker(engine, fake);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(fake.batchCalls).isEqualTo(2);
+        assertThat(migrateCalls.get()).isEqualTo(3);
+        assertThat(MigrationState.getInstance().getStatus()).isEqualTo(MigrationState.Status.SUCCESS);
+    }
+
     private static void injectHeapWalker(MigrationEngine engine, HeapWalker walker) throws Exception {
         Field f = MigrationEngine.class.getDeclaredField("heapWalker");
         f.setAccessible(true);
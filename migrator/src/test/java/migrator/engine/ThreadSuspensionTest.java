@@ -0,0 +1,188 @@
+package migrator.engine;
+
+import migrator.config.HeapWalkMode;
+import migrator.config.MigrationConfig;
+import migrator.engine.ItemFixture.Holder;
+import migrator.engine.ItemFixture.NewItem;
+import migrator.engine.ItemFixture.OldItem;
+import migrator.exceptions.MigrateException;
+import migrator.heap.HeapWalker;
+import migrator.metrics.MigrationMetrics;
+import migrator.quiesce.SuspendResult;
+import migrator.quiesce.ThreadSuspender;
+import migrator.state.MigrationState;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Set;
+import java.util.concurrent.CountDownLatch;
+
+import static migrator.engine.ItemFixture.inject;
+import static migrator.engine.ItemFixture.newEngine;
+import static org.assertj.core.api.Assertions.assertThat;
+import static org.assertj.core.api.Assertions.assertThatThrownBy;
+
+/**
+ * Verifies engine-managed quiescence: the application threads are suspended while references are
+ * patched, resumed before {@code onAfterCriticalPhase} on success and on failure, and the pause
+ * is reported in the metrics.
+ */
+@DisplayName("MigrationEngine — quiescence by thread suspension")
+class ThreadSuspensionTest {
+
+    /** A heap of one holder of one old item; records whether threads were suspended while it was walked. */
+    static class OneHolderHeapWalker implements HeapWalker {
+        final OldItem old = new OldItem(1);
+        final Holder holder = new Holder(old);
+        FakeSuspender suspender;
+        boolean walkedWhileSuspended;
+
+        @Override public Object[] snapshotObjects(Class<?> targetClass) {
+            return targetClass == OldItem.class ? new Object[]{old} : new Object[0];
+        }
+
+        @Override public Set<Object> walkHeap() {
+            walkedWhileSuspended = suspender.suspended != null;
+            Set<Object> set = Collections.newSetFromMap(new IdentityHashMap<>());
+            set.add(holder);
+            return set;
+        }
+
+        @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+    }
+
+    /** Pretends to suspend every thread it is given; records what it suspended and resumed. */
+    static final class FakeSuspender implements ThreadSuspender {
+        volatile Collection<Thread> suspended;
+        final List<Collection<Thread>> resumed = new ArrayList<>();
+
+        @Override public SuspendResult suspend(Collection<Thread> threads) {
+            suspended = threads;
+            return new SuspendResult(threads, 0, 1_000);
+        }
+
+        @Override public synchronized SuspendResult resume(Collection<Thread> threads) {
+            resumed.add(threads);
+            suspended = null;
+            return new SuspendResult(threads, 0, 2_000);
+        }
+    }
+
+    private final CountDownLatch release = new CountDownLatch(1);
+    private Thread appThread;
+
+    @BeforeEach
+    void reset() {
+        MigrationState.getInstance().reset();
+        appThread = new Thread(() -> {
+            try {
+                release.await();
+            } catch (InterruptedException ignored) {
+                Thread.currentThread().interrupt();
+            }
+        }, "suspension-test-app");
+        appThread.setDaemon(true);
+        appThread.start();
+    }
+
+    @AfterEach
+    void cleanup() throws InterruptedException {
+        release.countDown();
+        appThread.join(5_000);
+        MigrationState.getInstance().reset();
+    }
+
+    @Test
+    @DisplayName("suspends the application threads for the critical phase and reports the pause")
+    void suspendsDuringCriticalPhase() throws Exception {
+        MigrationEngine engine = newEngine().applyConfig(MigrationConfig.builder()
+                .heapWalkMode(HeapWalkMode.FULL)
+                .walkChunkSize(0)
+                .quiesceBySuspension(true)
+                .build());
+        FakeSuspender suspender = new FakeSuspender();
+        OneHolderHeapWalker walker = new OneHolderHeapWalker();
+        walker.suspender = suspender;
+        inject(engine, "heapWalker", walker);
+        inject(engine, "threadSuspender", suspender);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(walker.walkedWhileSuspended).isTrue();
+        assertThat(walker.holder.item).isInstanceOf(NewItem.class);
+        assertThat(suspender.resumed).hasSize(1);
+        assertThat(suspender.resumed.get(0)).contains(appThread).doesNotContain(Thread.currentThread());
+        assertThat(suspender.suspended).isNull();
+
+        MigrationMetrics metrics = MigrationEngine.getLastMetrics();
+        assertThat(metrics.hasSuspension()).isTrue();
+        assertThat(metrics.suspension().threads()).isEqualTo(suspender.resumed.get(0).size());
+        assertThat(metrics.suspension().suspendNanos()).isEqualTo(1_000);
+        assertThat(metrics.suspension().resumeNanos()).isEqualTo(2_000);
+        assertThat(metrics.suspension().pausedNanos()).isPositive();
+    }
+
+    @Test
+    @DisplayName("leaves allowlisted threads running")
+    void allowlist() throws Exception {
+        MigrationEngine engine = newEngine()
+                .setHeapWalkMode(HeapWalkMode.FULL)
+                .setQuiesceBySuspension(true)
+                .setSuspendAllowlist(List.of("suspension-test-*"));
+        FakeSuspender suspender = new FakeSuspender();
+        OneHolderHeapWalker walker = new OneHolderHeapWalker();
+        walker.suspender = suspender;
+        inject(engine, "heapWalker", walker);
+        inject(engine, "threadSuspender", suspender);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(suspender.resumed).hasSize(1);
+        assertThat(suspender.resumed.get(0)).doesNotContain(appThread);
+    }
+
+    @Test
+    @DisplayName("resumes the threads when the critical phase fails")
+    void resumesOnFailure() throws Exception {
+        MigrationEngine engine = newEngine().setHeapWalkMode(HeapWalkMode.FULL).setQuiesceBySuspension(true);
+        FakeSuspender suspender = new FakeSuspender();
+        OneHolderHeapWalker walker = new OneHolderHeapWalker() {
+            @Override public Set<Object> walkHeap() {
+                throw new IllegalStateException("walk failed");
+            }
+        };
+        inject(engine, "heapWalker", walker);
+        inject(engine, "threadSuspender", suspender);
+
+        assertThatThrownBy(() -> engine.migrate(Set.<Class<?>>of(), null, null))
+                .isInstanceOf(MigrateException.class);
+
+        assertThat(suspender.resumed).hasSize(1);
+        assertThat(suspender.suspended).isNull();
+    }
+
+    @Test
+    @DisplayName("is off by default")
+    void offByDefault() throws Exception {
+        MigrationEngine engine = newEngine().setHeapWalkMode(HeapWalkMode.FULL);
+        FakeSuspender suspender = new FakeSuspender();
+        OneHolderHeapWalker walker = new OneHolderHeapWalker();
+        walker.suspender = suspender;
+        inject(engine, "heapWalker", walker);
+        inject(engine, "threadSuspender", suspender);
+
+        engine.migrate(Set.<Class<?>>of(), null, null);
+
+        assertThat(engine.isQuiesceBySuspension()).isFalse();
+        assertThat(walker.walkedWhileSuspended).isFalse();
+        assertThat(suspender.resumed).isEmpty();
+        assertThat(MigrationEngine.getLastMetrics().hasSuspension()).isFalse();
+    }
+}
@@ -1,11 +1,17 @@
 package migrator.engine;
 
 import migrator.exceptions.MigrationTimeoutException;
+import migrator.heap.HeapWalker;
+import migrator.heap.WalkProgress;
+import migrator.state.MigrationState;
 import org.junit.jupiter.api.DisplayName;
 import org.junit.jupiter.api.Nested;
 import org.junit.jupiter.api.Test;
 
 import java.time.Duration;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.Set;
 import java.util.concurrent.CountDownLatch;
 import java.util.concurrent.TimeUnit;
 import java.util.concurrent.atomic.AtomicBoolean;
@@ -330,4 +336,91 @@ class TimeoutExecutorTest {
             assertThat(timeoutCount.get()).isEqualTo(5);
         }
     }
+
+    /**
+     * A walker whose "walk" ignores interrupts, like a native walk inside its VM operation, and
+     * stops only when {@link #cancelWalks()} is called.
+     */
+    static final class StubbornWalker implements HeapWalker {
+        final AtomicBoolean cancelRequested = new AtomicBoolean();
+        final CountDownLatch walkEnded = new CountDownLatch(1);
+        final AtomicInteger visited = new AtomicInteger();
+
+        Object walk() {
+            try {
+                while (!cancelRequested.get()) {
+                    visited.incrementAndGet();
+                    Thread.onSpinWait();
+                }
+                return null;
+            } finally {
+                walkEnded.countDown();
+            }
+        }
+
+        @Override public WalkProgress walkProgress() {
+            return new WalkProgress(1, visited.get(), 0, walkEnded.getCount() > 0, cancelRequested.get());
+        }
+        @Override public void cancelWalks() { cancelRequested.set(true); }
+
+        @Override public Object[] snapshotObjects(Class<?> targetClass) { return new Object[0]; }
+        @Override public Set<Object> walkHeap() { return Collections.emptySet(); }
+        @Override public Set<Object> walkHeap(Collection<Class<?>> classes) { return Collections.emptySet(); }
+    }
+
+    @Nested
+    @DisplayName("executeWalkWithTimeout")
+    class ExecuteWalkWithTimeout {
+
+        @Test
+        @DisplayName("cancels a walk that ignores interrupts when it times out")
+        void cancelsWalkOnTimeout() throws InterruptedException {
+            StubbornWalker walker = new StubbornWalker();
+
+            assertThatThrownBy(() -> TimeoutExecutor.executeWalkWithTimeout(
+                    "heapWalkFull", Duration.ofMillis(50), walker, walker::walk))
+                    .isInstanceOf(MigrationTimeoutException.class)
+                    .hasMessageContaining("heapWalkFull");
+
+            assertThat(walker.cancelRequested).isTrue();
+            assertThat(walker.walkEnded.await(5, TimeUnit.SECONDS)).isTrue();
+        }
+
+        @Test
+        @DisplayName("publishes the walk's live progress to MigrationState while it runs")
+        void publishesProgressWhileRunning() throws Exception {
+            MigrationState state = MigrationState.getInstance();
+            state.reset();
+            StubbornWalker walker = new StubbornWalker();
+            AtomicBoolean sawProgress = new AtomicBoolean();
+
+            try {
+                TimeoutExecutor.executeWalkWithTimeout("heapWalkFiltered", Duration.ofSeconds(5), walker, () -> {
+                    walker.visited.set(1000);
+                    sawProgress.set("heapWalkFiltered".equals(state.getCurrentWalk())
+                            && state.getWalkProgress().visited() == 1000
+                            && state.getWalkProgress().active());
+                    return "done";
+                });
+
+                assertThat(sawProgress).isTrue();
+                assertThat(state.getCurrentWalk()).isNull();
+                assertThat(state.getWalkProgress()).isEqualTo(WalkProgress.NONE);
+            } finally {
+                state.reset();
+            }
+        }
+
+        @Test
+        @DisplayName("does not cancel a walk that completes in time")
+        void completesWithoutCancel() throws Exception {
+            StubbornWalker walker = new StubbornWalker();
+
+            String result = TimeoutExecutor.executeWalkWithTimeout(
+                    "heapSnapshot", Duration.ofSeconds(5), walker, () -> "done");
+
+            assertThat(result).isEqualTo("done");
+            assertThat(walker.cancelRequested).isFalse();
+        }
+    }
 }
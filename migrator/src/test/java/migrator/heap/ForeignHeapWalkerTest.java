@@ -0,0 +1,114 @@
+package migrator.heap;
+
+import org.junit.jupiter.api.BeforeAll;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import migrator.exceptions.MigrateException;
+
+import static org.assertj.core.api.Assertions.assertThat;
+import static org.assertj.core.api.Assertions.assertThatThrownBy;
+import static org.junit.jupiter.api.Assumptions.assumeTrue;
+
+/**
+ * Runs {@link ForeignHeapWalker} against the real native agent self-attached into the test JVM
+ * (see {@link NativeAgentSupport}): every value read through the foreign binding matches the one
+ * read through JNI, since both read the same agent state, and object results still come back
+ * through JNI. When the binding is not available (JDK 21, or built without it) only the
+ * unavailable path is checked. Skips when the agent cannot be loaded.
+ */
+@DisplayName("ForeignHeapWalker — java.lang.foreign binding of the agent statistics")
+class ForeignHeapWalkerTest {
+
+    private final NativeHeapWalker jni = new NativeHeapWalker();
+    private final List<Object> keepAlive = new ArrayList<>();
+
+    @BeforeAll
+    static void loadAgent() {
+        NativeAgentSupport.ensureLoaded();
+    }
+
+    @BeforeEach
+    void requireAgent() {
+        assumeTrue(NativeAgentSupport.ensureLoaded(),
+                () -> "native agent not loaded, skipping: " + NativeAgentSupport.skipReason());
+    }
+
+    static final class ForeignTarget { final int x; ForeignTarget(int x) { this.x = x; } }
+
+    @Test
+    @DisplayName("create() fails with the reason when the binding is unavailable")
+    void unavailable() {
+        assumeTrue(!ForeignHeapWalker.isSupported(), "foreign binding available");
+
+        assertThat(ForeignHeapWalker.unsupportedReason()).isNotBlank();
+        assertThatThrownBy(ForeignHeapWalker::create)
+                .isInstanceOf(MigrateException.class)
+                .hasMessageContaining(ForeignHeapWalker.unsupportedReason());
+        if (Runtime.version().feature() < 22) {
+            assertThat(ForeignHeapWalker.unsupportedReason()).contains("JDK 22");
+        }
+    }
+
+    @Test
+    @DisplayName("walk progress and operation times read through the binding match JNI")
+    void statisticsMatchJni() throws MigrateException {
+        ForeignHeapWalker foreign = supported();
+        keepAlive.add(new ForeignTarget(1));
+
+        Object[] snap = foreign.snapshotObjects(ForeignTarget.class);
+
+        assertThat(snap).hasSize(1);
+        WalkProgress progress = foreign.walkProgress();
+        assertThat(progress).isEqualTo(jni.walkProgress());
+        assertThat(progress.active()).isFalse();
+        assertThat(progress.walkId()).isPositive();
+        HeapOpTimes times = foreign.opTimes();
+        assertThat(times).isEqualTo(jni.opTimes());
+        assertThat(times.tagCalls()).isPositive();
+    }
+
+    @Test
+    @DisplayName("reclamation counters read through the binding match JNI")
+    void reclamationMatchesJni() throws MigrateException {
+        ForeignHeapWalker foreign = supported();
+        ForeignTarget tracked = new ForeignTarget(2);
+        keepAlive.add(tracked);
+
+        assertThat(foreign.startReclamationTracking(List.of(tracked))).isTrue();
+        try {
+            ReclamationProgress viaForeign = foreign.reclamationProgress();
+            ReclamationProgress viaJni = jni.reclamationProgress();
+            assertThat(viaForeign.trackerId()).isEqualTo(viaJni.trackerId()).isPositive();
+            assertThat(viaForeign.tracked()).isEqualTo(viaJni.tracked()).isEqualTo(1);
+            assertThat(viaForeign.reclaimed()).isEqualTo(viaJni.reclaimed());
+        } finally {
+            foreign.stopReclamationTracking();
+        }
+    }
+
+    @Test
+    @DisplayName("epoch, cancellation and tag diagnostics go through the binding")
+    void diagnosticsAndEpoch() throws MigrateException {
+        ForeignHeapWalker foreign = supported();
+        keepAlive.add(new ForeignTarget(3));
+
+        // A cancellation affects only walks already started: the next walk runs to completion.
+        foreign.cancelWalks();
+        foreign.advanceEpoch();
+        assertThat(foreign.snapshotObjects(ForeignTarget.class)).hasSize(1);
+
+        assertThat(foreign.openWalkEnvironments()).isZero().isEqualTo(NativeHeapWalker.openWalkEnvironments());
+        assertThat(foreign.retainedTagCount()).isEqualTo(NativeHeapWalker.retainedTagCount());
+    }
+
+    private static ForeignHeapWalker supported() throws MigrateException {
+        assumeTrue(ForeignHeapWalker.isSupported(),
+                () -> "foreign binding unavailable, skipping: " + ForeignHeapWalker.unsupportedReason());
+        return ForeignHeapWalker.create();
+    }
+}
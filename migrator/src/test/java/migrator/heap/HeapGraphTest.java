@@ -0,0 +1,182 @@
+package migrator.heap;
+
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.io.TempDir;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+import static org.assertj.core.api.Assertions.assertThat;
+import static org.assertj.core.api.Assertions.assertThatThrownBy;
+
+/**
+ * Reads hand-built graph files in the agent's format (see "Reference-graph export" in agent.c),
+ * so the queries are checked against known counts without the native agent.
+ *
+ * <p>The graph: classes {@code OldUser} (source), {@code Session}, {@code Cache} and
+ * {@code [Ljava.lang.Object;}; two OldUser instances, one referenced by a Session field, the
+ * other by an Object[] element and by a stack root; a static field of Cache referencing the
+ * Session.
+ */
+@DisplayName("HeapGraph — offline queries over a memory-mapped reference graph")
+class HeapGraphTest {
+
+    @TempDir
+    Path tempDir;
+
+    private static final int OLD_USER = 0, SESSION = 1, CACHE = 2, OBJECT_ARRAY = 3;
+
+    /** Objects 0-3 are the class mirrors; then the instances. */
+    private static final int USER_A = 4, USER_B = 5, SESSION_1 = 6, ARRAY_1 = 7;
+
+    @Test
+    @DisplayName("header counts, class names and the object table read back")
+    void tables() throws IOException {
+        try (HeapGraph graph = HeapGraph.open(write(ByteOrder.LITTLE_ENDIAN, false))) {
+            assertThat(graph.classCount()).isEqualTo(4);
+            assertThat(graph.objectCount()).isEqualTo(8);
+            assertThat(graph.referenceCount()).isEqualTo(6);
+            assertThat(graph.className(OLD_USER)).isEqualTo("app.OldUser");
+            assertThat(graph.className(OBJECT_ARRAY)).isEqualTo("[Ljava.lang.Object;");
+            assertThat(graph.classIds("app.Session")).containsExactly(SESSION);
+            assertThat(graph.classIds("app.Missing")).isEmpty();
+            assertThat(graph.sourceClassNames()).containsExactly("app.OldUser");
+            assertThat(graph.objectClass(SESSION_1)).isEqualTo(SESSION);
+            assertThat(graph.objectSize(ARRAY_1)).isEqualTo(40);
+        }
+    }
+
+    @Test
+    @DisplayName("referrersOf counts references by referring class and root kind")
+    void referrers() throws IOException {
+        try (HeapGraph graph = HeapGraph.open(write(ByteOrder.LITTLE_ENDIAN, false))) {
+            HeapGraph.Referrers r = graph.referrersOf("app.OldUser");
+
+            assertThat(r.instances()).isEqualTo(2);
+            assertThat(r.references()).isEqualTo(3);
+            assertThat(r.byClass()).containsOnlyKeys("app.Session", "[Ljava.lang.Object;");
+            assertThat(r.roots()).containsEntry(HeapReferenceKind.STACK_LOCAL, 1L).hasSize(1);
+
+            HeapGraph.Referrers session = graph.referrersOf("app.Session");
+            assertThat(session.byClass()).containsEntry("app.Cache", 1L);
+            assertThatThrownBy(() -> graph.referrersOf("app.Missing")).isInstanceOf(IllegalArgumentException.class);
+        }
+    }
+
+    @Test
+    @DisplayName("classesToPatch lists the classes holding field or element references to source instances")
+    void classesToPatch() throws IOException {
+        try (HeapGraph graph = HeapGraph.open(write(ByteOrder.LITTLE_ENDIAN, false))) {
+            assertThat(graph.classesToPatch(null)).containsExactlyInAnyOrder("app.Session", "[Ljava.lang.Object;");
+            assertThat(graph.classesToPatch(List.of("app.Session"))).containsExactly("app.Cache");
+        }
+    }
+
+    @Test
+    @DisplayName("specCost counts the walked objects and the holders the SPEC classes miss")
+    void specCost() throws IOException {
+        try (HeapGraph graph = HeapGraph.open(write(ByteOrder.LITTLE_ENDIAN, false))) {
+            HeapGraph.SpecCost cost = graph.specCost(List.of("app.Session"), null);
+
+            assertThat(cost.objectsWalked()).isEqualTo(1);
+            assertThat(cost.bytesWalked()).isEqualTo(24);
+            assertThat(cost.holders()).isEqualTo(2);
+            assertThat(cost.holdersMissed()).isEqualTo(1);
+            assertThat(cost.heapObjects()).isEqualTo(8);
+            assertThat(cost.walkedFraction()).isEqualTo(1.0 / 8);
+
+            HeapGraph.SpecCost covering = graph.specCost(List.of("app.Session", "[Ljava.lang.Object;"), null);
+            assertThat(covering.holdersMissed()).isZero();
+        }
+    }
+
+    @Test
+    @DisplayName("a file written in big-endian order reads the same")
+    void bigEndian() throws IOException {
+        try (HeapGraph graph = HeapGraph.open(write(ByteOrder.BIG_ENDIAN, true))) {
+            assertThat(graph.sourceEdgesOnly()).isTrue();
+            assertThat(graph.referrersOf("app.OldUser").references()).isEqualTo(3);
+        }
+    }
+
+    @Test
+    @DisplayName("an incomplete or truncated file is rejected")
+    void rejectsIncomplete() throws IOException {
+        Path file = write(ByteOrder.LITTLE_ENDIAN, false);
+        byte[] bytes = Files.readAllBytes(file);
+
+        Path noHeader = tempDir.resolve("no-header.graph");
+        byte[] zeroed = bytes.clone();
+        Arrays.fill(zeroed, 0, HeapGraph.HEADER_SIZE, (byte) 0);
+        Files.write(noHeader, zeroed);
+        assertThatThrownBy(() -> HeapGraph.open(noHeader)).isInstanceOf(IOException.class);
+
+        Path truncated = tempDir.resolve("truncated.graph");
+        Files.write(truncated, Arrays.copyOf(bytes, bytes.length - 8));
+        assertThatThrownBy(() -> HeapGraph.open(truncated)).isInstanceOf(IOException.class);
+    }
+
+    @Test
+    @DisplayName("JVMTI signatures convert to Class.getName() form")
+    void classNames() {
+        assertThat(HeapGraph.className("Ljava/lang/String;")).isEqualTo("java.lang.String");
+        assertThat(HeapGraph.className("[Ljava/lang/String;")).isEqualTo("[Ljava.lang.String;");
+        assertThat(HeapGraph.className("[I")).isEqualTo("[I");
+        assertThat(HeapGraph.className("J")).isEqualTo("long");
+    }
+
+    /** Writes the graph described in the class comment in the agent's layout. */
+    private Path write(ByteOrder order, boolean sourceEdgesOnly) throws IOException {
+        String[] signatures = { "Lapp/OldUser;", "Lapp/Session;", "Lapp/Cache;", "[Ljava/lang/Object;" };
+        int[] classFlags = { HeapGraph.CLASS_SOURCE, 0, 0, 0 };
+        // (class, size) per object: the four mirrors, then the instances
+        int[][] objects = { { -1, 0 }, { -1, 0 }, { -1, 96 }, { -1, 0 },
+                            { OLD_USER, 16 }, { OLD_USER, 16 }, { SESSION, 24 }, { OBJECT_ARRAY, 40 } };
+        List<int[]> edges = new ArrayList<>(List.of(
+                new int[] { HeapGraph.ROOT, USER_B, HeapReferenceKind.STACK_LOCAL.code(), -1 },
+                new int[] { SESSION_1, USER_A, HeapReferenceKind.FIELD.code(), 0 },
+                new int[] { ARRAY_1, USER_B, HeapReferenceKind.ARRAY_ELEMENT.code(), 2 }));
+        if (!sourceEdgesOnly) {
+            edges.add(new int[] { CACHE, SESSION_1, HeapReferenceKind.STATIC_FIELD.code(), 1 });
+            edges.add(new int[] { HeapGraph.ROOT, ARRAY_1, HeapReferenceKind.JNI_GLOBAL.code(), -1 });
+            edges.add(new int[] { USER_A, OLD_USER, HeapReferenceKind.CLASS.code(), -1 });
+        }
+
+        int classBytes = 0;
+        for (String s : signatures) classBytes += 8 + s.length();
+        long classOffset = HeapGraph.HEADER_SIZE;
+        long edgeOffset = align(classOffset + classBytes);
+        long objectOffset = align(edgeOffset + (long) edges.size() * HeapGraph.EDGE_SIZE);
+        long size = objectOffset + (long) objects.length * HeapGraph.OBJECT_SIZE;
+
+        ByteBuffer b = ByteBuffer.allocate((int) size).order(order);
+        b.putInt(HeapGraph.MAGIC).putInt(HeapGraph.VERSION)
+                .putInt(sourceEdgesOnly ? HeapGraph.SOURCE_EDGES_ONLY : 0).putInt(signatures.length)
+                .putLong(objects.length).putLong(edges.size())
+                .putLong(classOffset).putLong(edgeOffset).putLong(objectOffset).putLong(size);
+        for (int i = 0; i < signatures.length; i++) {
+            byte[] sig = signatures[i].getBytes(StandardCharsets.UTF_8);
+            b.putInt(classFlags[i]).putInt(sig.length).put(sig);
+        }
+        b.position((int) edgeOffset);
+        for (int[] e : edges) b.putInt(e[0]).putInt(e[1]).putInt(e[2]).putInt(e[3]);
+        b.position((int) objectOffset);
+        for (int[] o : objects) b.putInt(o[0]).putInt(o[1]);
+
+        Path file = tempDir.resolve(order + (sourceEdgesOnly ? "-source" : "-full") + ".graph");
+        Files.write(file, b.array());
+        return file;
+    }
+
+    private static long align(long offset) {
+        return (offset + 15) & ~15L;
+    }
+}
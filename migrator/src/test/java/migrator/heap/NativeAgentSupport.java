@@ -16,7 +16,8 @@ import java.util.List;
  * unbound by default and any call throws {@link UnsatisfiedLinkError}. This helper loads the agent
  * at runtime by self-attaching via the Attach API and calling
  * {@link VirtualMachine#loadAgentPath(String)}, which triggers {@code Agent_OnAttach} → JVMTI
- * initialization and binds the {@code Java_migrator_heap_NativeHeapWalker_*} symbols.
+ * initialization and binds the {@code Java_migrator_heap_NativeHeapWalker_*} symbols (and the other
+ * natives the agent exports, such as {@code migrator.quiesce.NativeThreadSuspender}'s).
  *
  * <p>Self-attach requires {@code -Djdk.attach.allowAttachSelf=true} (set in the module's surefire
  * {@code argLine}). The agent shared library is rebuilt from source when a C toolchain and JDK
@@ -24,7 +25,7 @@ import java.util.List;
  * is possible (no toolchain, no prebuilt library, attach disabled, non-Linux, …) loading fails and
  * tests that depend on it skip via JUnit assumptions rather than failing the build.
  */
-final class NativeAgentSupport {
+public final class NativeAgentSupport {
 
     private static volatile boolean attempted = false;
     private static volatile boolean loaded = false;
@@ -33,7 +34,7 @@ final class NativeAgentSupport {
     private NativeAgentSupport() {}
 
     /** @return true once the native agent is loaded and its methods are callable. */
-    static synchronized boolean ensureLoaded() {
+    public static synchronized boolean ensureLoaded() {
         if (attempted) return loaded;
         attempted = true;
         try {
@@ -61,7 +62,7 @@ final class NativeAgentSupport {
         }
     }
 
-    static String skipReason() {
+    public static String skipReason() {
         return skipReason;
     }
 
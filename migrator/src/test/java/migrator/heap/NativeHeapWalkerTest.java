@@ -4,25 +4,44 @@ import org.junit.jupiter.api.BeforeAll;
 import org.junit.jupiter.api.BeforeEach;
 import org.junit.jupiter.api.DisplayName;
 import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.io.TempDir;
 
+import java.nio.file.Files;
+import java.nio.file.Path;
 import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.Collection;
 import java.util.Collections;
+import java.util.HashMap;
 import java.util.IdentityHashMap;
 import java.util.List;
+import java.util.Map;
 import java.util.Set;
+import java.util.concurrent.CancellationException;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicReference;
+import java.util.function.Predicate;
+import java.util.function.Supplier;
 
 import migrator.exceptions.MigrateException;
+import migrator.quiesce.NativeThreadSuspender;
+import migrator.quiesce.SuspendResult;
 
 import static org.assertj.core.api.Assertions.assertThat;
 import static org.assertj.core.api.Assertions.assertThatCode;
+import static org.assertj.core.api.Assertions.assertThatThrownBy;
 import static org.junit.jupiter.api.Assumptions.assumeTrue;
 
 /**
  * Hard, behavioural tests for the JNI/JVMTI native methods backing {@link NativeHeapWalker}:
- * {@code nativeSnapshotObjects}, {@code nativeWalkHeap}, {@code nativeWalkHeapFiltered} and
- * {@code nativeAdvanceEpoch} (see {@code agent/agent.c}).
+ * {@code nativeSnapshotObjects}, {@code nativeSnapshotPartitioned}, {@code nativeWalkHeap},
+ * {@code nativeWalkHeapFiltered}, their reachable (FollowReferences) variants,
+ * {@code nativeFindReferrers}, {@code nativePatchSlots}, {@code nativePatchStackLocals},
+ * {@code nativeVerifyResidual},
+ * {@code nativeAdvanceEpoch} and the tag
+ * reclamation diagnostics, walk progress and cancellation, and the object-reclamation tracker
+ * (see {@code agent/agent.c}).
  *
  * <p>These run against the real native agent self-attached into the test JVM
  * (see {@link NativeAgentSupport}). They focus on borderline and bad inputs:
@@ -32,6 +51,7 @@ import static org.junit.jupiter.api.Assumptions.assumeTrue;
  *   <li>interfaces and array classes as targets,</li>
  *   <li>deduplication of repeated classes and identity (not {@code equals}) set semantics,</li>
  *   <li>per-walk epoch/tag isolation so one walk never leaks results into the next,</li>
+ *   <li>per-walk tag reclamation so no walk leaves tags behind,</li>
  *   <li>large object counts to confirm every live instance is returned exactly once.</li>
  * </ul>
  *
@@ -164,6 +184,204 @@ class NativeHeapWalkerTest {
         assertThat(snap).allMatch(o -> o.getClass() == long[][].class);
     }
 
+    // ----------------------------------------------------------------------------------------------
+    // snapshotPartitioned — one walk, many classes
+    // ----------------------------------------------------------------------------------------------
+
+    static final class PartA { int x; PartA(int x) { this.x = x; } }
+    static class PartB { int x; PartB(int x) { this.x = x; } }
+    static final class PartC extends PartB { PartC(int x) { super(x); } }
+    static final class PartNone { private PartNone() {} }
+
+    @Test
+    @DisplayName("snapshotPartitioned returns each class's exact instances in its own partition")
+    void snapshotPartitionedSplitsByExactClass() {
+        PartA a1 = new PartA(1), a2 = new PartA(2);
+        PartB b = new PartB(3);
+        PartC c = new PartC(4);
+        keep(a1, a2, b, c);
+
+        Map<Class<?>, Object[]> parts = walker.snapshotPartitioned(
+                Arrays.asList(PartA.class, PartB.class, null, PartC.class, PartNone.class, PartA.class));
+
+        assertThat(parts.keySet()).containsExactly(PartA.class, PartB.class, PartC.class, PartNone.class);
+        assertThat(identitySet(parts.get(PartA.class))).containsExactlyInAnyOrder(a1, a2);
+        assertThat(parts.get(PartB.class)).containsExactly(b);   // exact class: the PartC is not a PartB here
+        assertThat(parts.get(PartC.class)).containsExactly(c);
+        assertThat(parts.get(PartNone.class)).isNotNull().isEmpty();
+    }
+
+    @Test
+    @DisplayName("snapshotPartitioned agrees with per-class snapshots and handles null / empty input")
+    void snapshotPartitionedMatchesPerClassSnapshots() {
+        for (int i = 0; i < 50; i++) keep(new PartA(i), new PartC(i));
+
+        Map<Class<?>, Object[]> parts = walker.snapshotPartitioned(List.of(PartA.class, PartC.class));
+
+        assertThat(identitySet(parts.get(PartA.class))).isEqualTo(identitySet(walker.snapshotObjects(PartA.class)));
+        assertThat(identitySet(parts.get(PartC.class))).isEqualTo(identitySet(walker.snapshotObjects(PartC.class)));
+        assertThat(walker.snapshotPartitioned(null)).isEmpty();
+        assertThat(walker.snapshotPartitioned(List.of())).isEmpty();
+    }
+
+    @Test
+    @DisplayName("snapshotPartitioned of java.lang.Class keeps matching the other requested classes")
+    void snapshotPartitionedWithClassAsTarget() {
+        PartA a = new PartA(1);
+        keep(a);
+
+        Map<Class<?>, Object[]> parts = walker.snapshotPartitioned(List.of(Class.class, PartA.class));
+
+        assertThat(parts.get(PartA.class)).containsExactly(a);
+        assertThat(parts.get(Class.class)).isNotEmpty();
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // snapshotReachable / walkReachable — live objects only
+    // ----------------------------------------------------------------------------------------------
+
+    static final class ReachLive { int x; ReachLive(int x) { this.x = x; } }
+    static final class ReachDead { int x; ReachDead(int x) { this.x = x; } }
+    static final class ReachHolder { Object ref; ReachHolder(Object ref) { this.ref = ref; } }
+
+    /** Published through a heap field so the allocations cannot be scalar-replaced. */
+    static volatile Object litterSink;
+
+    /** Leaves {@code n} unreachable instances of each class on the heap (until the next GC). */
+    private static void litter(int n) {
+        Object[] trash = new Object[n * 2];
+        for (int i = 0; i < n; i++) {
+            trash[2 * i] = new ReachDead(i);
+            trash[2 * i + 1] = new ReachLive(-i);
+        }
+        litterSink = trash;
+        litterSink = null;
+    }
+
+    @Test
+    @DisplayName("snapshotReachable returns only reachable instances, partitioned like snapshotPartitioned")
+    void snapshotReachableSkipsGarbage() {
+        ReachLive live = new ReachLive(1);
+        ReachHolder holder = new ReachHolder(new ReachLive(2));
+        keep(live, holder);
+        litter(500);
+
+        Map<Class<?>, Object[]> parts = walker.snapshotReachable(
+                Arrays.asList(ReachLive.class, null, ReachDead.class, ReachLive.class));
+
+        assertThat(parts.keySet()).containsExactly(ReachLive.class, ReachDead.class);
+        assertThat(identitySet(parts.get(ReachLive.class))).containsExactlyInAnyOrder(live, holder.ref);
+        assertThat(parts.get(ReachDead.class)).isNotNull().isEmpty();
+        // A heap snapshot still sees every uncollected instance.
+        assertThat(walker.snapshotObjects(ReachLive.class).length).isGreaterThanOrEqualTo(2);
+        assertThat(walker.snapshotReachable(null)).isEmpty();
+    }
+
+    @Test
+    @DisplayName("walkReachable returns live objects only, optionally without leaves")
+    void walkReachableSkipsGarbage() throws MigrateException {
+        ReachLive live = new ReachLive(3);
+        byte[] bytes = new byte[16];
+        ReachHolder holder = new ReachHolder(bytes);
+        keep(live, holder);
+        litter(100);
+
+        Set<Object> all = walker.walkReachable(null);
+        assertThat(all.contains(live)).isTrue();
+        assertThat(all.contains(holder)).isTrue();
+        assertThat(all.contains(bytes)).isTrue();
+        assertThat(all).noneMatch(o -> o instanceof ReachDead);
+
+        Set<Object> noLeaves = walker.walkReachable(List.of(ReachLive.class));
+        assertThat(noLeaves.contains(holder)).isTrue();
+        assertThat(noLeaves.contains(live)).isFalse();
+        assertThat(noLeaves.contains(bytes)).isFalse();
+    }
+
+    @Test
+    @DisplayName("chunked walkReachable delivers every live object once and no garbage")
+    void chunkedWalkReachable() throws MigrateException {
+        ReachLive live = new ReachLive(4);
+        ReachHolder holder = new ReachHolder(live);
+        keep(holder);
+        litter(100);
+
+        Set<Object> seen = Collections.newSetFromMap(new IdentityHashMap<>());
+        long delivered = walker.walkReachable(null, chunk -> {
+            assertThat(chunk.length).isBetween(1, 4096);
+            Collections.addAll(seen, chunk);
+        }, 4096);
+
+        assertThat((long) seen.size()).isEqualTo(delivered);
+        assertThat(seen.contains(holder)).isTrue();
+        assertThat(seen.contains(live)).isTrue();
+        assertThat(seen).noneMatch(o -> o instanceof ReachDead);
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // snapshotReachableFrom / walkReachableFrom — one subgraph
+    // ----------------------------------------------------------------------------------------------
+
+    static final class ScopeItem { int x; ScopeItem(int x) { this.x = x; } }
+
+    /** A tenant root; its class's static field is reached only through a class reference. */
+    static final class ScopeTenant {
+        static Object shared;
+        final Object[] items;
+        ScopeTenant(Object... items) { this.items = items; }
+    }
+
+    @Test
+    @DisplayName("snapshotReachableFrom returns the instances below the roots only, not through statics")
+    void snapshotReachableFromOneTenant() throws MigrateException {
+        ScopeItem a1 = new ScopeItem(1), a2 = new ScopeItem(2), b1 = new ScopeItem(3);
+        ScopeTenant a = new ScopeTenant(a1, new ReachHolder(a2));
+        ScopeTenant b = new ScopeTenant(b1);
+        keep(a, b);
+        ScopeTenant.shared = new ScopeItem(4);
+        try {
+            Map<Class<?>, Object[]> parts = walker.snapshotReachableFrom(List.of(a),
+                    Arrays.asList(ScopeItem.class, null, ScopeTenant.class));
+
+            assertThat(parts.keySet()).containsExactly(ScopeItem.class, ScopeTenant.class);
+            assertThat(identitySet(parts.get(ScopeItem.class))).containsExactlyInAnyOrder(a1, a2);
+            assertThat(identitySet(parts.get(ScopeTenant.class))).containsExactly(a);
+
+            Map<Class<?>, Object[]> both = walker.snapshotReachableFrom(Arrays.asList(a, null, b), List.of(ScopeItem.class));
+            assertThat(identitySet(both.get(ScopeItem.class))).containsExactlyInAnyOrder(a1, a2, b1);
+        } finally {
+            ScopeTenant.shared = null;
+        }
+    }
+
+    @Test
+    @DisplayName("walkReachableFrom returns the roots and what they reach, optionally without leaves")
+    void walkReachableFromOneTenant() throws MigrateException {
+        byte[] bytes = new byte[16];
+        ScopeItem item = new ScopeItem(5);
+        ReachHolder holder = new ReachHolder(bytes);
+        ScopeTenant a = new ScopeTenant(item, holder);
+        ScopeTenant b = new ScopeTenant(new ScopeItem(6));
+        keep(a, b);
+
+        Set<Object> all = walker.walkReachableFrom(List.of(a), null);
+        assertThat(all.contains(a)).isTrue();
+        assertThat(all.contains(a.items)).isTrue();
+        assertThat(all.contains(item)).isTrue();
+        assertThat(all.contains(bytes)).isTrue();
+        assertThat(all.contains(b)).isFalse();
+        assertThat(all.contains(b.items[0])).isFalse();
+        assertThat(all).noneMatch(o -> o instanceof Class<?>);
+
+        Set<Object> noLeaves = walker.walkReachableFrom(List.of(a), List.of(ScopeItem.class));
+        assertThat(noLeaves.contains(holder)).isTrue();
+        assertThat(noLeaves.contains(item)).isFalse();
+        assertThat(noLeaves.contains(bytes)).isFalse();
+
+        assertThat(walker.walkReachableFrom(List.of(), null)).isEmpty();
+        assertThat(walker.snapshotReachableFrom(null, List.of(ScopeItem.class)).get(ScopeItem.class)).isEmpty();
+    }
+
     // ----------------------------------------------------------------------------------------------
     // walkHeap(Collection) — filtered
     // ----------------------------------------------------------------------------------------------
@@ -250,6 +468,23 @@ class NativeHeapWalkerTest {
         assertThat(distinct).isEqualTo(2);
     }
 
+    static final class ManyA { } static final class ManyB { } static final class ManyC { }
+    static final class ManyD { } static final class ManyE { } static final class ManyF { }
+
+    @Test
+    @DisplayName("filtered walk over many classes (one heap pass) finds every instance exactly once")
+    void filteredWalkManyClasses() throws MigrateException {
+        List<Object> expected = List.of(new ManyA(), new ManyB(), new ManyC(), new ManyD(), new ManyE(), new ManyF());
+        keep(expected.toArray());
+        List<Class<?>> classes = new ArrayList<>();
+        for (Object o : expected) classes.add(o.getClass());
+        for (int i = 0; i < 40; i++) classes.add(NeverInstantiated.class); // duplicates are harmless
+
+        Set<Object> result = walker.walkHeap(classes);
+
+        assertThat(result).containsExactlyInAnyOrderElementsOf(expected);
+    }
+
     // ----------------------------------------------------------------------------------------------
     // walkHeap() — full
     // ----------------------------------------------------------------------------------------------
@@ -273,6 +508,232 @@ class NativeHeapWalkerTest {
         assertThat(all.size()).isGreaterThan(100);
     }
 
+    // ----------------------------------------------------------------------------------------------
+    // walkHeap(sink, chunkSize) — chunked
+    // ----------------------------------------------------------------------------------------------
+
+    static final class ChunkFixture { int x; ChunkFixture(int x) { this.x = x; } }
+    static final class ChunkOther { int x; ChunkOther(int x) { this.x = x; } }
+    static final class FullChunkFixture { int x; FullChunkFixture(int x) { this.x = x; } }
+    static final class ChunkAbortFixture { int x; ChunkAbortFixture(int x) { this.x = x; } }
+
+    @Test
+    @DisplayName("filtered chunked walk delivers every match exactly once, in chunks of at most chunkSize")
+    void filteredChunkedWalk() throws MigrateException {
+        List<Object> expected = new ArrayList<>();
+        for (int i = 0; i < 250; i++) expected.add(new ChunkFixture(i));
+        for (int i = 0; i < 50; i++) expected.add(new ChunkOther(i));
+        keep(expected.toArray());
+
+        List<Object[]> chunks = new ArrayList<>();
+        long delivered = walker.walkHeap(List.of(ChunkFixture.class, ChunkOther.class), chunks::add, 64);
+
+        Set<Object> seen = Collections.newSetFromMap(new IdentityHashMap<>());
+        int total = 0;
+        for (Object[] chunk : chunks) {
+            assertThat(chunk.length).isBetween(1, 64);
+            total += chunk.length;
+            Collections.addAll(seen, chunk);
+        }
+        assertThat(delivered).isEqualTo(total).isEqualTo(300);
+        assertThat(seen).hasSize(300).containsAll(expected);
+        assertThat(chunks.size()).isGreaterThanOrEqualTo(5);
+    }
+
+    @Test
+    @DisplayName("derived chunks deliver every match exactly once in a bounded number of chunks")
+    void derivedChunkedWalk() throws MigrateException {
+        List<Object> expected = new ArrayList<>();
+        for (int i = 0; i < 300; i++) expected.add(new ChunkFixture(i));
+        keep(expected.toArray());
+
+        List<Object[]> filtered = new ArrayList<>();
+        long matched = walker.walkHeap(List.of(ChunkFixture.class), filtered::add, HeapWalker.DERIVED_CHUNK_SIZE);
+        Set<Object> seen = Collections.newSetFromMap(new IdentityHashMap<>());
+        filtered.forEach(chunk -> Collections.addAll(seen, chunk));
+        assertThat(matched).isEqualTo(300);
+        assertThat(seen).hasSize(300).containsAll(expected);
+        assertThat(filtered.size()).isBetween(1, HeapWalker.DERIVED_CHUNKS + 1);
+
+        // The whole heap: many times the base slice, still in at most DERIVED_CHUNKS + 1 scans.
+        List<Object[]> full = new ArrayList<>();
+        long delivered = walker.walkHeap(full::add, HeapWalker.DERIVED_CHUNK_SIZE);
+        seen.clear();
+        full.forEach(chunk -> Collections.addAll(seen, chunk));
+        assertThat((long) seen.size()).isEqualTo(delivered);
+        assertThat(seen).containsAll(expected);
+        assertThat(full.size()).isBetween(1, HeapWalker.DERIVED_CHUNKS + 1);
+    }
+
+    @Test
+    @DisplayName("full chunked walk delivers our live objects without duplicates")
+    void fullChunkedWalk() throws MigrateException {
+        FullChunkFixture f1 = new FullChunkFixture(1);
+        FullChunkFixture f2 = new FullChunkFixture(2);
+        keep(f1, f2);
+
+        Set<Object> seen = Collections.newSetFromMap(new IdentityHashMap<>());
+        long[] delivered = {0};
+        walker.walkHeap(chunk -> {
+            assertThat(chunk.length).isBetween(1, 4096);
+            delivered[0] += chunk.length;
+            Collections.addAll(seen, chunk);
+        }, 4096);
+
+        assertThat(seen.contains(f1)).isTrue();
+        assertThat(seen.contains(f2)).isTrue();
+        assertThat((long) seen.size()).isEqualTo(delivered[0]);
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // walkHeapSkippingLeaves(...) — full walk without reference-free leaves
+    // ----------------------------------------------------------------------------------------------
+
+    static final class LeafFixture { long v; LeafFixture(long v) { this.v = v; } }
+    static final class NonLeafFixture { Object ref; NonLeafFixture(Object ref) { this.ref = ref; } }
+
+    @Test
+    @DisplayName("leaf-skipping walk drops primitive arrays and leaf instances but keeps their holders")
+    void fullWalkSkipsLeaves() throws MigrateException {
+        LeafFixture leaf = new LeafFixture(1);
+        byte[] bytes = new byte[32];
+        Object[] refs = {leaf, bytes};
+        NonLeafFixture holder = new NonLeafFixture(refs);
+        keep(leaf, bytes, refs, holder);
+
+        Set<Object> all = walker.walkHeapSkippingLeaves(List.of(LeafFixture.class));
+
+        assertThat(all.contains(holder)).isTrue();
+        assertThat(all.contains(refs)).isTrue();
+        assertThat(all.contains(leaf)).isFalse();
+        assertThat(all.contains(bytes)).isFalse();
+        assertThat(all).noneMatch(o -> o != null && o.getClass().isArray()
+                && o.getClass().getComponentType().isPrimitive());
+        // The leaf class mirrors themselves are still reported.
+        assertThat(all.contains(LeafFixture.class)).isTrue();
+        assertThat(all.size()).isLessThan(walker.walkHeap().size());
+    }
+
+    @Test
+    @DisplayName("chunked leaf-skipping walk drops the same objects")
+    void chunkedWalkSkipsLeaves() throws MigrateException {
+        LeafFixture leaf = new LeafFixture(2);
+        int[] ints = new int[8];
+        NonLeafFixture holder = new NonLeafFixture(leaf);
+        keep(leaf, ints, holder);
+
+        Set<Object> seen = Collections.newSetFromMap(new IdentityHashMap<>());
+        long delivered = walker.walkHeapSkippingLeaves(List.of(LeafFixture.class), chunk -> {
+            assertThat(chunk.length).isBetween(1, 4096);
+            Collections.addAll(seen, chunk);
+        }, 4096);
+
+        assertThat((long) seen.size()).isEqualTo(delivered);
+        assertThat(seen.contains(holder)).isTrue();
+        assertThat(seen.contains(leaf)).isFalse();
+        assertThat(seen.contains(ints)).isFalse();
+    }
+
+    @Test
+    @DisplayName("leaf-skipping walk with no leaf classes still drops primitive arrays")
+    void leafWalkWithoutClasses() throws MigrateException {
+        LeafFixture notALeaf = new LeafFixture(3);
+        long[] longs = new long[4];
+        keep(notALeaf, longs);
+
+        Set<Object> all = walker.walkHeapSkippingLeaves(null);
+
+        assertThat(all.contains(notALeaf)).isTrue();
+        assertThat(all.contains(longs)).isFalse();
+    }
+
+    @Test
+    @DisplayName("chunked walks reject bad arguments and deliver nothing for no classes")
+    void chunkedWalkArguments() throws MigrateException {
+        assertThatThrownBy(() -> walker.walkHeap(chunk -> { }, -1))
+                .isInstanceOf(IllegalArgumentException.class);
+        assertThatThrownBy(() -> walker.walkHeap(List.of(ChunkOther.class), null, 16))
+                .isInstanceOf(NullPointerException.class);
+        assertThat(walker.walkHeap(List.of(), chunk -> { throw new AssertionError(); }, 16)).isZero();
+        assertThat(walker.walkHeap(List.of(NeverInstantiated.class), chunk -> { throw new AssertionError(); }, 16)).isZero();
+    }
+
+    @Test
+    @DisplayName("a sink failure aborts the walk; later walks are unaffected")
+    void chunkedWalkSinkFailure() throws MigrateException {
+        for (int i = 0; i < 40; i++) keep(new ChunkAbortFixture(i));
+
+        int[] calls = {0};
+        assertThatThrownBy(() -> walker.walkHeap(List.of(ChunkAbortFixture.class), chunk -> {
+            calls[0]++;
+            throw new IllegalStateException("stop");
+        }, 8)).isInstanceOf(IllegalStateException.class);
+        assertThat(calls[0]).isEqualTo(1);
+
+        assertThat(walker.walkHeap(List.of(ChunkAbortFixture.class)))
+                .hasSize(walker.snapshotObjects(ChunkAbortFixture.class).length);
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // census — counts without resolving objects
+    // ----------------------------------------------------------------------------------------------
+
+    static class CensusBase { long a, b; CensusBase(long a) { this.a = a; } }
+    static final class CensusDerived extends CensusBase { CensusDerived(long a) { super(a); } }
+    static final class CensusArrayElem { }
+
+    @Test
+    @DisplayName("census counts exact-class instances and their shallow bytes")
+    void censusCountsExactClass() throws MigrateException {
+        for (int i = 0; i < 30; i++) keep(new CensusBase(i));
+        for (int i = 0; i < 12; i++) keep(new CensusDerived(i));
+
+        HeapCensus census = walker.census(Arrays.asList(CensusBase.class, null, CensusDerived.class, CensusBase.class));
+
+        assertThat(census.count(CensusBase.class)).isEqualTo(walker.snapshotObjects(CensusBase.class).length);
+        assertThat(census.count(CensusDerived.class)).isEqualTo(walker.snapshotObjects(CensusDerived.class).length);
+        assertThat(census.count(CensusBase.class)).isGreaterThanOrEqualTo(30);
+        assertThat(census.shallowBytes(CensusBase.class)).isGreaterThanOrEqualTo(30L * 16);
+        assertThat(census.classes().get(CensusBase.class).lengthBuckets()).isNull();
+        assertThat(census.totalCount())
+                .isEqualTo(census.count(CensusBase.class) + census.count(CensusDerived.class));
+        assertThat(census.count(NeverInstantiated.class)).isZero();
+    }
+
+    @Test
+    @DisplayName("census of an array class buckets array lengths by power of two")
+    void censusArrayLengths() throws MigrateException {
+        keep(new CensusArrayElem[0], new CensusArrayElem[1], new CensusArrayElem[3], new CensusArrayElem[1000]);
+
+        HeapCensus census = walker.census(List.of(CensusArrayElem[].class));
+
+        HeapCensus.ClassCensus arrays = census.classes().get(CensusArrayElem[].class);
+        assertThat(arrays).isNotNull();
+        assertThat(arrays.count()).isEqualTo(4);
+        long[] buckets = arrays.lengthBuckets();
+        assertThat(buckets).hasSize(HeapCensus.LENGTH_BUCKETS);
+        assertThat(buckets[0]).isEqualTo(1);  // length 0
+        assertThat(buckets[1]).isEqualTo(1);  // length 1
+        assertThat(buckets[2]).isEqualTo(1);  // lengths 2..3
+        assertThat(buckets[10]).isEqualTo(1); // lengths 512..1023
+        assertThat(HeapCensus.bucketLowerBound(10)).isEqualTo(512);
+        assertThat(arrays.shallowBytes()).isGreaterThan(1000L * 4);
+    }
+
+    @Test
+    @DisplayName("whole-heap census covers every loaded class, including our fixtures")
+    void censusWholeHeap() throws MigrateException {
+        keep(new CensusDerived(1));
+
+        HeapCensus census = walker.census(null);
+
+        assertThat(census.count(CensusDerived.class)).isGreaterThanOrEqualTo(1);
+        assertThat(census.count(String.class)).isGreaterThan(100);
+        assertThat(census.totalCount()).isGreaterThan(1000);
+        assertThat(census.largestByBytes(3)).hasSize(3);
+        assertThat(walker.census(Arrays.asList((Class<?>) null))).isEqualTo(HeapCensus.EMPTY);
+    }
+
     // ----------------------------------------------------------------------------------------------
     // epoch / per-walk tag isolation
     // ----------------------------------------------------------------------------------------------
@@ -323,6 +784,702 @@ class NativeHeapWalkerTest {
         assertThat(identitySet(after)).contains(o);
     }
 
+    static final class ReclaimFixture { Object ref; ReclaimFixture(Object ref) { this.ref = ref; } }
+
+    @Test
+    @DisplayName("no walk leaves a tag behind, including a chunked walk whose sink fails")
+    void walksLeaveNoTags() throws MigrateException {
+        Object shared = new Object();
+        for (int i = 0; i < 50; i++) keep(new ReclaimFixture(shared));
+        keep(shared);
+
+        walker.snapshotObjects(ReclaimFixture.class);
+        walker.snapshotPartitioned(List.of(ReclaimFixture.class, EpochBase.class));
+        walker.walkHeap(List.of(ReclaimFixture.class));
+        walker.walkHeap();
+        walker.walkHeap(chunk -> { }, 1 << 16);
+        assertThatThrownBy(() -> walker.walkHeap(List.of(ReclaimFixture.class), chunk -> {
+            throw new IllegalStateException("stop");
+        }, 8)).isInstanceOf(IllegalStateException.class);
+        walker.census(List.of(ReclaimFixture.class));
+        walker.findReferrers(List.of(shared));
+        walker.patchSlots(List.of(keepAlive.get(0)), new Object[]{shared}, new Object[]{shared});
+
+        assertThat(NativeHeapWalker.openWalkEnvironments()).isZero();
+        assertThat(NativeHeapWalker.retainedTagCount()).isZero();
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // walkProgress / cancelWalks
+    // ----------------------------------------------------------------------------------------------
+
+    static final class ProgressFixture { int a; ProgressFixture(int a) { this.a = a; } }
+    static final class CancelFixture { int a; CancelFixture(int a) { this.a = a; } }
+
+    @Test
+    @DisplayName("walkProgress reports the last walk's visited and tagged counts once it ends")
+    void progressOfFinishedWalk() {
+        for (int i = 0; i < 3000; i++) keep(new ProgressFixture(i));
+
+        walker.snapshotObjects(ProgressFixture.class);
+
+        WalkProgress progress = walker.walkProgress();
+        assertThat(progress.walkId()).isPositive();
+        assertThat(progress.visited()).isEqualTo(3000);
+        assertThat(progress.tagged()).isEqualTo(3000);
+        assertThat(progress.active()).isFalse();
+        assertThat(progress.cancelled()).isFalse();
+    }
+
+    @Test
+    @DisplayName("cancelWalks does not affect walks started after it")
+    void cancelDoesNotAffectLaterWalks() {
+        for (int i = 0; i < 10; i++) keep(new CancelFixture(i));
+
+        walker.cancelWalks();
+
+        assertThat(walker.snapshotObjects(CancelFixture.class)).hasSize(10);
+        assertThat(walker.walkProgress().cancelled()).isFalse();
+    }
+
+    @Test
+    @DisplayName("cancelWalks stops a running full walk, which then throws CancellationException")
+    void cancelStopsRunningWalk() throws InterruptedException {
+        Object[] filler = new Object[2_000_000];
+        for (int i = 0; i < filler.length; i++) filler[i] = new CancelFixture(i);
+        keep((Object) filler);
+        long before = walker.walkProgress().walkId();
+
+        AtomicReference<Throwable> thrown = new AtomicReference<>();
+        Thread walk = new Thread(() -> {
+            try {
+                walker.walkHeap();
+            } catch (Throwable t) {
+                thrown.set(t);
+            }
+        });
+        walk.start();
+        long deadline = System.nanoTime() + 10_000_000_000L;
+        while (System.nanoTime() < deadline && walk.isAlive()) {
+            WalkProgress p = walker.walkProgress();
+            if (p.walkId() > before && p.active() && p.visited() > 0) break;
+            Thread.onSpinWait();
+        }
+        walker.cancelWalks();
+        walk.join(30_000);
+
+        assertThat(walk.isAlive()).isFalse();
+        WalkProgress progress = walker.walkProgress();
+        assumeTrue(progress.cancelled(), "the walk finished before it could be cancelled");
+        assertThat(thrown.get()).isInstanceOf(CancellationException.class);
+        assertThat(NativeHeapWalker.openWalkEnvironments()).isZero();
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // opTimes
+    // ----------------------------------------------------------------------------------------------
+
+    static final class TimedFixture { int a; TimedFixture(int a) { this.a = a; } }
+
+    @Test
+    @DisplayName("opTimes counts a tagging and a resolve step per snapshot, safepoint time within wall time")
+    void opTimesOfSnapshot() {
+        for (int i = 0; i < 100; i++) keep(new TimedFixture(i));
+        HeapOpTimes before = walker.opTimes();
+
+        walker.snapshotObjects(TimedFixture.class);
+
+        HeapOpTimes delta = walker.opTimes().minus(before);
+        assertThat(delta.tagCalls()).isGreaterThanOrEqualTo(1);
+        assertThat(delta.resolveCalls()).isGreaterThanOrEqualTo(1);
+        assertThat(delta.tagSafepointNanos()).isPositive().isLessThanOrEqualTo(delta.tagWallNanos());
+        assertThat(delta.resolveSafepointNanos()).isPositive().isLessThanOrEqualTo(delta.resolveWallNanos());
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // startReclamationTracking / reclamationProgress / stopReclamationTracking
+    // ----------------------------------------------------------------------------------------------
+
+    static final class ReclaimFixture { long a; ReclaimFixture(long a) { this.a = a; } }
+
+    @Test
+    @DisplayName("a reclamation tracker counts the frees of dropped objects, but not of those still held")
+    void reclamationTrackerCountsFrees() throws InterruptedException {
+        ReclaimFixture held = new ReclaimFixture(-1);
+        keep(held);
+        List<Object> tracked = new ArrayList<>();
+        tracked.add(held);
+        for (int i = 0; i < 100; i++) tracked.add(new ReclaimFixture(i));
+        assumeTrue(walker.startReclamationTracking(tracked), "ObjectFree events not available");
+        tracked = null;
+        try {
+            ReclamationProgress progress = walker.reclamationProgress();
+            assertThat(progress.tracked()).isEqualTo(101);
+            assertThat(progress.trackedBytes()).isGreaterThanOrEqualTo(101L * 16);
+            assertThat(progress.active()).isTrue();
+
+            long deadline = System.nanoTime() + TimeUnit.SECONDS.toNanos(10);
+            while (walker.reclamationProgress().reclaimed() < 100 && System.nanoTime() < deadline) {
+                System.gc();
+                Thread.sleep(20);
+            }
+            progress = walker.reclamationProgress();
+            assertThat(progress.reclaimed()).isEqualTo(100);
+            assertThat(progress.outstanding()).isEqualTo(1);
+            assertThat(progress.isComplete()).as("one object is still held").isFalse();
+            assertThat(progress.reclaimedBytes() * 101).isEqualTo(progress.trackedBytes() * 100);
+            assertThat(progress.nanosToLastReclaim()).isPositive()
+                                                     .isLessThanOrEqualTo(progress.nanosSinceStart());
+        } finally {
+            walker.stopReclamationTracking();
+        }
+
+        ReclamationProgress stopped = walker.reclamationProgress();
+        assertThat(stopped.active()).isFalse();
+        assertThat(stopped.reclaimed()).as("counts stay readable").isEqualTo(100);
+    }
+
+    @Test
+    @DisplayName("a new reclamation tracker replaces the last one; empty input starts none")
+    void reclamationTrackerReplaced() {
+        ReclaimFixture a = new ReclaimFixture(1), b = new ReclaimFixture(2), c = new ReclaimFixture(3);
+        keep(a, b, c);
+        assertThat(walker.startReclamationTracking(null)).isFalse();
+        assertThat(walker.startReclamationTracking(List.of())).isFalse();
+        assumeTrue(walker.startReclamationTracking(List.of(a)), "ObjectFree events not available");
+        try {
+            long first = walker.reclamationProgress().trackerId();
+            assertThat(walker.startReclamationTracking(Arrays.asList(b, null, c))).isTrue();
+
+            ReclamationProgress progress = walker.reclamationProgress();
+            assertThat(progress.trackerId()).isNotEqualTo(first);
+            assertThat(progress.tracked()).isEqualTo(2);
+            assertThat(progress.reclaimed()).isZero();
+        } finally {
+            walker.stopReclamationTracking();
+        }
+        assertThatCode(walker::stopReclamationTracking).as("stopping twice").doesNotThrowAnyException();
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // findReferrers
+    // ----------------------------------------------------------------------------------------------
+
+    static final class RefTarget { int x; RefTarget(int x) { this.x = x; } }
+    static final class RefHolder { Object ref; RefHolder(Object ref) { this.ref = ref; } }
+    static final class RefBystander { Object ref; RefBystander(Object ref) { this.ref = ref; } }
+
+    @Test
+    @DisplayName("findReferrers returns the objects holding a field or element reference, not bystanders")
+    void findReferrersReturnsFieldAndArrayHolders() throws MigrateException {
+        RefTarget target = new RefTarget(1);
+        RefHolder holder = new RefHolder(target);
+        Object[] array = { null, target };
+        RefBystander bystander = new RefBystander(new RefTarget(2));
+        keep(holder, array, bystander);
+
+        HeapReferrers referrers = walker.findReferrers(List.of(target));
+
+        Set<Object> holders = identitySet(referrers.holders());
+        assertThat(holders).contains(holder, array).doesNotContain(bystander, target);
+        assertThat(referrers.referenceCount(HeapReferenceKind.FIELD)).isGreaterThanOrEqualTo(1);
+        assertThat(referrers.referenceCount(HeapReferenceKind.ARRAY_ELEMENT)).isGreaterThanOrEqualTo(1);
+    }
+
+    static final class StaticRefTarget { int x; StaticRefTarget(int x) { this.x = x; } }
+    static final class StaticRefHolder { static Object ref; }
+
+    @Test
+    @DisplayName("findReferrers reports a static-field holder as its Class object")
+    void findReferrersReturnsClassForStaticField() throws MigrateException {
+        StaticRefTarget target = new StaticRefTarget(1);
+        StaticRefHolder.ref = target;
+        try {
+            HeapReferrers referrers = walker.findReferrers(List.of(target));
+
+            assertThat(identitySet(referrers.holders())).contains(StaticRefHolder.class);
+            assertThat(referrers.referenceCount(HeapReferenceKind.STATIC_FIELD)).isGreaterThanOrEqualTo(1);
+        } finally {
+            StaticRefHolder.ref = null;
+        }
+    }
+
+    static final class ChainTarget { int x; ChainTarget(int x) { this.x = x; } }
+
+    @Test
+    @DisplayName("findReferrers never reports a target as its own holder, even in a cycle of targets")
+    void findReferrersExcludesTargets() throws MigrateException {
+        RefHolder a = new RefHolder(null);
+        RefHolder b = new RefHolder(a);
+        a.ref = b;
+        RefHolder outer = new RefHolder(a);
+        keep(outer);
+
+        HeapReferrers referrers = walker.findReferrers(List.of(a, b));
+
+        assertThat(identitySet(referrers.holders())).contains(outer).doesNotContain(a, b);
+    }
+
+    @Test
+    @DisplayName("findReferrers of null / empty targets returns EMPTY without walking")
+    void findReferrersEmptyInput() throws MigrateException {
+        assertThat(walker.findReferrers(null)).isSameAs(HeapReferrers.EMPTY);
+        assertThat(walker.findReferrers(List.of())).isSameAs(HeapReferrers.EMPTY);
+    }
+
+    @Test
+    @DisplayName("each referrer walk uses fresh tags: one walk's holders never leak into the next")
+    void findReferrersIsolatedByEpoch() throws MigrateException {
+        ChainTarget t1 = new ChainTarget(1), t2 = new ChainTarget(2);
+        RefHolder h1 = new RefHolder(t1), h2 = new RefHolder(t2);
+        keep(h1, h2);
+
+        assertThat(identitySet(walker.findReferrers(List.of(t1)).holders())).contains(h1).doesNotContain(h2);
+        assertThat(identitySet(walker.findReferrers(List.of(t2)).holders())).contains(h2).doesNotContain(h1);
+        // Targets of the earlier walks are not found as instances of a later snapshot's class by mistake.
+        assertThat(walker.snapshotObjects(ChainTarget.class)).hasSize(2);
+    }
+
+    @Test
+    @DisplayName("findReferrerChains fails once it would record more references than its cap")
+    void findReferrerChainsStopsAtCap() throws MigrateException {
+        ChainTarget target = new ChainTarget(1);
+        Map<String, Object> map = new HashMap<>();
+        map.put("k", target);
+        RefHolder owner = new RefHolder(map);
+        keep(owner);
+        Predicate<Class<?>> jdk = cls -> (cls.isArray() ? cls.getComponentType() : cls).getName().startsWith("java.");
+
+        HeapReferrerChains chains = walker.findReferrerChains(List.of(target), jdk, 8, Long.MAX_VALUE);
+        assertThat(chains.linkedAnchors()).contains(owner);
+
+        // node -> table -> map -> owner: more than one reference to record
+        assertThatThrownBy(() -> walker.findReferrerChains(List.of(target), jdk, 8, 1))
+                .isInstanceOf(MigrateException.class);
+        assertThatThrownBy(() -> walker.findReferrerChains(List.of(target), jdk, 8, 0))
+                .isInstanceOf(MigrateException.class);
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // findHolderClasses
+    // ----------------------------------------------------------------------------------------------
+
+    static final class HolderSource { int x; HolderSource(int x) { this.x = x; } }
+    static final class HolderSubSource { int x; HolderSubSource(int x) { this.x = x; } }
+    static final class FieldHolder { Object ref; FieldHolder(Object ref) { this.ref = ref; } }
+    static final class NonHolder { Object ref; NonHolder(Object ref) { this.ref = ref; } }
+    static final class StaticHolder { static Object ref; }
+
+    @Test
+    @DisplayName("findHolderClasses reports field, element and static-field holders, not bystanders or sources")
+    void findHolderClassesReportsHolders() throws MigrateException {
+        HolderSource a = new HolderSource(1), b = new HolderSource(2), c = new HolderSource(3);
+        HolderSource[] array = { null, b };
+        HolderSource self = new HolderSource(4);
+        keep(new FieldHolder(a), array, new NonHolder(new HolderSubSource(5)), self);
+        StaticHolder.ref = c;
+        try {
+            HolderClasses holders = walker.findHolderClasses(List.of(HolderSource.class));
+
+            assertThat(holders.instanceHolders())
+                    .contains(FieldHolder.class, HolderSource[].class)
+                    .doesNotContain(NonHolder.class, HolderSource.class);
+            assertThat(holders.staticOwners()).contains(StaticHolder.class).doesNotContain(FieldHolder.class);
+        } finally {
+            StaticHolder.ref = null;
+        }
+    }
+
+    static final class MapSource { int x; MapSource(int x) { this.x = x; } }
+    /** Unlisted owner of a source instance held only as a HashMap value. */
+    static final class MapOwner { final Map<String, Object> map = new HashMap<>(); }
+
+    @Test
+    @DisplayName("findHolderClasses climbs past JDK map internals to the class owning the map")
+    void findHolderClassesClimbsToMapOwner() throws Exception {
+        MapOwner owner = new MapOwner();
+        owner.map.put("k", new MapSource(1));
+        keep(owner);
+        Class<?> node = Class.forName("java.util.HashMap$Node");
+        Predicate<Class<?>> jdkInternals = cls -> (cls.isArray() ? cls.getComponentType() : cls).getName().startsWith("java.");
+
+        HolderClasses exact = walker.findHolderClasses(List.of(MapSource.class));
+        HolderClasses climbed = walker.findHolderClasses(List.of(MapSource.class), jdkInternals, 8);
+
+        assertThat(exact.instanceHolders()).contains(node).doesNotContain(MapOwner.class);
+        assertThat(climbed.instanceHolders()).contains(MapOwner.class).doesNotContain(node, MapSource.class);
+    }
+
+    @Test
+    @DisplayName("findHolderClasses of null / empty sources returns EMPTY without walking")
+    void findHolderClassesEmptyInput() throws MigrateException {
+        assertThat(walker.findHolderClasses(null)).isSameAs(HolderClasses.EMPTY);
+        assertThat(walker.findHolderClasses(List.of())).isSameAs(HolderClasses.EMPTY);
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // patchSlots
+    // ----------------------------------------------------------------------------------------------
+
+    interface Slot {}
+    static final class OldSlot implements Slot { int x; OldSlot(int x) { this.x = x; } }
+    static final class NewSlot implements Slot { int x; NewSlot(int x) { this.x = x; } }
+    /** Interface fields shift the JVMTI field indices of implementing classes. */
+    interface SlotConstants { Object TOKEN = new Object(); }
+    static class SlotBase implements SlotConstants { Slot inherited; long pad; }
+    static final class SlotHolder extends SlotBase implements Marker {
+        int primitive = 7;
+        Slot typed;
+        Object untyped;
+        final Slot finalSlot;
+        OldSlot concrete;  // a NewSlot does not fit: must be skipped, not written
+        SlotHolder(Slot v) { inherited = v; typed = v; untyped = v; finalSlot = v; concrete = (OldSlot) v; }
+    }
+    static final class StaticSlotHolder { static Slot slot; static final Slot FIXED = new OldSlot(-1); }
+
+    @Test
+    @DisplayName("patchSlots rewrites instance fields (inherited, typed, untyped) and skips finals and misfits")
+    void patchSlotsRewritesFields() throws MigrateException {
+        OldSlot old = new OldSlot(1);
+        NewSlot neu = new NewSlot(1);
+        SlotHolder holder = new SlotHolder(old);
+        keep(holder, old, neu);
+
+        SlotPatchResult r = walker.patchSlots(List.of(holder), new Object[]{old}, new Object[]{neu});
+
+        assertThat(holder.inherited).isSameAs(neu);
+        assertThat(holder.typed).isSameAs(neu);
+        assertThat(holder.untyped).isSameAs(neu);
+        assertThat(holder.finalSlot).isSameAs(old);
+        assertThat(holder.concrete).isSameAs(old);
+        assertThat(holder.primitive).isEqualTo(7);
+        assertThat(r.slotsFound()).isEqualTo(5);
+        assertThat(r.slotsRewritten()).isEqualTo(3);
+        assertThat(r.unpatchedHolders()).containsExactly(holder);
+    }
+
+    @Test
+    @DisplayName("patchSlots rewrites Object[] elements, and a typed array's store check rejects misfits")
+    void patchSlotsRewritesArrayElements() throws MigrateException {
+        OldSlot o1 = new OldSlot(1), o2 = new OldSlot(2);
+        NewSlot n1 = new NewSlot(1), n2 = new NewSlot(2);
+        Object[] plain = { o1, "x", o2, o1 };
+        OldSlot[] typed = { o2 };
+        keep(plain, typed, o1, o2, n1, n2);
+
+        SlotPatchResult r = walker.patchSlots(List.of(plain, typed), new Object[]{o1, o2}, new Object[]{n1, n2});
+
+        assertThat(plain).containsExactly(n1, "x", n2, n1);
+        assertThat(typed[0]).isSameAs(o2);
+        assertThat(r.slotsRewritten()).isEqualTo(3);
+        assertThat(identitySet(r.unpatchedHolders())).containsExactly(typed);
+    }
+
+    @Test
+    @DisplayName("patchSlots rewrites static fields of a Class holder but never a static final")
+    void patchSlotsRewritesStaticFields() throws MigrateException {
+        OldSlot old = new OldSlot(1);
+        NewSlot neu = new NewSlot(1);
+        Slot fixed = StaticSlotHolder.FIXED;
+        StaticSlotHolder.slot = old;
+        keep(old, neu);
+        try {
+            SlotPatchResult r = walker.patchSlots(List.of(StaticSlotHolder.class),
+                    new Object[]{old, fixed}, new Object[]{neu, new NewSlot(-1)});
+
+            assertThat(StaticSlotHolder.slot).isSameAs(neu);
+            assertThat(StaticSlotHolder.FIXED).isSameAs(fixed);
+            assertThat(r.slotsRewritten()).isEqualTo(1);
+            assertThat(r.unpatchedHolders()).containsExactly(StaticSlotHolder.class);
+        } finally {
+            StaticSlotHolder.slot = null;
+        }
+    }
+
+    @Test
+    @DisplayName("patchSlots leaves a lambda's captured (final) field to the Java patcher")
+    void patchSlotsSkipsLambdaCapture() throws MigrateException {
+        OldSlot old = new OldSlot(1);
+        NewSlot neu = new NewSlot(1);
+        Supplier<Slot> lambda = () -> old;
+        keep(lambda, old, neu);
+
+        SlotPatchResult r = walker.patchSlots(List.of(lambda), new Object[]{old}, new Object[]{neu});
+
+        assertThat(lambda.get()).isSameAs(old);
+        assertThat(r.slotsFound()).isEqualTo(1);
+        assertThat(r.slotsRewritten()).isZero();
+        assertThat(r.unpatchedHolders()).containsExactly(lambda);
+    }
+
+    @Test
+    @DisplayName("patchSlots touches only the given holders")
+    void patchSlotsIgnoresOtherHolders() throws MigrateException {
+        OldSlot old = new OldSlot(1);
+        NewSlot neu = new NewSlot(1);
+        RefHolder chosen = new RefHolder(old), other = new RefHolder(old);
+        keep(chosen, other, old, neu);
+
+        SlotPatchResult r = walker.patchSlots(List.of(chosen), new Object[]{old}, new Object[]{neu});
+
+        assertThat(chosen.ref).isSameAs(neu);
+        assertThat(other.ref).isSameAs(old);
+        assertThat(r.slotsFound()).isEqualTo(1);
+        assertThat(r.unpatchedHolders()).isEmpty();
+    }
+
+    @Test
+    @DisplayName("patchSlots of empty input returns EMPTY; mismatched old/new lengths throw")
+    void patchSlotsBadInput() throws MigrateException {
+        assertThat(walker.patchSlots(List.of(), new Object[]{1}, new Object[]{2})).isSameAs(SlotPatchResult.EMPTY);
+        assertThat(walker.patchSlots(List.of(new Object()), new Object[0], new Object[0])).isSameAs(SlotPatchResult.EMPTY);
+        assertThatThrownBy(() -> walker.patchSlots(List.of(new Object()), new Object[]{1}, new Object[0]))
+                .isInstanceOf(MigrateException.class);
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // findResidualReferences
+    //
+    // The calling thread is excluded from the walk, so a test's own locals never count: only the
+    // static holders below (or objects they reach) keep an old object reachable.
+    // ----------------------------------------------------------------------------------------------
+
+    static final class ResidualTarget { int x; ResidualTarget(int x) { this.x = x; } }
+    static final class ResidualStaticHolder { static Object ref; }
+
+    @Test
+    @DisplayName("findResidualReferences reports an old object held by a static field, with its root path")
+    void residualHeldByStaticField() throws MigrateException {
+        ResidualTarget old = new ResidualTarget(1);
+        ResidualStaticHolder.ref = old;
+        try {
+            ResidualReferences r = walker.findResidualReferences(List.of(old), List.of(), 3);
+
+            assertThat(r.residualObjects()).isEqualTo(1);
+            assertThat(r.referenceCount(HeapReferenceKind.STATIC_FIELD)).isEqualTo(1);
+            assertThat(r.samplePaths()).hasSize(1);
+            RootPath path = r.samplePaths().get(0);
+            assertThat(path.truncated()).isFalse();
+            assertThat(path.steps().get(0).via().isRoot()).isTrue();
+            List<RootPath.Step> steps = path.steps();
+            RootPath.Step last = steps.get(steps.size() - 1);
+            RootPath.Step holder = steps.get(steps.size() - 2);
+            assertThat(last.typeName()).isEqualTo(ResidualTarget.class.getTypeName());
+            assertThat(last.via()).isEqualTo(HeapReferenceKind.STATIC_FIELD);
+            assertThat(last.field()).isEqualTo("ref");
+            assertThat(holder.isClass()).isTrue();
+            assertThat(holder.typeName()).isEqualTo(ResidualStaticHolder.class.getTypeName());
+            assertThat(path.describe()).endsWith("-ref-> " + ResidualTarget.class.getTypeName());
+        } finally {
+            ResidualStaticHolder.ref = null;
+        }
+    }
+
+    @Test
+    @DisplayName("an old object held only by another old object is residual; the reference between them is not counted")
+    void residualHeldThroughOldObject() throws MigrateException {
+        ResidualTarget inner = new ResidualTarget(2);
+        RefHolder outer = new RefHolder(inner);
+        ResidualStaticHolder.ref = outer;
+        try {
+            ResidualReferences r = walker.findResidualReferences(List.of(outer, inner), null, 2);
+
+            assertThat(r.residualObjects()).isEqualTo(2);
+            assertThat(r.residualReferences()).isEqualTo(1);
+            assertThat(r.referenceCount(HeapReferenceKind.FIELD)).isZero();
+            assertThat(r.samplePaths()).hasSize(2);
+            List<RootPath.Step> innerPath = r.samplePaths().get(1).steps();
+            assertThat(innerPath.get(innerPath.size() - 1).field()).isEqualTo("ref");
+            assertThat(innerPath.get(innerPath.size() - 2).typeName()).isEqualTo(RefHolder.class.getTypeName());
+            assertThat(r.exactPaths()).isTrue();
+        } finally {
+            ResidualStaticHolder.ref = null;
+        }
+    }
+
+    @Test
+    @DisplayName("findResidualReferences does not follow excluded objects, and a clean result has no paths")
+    void residualExcludedBookkeeping() throws MigrateException {
+        ResidualTarget old = new ResidualTarget(3);
+        List<Object> bookkeeping = new ArrayList<>(List.of(old));
+        ResidualStaticHolder.ref = bookkeeping;
+        try {
+            ResidualReferences excluded = walker.findResidualReferences(List.of(old), List.of(bookkeeping), 3);
+            ResidualReferences included = walker.findResidualReferences(List.of(old), List.of(), 0);
+
+            assertThat(excluded.isClean()).isTrue();
+            assertThat(excluded.samplePaths()).isEmpty();
+            assertThat(included.residualObjects()).isEqualTo(1);
+            assertThat(included.referenceCount(HeapReferenceKind.ARRAY_ELEMENT)).isEqualTo(1);
+            assertThat(included.samplePaths()).isEmpty();
+        } finally {
+            ResidualStaticHolder.ref = null;
+        }
+    }
+
+    @Test
+    @DisplayName("findResidualReferences of null / empty input returns NONE without walking")
+    void residualEmptyInput() throws MigrateException {
+        assertThat(walker.findResidualReferences(null, null, 3)).isSameAs(ResidualReferences.NONE);
+        assertThat(walker.findResidualReferences(List.of(), List.of(), 3)).isSameAs(ResidualReferences.NONE);
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // exportReferenceGraph
+    //
+    // Each source instance is referenced from exactly one holder (and the test's stack, a root), so
+    // the per-class counts read back from the file are exact.
+    // ----------------------------------------------------------------------------------------------
+
+    static final class GraphSource { int x; GraphSource(int x) { this.x = x; } }
+    static final class GraphHolder { Object ref; GraphHolder(Object ref) { this.ref = ref; } }
+    static final class GraphStaticHolder { static Object ref; }
+
+    @TempDir
+    Path graphDir;
+
+    @Test
+    @DisplayName("exportReferenceGraph writes a graph whose referrers, patch classes and SPEC cost read back exactly")
+    void exportReferenceGraphRoundTrip() throws Exception {
+        GraphSource held = new GraphSource(1);
+        GraphSource statik = new GraphSource(2);
+        keepAlive.add(new GraphHolder(held));
+        GraphStaticHolder.ref = statik;
+        Path file = graphDir.resolve("heap.graph");
+        try {
+            HeapGraphExport export = walker.exportReferenceGraph(file, List.of(GraphSource.class), false);
+
+            assertThat(export.bytes()).isEqualTo(Files.size(file));
+            assertThat(export.objects()).isGreaterThan(export.classes()).isPositive();
+            try (HeapGraph graph = HeapGraph.open(file)) {
+                assertThat(graph.objectCount()).isEqualTo(export.objects());
+                assertThat(graph.referenceCount()).isEqualTo(export.references());
+                assertThat(graph.sourceEdgesOnly()).isFalse();
+                assertThat(graph.sourceClassNames()).containsExactly(GraphSource.class.getName());
+
+                HeapGraph.Referrers referrers = graph.referrersOf(GraphSource.class.getName());
+                assertThat(referrers.instances()).isEqualTo(2);
+                assertThat(referrers.byClass())
+                        .containsEntry(GraphHolder.class.getName(), 1L)
+                        .containsEntry(GraphStaticHolder.class.getName(), 1L);
+                assertThat(graph.classesToPatch(null))
+                        .contains(GraphHolder.class.getName(), GraphStaticHolder.class.getName())
+                        .doesNotContain(GraphSource.class.getName());
+
+                HeapGraph.SpecCost cost = graph.specCost(List.of(GraphHolder.class.getName()), null);
+                assertThat(cost.objectsWalked()).isGreaterThanOrEqualTo(1);
+                assertThat(cost.holders()).isGreaterThanOrEqualTo(2);
+                assertThat(cost.holdersMissed()).isGreaterThanOrEqualTo(1);
+                assertThat(cost.heapObjects()).isEqualTo(graph.objectCount());
+            }
+        } finally {
+            GraphStaticHolder.ref = null;
+        }
+        assertThat(held.x + statik.x).isEqualTo(3);
+    }
+
+    @Test
+    @DisplayName("exportReferenceGraph restricted to source edges writes only the references into source instances")
+    void exportReferenceGraphSourceEdgesOnly() throws Exception {
+        GraphSource held = new GraphSource(3);
+        keepAlive.add(new GraphHolder(held));
+        Path full = graphDir.resolve("full.graph");
+        Path sourceOnly = graphDir.resolve("source.graph");
+
+        walker.exportReferenceGraph(full, List.of(GraphSource.class), false);
+        HeapGraphExport export = walker.exportReferenceGraph(sourceOnly, List.of(GraphSource.class), true);
+
+        try (HeapGraph all = HeapGraph.open(full); HeapGraph graph = HeapGraph.open(sourceOnly)) {
+            assertThat(graph.sourceEdgesOnly()).isTrue();
+            assertThat(graph.referenceCount()).isEqualTo(export.references())
+                    .isEqualTo(graph.referrersOf(GraphSource.class.getName()).references())
+                    .isLessThan(all.referenceCount());
+            assertThat(graph.referrersOf(GraphSource.class.getName()).byClass())
+                    .containsEntry(GraphHolder.class.getName(), 1L);
+        }
+        assertThat(held.x).isEqualTo(3);
+    }
+
+    @Test
+    @DisplayName("exportReferenceGraph to an unwritable path fails with MigrateException")
+    void exportReferenceGraphUnwritable() {
+        Path file = graphDir.resolve("missing-dir").resolve("heap.graph");
+
+        assertThatThrownBy(() -> walker.exportReferenceGraph(file, null, false))
+                .isInstanceOf(MigrateException.class)
+                .hasMessageContaining("heap.graph");
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    // patchStackLocals
+    //
+    // Local access can only be granted while the agent loads at startup (-agentpath:<lib>=stacklocals),
+    // not to the self-attached test agent on HotSpot, so the rewrite test skips when it is unavailable.
+    // ----------------------------------------------------------------------------------------------
+
+    static final class LocalTarget { final int x; LocalTarget(int x) { this.x = x; } }
+
+    /** Parks holding {@code item} in a parameter and a local, then publishes what the local holds. */
+    private static void holdInLocal(Object item, CountDownLatch parked, CountDownLatch release,
+                                    AtomicReference<Object> seen) throws InterruptedException {
+        Object held = item;
+        parked.countDown();
+        release.await();
+        seen.set(held);
+    }
+
+    @Test
+    @DisplayName("patchStackLocals rewrites the locals of a suspended thread that hold an old object")
+    void patchStackLocalsRewritesSuspendedFrame() throws Exception {
+        LocalTarget old = new LocalTarget(1);
+        LocalTarget replacement = new LocalTarget(2);
+        CountDownLatch parked = new CountDownLatch(1);
+        CountDownLatch release = new CountDownLatch(1);
+        AtomicReference<Object> seen = new AtomicReference<>();
+        AtomicReference<Object> item = new AtomicReference<>(old);
+        Thread holder = new Thread(() -> {
+            try {
+                holdInLocal(item.getAndSet(null), parked, release, seen);
+            } catch (InterruptedException ignored) {
+                Thread.currentThread().interrupt();
+            }
+        }, "stack-locals-holder");
+        holder.setDaemon(true);
+        holder.start();
+        assertThat(parked.await(5, TimeUnit.SECONDS)).isTrue();
+
+        NativeThreadSuspender suspender = new NativeThreadSuspender();
+        SuspendResult suspended = suspender.suspend(List.of(holder));
+        StackLocalPatchResult r;
+        try {
+            r = walker.patchStackLocals(suspended.threads(), new Object[]{old}, new Object[]{replacement});
+        } catch (MigrateException e) {
+            r = null;
+        } finally {
+            suspender.resume(suspended.threads());
+            release.countDown();
+        }
+        holder.join(5_000);
+        assumeTrue(r != null, "local-variable access not granted to the attached agent");
+
+        // Both the parameter and the local are rewritten.
+        assertThat(r.localsFound()).isEqualTo(2);
+        assertThat(r.localsRewritten()).isEqualTo(2);
+        assertThat(r.unpatched()).isEmpty();
+        assertThat(seen.get()).isSameAs(replacement);
+    }
+
+    @Test
+    @DisplayName("patchStackLocals of empty input returns EMPTY; mismatched old/new lengths throw")
+    void patchStackLocalsBadInput() throws MigrateException {
+        assertThat(walker.patchStackLocals(List.of(), new Object[]{1}, new Object[]{2}))
+                .isSameAs(StackLocalPatchResult.EMPTY);
+        assertThat(walker.patchStackLocals(List.of(Thread.currentThread()), new Object[0], new Object[0]))
+                .isSameAs(StackLocalPatchResult.EMPTY);
+        assertThatThrownBy(() -> walker.patchStackLocals(List.of(Thread.currentThread()), new Object[]{1}, new Object[0]))
+                .isInstanceOf(MigrateException.class);
+    }
+
     // ----------------------------------------------------------------------------------------------
     // scale
     // ----------------------------------------------------------------------------------------------
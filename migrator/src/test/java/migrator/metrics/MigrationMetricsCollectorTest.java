@@ -1,8 +1,11 @@
 package migrator.metrics;
 
+import migrator.heap.HeapOpTimes;
 import migrator.metrics.MigrationMetrics.Phase;
 import org.junit.jupiter.api.Test;
 
+import java.util.concurrent.atomic.AtomicReference;
+
 import static org.assertj.core.api.Assertions.assertThat;
 
 /**
@@ -150,6 +153,38 @@ class MigrationMetricsCollectorTest {
         assertThat(metrics.phaseDuration(Phase.FIRST_PASS)).isGreaterThanOrEqualTo(5);
     }
 
+    @Test
+    void shouldRecordHeapOpsPerPhase() {
+        AtomicReference<HeapOpTimes> nativeTimes = new AtomicReference<>(new HeapOpTimes(5, 500, 400, 5, 50, 40));
+        MigrationMetricsCollector collector = new MigrationMetricsCollector();
+        collector.start(9L).heapOpTimes(nativeTimes::get);
+
+        // a census before any phase: counted overall, not in a phase
+        nativeTimes.set(nativeTimes.get().plus(new HeapOpTimes(1, 100, 90, 0, 0, 0)));
+        collector.timed(Phase.FIRST_PASS, () ->
+                nativeTimes.set(nativeTimes.get().plus(new HeapOpTimes(1, 1_000, 900, 1, 300, 200))));
+        collector.timed(Phase.SMOKE_TEST, () -> sleep(1));
+
+        MigrationMetrics metrics = collector.finish();
+
+        assertThat(collector.heapOps(Phase.FIRST_PASS)).isEqualTo(new HeapOpTimes(1, 1_000, 900, 1, 300, 200));
+        assertThat(metrics.phaseHeapOps(Phase.FIRST_PASS)).isEqualTo(new HeapOpTimes(1, 1_000, 900, 1, 300, 200));
+        assertThat(metrics.phaseHeapOps()).doesNotContainKey(Phase.SMOKE_TEST);
+        assertThat(metrics.heapOps()).isEqualTo(new HeapOpTimes(2, 1_100, 990, 1, 300, 200));
+    }
+
+    @Test
+    void shouldTolerateMissingHeapOpSource() {
+        MigrationMetricsCollector collector = new MigrationMetricsCollector();
+        collector.start(10L).heapOpTimes(() -> { throw new UnsatisfiedLinkError("no agent"); });
+
+        collector.timed(Phase.FIRST_PASS, () -> sleep(1));
+        MigrationMetrics metrics = collector.finish();
+
+        assertThat(metrics.heapOps()).isEqualTo(HeapOpTimes.NONE);
+        assertThat(metrics.phaseHeapOps()).isEmpty();
+    }
+
     @Test
     void nestedRecordsShouldProvideSummaries() {
         MigrationMetrics.MemoryMetrics memory = new MigrationMetrics.MemoryMetrics(
@@ -1,5 +1,7 @@
 package migrator.metrics;
 
+import migrator.heap.HeapOpTimes;
+import migrator.metrics.MigrationMetrics.Phase;
 import org.junit.jupiter.api.DisplayName;
 import org.junit.jupiter.api.Test;
 
@@ -35,4 +37,126 @@ class MigrationMetricsTest {
         // memory/cpu sub-records are populated by the builder, so these stay non-null.
         assertThat(serialized).containsKey("heapUsedBefore");
     }
+
+    @Test
+    @DisplayName("census counts appear in toMap() and summary() only when a census was taken")
+    void censusReportedOnlyWhenTaken() {
+        MigrationMetrics without = MigrationMetrics.builder().migrationId(1).build();
+        MigrationMetrics with = MigrationMetrics.builder()
+                .migrationId(2)
+                .sourceCensus(1500, 3L * 1024 * 1024)
+                .build();
+
+        assertThat(without.hasCensus()).isFalse();
+        assertThat(without.toMap().get("sourceInstances")).isNull();
+        assertThat(without.summary()).doesNotContain("Census");
+
+        assertThat(with.hasCensus()).isTrue();
+        assertThat(with.toMap().get("sourceInstances")).isEqualTo(1500L);
+        assertThat(with.toMap().get("sourceShallowBytes")).isEqualTo(3L * 1024 * 1024);
+        assertThat(with.summary()).contains("Census: 1500 source instances");
+    }
+
+    @Test
+    @DisplayName("unreachable source instances appear in toMap() and summary() only when measured")
+    void unreachableSkippedReportedOnlyWhenMeasured() {
+        MigrationMetrics without = MigrationMetrics.builder().migrationId(1).sourceCensus(10, 160).build();
+        MigrationMetrics with = MigrationMetrics.builder()
+                .migrationId(2)
+                .sourceCensus(10, 160)
+                .unreachableSkipped(7)
+                .build();
+
+        assertThat(without.hasUnreachableSkipped()).isFalse();
+        assertThat(without.toMap().get("unreachableSkipped")).isNull();
+        assertThat(without.summary()).doesNotContain("Unreachable");
+
+        assertThat(with.hasUnreachableSkipped()).isTrue();
+        assertThat(with.unreachableSkipped()).isEqualTo(7);
+        assertThat(with.toMap().get("unreachableSkipped")).isEqualTo(7L);
+        assertThat(with.summary()).contains("Unreachable skipped: 7");
+    }
+
+    @Test
+    @DisplayName("residual references appear in toMap() and summary() only when verified")
+    void residualsReportedOnlyWhenVerified() {
+        MigrationMetrics without = MigrationMetrics.builder().migrationId(1).build();
+        MigrationMetrics with = MigrationMetrics.builder().migrationId(2).residuals(3, 4).build();
+
+        assertThat(without.hasResidualCheck()).isFalse();
+        assertThat(without.toMap().get("residualObjects")).isNull();
+        assertThat(without.toMap().get("residualReferences")).isNull();
+        assertThat(without.summary()).doesNotContain("Residual");
+
+        assertThat(with.hasResidualCheck()).isTrue();
+        assertThat(with.residualObjects()).isEqualTo(3);
+        assertThat(with.toMap().get("residualObjects")).isEqualTo(3L);
+        assertThat(with.toMap().get("residualReferences")).isEqualTo(4L);
+        assertThat(with.summary()).contains("Residual: 3 objects, 4 references");
+    }
+
+    @Test
+    @DisplayName("thread suspension appears in toMap() and summary() only when the engine suspended")
+    void suspensionReportedOnlyWhenUsed() {
+        MigrationMetrics without = MigrationMetrics.builder().migrationId(1).build();
+        MigrationMetrics with = MigrationMetrics.builder()
+                .migrationId(2)
+                .suspension(new MigrationMetrics.ThreadSuspension(12, 1, 250_000, 150_000, 4_000_000))
+                .build();
+
+        assertThat(without.hasSuspension()).isFalse();
+        assertThat(without.suspension()).isEqualTo(MigrationMetrics.ThreadSuspension.NONE);
+        assertThat(without.toMap()).doesNotContainKeys("threadsSuspended", "suspendMs", "suspendedPauseMs");
+        assertThat(without.summary()).doesNotContain("Suspended");
+
+        assertThat(with.hasSuspension()).isTrue();
+        assertThat(with.toMap().get("threadsSuspended")).isEqualTo(12);
+        assertThat(with.toMap().get("threadsSuspendFailed")).isEqualTo(1);
+        assertThat(with.toMap().get("suspendMs")).isEqualTo(0.25);
+        assertThat(with.toMap().get("resumeMs")).isEqualTo(0.15);
+        assertThat(with.toMap().get("suspendedPauseMs")).isEqualTo(4.0);
+        assertThat(with.summary()).contains("Suspended: 12 threads (1 failed), pause 4.0ms (suspend 0.25ms, resume 0.15ms)");
+    }
+
+    @Test
+    @DisplayName("stack-local counts appear in toMap() and summary() only when locals were patched")
+    void stackLocalsReportedOnlyWhenPatched() {
+        MigrationMetrics without = MigrationMetrics.builder().migrationId(1).build();
+        MigrationMetrics with = MigrationMetrics.builder().migrationId(2).stackLocals(5, 4).build();
+
+        assertThat(without.hasStackLocalPatch()).isFalse();
+        assertThat(without.toMap().get("stackLocalsFound")).isNull();
+        assertThat(without.summary()).doesNotContain("Stack locals");
+
+        assertThat(with.hasStackLocalPatch()).isTrue();
+        assertThat(with.toMap().get("stackLocalsFound")).isEqualTo(5L);
+        assertThat(with.toMap().get("stackLocalsRewritten")).isEqualTo(4L);
+        assertThat(with.summary()).contains("Stack locals: 4 of 5 rewritten");
+    }
+
+    @Test
+    @DisplayName("heap-operation times appear per phase in toMap() and summary() only when recorded")
+    void heapOpsReportedPerPhase() {
+        HeapOpTimes firstPass = new HeapOpTimes(1, 12_000_000, 10_000_000, 1, 4_000_000, 2_500_000);
+        MigrationMetrics without = MigrationMetrics.builder().migrationId(1).build();
+        MigrationMetrics with = MigrationMetrics.builder()
+                .migrationId(2)
+                .phaseHeapOps(Map.of(Phase.FIRST_PASS, firstPass))
+                .heapOps(firstPass)
+                .build();
+
+        assertThat(without.heapOps()).isEqualTo(HeapOpTimes.NONE);
+        assertThat(without.toMap()).doesNotContainKey("heapOpTagSafepointMs");
+        assertThat(without.summary()).doesNotContain("Heap ops");
+
+        Map<String, Object> map = with.toMap();
+        assertThat(map.get("first_passTagWallMs")).isEqualTo(12.0);
+        assertThat(map.get("first_passTagSafepointMs")).isEqualTo(10.0);
+        assertThat(map.get("first_passResolveWallMs")).isEqualTo(4.0);
+        assertThat(map.get("first_passResolveSafepointMs")).isEqualTo(2.5);
+        assertThat(map.get("heapOpTagSafepointMs")).isEqualTo(10.0);
+        assertThat(map).doesNotContainKey("second_passTagWallMs");
+        assertThat(with.phaseHeapOps(Phase.SECOND_PASS)).isEqualTo(HeapOpTimes.NONE);
+        assertThat(with.summary()).contains("Heap ops: safepoint 12.5ms of 16.0ms");
+    }
 }
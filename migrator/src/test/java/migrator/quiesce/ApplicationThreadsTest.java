@@ -0,0 +1,77 @@
+package migrator.quiesce;
+
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+
+import static org.assertj.core.api.Assertions.assertThat;
+
+/**
+ * Verifies which threads an engine-managed quiescence selects for suspension.
+ */
+@DisplayName("ApplicationThreads — thread selection")
+class ApplicationThreadsTest {
+
+    private final CountDownLatch release = new CountDownLatch(1);
+    private final List<Thread> started = new ArrayList<>();
+
+    @AfterEach
+    void stopThreads() throws InterruptedException {
+        release.countDown();
+        for (Thread t : started) t.join(5_000);
+    }
+
+    private Thread start(String name) {
+        Thread t = new Thread(() -> {
+            try {
+                release.await();
+            } catch (InterruptedException ignored) {
+                Thread.currentThread().interrupt();
+            }
+        }, name);
+        t.setDaemon(true);
+        t.start();
+        started.add(t);
+        return t;
+    }
+
+    @Test
+    @DisplayName("selects application threads, never the caller, the migrator's threads or JDK threads")
+    void selectsApplicationThreads() {
+        Thread app = start("app-worker");
+        Thread migrator = start(ApplicationThreads.MIGRATOR_THREAD_PREFIX + "timeout-executor");
+
+        List<Thread> selected = ApplicationThreads.select(null);
+
+        assertThat(selected).contains(app)
+                .doesNotContain(Thread.currentThread(), migrator)
+                .noneMatch(ApplicationThreads::isJdkThread)
+                .noneMatch(t -> t.getName().equals("Reference Handler") || t.getName().equals("Finalizer"));
+    }
+
+    @Test
+    @DisplayName("leaves allowlisted threads running, by exact name or by prefix")
+    void honoursAllowlist() {
+        Thread exact = start("metrics-reporter");
+        Thread prefixed = start("grpc-executor-3");
+        Thread other = start("grpc2-executor");
+
+        List<Thread> selected = ApplicationThreads.select(List.of("metrics-reporter", "grpc-executor-*"));
+
+        assertThat(selected).contains(other).doesNotContain(exact, prefixed);
+    }
+
+    @Test
+    @DisplayName("matches allowlist entries by name, ignoring blank entries")
+    void allowlistMatching() {
+        assertThat(ApplicationThreads.isAllowed("pool-1-thread-1", List.of("pool-*"))).isTrue();
+        assertThat(ApplicationThreads.isAllowed("pool-1-thread-1", List.of("pool"))).isFalse();
+        assertThat(ApplicationThreads.isAllowed("anything", List.of("*"))).isTrue();
+        assertThat(ApplicationThreads.isAllowed("anything", List.of(""))).isFalse();
+        assertThat(ApplicationThreads.isAllowed("anything", null)).isFalse();
+    }
+}
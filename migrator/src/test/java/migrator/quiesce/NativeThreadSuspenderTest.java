@@ -0,0 +1,117 @@
+package migrator.quiesce;
+
+import migrator.heap.NativeAgentSupport;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeAll;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.util.Arrays;
+import java.util.List;
+import java.util.concurrent.atomic.AtomicLong;
+
+import static org.assertj.core.api.Assertions.assertThat;
+import static org.junit.jupiter.api.Assumptions.assumeTrue;
+
+/**
+ * Runs {@link NativeThreadSuspender} against the real native agent self-attached into the test
+ * JVM (see {@link NativeAgentSupport}): suspended threads stop making progress until resumed, and
+ * threads that cannot be suspended are counted rather than failing the call. Skips when the agent
+ * cannot be loaded.
+ */
+@DisplayName("NativeThreadSuspender — JVMTI thread suspension")
+class NativeThreadSuspenderTest {
+
+    private final NativeThreadSuspender suspender = new NativeThreadSuspender();
+    private volatile boolean stop;
+    private Thread spinner;
+    private final AtomicLong spins = new AtomicLong();
+
+    @BeforeAll
+    static void loadAgent() {
+        NativeAgentSupport.ensureLoaded();
+    }
+
+    @BeforeEach
+    void requireAgent() {
+        assumeTrue(NativeAgentSupport.ensureLoaded(),
+                () -> "native agent not loaded, skipping: " + NativeAgentSupport.skipReason());
+        spinner = new Thread(() -> {
+            while (!stop) spins.incrementAndGet();
+        }, "suspend-test-spinner");
+        spinner.setDaemon(true);
+        spinner.start();
+    }
+
+    @AfterEach
+    void stopSpinner() throws InterruptedException {
+        stop = true;
+        if (spinner != null) {
+            suspender.resume(List.of(spinner));
+            spinner.join(5_000);
+        }
+    }
+
+    @Test
+    @DisplayName("a suspended thread makes no progress until resumed")
+    void suspendsAndResumes() throws Exception {
+        awaitSpins(1);
+
+        SuspendResult suspended = suspender.suspend(List.of(spinner));
+        assertThat(suspended.threads()).containsExactly(spinner);
+        assertThat(suspended.failed()).isZero();
+        assertThat(suspended.nanos()).isPositive();
+
+        long frozen = spins.get();
+        Thread.sleep(100);
+        assertThat(spins.get()).isEqualTo(frozen);
+
+        SuspendResult resumed = suspender.resume(List.of(spinner));
+        assertThat(resumed.threads()).containsExactly(spinner);
+        assertThat(resumed.failed()).isZero();
+        awaitSpins(frozen + 1);
+    }
+
+    @Test
+    @DisplayName("the calling thread, ended threads and nulls are counted as failed, never suspended")
+    void unsuspendableThreads() throws Exception {
+        Thread ended = new Thread(() -> { }, "suspend-test-ended");
+        ended.start();
+        ended.join();
+
+        SuspendResult result = suspender.suspend(Arrays.asList(Thread.currentThread(), ended, null, spinner));
+        try {
+            assertThat(result.threads()).containsExactly(spinner);
+            assertThat(result.failed()).isEqualTo(2);
+        } finally {
+            suspender.resume(result.threads());
+        }
+    }
+
+    @Test
+    @DisplayName("resuming a thread that is not suspended is counted as failed")
+    void resumeNotSuspended() {
+        SuspendResult result = suspender.resume(List.of(spinner));
+
+        assertThat(result.threads()).isEmpty();
+        assertThat(result.failed()).isEqualTo(1);
+    }
+
+    @Test
+    @DisplayName("an empty list suspends nothing")
+    void emptyList() throws Exception {
+        SuspendResult result = suspender.suspend(List.of());
+
+        assertThat(result.threads()).isEmpty();
+        assertThat(result.failed()).isZero();
+    }
+
+    private void awaitSpins(long atLeast) throws InterruptedException {
+        long deadline = System.nanoTime() + 5_000_000_000L;
+        while (spins.get() < atLeast && System.nanoTime() < deadline) {
+            Thread.sleep(1);
+        }
+        assertThat(spins.get()).isGreaterThanOrEqualTo(atLeast);
+    }
+}
@@ -0,0 +1,110 @@
+package migrator.quiesce;
+
+import migrator.exceptions.MigrateException;
+import org.junit.jupiter.api.DisplayName;
+import org.junit.jupiter.api.Test;
+
+import java.time.Duration;
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.List;
+import java.util.concurrent.TimeUnit;
+
+import static org.assertj.core.api.Assertions.assertThat;
+import static org.assertj.core.api.Assertions.assertThatThrownBy;
+
+/**
+ * Verifies the pause handle: threads are resumed exactly once, by the caller or by the watchdog,
+ * and the pause is timed.
+ */
+@DisplayName("Quiescence — suspend / resume handle")
+class QuiescenceTest {
+
+    /** Records calls; "suspends" every listed thread except those named "gone". */
+    static final class RecordingSuspender implements ThreadSuspender {
+        final List<Collection<Thread>> suspended = new ArrayList<>();
+        final List<Collection<Thread>> resumed = new ArrayList<>();
+
+        @Override public SuspendResult suspend(Collection<Thread> threads) {
+            suspended.add(threads);
+            List<Thread> done = threads.stream().filter(t -> !t.getName().equals("gone")).toList();
+            return new SuspendResult(done, threads.size() - done.size(), 1_000);
+        }
+
+        @Override public synchronized SuspendResult resume(Collection<Thread> threads) {
+            resumed.add(threads);
+            return new SuspendResult(threads, 0, 2_000);
+        }
+    }
+
+    private static final Thread A = new Thread("a");
+    private static final Thread B = new Thread("b");
+    private static final Thread GONE = new Thread("gone");
+
+    @Test
+    @DisplayName("resumes exactly the suspended threads, once")
+    void resumesOnce() throws MigrateException {
+        RecordingSuspender suspender = new RecordingSuspender();
+        Quiescence q = Quiescence.begin(suspender, List.of(A, B, GONE), null);
+
+        assertThat(q.suspendedCount()).isEqualTo(2);
+        assertThat(q.failedCount()).isEqualTo(1);
+        assertThat(q.suspendNanos()).isEqualTo(1_000);
+        assertThat(q.pausedNanos()).isZero();
+
+        assertThat(q.resume()).isTrue();
+        assertThat(q.resume()).isFalse();
+        q.close();
+
+        assertThat(suspender.resumed).containsExactly(List.of(A, B));
+        assertThat(q.resumeNanos()).isEqualTo(2_000);
+        assertThat(q.pausedNanos()).isPositive();
+        assertThat(q.isResumedByWatchdog()).isFalse();
+    }
+
+    @Test
+    @DisplayName("the watchdog resumes a pause that outlives its limit")
+    void watchdogResumes() throws Exception {
+        RecordingSuspender suspender = new RecordingSuspender();
+        Quiescence q = Quiescence.begin(suspender, List.of(A), Duration.ofMillis(50));
+
+        long deadline = System.nanoTime() + TimeUnit.SECONDS.toNanos(5);
+        while (!q.isResumedByWatchdog() && System.nanoTime() < deadline) {
+            Thread.sleep(10);
+        }
+
+        assertThat(q.isResumedByWatchdog()).isTrue();
+
+        assertThat(q.resume()).isFalse();
+        assertThat(suspender.resumed).hasSize(1);
+        assertThat(q.pausedNanos()).isGreaterThanOrEqualTo(TimeUnit.MILLISECONDS.toNanos(50));
+    }
+
+    @Test
+    @DisplayName("a pause resumed in time leaves the watchdog idle")
+    void watchdogIdleWhenResumedInTime() throws Exception {
+        RecordingSuspender suspender = new RecordingSuspender();
+        Quiescence q = Quiescence.begin(suspender, List.of(A), Duration.ofMillis(100));
+
+        assertThat(q.resume()).isTrue();
+        Thread.sleep(200);
+
+        assertThat(q.isResumedByWatchdog()).isFalse();
+        assertThat(suspender.resumed).hasSize(1);
+    }
+
+    @Test
+    @DisplayName("suspension that is not available fails the begin")
+    void unavailable() {
+        ThreadSuspender none = new ThreadSuspender() {
+            @Override public SuspendResult suspend(Collection<Thread> threads) throws MigrateException {
+                throw new MigrateException("Thread suspension is not available in this VM");
+            }
+            @Override public SuspendResult resume(Collection<Thread> threads) { return SuspendResult.NONE; }
+        };
+
+        assertThatThrownBy(() -> Quiescence.begin(none, List.of(A), null))
+                .isInstanceOf(MigrateException.class)
+                .hasMessageContaining("not available");
+    }
+}
@@ -1,5 +1,7 @@
 package migrator.state;
 
+import migrator.heap.ReclamationProgress;
+import migrator.heap.WalkProgress;
 import migrator.metrics.MigrationMetrics;
 import migrator.metrics.MigrationMetrics.Phase;
 import org.junit.jupiter.api.AfterEach;
@@ -324,6 +326,87 @@ class MigrationStateTest {
     }
 
     // ----------------------------------------------------------------------------------------------
+    @Nested
+    @DisplayName("walk progress")
+    class WalkProgressTracking {
+
+        @Test
+        @DisplayName("reads the running walk's progress live and forgets it when the walk finishes")
+        void liveProgress() {
+            AtomicInteger visited = new AtomicInteger();
+            state.walkStarted("heapWalkFull", () -> new WalkProgress(7, visited.get(), 3, true, false));
+
+            visited.set(1000);
+            assertThat(state.getCurrentWalk()).isEqualTo("heapWalkFull");
+            assertThat(state.getWalkProgress().visited()).isEqualTo(1000);
+            @SuppressWarnings("unchecked")
+            Map<String, Object> walk = (Map<String, Object>) state.toMap().get("currentWalk");
+            assertThat(walk).containsEntry("operation", "heapWalkFull")
+                            .containsEntry("objectsVisited", 1000L)
+                            .containsEntry("objectsTagged", 3L);
+
+            state.walkFinished();
+            assertThat(state.getCurrentWalk()).isNull();
+            assertThat(state.getWalkProgress()).isEqualTo(WalkProgress.NONE);
+            assertThat(state.toMap()).doesNotContainKey("currentWalk");
+        }
+
+        @Test
+        @DisplayName("a failing progress source reads as no progress, and reset clears the walk")
+        void failingSourceAndReset() {
+            state.walkStarted("heapSnapshot", () -> { throw new IllegalStateException("agent gone"); });
+
+            assertThat(state.getWalkProgress()).isEqualTo(WalkProgress.NONE);
+            assertThat(catchThrowable(state::toMap)).isNull();
+
+            state.reset();
+            assertThat(state.getCurrentWalk()).isNull();
+        }
+    }
+
+    // ----------------------------------------------------------------------------------------------
+    @Nested
+    @DisplayName("reclamation")
+    class ReclamationTracking {
+
+        @Test
+        @DisplayName("reads the tracker's progress live and reports the time to reclaim once complete")
+        void liveReclamation() {
+            AtomicInteger reclaimed = new AtomicInteger(3);
+            state.reclamationStarted(5L, () -> new ReclamationProgress(
+                    9, 4, 64, reclaimed.get(), reclaimed.get() * 16L, 42_000_000, 50_000_000, true));
+
+            assertThat(state.getReclamationMigrationId()).isEqualTo(5L);
+            assertThat(state.getReclamation().outstanding()).isEqualTo(1);
+            @SuppressWarnings("unchecked")
+            Map<String, Object> partial = (Map<String, Object>) state.toMap().get("reclamation");
+            assertThat(partial).containsEntry("migrationId", 5L)
+                               .containsEntry("reclaimed", 3L)
+                               .containsEntry("complete", false)
+                               .containsEntry("timeToReclaimMs", null);
+
+            reclaimed.set(4);
+            @SuppressWarnings("unchecked")
+            Map<String, Object> complete = (Map<String, Object>) state.toMap().get("reclamation");
+            assertThat(complete).containsEntry("reclaimedBytes", 64L)
+                                .containsEntry("complete", true)
+                                .containsEntry("timeToReclaimMs", 42L);
+        }
+
+        @Test
+        @DisplayName("a failing source reads as none, and reset forgets the tracker")
+        void failingSourceAndReset() {
+            state.reclamationStarted(6L, () -> { throw new UnsatisfiedLinkError("agent gone"); });
+
+            assertThat(state.getReclamation()).isEqualTo(ReclamationProgress.NONE);
+            assertThat(catchThrowable(state::toMap)).isNull();
+
+            state.reset();
+            assertThat(state.getReclamationMigrationId()).isZero();
+            assertThat(state.toMap()).doesNotContainKey("reclamation");
+        }
+    }
+
     @Nested
     @DisplayName("reset")
     class Reset {